@@ -334,9 +334,16 @@ findpkg_finish(TBB_MALLOC_PROXY)
 #parse all the version numbers from tbb
 if(NOT TBB_VERSION)
 
+ #oneTBB moved the version macros out of tbb_stddef.h
+ set(TBB_VERSION_FILE "${TBB_INCLUDE_DIR}/tbb/tbb_stddef.h")
+ if(NOT EXISTS "${TBB_VERSION_FILE}" AND
+    EXISTS "${TBB_INCLUDE_DIR}/oneapi/tbb/version.h")
+   set(TBB_VERSION_FILE "${TBB_INCLUDE_DIR}/oneapi/tbb/version.h")
+ endif()
+
  #only read the start of the file
  file(READ
-      "${TBB_INCLUDE_DIR}/tbb/tbb_stddef.h"
+      "${TBB_VERSION_FILE}"
       TBB_VERSION_CONTENTS
       LIMIT 2048)
 
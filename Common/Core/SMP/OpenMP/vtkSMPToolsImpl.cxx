@@ -0,0 +1,65 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPToolsImpl.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkSMPToolsInternal.h"
+
+#include <omp.h>
+
+using namespace vtk::detail::smp;
+
+namespace
+{
+int vtkSMPNumberOfSpecifiedThreads = 0;
+}
+
+//--------------------------------------------------------------------------------
+void vtk::detail::smp::vtkSMPTools_Impl_Initialize_OpenMP(int numThreads)
+{
+  vtkSMPNumberOfSpecifiedThreads = numThreads > 0 ? numThreads : 0;
+}
+
+int vtk::detail::smp::vtkSMPTools_Impl_GetNumberOfThreads_OpenMP()
+{
+  return vtkSMPNumberOfSpecifiedThreads ? vtkSMPNumberOfSpecifiedThreads :
+         omp_get_max_threads();
+}
+
+void vtk::detail::smp::vtkSMPTools_Impl_For_OpenMP(vtkIdType first,
+  vtkIdType last, vtkIdType grain, ExecuteFunctorPtrType functorExecuter,
+  void *functor)
+{
+  vtkSMPScopeState state = { OpenMP, GetMaxNumberOfThreadsInScope() };
+  int numThreads = vtkSMPTools_Impl_GetNumberOfThreads_OpenMP();
+  if (state.MaxNumberOfThreads > 0 && state.MaxNumberOfThreads < numThreads)
+  {
+    numThreads = state.MaxNumberOfThreads;
+  }
+  if (grain <= 0)
+  {
+    vtkIdType estimateGrain = (last - first)/(numThreads * 4);
+    grain = (estimateGrain > 0) ? estimateGrain : 1;
+  }
+
+# pragma omp parallel num_threads(numThreads)
+  {
+    // The threads of the team run nested operations with the same settings.
+    vtkSMPScope scope(state);
+#   pragma omp for schedule(runtime)
+    for (vtkIdType from = first; from < last; from += grain)
+    {
+      functorExecuter(functor, from, grain, last);
+    }
+  }
+}
@@ -0,0 +1,298 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPToolsImpl.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkSMPToolsInternal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Implementation based on a pool of C++11 threads.
+//
+// Each call to For() becomes a job: the range is cut into chunks of grain
+// size which are claimed through an atomic counter. The calling thread
+// works on its own job and the idle threads of the pool claim chunks of the
+// most recent pending job. Nested calls to For() (from inside a functor)
+// simply post another job: the calling thread processes it while the idle
+// threads help, so nested parallelism never waits on a busy thread.
+//
+// A job started within a vtkSMPScope capping the number of threads accepts
+// at most that many threads (the calling thread included), and the threads
+// of the pool adopt the scope of the job while working on it.
+
+using namespace vtk::detail::smp;
+
+namespace
+{
+int vtkSMPNumberOfSpecifiedThreads = 0;
+
+struct vtkSMPJob
+{
+  ExecuteFunctorPtrType Executer;
+  void *Functor;
+  vtkIdType First;
+  vtkIdType Last;
+  vtkIdType Grain;
+  vtkIdType NumberOfChunks;
+  std::atomic<vtkIdType> NextChunk;
+  int NumberOfHelpers; // threads of the pool working on the job (locked)
+  int MaxNumberOfHelpers;
+  vtkSMPScopeState Scope;
+
+  // Process a chunk of the job. Returns false once all chunks are claimed.
+  bool ExecuteChunk()
+  {
+    vtkIdType chunk = this->NextChunk++;
+    if (chunk >= this->NumberOfChunks)
+    {
+      return false;
+    }
+    this->Executer(this->Functor, this->First + chunk * this->Grain,
+                   this->Grain, this->Last);
+    return true;
+  }
+
+  bool HasChunks() const
+  {
+    return this->NextChunk.load() < this->NumberOfChunks;
+  }
+};
+
+class vtkSMPThreadPool
+{
+public:
+  static vtkSMPThreadPool& GetInstance()
+  {
+    static vtkSMPThreadPool pool;
+    return pool;
+  }
+
+  ~vtkSMPThreadPool()
+  {
+    this->StopThreads();
+  }
+
+  // Create the pool for numThreads threads (the calling thread included).
+  void Initialize(int numThreads)
+  {
+    std::lock_guard<std::mutex> initGuard(this->InitializeLock);
+    if (numThreads <= 0)
+    {
+      numThreads = static_cast<int>(std::thread::hardware_concurrency());
+      numThreads = std::max(numThreads, 1);
+    }
+    if (this->Initialized && numThreads == this->NumberOfThreads)
+    {
+      return;
+    }
+
+    this->StopThreads();
+    this->NumberOfThreads = numThreads;
+    this->Stop = false;
+    for (int i = 1; i < numThreads; ++i)
+    {
+      this->Threads.push_back(std::thread(&vtkSMPThreadPool::Work, this));
+    }
+    this->Initialized = true;
+  }
+
+  bool IsInitialized() const
+  {
+    return this->Initialized;
+  }
+
+  int GetNumberOfThreads()
+  {
+    if (!this->Initialized)
+    {
+      this->Initialize(vtkSMPNumberOfSpecifiedThreads);
+    }
+    return this->NumberOfThreads;
+  }
+
+  void Run(vtkSMPJob &job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Jobs.push_back(&job);
+    }
+    this->JobPosted.notify_all();
+
+    while (job.ExecuteChunk())
+    {
+    }
+
+    // All the chunks are claimed; wait for the helpers to be done with them.
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->RemoveJob(&job);
+    this->JobDone.wait(lock, [&job] { return job.NumberOfHelpers == 0; });
+  }
+
+private:
+  vtkSMPThreadPool() : NumberOfThreads(1), Initialized(false), Stop(false)
+  {
+  }
+
+  void StopThreads()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->Stop = true;
+    }
+    this->JobPosted.notify_all();
+    for (size_t i = 0; i < this->Threads.size(); ++i)
+    {
+      this->Threads[i].join();
+    }
+    this->Threads.clear();
+  }
+
+  void RemoveJob(vtkSMPJob *job)
+  {
+    std::deque<vtkSMPJob*>::iterator it =
+      std::find(this->Jobs.begin(), this->Jobs.end(), job);
+    if (it != this->Jobs.end())
+    {
+      this->Jobs.erase(it);
+    }
+  }
+
+  // Find a job a thread of the pool can help with (locked). The most recent
+  // job is the innermost one when loops are nested; finishing it first
+  // unblocks the threads waiting on it. Jobs which have all their helpers
+  // are skipped.
+  vtkSMPJob* FindJob()
+  {
+    for (size_t i = this->Jobs.size(); i > 0; --i)
+    {
+      vtkSMPJob *job = this->Jobs[i - 1];
+      if (!job->HasChunks())
+      {
+        this->Jobs.erase(this->Jobs.begin() + (i - 1));
+      }
+      else if (job->NumberOfHelpers < job->MaxNumberOfHelpers)
+      {
+        return job;
+      }
+    }
+    return nullptr;
+  }
+
+  // Main loop of the threads of the pool.
+  void Work()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    for (;;)
+    {
+      vtkSMPJob *job = nullptr;
+      while (!this->Stop && !(job = this->FindJob()))
+      {
+        this->JobPosted.wait(lock);
+      }
+      if (this->Stop)
+      {
+        return;
+      }
+      ++job->NumberOfHelpers;
+
+      lock.unlock();
+      {
+        vtkSMPScope scope(job->Scope);
+        while (job->ExecuteChunk())
+        {
+        }
+      }
+      lock.lock();
+
+      this->RemoveJob(job);
+      if (--job->NumberOfHelpers == 0)
+      {
+        this->JobDone.notify_all();
+      }
+    }
+  }
+
+  std::mutex InitializeLock;
+  std::mutex Mutex;
+  std::condition_variable JobPosted;
+  std::condition_variable JobDone;
+  std::deque<vtkSMPJob*> Jobs;
+  std::vector<std::thread> Threads;
+  int NumberOfThreads;
+  std::atomic<bool> Initialized;
+  bool Stop;
+};
+}
+
+//--------------------------------------------------------------------------------
+void vtk::detail::smp::vtkSMPTools_Impl_Initialize_STDThread(int numThreads)
+{
+  // The threads are only created once the backend is used.
+  vtkSMPNumberOfSpecifiedThreads = numThreads;
+  vtkSMPThreadPool &pool = vtkSMPThreadPool::GetInstance();
+  if (pool.IsInitialized())
+  {
+    pool.Initialize(numThreads);
+  }
+}
+
+int vtk::detail::smp::vtkSMPTools_Impl_GetNumberOfThreads_STDThread()
+{
+  return vtkSMPThreadPool::GetInstance().GetNumberOfThreads();
+}
+
+void vtk::detail::smp::vtkSMPTools_Impl_For_STDThread(vtkIdType first,
+  vtkIdType last, vtkIdType grain, ExecuteFunctorPtrType functorExecuter,
+  void *functor)
+{
+  vtkSMPThreadPool &pool = vtkSMPThreadPool::GetInstance();
+  int numThreads = pool.GetNumberOfThreads();
+  int maxNumThreads = GetMaxNumberOfThreadsInScope();
+  if (maxNumThreads > 0 && maxNumThreads < numThreads)
+  {
+    numThreads = maxNumThreads;
+  }
+  if (grain <= 0)
+  {
+    vtkIdType estimateGrain = (last - first)/(numThreads * 4);
+    grain = (estimateGrain > 0) ? estimateGrain : 1;
+  }
+
+  vtkSMPJob job;
+  job.Executer = functorExecuter;
+  job.Functor = functor;
+  job.First = first;
+  job.Last = last;
+  job.Grain = grain;
+  job.NumberOfChunks = (last - first + grain - 1) / grain;
+  job.NextChunk = 0;
+  job.NumberOfHelpers = 0;
+  job.MaxNumberOfHelpers = numThreads - 1;
+  job.Scope.Backend = STDThread;
+  job.Scope.MaxNumberOfThreads = maxNumThreads;
+
+  if (numThreads == 1 || job.NumberOfChunks == 1)
+  {
+    while (job.ExecuteChunk())
+    {
+    }
+    return;
+  }
+  pool.Run(job);
+}
@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPToolsImpl.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkSMPToolsInternal.h"
+
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <memory>
+#include <mutex>
+
+using namespace vtk::detail::smp;
+
+namespace
+{
+std::mutex vtkSMPToolsInitializeLock;
+// When the number of threads is set by vtkSMPTools::Initialize, the loops
+// run in an arena of that concurrency and the global control lets TBB create
+// that many threads even when it exceeds the number of cores.
+std::unique_ptr<tbb::global_control> vtkSMPToolsGlobalControl;
+std::unique_ptr<tbb::task_arena> vtkSMPToolsArena;
+int vtkTBBNumSpecifiedThreads = 0;
+
+class vtkSMPToolsFuncCall
+{
+public:
+  vtkSMPToolsFuncCall(ExecuteFunctorPtrType executer, void *functor,
+                      const vtkSMPScopeState &state)
+    : Executer(executer), Functor(functor), State(state)
+  {
+  }
+
+  void operator() (const tbb::blocked_range<vtkIdType>& r) const
+  {
+    // The tasks run nested operations with the settings of the caller.
+    vtkSMPScope scope(this->State);
+    this->Executer(this->Functor, r.begin(), r.end() - r.begin(), r.end());
+  }
+
+private:
+  ExecuteFunctorPtrType Executer;
+  void *Functor;
+  vtkSMPScopeState State;
+};
+}
+
+//--------------------------------------------------------------------------------
+void vtk::detail::smp::vtkSMPTools_Impl_Initialize_TBB(int numThreads)
+{
+  std::lock_guard<std::mutex> lock(vtkSMPToolsInitializeLock);
+  // If numThreads <= 0, let TBB do the default thing.
+  vtkSMPToolsArena.reset();
+  vtkSMPToolsGlobalControl.reset();
+  vtkTBBNumSpecifiedThreads = 0;
+  if (numThreads > 0)
+  {
+    vtkSMPToolsGlobalControl.reset(new tbb::global_control(
+      tbb::global_control::max_allowed_parallelism, numThreads));
+    vtkSMPToolsArena.reset(new tbb::task_arena(numThreads));
+    vtkTBBNumSpecifiedThreads = numThreads;
+  }
+}
+
+int vtk::detail::smp::vtkSMPTools_Impl_GetNumberOfThreads_TBB()
+{
+  return vtkTBBNumSpecifiedThreads ? vtkTBBNumSpecifiedThreads
+    : tbb::this_task_arena::max_concurrency();
+}
+
+void vtk::detail::smp::vtkSMPTools_Impl_For_TBB(vtkIdType first,
+  vtkIdType last, vtkIdType grain, ExecuteFunctorPtrType functorExecuter,
+  void *functor)
+{
+  vtkSMPScopeState state = { TBB, GetMaxNumberOfThreadsInScope() };
+  vtkSMPToolsFuncCall call(functorExecuter, functor, state);
+  tbb::blocked_range<vtkIdType> range(first, last, grain > 0 ? grain : 1);
+
+  if (state.MaxNumberOfThreads > 0 &&
+      state.MaxNumberOfThreads < vtkSMPTools_Impl_GetNumberOfThreads_TBB())
+  {
+    // Run in an arena limited to the requested concurrency.
+    tbb::task_arena arena(state.MaxNumberOfThreads);
+    arena.execute([&range, &call] { tbb::parallel_for(range, call); });
+  }
+  else if (vtkSMPToolsArena)
+  {
+    vtkSMPToolsArena->execute(
+      [&range, &call] { tbb::parallel_for(range, call); });
+  }
+  else
+  {
+    tbb::parallel_for(range, call);
+  }
+}
@@ -13,12 +13,22 @@
 
 =========================================================================*/
 #include "vtkSMPThreadLocal.h"
+#include "vtkIdTypeArray.h"
 #include "vtkNew.h"
 #include "vtkObject.h"
 #include "vtkObjectFactory.h"
 #include "vtkSMPTools.h"
 #include "vtkSMPThreadLocalObject.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <functional>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <thread>
 #include <vector>
 
 static const int Target = 10000;
@@ -91,13 +101,53 @@ public:
 
 };
 
+// Functor calling vtkSMPTools::For() from within a parallel section.
+class NestedFunctor
+{
+public:
+  std::atomic<int> Counter;
+
+  NestedFunctor()
+  {
+    this->Counter = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i=begin; i<end; i++)
+    {
+      ARangeFunctor inner;
+      vtkSMPTools::For(0, 100, inner);
+      for (vtkSMPThreadLocal<int>::iterator it = inner.Counter.begin();
+           it != inner.Counter.end(); ++it)
+      {
+        this->Counter += *it;
+      }
+    }
+  }
+};
+
+// Functor recording the threads executing it.
+class ThreadIdsFunctor
+{
+public:
+  std::mutex Lock;
+  std::set<std::thread::id> Ids;
+
+  void operator()(vtkIdType, vtkIdType)
+  {
+    // Give the other threads a chance to pick up some work.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::lock_guard<std::mutex> guard(this->Lock);
+    this->Ids.insert(std::this_thread::get_id());
+  }
+};
+
 // For sorting comparison
 bool myComp (double a, double b) { return (a<b); }
 
-int TestSMP(int, char*[])
+static int TestSMPBackend()
 {
-  //vtkSMPTools::Initialize(8);
-
   ARangeFunctor functor1;
 
   vtkSMPTools::For(0, Target, functor1);
@@ -140,6 +190,15 @@ int TestSMP(int, char*[])
     return 1;
   }
 
+  NestedFunctor functor3;
+
+  vtkSMPTools::For(0, 100, 1, functor3);
+  if (functor3.Counter != 100 * 100)
+  {
+    cerr << "Error: NestedFunctor did not generate " << 100 * 100 << endl;
+    return 1;
+  }
+
   // Test sorting
   double data0[] = {2,1,0,3,9,6,7,3,8,4,5};
   std::vector<double> myvector (data0, data0+11);
@@ -167,5 +226,176 @@ int TestSMP(int, char*[])
     }
   }
 
+  // Test the parallel algorithms on a range large enough to be split
+  const vtkIdType n = 100003;
+  std::vector<vtkIdType> counts(n);
+  vtkSMPTools::Fill(counts.begin(), counts.end(), 3);
+  vtkSMPTools::Transform(counts.begin(), counts.end(), counts.begin(),
+    [](vtkIdType count) { return count - 1; });
+  if (std::count(counts.begin(), counts.end(), 2) != n)
+  {
+    cerr << "Error: Bad fill or transform!" << endl;
+    return 1;
+  }
+
+  std::vector<vtkIdType> sequence(n);
+  std::iota(sequence.begin(), sequence.end(), 0);
+  vtkSMPTools::Transform(sequence.begin(), sequence.end(), counts.begin(),
+    counts.begin(), [](vtkIdType i, vtkIdType count) { return i % 5 + count; });
+  if (vtkSMPTools::Reduce(counts.begin(), counts.end(), vtkIdType(0)) !=
+      std::accumulate(counts.begin(), counts.end(), vtkIdType(0)))
+  {
+    cerr << "Error: Bad reduction!" << endl;
+    return 1;
+  }
+  // Non commutative operation: the partial results must be combined in order
+  vtkIdType last = vtkSMPTools::Reduce(sequence.begin(), sequence.end(),
+    vtkIdType(-1), [](vtkIdType, vtkIdType b) { return b; });
+  if (last != n - 1)
+  {
+    cerr << "Error: Bad ordered reduction!" << endl;
+    return 1;
+  }
+
+  std::vector<vtkIdType> offsets(n);
+  vtkIdType sum = vtkSMPTools::ExclusiveScan(counts.begin(), counts.end(),
+    offsets.begin(), vtkIdType(10));
+  vtkIdType expected = 10;
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    if (offsets[i] != expected)
+    {
+      cerr << "Error: Bad exclusive scan!" << endl;
+      return 1;
+    }
+    expected += counts[i];
+  }
+  if (sum != expected)
+  {
+    cerr << "Error: Bad exclusive scan total!" << endl;
+    return 1;
+  }
+
+  // In place inclusive scan
+  sum = vtkSMPTools::InclusiveScan(counts.begin(), counts.end(),
+    counts.begin(), vtkIdType(10));
+  for (vtkIdType i = 0; i < n - 1; ++i)
+  {
+    if (counts[i] != offsets[i + 1])
+    {
+      cerr << "Error: Bad inclusive scan!" << endl;
+      return 1;
+    }
+  }
+  if (sum != expected || counts[n - 1] != expected)
+  {
+    cerr << "Error: Bad inclusive scan total!" << endl;
+    return 1;
+  }
+
+  // Data arrays
+  vtkNew<vtkIdTypeArray> countArray;
+  countArray->SetNumberOfValues(n);
+  vtkSMPTools::Fill(countArray.GetPointer(), 2);
+  vtkNew<vtkIdTypeArray> offsetArray;
+  sum = vtkSMPTools::ExclusiveScan(countArray.GetPointer(),
+    offsetArray.GetPointer(), 0);
+  if (sum != 2 * n || offsetArray->GetNumberOfValues() != n ||
+      offsetArray->GetValue(n - 1) != 2 * (n - 1) ||
+      vtkSMPTools::Reduce(countArray.GetPointer(), vtkIdType(0)) != 2 * n)
+  {
+    cerr << "Error: Bad data array scan!" << endl;
+    return 1;
+  }
+  vtkSMPTools::Transform(offsetArray.GetPointer(), countArray.GetPointer(),
+    [](vtkIdType offset) { return offset / 2; });
+  if (countArray->GetValue(n - 1) != n - 1)
+  {
+    cerr << "Error: Bad data array transform!" << endl;
+    return 1;
+  }
+
+  // Sort a range large enough to be sorted in parallel runs, with duplicates
+  std::vector<vtkIdType> values(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    values[i] = (i * 7919) % 5003;
+  }
+  std::vector<vtkIdType> sorted(values);
+  std::sort(sorted.begin(), sorted.end(), std::greater<vtkIdType>());
+  vtkSMPTools::Sort(values.begin(), values.end(), std::greater<vtkIdType>());
+  if (values != sorted)
+  {
+    cerr << "Error: Bad parallel sort!" << endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+int TestSMP(int, char*[])
+{
+  //vtkSMPTools::Initialize(8);
+
+  std::string defaultBackend = vtkSMPTools::GetBackend();
+  const char* backends[] = { "Sequential", "STDThread", "OpenMP", "TBB" };
+  for (int i=0; i < 4; ++i)
+  {
+    if (!vtkSMPTools::IsBackendAvailable(backends[i]))
+    {
+      continue;
+    }
+    int result = 1;
+    vtkSMPTools::LocalScope(vtkSMPTools::Config(backends[i]), [&]() {
+      result = strcmp(vtkSMPTools::GetBackend(), backends[i]) == 0 ?
+        TestSMPBackend() : 1;
+    });
+    if (result)
+    {
+      cerr << "Error: " << backends[i] << " backend failed" << endl;
+      return result;
+    }
+    if (defaultBackend != vtkSMPTools::GetBackend())
+    {
+      cerr << "Error: the backend was not restored" << endl;
+      return 1;
+    }
+
+    // A scope caps the number of threads of the operations run within it,
+    // including the nested ones, and an inner scope cannot raise the cap.
+    int maxThreads = 0;
+    int estimatedThreads = 0;
+    ThreadIdsFunctor functor;
+    NestedFunctor nested;
+    vtkSMPTools::LocalScope(vtkSMPTools::Config(2, backends[i]), [&]() {
+      vtkSMPTools::LocalScope(vtkSMPTools::Config(8), [&]() {
+        estimatedThreads = vtkSMPTools::GetEstimatedNumberOfThreads();
+        vtkSMPTools::For(0, 100, 1, functor);
+        vtkSMPTools::For(0, 100, 1, nested);
+      });
+      maxThreads = vtkSMPTools::GetEstimatedNumberOfThreads();
+    });
+    if (estimatedThreads > 2 || maxThreads > 2 || functor.Ids.size() > 2 ||
+        nested.Counter != 100 * 100)
+    {
+      cerr << "Error: " << backends[i] << " used too many threads" << endl;
+      return 1;
+    }
+  }
+
+  if (vtkSMPTools::SetBackend("NotABackend") ||
+      defaultBackend != vtkSMPTools::GetBackend())
+  {
+    cerr << "Error: an unknown backend was accepted" << endl;
+    return 1;
+  }
+  if (!vtkSMPTools::SetBackend("Sequential") ||
+      strcmp(vtkSMPTools::GetBackend(), "Sequential") != 0)
+  {
+    cerr << "Error: cannot select the Sequential backend" << endl;
+    return 1;
+  }
+  vtkSMPTools::SetBackend(defaultBackend.c_str());
+
   return 0;
 }
@@ -185,6 +185,16 @@ public:
                     int deleteMethod) override;
   //@}
 
+  /**
+   * Set the function called instead of the one given by the delete method
+   * of SetArray() to release the data when the array is deleted or
+   * resized. This is useful when the data are not allocated by malloc or
+   * new, e.g. when they belong to a memory map. The function may hold a
+   * reference to the owner of the data, released with the function.
+   */
+  void SetArrayFreeFunction(
+    typename vtkBuffer<ValueType>::FreeFunctionType callback);
+
   // Overridden for optimized implementations:
   void SetTuple(vtkIdType tupleIdx, const float *tuple) override;
   void SetTuple(vtkIdType tupleIdx, const double *tuple) override;
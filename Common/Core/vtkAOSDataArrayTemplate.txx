@@ -92,6 +92,15 @@ void vtkAOSDataArrayTemplate<ValueTypeT>
   this->SetArray(static_cast<ValueType*>(array), size, save, deleteMethod);
 }
 
+//-----------------------------------------------------------------------------
+template <class ValueTypeT>
+void vtkAOSDataArrayTemplate<ValueTypeT>
+::SetArrayFreeFunction(
+  typename vtkBuffer<ValueType>::FreeFunctionType callback)
+{
+  this->Buffer->SetFreeFunction(false, std::move(callback));
+}
+
 //-----------------------------------------------------------------------------
 template <class ValueTypeT>
 void vtkAOSDataArrayTemplate<ValueTypeT>::SetTuple(vtkIdType tupleIdx,
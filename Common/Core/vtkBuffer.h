@@ -28,12 +28,16 @@
 #include "vtkObject.h"
 #include "vtkObjectFactory.h" // New() implementation
 
+#include <functional> // for std::function
+#include <utility> // for std::move
+
 template <class ScalarTypeT>
 class vtkBuffer : public vtkObject
 {
 public:
   vtkTemplateTypeMacro(vtkBuffer<ScalarTypeT>, vtkObject)
   typedef ScalarTypeT ScalarType;
+  typedef std::function<void(void*)> FreeFunctionType;
 
   static vtkBuffer<ScalarTypeT>* New();
 
@@ -53,6 +57,16 @@ public:
   void SetBuffer(ScalarType* array, vtkIdType size, bool save=false,
                  void (*deleteFunction)(void*)=free);
 
+  /**
+   * Set the free function used to release the current buffer. If
+   * @a noFreeFunction is true, the buffer will not be freed when this
+   * vtkBuffer object is deleted or resized. The function may hold the
+   * context needed to release the buffer, e.g. a reference to its owner;
+   * it is destroyed once it has released the buffer.
+   */
+  void SetFreeFunction(bool noFreeFunction,
+                       FreeFunctionType deleteFunction=free);
+
   /**
    * Return the number of elements the current buffer can hold.
    */
@@ -86,7 +100,7 @@ protected:
   ScalarType *Pointer;
   vtkIdType Size;
   bool Save;
-  void (*DeleteFunction)(void*);
+  FreeFunctionType DeleteFunction;
 
 private:
   vtkBuffer(const vtkBuffer&) = delete;
@@ -118,6 +132,16 @@ void vtkBuffer<ScalarT>::SetBuffer(
   this->DeleteFunction = deleteFunction;
 }
 
+//------------------------------------------------------------------------------
+template <typename ScalarT>
+void vtkBuffer<ScalarT>::SetFreeFunction(
+    bool noFreeFunction,
+    typename vtkBuffer<ScalarT>::FreeFunctionType deleteFunction)
+{
+  this->Save = noFreeFunction;
+  this->DeleteFunction = std::move(deleteFunction);
+}
+
 //------------------------------------------------------------------------------
 template <typename ScalarT>
 bool vtkBuffer<ScalarT>::Allocate(vtkIdType size)
@@ -144,8 +168,10 @@ bool vtkBuffer<ScalarT>::Reallocate(vtkIdType newsize)
 {
   if (newsize == 0) { return this->Allocate(0); }
 
+  void (*const* deleteFunction)(void*) =
+    this->DeleteFunction.template target<void (*)(void*)>();
   if (this->Pointer &&
-      (this->Save || this->DeleteFunction != free))
+      (this->Save || !deleteFunction || *deleteFunction != free))
   {
     ScalarType* newArray =
         static_cast<ScalarType*>(malloc(newsize * sizeof(ScalarType)));
@@ -1,115 +1,111 @@
 set(VTK_SMP_IMPLEMENTATION_TYPE "Sequential"
-  CACHE STRING "Which multi-threaded parallelism implementation to use. Options are Sequential, OpenMP or TBB")
+  CACHE STRING "Which multi-threaded parallelism implementation to use by default. Options are Sequential, STDThread, OpenMP or TBB")
 set_property(CACHE VTK_SMP_IMPLEMENTATION_TYPE
   PROPERTY
-    STRINGS Sequential OpenMP TBB)
+    STRINGS Sequential STDThread OpenMP TBB)
 
 if (NOT (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "OpenMP" OR
-         VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "TBB"))
+         VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "TBB" OR
+         VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "STDThread"))
   set_property(CACHE VTK_SMP_IMPLEMENTATION_TYPE
     PROPERTY
       VALUE "Sequential")
 endif ()
 
-set(vtk_smp_headers_to_configure)
+# The Sequential and STDThread backends are always available. OpenMP and TBB
+# are compiled in on request (or when selected as the default backend) and
+# the backend actually used is chosen at runtime, see vtkSMPTools::SetBackend.
+option(VTK_SMP_ENABLE_OPENMP "Compile the OpenMP vtkSMPTools backend" OFF)
+option(VTK_SMP_ENABLE_TBB "Compile the TBB vtkSMPTools backend" OFF)
+mark_as_advanced(VTK_SMP_ENABLE_OPENMP VTK_SMP_ENABLE_TBB)
+
+if (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "OpenMP")
+  set(VTK_SMP_ENABLE_OPENMP ON)
+elseif (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "TBB")
+  set(VTK_SMP_ENABLE_TBB ON)
+endif ()
+
 set(vtk_smp_defines)
-set(vtk_smp_use_default_atomics ON)
 
-if (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "TBB")
+find_package(Threads REQUIRED)
+list(APPEND vtk_smp_libraries
+  ${CMAKE_THREAD_LIBS_INIT})
+list(APPEND vtk_smp_sources
+  vtkSMPTools.cxx
+  vtkSMPThreadLocalImpl.cxx
+  "${CMAKE_CURRENT_SOURCE_DIR}/SMP/STDThread/vtkSMPToolsImpl.cxx")
+# The SMP headers are listed explicitly below and are not wrapped.
+set_source_files_properties(
+  vtkSMPTools.cxx
+  vtkSMPThreadLocalImpl.cxx
+  PROPERTIES SKIP_HEADER_INSTALL 1)
+
+if (VTK_SMP_ENABLE_TBB)
   find_package(TBB REQUIRED)
   list(APPEND vtk_smp_libraries
     ${TBB_LIBRARIES})
-  # This needs to public because all modules that include <vtkAtomic.h> need
-  # to include <tbb/atomic.h>.
+  # This needs to public because vtkSMPToolsInternal.h includes
+  # <tbb/parallel_sort.h>.
   list(APPEND vtk_smp_includes
     ${TBB_INCLUDE_DIRS})
 
-  set(vtk_smp_use_default_atomics OFF)
-  set(vtk_smp_implementation_dir "${CMAKE_CURRENT_SOURCE_DIR}/SMP/TBB")
   list(APPEND vtk_smp_sources
-    "${vtk_smp_implementation_dir}/vtkSMPTools.cxx")
-  list(APPEND vtk_smp_headers_to_configure
-    vtkAtomic.h
-    vtkSMPToolsInternal.h
-    vtkSMPThreadLocal.h)
+    "${CMAKE_CURRENT_SOURCE_DIR}/SMP/TBB/vtkSMPToolsImpl.cxx")
+endif ()
 
-elseif (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "OpenMP")
+if (VTK_SMP_ENABLE_OPENMP)
   find_package(OpenMP REQUIRED)
 
-  list(APPEND vtk_smp_defines
-    ${OpenMP_CXX_FLAGS})
   list(APPEND vtk_smp_libraries
     ${OpenMP_CXX_LIBRARIES})
 
-  set(vtk_smp_implementation_dir "${CMAKE_CURRENT_SOURCE_DIR}/SMP/OpenMP")
+  # Only the backend implementation is compiled with OpenMP.
+  set_source_files_properties(
+    "${CMAKE_CURRENT_SOURCE_DIR}/SMP/OpenMP/vtkSMPToolsImpl.cxx"
+    PROPERTIES
+      COMPILE_FLAGS "${OpenMP_CXX_FLAGS}")
   list(APPEND vtk_smp_sources
-    "${vtk_smp_implementation_dir}/vtkSMPTools.cxx"
-    "${vtk_smp_implementation_dir}/vtkSMPThreadLocalImpl.cxx")
-  list(APPEND vtk_smp_headers_to_configure
-    vtkSMPThreadLocal.h
-    vtkSMPThreadLocalImpl.h
-    vtkSMPToolsInternal.h)
-
-  if (OpenMP_CXX_SPEC_DATE AND NOT "${OpenMP_CXX_SPEC_DATE}" LESS "201107")
-    set(vtk_smp_use_default_atomics OFF)
-    list(APPEND vtk_smp_sources
-      "${vtk_smp_implementation_dir}/vtkAtomic.cxx")
-    list(APPEND vtk_smp_headers_to_configure
-      vtkAtomic.h)
-  else()
-    message(WARNING
-      "Required OpenMP version (3.1) for atomics not detected. Using default "
-      "atomics implementation.")
-  endif()
-
-elseif (VTK_SMP_IMPLEMENTATION_TYPE STREQUAL "Sequential")
-  set(vtk_smp_implementation_dir "${CMAKE_CURRENT_SOURCE_DIR}/SMP/Sequential")
-  list(APPEND vtk_smp_sources
-    "${vtk_smp_implementation_dir}/vtkSMPTools.cxx")
-  list(APPEND vtk_smp_headers_to_configure
-    vtkSMPThreadLocal.h
-    vtkSMPToolsInternal.h)
-endif()
-
-if (vtk_smp_use_default_atomics)
-  include(CheckSymbolExists)
+    "${CMAKE_CURRENT_SOURCE_DIR}/SMP/OpenMP/vtkSMPToolsImpl.cxx")
+endif ()
 
-  include("${CMAKE_CURRENT_SOURCE_DIR}/vtkTestBuiltins.cmake")
+configure_file(
+  "${CMAKE_CURRENT_SOURCE_DIR}/vtkSMP.h.in"
+  "${CMAKE_CURRENT_BINARY_DIR}/vtkSMP.h")
 
-  set(vtkAtomic_defines)
+# The atomics do not depend on the backend anymore since several backends may
+# be used by the same process.
+include(CheckSymbolExists)
 
-  # Check for atomic functions
-  if (WIN32)
-    check_symbol_exists(InterlockedAdd "windows.h" VTK_HAS_INTERLOCKEDADD)
+include("${CMAKE_CURRENT_SOURCE_DIR}/vtkTestBuiltins.cmake")
 
-    if (VTK_HAS_INTERLOCKEDADD)
-      list(APPEND vtkAtomic_defines "VTK_HAS_INTERLOCKEDADD")
-    endif ()
-  endif()
+set(vtkAtomic_defines)
 
-  set_source_files_properties(vtkAtomic.cxx
-    PROPERITES
-      COMPILE_DEFINITIONS "${vtkAtomic_defines}")
+# Check for atomic functions
+if (WIN32)
+  check_symbol_exists(InterlockedAdd "windows.h" VTK_HAS_INTERLOCKEDADD)
 
-  set(vtk_atomics_default_impl_dir "${CMAKE_CURRENT_SOURCE_DIR}/SMP/Sequential")
-  list(APPEND vtk_smp_sources
-    "${vtk_atomics_default_impl_dir}/vtkAtomic.cxx")
-  configure_file(
-    "${vtk_atomics_default_impl_dir}/vtkAtomic.h.in"
-    "${CMAKE_CURRENT_BINARY_DIR}/vtkAtomic.h")
-  list(APPEND vtk_smp_headers
-    "${CMAKE_CURRENT_BINARY_DIR}/vtkAtomic.h")
+  if (VTK_HAS_INTERLOCKEDADD)
+    list(APPEND vtkAtomic_defines "VTK_HAS_INTERLOCKEDADD")
+  endif ()
 endif()
 
-foreach (vtk_smp_header IN LISTS vtk_smp_headers_to_configure)
-  configure_file(
-    "${vtk_smp_implementation_dir}/${vtk_smp_header}.in"
-    "${CMAKE_CURRENT_BINARY_DIR}/${vtk_smp_header}"
-    COPYONLY)
-  list(APPEND vtk_smp_headers
-    "${CMAKE_CURRENT_BINARY_DIR}/${vtk_smp_header}")
-endforeach()
+set_source_files_properties(vtkAtomic.cxx
+  PROPERITES
+    COMPILE_DEFINITIONS "${vtkAtomic_defines}")
+
+set(vtk_atomics_default_impl_dir "${CMAKE_CURRENT_SOURCE_DIR}/SMP/Sequential")
+list(APPEND vtk_smp_sources
+  "${vtk_atomics_default_impl_dir}/vtkAtomic.cxx")
+configure_file(
+  "${vtk_atomics_default_impl_dir}/vtkAtomic.h.in"
+  "${CMAKE_CURRENT_BINARY_DIR}/vtkAtomic.h")
+list(APPEND vtk_smp_headers
+  "${CMAKE_CURRENT_BINARY_DIR}/vtkAtomic.h")
 
 list(APPEND vtk_smp_headers
+  "${CMAKE_CURRENT_BINARY_DIR}/vtkSMP.h"
+  vtkSMPThreadLocal.h
+  vtkSMPThreadLocalImpl.h
+  vtkSMPToolsInternal.h
   vtkSMPTools.h
   vtkSMPThreadLocalObject.h)
@@ -15,17 +15,16 @@
 
 #include "vtkSMPThreadLocalImpl.h"
 
-#include <omp.h>
-
 #include <algorithm>
 
 namespace detail
 {
 
+static std::mutex HashTableResizeLock;
+
 static ThreadIdType GetThreadId()
 {
-  static int threadPrivateData;
-#pragma omp threadprivate(threadPrivateData)
+  static thread_local int threadPrivateData;
   return &threadPrivateData;
 }
 
@@ -52,16 +51,16 @@ inline HashType GetHash(ThreadIdType id)
 class LockGuard
 {
 public:
-  LockGuard(omp_lock_t &lock, bool wait) : Lock(lock), Status(0)
+  LockGuard(std::mutex &lock, bool wait) : Lock(lock), Status(0)
   {
     if (wait)
     {
-      omp_set_lock(&this->Lock);
+      this->Lock.lock();
       this->Status = 1;
     }
     else
     {
-      this->Status = omp_test_lock(&this->Lock);
+      this->Status = this->Lock.try_lock() ? 1 : 0;
     }
   }
 
@@ -74,7 +73,7 @@ public:
   {
     if (this->Status)
     {
-      omp_unset_lock(&this->Lock);
+      this->Lock.unlock();
       this->Status = 0;
     }
   }
@@ -89,20 +88,18 @@ private:
   LockGuard(const LockGuard&);
   void operator=(const LockGuard&);
 
-  omp_lock_t &Lock;
+  std::mutex &Lock;
   int Status;
 };
 
 
 Slot::Slot()
-  : ThreadId(0), Storage(0)
+  : ThreadId(nullptr), Storage(nullptr)
 {
-  omp_init_lock(&this->ModifyLock);
 }
 
 Slot::~Slot()
 {
-  omp_destroy_lock(&this->ModifyLock);
 }
 
 
@@ -255,7 +252,7 @@ StoragePointerType& ThreadSpecific::GetStorage()
     slot = AcquireSlot(array, threadId, hash, firstAccess);
     if (!slot) // not enough room, resize
     {
-#     pragma omp critical (HashTableResize)
+      std::lock_guard<std::mutex> resizeGuard(HashTableResizeLock);
       if (this->Root == array)
       {
         HashTableArray *newArray = new HashTableArray(array->SizeLg + 1);
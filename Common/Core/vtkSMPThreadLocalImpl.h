@@ -33,11 +33,11 @@
 #define vtkSMPThreadLocalImpl_h
 
 #include "vtkCommonCoreModule.h" // For export macro
-#include "vtkAtomic.h"
 #include "vtkConfigure.h"
 #include "vtkSystemIncludes.h"
 
-#include <omp.h>
+#include <atomic> // For std::atomic
+#include <mutex> // For std::mutex
 
 
 namespace detail
@@ -50,8 +50,8 @@ typedef void* StoragePointerType;
 
 struct Slot
 {
-  vtkAtomic<ThreadIdType> ThreadId;
-  omp_lock_t ModifyLock;
+  std::atomic<ThreadIdType> ThreadId;
+  std::mutex ModifyLock;
   StoragePointerType Storage;
 
   Slot();
@@ -67,7 +67,7 @@ private:
 struct HashTableArray
 {
   size_t Size, SizeLg;
-  vtkAtomic<size_t> NumberOfEntries;
+  std::atomic<size_t> NumberOfEntries;
   Slot *Slots;
   HashTableArray *Prev;
 
@@ -91,8 +91,8 @@ public:
   size_t Size() const;
 
 private:
-  vtkAtomic<HashTableArray*> Root;
-  vtkAtomic<size_t> Count;
+  std::atomic<HashTableArray*> Root;
+  std::atomic<size_t> Count;
 
   friend class ThreadSpecificStorageIterator;
 };
@@ -0,0 +1,246 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPTools.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkSMPTools.h"
+
+#include <vtksys/SystemTools.hxx>
+
+#include <atomic>
+#include <cstdlib>
+
+using namespace vtk::detail::smp;
+
+namespace
+{
+const char *vtkSMPBackendNames[] = { "Sequential", "STDThread", "OpenMP",
+                                     "TBB" };
+
+// Configuration of the innermost vtkSMPScope of each thread.
+thread_local vtkSMPScopeState vtkSMPThreadScope = { -1, 0 };
+
+bool vtkSMPIsBackendAvailable(int backend)
+{
+  switch (backend)
+  {
+    case Sequential:
+    case STDThread:
+      return true;
+    case OpenMP:
+      return VTK_SMP_ENABLE_OPENMP != 0;
+    case TBB:
+      return VTK_SMP_ENABLE_TBB != 0;
+    default:
+      return false;
+  }
+}
+
+// Returns -1 when name is not the name of a compiled back-end.
+int vtkSMPGetBackendFromName(const char *name)
+{
+  for (int backend = Sequential; backend <= TBB; ++backend)
+  {
+    if (vtksys::SystemTools::Strucmp(name, vtkSMPBackendNames[backend]) == 0)
+    {
+      return vtkSMPIsBackendAvailable(backend) ? backend : -1;
+    }
+  }
+  return -1;
+}
+
+int vtkSMPGetInitialBackend()
+{
+  const char *name = std::getenv("VTK_SMP_BACKEND_IN_USE");
+  if (name && *name)
+  {
+    int backend = vtkSMPGetBackendFromName(name);
+    if (backend >= 0)
+    {
+      return backend;
+    }
+    vtkGenericWarningMacro("VTK_SMP_BACKEND_IN_USE is set to " << name
+      << " which is not an available vtkSMPTools backend, using "
+      << VTK_SMP_BACKEND << " instead.");
+  }
+  return vtkSMPGetBackendFromName(VTK_SMP_BACKEND);
+}
+
+std::atomic<int>& vtkSMPGlobalBackend()
+{
+  static std::atomic<int> backend(vtkSMPGetInitialBackend());
+  return backend;
+}
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPTools::Initialize(int numThreads)
+{
+  vtkSMPTools_Impl_Initialize_STDThread(numThreads);
+#if VTK_SMP_ENABLE_OPENMP
+  vtkSMPTools_Impl_Initialize_OpenMP(numThreads);
+#endif
+#if VTK_SMP_ENABLE_TBB
+  vtkSMPTools_Impl_Initialize_TBB(numThreads);
+#endif
+}
+
+//--------------------------------------------------------------------------------
+int vtkSMPTools::GetEstimatedNumberOfThreads()
+{
+  return GetNumberOfThreads();
+}
+
+//--------------------------------------------------------------------------------
+bool vtkSMPTools::SetBackend(const char *backend)
+{
+  int type = backend ? vtkSMPGetBackendFromName(backend) : -1;
+  if (type < 0)
+  {
+    return false;
+  }
+  vtkSMPGlobalBackend() = type;
+  return true;
+}
+
+//--------------------------------------------------------------------------------
+const char *vtkSMPTools::GetBackend()
+{
+  return vtkSMPBackendNames[GetBackendInUse()];
+}
+
+//--------------------------------------------------------------------------------
+bool vtkSMPTools::IsBackendAvailable(const char *backend)
+{
+  return backend && vtkSMPGetBackendFromName(backend) >= 0;
+}
+
+//--------------------------------------------------------------------------------
+vtkSMPScope::vtkSMPScope(int maxNumberOfThreads, const char *backend)
+  : Previous(vtkSMPThreadScope)
+{
+  if (backend && *backend)
+  {
+    int type = vtkSMPGetBackendFromName(backend);
+    if (type >= 0)
+    {
+      vtkSMPThreadScope.Backend = type;
+    }
+    else
+    {
+      vtkGenericWarningMacro(<< backend
+        << " is not an available vtkSMPTools backend, it is ignored.");
+    }
+  }
+  if (maxNumberOfThreads > 0 && (this->Previous.MaxNumberOfThreads <= 0 ||
+      maxNumberOfThreads < this->Previous.MaxNumberOfThreads))
+  {
+    vtkSMPThreadScope.MaxNumberOfThreads = maxNumberOfThreads;
+  }
+}
+
+//--------------------------------------------------------------------------------
+vtkSMPScope::vtkSMPScope(const vtkSMPScopeState &state)
+  : Previous(vtkSMPThreadScope)
+{
+  vtkSMPThreadScope = state;
+}
+
+//--------------------------------------------------------------------------------
+vtkSMPScope::~vtkSMPScope()
+{
+  vtkSMPThreadScope = this->Previous;
+}
+
+//--------------------------------------------------------------------------------
+vtkSMPScopeState vtk::detail::smp::GetScopeState()
+{
+  return vtkSMPThreadScope;
+}
+
+//--------------------------------------------------------------------------------
+BackendType vtk::detail::smp::GetBackendInUse()
+{
+  int backend = vtkSMPThreadScope.Backend;
+  return static_cast<BackendType>(
+    backend >= 0 ? backend : vtkSMPGlobalBackend().load());
+}
+
+//--------------------------------------------------------------------------------
+int vtk::detail::smp::GetMaxNumberOfThreadsInScope()
+{
+  return vtkSMPThreadScope.MaxNumberOfThreads;
+}
+
+//--------------------------------------------------------------------------------
+int vtk::detail::smp::GetNumberOfThreads()
+{
+  int numThreads = 1;
+  switch (GetBackendInUse())
+  {
+    case STDThread:
+      numThreads = vtkSMPTools_Impl_GetNumberOfThreads_STDThread();
+      break;
+#if VTK_SMP_ENABLE_OPENMP
+    case OpenMP:
+      numThreads = vtkSMPTools_Impl_GetNumberOfThreads_OpenMP();
+      break;
+#endif
+#if VTK_SMP_ENABLE_TBB
+    case TBB:
+      numThreads = vtkSMPTools_Impl_GetNumberOfThreads_TBB();
+      break;
+#endif
+    default:
+      break;
+  }
+
+  int maxNumThreads = vtkSMPThreadScope.MaxNumberOfThreads;
+  return (maxNumThreads > 0 && maxNumThreads < numThreads) ?
+    maxNumThreads : numThreads;
+}
+
+//--------------------------------------------------------------------------------
+void vtk::detail::smp::vtkSMPTools_Impl_For_Backend(BackendType backend,
+  vtkIdType first, vtkIdType last, vtkIdType grain,
+  ExecuteFunctorPtrType functorExecuter, void *functor)
+{
+  switch (backend)
+  {
+    case STDThread:
+      vtkSMPTools_Impl_For_STDThread(first, last, grain, functorExecuter,
+                                     functor);
+      break;
+#if VTK_SMP_ENABLE_OPENMP
+    case OpenMP:
+      vtkSMPTools_Impl_For_OpenMP(first, last, grain, functorExecuter,
+                                  functor);
+      break;
+#endif
+#if VTK_SMP_ENABLE_TBB
+    case TBB:
+      vtkSMPTools_Impl_For_TBB(first, last, grain, functorExecuter, functor);
+      break;
+#endif
+    default:
+      if (grain <= 0)
+      {
+        grain = last - first;
+      }
+      for (vtkIdType from = first; from < last; from += grain)
+      {
+        functorExecuter(functor, from, grain, last);
+      }
+      break;
+  }
+}
@@ -19,8 +19,22 @@
  * vtkSMPTools provides a set of utility functions that can
  * be used to parallelize parts of VTK code using multiple threads.
  * There are several back-end implementations of parallel functionality
- * (currently Sequential, TBB and X-Kaapi) that actual execution is
- * delegated to.
+ * (currently Sequential, STDThread, OpenMP and TBB) that actual execution
+ * is delegated to. STDThread is a pool of C++11 threads which does not
+ * require any external library; it supports nested calls to For().
+ *
+ * Sequential and STDThread are always compiled in, OpenMP and TBB when
+ * VTK_SMP_ENABLE_OPENMP and VTK_SMP_ENABLE_TBB are on. The back-end is
+ * selected at runtime: VTK_SMP_IMPLEMENTATION_TYPE gives the default one,
+ * which the VTK_SMP_BACKEND_IN_USE environment variable and SetBackend()
+ * override. LocalScope() runs code with another back-end and/or a cap on the
+ * number of threads, without affecting the other threads of the process:
+ *
+ * \code
+ * vtkSMPTools::LocalScope(vtkSMPTools::Config{ 4 }, [&]() {
+ *   contour->Update(); // at most 4 threads
+ * });
+ * \endcode
 */
 
 #ifndef vtkSMPTools_h
@@ -32,6 +46,13 @@
 #include "vtkSMPThreadLocal.h" // For Initialized
 #include "vtkSMPToolsInternal.h"
 
+#include <functional> // For std::plus
+#include <string> // For std::string
+#include <type_traits> // For std::enable_if
+
+class vtkAbstractArray;
+template <class ValueTypeT> class vtkAOSDataArrayTemplate;
+
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 #ifndef __VTK_WRAP__
@@ -129,6 +150,15 @@ class vtkSMPTools_Lookup_For<Functor const>
 public:
   typedef vtkSMPTools_FunctorInternal<Functor const, init> type;
 };
+
+// Used to tell the iterator and the data array overloads of the scans apart:
+// a pointer to a data array is not an iterator over values.
+template <typename Iterator, typename T>
+struct vtkSMPTools_Enable_If_Not_Array
+  : std::enable_if<!std::is_base_of<vtkAbstractArray,
+      typename std::remove_pointer<Iterator>::type>::value, T>
+{
+};
 } // namespace smp
 } // namespace detail
 } // namespace vtk
@@ -210,21 +240,76 @@ public:
    * not required as it is automatically called before the first
    * execution of any parallel code. However, it can be used to
    * control the maximum number of threads used when the back-end
-   * supports it (currently Simple and TBB only). Make sure to call
-   * it before any other parallel operation.
+   * supports it (currently STDThread, OpenMP and TBB). It applies to all the
+   * back-ends compiled in. Make sure to call it before any other parallel
+   * operation. Use LocalScope() to limit the number of threads of some
+   * operations only.
    * When using Kaapi, use the KAAPI_CPUCOUNT env. variable to control
    * the number of threads used in the thread pool.
    */
   static void Initialize(int numThreads=0);
 
   /**
-   * Get the estimated number of threads being used by the backend.
+   * Get the estimated number of threads being used by the backend in use
+   * by the calling thread, taking the cap of its LocalScope() into account.
    * This should be used as just an estimate since the number of threads may
    * vary dynamically and a particular task may not be executed on all the
    * available threads.
    */
   static int GetEstimatedNumberOfThreads();
 
+  /**
+   * Select the back-end used by the parallel operations of all the threads
+   * that are not within a LocalScope() selecting another one. Valid names
+   * are "Sequential", "STDThread", "OpenMP" and "TBB" (case insensitive).
+   * Returns false, and keeps the current back-end, if the requested one is
+   * not compiled in.
+   */
+  static bool SetBackend(const char* backend);
+
+  /**
+   * Get the name of the back-end used by the calling thread.
+   */
+  static const char* GetBackend();
+
+  /**
+   * Returns true if the given back-end is compiled in.
+   */
+  static bool IsBackendAvailable(const char* backend);
+
+  /**
+   * Settings of a LocalScope(). A MaxNumberOfThreads <= 0 and an empty
+   * Backend keep the settings of the enclosing scope.
+   */
+  struct Config
+  {
+    int MaxNumberOfThreads;
+    std::string Backend;
+
+    Config() : MaxNumberOfThreads(0) {}
+    Config(int maxNumberOfThreads)
+      : MaxNumberOfThreads(maxNumberOfThreads) {}
+    Config(std::string backend)
+      : MaxNumberOfThreads(0), Backend(backend) {}
+    Config(int maxNumberOfThreads, std::string backend)
+      : MaxNumberOfThreads(maxNumberOfThreads), Backend(backend) {}
+  };
+
+  /**
+   * Call lambda with the given settings applied to the calling thread. They
+   * also apply to all the parallel operations started from lambda, including
+   * nested ones executed by other threads. A scope within another one can
+   * lower its thread cap but not raise it. The previous settings are restored
+   * when lambda returns.
+   */
+  template <typename T>
+  static void LocalScope(Config const& config, T&& lambda)
+  {
+    vtk::detail::smp::vtkSMPScope scope(
+      config.MaxNumberOfThreads, config.Backend.c_str());
+    lambda();
+  }
+
   /**
    * A convenience method for sorting data. It is a drop in replacement for
    * std::sort(). Under the hood different methods are used. For example,
@@ -249,6 +334,198 @@ public:
     vtk::detail::smp::vtkSMPTools_Impl_Sort(begin,end,comp);
   }
 
+  /**
+   * A parallel drop in replacement for std::transform(). Writes
+   * transform(*it) to the output for every iterator it in [inBegin, inEnd).
+   * The iterators must be random access and transform may be called
+   * concurrently by several threads. The output may be the input.
+   */
+  template <typename InputIt, typename OutputIt, typename Functor>
+  static void Transform(InputIt inBegin, InputIt inEnd, OutputIt outBegin,
+                        Functor transform)
+  {
+    vtk::detail::smp::vtkSMPTools_Impl_Transform(
+      inBegin, inEnd, outBegin, transform);
+  }
+
+  /**
+   * Binary version of Transform(). Writes transform(*it1, *it2) to the
+   * output, it2 walking the second input range in lock step with it1.
+   */
+  template <typename InputIt1, typename InputIt2, typename OutputIt,
+            typename Functor>
+  static void Transform(InputIt1 inBegin1, InputIt1 inEnd, InputIt2 inBegin2,
+                        OutputIt outBegin, Functor transform)
+  {
+    vtk::detail::smp::vtkSMPTools_Impl_Transform(
+      inBegin1, inEnd, inBegin2, outBegin, transform);
+  }
+
+  /**
+   * A parallel drop in replacement for std::fill(). The iterators must be
+   * random access.
+   */
+  template <typename Iterator, typename T>
+  static void Fill(Iterator begin, Iterator end, const T& value)
+  {
+    vtk::detail::smp::vtkSMPTools_Impl_Fill(begin, end, value);
+  }
+
+  //@{
+  /**
+   * Parallel reduction of [begin, end) with op, starting with init; a
+   * parallel replacement for std::accumulate(). op must be associative and
+   * may be called concurrently, however it does not need to be commutative:
+   * the partial results are always combined in order. Note that the result
+   * of a floating point reduction may differ from the one of a serial loop
+   * in the last bits since the sums are done in a different order.
+   * The default op is std::plus.
+   */
+  template <typename Iterator, typename T, typename BinaryOp>
+  static T Reduce(Iterator begin, Iterator end, T init, BinaryOp op)
+  {
+    return vtk::detail::smp::vtkSMPTools_Impl_Reduce(begin, end, init, op);
+  }
+  template <typename Iterator, typename T>
+  static T Reduce(Iterator begin, Iterator end, T init)
+  {
+    return vtkSMPTools::Reduce(begin, end, init, std::plus<T>());
+  }
+  //@}
+
+  //@{
+  /**
+   * Parallel exclusive prefix scan: the i-th output value is the reduction
+   * of init and the values before the i-th input value. Returns the
+   * reduction of init and all the values, so scanning per item counts with
+   * init = 0 gives both the output offsets and the size of the output. op
+   * must be associative and the iterators random access. The scan may be
+   * done in place (out == begin). The default op is std::plus.
+   */
+  template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+  static T ExclusiveScan(InputIt begin, InputIt end, OutputIt out, T init,
+                         BinaryOp op)
+  {
+    return vtk::detail::smp::vtkSMPTools_Impl_Scan<false>(
+      begin, end, out, init, op);
+  }
+  template <typename InputIt, typename OutputIt, typename T>
+  static typename vtk::detail::smp::vtkSMPTools_Enable_If_Not_Array<
+    InputIt, T>::type
+  ExclusiveScan(InputIt begin, InputIt end, OutputIt out, T init)
+  {
+    return vtkSMPTools::ExclusiveScan(begin, end, out, init, std::plus<T>());
+  }
+  //@}
+
+  //@{
+  /**
+   * Parallel inclusive prefix scan: the i-th output value is the reduction
+   * of init and the values up to and including the i-th input value.
+   * Returns the reduction of init and all the values. Same requirements as
+   * ExclusiveScan().
+   */
+  template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+  static T InclusiveScan(InputIt begin, InputIt end, OutputIt out, T init,
+                         BinaryOp op)
+  {
+    return vtk::detail::smp::vtkSMPTools_Impl_Scan<true>(
+      begin, end, out, init, op);
+  }
+  template <typename InputIt, typename OutputIt, typename T>
+  static typename vtk::detail::smp::vtkSMPTools_Enable_If_Not_Array<
+    InputIt, T>::type
+  InclusiveScan(InputIt begin, InputIt end, OutputIt out, T init)
+  {
+    return vtkSMPTools::InclusiveScan(begin, end, out, init, std::plus<T>());
+  }
+  //@}
+
+  //@{
+  /**
+   * Versions of the above operating on all the values of data arrays with
+   * an array of structures layout (vtkIdTypeArray, vtkFloatArray...). The
+   * output array of Transform() and of the scans is resized to the number
+   * of values of the input array when it is smaller; its number of
+   * components is left unchanged.
+   */
+  template <typename InValueType, typename OutValueType, typename Functor>
+  static void Transform(vtkAOSDataArrayTemplate<InValueType>* in,
+                        vtkAOSDataArrayTemplate<OutValueType>* out,
+                        Functor transform)
+  {
+    vtkIdType n = in->GetNumberOfValues();
+    vtkSMPTools::ResizeOutput(out, n);
+    vtkSMPTools::Transform(in->GetPointer(0), in->GetPointer(0) + n,
+                           out->GetPointer(0), transform);
+  }
+  template <typename ValueType, typename T>
+  static void Fill(vtkAOSDataArrayTemplate<ValueType>* array, const T& value)
+  {
+    ValueType* begin = array->GetPointer(0);
+    vtkSMPTools::Fill(begin, begin + array->GetNumberOfValues(),
+                      static_cast<ValueType>(value));
+  }
+  template <typename ValueType, typename T, typename BinaryOp>
+  static T Reduce(vtkAOSDataArrayTemplate<ValueType>* array, T init,
+                  BinaryOp op)
+  {
+    ValueType* begin = array->GetPointer(0);
+    return vtkSMPTools::Reduce(begin, begin + array->GetNumberOfValues(),
+                               init, op);
+  }
+  template <typename ValueType, typename T>
+  static T Reduce(vtkAOSDataArrayTemplate<ValueType>* array, T init)
+  {
+    return vtkSMPTools::Reduce(array, init, std::plus<T>());
+  }
+  template <typename InValueType, typename OutValueType, typename T,
+            typename BinaryOp>
+  static T ExclusiveScan(vtkAOSDataArrayTemplate<InValueType>* in,
+                         vtkAOSDataArrayTemplate<OutValueType>* out, T init,
+                         BinaryOp op)
+  {
+    vtkIdType n = in->GetNumberOfValues();
+    vtkSMPTools::ResizeOutput(out, n);
+    return vtkSMPTools::ExclusiveScan(in->GetPointer(0), in->GetPointer(0) + n,
+                                      out->GetPointer(0), init, op);
+  }
+  template <typename InValueType, typename OutValueType, typename T>
+  static T ExclusiveScan(vtkAOSDataArrayTemplate<InValueType>* in,
+                         vtkAOSDataArrayTemplate<OutValueType>* out, T init)
+  {
+    return vtkSMPTools::ExclusiveScan(in, out, init, std::plus<T>());
+  }
+  template <typename InValueType, typename OutValueType, typename T,
+            typename BinaryOp>
+  static T InclusiveScan(vtkAOSDataArrayTemplate<InValueType>* in,
+                         vtkAOSDataArrayTemplate<OutValueType>* out, T init,
+                         BinaryOp op)
+  {
+    vtkIdType n = in->GetNumberOfValues();
+    vtkSMPTools::ResizeOutput(out, n);
+    return vtkSMPTools::InclusiveScan(in->GetPointer(0), in->GetPointer(0) + n,
+                                      out->GetPointer(0), init, op);
+  }
+  template <typename InValueType, typename OutValueType, typename T>
+  static T InclusiveScan(vtkAOSDataArrayTemplate<InValueType>* in,
+                         vtkAOSDataArrayTemplate<OutValueType>* out, T init)
+  {
+    return vtkSMPTools::InclusiveScan(in, out, init, std::plus<T>());
+  }
+  //@}
+
+private:
+  template <typename ValueType>
+  static void ResizeOutput(vtkAOSDataArrayTemplate<ValueType>* out,
+                           vtkIdType n)
+  {
+    if (out->GetNumberOfValues() < n)
+    {
+      out->SetNumberOfValues(n);
+    }
+  }
+
 };
 
 #endif
@@ -0,0 +1,567 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPToolsInternal.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+// Runtime dispatch of vtkSMPTools to the compiled back-ends.
+//
+// All the back-ends (Sequential, STDThread and, when enabled at configure
+// time, OpenMP and TBB) live in the same library. A For() erases the type of
+// its functor and is forwarded to the back-end in use by the calling thread:
+// the one of the innermost vtkSMPScope if any, the global one otherwise. A
+// scope may also cap the number of threads used by the parallel operations
+// executed within it; the back-ends propagate the scope of the calling thread
+// to the threads working on its behalf so nested operations honor it too.
+
+#ifndef vtkSMPToolsInternal_h
+#define vtkSMPToolsInternal_h
+
+#include "vtkCommonCoreModule.h" // For export macro
+#include "vtkSMP.h" // For VTK_SMP_ENABLE_TBB
+#include "vtkType.h" // For vtkIdType
+
+#include <algorithm> //for std::sort()
+#include <functional> // For std::less
+#include <iterator> // For std::iterator_traits
+#include <vector> // For std::vector
+
+#if VTK_SMP_ENABLE_TBB
+#include <tbb/parallel_sort.h> // For tbb::parallel_sort
+#endif
+
+#ifndef __VTK_WRAP__
+namespace vtk
+{
+namespace detail
+{
+namespace smp
+{
+
+enum BackendType
+{
+  Sequential = 0,
+  STDThread = 1,
+  OpenMP = 2,
+  TBB = 3
+};
+
+typedef void (*ExecuteFunctorPtrType)(void *, vtkIdType, vtkIdType, vtkIdType);
+
+/**
+ * Per thread SMP configuration. A Backend < 0 or a MaxNumberOfThreads <= 0
+ * means that the global setting applies.
+ */
+struct vtkSMPScopeState
+{
+  int Backend;
+  int MaxNumberOfThreads;
+};
+
+/**
+ * RAII helper changing the SMP configuration of the calling thread for its
+ * lifetime. A scope can lower the thread cap of an enclosing scope but never
+ * raise it.
+ */
+class VTKCOMMONCORE_EXPORT vtkSMPScope
+{
+public:
+  /**
+   * Use backend (if not null or empty) and at most maxNumberOfThreads threads
+   * (if > 0). An unknown or unavailable backend is ignored with a warning.
+   */
+  vtkSMPScope(int maxNumberOfThreads, const char *backend);
+
+  /**
+   * Adopt a state captured with GetScopeState(), typically the one of the
+   * thread that started the parallel operation.
+   */
+  explicit vtkSMPScope(const vtkSMPScopeState &state);
+
+  ~vtkSMPScope();
+
+private:
+  vtkSMPScopeState Previous;
+
+  vtkSMPScope(const vtkSMPScope&) = delete;
+  void operator=(const vtkSMPScope&) = delete;
+};
+
+VTKCOMMONCORE_EXPORT vtkSMPScopeState GetScopeState();
+
+/**
+ * The back-end used by the calling thread.
+ */
+VTKCOMMONCORE_EXPORT BackendType GetBackendInUse();
+
+/**
+ * The thread cap of the calling thread, 0 if there is none.
+ */
+VTKCOMMONCORE_EXPORT int GetMaxNumberOfThreadsInScope();
+
+/**
+ * The number of threads a parallel operation started by the calling thread
+ * may use.
+ */
+VTKCOMMONCORE_EXPORT int GetNumberOfThreads();
+
+VTKCOMMONCORE_EXPORT void vtkSMPTools_Impl_For_Backend(BackendType backend,
+  vtkIdType first, vtkIdType last, vtkIdType grain,
+  ExecuteFunctorPtrType functorExecuter, void *functor);
+
+// Back-end implementations, see SMP/<Backend>/vtkSMPToolsImpl.cxx.
+void vtkSMPTools_Impl_Initialize_STDThread(int numThreads);
+int vtkSMPTools_Impl_GetNumberOfThreads_STDThread();
+void vtkSMPTools_Impl_For_STDThread(vtkIdType first, vtkIdType last,
+  vtkIdType grain, ExecuteFunctorPtrType functorExecuter, void *functor);
+void vtkSMPTools_Impl_Initialize_OpenMP(int numThreads);
+int vtkSMPTools_Impl_GetNumberOfThreads_OpenMP();
+void vtkSMPTools_Impl_For_OpenMP(vtkIdType first, vtkIdType last,
+  vtkIdType grain, ExecuteFunctorPtrType functorExecuter, void *functor);
+void vtkSMPTools_Impl_Initialize_TBB(int numThreads);
+int vtkSMPTools_Impl_GetNumberOfThreads_TBB();
+void vtkSMPTools_Impl_For_TBB(vtkIdType first, vtkIdType last,
+  vtkIdType grain, ExecuteFunctorPtrType functorExecuter, void *functor);
+
+template <typename FunctorInternal>
+void ExecuteFunctor(void *functor, vtkIdType from, vtkIdType grain,
+                    vtkIdType last)
+{
+  vtkIdType to = from + grain;
+  if (to > last)
+  {
+    to = last;
+  }
+
+  FunctorInternal &fi = *reinterpret_cast<FunctorInternal*>(functor);
+  fi.Execute(from, to);
+}
+
+template <typename FunctorInternal>
+void vtkSMPTools_Impl_For(vtkIdType first, vtkIdType last,
+                                 vtkIdType grain, FunctorInternal& fi)
+{
+  vtkIdType n = last - first;
+  if (n <= 0)
+  {
+    return;
+  }
+
+  BackendType backend = GetBackendInUse();
+  if (backend == Sequential || GetMaxNumberOfThreadsInScope() == 1)
+  {
+    if (grain <= 0 || grain >= n)
+    {
+      fi.Execute(first, last);
+    }
+    else
+    {
+      for (vtkIdType from = first; from < last; from += grain)
+      {
+        fi.Execute(from, std::min(from + grain, last));
+      }
+    }
+  }
+  else if (grain >= n)
+  {
+    fi.Execute(first, last);
+  }
+  else
+  {
+    vtkSMPTools_Impl_For_Backend(backend, first, last, grain,
+                                 ExecuteFunctor<FunctorInternal>, &fi);
+  }
+}
+
+//--------------------------------------------------------------------------------
+// Transform, Fill, Reduce and Scan are built on vtkSMPTools_Impl_For() so that
+// they run on the back-end in use by the calling thread and honor the thread
+// cap of its scope. They fall back to a serial loop with the Sequential
+// back-end, when a single thread is available or when the range is too small
+// to be worth splitting.
+
+/**
+ * Minimum number of values processed by a chunk of a parallel Reduce, Scan
+ * or Sort.
+ */
+const vtkIdType vtkSMPMinimumChunkSize = 1024;
+
+/**
+ * The number of chunks a Reduce, Scan or Sort over n values is split into, 1
+ * when it should be executed serially.
+ */
+inline vtkIdType GetNumberOfChunks(vtkIdType n)
+{
+  if (GetBackendInUse() == Sequential || GetMaxNumberOfThreadsInScope() == 1)
+  {
+    return 1;
+  }
+  vtkIdType numChunks = static_cast<vtkIdType>(GetNumberOfThreads()) * 4;
+  vtkIdType maxNumChunks = n / vtkSMPMinimumChunkSize;
+  return std::max<vtkIdType>(std::min(numChunks, maxNumChunks), 1);
+}
+
+template <typename InputIt, typename OutputIt, typename Functor>
+struct vtkSMPTools_UnaryTransformCall
+{
+  InputIt In;
+  OutputIt Out;
+  Functor& Transform;
+
+  vtkSMPTools_UnaryTransformCall(InputIt in, OutputIt out, Functor& transform)
+    : In(in), Out(out), Transform(transform) {}
+
+  void Execute(vtkIdType begin, vtkIdType end)
+  {
+    InputIt it = this->In + begin;
+    OutputIt out = this->Out + begin;
+    for (vtkIdType i = begin; i < end; ++i, ++it, ++out)
+    {
+      *out = this->Transform(*it);
+    }
+  }
+};
+
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+          typename Functor>
+struct vtkSMPTools_BinaryTransformCall
+{
+  InputIt1 In1;
+  InputIt2 In2;
+  OutputIt Out;
+  Functor& Transform;
+
+  vtkSMPTools_BinaryTransformCall(InputIt1 in1, InputIt2 in2, OutputIt out,
+                                  Functor& transform)
+    : In1(in1), In2(in2), Out(out), Transform(transform) {}
+
+  void Execute(vtkIdType begin, vtkIdType end)
+  {
+    InputIt1 it1 = this->In1 + begin;
+    InputIt2 it2 = this->In2 + begin;
+    OutputIt out = this->Out + begin;
+    for (vtkIdType i = begin; i < end; ++i, ++it1, ++it2, ++out)
+    {
+      *out = this->Transform(*it1, *it2);
+    }
+  }
+};
+
+template <typename Iterator, typename T>
+struct vtkSMPTools_FillCall
+{
+  Iterator Begin;
+  const T& Value;
+
+  vtkSMPTools_FillCall(Iterator begin, const T& value)
+    : Begin(begin), Value(value) {}
+
+  void Execute(vtkIdType begin, vtkIdType end)
+  {
+    std::fill(this->Begin + begin, this->Begin + end, this->Value);
+  }
+};
+
+// Reduce chunk after chunk. The partial result of a chunk starts with its
+// first value so that no identity element is needed.
+template <typename Iterator, typename T, typename BinaryOp>
+struct vtkSMPTools_ReduceCall
+{
+  Iterator Begin;
+  vtkIdType Size;
+  vtkIdType ChunkSize;
+  BinaryOp& Op;
+  std::vector<T>& Partials;
+
+  vtkSMPTools_ReduceCall(Iterator begin, vtkIdType size, vtkIdType chunkSize,
+                         BinaryOp& op, std::vector<T>& partials)
+    : Begin(begin), Size(size), ChunkSize(chunkSize), Op(op),
+      Partials(partials) {}
+
+  void Execute(vtkIdType firstChunk, vtkIdType lastChunk)
+  {
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
+    {
+      vtkIdType begin = chunk * this->ChunkSize;
+      vtkIdType end = std::min(begin + this->ChunkSize, this->Size);
+      Iterator it = this->Begin + begin;
+      T value(*it);
+      for (++it, ++begin; begin < end; ++it, ++begin)
+      {
+        value = this->Op(value, *it);
+      }
+      this->Partials[chunk] = value;
+    }
+  }
+};
+
+// Serial scans returning the reduction of acc and all the input values.
+// The input value is read before the output is written so that a scan can
+// be done in place.
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+T ExclusiveScanSequential(InputIt begin, InputIt end, OutputIt out, T acc,
+                          BinaryOp& op)
+{
+  for (; begin != end; ++begin, ++out)
+  {
+    T next = op(acc, *begin);
+    *out = acc;
+    acc = next;
+  }
+  return acc;
+}
+
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+T InclusiveScanSequential(InputIt begin, InputIt end, OutputIt out, T acc,
+                          BinaryOp& op)
+{
+  for (; begin != end; ++begin, ++out)
+  {
+    acc = op(acc, *begin);
+    *out = acc;
+  }
+  return acc;
+}
+
+// Second pass of a parallel scan: each chunk is scanned starting with the
+// reduction of the chunks before it.
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp,
+          bool Inclusive>
+struct vtkSMPTools_ScanCall
+{
+  InputIt In;
+  OutputIt Out;
+  vtkIdType Size;
+  vtkIdType ChunkSize;
+  BinaryOp& Op;
+  const std::vector<T>& Offsets;
+
+  vtkSMPTools_ScanCall(InputIt in, OutputIt out, vtkIdType size,
+                       vtkIdType chunkSize, BinaryOp& op,
+                       const std::vector<T>& offsets)
+    : In(in), Out(out), Size(size), ChunkSize(chunkSize), Op(op),
+      Offsets(offsets) {}
+
+  void Execute(vtkIdType firstChunk, vtkIdType lastChunk)
+  {
+    for (vtkIdType chunk = firstChunk; chunk < lastChunk; ++chunk)
+    {
+      vtkIdType begin = chunk * this->ChunkSize;
+      vtkIdType end = std::min(begin + this->ChunkSize, this->Size);
+      if (Inclusive)
+      {
+        InclusiveScanSequential(this->In + begin, this->In + end,
+          this->Out + begin, this->Offsets[chunk], this->Op);
+      }
+      else
+      {
+        ExclusiveScanSequential(this->In + begin, this->In + end,
+          this->Out + begin, this->Offsets[chunk], this->Op);
+      }
+    }
+  }
+};
+
+//--------------------------------------------------------------------------------
+template <typename InputIt, typename OutputIt, typename Functor>
+void vtkSMPTools_Impl_Transform(InputIt inBegin, InputIt inEnd,
+                                OutputIt outBegin, Functor& transform)
+{
+  vtkIdType n = static_cast<vtkIdType>(inEnd - inBegin);
+  vtkSMPTools_UnaryTransformCall<InputIt, OutputIt, Functor> fi(
+    inBegin, outBegin, transform);
+  vtkSMPTools_Impl_For(0, n, 0, fi);
+}
+
+//--------------------------------------------------------------------------------
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+          typename Functor>
+void vtkSMPTools_Impl_Transform(InputIt1 inBegin1, InputIt1 inEnd,
+                                InputIt2 inBegin2, OutputIt outBegin,
+                                Functor& transform)
+{
+  vtkIdType n = static_cast<vtkIdType>(inEnd - inBegin1);
+  vtkSMPTools_BinaryTransformCall<InputIt1, InputIt2, OutputIt, Functor> fi(
+    inBegin1, inBegin2, outBegin, transform);
+  vtkSMPTools_Impl_For(0, n, 0, fi);
+}
+
+//--------------------------------------------------------------------------------
+template <typename Iterator, typename T>
+void vtkSMPTools_Impl_Fill(Iterator begin, Iterator end, const T& value)
+{
+  vtkIdType n = static_cast<vtkIdType>(end - begin);
+  vtkSMPTools_FillCall<Iterator, T> fi(begin, value);
+  vtkSMPTools_Impl_For(0, n, 0, fi);
+}
+
+//--------------------------------------------------------------------------------
+template <typename Iterator, typename T, typename BinaryOp>
+T vtkSMPTools_Impl_Reduce(Iterator begin, Iterator end, T init, BinaryOp& op)
+{
+  vtkIdType n = static_cast<vtkIdType>(end - begin);
+  vtkIdType numChunks = GetNumberOfChunks(n);
+  if (numChunks <= 1)
+  {
+    for (; begin != end; ++begin)
+    {
+      init = op(init, *begin);
+    }
+    return init;
+  }
+
+  vtkIdType chunkSize = (n + numChunks - 1) / numChunks;
+  numChunks = (n + chunkSize - 1) / chunkSize;
+  std::vector<T> partials(numChunks, init);
+  vtkSMPTools_ReduceCall<Iterator, T, BinaryOp> fi(
+    begin, n, chunkSize, op, partials);
+  vtkSMPTools_Impl_For(0, numChunks, 1, fi);
+
+  for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+  {
+    init = op(init, partials[chunk]);
+  }
+  return init;
+}
+
+//--------------------------------------------------------------------------------
+// Parallel scan in two passes over the data: the chunks are reduced in
+// parallel, the offsets of the chunks are computed serially from these
+// partial results, then the chunks are scanned in parallel.
+template <bool Inclusive, typename InputIt, typename OutputIt, typename T,
+          typename BinaryOp>
+T vtkSMPTools_Impl_Scan(InputIt begin, InputIt end, OutputIt out, T init,
+                        BinaryOp& op)
+{
+  vtkIdType n = static_cast<vtkIdType>(end - begin);
+  vtkIdType numChunks = GetNumberOfChunks(n);
+  if (numChunks <= 1)
+  {
+    return Inclusive ? InclusiveScanSequential(begin, end, out, init, op) :
+      ExclusiveScanSequential(begin, end, out, init, op);
+  }
+
+  vtkIdType chunkSize = (n + numChunks - 1) / numChunks;
+  numChunks = (n + chunkSize - 1) / chunkSize;
+  std::vector<T> partials(numChunks, init);
+  vtkSMPTools_ReduceCall<InputIt, T, BinaryOp> reduce(
+    begin, n, chunkSize, op, partials);
+  vtkSMPTools_Impl_For(0, numChunks, 1, reduce);
+
+  std::vector<T> offsets(numChunks, init);
+  for (vtkIdType chunk = 1; chunk < numChunks; ++chunk)
+  {
+    offsets[chunk] = op(offsets[chunk - 1], partials[chunk - 1]);
+  }
+  T total = op(offsets[numChunks - 1], partials[numChunks - 1]);
+
+  vtkSMPTools_ScanCall<InputIt, OutputIt, T, BinaryOp, Inclusive> scan(
+    begin, out, n, chunkSize, op, offsets);
+  vtkSMPTools_Impl_For(0, numChunks, 1, scan);
+  return total;
+}
+
+//--------------------------------------------------------------------------------
+// Without TBB, Sort() sorts chunks of the range in parallel, then merges
+// pairs of adjacent sorted runs in parallel until a single run is left.
+template <typename RandomAccessIterator, typename Compare>
+struct vtkSMPTools_SortCall
+{
+  const std::vector<RandomAccessIterator>& Bounds;
+  Compare& Comp;
+  vtkIdType Width;
+
+  vtkSMPTools_SortCall(const std::vector<RandomAccessIterator>& bounds,
+                       Compare& comp)
+    : Bounds(bounds), Comp(comp), Width(0) {}
+
+  void Execute(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType numRuns = static_cast<vtkIdType>(this->Bounds.size()) - 1;
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      if (this->Width == 0)
+      {
+        std::sort(this->Bounds[i], this->Bounds[i + 1], this->Comp);
+      }
+      else
+      {
+        vtkIdType first = i * 2 * this->Width;
+        vtkIdType middle = std::min(first + this->Width, numRuns);
+        vtkIdType last = std::min(first + 2 * this->Width, numRuns);
+        std::inplace_merge(this->Bounds[first], this->Bounds[middle],
+                           this->Bounds[last], this->Comp);
+      }
+    }
+  }
+};
+
+template<typename RandomAccessIterator, typename Compare>
+void vtkSMPTools_Impl_Sort(RandomAccessIterator begin,
+                                  RandomAccessIterator end,
+                                  Compare comp)
+{
+#if VTK_SMP_ENABLE_TBB
+  if (GetBackendInUse() == TBB)
+  {
+    tbb::parallel_sort(begin, end, comp);
+    return;
+  }
+#endif
+  vtkIdType n = static_cast<vtkIdType>(end - begin);
+  vtkIdType numRuns = GetNumberOfChunks(n);
+  if (numRuns <= 1)
+  {
+    std::sort(begin, end, comp);
+    return;
+  }
+
+  std::vector<RandomAccessIterator> bounds(numRuns + 1);
+  for (vtkIdType i = 0; i <= numRuns; ++i)
+  {
+    bounds[i] = begin + n * i / numRuns;
+  }
+  vtkSMPTools_SortCall<RandomAccessIterator, Compare> sortCall(bounds, comp);
+  vtkSMPTools_Impl_For(0, numRuns, 1, sortCall);
+  for (sortCall.Width = 1; sortCall.Width < numRuns; sortCall.Width *= 2)
+  {
+    vtkIdType numMerges = (numRuns + 2 * sortCall.Width - 1) /
+      (2 * sortCall.Width);
+    vtkSMPTools_Impl_For(0, numMerges, 1, sortCall);
+  }
+}
+
+//--------------------------------------------------------------------------------
+template<typename RandomAccessIterator>
+void vtkSMPTools_Impl_Sort(RandomAccessIterator begin,
+                                  RandomAccessIterator end)
+{
+#if VTK_SMP_ENABLE_TBB
+  if (GetBackendInUse() == TBB)
+  {
+    tbb::parallel_sort(begin, end);
+    return;
+  }
+#endif
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type
+    ValueType;
+  vtkSMPTools_Impl_Sort(begin, end, std::less<ValueType>());
+}
+
+}//namespace smp
+}//namespace detail
+}//namespace vtk
+
+#endif // __VTK_WRAP__
+
+#endif
+// VTK-HeaderTest-Exclude: vtkSMPToolsInternal.h
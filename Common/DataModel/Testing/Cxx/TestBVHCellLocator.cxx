@@ -0,0 +1,306 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBVHCellLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the queries of vtkBVHCellLocator with brute force searches over
+// all the cells, on a triangulated surface and on a hexahedral grid.
+
+#include "vtkBVHCellLocator.h"
+#include "vtkBox.h"
+#include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkStructuredGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// A sphere made of triangles.
+void MakeSphere(vtkPolyData *pd, int res)
+{
+  vtkNew<vtkPoints> pts;
+  vtkNew<vtkCellArray> tris;
+  for (int j = 0; j <= res; ++j)
+  {
+    double phi = vtkMath::Pi() * j / res;
+    for (int i = 0; i < 2*res; ++i)
+    {
+      double theta = vtkMath::Pi() * i / res;
+      pts->InsertNextPoint(sin(phi) * cos(theta), sin(phi) * sin(theta),
+                           cos(phi));
+    }
+  }
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < 2*res; ++i)
+    {
+      vtkIdType p0 = j * 2*res + i;
+      vtkIdType p1 = j * 2*res + (i + 1) % (2*res);
+      vtkIdType tri0[3] = { p0, p1, p0 + 2*res };
+      vtkIdType tri1[3] = { p1, p1 + 2*res, p0 + 2*res };
+      tris->InsertNextCell(3, tri0);
+      tris->InsertNextCell(3, tri1);
+    }
+  }
+  pd->SetPoints(pts);
+  pd->SetPolys(tris);
+}
+
+// A grid of hexahedra with jittered points.
+void MakeGrid(vtkStructuredGrid *sg, int res, vtkMinimalStandardRandomSequence *rnd)
+{
+  vtkNew<vtkPoints> pts;
+  for (int k = 0; k < res; ++k)
+  {
+    for (int j = 0; j < res; ++j)
+    {
+      for (int i = 0; i < res; ++i)
+      {
+        double x[3] = { static_cast<double>(i), static_cast<double>(j),
+                        static_cast<double>(k) };
+        for (int c = 0; c < 3; ++c)
+        {
+          x[c] += rnd->GetRangeValue(-0.2, 0.2);
+          rnd->Next();
+        }
+        pts->InsertNextPoint(x);
+      }
+    }
+  }
+  sg->SetDimensions(res, res, res);
+  sg->SetPoints(pts);
+}
+
+void RandomPoint(vtkMinimalStandardRandomSequence *rnd, const double bounds[6],
+                 double x[3])
+{
+  for (int c = 0; c < 3; ++c)
+  {
+    x[c] = rnd->GetRangeValue(bounds[2*c], bounds[2*c+1]);
+    rnd->Next();
+  }
+}
+
+bool SameIds(vtkIdList *ids, std::vector<vtkIdType> expected)
+{
+  std::vector<vtkIdType> found(ids->GetPointer(0),
+                               ids->GetPointer(0) + ids->GetNumberOfIds());
+  std::sort(found.begin(), found.end());
+  std::sort(expected.begin(), expected.end());
+  return found == expected;
+}
+
+int TestLocator(vtkDataSet *ds, vtkMinimalStandardRandomSequence *rnd,
+                int numQueries)
+{
+  vtkNew<vtkBVHCellLocator> locator;
+  locator->SetDataSet(ds);
+  locator->BuildLocator();
+
+  const vtkIdType numCells = ds->GetNumberOfCells();
+  if (locator->GetNumberOfNodes() < 2 * (numCells / 8) - 1)
+  {
+    cerr << "Too few nodes: " << locator->GetNumberOfNodes() << endl;
+    return 1;
+  }
+
+  double bounds[6];
+  ds->GetBounds(bounds);
+  for (int c = 0; c < 3; ++c)
+  {
+    double margin = 0.2 * (bounds[2*c+1] - bounds[2*c]);
+    bounds[2*c] -= margin;
+    bounds[2*c+1] += margin;
+  }
+
+  vtkNew<vtkGenericCell> cell;
+  vtkNew<vtkIdList> ids;
+  vtkNew<vtkPoints> starts;
+  vtkNew<vtkPoints> ends;
+  starts->SetDataTypeToDouble();
+  ends->SetDataTypeToDouble();
+  std::vector<vtkIdType> expectedHits;
+  std::vector<double> expectedT;
+  double weights[8], delta[3] = {0.0, 0.0, 0.0}, pcoords[3], point[3], x[3], t, dist2;
+  int subId;
+  int errors = 0;
+
+  for (int q = 0; q < numQueries; ++q)
+  {
+    double p1[3], p2[3];
+    RandomPoint(rnd, bounds, p1);
+    RandomPoint(rnd, bounds, p2);
+    starts->InsertNextPoint(p1);
+    ends->InsertNextPoint(p2);
+
+    // The closest intersection along the line
+    vtkIdType bestId = -1;
+    double tBest = VTK_DOUBLE_MAX;
+    std::vector<vtkIdType> alongLine;
+    double dir[3] = { p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2] };
+    for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+    {
+      ds->GetCell(cellId, cell);
+      if (cell->IntersectWithLine(p1, p2, 0.0, t, x, pcoords, subId) &&
+          t < tBest)
+      {
+        tBest = t;
+        bestId = cellId;
+      }
+      double cellBounds[6], hit[3];
+      ds->GetCellBounds(cellId, cellBounds);
+      if (vtkBox::IntersectBox(cellBounds, p1, dir, hit, t))
+      {
+        alongLine.push_back(cellId);
+      }
+    }
+    expectedHits.push_back(bestId);
+    expectedT.push_back(tBest);
+
+    vtkIdType cellId = -1;
+    int hit = locator->IntersectWithLine(p1, p2, 0.0, t, x, pcoords, subId,
+                                         cellId, cell);
+    if (hit != (bestId >= 0) || (hit && std::abs(t - tBest) > 1e-12))
+    {
+      cerr << "IntersectWithLine: expected " << bestId << " at " << tBest
+           << ", got " << cellId << " at " << t << endl;
+      ++errors;
+    }
+
+    locator->FindCellsAlongLine(p1, p2, 0.0, ids);
+    if (!SameIds(ids, alongLine))
+    {
+      cerr << "FindCellsAlongLine: expected " << alongLine.size()
+           << " cells, got " << ids->GetNumberOfIds() << endl;
+      ++errors;
+    }
+
+    // The closest point, the cell containing the point, the cells within
+    // bounds
+    double minDist2 = VTK_DOUBLE_MAX;
+    vtkIdType containingId = -1;
+    std::vector<vtkIdType> withinBounds;
+    double bbox[6] = { std::min(p1[0], p2[0]), std::max(p1[0], p2[0]),
+                       std::min(p1[1], p2[1]), std::max(p1[1], p2[1]),
+                       std::min(p1[2], p2[2]), std::max(p1[2], p2[2]) };
+    for (vtkIdType id = 0; id < numCells; ++id)
+    {
+      ds->GetCell(id, cell);
+      int inside = cell->EvaluatePosition(p1, point, subId, pcoords, dist2,
+                                          weights);
+      if (inside != -1)
+      {
+        minDist2 = std::min(minDist2, dist2);
+      }
+      double cellBounds[6];
+      ds->GetCellBounds(id, cellBounds);
+      if (inside == 1 && containingId < 0 &&
+          vtkMath::PointIsWithinBounds(p1, cellBounds, delta))
+      {
+        containingId = id;
+      }
+      if (cellBounds[0] <= bbox[1] && cellBounds[1] >= bbox[0] &&
+          cellBounds[2] <= bbox[3] && cellBounds[3] >= bbox[2] &&
+          cellBounds[4] <= bbox[5] && cellBounds[5] >= bbox[4])
+      {
+        withinBounds.push_back(id);
+      }
+    }
+
+    locator->FindClosestPoint(p1, point, cell, cellId, subId, dist2);
+    if (std::abs(dist2 - minDist2) > 1e-12 ||
+        std::abs(vtkMath::Distance2BetweenPoints(p1, point) - dist2) > 1e-9)
+    {
+      cerr << "FindClosestPoint: expected " << minDist2 << ", got " << dist2
+           << endl;
+      ++errors;
+    }
+
+    int inside;
+    double radius = 1.01 * sqrt(minDist2);
+    if (!locator->FindClosestPointWithinRadius(p1, radius, point, cell, cellId,
+                                               subId, dist2, inside) ||
+        std::abs(dist2 - minDist2) > 1e-12 ||
+        (minDist2 > 0.0 &&
+         locator->FindClosestPointWithinRadius(p1, 0.99 * sqrt(minDist2), point,
+                                              cell, cellId, subId, dist2,
+                                              inside)))
+    {
+      cerr << "FindClosestPointWithinRadius: wrong result" << endl;
+      ++errors;
+    }
+
+    cellId = locator->FindCell(p1, 0.0, cell, pcoords, weights);
+    if ((cellId < 0) != (containingId < 0))
+    {
+      cerr << "FindCell: expected " << containingId << ", got " << cellId
+           << endl;
+      ++errors;
+    }
+
+    locator->FindCellsWithinBounds(bbox, ids);
+    if (!SameIds(ids, withinBounds))
+    {
+      cerr << "FindCellsWithinBounds: expected " << withinBounds.size()
+           << " cells, got " << ids->GetNumberOfIds() << endl;
+      ++errors;
+    }
+  }
+
+  // The batched intersections
+  vtkNew<vtkIdTypeArray> hits;
+  vtkNew<vtkDoubleArray> ts;
+  vtkNew<vtkPoints> xs;
+  locator->IntersectWithLines(starts, ends, 0.0, hits, ts, xs);
+  for (int q = 0; q < numQueries; ++q)
+  {
+    if ((hits->GetValue(q) < 0) != (expectedHits[q] < 0) ||
+        (expectedHits[q] >= 0 && std::abs(ts->GetValue(q) - expectedT[q]) > 1e-12))
+    {
+      cerr << "IntersectWithLines: expected " << expectedHits[q] << ", got "
+           << hits->GetValue(q) << " for line " << q << endl;
+      ++errors;
+    }
+  }
+
+  return errors;
+}
+
+} // anonymous namespace
+
+int TestBVHCellLocator(int, char *[])
+{
+  vtkNew<vtkMinimalStandardRandomSequence> rnd;
+  rnd->SetSeed(8775070);
+
+  vtkNew<vtkPolyData> sphere;
+  MakeSphere(sphere, 40);
+  int errors = TestLocator(sphere, rnd, 200);
+
+  vtkNew<vtkStructuredGrid> grid;
+  MakeGrid(grid, 16, rnd);
+  errors += TestLocator(grid, rnd, 200);
+
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,453 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellArrayStorage.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellArray.h"
+#include "vtkCellType.h"
+#include "vtkCommand.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkTestErrorObserver.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkTypeInt64Array.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+const vtkIdType NumCells = 4;
+const vtkIdType Cells[] = {3, 0, 1, 2,
+                           4, 2, 3, 4, 5,
+                           1, 6,
+                           2, 7, 8};
+
+// Fill a cell array with the reference cells.
+void InsertCells(vtkCellArray *ca)
+{
+  ca->InsertNextCell(3, Cells + 1);
+  ca->InsertNextCell(4, Cells + 5);
+  ca->InsertNextCell(1);
+  ca->InsertCellPoint(6);
+  ca->UpdateCellCount(1);
+  ca->InsertNextCell(2, Cells + 12);
+}
+
+// Check the cells of ca against the reference cells using the sequential
+// traversal, the location based access and the random access. None of them
+// modifies the storage.
+bool CheckCells(vtkCellArray *ca, const char *label)
+{
+  if (ca->GetNumberOfCells() != NumCells ||
+      ca->GetNumberOfConnectivityEntries() !=
+        static_cast<vtkIdType>(sizeof(Cells)/sizeof(vtkIdType)))
+  {
+    cerr << label << ": wrong number of cells or entries" << endl;
+    return false;
+  }
+
+  int storageType = ca->GetStorageType();
+  vtkIdType npts, loc = 0;
+  vtkNew<vtkIdList> pts;
+  vtkNew<vtkIdList> ids;
+  ca->InitTraversal();
+  for (vtkIdType cellId=0; ca->GetNextCell(pts.GetPointer()); ++cellId)
+  {
+    npts = pts->GetNumberOfIds();
+    vtkIdType travLoc = ca->GetTraversalLocation(npts);
+    if (npts != Cells[loc] || travLoc != loc ||
+        ca->GetCellSize(cellId) != npts)
+    {
+      cerr << label << ": bad traversal of cell " << cellId << endl;
+      return false;
+    }
+
+    vtkIdType lnpts;
+    vtkIdType const* lpts;
+    ca->GetCell(travLoc, lnpts, lpts, ids.GetPointer());
+    vtkIdType const* rpts;
+    ca->GetCellAtId(cellId, npts, rpts, ids.GetPointer());
+    for (vtkIdType i=0; i < npts; ++i)
+    {
+      if (pts->GetId(i) != Cells[loc+1+i] || lpts[i] != Cells[loc+1+i] ||
+          rpts[i] != Cells[loc+1+i])
+      {
+        cerr << label << ": bad ids for cell " << cellId << endl;
+        return false;
+      }
+    }
+    loc += npts + 1;
+  }
+
+  if (ca->GetMaxCellSize() != 4 || ca->GetStorageType() != storageType)
+  {
+    cerr << label << ": bad max cell size or storage type" << endl;
+    return false;
+  }
+  return true;
+}
+
+// The pointers returned by GetNextCell() and GetCell() point into the cell
+// array: the ids written through them are kept, and several cells may be
+// held at once.
+bool CheckPointerAccess(vtkCellArray *ca, const char *label)
+{
+  vtkIdType npts, *pts;
+  vtkIdType loc = 0;
+  ca->InitTraversal();
+  for (vtkIdType cellId=0; ca->GetNextCell(npts, pts); ++cellId)
+  {
+    if (npts != Cells[loc] ||
+        !std::equal(pts, pts + npts, Cells + loc + 1))
+    {
+      cerr << label << ": bad traversal of cell " << cellId << endl;
+      return false;
+    }
+    loc += npts + 1;
+  }
+
+  vtkIdType npts0, *pts0, npts1, *pts1;
+  ca->GetCell(0, npts0, pts0);
+  ca->GetCell(4, npts1, pts1);
+  pts0[1] = 10;
+  pts1[3] = 11;
+  vtkNew<vtkIdList> ids;
+  ca->GetCellAtId(0, ids.GetPointer());
+  if (npts0 != 3 || pts0[0] != 0 || npts1 != 4 || pts1[0] != 2 ||
+      ids->GetId(1) != 10)
+  {
+    cerr << label << ": bad cells accessed through pointers" << endl;
+    return false;
+  }
+  ca->GetCellAtId(1, ids.GetPointer());
+  if (ids->GetId(3) != 11 || !ca->IsIdTypeStorage())
+  {
+    cerr << label << ": ids not written into the cell array" << endl;
+    return false;
+  }
+  pts0[1] = 1;
+  pts1[3] = 5;
+  return true;
+}
+
+// When the ids are not stored as vtkIdType, GetNextCell() returns copies of
+// the cells and GetCell(loc,npts,pts) fails; neither converts the storage.
+bool CheckCopyAccess(vtkCellArray *ca, vtkTest::ErrorObserver *observer,
+                     const char *label)
+{
+  int storageType = ca->GetStorageType();
+  for (int pass=0; pass < 2; ++pass)
+  {
+    vtkIdType npts, *pts;
+    vtkIdType loc = 0, cellId = 0;
+    for (ca->InitTraversal(); ca->GetNextCell(npts, pts); ++cellId)
+    {
+      if (npts != Cells[loc] ||
+          !std::equal(pts, pts + npts, Cells + loc + 1))
+      {
+        cerr << label << ": bad traversal of cell " << cellId << endl;
+        return false;
+      }
+      loc += npts + 1;
+    }
+    if (cellId != NumCells)
+    {
+      cerr << label << ": traversal " << pass << " visited " << cellId
+           << " cells" << endl;
+      return false;
+    }
+  }
+
+  vtkIdType npts = 1, *pts = nullptr;
+  ca->AddObserver(vtkCommand::ErrorEvent, observer);
+  ca->GetCell(4, npts, pts);
+  if (observer->CheckErrorMessage("Cannot return a vtkIdType pointer") ||
+      npts != 0 || pts != nullptr)
+  {
+    cerr << label << ": GetCell() returned a pointer" << endl;
+    return false;
+  }
+  if (ca->GetStorageType() != storageType)
+  {
+    cerr << label << ": the storage was converted" << endl;
+    return false;
+  }
+  return true;
+}
+
+// vtkPolyData and vtkUnstructuredGrid give access to the cells of a 32-bit
+// storage without converting it, and their cells can be read from several
+// threads at once.
+void InsertDataSetPoints(vtkPointSet *ds)
+{
+  vtkNew<vtkPoints> points;
+  for (vtkIdType i=0; i < 9; ++i)
+  {
+    points->InsertNextPoint(static_cast<double>(i), static_cast<double>(i*i),
+                            0.0);
+  }
+  ds->SetPoints(points.GetPointer());
+}
+
+// Read every cell of ds in parallel, each thread with its own id list and
+// generic cell, and compare with the reference cells: the cell cellId of ds
+// is the reference cell order[cellId].
+template <typename DataSetT>
+bool CheckParallelAccess(DataSetT *ds, const vtkIdType *order,
+                         const char *label)
+{
+  std::atomic<int> errors(0);
+  vtkSMPThreadLocalObject<vtkIdList> tlIds;
+  vtkSMPThreadLocalObject<vtkGenericCell> tlCell;
+  const vtkIdType numCells = ds->GetNumberOfCells();
+  vtkSMPTools::For(0, numCells * 1000, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *ids = tlIds.Local();
+    vtkGenericCell *cell = tlCell.Local();
+    for (vtkIdType i=begin; i < end; ++i)
+    {
+      vtkIdType cellId = i % numCells;
+      vtkIdType loc = 0;
+      for (vtkIdType j=0; j < order[cellId]; ++j)
+      {
+        loc += Cells[loc] + 1;
+      }
+      vtkIdType npts;
+      vtkIdType const* pts;
+      ds->GetCellPoints(cellId, npts, pts, ids);
+      ds->GetCell(cellId, cell);
+      if (npts != Cells[loc] || cell->GetNumberOfPoints() != npts ||
+          !std::equal(pts, pts + npts, Cells + loc + 1) ||
+          !std::equal(pts, pts + npts, cell->GetPointIds()->GetPointer(0)))
+      {
+        ++errors;
+      }
+    }
+  });
+  if (errors > 0)
+  {
+    cerr << label << ": " << errors << " bad cells read in parallel" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool CheckDataSets()
+{
+  // The vertex and the line of the reference cells come first in a
+  // vtkPolyData.
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> polys;
+  verts->SetStorageTypeToOffsets32Bit();
+  lines->SetStorageTypeToOffsets32Bit();
+  polys->SetStorageTypeToOffsets32Bit();
+  verts->InsertNextCell(1, Cells + 10);
+  lines->InsertNextCell(2, Cells + 12);
+  polys->InsertNextCell(3, Cells + 1);
+  polys->InsertNextCell(4, Cells + 5);
+  vtkNew<vtkPolyData> pd;
+  InsertDataSetPoints(pd.GetPointer());
+  pd->SetVerts(verts.GetPointer());
+  pd->SetLines(lines.GetPointer());
+  pd->SetPolys(polys.GetPointer());
+  pd->BuildLinks();
+  double bounds[6];
+  pd->GetBounds(bounds);
+  vtkCell *cell = pd->GetCell(3);
+  if (polys->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      lines->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      cell->GetCellType() != VTK_QUAD || cell->GetPointId(3) != 5 ||
+      bounds[1] != 8.0 || bounds[3] != 64.0 || !pd->IsTriangle(0, 1, 2) ||
+      !pd->IsEdge(4, 5) || pd->IsEdge(2, 4) || !pd->IsPointUsedByCell(3, 3))
+  {
+    cerr << "Bad vtkPolyData cells with 32-bit storage" << endl;
+    return false;
+  }
+  const vtkIdType polyDataOrder[NumCells] = { 2, 3, 0, 1 };
+  if (!CheckParallelAccess(pd.GetPointer(), polyDataOrder, "vtkPolyData"))
+  {
+    return false;
+  }
+  pd->ReplaceCellPoint(1, 8, 0);
+  vtkNew<vtkIdList> ids;
+  pd->GetCellPoints(1, ids.GetPointer());
+  if (ids->GetNumberOfIds() != 2 || ids->GetId(1) != 0 ||
+      lines->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE)
+  {
+    cerr << "Bad vtkPolyData::ReplaceCellPoint()" << endl;
+    return false;
+  }
+
+  vtkNew<vtkCellArray> connectivity;
+  connectivity->SetStorageTypeToOffsets32Bit();
+  InsertCells(connectivity.GetPointer());
+  int types[NumCells] = { VTK_TRIANGLE, VTK_QUAD, VTK_VERTEX, VTK_LINE };
+  vtkNew<vtkUnstructuredGrid> ug;
+  InsertDataSetPoints(ug.GetPointer());
+  ug->SetCells(types, connectivity.GetPointer());
+  cell = ug->GetCell(1);
+  if (connectivity->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      cell->GetCellType() != VTK_QUAD || cell->GetPointId(3) != 5)
+  {
+    cerr << "Bad vtkUnstructuredGrid cells with 32-bit storage" << endl;
+    return false;
+  }
+  const vtkIdType gridOrder[NumCells] = { 0, 1, 2, 3 };
+  return CheckParallelAccess(ug.GetPointer(), gridOrder,
+                             "vtkUnstructuredGrid");
+}
+}
+
+int TestCellArrayStorage(int, char *[])
+{
+  // Legacy and offsets storages built by insertion must agree.
+  vtkNew<vtkCellArray> legacy;
+  InsertCells(legacy.GetPointer());
+  if (!CheckCells(legacy.GetPointer(), "Legacy"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkCellArray> offsets32;
+  offsets32->SetStorageTypeToOffsets32Bit();
+  InsertCells(offsets32.GetPointer());
+  if (offsets32->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      !vtkTypeInt32Array::SafeDownCast(offsets32->GetConnectivityArray()) ||
+      !CheckCells(offsets32.GetPointer(), "Offsets32"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkCellArray> offsets64;
+  offsets64->SetStorageTypeToOffsets64Bit();
+  InsertCells(offsets64.GetPointer());
+  if (!CheckCells(offsets64.GetPointer(), "Offsets64"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Conversions between storages.
+  legacy->SetStorageTypeToOffsets();
+  if (legacy->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      !CheckCells(legacy.GetPointer(), "Legacy to offsets"))
+  {
+    return EXIT_FAILURE;
+  }
+  vtkIdTypeArray *data = offsets64->GetData();
+  if (offsets64->GetStorageType() != vtkCellArray::LEGACY_STORAGE ||
+      data->GetNumberOfValues() != 14 || data->GetValue(9) != 1 ||
+      !CheckCells(offsets64.GetPointer(), "Offsets to legacy"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkCellArray> copy;
+  copy->DeepCopy(offsets32.GetPointer());
+  if (copy->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE ||
+      !CheckCells(copy.GetPointer(), "DeepCopy"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Pointer access never converts the storage; UseIdTypeStorage() does.
+  vtkNew<vtkTest::ErrorObserver> errorObserver;
+  vtkNew<vtkCellArray> pointers;
+  pointers->SetStorageTypeToOffsets32Bit();
+  InsertCells(pointers.GetPointer());
+  if (!pointers->IsIdTypeStorage())
+  {
+    if (!CheckCopyAccess(pointers.GetPointer(), errorObserver.GetPointer(),
+                         "Copies") ||
+        !CheckCells(pointers.GetPointer(), "Copies"))
+    {
+      return EXIT_FAILURE;
+    }
+    pointers->UseIdTypeStorage();
+  }
+  if (!CheckPointerAccess(pointers.GetPointer(), "Pointers") ||
+      !CheckCells(pointers.GetPointer(), "Pointers"))
+  {
+    return EXIT_FAILURE;
+  }
+  if (!CheckPointerAccess(offsets64.GetPointer(), "Legacy pointers"))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Location and cell id based modifications.
+  offsets32->ReverseCell(4);
+  offsets32->ReverseCellAtId(1);
+  vtkNew<vtkIdList> ids;
+  offsets32->GetCellAtId(1, ids.GetPointer());
+  if (ids->GetNumberOfIds() != 4 || ids->GetId(0) != 2 || ids->GetId(3) != 5)
+  {
+    cerr << "Bad reversed cell" << endl;
+    return EXIT_FAILURE;
+  }
+
+  // A 32-bit storage is promoted when an id does not fit.
+  vtkIdType bigCell[2] = {0, VTK_TYPE_INT32_MAX};
+  bigCell[1] += 10;
+  offsets32->InsertNextCell(2, bigCell);
+  offsets32->GetCellAtId(4, ids.GetPointer());
+  if (offsets32->GetStorageType() != vtkCellArray::OFFSETS_64BIT_STORAGE ||
+      ids->GetId(1) != bigCell[1])
+  {
+    cerr << "Bad promotion to 64-bit storage" << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Adopt externally built offsets and connectivity.
+  vtkNew<vtkTypeInt32Array> o;
+  vtkNew<vtkTypeInt32Array> c;
+  vtkTypeInt32 ov[] = {0, 3, 7, 8, 10};
+  vtkTypeInt32 cv[] = {0, 1, 2, 2, 3, 4, 5, 6, 7, 8};
+  for (int i=0; i < 5; ++i)
+  {
+    o->InsertNextValue(ov[i]);
+  }
+  for (int i=0; i < 10; ++i)
+  {
+    c->InsertNextValue(cv[i]);
+  }
+  vtkNew<vtkCellArray> adopted;
+  if (!adopted->SetData(o.GetPointer(), c.GetPointer()) ||
+      !CheckCells(adopted.GetPointer(), "SetData"))
+  {
+    return EXIT_FAILURE;
+  }
+  adopted->AddObserver(vtkCommand::ErrorEvent, errorObserver.GetPointer());
+  o->SetValue(4, 9);
+  if (adopted->SetData(o.GetPointer(), c.GetPointer()) ||
+      errorObserver->CheckErrorMessage("The offsets do not match"))
+  {
+    cerr << "Inconsistent offsets accepted" << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!CheckDataSets())
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -12,13 +12,17 @@
      PURPOSE.  See the above copyright notice for more information.
 
 =========================================================================*/
+#include "vtkDoubleArray.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkKdTree.h"
 #include "vtkKdTreePointLocator.h"
 #include "vtkMath.h"
 #include "vtkOctreePointLocator.h"
 #include "vtkPointLocator.h"
 #include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkStaticPointLocator.h"
 #include "vtkStructuredGrid.h"
 
 // returns true if 2 points are equidistant from x, within a tolerance
@@ -292,6 +296,196 @@ int TestKdTreePointLocator()
   return rval;
 }
 
+// This test checks that the batched queries of the KdTree, which are
+// processed in parallel, return the same points as the single queries.
+// The tree has enough points for its build to be done in parallel too.
+int TestKdTreeBatchedQueries()
+{
+  int rval = 0;
+  vtkIdType num_points = 300000;
+  vtkIdType num_test_points = 1000;
+
+  vtkPoints * A = vtkPoints::New();
+  A->SetNumberOfPoints( num_points );
+  for ( vtkIdType point = 0; point < num_points; ++point )
+  {
+    A->SetPoint( point, ((double) rand()) / RAND_MAX,
+                 ((double) rand()) / RAND_MAX, ((double) rand()) / RAND_MAX );
+  }
+
+  vtkPoints * B = vtkPoints::New();
+  B->SetNumberOfPoints( num_test_points );
+  for ( vtkIdType point = 0; point < num_test_points; ++point )
+  {
+    B->SetPoint( point, 1.2 * rand() / RAND_MAX - 0.1,
+                 1.2 * rand() / RAND_MAX - 0.1, 1.2 * rand() / RAND_MAX - 0.1 );
+  }
+
+  vtkKdTree * kd = vtkKdTree::New();
+  kd->BuildLocatorFromPoints( A );
+
+  vtkIdTypeArray * closestIds = vtkIdTypeArray::New();
+  vtkDoubleArray * closestDist2 = vtkDoubleArray::New();
+  kd->FindClosestPoints( B, closestIds, closestDist2 );
+
+  double radius = 0.02;
+  vtkIdTypeArray * offsets = vtkIdTypeArray::New();
+  vtkIdTypeArray * ids = vtkIdTypeArray::New();
+  kd->FindPointsWithinRadius( radius, B, offsets, ids );
+
+  vtkIdList * result = vtkIdList::New();
+  for ( vtkIdType test_point = 0; test_point < num_test_points; ++test_point )
+  {
+    double x[3], dist2;
+    B->GetPoint( test_point, x );
+    if ( closestIds->GetValue( test_point ) != kd->FindClosestPoint( x, dist2 ) ||
+         closestDist2->GetValue( test_point ) != dist2 )
+    {
+      cerr << "FindClosestPoints differs from FindClosestPoint for point "
+           << test_point << endl;
+      rval++;
+    }
+
+    kd->FindPointsWithinRadius( radius, x, result );
+    vtkIdType first = offsets->GetValue( test_point );
+    vtkIdType numFound = offsets->GetValue( test_point + 1 ) - first;
+    bool same = ( numFound == result->GetNumberOfIds() );
+    for ( vtkIdType i = 0; same && i < numFound; ++i )
+    {
+      same = ( result->IsId( ids->GetValue( first + i ) ) >= 0 );
+    }
+    if ( !same )
+    {
+      cerr << "FindPointsWithinRadius with vtkPoints differs from "
+           << "FindPointsWithinRadius for point " << test_point << endl;
+      rval++;
+    }
+  }
+
+  result->Delete();
+  ids->Delete();
+  offsets->Delete();
+  closestDist2->Delete();
+  closestIds->Delete();
+  kd->Delete();
+  B->Delete();
+  A->Delete();
+
+  return rval;
+}
+
+// This test checks that the batched queries of a point locator, which
+// are processed in parallel, return the same points as the single queries.
+int TestBatchedQueries(vtkAbstractPointLocator* locator)
+{
+  int rval = 0;
+  vtkIdType num_points = 10000;
+  vtkIdType num_test_points = 200;
+
+  vtkPoints * A = vtkPoints::New();
+  A->SetDataTypeToDouble();
+  A->SetNumberOfPoints( num_points );
+  for ( vtkIdType point = 0; point < num_points; ++point )
+  {
+    A->SetPoint( point, ((double) rand()) / RAND_MAX,
+                 ((double) rand()) / RAND_MAX, ((double) rand()) / RAND_MAX );
+  }
+  vtkPolyData * pd = vtkPolyData::New();
+  pd->SetPoints( A );
+
+  vtkPoints * B = vtkPoints::New();
+  B->SetNumberOfPoints( num_test_points );
+  for ( vtkIdType point = 0; point < num_test_points; ++point )
+  {
+    B->SetPoint( point, 1.2 * rand() / RAND_MAX - 0.1,
+                 1.2 * rand() / RAND_MAX - 0.1, 1.2 * rand() / RAND_MAX - 0.1 );
+  }
+
+  locator->SetDataSet( pd );
+
+  vtkIdTypeArray * closestIds = vtkIdTypeArray::New();
+  vtkDoubleArray * closestDist2 = vtkDoubleArray::New();
+  locator->FindClosestPoints( B, closestIds, closestDist2 );
+
+  int N = 10;
+  vtkIdTypeArray * nOffsets = vtkIdTypeArray::New();
+  vtkIdTypeArray * nIds = vtkIdTypeArray::New();
+  vtkDoubleArray * nDist2 = vtkDoubleArray::New();
+  locator->FindClosestNPoints( N, B, nOffsets, nIds, nDist2 );
+
+  double radius = 0.1;
+  vtkIdTypeArray * rOffsets = vtkIdTypeArray::New();
+  vtkIdTypeArray * rIds = vtkIdTypeArray::New();
+  vtkDoubleArray * rDist2 = vtkDoubleArray::New();
+  locator->FindPointsWithinRadius( radius, B, rOffsets, rIds, rDist2 );
+
+  vtkIdList * result = vtkIdList::New();
+  for ( vtkIdType test_point = 0; test_point < num_test_points; ++test_point )
+  {
+    double x[3];
+    B->GetPoint( test_point, x );
+    vtkIdType closest = locator->FindClosestPoint( x );
+    double dist2 = vtkMath::Distance2BetweenPoints( x, A->GetPoint( closest ) );
+    if ( closestIds->GetValue( test_point ) != closest ||
+         fabs( closestDist2->GetValue( test_point ) - dist2 ) > 1e-5 * dist2 )
+    {
+      cerr << locator->GetClassName() << ": FindClosestPoints differs from "
+           << "FindClosestPoint for point " << test_point << endl;
+      rval++;
+    }
+
+    locator->FindClosestNPoints( N, x, result );
+    vtkIdType first = nOffsets->GetValue( test_point );
+    bool same = ( nOffsets->GetValue( test_point + 1 ) - first ==
+                  result->GetNumberOfIds() );
+    for ( vtkIdType i = 0; same && i < result->GetNumberOfIds(); ++i )
+    {
+      dist2 = vtkMath::Distance2BetweenPoints( x, A->GetPoint( result->GetId( i ) ) );
+      same = ( nIds->GetValue( first + i ) == result->GetId( i ) &&
+               nDist2->GetValue( first + i ) == dist2 );
+    }
+    if ( !same )
+    {
+      cerr << locator->GetClassName() << ": FindClosestNPoints with vtkPoints "
+           << "differs from FindClosestNPoints for point " << test_point << endl;
+      rval++;
+    }
+
+    locator->FindPointsWithinRadius( radius, x, result );
+    first = rOffsets->GetValue( test_point );
+    same = ( rOffsets->GetValue( test_point + 1 ) - first ==
+             result->GetNumberOfIds() );
+    for ( vtkIdType i = 0; same && i < result->GetNumberOfIds(); ++i )
+    {
+      dist2 = vtkMath::Distance2BetweenPoints( x, A->GetPoint( result->GetId( i ) ) );
+      same = ( rIds->GetValue( first + i ) == result->GetId( i ) &&
+               rDist2->GetValue( first + i ) == dist2 );
+    }
+    if ( !same )
+    {
+      cerr << locator->GetClassName() << ": FindPointsWithinRadius with "
+           << "vtkPoints differs from FindPointsWithinRadius for point "
+           << test_point << endl;
+      rval++;
+    }
+  }
+
+  result->Delete();
+  rDist2->Delete();
+  rIds->Delete();
+  rOffsets->Delete();
+  nDist2->Delete();
+  nIds->Delete();
+  nOffsets->Delete();
+  closestDist2->Delete();
+  closestIds->Delete();
+  B->Delete();
+  pd->Delete();
+  A->Delete();
+
+  return rval;
+}
+
 int TestPointLocators(int , char *[])
 {
   vtkKdTreePointLocator* kdTreeLocator = vtkKdTreePointLocator::New();
@@ -311,5 +505,16 @@ int TestPointLocators(int , char *[])
 
   rval += TestKdTreePointLocator();
 
+  rval += TestKdTreeBatchedQueries();
+
+  vtkAbstractPointLocator* locators[4] = { vtkKdTreePointLocator::New(),
+    vtkPointLocator::New(), vtkOctreePointLocator::New(),
+    vtkStaticPointLocator::New() };
+  for (int i = 0; i < 4; i++)
+  {
+    rval += TestBatchedQueries(locators[i]);
+    locators[i]->Delete();
+  }
+
   return rval;
 }
@@ -0,0 +1,267 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TimeCellLinks.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellArray.h"
+#include "vtkCellLinks.h"
+#include "vtkCellType.h"
+#include "vtkIdList.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkStaticCellLinksTemplate.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Time the construction of the cell links of a triangulated plane, serially
+// and with the SMP backend in use, and check that both give the same links.
+// The default mesh is small enough for a regular test run; use
+// "--resolution 2300" to time a mesh of more than 10 million triangles.
+namespace
+{
+
+// The reference links: the cells using each point in increasing order.
+void BuildReferenceLinks(vtkCellArray *polys, vtkIdType numPts,
+                         std::vector<std::vector<vtkIdType> > &links)
+{
+  links.assign(numPts, std::vector<vtkIdType>());
+  vtkIdType npts;
+  vtkIdType *pts;
+  vtkIdType cellId = 0;
+  for (polys->InitTraversal(); polys->GetNextCell(npts, pts); ++cellId)
+  {
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      links[pts[i]].push_back(cellId);
+    }
+  }
+}
+
+bool CheckLinks(vtkCellLinks *links,
+                const std::vector<std::vector<vtkIdType> > &reference)
+{
+  for (size_t ptId = 0; ptId < reference.size(); ++ptId)
+  {
+    const std::vector<vtkIdType> &cells = reference[ptId];
+    if (links->GetNcells(ptId) != cells.size() ||
+        !std::equal(cells.begin(), cells.end(), links->GetCells(ptId)))
+    {
+      cerr << "Bad links for point " << ptId << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckLinks(vtkStaticCellLinksTemplate<int> &links,
+                const std::vector<std::vector<vtkIdType> > &reference)
+{
+  for (size_t ptId = 0; ptId < reference.size(); ++ptId)
+  {
+    const std::vector<vtkIdType> &cells = reference[ptId];
+    if (links.GetNumberOfCells(ptId) != static_cast<int>(cells.size()) ||
+        !std::equal(cells.begin(), cells.end(), links.GetCells(ptId)))
+    {
+      cerr << "Bad static links for point " << ptId << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// The cell ids of a vtkPolyData follow the insertion order, which may
+// interleave verts, lines, polys and strips: the links must use these ids.
+bool CheckInterleavedCells()
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int i = 0; i < 6; ++i)
+  {
+    points->InsertNextPoint(i % 3, i / 3, 0.0);
+  }
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->Allocate(10);
+  vtkIdType tri[3] = { 0, 1, 4 };
+  vtkIdType vert[1] = { 1 };
+  vtkIdType strip[4] = { 1, 2, 4, 5 };
+  vtkIdType line[2] = { 3, 4 };
+  vtkIdType quad[4] = { 0, 1, 4, 3 };
+  polyData->InsertNextCell(VTK_TRIANGLE, 3, tri);
+  polyData->InsertNextCell(VTK_VERTEX, 1, vert);
+  polyData->InsertNextCell(VTK_TRIANGLE_STRIP, 4, strip);
+  polyData->InsertNextCell(VTK_LINE, 2, line);
+  polyData->InsertNextCell(VTK_QUAD, 4, quad);
+  polyData->InsertNextCell(VTK_VERTEX, 1, vert + 0);
+
+  std::vector<std::vector<vtkIdType> > reference(6);
+  vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < polyData->GetNumberOfCells(); ++cellId)
+  {
+    polyData->GetCellPoints(cellId, ids);
+    for (vtkIdType i = 0; i < ids->GetNumberOfIds(); ++i)
+    {
+      reference[ids->GetId(i)].push_back(cellId);
+    }
+  }
+  if (reference[1] != std::vector<vtkIdType>({ 0, 1, 2, 4, 5 }))
+  {
+    cerr << "Bad interleaved cells" << endl;
+    return false;
+  }
+
+  for (int mode = 0; mode < 2; ++mode)
+  {
+    vtkSMPTools::Config config;
+    if (mode == 0)
+    {
+      config.Backend = "Sequential";
+    }
+    vtkSMPTools::LocalScope(config, [&]() { polyData->BuildLinks(); });
+    if (!CheckLinks(polyData->GetCellLinks(), reference))
+    {
+      cerr << "Bad links of interleaved cells" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
+int TimeCellLinks(int argc, char *argv[])
+{
+  vtkIdType res = 300;
+  for (int i = 1; i < argc - 1; ++i)
+  {
+    if (strcmp(argv[i], "--resolution") == 0)
+    {
+      res = atoi(argv[i + 1]);
+    }
+  }
+
+  // A plane of res x res quads, each split in two triangles
+  vtkIdType numPts = (res + 1) * (res + 1);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numPts);
+  for (vtkIdType j = 0, ptId = 0; j <= res; ++j)
+  {
+    for (vtkIdType i = 0; i <= res; ++i, ++ptId)
+    {
+      points->SetPoint(ptId, i, j, 0.0);
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  polys->Allocate(polys->EstimateSize(2 * res * res, 3));
+  for (vtkIdType j = 0; j < res; ++j)
+  {
+    for (vtkIdType i = 0; i < res; ++i)
+    {
+      vtkIdType p0 = j * (res + 1) + i;
+      vtkIdType tri0[3] = { p0, p0 + 1, p0 + res + 2 };
+      vtkIdType tri1[3] = { p0, p0 + res + 2, p0 + res + 1 };
+      polys->InsertNextCell(3, tri0);
+      polys->InsertNextCell(3, tri1);
+    }
+  }
+  vtkIdType numCells = polys->GetNumberOfCells();
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetPolys(polys);
+
+  vtkSmartPointer<vtkUnstructuredGrid> ugrid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  ugrid->SetPoints(points);
+  std::vector<int> types(numCells, VTK_TRIANGLE);
+  ugrid->SetCells(types.data(), polys);
+
+  std::vector<std::vector<vtkIdType> > reference;
+  BuildReferenceLinks(polys, numPts, reference);
+
+  cout << "Building the links of " << numCells << " triangles, "
+       << numPts << " points (" << vtkSMPTools::GetBackend() << " backend, "
+       << vtkSMPTools::GetEstimatedNumberOfThreads() << " threads)\n";
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  bool success = true;
+  const char *modes[] = { "Serial", "Parallel" };
+  for (int mode = 0; mode < 2; ++mode)
+  {
+    vtkSMPTools::Config config;
+    if (mode == 0)
+    {
+      config.Backend = "Sequential";
+    }
+    double polyDataTime = 0.0, ugridTime = 0.0, staticTime = 0.0;
+    vtkStaticCellLinksTemplate<int> staticLinks;
+    vtkSMPTools::LocalScope(config, [&]() {
+      polyData->DeleteLinks();
+      timer->StartTimer();
+      polyData->BuildLinks();
+      timer->StopTimer();
+      polyDataTime = timer->GetElapsedTime();
+
+      timer->StartTimer();
+      ugrid->BuildLinks();
+      timer->StopTimer();
+      ugridTime = timer->GetElapsedTime();
+
+      timer->StartTimer();
+      staticLinks.BuildLinks(polyData.GetPointer());
+      timer->StopTimer();
+      staticTime = timer->GetElapsedTime();
+    });
+
+    cout << "  " << modes[mode] << ":\n"
+         << "    vtkPolyData::BuildLinks: " << polyDataTime << " s\n"
+         << "    vtkUnstructuredGrid::BuildLinks: " << ugridTime << " s\n"
+         << "    vtkStaticCellLinksTemplate<int>: " << staticTime << " s\n";
+
+    // Check the links
+    vtkCellLinks *links = polyData->GetCellLinks();
+    success = success && CheckLinks(links, reference) &&
+      CheckLinks(ugrid->GetCellLinks(), reference) &&
+      CheckLinks(staticLinks, reference);
+  }
+
+  // Edit the links built in one block
+  vtkIdType ptId = res + 2;
+  vtkCellLinks *links = polyData->GetCellLinks();
+  unsigned short ncells = links->GetNcells(ptId);
+  links->ResizeCellList(ptId, 1);
+  links->AddCellReference(numCells, ptId);
+  links->RemoveCellReference(0, ptId);
+  links->DeletePoint(0);
+  if (links->GetNcells(ptId) != ncells ||
+      links->GetCells(ptId)[ncells - 1] != numCells ||
+      links->GetNcells(0) != 0)
+  {
+    cerr << "Bad edited links" << endl;
+    success = false;
+  }
+
+  vtkSmartPointer<vtkCellLinks> copy = vtkSmartPointer<vtkCellLinks>::New();
+  copy->DeepCopy(ugrid->GetCellLinks());
+  success = success && CheckLinks(copy, reference);
+
+  success = CheckInterleavedCells() && success;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
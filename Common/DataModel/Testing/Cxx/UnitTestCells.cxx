@@ -59,6 +59,7 @@
 #include "vtkMath.h"
 #include "vtkPoints.h"
 #include "vtkCellArray.h"
+#include <algorithm>
 #include <sstream>
 #include <vector>
 #include <string>
@@ -1068,6 +1069,60 @@ template<typename T> int TestOneCell(const VTKCellType cellType,
     std::cout << "...PASSED" << std::endl;
   }
 
+  if (aCell->GetNumberOfPoints() > 0 &&
+      strcmp(aCell->GetClassName(), "vtkQuadraticEdge") != 0 )
+  {
+    std::cout << "  Testing Derivatives of 4 components...";
+    // All 3*dim derivatives are written, and nothing past them. The
+    // collapsed cell takes the degenerate branch of the cells that have one.
+    vtkSmartPointer<T> collapsed = vtkSmartPointer<T>::New();
+    collapsed->DeepCopy(aCell);
+    if (collapsed->GetCellDimension() < 3)
+    {
+      double x0[3];
+      collapsed->GetPoints()->GetPoint(0, x0);
+      for (int p = 1; p < collapsed->GetNumberOfPoints(); ++p)
+      {
+        collapsed->GetPoints()->SetPoint(p, x0);
+      }
+    }
+    const int dim = 4;
+    std::vector<double> values(dim * aCell->GetNumberOfPoints());
+    for (size_t v = 0; v < values.size(); ++v)
+    {
+      values[v] = static_cast<double>(v % 5);
+    }
+    int status7 = 0;
+    vtkCell* cells[2] = { aCell, collapsed };
+    for (int c = 0; c < 2; ++c)
+    {
+      std::vector<double> derivs(3 * dim + 3, -12345.0);
+      cells[c]->Derivatives(0, pcenter, &(*values.begin()), dim,
+                            &(*derivs.begin()));
+      bool computed = (std::count(derivs.begin(), derivs.begin() + 3 * dim,
+                                  -12345.0) < 3 * dim);
+      for (int d = (computed ? 0 : 3 * dim); d < 3 * dim + 3; ++d)
+      {
+        if ((d < 3 * dim) == (derivs[d] == -12345.0))
+        {
+          std::cout << (c ? " collapsed" : "") << " derivs[" << d << "] "
+                    << (d < 3 * dim ? "not written" : "overwritten");
+          ++status7;
+          break;
+        }
+      }
+    }
+    if (status7)
+    {
+      ++status;
+      std::cout << "...FAILED" << std::endl;
+    }
+    else
+    {
+      std::cout << "...PASSED" << std::endl;
+    }
+  }
+
   std::cout << "  Testing EvaluateLocation vertex matches pcoord...";
   int status5 = 0;
   double *locations = aCell->GetParametricCoords();
@@ -15,7 +15,74 @@
 #include "vtkAbstractPointLocator.h"
 
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Run query(x, result) for each point x of queryPoints in parallel, and
+// store the results one after the other in ids. Each thread appends the
+// results of its queries to its own list: remember where the results of
+// each query are, then gather them once their offsets are known.
+template <typename QueryFunctor>
+void GatherQueries(vtkPoints *queryPoints, vtkIdTypeArray *offsets,
+                   vtkIdTypeArray *ids, QueryFunctor query)
+{
+  vtkIdType numQueries = queryPoints->GetNumberOfPoints();
+
+  offsets->SetNumberOfComponents(1);
+  offsets->SetNumberOfTuples(numQueries + 1);
+  vtkIdType *offset = offsets->GetPointer(0);
+
+  vtkSMPThreadLocalObject<vtkIdList> localResult;
+  vtkSMPThreadLocalObject<vtkIdList> localFound;
+  std::vector<vtkIdList*> found(numQueries);
+  std::vector<vtkIdType> start(numQueries);
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *result = localResult.Local();
+    vtkIdList *list = localFound.Local();
+    double x[3];
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      queryPoints->GetPoint(i, x);
+      query(x, result);
+      vtkIdType numIds = result->GetNumberOfIds();
+      found[i] = list;
+      start[i] = list->GetNumberOfIds();
+      std::copy(result->GetPointer(0), result->GetPointer(0) + numIds,
+                list->WritePointer(start[i], numIds));
+      offset[i] = numIds;
+    }
+  });
+
+  offset[numQueries] = vtkSMPTools::ExclusiveScan(offset, offset + numQueries,
+    offset, static_cast<vtkIdType>(0));
+
+  ids->SetNumberOfComponents(1);
+  ids->SetNumberOfTuples(offset[numQueries]);
+  vtkIdType *out = ids->GetPointer(0);
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      vtkIdType *first = found[i]->GetPointer(start[i]);
+      std::copy(first, first + (offset[i+1] - offset[i]), out + offset[i]);
+    }
+  });
+}
+}
 
 
 //-----------------------------------------------------------------------------
@@ -68,6 +135,117 @@ void vtkAbstractPointLocator::FindPointsWithinRadius(double R, double x,
   this->FindPointsWithinRadius(R,p,result);
 }
 
+//-----------------------------------------------------------------------------
+void vtkAbstractPointLocator::FindClosestPoints(vtkPoints *queryPoints,
+                                                vtkIdTypeArray *closestIds,
+                                                vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+
+  vtkIdType numQueries = queryPoints->GetNumberOfPoints();
+
+  closestIds->SetNumberOfComponents(1);
+  closestIds->SetNumberOfTuples(numQueries);
+  vtkIdType *closest = closestIds->GetPointer(0);
+
+  double *closestDist2 = nullptr;
+  if (dist2)
+  {
+    dist2->SetNumberOfComponents(1);
+    dist2->SetNumberOfTuples(numQueries);
+    closestDist2 = dist2->GetPointer(0);
+  }
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    double x[3], p[3];
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      queryPoints->GetPoint(i, x);
+      closest[i] = this->FindClosestPoint(x);
+      if (closestDist2)
+      {
+        closestDist2[i] = VTK_DOUBLE_MAX;
+        if (closest[i] >= 0)
+        {
+          this->DataSet->GetPoint(closest[i], p);
+          closestDist2[i] = vtkMath::Distance2BetweenPoints(x, p);
+        }
+      }
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+void vtkAbstractPointLocator::FindClosestNPoints(int N, vtkPoints *queryPoints,
+                                                 vtkIdTypeArray *offsets,
+                                                 vtkIdTypeArray *ids,
+                                                 vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+
+  GatherQueries(queryPoints, offsets, ids,
+    [this, N](const double x[3], vtkIdList *result)
+    {
+      this->FindClosestNPoints(N, x, result);
+    });
+
+  if (dist2)
+  {
+    this->ComputeDistances(queryPoints, offsets, ids, dist2);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkAbstractPointLocator::FindPointsWithinRadius(double R,
+                                                     vtkPoints *queryPoints,
+                                                     vtkIdTypeArray *offsets,
+                                                     vtkIdTypeArray *ids,
+                                                     vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+
+  GatherQueries(queryPoints, offsets, ids,
+    [this, R](const double x[3], vtkIdList *result)
+    {
+      this->FindPointsWithinRadius(R, x, result);
+    });
+
+  if (dist2)
+  {
+    this->ComputeDistances(queryPoints, offsets, ids, dist2);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkAbstractPointLocator::ComputeDistances(vtkPoints *queryPoints,
+                                               vtkIdTypeArray *offsets,
+                                               vtkIdTypeArray *ids,
+                                               vtkDoubleArray *dist2)
+{
+  const vtkIdType *offset = offsets->GetPointer(0);
+  const vtkIdType *id = ids->GetPointer(0);
+
+  dist2->SetNumberOfComponents(1);
+  dist2->SetNumberOfTuples(ids->GetNumberOfTuples());
+  double *d2 = dist2->GetPointer(0);
+
+  vtkSMPTools::For(0, queryPoints->GetNumberOfPoints(),
+    [&](vtkIdType begin, vtkIdType end)
+    {
+      double x[3], p[3];
+      for (vtkIdType i = begin; i < end; i++)
+      {
+        queryPoints->GetPoint(i, x);
+        for (vtkIdType j = offset[i]; j < offset[i+1]; j++)
+        {
+          this->DataSet->GetPoint(id[j], p);
+          d2[j] = vtkMath::Distance2BetweenPoints(x, p);
+        }
+      }
+    });
+}
+
 //-----------------------------------------------------------------------------
 void vtkAbstractPointLocator::GetBounds(double* bnds)
 {
@@ -33,7 +33,10 @@
 #include "vtkCommonDataModelModule.h" // For export macro
 #include "vtkLocator.h"
 
+class vtkDoubleArray;
 class vtkIdList;
+class vtkIdTypeArray;
+class vtkPoints;
 
 class VTKCOMMONDATAMODEL_EXPORT vtkAbstractPointLocator : public vtkLocator
 {
@@ -93,6 +96,33 @@ public:
                                       vtkIdList *result);
   //@}
 
+  //@{
+  /**
+   * Batched versions of FindClosestPoint(), FindClosestNPoints() and
+   * FindPointsWithinRadius() that answer the queries for all the points of
+   * queryPoints at once. The locator is built first, then the query points
+   * are processed in parallel (see vtkSMPTools). FindClosestPoints() resizes
+   * closestIds to hold the id of the closest point of each query point (-1
+   * if there is none). The other methods store the points found for all the
+   * query points one after the other in ids: the points found for query
+   * point i are ids[offsets[i]] to ids[offsets[i+1]-1], in the order of the
+   * single queries, so offsets is resized to hold one more value than there
+   * are query points. When dist2 is given, it is resized like closestIds or
+   * ids to hold the square of the distance of each point found to its query
+   * point.
+   */
+  virtual void FindClosestPoints(vtkPoints *queryPoints,
+                                 vtkIdTypeArray *closestIds,
+                                 vtkDoubleArray *dist2 = nullptr);
+  virtual void FindClosestNPoints(int N, vtkPoints *queryPoints,
+                                  vtkIdTypeArray *offsets, vtkIdTypeArray *ids,
+                                  vtkDoubleArray *dist2 = nullptr);
+  virtual void FindPointsWithinRadius(double R, vtkPoints *queryPoints,
+                                      vtkIdTypeArray *offsets,
+                                      vtkIdTypeArray *ids,
+                                      vtkDoubleArray *dist2 = nullptr);
+  //@}
+
   /**
    * Provide an accessor to the bounds.
    */
@@ -111,6 +141,15 @@ protected:
   vtkAbstractPointLocator();
   ~vtkAbstractPointLocator() override;
 
+  /**
+   * Resize dist2 like ids and set it to the square of the distance of each
+   * point of ids to its query point, the points found for query point i
+   * being ids[offsets[i]] to ids[offsets[i+1]-1]. Used by the batched
+   * queries of the subclasses that do not get the distances for free.
+   */
+  void ComputeDistances(vtkPoints *queryPoints, vtkIdTypeArray *offsets,
+                        vtkIdTypeArray *ids, vtkDoubleArray *dist2);
+
   double Bounds[6]; // bounds of points
   vtkIdType NumberOfBuckets; // total size of locator
 
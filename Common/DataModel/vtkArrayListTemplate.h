@@ -251,6 +251,12 @@ struct ArrayList
       }
   }
 
+  // Copy the arrays of outPD which are not in the list (arrays that are not
+  // vtkDataArrays, or vtkBitArrays), one tuple at a time: the output tuple i
+  // is the input tuple sources[i]. This is not thread safe.
+  void CopyOtherArrays(vtkIdType numOut, const vtkIdType *sources,
+                       vtkDataSetAttributes *inPD, vtkDataSetAttributes *outPD);
+
   // Loop over the arrays and have them interpolate themselves
   void Interpolate(int numWeights, const vtkIdType *ids, const double *weights, vtkIdType outId)
   {
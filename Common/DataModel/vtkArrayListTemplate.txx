@@ -214,4 +214,65 @@ AddSelfInterpolatingArrays(vtkIdType numOutPts, vtkDataSetAttributes *attr, doub
   }//for each candidate array
 }
 
+//----------------------------------------------------------------------------
+inline void ArrayList::
+CopyOtherArrays(vtkIdType numOut, const vtkIdType *sources,
+                vtkDataSetAttributes *inPD, vtkDataSetAttributes *outPD)
+{
+  int numArrays = outPD->GetNumberOfArrays();
+  int unnamedRank = 0;
+  for (int i=0; i < numArrays; ++i)
+  {
+    vtkAbstractArray *oArray = outPD->GetAbstractArray(i);
+    bool inList = false;
+    for (std::vector<BaseArrayPair*>::iterator it = Arrays.begin();
+         !inList && it != Arrays.end(); ++it)
+    {
+      inList = ((*it)->OutputArray.GetPointer() == oArray);
+    }
+    vtkDataArray *oDataArray = vtkArrayDownCast<vtkDataArray>(oArray);
+    if ( inList || (oDataArray && this->IsExcluded(oDataArray)) )
+    {
+      continue;
+    }
+
+    // Unnamed arrays are matched as attributes, or else by their rank among
+    // the unnamed arrays that are not attributes (copy flags never drop those).
+    vtkAbstractArray *iArray = nullptr;
+    int attribute = outPD->IsArrayAnAttribute(i);
+    if ( oArray->GetName() )
+    {
+      iArray = inPD->GetAbstractArray(oArray->GetName());
+    }
+    else if ( attribute >= 0 )
+    {
+      iArray = inPD->GetAbstractAttribute(attribute);
+    }
+    else
+    {
+      for (int j=0, rank=0; !iArray && j < inPD->GetNumberOfArrays(); ++j)
+      {
+        vtkAbstractArray *candidate = inPD->GetAbstractArray(j);
+        if ( candidate && !candidate->GetName() &&
+             inPD->IsArrayAnAttribute(j) < 0 && rank++ == unnamedRank )
+        {
+          iArray = candidate;
+        }
+      }
+      ++unnamedRank;
+    }
+    vtkDataArray *iDataArray = vtkArrayDownCast<vtkDataArray>(iArray);
+    if ( !iArray || (iDataArray && this->IsExcluded(iDataArray)) )
+    {
+      continue;
+    }
+
+    oArray->SetNumberOfTuples(numOut);
+    for (vtkIdType outId=0; outId < numOut; ++outId)
+    {
+      oArray->SetTuple(outId, sources[outId], iArray);
+    }
+  }//for each candidate array
+}
+
 #endif
@@ -0,0 +1,1158 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBVHCellLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkBVHCellLocator.h"
+
+#include "vtkCellArray.h"
+#include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+vtkStandardNewMacro(vtkBVHCellLocator);
+
+//----------------------------------------------------------------------------
+// Helper classes to build and traverse the hierarchy.
+//
+// The hierarchy is first built as a tree of BuildNode, each of which owns a
+// contiguous range of a permutation of the cell ids. The cells of a node are
+// split in two by partitioning its range: the split minimizes the surface
+// area heuristic among the boundaries of NumberOfBins bins of the centroids
+// along each axis. The centroids of large nodes are binned with several
+// threads, and the two children of large nodes are built concurrently. Since
+// the bins only hold counts and bounds, the tree does not depend on the
+// number of threads. The tree is then flattened into an array of BVHNode in
+// depth first order.
+namespace
+{
+  // The depth of the hierarchy is limited, so that the traversals can use a
+  // stack of fixed size.
+  const int MaxDepth = 64;
+  const int StackSize = MaxDepth + 1;
+
+  // The centroids of the nodes with at least that many cells are binned
+  // with several threads, and the children of the nodes with at least that
+  // many cells are built concurrently.
+  const vtkIdType ParallelBinSize = 1 << 15;
+  const vtkIdType ParallelBuildSize = 1 << 12;
+
+  //----------------------------------------------------------------------------
+  // A node of the flattened hierarchy. The first child of an interior node
+  // follows it in the array, and Index is the index of its second child.
+  // The cells of a leaf are CellIds[Index, Index + Size). Size is 0 for the
+  // interior nodes.
+  struct BVHNode
+  {
+    float Bounds[6];
+    unsigned int Index;
+    unsigned int Size;
+  };
+
+  //----------------------------------------------------------------------------
+  // A node of the hierarchy while it is built.
+  struct BuildNode
+  {
+    double Bounds[6];
+    vtkIdType Begin;
+    vtkIdType End;
+    vtkIdType NumberOfNodes; // in the subtree of the node
+    int Depth; // of the subtree of the node
+    std::unique_ptr<BuildNode> Children[2];
+  };
+
+  //----------------------------------------------------------------------------
+  // The cells whose centroid falls into a bin along an axis: their number
+  // and their bounds.
+  struct SAHBin
+  {
+    vtkIdType Count;
+    double Bounds[6];
+  };
+
+  //----------------------------------------------------------------------------
+  void InitializeBounds(double bounds[6])
+  {
+    bounds[0] = bounds[2] = bounds[4] = VTK_DOUBLE_MAX;
+    bounds[1] = bounds[3] = bounds[5] = -VTK_DOUBLE_MAX;
+  }
+
+  void AddBounds(double bounds[6], const double b[6])
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2*i] = std::min(bounds[2*i], b[2*i]);
+      bounds[2*i+1] = std::max(bounds[2*i+1], b[2*i+1]);
+    }
+  }
+
+  void AddPoint(double bounds[6], const double x[3])
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2*i] = std::min(bounds[2*i], x[i]);
+      bounds[2*i+1] = std::max(bounds[2*i+1], x[i]);
+    }
+  }
+
+  // Half of the area of a box, which is all the heuristic needs.
+  double HalfArea(const double b[6])
+  {
+    if (b[1] < b[0])
+    {
+      return 0.0;
+    }
+    double dx = b[1] - b[0];
+    double dy = b[3] - b[2];
+    double dz = b[5] - b[4];
+    return dx*dy + dy*dz + dz*dx;
+  }
+
+  // Convert double bounds to float bounds which contain them.
+  void RoundOutward(const double b[6], float f[6])
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      f[2*i] = static_cast<float>(b[2*i]);
+      if (f[2*i] > b[2*i])
+      {
+        f[2*i] = std::nextafter(f[2*i], -VTK_FLOAT_MAX);
+      }
+      f[2*i+1] = static_cast<float>(b[2*i+1]);
+      if (f[2*i+1] < b[2*i+1])
+      {
+        f[2*i+1] = std::nextafter(f[2*i+1], VTK_FLOAT_MAX);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Return whether the segment p + t*dir, for t in [0, tMax], intersects the
+  // box enlarged by tol, and the parametric coordinate at which it enters
+  // it. invDir is the inverse of dir. When a component of dir is zero, the
+  // infinite (or NaN, on the planes of the box) slab coordinates behave as
+  // they should: NaN comparisons are false and leave the range untouched.
+  template <typename T>
+  bool IntersectSegment(const T b[6], const double p[3], const double invDir[3],
+                        double tMax, double tol, double& tEntry)
+  {
+    double t0 = 0.0;
+    double t1 = tMax;
+    for (int i = 0; i < 3; ++i)
+    {
+      double ta = (b[2*i] - tol - p[i]) * invDir[i];
+      double tb = (b[2*i+1] + tol - p[i]) * invDir[i];
+      if (ta > tb)
+      {
+        std::swap(ta, tb);
+      }
+      if (ta > t0)
+      {
+        t0 = ta;
+      }
+      if (tb < t1)
+      {
+        t1 = tb;
+      }
+      if (t0 > t1)
+      {
+        return false;
+      }
+    }
+    tEntry = t0;
+    return true;
+  }
+
+  template <typename T>
+  double Distance2ToBounds(const T b[6], const double x[3])
+  {
+    double d2 = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      double d = 0.0;
+      if (x[i] < b[2*i])
+      {
+        d = b[2*i] - x[i];
+      }
+      else if (x[i] > b[2*i+1])
+      {
+        d = x[i] - b[2*i+1];
+      }
+      d2 += d * d;
+    }
+    return d2;
+  }
+
+  template <typename T>
+  bool ContainsPoint(const T b[6], const double x[3])
+  {
+    return x[0] >= b[0] && x[0] <= b[1] && x[1] >= b[2] && x[1] <= b[3] &&
+      x[2] >= b[4] && x[2] <= b[5];
+  }
+
+  template <typename T>
+  bool OverlapsBounds(const T b[6], const double bbox[6])
+  {
+    return b[0] <= bbox[1] && b[1] >= bbox[0] && b[2] <= bbox[3] &&
+      b[3] >= bbox[2] && b[4] <= bbox[5] && b[5] >= bbox[4];
+  }
+
+  //----------------------------------------------------------------------------
+  // Builds the hierarchy of the cells, given their bounds and centroids.
+  class BVHBuilder
+  {
+  public:
+    BVHBuilder(const double (*cellBounds)[6], const double *centroids,
+               vtkIdType *cellIds, int leafSize, int numBins) :
+      CellBounds(cellBounds), Centroids(centroids), CellIds(cellIds),
+      LeafSize(leafSize), NumberOfBins(numBins)
+    {
+    }
+
+    std::unique_ptr<BuildNode> Build(vtkIdType begin, vtkIdType end, int depth)
+    {
+      std::unique_ptr<BuildNode> node(new BuildNode);
+      node->Begin = begin;
+      node->End = end;
+      node->NumberOfNodes = 1;
+      node->Depth = 1;
+
+      double centroidBounds[6];
+      this->ComputeBounds(begin, end, node->Bounds, centroidBounds);
+      if ((end - begin) <= this->LeafSize || depth >= MaxDepth - 1)
+      {
+        return node;
+      }
+
+      vtkIdType mid = this->Split(begin, end, centroidBounds);
+      auto buildChildren = [&](vtkIdType first, vtkIdType last)
+      {
+        for (vtkIdType i = first; i < last; ++i)
+        {
+          node->Children[i] = (i == 0) ? this->Build(begin, mid, depth + 1)
+                                       : this->Build(mid, end, depth + 1);
+        }
+      };
+      if ((end - begin) >= ParallelBuildSize)
+      {
+        vtkSMPTools::For(0, 2, 1, buildChildren);
+      }
+      else
+      {
+        buildChildren(0, 2);
+      }
+
+      node->NumberOfNodes = 1 + node->Children[0]->NumberOfNodes +
+        node->Children[1]->NumberOfNodes;
+      node->Depth = 1 + std::max(node->Children[0]->Depth,
+                                 node->Children[1]->Depth);
+      return node;
+    }
+
+    // Write the subtree of node into nodes, node itself at index.
+    void Flatten(const BuildNode *node, BVHNode *nodes, vtkIdType index)
+    {
+      BVHNode& out = nodes[index];
+      RoundOutward(node->Bounds, out.Bounds);
+      if (!node->Children[0])
+      {
+        out.Index = static_cast<unsigned int>(node->Begin);
+        out.Size = static_cast<unsigned int>(node->End - node->Begin);
+        return;
+      }
+
+      vtkIdType second = index + 1 + node->Children[0]->NumberOfNodes;
+      out.Index = static_cast<unsigned int>(second);
+      out.Size = 0;
+      auto flattenChildren = [&](vtkIdType first, vtkIdType last)
+      {
+        for (vtkIdType i = first; i < last; ++i)
+        {
+          this->Flatten(node->Children[i].get(), nodes,
+                        (i == 0) ? index + 1 : second);
+        }
+      };
+      if ((node->End - node->Begin) >= ParallelBuildSize)
+      {
+        vtkSMPTools::For(0, 2, 1, flattenChildren);
+      }
+      else
+      {
+        flattenChildren(0, 2);
+      }
+    }
+
+  private:
+    const double (*CellBounds)[6];
+    const double *Centroids;
+    vtkIdType *CellIds;
+    int LeafSize;
+    int NumberOfBins;
+
+    // Compute the bounds of the cells of a range, and of their centroids.
+    void ComputeBounds(vtkIdType begin, vtkIdType end, double bounds[6],
+                       double centroidBounds[6])
+    {
+      std::vector<double> exemplar(12);
+      InitializeBounds(exemplar.data());
+      InitializeBounds(exemplar.data() + 6);
+      auto addCells = [this](vtkIdType first, vtkIdType last, double *b)
+      {
+        for (vtkIdType i = first; i < last; ++i)
+        {
+          vtkIdType cellId = this->CellIds[i];
+          AddBounds(b, this->CellBounds[cellId]);
+          AddPoint(b + 6, this->Centroids + 3*cellId);
+        }
+      };
+
+      if ((end - begin) < ParallelBinSize)
+      {
+        addCells(begin, end, exemplar.data());
+      }
+      else
+      {
+        vtkSMPThreadLocal<std::vector<double> > localBounds(exemplar);
+        vtkSMPTools::For(begin, end, [&](vtkIdType first, vtkIdType last)
+        {
+          addCells(first, last, localBounds.Local().data());
+        });
+        for (auto it = localBounds.begin(); it != localBounds.end(); ++it)
+        {
+          AddBounds(exemplar.data(), it->data());
+          AddBounds(exemplar.data() + 6, it->data() + 6);
+        }
+      }
+      std::copy(exemplar.begin(), exemplar.begin() + 6, bounds);
+      std::copy(exemplar.begin() + 6, exemplar.end(), centroidBounds);
+    }
+
+    // The bin of a centroid coordinate along an axis. The binning and the
+    // partition must use the very same computation.
+    int GetBin(double c, double cMin, double scale) const
+    {
+      int bin = static_cast<int>((c - cMin) * scale);
+      return (bin < this->NumberOfBins) ? bin : this->NumberOfBins - 1;
+    }
+
+    // Count the cells of a range in the bins of their centroids along the
+    // axes where the centroids are not all equal.
+    void BinCentroids(vtkIdType begin, vtkIdType end,
+                      const double centroidBounds[6], const double scale[3],
+                      std::vector<SAHBin>& bins)
+    {
+      SAHBin empty;
+      empty.Count = 0;
+      InitializeBounds(empty.Bounds);
+      std::vector<SAHBin> exemplar(3 * this->NumberOfBins, empty);
+      auto binCells = [&](vtkIdType first, vtkIdType last, SAHBin *b)
+      {
+        for (vtkIdType i = first; i < last; ++i)
+        {
+          vtkIdType cellId = this->CellIds[i];
+          const double *c = this->Centroids + 3*cellId;
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            if (scale[axis] > 0.0)
+            {
+              SAHBin& bin = b[axis * this->NumberOfBins +
+                this->GetBin(c[axis], centroidBounds[2*axis], scale[axis])];
+              bin.Count++;
+              AddBounds(bin.Bounds, this->CellBounds[cellId]);
+            }
+          }
+        }
+      };
+
+      if ((end - begin) < ParallelBinSize)
+      {
+        binCells(begin, end, exemplar.data());
+        bins.swap(exemplar);
+        return;
+      }
+
+      vtkSMPThreadLocal<std::vector<SAHBin> > localBins(exemplar);
+      vtkSMPTools::For(begin, end, [&](vtkIdType first, vtkIdType last)
+      {
+        binCells(first, last, localBins.Local().data());
+      });
+      bins.swap(exemplar);
+      for (auto it = localBins.begin(); it != localBins.end(); ++it)
+      {
+        for (size_t i = 0; i < bins.size(); ++i)
+        {
+          bins[i].Count += (*it)[i].Count;
+          AddBounds(bins[i].Bounds, (*it)[i].Bounds);
+        }
+      }
+    }
+
+    // Partition the cells of a range so as to minimize the surface area
+    // heuristic, and return where the second part begins.
+    vtkIdType Split(vtkIdType begin, vtkIdType end,
+                    const double centroidBounds[6])
+    {
+      const int numBins = this->NumberOfBins;
+      double scale[3];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        double extent = centroidBounds[2*axis+1] - centroidBounds[2*axis];
+        scale[axis] = (extent > 0.0) ? numBins / extent : 0.0;
+      }
+
+      std::vector<SAHBin> bins;
+      this->BinCentroids(begin, end, centroidBounds, scale, bins);
+
+      // Sweep the bins of each axis from the left then from the right: the
+      // cost of splitting after bin i is the sum over both sides of the
+      // number of cells times the area of their bounds.
+      int bestAxis = -1;
+      int bestBin = 0;
+      double bestCost = VTK_DOUBLE_MAX;
+      std::vector<double> leftCost(numBins);
+      std::vector<vtkIdType> leftCount(numBins);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        if (scale[axis] <= 0.0)
+        {
+          continue;
+        }
+        const SAHBin *b = bins.data() + axis * numBins;
+        double bounds[6];
+        InitializeBounds(bounds);
+        vtkIdType count = 0;
+        for (int i = 0; i < numBins - 1; ++i)
+        {
+          count += b[i].Count;
+          AddBounds(bounds, b[i].Bounds);
+          leftCount[i] = count;
+          leftCost[i] = count * HalfArea(bounds);
+        }
+        InitializeBounds(bounds);
+        count = 0;
+        for (int i = numBins - 1; i > 0; --i)
+        {
+          count += b[i].Count;
+          AddBounds(bounds, b[i].Bounds);
+          if (count == 0 || leftCount[i-1] == 0)
+          {
+            continue;
+          }
+          double cost = leftCost[i-1] + count * HalfArea(bounds);
+          if (cost < bestCost)
+          {
+            bestCost = cost;
+            bestAxis = axis;
+            bestBin = i - 1;
+          }
+        }
+      }
+
+      // All the centroids are equal: split the range in halves.
+      if (bestAxis < 0)
+      {
+        return begin + (end - begin) / 2;
+      }
+
+      const double cMin = centroidBounds[2*bestAxis];
+      const double s = scale[bestAxis];
+      vtkIdType *mid = std::partition(this->CellIds + begin,
+        this->CellIds + end, [&](vtkIdType cellId)
+        {
+          return this->GetBin(this->Centroids[3*cellId + bestAxis], cMin, s)
+            <= bestBin;
+        });
+      return mid - this->CellIds;
+    }
+  };
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// The flattened hierarchy, and the queries. The queries do not modify it,
+// so they may run concurrently given distinct generic cells.
+class vtkBVHCellLocator::vtkInternals
+{
+public:
+  vtkDataSet *DataSet;
+  const double (*CellBounds)[6];
+  std::vector<BVHNode> Nodes;
+  std::vector<vtkIdType> CellIds;
+
+  vtkInternals() : DataSet(nullptr), CellBounds(nullptr) {}
+
+  bool IsBuilt() const
+  {
+    return !this->Nodes.empty();
+  }
+
+  void Free()
+  {
+    std::vector<BVHNode>().swap(this->Nodes);
+    std::vector<vtkIdType>().swap(this->CellIds);
+    this->DataSet = nullptr;
+    this->CellBounds = nullptr;
+  }
+
+  //----------------------------------------------------------------------------
+  vtkIdType FindCell(double x[3], vtkGenericCell *cell, double pcoords[3],
+                     double *weights) const
+  {
+    unsigned int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    double dist2, delta[3] = {0.0, 0.0, 0.0};
+    int subId;
+
+    while (top > 0)
+    {
+      unsigned int index = stack[--top];
+      const BVHNode& node = this->Nodes[index];
+      if (!ContainsPoint(node.Bounds, x))
+      {
+        continue;
+      }
+      if (node.Size == 0)
+      {
+        stack[top++] = node.Index;
+        stack[top++] = index + 1;
+        continue;
+      }
+      for (unsigned int i = node.Index; i < node.Index + node.Size; ++i)
+      {
+        vtkIdType cellId = this->CellIds[i];
+        if (vtkMath::PointIsWithinBounds(
+              x, const_cast<double*>(this->CellBounds[cellId]), delta))
+        {
+          this->DataSet->GetCell(cellId, cell);
+          if (cell->EvaluatePosition(x, nullptr, subId, pcoords, dist2,
+                                     weights) == 1)
+          {
+            return cellId;
+          }
+        }
+      }
+    }
+    return -1;
+  }
+
+  //----------------------------------------------------------------------------
+  // The children are visited in the order the segment enters them, and the
+  // nodes the segment enters after the closest intersection so far are
+  // skipped.
+  int IntersectWithLine(double p1[3], double p2[3], double tol, double& t,
+                        double x[3], double pcoords[3], int &subId,
+                        vtkIdType &cellId, vtkGenericCell *cell) const
+  {
+    double invDir[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      invDir[i] = 1.0 / (p2[i] - p1[i]);
+    }
+
+    struct Entry
+    {
+      unsigned int Index;
+      double T;
+    };
+    Entry stack[StackSize];
+    int top = 0;
+
+    double tEntry;
+    if (!IntersectSegment(this->Nodes[0].Bounds, p1, invDir, 1.0, 0.0, tEntry))
+    {
+      return 0;
+    }
+    stack[top++] = Entry{0, tEntry};
+
+    vtkIdType bestId = -1;
+    vtkIdType loadedId = -1;
+    double tBest = 1.0;
+    double tCell, xCell[3], pcoordsCell[3];
+    int subIdCell;
+    while (top > 0)
+    {
+      Entry entry = stack[--top];
+      if (bestId >= 0 && entry.T > tBest)
+      {
+        continue;
+      }
+      const BVHNode& node = this->Nodes[entry.Index];
+      if (node.Size == 0)
+      {
+        unsigned int children[2] = { entry.Index + 1, node.Index };
+        double tChild[2];
+        bool hit[2];
+        for (int i = 0; i < 2; ++i)
+        {
+          hit[i] = IntersectSegment(this->Nodes[children[i]].Bounds, p1,
+                                    invDir, tBest, 0.0, tChild[i]);
+        }
+        int nearest = (hit[0] && hit[1] && tChild[1] < tChild[0]) ? 1 : 0;
+        for (int i = 1; i >= 0; --i)
+        {
+          int child = (i == 0) ? nearest : 1 - nearest;
+          if (hit[child])
+          {
+            stack[top++] = Entry{children[child], tChild[child]};
+          }
+        }
+        continue;
+      }
+
+      for (unsigned int i = node.Index; i < node.Index + node.Size; ++i)
+      {
+        vtkIdType id = this->CellIds[i];
+        if (!IntersectSegment(this->CellBounds[id], p1, invDir, tBest, 0.0,
+                              tEntry))
+        {
+          continue;
+        }
+        this->DataSet->GetCell(id, cell);
+        loadedId = id;
+        if (cell->IntersectWithLine(p1, p2, tol, tCell, xCell, pcoordsCell,
+                                    subIdCell) &&
+            (bestId < 0 || tCell < tBest))
+        {
+          bestId = id;
+          tBest = tCell;
+          t = tCell;
+          subId = subIdCell;
+          for (int j = 0; j < 3; ++j)
+          {
+            x[j] = xCell[j];
+            pcoords[j] = pcoordsCell[j];
+          }
+        }
+      }
+    }
+
+    if (bestId < 0)
+    {
+      return 0;
+    }
+    if (loadedId != bestId)
+    {
+      this->DataSet->GetCell(bestId, cell);
+    }
+    cellId = bestId;
+    return 1;
+  }
+
+  //----------------------------------------------------------------------------
+  void FindCellsAlongLine(double p1[3], double p2[3], double tol,
+                          vtkIdList *cells) const
+  {
+    double invDir[3], tEntry;
+    for (int i = 0; i < 3; ++i)
+    {
+      invDir[i] = 1.0 / (p2[i] - p1[i]);
+    }
+
+    unsigned int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      unsigned int index = stack[--top];
+      const BVHNode& node = this->Nodes[index];
+      if (!IntersectSegment(node.Bounds, p1, invDir, 1.0, tol, tEntry))
+      {
+        continue;
+      }
+      if (node.Size == 0)
+      {
+        stack[top++] = node.Index;
+        stack[top++] = index + 1;
+        continue;
+      }
+      for (unsigned int i = node.Index; i < node.Index + node.Size; ++i)
+      {
+        vtkIdType cellId = this->CellIds[i];
+        if (IntersectSegment(this->CellBounds[cellId], p1, invDir, 1.0, tol,
+                             tEntry))
+        {
+          cells->InsertNextId(cellId);
+        }
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void FindCellsWithinBounds(const double bbox[6], vtkIdList *cells) const
+  {
+    unsigned int stack[StackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      unsigned int index = stack[--top];
+      const BVHNode& node = this->Nodes[index];
+      if (!OverlapsBounds(node.Bounds, bbox))
+      {
+        continue;
+      }
+      if (node.Size == 0)
+      {
+        stack[top++] = node.Index;
+        stack[top++] = index + 1;
+        continue;
+      }
+      for (unsigned int i = node.Index; i < node.Index + node.Size; ++i)
+      {
+        vtkIdType cellId = this->CellIds[i];
+        if (OverlapsBounds(this->CellBounds[cellId], bbox))
+        {
+          cells->InsertNextId(cellId);
+        }
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Branch and bound: the nearer child is visited first, and the nodes
+  // farther than the closest cell so far are skipped.
+  vtkIdType FindClosestPoint(double x[3], double radius2,
+                             double closestPoint[3], vtkGenericCell *cell,
+                             vtkIdType &cellId, int &subId, double& dist2,
+                             int &inside) const
+  {
+    struct Entry
+    {
+      unsigned int Index;
+      double Dist2;
+    };
+    Entry stack[StackSize];
+    int top = 0;
+
+    double minDist2 = radius2;
+    double d2 = Distance2ToBounds(this->Nodes[0].Bounds, x);
+    if (d2 > minDist2)
+    {
+      return 0;
+    }
+    stack[top++] = Entry{0, d2};
+
+    vtkIdType bestId = -1;
+    vtkIdType loadedId = -1;
+    double point[3], pcoords[3];
+    int subIdCell, stat;
+    std::vector<double> weights(8);
+    while (top > 0)
+    {
+      Entry entry = stack[--top];
+      if (entry.Dist2 > minDist2)
+      {
+        continue;
+      }
+      const BVHNode& node = this->Nodes[entry.Index];
+      if (node.Size == 0)
+      {
+        unsigned int children[2] = { entry.Index + 1, node.Index };
+        double dChild[2];
+        for (int i = 0; i < 2; ++i)
+        {
+          dChild[i] = Distance2ToBounds(this->Nodes[children[i]].Bounds, x);
+        }
+        int nearest = (dChild[1] < dChild[0]) ? 1 : 0;
+        for (int i = 1; i >= 0; --i)
+        {
+          int child = (i == 0) ? nearest : 1 - nearest;
+          if (dChild[child] <= minDist2)
+          {
+            stack[top++] = Entry{children[child], dChild[child]};
+          }
+        }
+        continue;
+      }
+
+      for (unsigned int i = node.Index; i < node.Index + node.Size; ++i)
+      {
+        vtkIdType id = this->CellIds[i];
+        if (Distance2ToBounds(this->CellBounds[id], x) > minDist2)
+        {
+          continue;
+        }
+        this->DataSet->GetCell(id, cell);
+        loadedId = id;
+        size_t numPts = static_cast<size_t>(cell->GetNumberOfPoints());
+        if (weights.size() < numPts)
+        {
+          weights.resize(numPts);
+        }
+        stat = cell->EvaluatePosition(x, point, subIdCell, pcoords, d2,
+                                      weights.data());
+        if (stat != -1 && (d2 < minDist2 || (bestId < 0 && d2 <= minDist2)))
+        {
+          bestId = id;
+          minDist2 = d2;
+          subId = subIdCell;
+          inside = stat;
+          closestPoint[0] = point[0];
+          closestPoint[1] = point[1];
+          closestPoint[2] = point[2];
+        }
+      }
+    }
+
+    if (bestId < 0)
+    {
+      return 0;
+    }
+    if (loadedId != bestId)
+    {
+      this->DataSet->GetCell(bestId, cell);
+    }
+    cellId = bestId;
+    dist2 = minDist2;
+    return 1;
+  }
+
+  //----------------------------------------------------------------------------
+  // Add the boxes of the nodes at the given depth, and of the leaves above.
+  void GenerateRepresentation(unsigned int index, int depth, int level,
+                              vtkPoints *pts, vtkCellArray *polys) const
+  {
+    const BVHNode& node = this->Nodes[index];
+    if (node.Size == 0 && depth < level)
+    {
+      this->GenerateRepresentation(index + 1, depth + 1, level, pts, polys);
+      this->GenerateRepresentation(node.Index, depth + 1, level, pts, polys);
+      return;
+    }
+
+    const float *b = node.Bounds;
+    vtkIdType ptIds[8];
+    for (int i = 0; i < 8; ++i)
+    {
+      ptIds[i] = pts->InsertNextPoint(b[i & 1], b[2 + ((i >> 1) & 1)],
+                                      b[4 + ((i >> 2) & 1)]);
+    }
+    static const int faces[6][4] = { {0, 4, 6, 2}, {1, 3, 7, 5},
+      {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6} };
+    for (int i = 0; i < 6; ++i)
+    {
+      polys->InsertNextCell(4);
+      for (int j = 0; j < 4; ++j)
+      {
+        polys->InsertCellPoint(ptIds[faces[i][j]]);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Here is the VTK class proper.
+
+//----------------------------------------------------------------------------
+vtkBVHCellLocator::vtkBVHCellLocator()
+{
+  this->CacheCellBounds = 1; //always cached
+  this->NumberOfCellsPerNode = 8;
+  this->NumberOfBins = 16;
+  this->Internals = new vtkInternals;
+}
+
+//----------------------------------------------------------------------------
+vtkBVHCellLocator::~vtkBVHCellLocator()
+{
+  this->FreeSearchStructure();
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::FreeSearchStructure()
+{
+  this->Internals->Free();
+  this->FreeCellBounds();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::BuildLocator()
+{
+  vtkDebugMacro( << "Building BVH cell locator" );
+
+  // Do we need to build?
+  if ( this->Internals->IsBuilt() && (this->BuildTime > this->MTime)
+       && (this->BuildTime > this->DataSet->GetMTime()) )
+  {
+    return;
+  }
+
+  vtkIdType numCells;
+  if ( !this->DataSet || (numCells = this->DataSet->GetNumberOfCells()) < 1 )
+  {
+    vtkErrorMacro( << "No cells to build");
+    return;
+  }
+  if ( numCells >= VTK_INT_MAX )
+  {
+    vtkErrorMacro( << "Too many cells to build: " << numCells);
+    return;
+  }
+
+  this->FreeSearchStructure();
+
+  // Compute the bounds and the centroids of the cells. The bounds of the
+  // first cell are computed serially to cause the non thread-safe
+  // initialization of the dataset to occur.
+  vtkDataSet *ds = this->DataSet;
+  double (*cellBounds)[6] = new double [numCells][6];
+  std::vector<double> centroids(3*numCells);
+  std::vector<vtkIdType>& cellIds = this->Internals->CellIds;
+  cellIds.resize(numCells);
+  ds->GetCellBounds(0, cellBounds[0]);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      double *b = cellBounds[cellId];
+      ds->GetCellBounds(cellId, b);
+      centroids[3*cellId] = 0.5 * (b[0] + b[1]);
+      centroids[3*cellId+1] = 0.5 * (b[2] + b[3]);
+      centroids[3*cellId+2] = 0.5 * (b[4] + b[5]);
+      cellIds[cellId] = cellId;
+    }
+  });
+  this->CellBounds = cellBounds;
+
+  BVHBuilder builder(cellBounds, centroids.data(), cellIds.data(),
+                     this->NumberOfCellsPerNode, this->NumberOfBins);
+  std::unique_ptr<BuildNode> root = builder.Build(0, numCells, 0);
+  this->Internals->Nodes.resize(root->NumberOfNodes);
+  builder.Flatten(root.get(), this->Internals->Nodes.data(), 0);
+  this->Level = root->Depth;
+
+  this->Internals->DataSet = ds;
+  this->Internals->CellBounds = cellBounds;
+  this->BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::GetNumberOfNodes()
+{
+  return static_cast<vtkIdType>(this->Internals->Nodes.size());
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::
+FindCell(double x[3], double vtkNotUsed(tol2), vtkGenericCell *cell,
+         double pcoords[3], double *weights)
+{
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return -1;
+  }
+  return this->Internals->FindCell(x, cell, pcoords, weights);
+}
+
+//----------------------------------------------------------------------------
+int vtkBVHCellLocator::
+IntersectWithLine(double p1[3], double p2[3], double tol,
+                  double &t, double x[3], double pcoords[3],
+                  int &subId, vtkIdType &cellId, vtkGenericCell *cell)
+{
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return 0;
+  }
+  return this->Internals->
+    IntersectWithLine(p1, p2, tol, t, x, pcoords, subId, cellId, cell);
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::
+IntersectWithLines(vtkPoints *p1, vtkPoints *p2, double tol,
+                   vtkIdTypeArray *cellIds, vtkDoubleArray *t, vtkPoints *x)
+{
+  vtkIdType numLines = p1->GetNumberOfPoints();
+  if ( p2->GetNumberOfPoints() != numLines )
+  {
+    vtkErrorMacro( << "The lines must have as many end points as start points");
+    return;
+  }
+
+  this->BuildLocator();
+  cellIds->SetNumberOfComponents(1);
+  cellIds->SetNumberOfTuples(numLines);
+  if ( t )
+  {
+    t->SetNumberOfComponents(1);
+    t->SetNumberOfTuples(numLines);
+  }
+  if ( x )
+  {
+    x->SetDataTypeToDouble();
+    x->SetNumberOfPoints(numLines);
+  }
+  if ( ! this->Internals->IsBuilt() )
+  {
+    cellIds->FillValue(-1);
+    return;
+  }
+
+  // Cause the non thread-safe initialization of the dataset to occur.
+  this->DataSet->GetCell(0, this->GenericCell);
+
+  const vtkInternals *internals = this->Internals;
+  vtkIdType *ids = cellIds->GetPointer(0);
+  double *tPtr = t ? t->GetPointer(0) : nullptr;
+  double *xPtr = x ?
+    vtkArrayDownCast<vtkDoubleArray>(x->GetData())->GetPointer(0) : nullptr;
+  vtkSMPThreadLocalObject<vtkGenericCell> localCell;
+  vtkSMPTools::For(0, numLines, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkGenericCell *cell = localCell.Local();
+    double a0[3], a1[3], tHit, xHit[3], pcoords[3];
+    int subId;
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      p1->GetPoint(i, a0);
+      p2->GetPoint(i, a1);
+      vtkIdType cellId = -1;
+      if ( internals->IntersectWithLine(a0, a1, tol, tHit, xHit, pcoords,
+                                        subId, cellId, cell) )
+      {
+        if ( tPtr )
+        {
+          tPtr[i] = tHit;
+        }
+        if ( xPtr )
+        {
+          std::copy(xHit, xHit + 3, xPtr + 3*i);
+        }
+      }
+      ids[i] = cellId;
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::
+FindCellsAlongLine(double p1[3], double p2[3], double tolerance,
+                   vtkIdList *cells)
+{
+  cells->Reset();
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return;
+  }
+  this->Internals->FindCellsAlongLine(p1, p2, tolerance, cells);
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::
+FindCellsWithinBounds(double *bbox, vtkIdList *cells)
+{
+  cells->Reset();
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return;
+  }
+  this->Internals->FindCellsWithinBounds(bbox, cells);
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::
+FindClosestPoint(double x[3], double closestPoint[3], vtkGenericCell *cell,
+                 vtkIdType &cellId, int &subId, double& dist2)
+{
+  int inside;
+  dist2 = -1.0;
+  this->FindClosestPointWithinSquaredRadius(
+    x, VTK_DOUBLE_MAX, closestPoint, cell, cellId, subId, dist2, inside);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::
+FindClosestPointWithinRadius(double x[3], double radius,
+                             double closestPoint[3], vtkGenericCell *cell,
+                             vtkIdType &cellId, int &subId, double& dist2,
+                             int &inside)
+{
+  return this->FindClosestPointWithinSquaredRadius(
+    x, radius*radius, closestPoint, cell, cellId, subId, dist2, inside);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::
+FindClosestPointWithinSquaredRadius(double x[3], double radius2,
+                                    double closestPoint[3],
+                                    vtkGenericCell *cell, vtkIdType &cellId,
+                                    int &subId, double& dist2, int &inside)
+{
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return 0;
+  }
+  return this->Internals->FindClosestPoint(
+    x, radius2, closestPoint, cell, cellId, subId, dist2, inside);
+}
+
+//----------------------------------------------------------------------------
+bool vtkBVHCellLocator::InsideCellBounds(double x[3], vtkIdType cellId)
+{
+  if ( ! this->CellBounds )
+  {
+    return this->Superclass::InsideCellBounds(x, cellId);
+  }
+  double delta[3] = {0.0, 0.0, 0.0};
+  return vtkMath::PointIsWithinBounds(x, this->CellBounds[cellId], delta) != 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::
+GenerateRepresentation(int level, vtkPolyData *pd)
+{
+  // Make sure locator has been built successfully
+  this->BuildLocator();
+  if ( ! this->Internals->IsBuilt() )
+  {
+    return;
+  }
+
+  vtkPoints *pts = vtkPoints::New();
+  pts->SetDataTypeToFloat();
+  vtkCellArray *polys = vtkCellArray::New();
+  this->Internals->GenerateRepresentation(0, 0, level, pts, polys);
+  pd->SetPoints(pts);
+  pd->SetPolys(polys);
+  polys->Delete();
+  pts->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Number Of Bins: " << this->NumberOfBins << "\n";
+  os << indent << "Number Of Nodes: " << this->Internals->Nodes.size() << "\n";
+}
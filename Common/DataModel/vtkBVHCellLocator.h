@@ -0,0 +1,198 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBVHCellLocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkBVHCellLocator
+ * @brief   cell locator based on a bounding volume hierarchy
+ *
+ * vtkBVHCellLocator is a type of vtkAbstractCellLocator that organizes the
+ * cells of a dataset into a binary bounding volume hierarchy (BVH). Each
+ * node of the hierarchy stores the bounding box of its cells, and the cells
+ * are split between the two children of a node so as to minimize the
+ * surface area heuristic (SAH), i.e. the expected cost of intersecting a
+ * ray with the children. The split candidates are the boundaries of
+ * NumberOfBins bins of the cell centroids along each axis ("binned SAH").
+ *
+ * The hierarchy is built with several threads (via vtkSMPTools): the
+ * centroids of the cells of large nodes are binned in parallel, and the two
+ * children of a node are built concurrently. The result does not depend on
+ * the number of threads. The nodes are stored in a single array, in depth
+ * first order so that the first child of a node follows it, with single
+ * precision bounds conservatively rounded outward, so that two nodes fit in
+ * a 64 bytes cache line.
+ *
+ * Each cell belongs to exactly one leaf, so the queries never have to
+ * remove duplicates, and they do not modify the locator: once it is built,
+ * queries given their own vtkGenericCell may be issued from several threads.
+ * IntersectWithLines() intersects a batch of line segments in parallel.
+ *
+ * @warning
+ * This class *always* caches cell bounds, and supports datasets of less than
+ * VTK_INT_MAX cells.
+ *
+ * @warning
+ * NumberOfCellsPerNode is the maximum number of cells of a leaf, except for
+ * pathological datasets whose hierarchy would be deeper than 64 levels.
+ *
+ * @sa
+ * vtkLocator vtkAbstractCellLocator vtkCellLocator vtkStaticCellLocator
+ * vtkCellTreeLocator vtkModifiedBSPTree
+ */
+
+#ifndef vtkBVHCellLocator_h
+#define vtkBVHCellLocator_h
+
+#include "vtkCommonDataModelModule.h" // For export macro
+#include "vtkAbstractCellLocator.h"
+
+class vtkDoubleArray;
+class vtkIdTypeArray;
+
+class VTKCOMMONDATAMODEL_EXPORT vtkBVHCellLocator : public vtkAbstractCellLocator
+{
+public:
+  //@{
+  /**
+   * Standard methods to instantiate, print and obtain type-related information.
+   */
+  static vtkBVHCellLocator *New();
+  vtkTypeMacro(vtkBVHCellLocator,vtkAbstractCellLocator);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+  //@}
+
+  // Re-use any superclass signatures that we don't override.
+  using vtkAbstractCellLocator::IntersectWithLine;
+  using vtkAbstractCellLocator::FindClosestPoint;
+  using vtkAbstractCellLocator::FindClosestPointWithinRadius;
+  using vtkAbstractCellLocator::FindCell;
+
+  //@{
+  /**
+   * Set the number of bins along each axis in which the cell centroids of a
+   * node are counted to evaluate the surface area heuristic. More bins give
+   * better splits but a slower build. Default 16.
+   */
+  vtkSetClampMacro(NumberOfBins,int,2,256);
+  vtkGetMacro(NumberOfBins,int);
+  //@}
+
+  /**
+   * Test a point to find if it is inside a cell. Returns the cellId if inside
+   * or -1 if not. The tolerance is not used.
+   */
+  vtkIdType FindCell(double x[3], double tol2, vtkGenericCell *cell,
+                     double pcoords[3], double *weights) override;
+
+  /**
+   * Return intersection point (if any) AND the cell which was intersected by
+   * the finite line. The cell is returned as a cell id and as a generic cell.
+   * The intersection is the one closest to p1.
+   */
+  int IntersectWithLine(double p1[3], double p2[3], double tol,
+                        double& t, double x[3], double pcoords[3],
+                        int &subId, vtkIdType &cellId,
+                        vtkGenericCell *cell) override;
+
+  /**
+   * Intersect a batch of finite lines with the cells, in parallel. The i-th
+   * line goes from the i-th point of p1 to the i-th point of p2. cellIds is
+   * resized to the number of lines and receives the id of the cell of the
+   * intersection closest to p1, or -1 when the line intersects no cell. The
+   * parametric coordinate of the intersections along the lines and the
+   * intersection points are also returned when t and x are not nullptr (both
+   * are undefined when there is no intersection).
+   */
+  void IntersectWithLines(vtkPoints *p1, vtkPoints *p2, double tol,
+                          vtkIdTypeArray *cellIds, vtkDoubleArray *t = nullptr,
+                          vtkPoints *x = nullptr);
+
+  /**
+   * Given a finite line defined by the two points (p1,p2), return the list
+   * of unique cell ids whose bounds, enlarged by tolerance, intersect the
+   * line.
+   */
+  void FindCellsAlongLine(double p1[3], double p2[3], double tolerance,
+                          vtkIdList *cells) override;
+
+  /**
+   * Return the list of unique cell ids whose bounds intersect the given
+   * bounding box.
+   */
+  void FindCellsWithinBounds(double *bbox, vtkIdList *cells) override;
+
+  /**
+   * Return the closest point and the cell which is closest to the point x.
+   * The closest point is somewhere on a cell, it need not be one of the
+   * vertices of the cell. If a cell is found, "cell" contains the points
+   * and ptIds for the cell "cellId" upon exit. dist2 is -1 when there are
+   * no cells.
+   */
+  void FindClosestPoint(double x[3], double closestPoint[3],
+                        vtkGenericCell *cell, vtkIdType &cellId,
+                        int &subId, double& dist2) override;
+
+  /**
+   * Return the closest point within a specified radius and the cell which
+   * is closest to the point x. This method returns 1 if a point is found
+   * within the specified radius, and 0 otherwise. If a point is found,
+   * "cell" contains the points and ptIds for the cell "cellId" upon exit,
+   * and inside is the return value of the EvaluatePosition call to the
+   * closest cell.
+   */
+  vtkIdType FindClosestPointWithinRadius(double x[3], double radius,
+                                         double closestPoint[3],
+                                         vtkGenericCell *cell,
+                                         vtkIdType &cellId, int &subId,
+                                         double& dist2, int &inside) override;
+
+  /**
+   * Quickly test if a point is inside the bounds of a particular cell.
+   */
+  bool InsideCellBounds(double x[3], vtkIdType cellId) override;
+
+  /**
+   * Return the number of nodes of the hierarchy, or 0 if it is not built.
+   */
+  vtkIdType GetNumberOfNodes();
+
+  //@{
+  /**
+   * Satisfy vtkLocator abstract interface. GenerateRepresentation() outputs
+   * the boxes of the nodes at the given depth, and of the leaves above it.
+   */
+  void GenerateRepresentation(int level, vtkPolyData *pd) override;
+  void FreeSearchStructure() override;
+  void BuildLocator() override;
+  //@}
+
+protected:
+  vtkBVHCellLocator();
+  ~vtkBVHCellLocator() override;
+
+  int NumberOfBins;
+
+  // Find the closest point to x among the cells closer than sqrt(radius2).
+  vtkIdType FindClosestPointWithinSquaredRadius(
+    double x[3], double radius2, double closestPoint[3], vtkGenericCell *cell,
+    vtkIdType &cellId, int &subId, double& dist2, int &inside);
+
+private:
+  vtkBVHCellLocator(const vtkBVHCellLocator&) = delete;
+  void operator=(const vtkBVHCellLocator&) = delete;
+
+  class vtkInternals;
+  vtkInternals *Internals;
+};
+
+#endif
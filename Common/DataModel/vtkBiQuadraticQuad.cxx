@@ -376,7 +376,7 @@ vtkBiQuadraticQuad::Derivatives (int vtkNotUsed (subId),
     {
       for (int i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
@@ -13,10 +13,234 @@
 
 =========================================================================*/
 #include "vtkCellArray.h"
+#include "vtkIdList.h"
 #include "vtkObjectFactory.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkTypeInt64Array.h"
+
+#include <algorithm>
 
 vtkStandardNewMacro(vtkCellArray);
 
+namespace
+{
+typedef vtkAOSDataArrayTemplate<vtkTypeInt32> vtkCellArrayArray32;
+typedef vtkAOSDataArrayTemplate<vtkTypeInt64> vtkCellArrayArray64;
+
+// Expose the stored ids without copy when they are vtkIdType.
+inline bool vtkCellArrayExposeIds(const vtkIdType *ids, vtkIdType const* &pts)
+{
+  pts = ids;
+  return true;
+}
+
+template <typename T>
+inline bool vtkCellArrayExposeIds(const T *, vtkIdType const* &)
+{
+  return false;
+}
+
+// Create an (empty) offsets storage of the given type.
+vtkDataArray *vtkCellArrayNewArray(int type)
+{
+  if (type == vtkCellArray::OFFSETS_32BIT_STORAGE)
+  {
+    return vtkTypeInt32Array::New();
+  }
+  return vtkTypeInt64Array::New();
+}
+
+template <typename T>
+void vtkCellArrayGetCell(vtkAOSDataArrayTemplate<T> *offsets,
+                         vtkAOSDataArrayTemplate<T> *conn,
+                         vtkIdType cellId, vtkIdType &npts,
+                         vtkIdType const* &pts, vtkIdList *ptIds)
+{
+  const T *o = offsets->GetPointer(0);
+  vtkIdType beg = static_cast<vtkIdType>(o[cellId]);
+  npts = static_cast<vtkIdType>(o[cellId+1]) - beg;
+  const T *c = conn->GetPointer(0) + beg;
+  if (!vtkCellArrayExposeIds(c, pts))
+  {
+    ptIds->SetNumberOfIds(npts);
+    vtkIdType *ids = ptIds->GetPointer(0);
+    for (vtkIdType i=0; i < npts; ++i)
+    {
+      ids[i] = static_cast<vtkIdType>(c[i]);
+    }
+    pts = ids;
+  }
+}
+
+// Binary search of the cell whose legacy location is loc. The legacy
+// location of cell i is offsets[i]+i, which increases strictly with i.
+template <typename T>
+vtkIdType vtkCellArrayFindLocation(vtkAOSDataArrayTemplate<T> *offsets,
+                                   vtkIdType numCells, vtkIdType loc)
+{
+  const T *o = offsets->GetPointer(0);
+  vtkIdType lo = 0, hi = numCells;
+  while (lo < hi)
+  {
+    vtkIdType mid = lo + (hi - lo) / 2;
+    if (static_cast<vtkIdType>(o[mid]) + mid < loc)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <typename T>
+void vtkCellArrayReverse(vtkAOSDataArrayTemplate<T> *offsets,
+                         vtkAOSDataArrayTemplate<T> *conn, vtkIdType cellId)
+{
+  const T *o = offsets->GetPointer(0);
+  T *c = conn->GetPointer(0);
+  std::reverse(c + o[cellId], c + o[cellId+1]);
+}
+
+template <typename T>
+void vtkCellArrayReplace(vtkAOSDataArrayTemplate<T> *offsets,
+                         vtkAOSDataArrayTemplate<T> *conn, vtkIdType cellId,
+                         vtkIdType npts, const vtkIdType *pts)
+{
+  T *c = conn->GetPointer(0) + offsets->GetValue(cellId);
+  for (vtkIdType i=0; i < npts; ++i)
+  {
+    c[i] = static_cast<T>(pts[i]);
+  }
+}
+
+template <typename T>
+vtkIdType vtkCellArrayMaxCellSize(vtkAOSDataArrayTemplate<T> *offsets,
+                                  vtkIdType numCells)
+{
+  const T *o = offsets->GetPointer(0);
+  vtkIdType maxSize = 0;
+  for (vtkIdType i=0; i < numCells; ++i)
+  {
+    maxSize = std::max(maxSize, static_cast<vtkIdType>(o[i+1] - o[i]));
+  }
+  return maxSize;
+}
+
+template <typename T>
+void vtkCellArrayAppend(vtkAOSDataArrayTemplate<T> *offsets,
+                        vtkAOSDataArrayTemplate<T> *conn,
+                        vtkIdType npts, const vtkIdType *pts)
+{
+  vtkIdType beg = conn->GetNumberOfValues();
+  T *c = conn->WritePointer(beg, npts);
+  for (vtkIdType i=0; i < npts; ++i)
+  {
+    c[i] = static_cast<T>(pts[i]);
+  }
+  offsets->InsertNextValue(static_cast<T>(beg + npts));
+}
+
+// Fill the offsets storage from the legacy layout.
+template <typename T>
+void vtkCellArrayFromLegacy(vtkIdTypeArray *ia, vtkIdType numCells,
+                            vtkAOSDataArrayTemplate<T> *offsets,
+                            vtkAOSDataArrayTemplate<T> *conn)
+{
+  const vtkIdType *legacy = ia->GetPointer(0);
+  vtkIdType size = ia->GetNumberOfValues();
+  numCells = std::min(numCells, size);
+
+  offsets->SetNumberOfValues(numCells + 1);
+  conn->SetNumberOfValues(std::max(size - numCells, vtkIdType(0)));
+  T *o = offsets->GetPointer(0);
+  T *c = conn->GetPointer(0);
+
+  vtkIdType loc = 0, offset = 0;
+  for (vtkIdType cellId=0; cellId < numCells; ++cellId)
+  {
+    o[cellId] = static_cast<T>(offset);
+    vtkIdType npts = legacy[loc++];
+    for (vtkIdType i=0; i < npts; ++i)
+    {
+      c[offset++] = static_cast<T>(legacy[loc++]);
+    }
+  }
+  o[numCells] = static_cast<T>(offset);
+  conn->SetNumberOfValues(offset);
+}
+
+// Fill the legacy layout from the offsets storage.
+template <typename T>
+void vtkCellArrayToLegacy(vtkAOSDataArrayTemplate<T> *offsets,
+                          vtkAOSDataArrayTemplate<T> *conn,
+                          vtkIdType numCells, vtkIdTypeArray *ia)
+{
+  const T *o = offsets->GetPointer(0);
+  const T *c = conn->GetPointer(0);
+  vtkIdType *legacy = ia->WritePointer(0, conn->GetNumberOfValues() + numCells);
+  for (vtkIdType cellId=0; cellId < numCells; ++cellId)
+  {
+    *legacy++ = static_cast<vtkIdType>(o[cellId+1] - o[cellId]);
+    for (T i=o[cellId]; i < o[cellId+1]; ++i)
+    {
+      *legacy++ = static_cast<vtkIdType>(c[i]);
+    }
+  }
+}
+
+// Copy an offsets storage into another one (possibly of another type).
+template <typename TIn, typename TOut>
+void vtkCellArrayCopy(vtkAOSDataArrayTemplate<TIn> *inOffsets,
+                      vtkAOSDataArrayTemplate<TIn> *inConn,
+                      vtkAOSDataArrayTemplate<TOut> *outOffsets,
+                      vtkAOSDataArrayTemplate<TOut> *outConn)
+{
+  vtkIdType numOffsets = inOffsets->GetNumberOfValues();
+  vtkIdType numConn = inConn->GetNumberOfValues();
+  const TIn *io = inOffsets->GetPointer(0);
+  const TIn *ic = inConn->GetPointer(0);
+  TOut *oo = outOffsets->WritePointer(0, numOffsets);
+  TOut *oc = outConn->WritePointer(0, numConn);
+  std::copy(io, io + numOffsets, oo);
+  std::copy(ic, ic + numConn, oc);
+}
+
+// Largest point id referenced by the offsets storage.
+template <typename T>
+vtkIdType vtkCellArrayMaxId(vtkAOSDataArrayTemplate<T> *conn)
+{
+  const T *c = conn->GetPointer(0);
+  vtkIdType numConn = conn->GetNumberOfValues();
+  return numConn > 0 ?
+    static_cast<vtkIdType>(*std::max_element(c, c + numConn)) : 0;
+}
+}
+
+// Dispatch a call to one of the templated helpers according to the storage
+// type of this cell array.
+#define vtkCellArrayOffsetsCall(call, offsets, conn)                      \
+  if (this->StorageType == OFFSETS_32BIT_STORAGE)                         \
+  {                                                                       \
+    vtkCellArrayArray32 *offsets =                                        \
+      static_cast<vtkCellArrayArray32*>(this->Offsets);                   \
+    vtkCellArrayArray32 *conn =                                           \
+      static_cast<vtkCellArrayArray32*>(this->Connectivity);              \
+    (void)offsets; (void)conn;                                            \
+    call;                                                                 \
+  }                                                                       \
+  else                                                                    \
+  {                                                                       \
+    vtkCellArrayArray64 *offsets =                                        \
+      static_cast<vtkCellArrayArray64*>(this->Offsets);                   \
+    vtkCellArrayArray64 *conn =                                           \
+      static_cast<vtkCellArrayArray64*>(this->Connectivity);              \
+    (void)offsets; (void)conn;                                            \
+    call;                                                                 \
+  }
+
 //----------------------------------------------------------------------------
 vtkCellArray::vtkCellArray()
 {
@@ -24,36 +248,371 @@ vtkCellArray::vtkCellArray()
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
+
+  this->StorageType = LEGACY_STORAGE;
+  this->Offsets = nullptr;
+  this->Connectivity = nullptr;
+  this->TraversalCellId = 0;
+  this->TraversalIds = nullptr;
 }
 
 //----------------------------------------------------------------------------
 void vtkCellArray::DeepCopy (vtkCellArray *ca)
 {
   // Do nothing on a nullptr input.
-  if (ca == nullptr)
+  if (ca == nullptr || ca == this)
   {
     return;
   }
 
-  this->Ia->DeepCopy(ca->Ia);
+  this->DiscardStorage(ca->StorageType);
+  if (ca->StorageType == LEGACY_STORAGE)
+  {
+    this->Ia->DeepCopy(ca->Ia);
+  }
+  else
+  {
+    this->Offsets->DeepCopy(ca->Offsets);
+    this->Connectivity->DeepCopy(ca->Connectivity);
+  }
   this->NumberOfCells = ca->NumberOfCells;
   this->InsertLocation = ca->InsertLocation;
   this->TraversalLocation = ca->TraversalLocation;
+  this->TraversalCellId = ca->TraversalCellId;
 }
 
 //----------------------------------------------------------------------------
 vtkCellArray::~vtkCellArray()
 {
   this->Ia->Delete();
+  if (this->Offsets)
+  {
+    this->Offsets->Delete();
+    this->Connectivity->Delete();
+  }
+  if (this->TraversalIds)
+  {
+    this->TraversalIds->Delete();
+  }
+}
+
+//----------------------------------------------------------------------------
+// Drop the current cells and set up an empty storage of the given type.
+void vtkCellArray::DiscardStorage(int type)
+{
+  if (this->Offsets)
+  {
+    this->Offsets->Delete();
+    this->Connectivity->Delete();
+    this->Offsets = nullptr;
+    this->Connectivity = nullptr;
+  }
+  // The legacy array may be shared (see SetCells()), so it is replaced
+  // rather than cleared.
+  if (this->Ia->GetNumberOfValues() > 0 || this->Ia->GetReferenceCount() > 1)
+  {
+    this->Ia->Delete();
+    this->Ia = vtkIdTypeArray::New();
+  }
+
+  this->StorageType = type;
+  if (type != LEGACY_STORAGE)
+  {
+    this->Offsets = vtkCellArrayNewArray(type);
+    this->Connectivity = vtkCellArrayNewArray(type);
+    this->Offsets->InsertTuple1(0, 0);
+  }
+
+  this->NumberOfCells = 0;
+  this->InsertLocation = 0;
+  this->TraversalLocation = 0;
+  this->TraversalCellId = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::SetStorageType(int type)
+{
+  if (type < LEGACY_STORAGE || type > OFFSETS_64BIT_STORAGE)
+  {
+    vtkErrorMacro("Unknown storage type " << type);
+    return;
+  }
+  if (this->ConvertStorage(type))
+  {
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+// Convert the cells to the given storage type. The cells themselves do not
+// change, so the cell array is not marked as modified. Returns false if the
+// storage type is unchanged.
+bool vtkCellArray::ConvertStorage(int type)
+{
+  if (type == OFFSETS_32BIT_STORAGE && !this->CanConvertTo32BitStorage())
+  {
+    type = OFFSETS_64BIT_STORAGE;
+  }
+  if (type == this->StorageType)
+  {
+    return false;
+  }
+
+  vtkIdType numCells = this->NumberOfCells;
+  vtkIdType traversalLoc = this->GetTraversalLocation();
+  vtkIdTypeArray *ia = this->Ia;
+  ia->Register(this);
+  vtkDataArray *offsets = this->Offsets;
+  vtkDataArray *conn = this->Connectivity;
+  if (offsets)
+  {
+    offsets->Register(this);
+    conn->Register(this);
+  }
+  int oldType = this->StorageType;
+
+  this->DiscardStorage(type);
+
+  if (oldType == LEGACY_STORAGE)
+  {
+    if (type == OFFSETS_32BIT_STORAGE)
+    {
+      vtkCellArrayFromLegacy(ia, numCells,
+        static_cast<vtkCellArrayArray32*>(this->Offsets),
+        static_cast<vtkCellArrayArray32*>(this->Connectivity));
+    }
+    else
+    {
+      vtkCellArrayFromLegacy(ia, numCells,
+        static_cast<vtkCellArrayArray64*>(this->Offsets),
+        static_cast<vtkCellArrayArray64*>(this->Connectivity));
+    }
+  }
+  else if (oldType == OFFSETS_32BIT_STORAGE)
+  {
+    vtkCellArrayArray32 *o = static_cast<vtkCellArrayArray32*>(offsets);
+    vtkCellArrayArray32 *c = static_cast<vtkCellArrayArray32*>(conn);
+    if (type == LEGACY_STORAGE)
+    {
+      vtkCellArrayToLegacy(o, c, numCells, this->Ia);
+    }
+    else
+    {
+      vtkCellArrayCopy(o, c,
+        static_cast<vtkCellArrayArray64*>(this->Offsets),
+        static_cast<vtkCellArrayArray64*>(this->Connectivity));
+    }
+  }
+  else
+  {
+    vtkCellArrayArray64 *o = static_cast<vtkCellArrayArray64*>(offsets);
+    vtkCellArrayArray64 *c = static_cast<vtkCellArrayArray64*>(conn);
+    if (type == LEGACY_STORAGE)
+    {
+      vtkCellArrayToLegacy(o, c, numCells, this->Ia);
+    }
+    else
+    {
+      vtkCellArrayCopy(o, c,
+        static_cast<vtkCellArrayArray32*>(this->Offsets),
+        static_cast<vtkCellArrayArray32*>(this->Connectivity));
+    }
+  }
+
+  ia->UnRegister(this);
+  if (offsets)
+  {
+    offsets->UnRegister(this);
+    conn->UnRegister(this);
+  }
+
+  this->NumberOfCells = numCells;
+  this->InsertLocation = this->Ia->GetNumberOfValues();
+  this->SetTraversalLocation(traversalLoc);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::SetStorageTypeToOffsets()
+{
+  this->SetStorageType(this->CanConvertTo32BitStorage() ?
+    OFFSETS_32BIT_STORAGE : OFFSETS_64BIT_STORAGE);
+}
+
+//----------------------------------------------------------------------------
+const char *vtkCellArray::GetStorageTypeAsString()
+{
+  switch (this->StorageType)
+  {
+    case OFFSETS_32BIT_STORAGE:
+      return "Offsets32Bit";
+    case OFFSETS_64BIT_STORAGE:
+      return "Offsets64Bit";
+    default:
+      return "Legacy";
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkCellArray::CanConvertTo32BitStorage()
+{
+  if (this->StorageType == OFFSETS_32BIT_STORAGE)
+  {
+    return true;
+  }
+
+  vtkIdType maxId = 0, connSize;
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    connSize = this->Ia->GetNumberOfValues();
+    const vtkIdType *legacy = this->Ia->GetPointer(0);
+    for (vtkIdType loc=0; loc < connSize; loc += legacy[loc] + 1)
+    {
+      for (vtkIdType i=1; i <= legacy[loc] && loc + i < connSize; ++i)
+      {
+        maxId = std::max(maxId, legacy[loc+i]);
+      }
+    }
+  }
+  else
+  {
+    connSize = this->Connectivity->GetNumberOfValues();
+    maxId = vtkCellArrayMaxId(
+      static_cast<vtkCellArrayArray64*>(this->Connectivity));
+  }
+
+  return maxId <= VTK_TYPE_INT32_MAX && connSize <= VTK_TYPE_INT32_MAX;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCellArray::SetData(vtkDataArray *offsets, vtkDataArray *connectivity)
+{
+  if (!offsets || !connectivity ||
+      offsets->GetNumberOfComponents() != 1 ||
+      connectivity->GetNumberOfComponents() != 1 ||
+      offsets->GetNumberOfTuples() < 1)
+  {
+    vtkErrorMacro("Invalid offsets or connectivity array.");
+    return false;
+  }
+
+  int type;
+  if (vtkArrayDownCast<vtkCellArrayArray32>(offsets) &&
+      vtkArrayDownCast<vtkCellArrayArray32>(connectivity))
+  {
+    type = OFFSETS_32BIT_STORAGE;
+  }
+  else if (vtkArrayDownCast<vtkCellArrayArray64>(offsets) &&
+           vtkArrayDownCast<vtkCellArrayArray64>(connectivity))
+  {
+    type = OFFSETS_64BIT_STORAGE;
+  }
+  else
+  {
+    vtkErrorMacro("The offsets and connectivity arrays must both be "
+                  "32-bit or both be 64-bit integer arrays.");
+    return false;
+  }
+
+  vtkIdType numCells = offsets->GetNumberOfTuples() - 1;
+  if (offsets->GetTuple1(0) != 0 ||
+      static_cast<vtkIdType>(offsets->GetTuple1(numCells)) !=
+        connectivity->GetNumberOfTuples())
+  {
+    vtkErrorMacro("The offsets do not match the connectivity array.");
+    return false;
+  }
+
+  offsets->Register(this);
+  connectivity->Register(this);
+  this->DiscardStorage(LEGACY_STORAGE);
+  this->StorageType = type;
+  this->Offsets = offsets;
+  this->Connectivity = connectivity;
+  this->NumberOfCells = numCells;
+  this->Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+int vtkCellArray::Allocate(vtkIdType sz, vtkIdType ext)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    return this->Ia->Allocate(sz,ext);
+  }
+
+  // Allocate() empties the arrays; the offsets always start with 0.
+  this->NumberOfCells = 0;
+  this->InsertLocation = 0;
+  this->TraversalCellId = 0;
+  int ok = this->Connectivity->Allocate(sz,ext);
+  ok &= this->Offsets->Allocate(sz/4+1,ext);
+  this->Offsets->InsertTuple1(0, 0);
+  return ok;
 }
 
 //----------------------------------------------------------------------------
 void vtkCellArray::Initialize()
 {
   this->Ia->Initialize();
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->Offsets->Initialize();
+    this->Connectivity->Initialize();
+    this->Offsets->InsertTuple1(0, 0);
+  }
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
+  this->TraversalCellId = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::Reset()
+{
+  this->NumberOfCells = 0;
+  this->InsertLocation = 0;
+  this->TraversalLocation = 0;
+  this->TraversalCellId = 0;
+  this->Ia->Reset();
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->Offsets->Reset();
+    this->Connectivity->Reset();
+    this->Offsets->InsertTuple1(0, 0);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::Squeeze()
+{
+  this->Ia->Squeeze();
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->Offsets->Squeeze();
+    this->Connectivity->Squeeze();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetSize()
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    return this->Ia->GetSize();
+  }
+  return this->Connectivity->GetSize() + this->NumberOfCells;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetNumberOfConnectivityEntries()
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    return this->Ia->GetMaxId()+1;
+  }
+  return this->Connectivity->GetNumberOfValues() + this->NumberOfCells;
 }
 
 //----------------------------------------------------------------------------
@@ -61,6 +620,14 @@ void vtkCellArray::Initialize()
 // defining the cell.
 int vtkCellArray::GetMaxCellSize()
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    vtkIdType maxSize = 0;
+    vtkCellArrayOffsetsCall(
+      maxSize = vtkCellArrayMaxCellSize(o, this->NumberOfCells), o, c);
+    return static_cast<int>(maxSize);
+  }
+
   int npts=0, maxSize=0;
   vtkIdType i;
 
@@ -80,6 +647,12 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
 {
   if ( cells && cells != this->Ia )
   {
+    int storage = this->StorageType;
+    if (storage != LEGACY_STORAGE)
+    {
+      this->DiscardStorage(LEGACY_STORAGE);
+    }
+
     this->Modified();
     this->Ia->Delete();
     this->Ia = cells;
@@ -88,18 +661,40 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
     this->NumberOfCells = ncells;
     this->InsertLocation = cells->GetMaxId() + 1;
     this->TraversalLocation = 0;
+
+    if (storage != LEGACY_STORAGE)
+    {
+      this->SetStorageType(storage);
+    }
   }
 }
 
 //----------------------------------------------------------------------------
 unsigned long vtkCellArray::GetActualMemorySize()
 {
-  return this->Ia->GetActualMemorySize();
+  unsigned long size = this->Ia->GetActualMemorySize();
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    size += this->Offsets->GetActualMemorySize();
+    size += this->Connectivity->GetActualMemorySize();
+  }
+  return size;
 }
 
 //----------------------------------------------------------------------------
 int vtkCellArray::GetNextCell(vtkIdList *pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    // Copy the ids without converting the storage.
+    if (this->TraversalCellId < this->NumberOfCells)
+    {
+      this->GetCellAtId(this->TraversalCellId++, pts);
+      return 1;
+    }
+    return 0;
+  }
+
   vtkIdType npts, *ppts;
   if (this->GetNextCell(npts, ppts))
   {
@@ -113,9 +708,29 @@ int vtkCellArray::GetNextCell(vtkIdList *pts)
   return 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
+                           vtkIdType const* &pts, vtkIdList *ptIds)
+{
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->GetCellAtId(this->LocationToCellId(loc), npts, pts, ptIds);
+    return;
+  }
+
+  npts = this->Ia->GetValue(loc++);
+  pts = this->Ia->GetPointer(loc);
+}
+
 //----------------------------------------------------------------------------
 void vtkCellArray::GetCell(vtkIdType loc, vtkIdList *pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->GetCellAtId(this->LocationToCellId(loc), pts);
+    return;
+  }
+
   vtkIdType npts = this->Ia->GetValue(loc++);
   vtkIdType *ppts = this->Ia->GetPointer(loc);
   pts->SetNumberOfIds(npts);
@@ -125,12 +740,252 @@ void vtkCellArray::GetCell(vtkIdType loc, vtkIdList *pts)
   }
 }
 
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetCellSize(vtkIdType cellId)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    vtkIdType npts;
+    vtkIdType const* pts;
+    this->GetCellAtId(cellId, npts, pts, nullptr);
+    return npts;
+  }
+  return static_cast<vtkIdType>(this->Offsets->GetTuple1(cellId+1) -
+                                this->Offsets->GetTuple1(cellId));
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdType &npts,
+                               vtkIdType const* &pts, vtkIdList *ptIds)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    // No random access: walk the cells up to the one requested.
+    const vtkIdType *legacy = this->Ia->GetPointer(0);
+    vtkIdType loc = 0;
+    for (vtkIdType i=0; i < cellId; ++i)
+    {
+      loc += legacy[loc] + 1;
+    }
+    npts = legacy[loc];
+    pts = legacy + loc + 1;
+    return;
+  }
+
+  vtkCellArrayOffsetsCall(
+    vtkCellArrayGetCell(o, c, cellId, npts, pts, ptIds), o, c);
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdList *pts)
+{
+  vtkIdType npts;
+  vtkIdType const* ppts;
+  this->GetCellAtId(cellId, npts, ppts, pts);
+  if (ppts != pts->GetPointer(0))
+  {
+    pts->SetNumberOfIds(npts);
+    std::copy(ppts, ppts + npts, pts->GetPointer(0));
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::ReverseCellAtId(vtkIdType cellId)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    vtkIdType npts;
+    vtkIdType const* pts;
+    this->GetCellAtId(cellId, npts, pts, nullptr);
+    this->ReverseCell(pts - 1 - this->Ia->GetPointer(0));
+    return;
+  }
+
+  vtkCellArrayOffsetsCall(vtkCellArrayReverse(o, c, cellId), o, c);
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::ReplaceCellAtId(vtkIdType cellId, vtkIdType npts,
+                                   const vtkIdType *pts)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    vtkIdType n;
+    vtkIdType const* oldPts;
+    this->GetCellAtId(cellId, n, oldPts, nullptr);
+    this->ReplaceCell(oldPts - 1 - this->Ia->GetPointer(0),
+                      static_cast<int>(npts), pts);
+    return;
+  }
+
+  if (this->StorageType == OFFSETS_32BIT_STORAGE && npts > 0 &&
+      *std::max_element(pts, pts + npts) > VTK_TYPE_INT32_MAX)
+  {
+    this->SetStorageType(OFFSETS_64BIT_STORAGE);
+  }
+  vtkCellArrayOffsetsCall(vtkCellArrayReplace(o, c, cellId, npts, pts), o, c);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetInsertLocation()
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    return this->InsertLocation;
+  }
+  return this->Connectivity->GetNumberOfValues() + this->NumberOfCells;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetTraversalLocation()
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    return this->TraversalLocation;
+  }
+  return static_cast<vtkIdType>(
+    this->Offsets->GetTuple1(this->TraversalCellId)) + this->TraversalCellId;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::SetTraversalLocation(vtkIdType loc)
+{
+  if (this->StorageType == LEGACY_STORAGE)
+  {
+    this->TraversalLocation = loc;
+    return;
+  }
+  this->TraversalCellId = this->LocationToCellId(loc);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::LocationToCellId(vtkIdType loc)
+{
+  vtkIdType cellId = 0;
+  vtkCellArrayOffsetsCall(
+    cellId = vtkCellArrayFindLocation(o, this->NumberOfCells, loc), o, c);
+  return cellId;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::InsertNextCellWithOffsets(vtkIdType npts,
+                                             const vtkIdType* pts)
+{
+  if (this->StorageType == OFFSETS_32BIT_STORAGE &&
+      (this->Connectivity->GetNumberOfValues() + npts > VTK_TYPE_INT32_MAX ||
+       (npts > 0 && *std::max_element(pts, pts + npts) > VTK_TYPE_INT32_MAX)))
+  {
+    this->SetStorageType(OFFSETS_64BIT_STORAGE);
+  }
+  vtkCellArrayOffsetsCall(vtkCellArrayAppend(o, c, npts, pts), o, c);
+  this->NumberOfCells++;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::InsertNextCellWithOffsets(int)
+{
+  // The new cell starts empty; InsertCellPoint() extends it.
+  this->Offsets->InsertTuple1(this->NumberOfCells + 1,
+    this->Offsets->GetTuple1(this->NumberOfCells));
+  this->NumberOfCells++;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::InsertCellPointWithOffsets(vtkIdType id)
+{
+  if (this->StorageType == OFFSETS_32BIT_STORAGE &&
+      (id > VTK_TYPE_INT32_MAX ||
+       this->Connectivity->GetNumberOfValues() >= VTK_TYPE_INT32_MAX))
+  {
+    this->SetStorageType(OFFSETS_64BIT_STORAGE);
+  }
+  vtkCellArrayOffsetsCall(
+    c->InsertNextValue(id);
+    o->SetValue(this->NumberOfCells, c->GetNumberOfValues()), o, c);
+}
+
+//----------------------------------------------------------------------------
+int vtkCellArray::GetNextCellWithOffsets(vtkIdType& npts, vtkIdType* &pts)
+{
+  if (this->TraversalCellId < this->NumberOfCells)
+  {
+    // The ids are exposed without copy when they are stored as vtkIdType;
+    // otherwise the cell is copied rather than converting the storage.
+    vtkIdList *ids = nullptr;
+    if (!this->IsIdTypeStorage())
+    {
+      if (!this->TraversalIds)
+      {
+        this->TraversalIds = vtkIdList::New();
+      }
+      ids = this->TraversalIds;
+    }
+    vtkIdType const* cpts;
+    this->GetCellAtId(this->TraversalCellId++, npts, cpts, ids);
+    pts = const_cast<vtkIdType*>(cpts);
+    return 1;
+  }
+  npts=0;
+  pts=nullptr;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCellWithOffsets(vtkIdType loc, vtkIdType &npts,
+                                      vtkIdType* &pts)
+{
+  if (!this->IsIdTypeStorage())
+  {
+    vtkErrorMacro("Cannot return a vtkIdType pointer into a "
+                  << this->GetStorageTypeAsString() << " cell array. "
+                  "Use GetCellAtId() or the const GetCell() overload.");
+    npts=0;
+    pts=nullptr;
+    return;
+  }
+
+  // The ids are exposed without copy, so no id list is needed.
+  vtkIdType const* cpts;
+  this->GetCellAtId(this->LocationToCellId(loc), npts, cpts, nullptr);
+  pts = const_cast<vtkIdType*>(cpts);
+}
+
+//----------------------------------------------------------------------------
+#ifdef VTK_USE_64BIT_IDS
+#define VTK_CELL_ARRAY_ID_TYPE_STORAGE vtkCellArray::OFFSETS_64BIT_STORAGE
+#else
+#define VTK_CELL_ARRAY_ID_TYPE_STORAGE vtkCellArray::OFFSETS_32BIT_STORAGE
+#endif
+
+//----------------------------------------------------------------------------
+bool vtkCellArray::IsIdTypeStorage()
+{
+  return this->StorageType == LEGACY_STORAGE ||
+         this->StorageType == VTK_CELL_ARRAY_ID_TYPE_STORAGE;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::UseIdTypeStorage()
+{
+  if (this->IsIdTypeStorage())
+  {
+    return;
+  }
+  this->ConvertStorage(VTK_CELL_ARRAY_ID_TYPE_STORAGE);
+  if (!this->IsIdTypeStorage())
+  {
+    this->ConvertStorage(LEGACY_STORAGE);
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkCellArray::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Number Of Cells: " << this->NumberOfCells << endl;
-  os << indent << "Insert Location: " << this->InsertLocation << endl;
-  os << indent << "Traversal Location: " << this->TraversalLocation << endl;
+  os << indent << "Insert Location: " << this->GetInsertLocation() << endl;
+  os << indent << "Traversal Location: "
+     << this->GetTraversalLocation() << endl;
+  os << indent << "Storage Type: " << this->GetStorageTypeAsString() << endl;
 }
@@ -28,6 +28,27 @@
  * using the vtkCellTypes and vtkCellLinks objects to extend the definition of
  * the data structure.
  *
+ * Alternatively, the cells may be kept in an offsets storage (see
+ * SetStorageType()). In this mode the point ids of all cells are stored
+ * contiguously in a connectivity array, and an offsets array of
+ * (NumberOfCells+1) values marks where each cell begins in the
+ * connectivity array (the last value is the size of the connectivity
+ * array). Both arrays are either 32-bit or 64-bit integers; the 32-bit
+ * variant roughly halves the memory of the connectivity when the ids fit.
+ * Offsets storage provides O(1) random access to any cell through
+ * GetCellAtId(), which is safe to call concurrently from several threads as
+ * long as the cell array is not modified. The legacy, location based
+ * methods (GetCell(loc,...), ReverseCell(), GetTraversalLocation() etc.)
+ * keep working on offsets storage: a location is the position the cell
+ * would have in the legacy (n,id1,id2,...) layout. Methods which expose the
+ * legacy layout directly (GetPointer(), GetData(), WritePointer()) convert
+ * the cell array back to legacy storage. When the ids are not stored as
+ * vtkIdType (32-bit offsets storage with 64-bit vtkIdType), the methods
+ * returning a non-const vtkIdType pointer cannot point into the cell array:
+ * GetNextCell() returns a copy of the cell and GetCell(loc,npts,pts) reports
+ * an error. Use GetCellAtId() or the const GetCell() overload instead, or
+ * convert the storage explicitly with UseIdTypeStorage().
+ *
  * @sa
  * vtkCellTypes vtkCellLinks
 */
@@ -53,10 +74,95 @@ public:
   static vtkCellArray *New();
 
   /**
-   * Allocate memory and set the size to extend by.
+   * The ways in which cells can be stored. LEGACY_STORAGE is the
+   * interleaved (n,id1,id2,...) list; the OFFSETS storages keep separate
+   * offsets and connectivity arrays of 32-bit or 64-bit integers.
+   */
+  enum StorageTypes
+  {
+    LEGACY_STORAGE = 0,
+    OFFSETS_32BIT_STORAGE = 1,
+    OFFSETS_64BIT_STORAGE = 2
+  };
+
+  //@{
+  /**
+   * Specify how the cells are stored (LEGACY_STORAGE by default). Changing
+   * the storage type converts any cells already present. Requesting
+   * OFFSETS_32BIT_STORAGE when the ids (or the size of the connectivity)
+   * cannot be represented with 32 bits results in OFFSETS_64BIT_STORAGE.
+   * Likewise, a 32-bit storage is promoted to 64-bit when a cell inserted
+   * later no longer fits. SetStorageTypeToOffsets() selects the smallest
+   * offsets storage able to represent the current cells.
+   */
+  void SetStorageType(int type);
+  int GetStorageType()
+    {return this->StorageType;}
+  void SetStorageTypeToLegacy()
+    {this->SetStorageType(LEGACY_STORAGE);}
+  void SetStorageTypeToOffsets32Bit()
+    {this->SetStorageType(OFFSETS_32BIT_STORAGE);}
+  void SetStorageTypeToOffsets64Bit()
+    {this->SetStorageType(OFFSETS_64BIT_STORAGE);}
+  void SetStorageTypeToOffsets();
+  const char *GetStorageTypeAsString();
+  //@}
+
+  /**
+   * Return true if all point ids and the size of the connectivity can be
+   * represented with 32-bit integers.
+   */
+  bool CanConvertTo32BitStorage();
+
+  /**
+   * Return whether the cells are kept in one of the offsets storages.
+   */
+  bool IsOffsetsStorage()
+    {return this->StorageType != LEGACY_STORAGE;}
+
+  /**
+   * Return true if the point ids are stored as vtkIdType, i.e. with the
+   * legacy storage or with the offsets storage of the width of vtkIdType.
+   */
+  bool IsIdTypeStorage();
+
+  /**
+   * Convert an offsets storage whose ids are not vtkIdType to the offsets
+   * storage whose ids are (or to the legacy storage if that is not
+   * possible), so that the methods returning a vtkIdType pointer, such as
+   * GetCell() and GetNextCell(), point directly into the cell array. This
+   * gives up the memory saved by the 32-bit storage; it is never done
+   * implicitly.
+   */
+  void UseIdTypeStorage();
+
+  //@{
+  /**
+   * Access the offsets and connectivity arrays of the offsets storages. The
+   * arrays are vtkTypeInt32Array or vtkTypeInt64Array depending on the
+   * storage type. nullptr is returned when using the legacy storage.
+   */
+  vtkDataArray *GetOffsetsArray()
+    {return this->Offsets;}
+  vtkDataArray *GetConnectivityArray()
+    {return this->Connectivity;}
+  //@}
+
+  /**
+   * Define all the cells of the array with offsets and connectivity arrays
+   * (no copy is made). Both arrays must hold values of the same integral
+   * type, either 32-bit or 64-bit; the storage type is set accordingly.
+   * offsets has (number of cells + 1) values, starting with 0 and ending
+   * with the number of values in connectivity. Returns false (and leaves
+   * the cell array untouched) if the arrays are not suitable.
+   */
+  bool SetData(vtkDataArray *offsets, vtkDataArray *connectivity);
+
+  /**
+   * Allocate memory and set the size to extend by. sz is expressed as the
+   * size of the legacy (n,id1,id2,...) layout (see EstimateSize()).
    */
-  int Allocate(vtkIdType sz, vtkIdType ext=1000)
-    {return this->Ia->Allocate(sz,ext);}
+  int Allocate(vtkIdType sz, vtkIdType ext=1000);
 
   /**
    * Free any memory and reset to an empty state.
@@ -93,13 +199,17 @@ public:
    * A cell traversal methods that is more efficient than vtkDataSet traversal
    * methods.  InitTraversal() initializes the traversal of the list of cells.
    */
-  void InitTraversal() {this->TraversalLocation=0;};
+  void InitTraversal()
+    {this->TraversalLocation=0; this->TraversalCellId=0;}
 
   /**
    * A cell traversal methods that is more efficient than vtkDataSet traversal
    * methods.  GetNextCell() gets the next cell in the list. If end of list
    * is encountered, 0 is returned. A value of 1 is returned whenever
-   * npts and pts have been updated without error.
+   * npts and pts have been updated without error. When the ids are not
+   * stored as vtkIdType, they are copied and pts is only valid until the
+   * next call; ids written through pts are then not stored in the cell
+   * array.
    */
   int GetNextCell(vtkIdType& npts, vtkIdType* &pts)
     VTK_SIZEHINT(pts, npts);
@@ -112,30 +222,76 @@ public:
   int GetNextCell(vtkIdList *pts);
 
   /**
-   * Get the size of the allocated connectivity array.
+   * Get the size of the allocated connectivity array. For offsets storage
+   * this is the equivalent size of the legacy layout.
    */
-  vtkIdType GetSize()
-    {return this->Ia->GetSize();}
+  vtkIdType GetSize();
 
   /**
    * Get the total number of entries (i.e., data values) in the connectivity
    * array. This may be much less than the allocated size (i.e., return value
-   * from GetSize().)
+   * from GetSize().) For offsets storage this is the equivalent number of
+   * entries of the legacy layout (i.e., it includes one count per cell).
    */
-  vtkIdType GetNumberOfConnectivityEntries()
-    {return this->Ia->GetMaxId()+1;}
+  vtkIdType GetNumberOfConnectivityEntries();
+
+  /**
+   * Return the number of points defining the cell cellId. This is O(1)
+   * with offsets storage and requires a traversal of the cells with the
+   * legacy storage.
+   */
+  vtkIdType GetCellSize(vtkIdType cellId)
+    VTK_EXPECTS(0 <= cellId && cellId < GetNumberOfCells());
+
+  /**
+   * Random access to the cell cellId. This is O(1) with offsets storage
+   * and requires a traversal of the cells with the legacy storage. When
+   * the ids are stored with the same type as vtkIdType, pts points directly
+   * into the connectivity; otherwise the ids are copied into ptIds, and pts
+   * points into ptIds. pts is valid until ptIds or the cell array are
+   * modified. This method does not modify the cell array, so any number of
+   * threads may call it concurrently, each with its own ptIds.
+   */
+  void GetCellAtId(vtkIdType cellId, vtkIdType &npts,
+                   vtkIdType const* &pts, vtkIdList *ptIds)
+    VTK_EXPECTS(0 <= cellId && cellId < GetNumberOfCells())
+    VTK_SIZEHINT(pts, npts);
+
+  /**
+   * Random access to the cell cellId; the point ids are copied into pts.
+   * Like the method above, it is thread-safe as long as each thread
+   * provides its own id list.
+   */
+  void GetCellAtId(vtkIdType cellId, vtkIdList *pts)
+    VTK_EXPECTS(0 <= cellId && cellId < GetNumberOfCells());
 
   /**
    * Internal method used to retrieve a cell given an offset into
-   * the internal array.
+   * the internal array. pts points into the cell array, and may be used to
+   * modify the cell. When the ids are not stored as vtkIdType there is no
+   * such pointer: an error is reported, and npts and pts are set to 0 and
+   * nullptr. The storage is not converted (see UseIdTypeStorage()); prefer
+   * the const overload below, which works with every storage.
    */
   void GetCell(vtkIdType loc, vtkIdType &npts, vtkIdType* &pts)
     VTK_EXPECTS(0 <= loc && loc < GetSize())
     VTK_SIZEHINT(pts, npts);
 
+  /**
+   * Same as the method above, but the cell array is never modified: when
+   * the ids are not stored as vtkIdType, they are copied into ptIds, and
+   * pts points into ptIds. Any number of threads may call it concurrently,
+   * each with its own ptIds.
+   */
+  void GetCell(vtkIdType loc, vtkIdType &npts, vtkIdType const* &pts,
+               vtkIdList *ptIds)
+    VTK_EXPECTS(0 <= loc && loc < GetSize())
+    VTK_SIZEHINT(pts, npts);
+
   /**
    * Internal method used to retrieve a cell given an offset into
-   * the internal array.
+   * the internal array. The ids are copied into pts, without modifying
+   * the cell array.
    */
   void GetCell(vtkIdType loc, vtkIdList* pts)
     VTK_EXPECTS(0 <= loc && loc < GetSize());
@@ -183,22 +339,20 @@ public:
    * Used in conjunction with GetCell(int loc,...).
    */
   vtkIdType GetInsertLocation(int npts)
-    {return (this->InsertLocation - npts - 1);};
+    {return (this->GetInsertLocation() - npts - 1);};
 
   /**
    * Get/Set the current traversal location.
    */
-  vtkIdType GetTraversalLocation()
-    {return this->TraversalLocation;}
-  void SetTraversalLocation(vtkIdType loc)
-    {this->TraversalLocation = loc;}
+  vtkIdType GetTraversalLocation();
+  void SetTraversalLocation(vtkIdType loc);
 
   /**
    * Computes the current traversal location within the internal array. Used
    * in conjunction with GetCell(int loc,...).
    */
   vtkIdType GetTraversalLocation(vtkIdType npts)
-    {return(this->TraversalLocation-npts-1);}
+    {return(this->GetTraversalLocation()-npts-1);}
 
   /**
    * Special method inverts ordering of current cell. Must be called
@@ -217,6 +371,20 @@ public:
     VTK_EXPECTS(0 <= loc && loc < GetSize())
     VTK_SIZEHINT(pts, npts);
 
+  //@{
+  /**
+   * Same as ReverseCell() and ReplaceCell(), but the cell is given by its
+   * id. With ReplaceCellAtId(), npts must match the current size of the
+   * cell.
+   */
+  void ReverseCellAtId(vtkIdType cellId)
+    VTK_EXPECTS(0 <= cellId && cellId < GetNumberOfCells());
+  void ReplaceCellAtId(vtkIdType cellId, vtkIdType npts,
+                       const vtkIdType *pts)
+    VTK_EXPECTS(0 <= cellId && cellId < GetNumberOfCells())
+    VTK_SIZEHINT(pts, npts);
+  //@}
+
   /**
    * Returns the size of the largest cell. The size is the number of points
    * defining the cell.
@@ -224,15 +392,19 @@ public:
   int GetMaxCellSize();
 
   /**
-   * Get pointer to array of cell data.
+   * Get pointer to array of cell data. Converts offsets storage to legacy
+   * storage.
    */
   vtkIdType *GetPointer()
-    {return this->Ia->GetPointer(0);}
+  {
+    this->UseLegacyStorage();
+    return this->Ia->GetPointer(0);
+  }
 
   /**
    * Get pointer to data array for purpose of direct writes of data. Size is the
    * total storage consumed by the cell array. ncells is the number of cells
-   * represented in the array.
+   * represented in the array. The cell array is switched to legacy storage.
    */
   vtkIdType *WritePointer(const vtkIdType ncells, const vtkIdType size);
 
@@ -243,7 +415,8 @@ public:
    * referring these cells becomes invalid (for example, if BuildCells() has
    * been called see vtkPolyData).  The traversal location is reset to the
    * beginning of the list; the insertion location is set to the end of the
-   * list.
+   * list. With offsets storage, the cells are copied into the offsets and
+   * connectivity arrays.
    */
   void SetCells(vtkIdType ncells, vtkIdTypeArray *cells);
 
@@ -253,10 +426,14 @@ public:
   void DeepCopy(vtkCellArray *ca);
 
   /**
-   * Return the underlying data as a data array.
+   * Return the underlying data as a data array. Converts offsets storage to
+   * legacy storage.
    */
   vtkIdTypeArray* GetData()
-    {return this->Ia;}
+  {
+    this->UseLegacyStorage();
+    return this->Ia;
+  }
 
   /**
    * Reuse list. Reset to initial condition.
@@ -266,8 +443,7 @@ public:
   /**
    * Reclaim any extra memory.
    */
-  void Squeeze()
-    {this->Ia->Squeeze();}
+  void Squeeze();
 
   /**
    * Return the memory in kibibytes (1024 bytes) consumed by this cell array. Used to
@@ -288,6 +464,34 @@ protected:
   vtkIdType TraversalLocation;   //keep track of traversal position
   vtkIdTypeArray *Ia;
 
+  // Offsets storage. Offsets holds NumberOfCells+1 values; the traversal
+  // position is kept as a cell id.
+  int StorageType;
+  vtkDataArray *Offsets;
+  vtkDataArray *Connectivity;
+  vtkIdType TraversalCellId;
+
+  vtkIdType GetInsertLocation();
+  void UseLegacyStorage()
+  {
+    if (this->StorageType != LEGACY_STORAGE)
+    {
+      this->SetStorageType(LEGACY_STORAGE);
+    }
+  }
+  void DiscardStorage(int type);
+  bool ConvertStorage(int type);
+  vtkIdType LocationToCellId(vtkIdType loc);
+  void InsertNextCellWithOffsets(vtkIdType npts, const vtkIdType* pts);
+  void InsertNextCellWithOffsets(int npts);
+  void InsertCellPointWithOffsets(vtkIdType id);
+  int GetNextCellWithOffsets(vtkIdType& npts, vtkIdType* &pts);
+  void GetCellWithOffsets(vtkIdType loc, vtkIdType &npts, vtkIdType* &pts);
+
+  // Copy of the current cell returned by GetNextCell() when the ids are not
+  // stored as vtkIdType.
+  vtkIdList *TraversalIds;
+
 private:
   vtkCellArray(const vtkCellArray&) = delete;
   void operator=(const vtkCellArray&) = delete;
@@ -298,6 +502,12 @@ private:
 inline vtkIdType vtkCellArray::InsertNextCell(vtkIdType npts,
                                               const vtkIdType* pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->InsertNextCellWithOffsets(npts, pts);
+    return this->NumberOfCells - 1;
+  }
+
   vtkIdType i = this->Ia->GetMaxId() + 1;
   vtkIdType *ptr = this->Ia->WritePointer(i, npts+1);
 
@@ -315,6 +525,12 @@ inline vtkIdType vtkCellArray::InsertNextCell(vtkIdType npts,
 //----------------------------------------------------------------------------
 inline vtkIdType vtkCellArray::InsertNextCell(int npts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->InsertNextCellWithOffsets(npts);
+    return this->NumberOfCells - 1;
+  }
+
   this->InsertLocation = this->Ia->InsertNextValue(npts) + 1;
   this->NumberOfCells++;
 
@@ -324,12 +540,25 @@ inline vtkIdType vtkCellArray::InsertNextCell(int npts)
 //----------------------------------------------------------------------------
 inline void vtkCellArray::InsertCellPoint(vtkIdType id)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->InsertCellPointWithOffsets(id);
+    return;
+  }
+
   this->Ia->InsertValue(this->InsertLocation++, id);
 }
 
 //----------------------------------------------------------------------------
 inline void vtkCellArray::UpdateCellCount(int npts)
 {
+  // With offsets storage the size of a cell is given by the number of
+  // points inserted, so there is nothing to update.
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    return;
+  }
+
   this->Ia->SetValue(this->InsertLocation-npts-1, npts);
 }
 
@@ -346,18 +575,14 @@ inline vtkIdType vtkCellArray::InsertNextCell(vtkCell *cell)
                               cell->PointIds->GetPointer(0));
 }
 
-//----------------------------------------------------------------------------
-inline void vtkCellArray::Reset()
-{
-  this->NumberOfCells = 0;
-  this->InsertLocation = 0;
-  this->TraversalLocation = 0;
-  this->Ia->Reset();
-}
-
 //----------------------------------------------------------------------------
 inline int vtkCellArray::GetNextCell(vtkIdType& npts, vtkIdType* &pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    return this->GetNextCellWithOffsets(npts, pts);
+  }
+
   if ( this->Ia->GetMaxId() >= 0 &&
        this->TraversalLocation <= this->Ia->GetMaxId() )
   {
@@ -375,6 +600,12 @@ inline int vtkCellArray::GetNextCell(vtkIdType& npts, vtkIdType* &pts)
 inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
                                   vtkIdType* &pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->GetCellWithOffsets(loc, npts, pts);
+    return;
+  }
+
   npts = this->Ia->GetValue(loc++);
   pts  = this->Ia->GetPointer(loc);
 }
@@ -382,6 +613,12 @@ inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
 //----------------------------------------------------------------------------
 inline void vtkCellArray::ReverseCell(vtkIdType loc)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->ReverseCellAtId(this->LocationToCellId(loc));
+    return;
+  }
+
   int i;
   vtkIdType tmp;
   vtkIdType npts=this->Ia->GetValue(loc);
@@ -398,6 +635,12 @@ inline void vtkCellArray::ReverseCell(vtkIdType loc)
 inline void vtkCellArray::ReplaceCell(vtkIdType loc, int npts,
                                       const vtkIdType *pts)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->ReplaceCellAtId(this->LocationToCellId(loc), npts, pts);
+    return;
+  }
+
   vtkIdType *oldPts=this->Ia->GetPointer(loc+1);
   for (int i=0; i < npts; i++)
   {
@@ -409,6 +652,11 @@ inline void vtkCellArray::ReplaceCell(vtkIdType loc, int npts,
 inline vtkIdType *vtkCellArray::WritePointer(const vtkIdType ncells,
                                              const vtkIdType size)
 {
+  if (this->StorageType != LEGACY_STORAGE)
+  {
+    this->DiscardStorage(LEGACY_STORAGE);
+  }
+
   this->NumberOfCells = ncells;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
@@ -16,12 +16,38 @@
 
 #include "vtkCellArray.h"
 #include "vtkDataSet.h"
-#include "vtkGenericCell.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <algorithm>
 
 vtkStandardNewMacro(vtkCellLinks);
 
+namespace
+{
+// Point the link of each point to its list of cells in the link storage.
+struct vtkCellLinksSetLinks
+{
+  vtkCellLinks::Link *Array;
+  const vtkIdType *Offsets;
+  vtkIdType *Links;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId) const
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkIdType ncells = this->Offsets[ptId + 1] - this->Offsets[ptId];
+      this->Array[ptId].ncells = static_cast<unsigned short>(ncells);
+      this->Array[ptId].cells =
+        ncells > 0 ? this->Links + this->Offsets[ptId] : nullptr;
+    }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 vtkCellLinks::~vtkCellLinks()
 {
@@ -35,12 +61,21 @@ void vtkCellLinks::Initialize()
   {
     for (vtkIdType i=0; i<=this->MaxId; i++)
     {
-      delete [] this->Array[i].cells;
+      if ( !this->IsInLinkStorage(this->Array[i].cells) )
+      {
+        delete [] this->Array[i].cells;
+      }
     }
 
     delete [] this->Array;
     this->Array = nullptr;
   }
+  this->Size = 0;
+  this->MaxId = -1;
+
+  delete [] this->LinkStorage;
+  this->LinkStorage = nullptr;
+  this->LinkStorageSize = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -48,8 +83,8 @@ void vtkCellLinks::Allocate(vtkIdType sz, vtkIdType ext)
 {
   static vtkCellLinks::Link linkInit = {0,nullptr};
 
+  this->Initialize();
   this->Size = sz;
-  delete [] this->Array;
   this->Array = new vtkCellLinks::Link[sz];
   this->Extend = ext;
   this->MaxId = -1;
@@ -128,79 +163,29 @@ vtkCellLinks::Link *vtkCellLinks::Resize(vtkIdType sz)
 void vtkCellLinks::BuildLinks(vtkDataSet *data)
 {
   vtkIdType numPts = data->GetNumberOfPoints();
-  vtkIdType numCells = data->GetNumberOfCells();
-  int j;
-  vtkIdType cellId;
-  unsigned short *linkLoc;
+  vtkIdType *offsets = new vtkIdType[numPts+1];
+  vtkIdType linksSize;
+  vtkIdType *links;
 
-  // fill out lists with number of references to cells
-  linkLoc = new unsigned short[numPts];
-  memset(linkLoc, 0, numPts*sizeof(unsigned short));
-
-  // Use fast path if polydata
+  // Use fast path if polydata. The cells are visited in the order of their
+  // ids, which need not be verts, lines, polys then strips.
   if ( data->GetDataObjectType() == VTK_POLY_DATA )
   {
-    vtkIdType *pts, npts;
-
-    vtkPolyData *pdata = static_cast<vtkPolyData *>(data);
-    // traverse data to determine number of uses of each point
-    for (cellId=0; cellId < numCells; cellId++)
-    {
-      pdata->GetCellPoints(cellId, npts, pts);
-      for (j=0; j < npts; j++)
-      {
-        this->IncrementLinkCount(pts[j]);
-      }
-    }
-
-    // now allocate storage for the links
-    this->AllocateLinks(numPts);
-    this->MaxId = numPts - 1;
-
-    for (cellId=0; cellId < numCells; cellId++)
-    {
-      pdata->GetCellPoints(cellId, npts, pts);
-      for (j=0; j < npts; j++)
-      {
-        this->InsertCellReference(pts[j], (linkLoc[pts[j]])++, cellId);
-      }
-    }
+    vtkStaticCellLinksDetail::PolyDataAccess access(
+      static_cast<vtkPolyData *>(data));
+    links = vtkStaticCellLinksDetail::BuildLinks(
+      access, numPts, offsets, linksSize);
   }
 
   else //any other type of dataset
   {
-    vtkIdType numberOfPoints, ptId;
-    vtkGenericCell *cell=vtkGenericCell::New();
-
-    // traverse data to determine number of uses of each point
-    for (cellId=0; cellId < numCells; cellId++)
-    {
-      data->GetCell(cellId,cell);
-      numberOfPoints = cell->GetNumberOfPoints();
-      for (j=0; j < numberOfPoints; j++)
-      {
-        this->IncrementLinkCount(cell->PointIds->GetId(j));
-      }
-    }
-
-    // now allocate storage for the links
-    this->AllocateLinks(numPts);
-    this->MaxId = numPts - 1;
-
-    for (cellId=0; cellId < numCells; cellId++)
-    {
-      data->GetCell(cellId,cell);
-      numberOfPoints = cell->GetNumberOfPoints();
-      for (j=0; j < numberOfPoints; j++)
-      {
-        ptId = cell->PointIds->GetId(j);
-        this->InsertCellReference(ptId, (linkLoc[ptId])++, cellId);
-      }
-    }
-    cell->Delete();
-  }//end else
+    vtkStaticCellLinksDetail::DataSetAccess access(data);
+    links = vtkStaticCellLinksDetail::BuildLinks(
+      access, numPts, offsets, linksSize);
+  }
 
-  delete [] linkLoc;
+  this->SetLinks(numPts, offsets, links, linksSize);
+  delete [] offsets;
 }
 
 //----------------------------------------------------------------------------
@@ -208,41 +193,40 @@ void vtkCellLinks::BuildLinks(vtkDataSet *data)
 void vtkCellLinks::BuildLinks(vtkDataSet *data, vtkCellArray *Connectivity)
 {
   vtkIdType numPts = data->GetNumberOfPoints();
-  vtkIdType j, cellId;
-  unsigned short *linkLoc;
-  vtkIdType npts=0;
-  vtkIdType *pts=nullptr;
-  vtkIdType loc = Connectivity->GetTraversalLocation();
-
-  // traverse data to determine number of uses of each point
-  for (Connectivity->InitTraversal();
-       Connectivity->GetNextCell(npts,pts);)
+  vtkIdType *offsets = new vtkIdType[numPts+1];
+  vtkIdType linksSize;
+
+  // The cell locations of an unstructured grid spare a traversal of its
+  // (legacy) connectivity.
+  vtkIdTypeArray *locations = nullptr;
+  if ( data->GetDataObjectType() == VTK_UNSTRUCTURED_GRID &&
+       static_cast<vtkUnstructuredGrid *>(data)->GetCells() == Connectivity )
   {
-    for (j=0; j < npts; j++)
-    {
-      this->IncrementLinkCount(pts[j]);
-    }
+    locations =
+      static_cast<vtkUnstructuredGrid *>(data)->GetCellLocationsArray();
   }
 
-  // now allocate storage for the links
-  this->AllocateLinks(numPts);
-  this->MaxId = numPts - 1;
+  vtkStaticCellLinksDetail::CellArraysAccess access;
+  access.AddCells(Connectivity, locations);
+  vtkIdType *links = vtkStaticCellLinksDetail::BuildLinks(
+    access, numPts, offsets, linksSize);
 
-  // fill out lists with references to cells
-  linkLoc = new unsigned short[numPts];
-  memset(linkLoc, 0, numPts*sizeof(unsigned short));
+  this->SetLinks(numPts, offsets, links, linksSize);
+  delete [] offsets;
+}
 
-  cellId = 0;
-  for (Connectivity->InitTraversal();
-       Connectivity->GetNextCell(npts,pts); cellId++)
-  {
-    for (j=0; j < npts; j++)
-    {
-      this->InsertCellReference(pts[j], (linkLoc[pts[j]])++, cellId);
-    }
-  }
-  delete [] linkLoc;
-  Connectivity->SetTraversalLocation(loc);
+//----------------------------------------------------------------------------
+void vtkCellLinks::SetLinks(vtkIdType numPts, const vtkIdType *offsets,
+                            vtkIdType *links, vtkIdType linksSize)
+{
+  // Keep the room allocated for points to be inserted later on
+  this->Allocate(numPts > this->Size ? numPts : this->Size, this->Extend);
+  this->LinkStorage = links;
+  this->LinkStorageSize = linksSize;
+  this->MaxId = numPts - 1;
+
+  vtkCellLinksSetLinks setLinks = { this->Array, offsets, links };
+  vtkSMPTools::For(0, numPts, setLinks);
 }
 
 //----------------------------------------------------------------------------
@@ -271,16 +255,41 @@ unsigned long vtkCellLinks::GetActualMemorySize()
 
   size *= sizeof(int *); //references to cells
   size += (this->MaxId+1) * sizeof(vtkCellLinks::Link); //list of cell lists
+  if ( this->LinkStorage )
+  {
+    size += this->LinkStorageSize * sizeof(vtkIdType);
+  }
 
   return static_cast<unsigned long>( ceil(size/1024.0)); // kibibytes
 }
 
 //----------------------------------------------------------------------------
+// The lists of cells are copied into a single block of memory, like the
+// ones built by BuildLinks().
 void vtkCellLinks::DeepCopy(vtkCellLinks *src)
 {
-  this->Allocate(src->Size, src->Extend);
-  memcpy(this->Array, src->Array, this->Size * sizeof(vtkCellLinks::Link));
-  this->MaxId = src->MaxId;
+  vtkIdType numPts = src->MaxId + 1;
+  vtkIdType *offsets = new vtkIdType[numPts+1];
+  offsets[0] = 0;
+  for (vtkIdType ptId=0; ptId < numPts; ptId++)
+  {
+    offsets[ptId+1] = offsets[ptId] + src->Array[ptId].ncells;
+  }
+
+  vtkIdType linksSize = offsets[numPts];
+  vtkIdType *links = new vtkIdType[linksSize];
+  for (vtkIdType ptId=0; ptId < numPts; ptId++)
+  {
+    std::copy(src->Array[ptId].cells,
+              src->Array[ptId].cells + src->Array[ptId].ncells,
+              links + offsets[ptId]);
+  }
+
+  this->Initialize();
+  this->Size = src->Size;
+  this->Extend = src->Extend;
+  this->SetLinks(numPts, offsets, links, linksSize);
+  delete [] offsets;
 }
 
 //----------------------------------------------------------------------------
@@ -22,6 +22,12 @@
  * using the point. The information provided by this object can be used to
  * determine neighbors and construct other local topological information.
  *
+ * BuildLinks() counts the uses of each point, then fills the lists of cell
+ * ids, in parallel with vtkSMPTools. The lists of all the points are kept in
+ * one contiguous block of memory; they can still be edited afterwards (a
+ * list resized with ResizeCellList() is moved to its own allocation). The
+ * cells using a point are listed in increasing order of cell id.
+ *
  * @warning
  * Note that this class is designed to support incremental link construction.
  * More efficient cell links structures can be built with vtkStaticCellLinks
@@ -73,7 +79,7 @@ public:
 
   /**
    * Allocate the specified number of links (i.e., number of points) that
-   * will be built.
+   * will be built. Any previous links are released.
    */
   void Allocate(vtkIdType numLinks, vtkIdType ext=1000);
 
@@ -162,7 +168,8 @@ public:
   void DeepCopy(vtkCellLinks *src);
 
 protected:
-  vtkCellLinks():Array(nullptr),Size(0),MaxId(-1),Extend(1000) {}
+  vtkCellLinks():Array(nullptr),Size(0),MaxId(-1),Extend(1000),
+    LinkStorage(nullptr),LinkStorageSize(0) {}
   ~vtkCellLinks() override;
 
   /**
@@ -172,6 +179,23 @@ protected:
 
   void AllocateLinks(vtkIdType n);
 
+  /**
+   * Take ownership of links built for numPts points: the list of cells of
+   * point i is links[offsets[i]] to links[offsets[i+1]-1].
+   */
+  void SetLinks(vtkIdType numPts, const vtkIdType *offsets, vtkIdType *links,
+                vtkIdType linksSize);
+
+  /**
+   * Return true if the list of cells lies in the block built by BuildLinks()
+   * (and must not be deleted on its own).
+   */
+  bool IsInLinkStorage(const vtkIdType *cells)
+  {
+    return this->LinkStorage && cells >= this->LinkStorage &&
+      cells < this->LinkStorage + this->LinkStorageSize;
+  }
+
   /**
    * Insert a cell id into the list of cells using the point.
    */
@@ -183,6 +207,8 @@ protected:
   vtkIdType MaxId;     // maximum index inserted thus far
   vtkIdType Extend;     // grow array by this point
   Link *Resize(vtkIdType sz);  // function to resize data
+  vtkIdType *LinkStorage; // lists of cells built by BuildLinks()
+  vtkIdType LinkStorageSize;
 
 private:
   vtkCellLinks(const vtkCellLinks&) = delete;
@@ -201,7 +227,10 @@ inline void vtkCellLinks::InsertCellReference(vtkIdType ptId,
 inline void vtkCellLinks::DeletePoint(vtkIdType ptId)
 {
   this->Array[ptId].ncells = 0;
-  delete [] this->Array[ptId].cells;
+  if (!this->IsInLinkStorage(this->Array[ptId].cells))
+  {
+    delete [] this->Array[ptId].cells;
+  }
   this->Array[ptId].cells = nullptr;
 }
 
@@ -248,7 +277,10 @@ inline void vtkCellLinks::ResizeCellList(vtkIdType ptId, int size)
   cells = new vtkIdType[newSize];
   memcpy(cells, this->Array[ptId].cells,
          this->Array[ptId].ncells*sizeof(vtkIdType));
-  delete [] this->Array[ptId].cells;
+  if (!this->IsInLinkStorage(this->Array[ptId].cells))
+  {
+    delete [] this->Array[ptId].cells;
+  }
   this->Array[ptId].cells = cells;
 }
 
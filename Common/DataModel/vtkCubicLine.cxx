@@ -337,7 +337,7 @@ void vtkCubicLine::Derivatives(int vtkNotUsed(subId),
     {
       for (int i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
@@ -368,7 +368,7 @@ void vtkCubicLine::Derivatives(int vtkNotUsed(subId),
     {
       for (int i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
@@ -149,6 +149,10 @@ public:
    */
   void BuildLocator() override;
 
+  // Re-use any superclass signatures that we don't override.
+  using vtkAbstractPointLocator::FindClosestNPoints;
+  using vtkAbstractPointLocator::FindPointsWithinRadius;
+
   /**
    * Given a point x, return the id of the closest point. BuildLocator() should
    * have been called prior to this function. This method is thread safe if
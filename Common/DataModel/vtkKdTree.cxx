@@ -30,6 +30,7 @@
 #include "vtkMath.h"
 #include "vtkCell.h"
 #include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
 #include "vtkGarbageCollector.h"
 #include "vtkIdList.h"
 #include "vtkPolyData.h"
@@ -38,6 +39,9 @@
 #include "vtkIntArray.h"
 #include "vtkPointSet.h"
 #include "vtkImageData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTimerLog.h"
 #include "vtkUniformGrid.h"
 #include "vtkRectilinearGrid.h"
@@ -48,6 +52,7 @@
 #include <map>
 #include <queue>
 #include <set>
+#include <vector>
 
 namespace
 {
@@ -191,6 +196,248 @@ namespace
   };
 }
 
+// helpers for building the k-d tree with several threads
+namespace
+{
+  // The median of the regions with at least that many points is found,
+  // and their points are partitioned, with several threads.
+  const int ParallelSelectSize = 1 << 18;
+
+  // The two halves of the regions with at least that many points are
+  // divided concurrently.
+  const int ParallelDivideSize = 1 << 12;
+
+  // The points are partitioned by chunks of that size. It does not depend
+  // on the number of threads, so that the k-d tree does not either.
+  const vtkIdType PartitionChunkSize = 1 << 15;
+
+  // Histograms of the coordinates have that many bins, and the median is
+  // selected serially among at most that many values.
+  const int NumberOfBins = 1024;
+  const vtkIdType MaxSelectSize = 1 << 16;
+
+  //----------------------------------------------------------------------------
+  // Return the K-th smallest coordinate dim of the points c1. The values in
+  // [lo, hi] are counted in a histogram in parallel, then the search goes
+  // on in the bin holding the K-th value, until it holds few enough values
+  // to select among them directly.
+  float FindRankedCoordinate(int dim, const float *c1, int nvals, int K)
+  {
+    const float *X = c1 + dim;
+
+    vtkSMPThreadLocal<std::pair<float, float> >
+      localRange(std::make_pair(VTK_FLOAT_MAX, -VTK_FLOAT_MAX));
+    vtkSMPTools::For(0, nvals, PartitionChunkSize,
+      [&](vtkIdType begin, vtkIdType end)
+      {
+        std::pair<float, float>& range = localRange.Local();
+        for (vtkIdType i = begin; i < end; i++)
+        {
+          range.first = std::min(range.first, X[3*i]);
+          range.second = std::max(range.second, X[3*i]);
+        }
+      });
+
+    float lo = VTK_FLOAT_MAX;
+    float hi = -VTK_FLOAT_MAX;
+    for (auto it = localRange.begin(); it != localRange.end(); ++it)
+    {
+      lo = std::min(lo, it->first);
+      hi = std::max(hi, it->second);
+    }
+
+    vtkIdType rank = K;
+
+    while (lo < hi)
+    {
+      // The bins are monotonic in x, so the values of a bin are exactly
+      // those between its smallest and its largest value.
+      const double scale = NumberOfBins / (static_cast<double>(hi) - lo);
+      auto binOf = [lo, scale](float x)
+      {
+        int bin = static_cast<int>((static_cast<double>(x) - lo) * scale);
+        return (bin < NumberOfBins) ? bin : NumberOfBins - 1;
+      };
+
+      vtkSMPThreadLocal<std::vector<vtkIdType> >
+        localCounts(std::vector<vtkIdType>(NumberOfBins, 0));
+      vtkSMPTools::For(0, nvals, PartitionChunkSize,
+        [&](vtkIdType begin, vtkIdType end)
+        {
+          std::vector<vtkIdType>& counts = localCounts.Local();
+          for (vtkIdType i = begin; i < end; i++)
+          {
+            float x = X[3*i];
+            if ((x >= lo) && (x <= hi))
+            {
+              counts[binOf(x)]++;
+            }
+          }
+        });
+
+      std::vector<vtkIdType> counts(NumberOfBins, 0);
+      for (auto it = localCounts.begin(); it != localCounts.end(); ++it)
+      {
+        for (int bin = 0; bin < NumberOfBins; bin++)
+        {
+          counts[bin] += (*it)[bin];
+        }
+      }
+
+      int kBin = 0;
+      while ((kBin < NumberOfBins - 1) && (rank >= counts[kBin]))
+      {
+        rank -= counts[kBin++];
+      }
+
+      auto inBin = [&](float x)
+      {
+        return (x >= lo) && (x <= hi) && (binOf(x) == kBin);
+      };
+
+      if (counts[kBin] <= MaxSelectSize)
+      {
+        vtkSMPThreadLocal<std::vector<float> > localValues;
+        vtkSMPTools::For(0, nvals, PartitionChunkSize,
+          [&](vtkIdType begin, vtkIdType end)
+          {
+            std::vector<float>& values = localValues.Local();
+            for (vtkIdType i = begin; i < end; i++)
+            {
+              if (inBin(X[3*i]))
+              {
+                values.push_back(X[3*i]);
+              }
+            }
+          });
+
+        std::vector<float> values;
+        values.reserve(counts[kBin]);
+        for (auto it = localValues.begin(); it != localValues.end(); ++it)
+        {
+          values.insert(values.end(), it->begin(), it->end());
+        }
+        if (values.empty())
+        {
+          break;
+        }
+        rank = std::min(rank, static_cast<vtkIdType>(values.size()) - 1);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
+      }
+
+      vtkSMPThreadLocal<std::pair<float, float> >
+        localBinRange(std::make_pair(VTK_FLOAT_MAX, -VTK_FLOAT_MAX));
+      vtkSMPTools::For(0, nvals, PartitionChunkSize,
+        [&](vtkIdType begin, vtkIdType end)
+        {
+          std::pair<float, float>& range = localBinRange.Local();
+          for (vtkIdType i = begin; i < end; i++)
+          {
+            if (inBin(X[3*i]))
+            {
+              range.first = std::min(range.first, X[3*i]);
+              range.second = std::max(range.second, X[3*i]);
+            }
+          }
+        });
+
+      float binLo = VTK_FLOAT_MAX;
+      float binHi = -VTK_FLOAT_MAX;
+      for (auto it = localBinRange.begin(); it != localBinRange.end(); ++it)
+      {
+        binLo = std::min(binLo, it->first);
+        binHi = std::max(binHi, it->second);
+      }
+      lo = binLo;
+      hi = binHi;
+    }
+
+    return lo;
+  }
+
+  //----------------------------------------------------------------------------
+  // A parallel version of vtkKdTree::Select: move the points whose
+  // coordinate dim is smaller than the median value to the front of the
+  // array, and return their number. The relative order of the points is
+  // kept in each half.
+  int ParallelSelect(int dim, float *c1, int *ids, int nvals, double &coord)
+  {
+    float T = FindRankedCoordinate(dim, c1, nvals, nvals / 2);
+
+    const float *X = c1 + dim;
+    vtkIdType numChunks = (nvals + PartitionChunkSize - 1) / PartitionChunkSize;
+
+    std::vector<vtkIdType> leftOffsets(numChunks);
+    std::vector<float> leftMax(numChunks, -VTK_FLOAT_MAX);
+    vtkSMPTools::For(0, numChunks, 1,
+      [&](vtkIdType begin, vtkIdType end)
+      {
+        for (vtkIdType chunk = begin; chunk < end; chunk++)
+        {
+          vtkIdType first = chunk * PartitionChunkSize;
+          vtkIdType last = std::min(first + PartitionChunkSize,
+                                    static_cast<vtkIdType>(nvals));
+          vtkIdType nleft = 0;
+          for (vtkIdType i = first; i < last; i++)
+          {
+            if (X[3*i] < T)
+            {
+              nleft++;
+              leftMax[chunk] = std::max(leftMax[chunk], X[3*i]);
+            }
+          }
+          leftOffsets[chunk] = nleft;
+        }
+      });
+
+    vtkIdType mid = vtkSMPTools::ExclusiveScan(leftOffsets.begin(),
+      leftOffsets.end(), leftOffsets.begin(), static_cast<vtkIdType>(0));
+
+    if (mid == 0)
+    {
+      return 0;     // failed to divide region
+    }
+
+    std::vector<float> points(3 * static_cast<size_t>(nvals));
+    std::vector<int> pointIds(ids ? nvals : 0);
+    vtkSMPTools::For(0, numChunks, 1,
+      [&](vtkIdType begin, vtkIdType end)
+      {
+        for (vtkIdType chunk = begin; chunk < end; chunk++)
+        {
+          vtkIdType first = chunk * PartitionChunkSize;
+          vtkIdType last = std::min(first + PartitionChunkSize,
+                                    static_cast<vtkIdType>(nvals));
+          vtkIdType left = leftOffsets[chunk];
+          vtkIdType right = mid + first - left;
+          for (vtkIdType i = first; i < last; i++)
+          {
+            vtkIdType to = (X[3*i] < T) ? left++ : right++;
+            std::copy(c1 + 3*i, c1 + 3*i + 3, points.begin() + 3*to);
+            if (ids)
+            {
+              pointIds[to] = ids[i];
+            }
+          }
+        }
+      });
+
+    vtkSMPTools::Transform(points.begin(), points.end(), c1,
+                           [](float x) { return x; });
+    if (ids)
+    {
+      vtkSMPTools::Transform(pointIds.begin(), pointIds.end(), ids,
+                             [](int id) { return id; });
+    }
+
+    coord = (static_cast<double>(T) + static_cast<double>(
+      *std::max_element(leftMax.begin(), leftMax.end()))) / 2.0;
+
+    return static_cast<int>(mid);
+  }
+}
+
 vtkStandardNewMacro(vtkKdTree);
 
 //----------------------------------------------------------------------------
@@ -1299,6 +1546,26 @@ int vtkKdTree::DivideRegion(vtkKdNode *kd, float *c1, int *ids, int level)
   int *leftIds  = ids;
   int *rightIds = ids ? ids + nleft : nullptr;
 
+  if (kd->GetNumberOfPoints() >= ParallelDivideSize)
+  {
+    // The halves are disjoint parts of the arrays: divide them concurrently.
+    vtkSMPTools::For(0, 2, 1, [&](vtkIdType begin, vtkIdType end)
+    {
+      for (vtkIdType half = begin; half < end; half++)
+      {
+        if (half == 0)
+        {
+          this->DivideRegion(kd->GetLeft(), c1, leftIds, level + 1);
+        }
+        else
+        {
+          this->DivideRegion(kd->GetRight(), c1 + nleft*3, rightIds, level + 1);
+        }
+      }
+    });
+    return 0;
+  }
+
   this->DivideRegion(kd->GetLeft(), c1, leftIds, level + 1);
 
   this->DivideRegion(kd->GetRight(), c1 + nleft*3, rightIds, level + 1);
@@ -1328,7 +1595,14 @@ void vtkKdTree::DoMedianFind(vtkKdNode *kd, float *c1, int *ids,
       break;
     }
 
-    midpt = vtkKdTree::Select(dims[dim], c1, ids, npoints, coord);
+    if (npoints >= ParallelSelectSize)
+    {
+      midpt = ParallelSelect(dims[dim], c1, ids, npoints, coord);
+    }
+    else
+    {
+      midpt = vtkKdTree::Select(dims[dim], c1, ids, npoints, coord);
+    }
 
     if (midpt == 0)
     {
@@ -1836,26 +2110,36 @@ void vtkKdTree::BuildLocatorFromPoints(vtkPoints **ptArrays, int numPtArrays)
     else
     {
       // Hopefully point arrays are usually floats.  This conversion will
-      // really slow things down.
+      // really slow things down, so do it with several threads.
 
-      for (vtkIdType ii=0; ii<npoints; ii++)
+      vtkPoints *ptArray = ptArrays[i];
+      float *to = points + ptId;
+      vtkSMPTools::For(0, npoints, [ptArray, to](vtkIdType begin, vtkIdType end)
       {
-        double *pt = ptArrays[i]->GetPoint(ii);
+        double pt[3];
+        for (vtkIdType ii=begin; ii<end; ii++)
+        {
+          ptArray->GetPoint(ii, pt);
 
-        points[ptId++] = static_cast<float>(pt[0]);
-        points[ptId++] = static_cast<float>(pt[1]);
-        points[ptId++] = static_cast<float>(pt[2]);
-      }
+          to[3*ii]     = static_cast<float>(pt[0]);
+          to[3*ii + 1] = static_cast<float>(pt[1]);
+          to[3*ii + 2] = static_cast<float>(pt[2]);
+        }
+      });
+      ptId += nvals;
     }
   }
 
-  for (ptId=0; ptId<totalNumPoints; ptId++)
-  {
-    // _Select dominates DivideRegion algorithm, operating on
-    // ints is much fast than operating on long longs
+  // _Select dominates DivideRegion algorithm, operating on
+  // ints is much fast than operating on long longs
 
-    ptIds[ptId] = ptId;
-  }
+  vtkSMPTools::For(0, totalNumPoints, [ptIds](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType id=begin; id<end; id++)
+    {
+      ptIds[id] = static_cast<int>(id);
+    }
+  });
 
   TIMERDONE("Set up to build k-d tree");
 
@@ -2378,48 +2662,65 @@ int vtkKdTree::FindClosestPointInSphere(double x, double y, double z,
     vtkErrorMacro(<< "vtkKdTree::FindClosestPointInSphere - must build locator first");
     return -1;
   }
-  int *regionIds = new int [this->NumberOfRegions];
-
-  this->BSPCalculator->ComputeIntersectionsUsingDataBoundsOn();
-
-  int nRegions =
-    this->BSPCalculator->IntersectsSphere2(regionIds, this->NumberOfRegions, x, y, z, radius*radius);
 
-  this->BSPCalculator->ComputeIntersectionsUsingDataBoundsOff();
+  // The regions are visited in the order of their ids, like the regions
+  // intersecting the sphere that BSPCalculator would list. Walking the tree
+  // directly leaves the calculator untouched, so that concurrent queries
+  // are possible.
 
   double minDistance2 = 4 * this->MaxWidth * this->MaxWidth;
   int localCloseId = -1;
 
-  bool recheck = 0; // used to flag that we should recheck the distance
-  for (int reg=0; reg < nRegions; reg++)
+  this->FindClosestPointInSphere(this->Top, x, y, z, radius*radius,
+                                 skipRegion, minDistance2, localCloseId);
+
+  dist2 = minDistance2;
+  return localCloseId;
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTree::FindClosestPointInSphere(vtkKdNode *node,
+                                         double x, double y, double z,
+                                         double radius2, int skipRegion,
+                                         double &minDistance2,
+                                         int &localCloseId)
+{
+  if (!node->IntersectsSphere2(x, y, z, radius2, 1))
   {
-    if (regionIds[reg] == skipRegion)
-    {
-      continue;
-    }
+    return;
+  }
 
-    int neighbor = regionIds[reg];
+  if (node->GetLeft())
+  {
+    this->FindClosestPointInSphere(node->GetLeft(), x, y, z, radius2,
+                                   skipRegion, minDistance2, localCloseId);
+    this->FindClosestPointInSphere(node->GetRight(), x, y, z, radius2,
+                                   skipRegion, minDistance2, localCloseId);
+    return;
+  }
 
-    // recheck that the bin is closer than the current minimum distance
-    if(!recheck || this->RegionList[neighbor]->GetDistance2ToBoundary(x, y, z, 1) < minDistance2)
-    {
-      double newDistance2;
-      int newLocalCloseId = this->_FindClosestPointInRegion(neighbor,
-                                                            x, y, z, newDistance2);
+  int neighbor = node->GetID();
 
-      if (newDistance2 < minDistance2 && newDistance2 <= radius*radius)
-      {
-        minDistance2 = newDistance2;
-        localCloseId = newLocalCloseId;
-        recheck = 1; // changed the minimum distance so mark to check subsequent bins
-      }
-    }
+  if (neighbor == skipRegion)
+  {
+    return;
   }
 
-  delete [] regionIds;
+  // once a point is found, recheck that the bin is closer than the
+  // current minimum distance
+  if ((localCloseId < 0) ||
+      (node->GetDistance2ToBoundary(x, y, z, 1) < minDistance2))
+  {
+    double newDistance2;
+    int newLocalCloseId = this->_FindClosestPointInRegion(neighbor,
+                                                          x, y, z, newDistance2);
 
-  dist2 = minDistance2;
-  return localCloseId;
+    if (newDistance2 < minDistance2 && newDistance2 <= radius2)
+    {
+      minDistance2 = newDistance2;
+      localCloseId = newLocalCloseId;
+    }
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -2545,6 +2846,102 @@ void vtkKdTree::FindPointsWithinRadius(vtkKdNode* node, double R2,
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkKdTree::FindClosestPoints(vtkPoints *queryPoints,
+                                  vtkIdTypeArray *closestIds,
+                                  vtkDoubleArray *dist2)
+{
+  if (!this->LocatorPoints)
+  {
+    vtkErrorMacro(<< "vtkKdTree::FindClosestPoints - must build locator first");
+    return;
+  }
+
+  vtkIdType numQueries = queryPoints->GetNumberOfPoints();
+
+  closestIds->SetNumberOfComponents(1);
+  closestIds->SetNumberOfTuples(numQueries);
+  vtkIdType *closest = closestIds->GetPointer(0);
+
+  double *closestDist2 = nullptr;
+  if (dist2)
+  {
+    dist2->SetNumberOfComponents(1);
+    dist2->SetNumberOfTuples(numQueries);
+    closestDist2 = dist2->GetPointer(0);
+  }
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    double x[3], d2;
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      queryPoints->GetPoint(i, x);
+      closest[i] = this->FindClosestPoint(x[0], x[1], x[2], d2);
+      if (closestDist2)
+      {
+        closestDist2[i] = d2;
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTree::FindPointsWithinRadius(double R, vtkPoints *queryPoints,
+                                       vtkIdTypeArray *offsets,
+                                       vtkIdTypeArray *ids)
+{
+  if (!this->LocatorPoints)
+  {
+    vtkErrorMacro(<< "vtkKdTree::FindPointsWithinRadius - must build locator first");
+    return;
+  }
+
+  vtkIdType numQueries = queryPoints->GetNumberOfPoints();
+
+  offsets->SetNumberOfComponents(1);
+  offsets->SetNumberOfTuples(numQueries + 1);
+  vtkIdType *offset = offsets->GetPointer(0);
+
+  // Each thread appends the points it finds to its own list. Remember
+  // where the points of each query are, and count them, then gather them
+  // once the offsets are known.
+  vtkSMPThreadLocalObject<vtkIdList> localFound;
+  std::vector<vtkIdList*> found(numQueries);
+  std::vector<vtkIdType> start(numQueries);
+  double R2 = R * R;
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *list = localFound.Local();
+    double x[3];
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      queryPoints->GetPoint(i, x);
+      found[i] = list;
+      start[i] = list->GetNumberOfIds();
+      this->FindPointsWithinRadius(this->Top, R2, x, list);
+      offset[i] = list->GetNumberOfIds() - start[i];
+    }
+  });
+
+  offset[numQueries] = vtkSMPTools::ExclusiveScan(offset, offset + numQueries,
+    offset, static_cast<vtkIdType>(0));
+
+  ids->SetNumberOfComponents(1);
+  ids->SetNumberOfTuples(offset[numQueries]);
+  vtkIdType *out = ids->GetPointer(0);
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      vtkIdType *first = found[i]->GetPointer(start[i]);
+      std::copy(first, first + (offset[i+1] - offset[i]), out + offset[i]);
+    }
+  });
+}
+
 //----------------------------------------------------------------------------
 void vtkKdTree::FindClosestNPoints(int N, const double x[3],
                                    vtkIdList* result)
@@ -48,6 +48,13 @@
  *     ids to a subset of the ids that is unique within a supplied
  *     tolerance, or you can use FindPoint and FindClosestPoint to
  *     locate points in the original set that the tree was built from.
+ *     FindClosestPoints and FindPointsWithinRadius process whole vtkPoints
+ *     objects of query points in parallel.
+ *
+ *     The k-d tree is built with vtkSMPTools: the median of the largest
+ *     regions is found and their points are partitioned in parallel, and
+ *     the two halves of a region are divided concurrently. The resulting
+ *     regions do not depend on the number of threads.
  *
  * @sa
  *      vtkLocator vtkCellLocator vtkPKdTree
@@ -60,6 +67,7 @@
 #include "vtkLocator.h"
 
 class vtkTimerLog;
+class vtkDoubleArray;
 class vtkIdList;
 class vtkIdTypeArray;
 class vtkIntArray;
@@ -521,6 +529,15 @@ public:
   vtkIdType FindClosestPoint(double x, double y, double z, double &dist2);
   //@}
 
+  /**
+   * Find the closest point of each of the queryPoints, processing them
+   * in parallel. closestIds is resized to hold the id of the closest point
+   * of each query point, and dist2, when given, the square of the distance
+   * to it. You must have called BuildLocatorFromPoints() before calling this.
+   */
+  void FindClosestPoints(vtkPoints *queryPoints, vtkIdTypeArray *closestIds,
+                         vtkDoubleArray *dist2 = nullptr);
+
   /**
    * Given a position x and a radius r, return the id of the point
    * closest to the point in that radius.
@@ -548,6 +565,18 @@ public:
    */
   void FindPointsWithinRadius(double R, const double x[3], vtkIdList *result);
 
+  /**
+   * Find all points within a specified radius R of each of the queryPoints,
+   * processing them in parallel. The ids of the points found are stored one
+   * query point after the other in ids: the points found for query point i
+   * are ids[offsets[i]] to ids[offsets[i+1]-1], so offsets is resized to
+   * hold one more value than there are query points. The points found for a
+   * query point are not sorted in any specific manner.
+   * You must have called BuildLocatorFromPoints() before calling this.
+   */
+  void FindPointsWithinRadius(double R, vtkPoints *queryPoints,
+                              vtkIdTypeArray *offsets, vtkIdTypeArray *ids);
+
   /**
    * Find the closest N points to a position. This returns the closest
    * N points to a position. A faster method could be created that returned
@@ -828,6 +857,11 @@ protected:
   int FindClosestPointInSphere(double x, double y, double z, double radius,
                                int skipRegion, double &dist2);
 
+  // Recursive helper for FindClosestPointInSphere
+  void FindClosestPointInSphere(vtkKdNode *node, double x, double y, double z,
+                                double radius2, int skipRegion,
+                                double &minDistance2, int &localCloseId);
+
   int _ViewOrderRegionsInDirection(vtkIntArray *IdsOfInterest,
                                    const double dop[3],
                                    vtkIntArray *orderedList);
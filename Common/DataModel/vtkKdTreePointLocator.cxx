@@ -62,6 +62,28 @@ void vtkKdTreePointLocator::FindPointsWithinRadius(double R, const double x[3],
   this->KdTree->FindPointsWithinRadius(R, x, result);
 }
 
+void vtkKdTreePointLocator::FindClosestPoints(vtkPoints *queryPoints,
+                                              vtkIdTypeArray *closestIds,
+                                              vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+  this->KdTree->FindClosestPoints(queryPoints, closestIds, dist2);
+}
+
+void vtkKdTreePointLocator::FindPointsWithinRadius(double R,
+                                                   vtkPoints *queryPoints,
+                                                   vtkIdTypeArray *offsets,
+                                                   vtkIdTypeArray *ids,
+                                                   vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+  this->KdTree->FindPointsWithinRadius(R, queryPoints, offsets, ids);
+  if (dist2)
+  {
+    this->ComputeDistances(queryPoints, offsets, ids, dist2);
+  }
+}
+
 void vtkKdTreePointLocator::FreeSearchStructure()
 {
   if(this->KdTree)
@@ -39,6 +39,11 @@ public:
   static vtkKdTreePointLocator* New();
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
+  // Re-use any superclass signatures that we don't override.
+  using vtkAbstractPointLocator::FindClosestPoint;
+  using vtkAbstractPointLocator::FindClosestNPoints;
+  using vtkAbstractPointLocator::FindPointsWithinRadius;
+
   /**
    * Given a position x, return the id of the point closest to it. Alternative
    * method requires separate x-y-z values.
@@ -75,6 +80,20 @@ public:
   void FindPointsWithinRadius(double R, const double x[3],
                               vtkIdList *result) override;
 
+  //@{
+  /**
+   * Batched queries, see vtkAbstractPointLocator. These use the batched
+   * queries of vtkKdTree, which process the query points in parallel.
+   * The distances of FindClosestPoints() are those computed by the k-d
+   * tree, from the single precision copy of the points it holds.
+   */
+  void FindClosestPoints(vtkPoints *queryPoints, vtkIdTypeArray *closestIds,
+                         vtkDoubleArray *dist2 = nullptr) override;
+  void FindPointsWithinRadius(double R, vtkPoints *queryPoints,
+                              vtkIdTypeArray *offsets, vtkIdTypeArray *ids,
+                              vtkDoubleArray *dist2 = nullptr) override;
+  //@}
+
   //@{
   /**
    * See vtkLocator interface documentation.
@@ -22,6 +22,7 @@
 #include "vtkCellArray.h"
 #include "vtkCommand.h"
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
@@ -32,6 +33,7 @@
 #include "vtkPoints.h"
 #include "vtkPointSet.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 
 #include <list>
 #include <map>
@@ -571,6 +573,42 @@ vtkIdType vtkOctreePointLocator::FindClosestPoint(
   return closePointId;
 }
 
+//----------------------------------------------------------------------------
+void vtkOctreePointLocator::FindClosestPoints(vtkPoints *queryPoints,
+                                              vtkIdTypeArray *closestIds,
+                                              vtkDoubleArray *dist2)
+{
+  this->BuildLocator();
+
+  vtkIdType numQueries = queryPoints->GetNumberOfPoints();
+
+  closestIds->SetNumberOfComponents(1);
+  closestIds->SetNumberOfTuples(numQueries);
+  vtkIdType *closest = closestIds->GetPointer(0);
+
+  double *closestDist2 = nullptr;
+  if (dist2)
+  {
+    dist2->SetNumberOfComponents(1);
+    dist2->SetNumberOfTuples(numQueries);
+    closestDist2 = dist2->GetPointer(0);
+  }
+
+  vtkSMPTools::For(0, numQueries, [&](vtkIdType begin, vtkIdType end)
+  {
+    double x[3], d2;
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      queryPoints->GetPoint(i, x);
+      closest[i] = this->FindClosestPoint(x[0], x[1], x[2], d2);
+      if (closestDist2)
+      {
+        closestDist2[i] = d2;
+      }
+    }
+  });
+}
+
 //----------------------------------------------------------------------------
 vtkIdType vtkOctreePointLocator::FindClosestPointWithinRadius(
   double radius, const double x[3], double& dist2)
@@ -119,6 +119,10 @@ public:
    */
   void BuildLocator() override;
 
+  // Re-use any superclass signatures that we don't override.
+  using vtkAbstractPointLocator::FindClosestNPoints;
+  using vtkAbstractPointLocator::FindPointsWithinRadius;
+
   //@{
   /**
    * Return the Id of the point that is closest to the given point.
@@ -128,6 +132,14 @@ public:
   vtkIdType FindClosestPoint(double x, double y, double z, double &dist2);
   //@}
 
+  /**
+   * Batched version of FindClosestPoint(), see vtkAbstractPointLocator.
+   * The distances are those computed by the octree, from the single
+   * precision copy of the points it holds.
+   */
+  void FindClosestPoints(vtkPoints *queryPoints, vtkIdTypeArray *closestIds,
+                         vtkDoubleArray *dist2 = nullptr) override;
+
   /**
    * Given a position x and a radius r, return the id of the point
    * closest to the point in that radius.
@@ -82,6 +82,8 @@ public:
 
   // Re-use any superclass signatures that we don't override.
   using vtkAbstractPointLocator::FindClosestPoint;
+  using vtkAbstractPointLocator::FindClosestNPoints;
+  using vtkAbstractPointLocator::FindPointsWithinRadius;
 
   /**
    * Given a position x, return the id of the point closest to it. Alternative
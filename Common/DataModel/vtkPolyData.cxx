@@ -223,7 +223,8 @@ int vtkPolyData::GetCellType(vtkIdType cellId)
 vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
 {
   vtkIdType i, loc;
-  vtkIdType *pts, numPts;
+  const vtkIdType *pts;
+  vtkIdType numPts;
   vtkCell *cell = nullptr;
   unsigned char type;
 
@@ -243,7 +244,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Vertex = vtkVertex::New();
       }
       cell = this->Vertex;
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_VERTEX:
@@ -252,7 +253,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->PolyVertex = vtkPolyVertex::New();
       }
       cell = this->PolyVertex;
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -263,7 +264,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Line = vtkLine::New();
       }
       cell = this->Line;
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_LINE:
@@ -272,7 +273,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->PolyLine = vtkPolyLine::New();
       }
       cell = this->PolyLine;
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -283,7 +284,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Triangle = vtkTriangle::New();
       }
       cell = this->Triangle;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_QUAD:
@@ -292,7 +293,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Quad = vtkQuad::New();
       }
       cell = this->Quad;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLYGON:
@@ -301,7 +302,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Polygon = vtkPolygon::New();
       }
       cell = this->Polygon;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -312,7 +313,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->TriangleStrip = vtkTriangleStrip::New();
       }
       cell = this->TriangleStrip;
-      this->Strips->GetCell(loc,numPts,pts);
+      this->Strips->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -339,7 +340,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
 void vtkPolyData::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 {
   vtkIdType       i, loc;
-  vtkIdType       *pts=nullptr;
+  const vtkIdType *pts=nullptr;
   vtkIdType       numPts;
   unsigned char   type;
   double           x[3];
@@ -356,48 +357,48 @@ void vtkPolyData::GetCell(vtkIdType cellId, vtkGenericCell *cell)
   {
     case VTK_VERTEX:
       cell->SetCellTypeToVertex();
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_VERTEX:
       cell->SetCellTypeToPolyVertex();
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_LINE:
       cell->SetCellTypeToLine();
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_LINE:
       cell->SetCellTypeToPolyLine();
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_TRIANGLE:
       cell->SetCellTypeToTriangle();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_QUAD:
       cell->SetCellTypeToQuad();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLYGON:
       cell->SetCellTypeToPolygon();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_TRIANGLE_STRIP:
       cell->SetCellTypeToTriangleStrip();
-      this->Strips->GetCell(loc,numPts,pts);
+      this->Strips->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -495,7 +496,9 @@ void vtkPolyData::CopyCells(vtkPolyData *pd, vtkIdList *idList,
 void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
 {
   vtkIdType i, loc;
-  vtkIdType *pts, numPts;
+  const vtkIdType *pts;
+  vtkIdType numPts;
+  vtkCellArray *cells;
   unsigned char type;
   double x[3];
 
@@ -511,22 +514,22 @@ void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
   {
     case VTK_VERTEX:
     case VTK_POLY_VERTEX:
-      this->Verts->GetCell(loc,numPts,pts);
+      cells = this->Verts;
       break;
 
     case VTK_LINE:
     case VTK_POLY_LINE:
-      this->Lines->GetCell(loc,numPts,pts);
+      cells = this->Lines;
       break;
 
     case VTK_TRIANGLE:
     case VTK_QUAD:
     case VTK_POLYGON:
-      this->Polys->GetCell(loc,numPts,pts);
+      cells = this->Polys;
       break;
 
     case VTK_TRIANGLE_STRIP:
-      this->Strips->GetCell(loc,numPts,pts);
+      cells = this->Strips;
       break;
 
     default:
@@ -535,6 +538,14 @@ void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
       return;
   }
 
+  // The ids are only copied when they are not stored as vtkIdType.
+  vtkSmartPointer<vtkIdList> ptIds;
+  if (!cells->IsIdTypeStorage())
+  {
+    ptIds = vtkSmartPointer<vtkIdList>::New();
+  }
+  cells->GetCell(loc,numPts,pts,ptIds);
+
   // carefully compute the bounds
   if (numPts)
   {
@@ -918,6 +929,37 @@ void vtkPolyData::DeleteCells()
   }
 }
 
+//----------------------------------------------------------------------------
+// Call f(cellId, location, npts) for each cell of a cell array. The offsets
+// storage is read through GetCellSize() rather than converted to the legacy
+// layout.
+template <typename Functor>
+static void vtkPolyDataForEachCell(vtkCellArray *cells, Functor f)
+{
+  vtkIdType numCells = cells->GetNumberOfCells();
+  if (numCells == 0)
+  {
+    return;
+  }
+  vtkIdType loc = 0;
+  if (cells->IsOffsetsStorage())
+  {
+    for (vtkIdType i = 0; i < numCells; ++i)
+    {
+      vtkIdType npts = cells->GetCellSize(i);
+      f(i, loc, npts);
+      loc += npts + 1;
+    }
+    return;
+  }
+  const vtkIdType *legacy = cells->GetPointer();
+  for (vtkIdType i = 0; i < numCells; ++i)
+  {
+    f(i, loc, legacy[loc]);
+    loc += legacy[loc] + 1;
+  }
+}
+
 //----------------------------------------------------------------------------
 // Create data structure that allows random access of cells.
 void vtkPolyData::BuildCells()
@@ -949,102 +991,47 @@ void vtkPolyData::BuildCells()
 
   // record locations and type of each cell.
   // verts
-  vtkIdType numCellPts;
-  vtkIdType nextCellPts;
-  if (nVerts)
-  {
-    vtkIdType *pVerts = vertCells->GetData()->GetPointer(0);
-    numCellPts = pVerts[0];
-    nextCellPts = numCellPts + 1;
-    pLocs[0] = 0;
-    pTypes[0] = numCellPts > 1 ? VTK_POLY_VERTEX : VTK_VERTEX;
-    for (vtkIdType i = 1; i < nVerts; ++i)
-    {
-      numCellPts = pVerts[nextCellPts];
-      pLocs[i] = nextCellPts;
-      pTypes[i] = numCellPts > 1 ? VTK_POLY_VERTEX : VTK_VERTEX;
-      nextCellPts += numCellPts + 1;
-    }
-    pLocs += nVerts;
-    pTypes += nVerts;
-  }
+  vtkPolyDataForEachCell(vertCells, [&](vtkIdType, vtkIdType loc,
+                                        vtkIdType numCellPts)
+  {
+    *pLocs++ = loc;
+    *pTypes++ = numCellPts > 1 ? VTK_POLY_VERTEX : VTK_VERTEX;
+  });
 
   // lines
-  if (nLines)
+  vtkPolyDataForEachCell(lineCells, [&](vtkIdType i, vtkIdType loc,
+                                        vtkIdType numCellPts)
   {
-    vtkIdType *pLines = lineCells->GetData()->GetPointer(0);
-    numCellPts = pLines[0];
-    pLocs[0] = 0;
-    pTypes[0] = numCellPts > 2 ? VTK_POLY_LINE : VTK_LINE;
+    *pLocs++ = loc;
+    *pTypes++ = numCellPts > 2 ? VTK_POLY_LINE : VTK_LINE;
     if (numCellPts == 1)
     {
-      vtkWarningMacro("Building VTK_LINE 0 with only one point, but VTK_LINE "
-      "needs at least two points. Check the input.");
-    }
-    nextCellPts = numCellPts + 1;
-    for (vtkIdType i = 1; i < nLines; ++i)
-    {
-      numCellPts = pLines[nextCellPts];
-      pLocs[i] = nextCellPts;
-      pTypes[i] = numCellPts > 2 ? VTK_POLY_LINE : VTK_LINE;
-      if (numCellPts == 1)
-      {
-        vtkWarningMacro("Building VTK_LINE " << i <<" with only one point, but "
-        "VTK_LINE needs at least two points. Check the input.");
-      }
-      nextCellPts += numCellPts + 1;
+      vtkWarningMacro("Building VTK_LINE " << i <<" with only one point, but "
+      "VTK_LINE needs at least two points. Check the input.");
     }
-    pLocs += nLines;
-    pTypes += nLines;
-  }
+  });
 
   // polys
-  if (nPolys)
+  vtkPolyDataForEachCell(polyCells, [&](vtkIdType i, vtkIdType loc,
+                                        vtkIdType numCellPts)
   {
-    vtkIdType *pPolys = polyCells->GetData()->GetPointer(0);
-    numCellPts = pPolys[0];
-    pLocs[0] = 0;
+    *pLocs++ = loc;
     if (numCellPts < 3)
     {
-      vtkWarningMacro("Building VTK_TRIANGLE 0 with less than three points, but"
-      " VTK_TRIANGLE needs at least three points. Check the input.");
+      vtkWarningMacro("Building VTK_TRIANGLE "<< i << " with less than three "
+      "points, but VTK_TRIANGLE needs at least three points. "
+      "Check the input.");
     }
-    pTypes[0] = numCellPts == 3 ? VTK_TRIANGLE :
+    *pTypes++ = numCellPts == 3 ? VTK_TRIANGLE :
       numCellPts == 4 ? VTK_QUAD : VTK_POLYGON;
-    nextCellPts = numCellPts + 1;
-    for (vtkIdType i = 1; i < nPolys; ++i)
-    {
-      numCellPts = pPolys[nextCellPts];
-      pLocs[i] = nextCellPts;
-      if (numCellPts < 3)
-      {
-        vtkWarningMacro("Building VTK_TRIANGLE "<< i << " with less than three "
-        "points, but VTK_TRIANGLE needs at least three points. "
-        "Check the input.");
-      }
-      pTypes[i] = numCellPts == 3 ? VTK_TRIANGLE :
-        numCellPts == 4 ? VTK_QUAD : VTK_POLYGON;
-      nextCellPts += numCellPts + 1;
-    }
-    pLocs += nPolys;
-    pTypes += nPolys;
-  }
+  });
 
   // strips
-  if (nStrips)
-  {
-    std::fill_n(pTypes, nStrips, VTK_TRIANGLE_STRIP);
-    vtkIdType *pStrips = stripCells->GetData()->GetPointer(0);
-    numCellPts = pStrips[0];
-    pLocs[0] = 0;
-    nextCellPts = numCellPts + 1;
-    for (vtkIdType i = 1; i < nStrips; ++i)
-    {
-      numCellPts = pStrips[nextCellPts];
-      pLocs[i] = nextCellPts;
-      nextCellPts += numCellPts + 1;
-    }
-  }
+  vtkPolyDataForEachCell(stripCells, [&](vtkIdType, vtkIdType loc, vtkIdType)
+  {
+    *pLocs++ = loc;
+    *pTypes++ = VTK_TRIANGLE_STRIP;
+  });
 
   // set up the cell types data structure
   this->Cells = vtkCellTypes::New();
@@ -1099,21 +1086,86 @@ void vtkPolyData::BuildLinks(int initialSize)
 // Copy a cells point ids into list provided. (Less efficient.)
 void vtkPolyData::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 {
-  vtkIdType i;
-  vtkIdType *pts, npts;
-
   ptIds->Reset();
   if ( this->Cells == nullptr )
   {
     this->BuildCells();
   }
 
-  this->vtkPolyData::GetCellPoints(cellId, npts, pts);
-  ptIds->InsertId (npts-1,pts[npts-1]);
-  for (i=0; i<npts-1; i++)
+  // The ids are copied by vtkCellArray::GetCell(loc, ptIds), which does not
+  // modify the cell array, so that several threads may call this method.
+  vtkCellArray *cells;
+  switch (this->Cells->GetCellType(cellId))
+  {
+    case VTK_VERTEX: case VTK_POLY_VERTEX:
+      cells = this->Verts;
+      break;
+
+    case VTK_LINE: case VTK_POLY_LINE:
+      cells = this->Lines;
+      break;
+
+    case VTK_TRIANGLE: case VTK_QUAD: case VTK_POLYGON:
+      cells = this->Polys;
+      break;
+
+    case VTK_TRIANGLE_STRIP:
+      cells = this->Strips;
+      break;
+
+    default:
+      return;
+  }
+  cells->GetCell(this->Cells->GetCellLocation(cellId), ptIds);
+}
+
+//----------------------------------------------------------------------------
+unsigned char vtkPolyData::GetCellPoints(vtkIdType cellId, vtkIdType& npts,
+                                         vtkIdType const* &pts,
+                                         vtkIdList *ptIds)
+{
+  unsigned char type = this->Cells->GetCellType(cellId);
+  vtkCellArray *cells;
+  switch (type)
+  {
+    case VTK_VERTEX: case VTK_POLY_VERTEX:
+      cells = this->Verts;
+      break;
+
+    case VTK_LINE: case VTK_POLY_LINE:
+      cells = this->Lines;
+      break;
+
+    case VTK_TRIANGLE: case VTK_QUAD: case VTK_POLYGON:
+      cells = this->Polys;
+      break;
+
+    case VTK_TRIANGLE_STRIP:
+      cells = this->Strips;
+      break;
+
+    default:
+      npts = 0;
+      pts = nullptr;
+      return 0;
+  }
+  cells->GetCell(this->Cells->GetCellLocation(cellId), npts, pts, ptIds);
+  return type;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkIdList> vtkPolyData::NewCellPointsBuffer()
+{
+  vtkCellArray *cellArrays[4] =
+    { this->Verts, this->Lines, this->Polys, this->Strips };
+  for (int i = 0; i < 4; ++i)
   {
-    ptIds->SetId(i,pts[i]);
+    if (cellArrays[i] && !cellArrays[i]->IsIdTypeStorage())
+    {
+      return vtkSmartPointer<vtkIdList>::New();
+    }
   }
+  return nullptr;
 }
 
 //----------------------------------------------------------------------------
@@ -1690,7 +1742,9 @@ int vtkPolyData::IsEdge(vtkIdType p1, vtkIdType p2)
   vtkIdType cellType;
   vtkIdType npts;
   vtkIdType i, j;
-  vtkIdType *cells, *pts;
+  vtkIdType *cells;
+  vtkIdType const* pts;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
   vtkIdType nbPoints = this->GetNumberOfPoints();
   if (p1 >= nbPoints || p2 >= nbPoints)
@@ -1713,7 +1767,7 @@ int vtkPolyData::IsEdge(vtkIdType p1, vtkIdType p2)
         }
         break;
       case VTK_QUAD:
-        this->GetCellPoints(cells[i],npts,pts);
+        this->GetCellPoints(cells[i],npts,pts,buffer);
         for (j=0; j<npts-1; j++)
         {
           if (((pts[j]==p1)&&(pts[j+1]==p2))||((pts[j]==p2)&&(pts[j+1]==p1)))
@@ -1727,7 +1781,7 @@ int vtkPolyData::IsEdge(vtkIdType p1, vtkIdType p2)
         }
         break;
       case VTK_TRIANGLE_STRIP:
-        this->GetCellPoints(cells[i],npts,pts);
+        this->GetCellPoints(cells[i],npts,pts,buffer);
         for (j=0; j<npts-2; j++)
         {
           if ((((pts[j]==p1)&&(pts[j+1]==p2))||((pts[j]==p2)&&(pts[j+1]==p1)))||
@@ -1742,7 +1796,7 @@ int vtkPolyData::IsEdge(vtkIdType p1, vtkIdType p2)
         }
         break;
       default:
-        this->GetCellPoints(cells[i],npts,pts);
+        this->GetCellPoints(cells[i],npts,pts,buffer);
         for (j=0; j<npts; j++)
         {
           if (p1==pts[j])
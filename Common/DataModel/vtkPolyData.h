@@ -64,6 +64,7 @@
 #include "vtkCellTypes.h" // Needed for inline methods
 #include "vtkCellLinks.h" // Needed for inline methods
 #include "vtkCellArray.h" // Needed for inline methods
+#include "vtkSmartPointer.h" // Needed for inline methods
 
 class vtkVertex;
 class vtkPolyVertex;
@@ -269,6 +270,11 @@ public:
    */
   void BuildLinks(int initialSize=0);
 
+  /**
+   * Get the links built by BuildLinks(), nullptr if they are not built.
+   */
+  vtkCellLinks *GetCellLinks() {return this->Links;};
+
   /**
    * Release data structure that allows random access of the cells. This must
    * be done before a 2nd call to BuildLinks(). DeleteCells implicitly deletes
@@ -304,6 +310,15 @@ public:
   unsigned char GetCellPoints(vtkIdType cellId,
       vtkIdType& npts, vtkIdType* &pts);
 
+  /**
+   * Same as the method above, but the cell arrays are never modified: when
+   * the ids are not stored as vtkIdType, they are copied into ptIds, and
+   * pts points into ptIds. Use it with one ptIds per thread to access the
+   * cells from several threads (BuildCells() must have been called).
+   */
+  unsigned char GetCellPoints(vtkIdType cellId, vtkIdType& npts,
+                              vtkIdType const* &pts, vtkIdList *ptIds);
+
   /**
    * Get a pointer to the cell, ie [npts pid1 .. pidn]. More efficient
    * because pointer points directly to cell array internals and this
@@ -560,6 +575,11 @@ protected:
   vtkCellTypes *Cells;
   vtkCellLinks *Links;
 
+  // Id list to pass to GetCellPoints(cellId, npts, pts, ptIds): nullptr
+  // when all the cell arrays store their ids as vtkIdType, so that only the
+  // other storages pay for the allocation.
+  vtkSmartPointer<vtkIdList> NewCellPointsBuffer();
+
 private:
   // Hide these from the user and the compiler.
 
@@ -587,7 +607,9 @@ inline int vtkPolyData::IsTriangle(int v1, int v2, int v3)
 {
   unsigned short int n1;
   int i, j, tVerts[3];
-  vtkIdType *cells, *tVerts2, n2;
+  vtkIdType *cells, n2;
+  vtkIdType const* tVerts2;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
   tVerts[0] = v1;
   tVerts[1] = v2;
@@ -598,7 +620,7 @@ inline int vtkPolyData::IsTriangle(int v1, int v2, int v3)
     this->GetPointCells(tVerts[i], n1, cells);
     for (j=0; j<n1; j++)
     {
-      this->GetCellPoints(cells[j], n2, tVerts2);
+      this->GetCellPoints(cells[j], n2, tVerts2, buffer);
       if ( (tVerts[0] == tVerts2[0] || tVerts[0] == tVerts2[1] ||
             tVerts[0] == tVerts2[2]) &&
            (tVerts[1] == tVerts2[0] || tVerts[1] == tVerts2[1] ||
@@ -615,9 +637,11 @@ inline int vtkPolyData::IsTriangle(int v1, int v2, int v3)
 
 inline int vtkPolyData::IsPointUsedByCell(vtkIdType ptId, vtkIdType cellId)
 {
-  vtkIdType *pts, npts;
+  vtkIdType npts;
+  vtkIdType const* pts;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
-  this->GetCellPoints(cellId, npts, pts);
+  this->GetCellPoints(cellId, npts, pts, buffer);
   for (vtkIdType i=0; i < npts; i++)
   {
     if ( pts[i] == ptId )
@@ -641,9 +665,11 @@ inline void vtkPolyData::DeleteCell(vtkIdType cellId)
 
 inline void vtkPolyData::RemoveCellReference(vtkIdType cellId)
 {
-  vtkIdType *pts, npts;
+  vtkIdType npts;
+  vtkIdType const* pts;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
-  this->GetCellPoints(cellId, npts, pts);
+  this->GetCellPoints(cellId, npts, pts, buffer);
   for (vtkIdType i=0; i<npts; i++)
   {
     this->Links->RemoveCellReference(cellId, pts[i]);
@@ -652,9 +678,11 @@ inline void vtkPolyData::RemoveCellReference(vtkIdType cellId)
 
 inline void vtkPolyData::AddCellReference(vtkIdType cellId)
 {
-  vtkIdType *pts, npts;
+  vtkIdType npts;
+  vtkIdType const* pts;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
-  this->GetCellPoints(cellId, npts, pts);
+  this->GetCellPoints(cellId, npts, pts, buffer);
   for (vtkIdType i=0; i<npts; i++)
   {
     this->Links->AddCellReference(cellId, pts[i]);
@@ -670,14 +698,24 @@ inline void vtkPolyData::ReplaceCellPoint(vtkIdType cellId, vtkIdType oldPtId,
                                           vtkIdType newPtId)
 {
   int i;
-  vtkIdType *verts, nverts;
+  vtkIdType nverts;
+  vtkIdType const* verts;
+  vtkSmartPointer<vtkIdList> buffer = this->NewCellPointsBuffer();
 
-  this->GetCellPoints(cellId,nverts,verts);
+  this->GetCellPoints(cellId,nverts,verts,buffer);
   for ( i=0; i < nverts; i++ )
   {
     if ( verts[i] == oldPtId )
     {
-      verts[i] = newPtId; // this is very nasty! direct write!
+      if (buffer && verts == buffer->GetPointer(0))
+      {
+        // The ids were copied out of the cell array: replace the cell.
+        buffer->SetId(i, newPtId);
+        this->ReplaceCell(cellId, static_cast<int>(nverts),
+                          buffer->GetPointer(0));
+        return;
+      }
+      const_cast<vtkIdType*>(verts)[i] = newPtId; // this is very nasty! direct write!
       return;
     }
   }
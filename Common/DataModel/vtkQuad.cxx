@@ -694,7 +694,7 @@ void vtkQuad::Derivatives(int vtkNotUsed(subId), double pcoords[3],
     {
       for ( i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
@@ -729,7 +729,7 @@ void vtkQuad::Derivatives(int vtkNotUsed(subId), double pcoords[3],
     {
       for ( i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
@@ -492,7 +492,7 @@ void vtkQuadraticQuad::Derivatives(int vtkNotUsed(subId),
     {
       for (int i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
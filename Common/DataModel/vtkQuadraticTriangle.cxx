@@ -303,7 +303,7 @@ void vtkQuadraticTriangle::Derivatives(int vtkNotUsed(subId), double pcoords[3],
     {
       for (int i=0; i < 3; i++ )
       {
-        derivs[j*dim + i] = 0.0;
+        derivs[j*3 + i] = 0.0;
       }
     }
     return;
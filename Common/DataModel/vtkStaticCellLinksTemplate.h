@@ -38,6 +38,9 @@
  * although it uses vtkIdType and thereby loses some speed and memory
  * advantage.
  *
+ * The links are built in parallel with vtkSMPTools. The cells using a point
+ * are listed in increasing order of cell id.
+ *
  * @sa
  * vtkCellLinks vtkStaticCellLinks
 */
@@ -106,6 +109,13 @@ public:
   }
 
 protected:
+  /**
+   * Build the links of the cells provided by access (see
+   * vtkStaticCellLinksTemplate.txx) for numPts points.
+   */
+  template <typename TAccess>
+  void BuildLinks(const TAccess &access, vtkIdType numPts);
+
   // The various templated data members
   TIds LinksSize;
   TIds NumPts;
@@ -19,255 +19,398 @@
 
 #include "vtkCellArray.h"
 #include "vtkDataSet.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkUnstructuredGrid.h"
 
-//----------------------------------------------------------------------------
-// Note: this class is a faster, serial version of vtkCellLinks. Future work
-// to parallelize this class is possible. This includes:
-// = using a parallel prefix sum operation
-// = using atomics to update counts (i.e., number of cells using a point)
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 //----------------------------------------------------------------------------
-// Clean up any previously allocated memory
-template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
-Initialize()
+// The links are built in parallel in three passes over the cells. The
+// number of uses of each point is counted with atomics, a parallel prefix
+// sum of the counts gives the offsets of the runs of cell ids, and the cell
+// ids are inserted into the runs through atomic cursors. Threads insert the
+// cells in an arbitrary order, so each run is finally sorted: the cells
+// using a point are listed in increasing order of cell id.
+namespace vtkStaticCellLinksDetail
 {
-  if ( this->Links )
+
+// Random access to the cells of one or more vtkCellArrays whose cells are
+// numbered consecutively (the four cell arrays of a vtkPolyData for
+// example). Cells with offsets storage are accessed with GetCellAtId();
+// legacy storage requires the location of each cell which is either
+// provided or computed with a (serial) traversal of the cells.
+class CellArraysAccess
+{
+public:
+  void AddCells(vtkCellArray *cells, vtkIdTypeArray *locations = nullptr)
   {
-    delete [] this->Links;
-    this->Links = nullptr;
+    Range range;
+    range.Cells = cells;
+    range.Begin = this->GetNumberOfCells();
+    range.End = range.Begin + (cells ? cells->GetNumberOfCells() : 0);
+    range.Legacy = nullptr;
+    range.Locations = nullptr;
+    if (range.End > range.Begin && !cells->IsOffsetsStorage())
+    {
+      range.Legacy = cells->GetPointer();
+      if (locations && locations->GetNumberOfValues() >= range.End - range.Begin)
+      {
+        range.Locations = locations->GetPointer(0);
+      }
+      else
+      {
+        this->ComputedLocations.emplace_back(range.End - range.Begin);
+        std::vector<vtkIdType> &locs = this->ComputedLocations.back();
+        vtkIdType loc = 0;
+        for (vtkIdType i = 0; i < range.End - range.Begin; ++i)
+        {
+          locs[i] = loc;
+          loc += range.Legacy[loc] + 1;
+        }
+        range.Locations = locs.data();
+      }
+    }
+    this->Ranges.push_back(range);
   }
-  if ( this->Offsets )
+
+  vtkIdType GetNumberOfCells() const
   {
-    delete [] this->Offsets;
-    this->Offsets = nullptr;
+    return this->Ranges.empty() ? 0 : this->Ranges.back().End;
   }
-}
 
-//----------------------------------------------------------------------------
-// Build the link list array for any dataset type. Specialized methods are
-// used for dataset types that use vtkCellArrays to represent cells.
-template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
-BuildLinks(vtkDataSet *ds)
-{
-  // Use a fast path if polydata or unstructured grid
-  if ( ds->GetDataObjectType() == VTK_POLY_DATA )
+  // Thread safe as long as each thread provides its own buffer.
+  void GetCellPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType* &pts,
+                     vtkIdList *buffer) const
   {
-    return this->BuildLinks(static_cast<vtkPolyData*>(ds));
+    size_t i = 0;
+    while (cellId >= this->Ranges[i].End)
+    {
+      ++i;
+    }
+    const Range &range = this->Ranges[i];
+    if (range.Legacy)
+    {
+      const vtkIdType *cell = range.Legacy + range.Locations[cellId - range.Begin];
+      npts = *cell;
+      pts = cell + 1;
+    }
+    else
+    {
+      range.Cells->GetCellAtId(cellId - range.Begin, npts, pts, buffer);
+    }
   }
 
-  else if ( ds->GetDataObjectType() == VTK_UNSTRUCTURED_GRID )
+private:
+  struct Range
   {
-    return this->BuildLinks(static_cast<vtkUnstructuredGrid*>(ds));
+    vtkCellArray *Cells;
+    vtkIdType Begin;
+    vtkIdType End;
+    const vtkIdType *Legacy;
+    const vtkIdType *Locations;
+  };
+  std::vector<Range> Ranges;
+  std::vector<std::vector<vtkIdType> > ComputedLocations;
+};
+
+// Access to the cells of any dataset through vtkDataSet::GetCellPoints(),
+// which is thread safe once it has been called from a single thread.
+class DataSetAccess
+{
+public:
+  explicit DataSetAccess(vtkDataSet *ds) : DataSet(ds)
+  {
+    if (ds->GetNumberOfCells() > 0)
+    {
+      vtkIdList *buffer = vtkIdList::New();
+      ds->GetCellPoints(0, buffer);
+      buffer->Delete();
+    }
   }
 
-  // Any other type of dataset. Generally this is not called as datasets have
-  // their own, more efficient ways of getting similar information.
-  // Make sure that we clear out previous allocation.
-  this->NumCells = ds->GetNumberOfCells();
-  this->NumPts = ds->GetNumberOfPoints();
+  vtkIdType GetNumberOfCells() const
+  {
+    return this->DataSet->GetNumberOfCells();
+  }
 
-  vtkIdType npts, ptId;
-  vtkIdType cellId, j;
-  vtkIdList *cellPts = vtkIdList::New();
+  void GetCellPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType* &pts,
+                     vtkIdList *buffer) const
+  {
+    this->DataSet->GetCellPoints(cellId, buffer);
+    npts = buffer->GetNumberOfIds();
+    pts = buffer->GetPointer(0);
+  }
 
-  // Traverse data to determine number of uses of each point. Also count the
-  // number of links to allocate.
-  this->Offsets = new TIds[this->NumPts+1];
-  std::fill_n(this->Offsets, this->NumPts, 0);
+private:
+  vtkDataSet *DataSet;
+};
 
-  for (this->LinksSize=0, cellId=0; cellId < this->NumCells; cellId++)
+// Access to the cells of a vtkPolyData in the order of its cell ids, which
+// follows the insertion order and may interleave the four cell arrays. The
+// cells are read through the cell types table without being copied when
+// they are stored as vtkIdType. Thread safe once the table is built, which
+// the constructor takes care of.
+class PolyDataAccess
+{
+public:
+  explicit PolyDataAccess(vtkPolyData *pd) : PolyData(pd)
   {
-    ds->GetCellPoints(cellId,cellPts);
-    npts = cellPts->GetNumberOfIds();
-    for (j=0; j < npts; j++)
+    if (pd->NeedToBuildCells())
     {
-      this->Offsets[cellPts->GetId(j)]++;
-      this->LinksSize++;
+      pd->BuildCells();
     }
   }
 
-  // Allocate space for links. Perform prefix sum.
-  this->Links = new TIds[this->LinksSize+1];
-  this->Links[this->LinksSize] = this->NumPts;
-
-  for ( ptId=0; ptId < this->NumPts; ++ptId )
+  vtkIdType GetNumberOfCells() const
   {
-    npts = this->Offsets[ptId+1];
-    this->Offsets[ptId+1] = this->Offsets[ptId] + npts;
+    return this->PolyData->GetNumberOfCells();
   }
 
-  // Now build the links. The summation from the prefix sum indicates where
-  // the cells are to be inserted. Each time a cell is inserted, the offset
-  // is decremented. In the end, the offset array is also constructed as it
-  // points to the beginning of each cell run.
-  for ( cellId=0; cellId < this->NumCells; ++cellId )
+  void GetCellPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType* &pts,
+                     vtkIdList *buffer) const
   {
-    ds->GetCellPoints(cellId,cellPts);
-    npts = cellPts->GetNumberOfIds();
-    for (j=0; j<npts; ++j)
-    {
-      ptId = cellPts->GetId(j);
-      this->Offsets[ptId]--;
-      this->Links[this->Offsets[ptId]] = cellId;
-    }
+    this->PolyData->GetCellPoints(cellId, npts, pts, buffer);
   }
-  this->Offsets[this->NumPts] = this->LinksSize;
 
-  cellPts->Delete();
-}
+private:
+  vtkPolyData *PolyData;
+};
 
-//----------------------------------------------------------------------------
-// Build the link list array for unstructured grids
-template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
-BuildLinks(vtkUnstructuredGrid *ugrid)
+// Access to the cells of any dataset: CellArraysAccess for unstructured
+// grids, DataSetAccess otherwise. (The cell ids of poly data follow the
+// insertion order, which may mix the four cell arrays.)
+class AnyDataSetAccess
 {
-  // Basic information about the grid
-  this->NumCells = ugrid->GetNumberOfCells();
-  this->NumPts = ugrid->GetNumberOfPoints();
-
-  // We're going to get into the guts of the class
-  vtkCellArray *cellArray = ugrid->GetCells();
-  const vtkIdType *cells = cellArray->GetPointer();
-
-  // I love this trick: the size of the Links array is equal to
-  // the size of the cell array, minus the number of cells.
-  this->LinksSize =
-    cellArray->GetNumberOfConnectivityEntries() - this->NumCells;
-
-  // Extra one allocated to simplify later pointer manipulation
-  this->Links = new TIds[this->LinksSize+1];
-  this->Links[this->LinksSize] = this->NumPts;
-  this->Offsets = new TIds[this->NumPts+1];
-  std::fill_n(this->Offsets, this->NumPts, 0);
-
-  // Now create the links.
-  vtkIdType npts, cellId, ptId;
-  const vtkIdType *cell=cells;
-  int i;
-
-  // Count number of point uses
-  for ( cellId=0; cellId < this->NumCells; ++cellId )
+public:
+  explicit AnyDataSetAccess(vtkDataSet *ds) : DataSet(nullptr)
   {
-    npts = *cell++;
-    for (i=0; i<npts; ++i)
+    if (ds->GetDataObjectType() == VTK_UNSTRUCTURED_GRID)
     {
-      this->Offsets[*cell++]++;
+      vtkUnstructuredGrid *ugrid = static_cast<vtkUnstructuredGrid*>(ds);
+      this->Cells.AddCells(ugrid->GetCells(), ugrid->GetCellLocationsArray());
+    }
+    else
+    {
+      this->DataSet = new DataSetAccess(ds);
     }
   }
 
-  // Perform prefix sum
-  for ( ptId=0; ptId < this->NumPts; ++ptId )
+  ~AnyDataSetAccess()
   {
-    npts = this->Offsets[ptId+1];
-    this->Offsets[ptId+1] = this->Offsets[ptId] + npts;
+    delete this->DataSet;
   }
 
-  // Now build the links. The summation from the prefix sum indicates where
-  // the cells are to be inserted. Each time a cell is inserted, the offset
-  // is decremented. In the end, the offset array is also constructed as it
-  // points to the beginning of each cell run.
-  for ( cell=cells, cellId=0; cellId < this->NumCells; ++cellId )
+  void GetCellPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType* &pts,
+                     vtkIdList *buffer) const
   {
-    npts = *cell++;
-    for (i=0; i<npts; ++i)
+    if (this->DataSet)
+    {
+      this->DataSet->GetCellPoints(cellId, npts, pts, buffer);
+    }
+    else
     {
-      this->Offsets[*cell]--;
-      this->Links[this->Offsets[*cell++]] = cellId;
+      this->Cells.GetCellPoints(cellId, npts, pts, buffer);
     }
   }
-  this->Offsets[this->NumPts] = this->LinksSize;
-}
 
-//----------------------------------------------------------------------------
-// Build the link list array for poly data. This is more complex because there
-// are potentially fout different cell arrays to contend with.
-template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
-BuildLinks(vtkPolyData *pd)
-{
-  // Basic information about the grid
-  this->NumCells = pd->GetNumberOfCells();
-  this->NumPts = pd->GetNumberOfPoints();
+private:
+  AnyDataSetAccess(const AnyDataSetAccess&) = delete;
+  void operator=(const AnyDataSetAccess&) = delete;
 
-  vtkCellArray *cellArrays[4];
-  vtkIdType numCells[4];
-  vtkIdType sizes[4];
-  int i, j;
+  CellArraysAccess Cells;
+  DataSetAccess *DataSet;
+};
 
-  cellArrays[0] = pd->GetVerts();
-  cellArrays[1] = pd->GetLines();
-  cellArrays[2] = pd->GetPolys();
-  cellArrays[3] = pd->GetStrips();
+// Count the number of uses of each point.
+template <typename TIds, typename TAccess>
+struct CountUses
+{
+  const TAccess &Access;
+  std::atomic<TIds> *Counts;
+  vtkSMPThreadLocalObject<vtkIdList> Buffer;
 
-  for (i=0; i<4; ++i)
+  CountUses(const TAccess &access, std::atomic<TIds> *counts)
+    : Access(access), Counts(counts) {}
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
   {
-    if ( cellArrays[i] != nullptr )
+    vtkIdList *buffer = this->Buffer.Local();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (; cellId < endCellId; ++cellId)
     {
-      numCells[i] = cellArrays[i]->GetNumberOfCells();
-      sizes[i] = cellArrays[i]->GetNumberOfConnectivityEntries() - numCells[i];
-    }
-    else
-    {
-      numCells[i] = 0;
-      sizes[i] = 0;
+      this->Access.GetCellPoints(cellId, npts, pts, buffer);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        this->Counts[pts[i]].fetch_add(1, std::memory_order_relaxed);
+      }
     }
-  }//for the four polydata arrays
-
-  // Allocate
-  this->LinksSize = sizes[0] + sizes[1] + sizes[2] + sizes[3];
-  this->Links = new TIds[this->LinksSize+1];
-  this->Links[this->LinksSize] = this->NumPts;
-  this->Offsets = new TIds[this->NumPts+1];
-  this->Offsets[this->NumPts] = this->LinksSize;
-  std::fill_n(this->Offsets, this->NumPts, 0);
-
-  // Now create the links.
-  vtkIdType npts, cellId, CellId, ptId;
-  const vtkIdType *cell;
-
-  // Visit the four arrays
-  for ( CellId=0, j=0; j < 4; ++j )
+  }
+};
+
+// Insert the cell ids into the runs of the points they use.
+template <typename TIds, typename TAccess>
+struct InsertCells
+{
+  const TAccess &Access;
+  std::atomic<TIds> *Cursors;
+  TIds *Links;
+  vtkSMPThreadLocalObject<vtkIdList> Buffer;
+
+  InsertCells(const TAccess &access, std::atomic<TIds> *cursors, TIds *links)
+    : Access(access), Cursors(cursors), Links(links) {}
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
   {
-    // Count number of point uses
-    cell = cellArrays[j]->GetPointer();
-    for ( cellId=0; cellId < numCells[j]; ++cellId )
+    vtkIdList *buffer = this->Buffer.Local();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (; cellId < endCellId; ++cellId)
     {
-      npts = *cell++;
-      for (i=0; i<npts; ++i)
+      this->Access.GetCellPoints(cellId, npts, pts, buffer);
+      for (vtkIdType i = 0; i < npts; ++i)
       {
-        this->Offsets[CellId+(*cell++)]++;
+        TIds loc =
+          this->Cursors[pts[i]].fetch_add(1, std::memory_order_relaxed);
+        this->Links[loc] = static_cast<TIds>(cellId);
       }
     }
-    CellId += numCells[j];
-  } //for each of the four polydata cell arrays
-
-  // Perform prefix sum
-  for ( ptId=0; ptId < this->NumPts; ++ptId )
-  {
-    npts = this->Offsets[ptId+1];
-    this->Offsets[ptId+1] = this->Offsets[ptId] + npts;
   }
+};
 
-  // Now build the links. The summation from the prefix sum indicates where
-  // the cells are to be inserted. Each time a cell is inserted, the offset
-  // is decremented. In the end, the offset array is also constructed as it
-  // points to the beginning of each cell run.
-  for ( CellId=0, j=0; j < 4; ++j )
+template <typename TIds>
+struct SortRuns
+{
+  const TIds *Offsets;
+  TIds *Links;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId) const
   {
-    cell = cellArrays[j]->GetPointer();
-    for ( cellId=0; cellId < numCells[j]; ++cellId )
+    for (; ptId < endPtId; ++ptId)
     {
-      npts = *cell++;
-      for (i=0; i<npts; ++i)
-      {
-        this->Offsets[*cell]--;
-        this->Links[this->Offsets[*cell++]] = CellId+cellId;
-      }
+      std::sort(this->Links + this->Offsets[ptId],
+                this->Links + this->Offsets[ptId + 1]);
     }
-    CellId += numCells[j];
-  }//for each of the four polydata arrays
-  this->Offsets[this->NumPts] = this->LinksSize;
+  }
+};
+
+// Build the links of the cells provided by access. offsets must have room
+// for numPts+1 values. Returns the links, an array of linksSize+1 values
+// allocated with new[].
+template <typename TIds, typename TAccess>
+TIds *BuildLinks(const TAccess &access, vtkIdType numPts, TIds *offsets,
+                 TIds &linksSize)
+{
+  vtkIdType numCells = access.GetNumberOfCells();
+
+  std::atomic<TIds> *counts = new std::atomic<TIds>[numPts];
+  vtkSMPTools::Fill(counts, counts + numPts, 0);
+  CountUses<TIds, TAccess> count(access, counts);
+  vtkSMPTools::For(0, numCells, count);
+
+  linksSize = vtkSMPTools::ExclusiveScan(counts, counts + numPts, offsets,
+                                         static_cast<TIds>(0));
+  offsets[numPts] = linksSize;
+
+  TIds *links = new TIds[linksSize + 1];
+  links[linksSize] = static_cast<TIds>(numPts);
+  vtkSMPTools::Transform(offsets, offsets + numPts, counts,
+                         [](TIds offset) { return offset; });
+  InsertCells<TIds, TAccess> insert(access, counts, links);
+  vtkSMPTools::For(0, numCells, insert);
+  delete [] counts;
+
+  SortRuns<TIds> sortRuns = { offsets, links };
+  vtkSMPTools::For(0, numPts, sortRuns);
+
+  return links;
+}
+
+} // vtkStaticCellLinksDetail
+
+//----------------------------------------------------------------------------
+// Clean up any previously allocated memory
+template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
+Initialize()
+{
+  if ( this->Links )
+  {
+    delete [] this->Links;
+    this->Links = nullptr;
+  }
+  if ( this->Offsets )
+  {
+    delete [] this->Offsets;
+    this->Offsets = nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Build the link list array for any dataset type. Specialized methods are
+// used for dataset types that use vtkCellArrays to represent cells.
+template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
+BuildLinks(vtkDataSet *ds)
+{
+  // Use a fast path if polydata or unstructured grid
+  if ( ds->GetDataObjectType() == VTK_POLY_DATA )
+  {
+    return this->BuildLinks(static_cast<vtkPolyData*>(ds));
+  }
+
+  else if ( ds->GetDataObjectType() == VTK_UNSTRUCTURED_GRID )
+  {
+    return this->BuildLinks(static_cast<vtkUnstructuredGrid*>(ds));
+  }
+
+  // Any other type of dataset. Generally this is not called as datasets have
+  // their own, more efficient ways of getting similar information.
+  vtkStaticCellLinksDetail::DataSetAccess access(ds);
+  this->BuildLinks(access, ds->GetNumberOfPoints());
+}
+
+//----------------------------------------------------------------------------
+// Build the link list array for unstructured grids
+template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
+BuildLinks(vtkUnstructuredGrid *ugrid)
+{
+  vtkStaticCellLinksDetail::CellArraysAccess access;
+  access.AddCells(ugrid->GetCells(), ugrid->GetCellLocationsArray());
+  this->BuildLinks(access, ugrid->GetNumberOfPoints());
+}
+
+//----------------------------------------------------------------------------
+// Build the link list array for poly data. The cells of the four cell arrays
+// are numbered consecutively.
+template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
+BuildLinks(vtkPolyData *pd)
+{
+  vtkStaticCellLinksDetail::CellArraysAccess access;
+  access.AddCells(pd->GetVerts());
+  access.AddCells(pd->GetLines());
+  access.AddCells(pd->GetPolys());
+  access.AddCells(pd->GetStrips());
+  this->BuildLinks(access, pd->GetNumberOfPoints());
+}
+
+//----------------------------------------------------------------------------
+template <typename TIds> template <typename TAccess>
+void vtkStaticCellLinksTemplate<TIds>::
+BuildLinks(const TAccess &access, vtkIdType numPts)
+{
+  // Make sure that we clear out previous allocation.
+  this->Initialize();
+
+  this->NumCells = static_cast<TIds>(access.GetNumberOfCells());
+  this->NumPts = static_cast<TIds>(numPts);
+  this->Offsets = new TIds[numPts+1];
+  this->Links = vtkStaticCellLinksDetail::BuildLinks(
+    access, numPts, this->Offsets, this->LinksSize);
 }
 
 #endif
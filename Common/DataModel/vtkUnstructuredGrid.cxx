@@ -52,6 +52,7 @@
 #include "vtkQuadraticQuad.h"
 #include "vtkQuadraticTetra.h"
 #include "vtkQuadraticTriangle.h"
+#include "vtkSmartPointer.h"
 #include "vtkTetra.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleStrip.h"
@@ -523,11 +524,18 @@ vtkCell *vtkUnstructuredGrid::GetCell(vtkIdType cellId)
   vtkIdType i;
   vtkIdType loc;
   vtkCell *cell = nullptr;
-  vtkIdType *pts, numPts;
+  const vtkIdType *pts;
+  vtkIdType numPts;
 
+  // The ids are only copied when they are not stored as vtkIdType.
+  vtkSmartPointer<vtkIdList> ptIds;
+  if (!this->Connectivity->IsIdTypeStorage())
+  {
+    ptIds = vtkSmartPointer<vtkIdList>::New();
+  }
   loc = this->Locations->GetValue(cellId);
   vtkDebugMacro(<< "location = " <<  loc);
-  this->Connectivity->GetCell(loc,numPts,pts);
+  this->Connectivity->GetCell(loc,numPts,pts,ptIds);
 
   int cellType = static_cast<int>(this->Types->GetValue(cellId));
   switch (cellType)
@@ -887,18 +895,12 @@ vtkCell *vtkUnstructuredGrid::GetCell(vtkIdType cellId)
 //----------------------------------------------------------------------------
 void vtkUnstructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 {
-  vtkIdType loc;
-  vtkIdType *pts, numPts;
-
   int cellType = static_cast<int>(this->Types->GetValue(cellId));
   cell->SetCellType(cellType);
 
-  loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
-
-  cell->PointIds->SetNumberOfIds(numPts);
-
-  std::copy(pts, pts + numPts, cell->PointIds->GetPointer(0));
+  // Copy the ids without modifying the cell array.
+  this->Connectivity->GetCell(this->Locations->GetValue(cellId),
+                              cell->PointIds);
   this->Points->GetPoints(cell->PointIds, cell->Points);
 
   // Explicit face representation
@@ -923,10 +925,17 @@ void vtkUnstructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
   vtkIdType i;
   vtkIdType loc;
   double x[3];
-  vtkIdType *pts, numPts;
+  const vtkIdType *pts;
+  vtkIdType numPts;
 
+  // The ids are only copied when they are not stored as vtkIdType.
+  vtkSmartPointer<vtkIdList> ptIds;
+  if (!this->Connectivity->IsIdTypeStorage())
+  {
+    ptIds = vtkSmartPointer<vtkIdList>::New();
+  }
   loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
+  this->Connectivity->GetCell(loc,numPts,pts,ptIds);
 
   // carefully compute the bounds
   if (numPts)
@@ -1400,17 +1409,9 @@ void vtkUnstructuredGrid::BuildLinks()
 //----------------------------------------------------------------------------
 void vtkUnstructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 {
-  vtkIdType i, loc;
-  vtkIdType *pts, numPts;
-
-  loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
-  ptIds->SetNumberOfIds(numPts);
-  for (i=0; i<numPts; i++)
-  {
-    ptIds->SetId(i,pts[i]);
-  }
-
+  // GetCell(loc, ptIds) copies the ids without modifying the cell array,
+  // so that several threads may call this method.
+  this->Connectivity->GetCell(this->Locations->GetValue(cellId), ptIds);
 }
 
 //----------------------------------------------------------------------------
@@ -1426,6 +1427,15 @@ void vtkUnstructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdType& npts,
   this->Connectivity->GetCell(loc,npts,pts);
 }
 
+//----------------------------------------------------------------------------
+void vtkUnstructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdType& npts,
+                                        vtkIdType const* &pts,
+                                        vtkIdList *ptIds)
+{
+  this->Connectivity->GetCell(this->Locations->GetValue(cellId),
+                              npts, pts, ptIds);
+}
+
 //----------------------------------------------------------------------------
 void vtkUnstructuredGrid::GetFaceStream(vtkIdType cellId, vtkIdList *ptIds)
 {
@@ -1906,14 +1916,19 @@ void vtkUnstructuredGrid::GetCellNeighbors(vtkIdType cellId, vtkIdList *ptIds,
 
   //Now for each cell, see if it contains all the points
   //in the ptIds list.
+  vtkSmartPointer<vtkIdList> cellPtIds;
+  if (!this->Connectivity->IsIdTypeStorage())
+  {
+    cellPtIds = vtkSmartPointer<vtkIdList>::New();
+  }
   bool match;
   for (int i=0; i<minNumCells; i++)
   {
     if ( minCells[i] != cellId ) //don't include current cell
     {
-      vtkIdType *cellPts;
+      const vtkIdType *cellPts;
       vtkIdType npts;
-      this->GetCellPoints(minCells[i],npts,cellPts);
+      this->GetCellPoints(minCells[i],npts,cellPts,cellPtIds);
       match=true;
       for (vtkIdType j=0; j<numPts && match; j++) //for all pts in input cell
       {
@@ -160,6 +160,15 @@ public:
   virtual void GetCellPoints(vtkIdType cellId, vtkIdType& npts,
                              vtkIdType* &pts);
 
+  /**
+   * Same as the method above, but the cell array is never modified: when
+   * the ids are not stored as vtkIdType, they are copied into ptIds, and
+   * pts points into ptIds. Use it with one ptIds per thread to access the
+   * cells from several threads.
+   */
+  void GetCellPoints(vtkIdType cellId, vtkIdType& npts,
+                     vtkIdType const* &pts, vtkIdList *ptIds);
+
   /**
    * Get the face stream of a polyhedron cell in the following format:
    * (numCellFaces, numFace0Pts, id1, id2, id3, numFace1Pts,id1, id2, id3, ...).
@@ -210,7 +210,7 @@ void vtkVertex::Derivatives(int vtkNotUsed(subId),
 
   for (i=0; i<dim; i++)
   {
-    idx = i*dim;
+    idx = i*3;
     derivs[idx] = 0.0;
     derivs[idx+1] = 0.0;
     derivs[idx+2] = 0.0;
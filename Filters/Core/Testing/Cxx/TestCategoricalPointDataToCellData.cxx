@@ -59,11 +59,66 @@ void AddTriangle(const double* p0,
   }
   cells->InsertNextCell(t);
 }
+
+// A hexahedron whose points all have the same value followed by a triangle
+// whose points have distinct values: the majority bins of the hexahedron
+// must not be counted for the triangle, which takes the largest of its
+// values.
+bool TestMixedCellSizes()
+{
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  vtkSmartPointer<vtkPoints> points =
+    vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkDoubleArray> values =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  values->SetName("Values");
+  for (int i = 0; i < 8; i++)
+  {
+    points->InsertNextPoint(i % 2, (i / 2) % 2, i / 4);
+    values->InsertNextValue(7.);
+  }
+  for (int i = 0; i < 3; i++)
+  {
+    points->InsertNextPoint(2. + i % 2, i / 2, 0.);
+    values->InsertNextValue(i + 1.);
+  }
+  grid->SetPoints(points);
+  grid->GetPointData()->SetScalars(values);
+
+  grid->Allocate(2);
+  vtkIdType hexIds[8] = {0, 1, 3, 2, 4, 5, 7, 6};
+  vtkIdType triangleIds[3] = {8, 9, 10};
+  grid->InsertNextCell(VTK_HEXAHEDRON, 8, hexIds);
+  grid->InsertNextCell(VTK_TRIANGLE, 3, triangleIds);
+
+  vtkSmartPointer<vtkPointDataToCellData> pointDataToCellData =
+    vtkSmartPointer<vtkPointDataToCellData>::New();
+  pointDataToCellData->SetInputData(grid);
+  pointDataToCellData->SetCategoricalData(true);
+  pointDataToCellData->Update();
+
+  vtkDataArray* cellValues =
+    pointDataToCellData->GetOutput()->GetCellData()->GetScalars();
+  if (!cellValues || cellValues->GetNumberOfTuples() != 2 ||
+      cellValues->GetTuple1(0) != 7. || cellValues->GetTuple1(1) != 3.)
+  {
+    cerr << "Wrong categorical cell data with cells of different sizes"
+         << endl;
+    return false;
+  }
+  return true;
+}
 }
 
 int TestCategoricalPointDataToCellData(int vtkNotUsed(argc),
                                        char *vtkNotUsed(argv)[])
 {
+  if (!TestMixedCellSizes())
+  {
+    return EXIT_FAILURE;
+  }
+
   // Construct an unstructured grid of triangles, assign point data according to
   // the y-value of the point, convert the point data to cell data (treating the
   // data as categorical), and compare the results to an established truth
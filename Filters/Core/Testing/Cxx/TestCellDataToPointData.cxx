@@ -16,21 +16,239 @@
 #include <vtkCellDataToPointData.h>
 #include <vtkDataArray.h>
 #include <vtkCellData.h>
+#include <vtkCellType.h>
 #include <vtkDataSet.h>
 #include <vtkDataSetTriangleFilter.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkPointDataToCellData.h>
+#include <vtkPoints.h>
+#include <vtkRectilinearGrid.h>
 #include <vtkRTAnalyticSource.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkStructuredGrid.h>
+#include <vtkUniformGrid.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkUnstructuredGrid.h>
+#include <vtkVariant.h>
 #include <vtkThreshold.h>
 #include <vtkTestUtilities.h>
 
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
 #define vsp(type, name) \
         vtkSmartPointer<vtk##type> name = vtkSmartPointer<vtk##type>::New()
 
+namespace
+{
+// Add to dsa a double array of 3 components, integer scalars, an unsigned
+// char array and a string array of n tuples.
+void AddArrays(vtkDataSetAttributes* dsa, vtkIdType n)
+{
+  vtkNew<vtkDoubleArray> d;
+  d->SetName("d");
+  d->SetNumberOfComponents(3);
+  vtkNew<vtkIntArray> i;
+  i->SetName("i");
+  vtkNew<vtkUnsignedCharArray> u;
+  u->SetName("u");
+  vtkNew<vtkStringArray> s;
+  s->SetName("s");
+  for (vtkIdType k = 0; k < n; ++k)
+  {
+    d->InsertNextTuple3(sin(0.37 * k), cos(0.11 * k), 0.5 * k);
+    i->InsertNextValue(static_cast<int>(k % 11) - 5);
+    u->InsertNextValue(static_cast<unsigned char>((7 * k) % 256));
+    s->InsertNextValue(std::string(1, static_cast<char>('a' + k % 13)));
+  }
+  dsa->AddArray(d);
+  dsa->SetScalars(i);
+  dsa->AddArray(u);
+  dsa->AddArray(s);
+}
+
+// Whether two vtkDataSetAttributes have the same arrays, with the same
+// values.
+bool SameAttributes(const std::string& name, vtkDataSetAttributes* a,
+                    vtkDataSetAttributes* b)
+{
+  bool same = a->GetNumberOfArrays() == b->GetNumberOfArrays();
+  for (int i = 0; same && i < a->GetNumberOfArrays(); ++i)
+  {
+    vtkAbstractArray* aArray = a->GetAbstractArray(i);
+    vtkAbstractArray* bArray = b->GetAbstractArray(i);
+    same = aArray->GetDataType() == bArray->GetDataType() &&
+      aArray->GetNumberOfValues() == bArray->GetNumberOfValues() &&
+      std::string(aArray->GetName()) == bArray->GetName();
+    for (vtkIdType k = 0; same && k < aArray->GetNumberOfValues(); ++k)
+    {
+      same = aArray->GetVariantValue(k) == bArray->GetVariantValue(k);
+    }
+  }
+  if (!same)
+  {
+    cerr << "Sequential and parallel outputs differ for " << name << endl;
+  }
+  return same;
+}
+
+// Map the cell data of the structured datasets, with and without blanking,
+// and of an unstructured grid mixing cells of several dimensions with each
+// contributing cell option, and the point data back to the cells. Compare
+// the mapped arrays with the ones mapped by the Sequential backend.
+bool TestDatasets()
+{
+  std::vector<std::pair<std::string, vtkSmartPointer<vtkDataSet> > > datasets;
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 20, -3, 10, 2, 9);
+  datasets.push_back(std::make_pair("image", image.GetPointer()));
+
+  vtkNew<vtkRectilinearGrid> rgrid;
+  rgrid->SetDimensions(9, 8, 7);
+  vtkNew<vtkDoubleArray> xCoords;
+  vtkNew<vtkDoubleArray> yCoords;
+  vtkNew<vtkDoubleArray> zCoords;
+  for (int k = 0; k < 9; ++k)
+  {
+    xCoords->InsertNextValue(k * k);
+  }
+  for (int k = 0; k < 8; ++k)
+  {
+    yCoords->InsertNextValue(k);
+  }
+  for (int k = 0; k < 7; ++k)
+  {
+    zCoords->InsertNextValue(sqrt(k));
+  }
+  rgrid->SetXCoordinates(xCoords);
+  rgrid->SetYCoordinates(yCoords);
+  rgrid->SetZCoordinates(zCoords);
+  datasets.push_back(std::make_pair("rectilinear", rgrid.GetPointer()));
+
+  vtkNew<vtkStructuredGrid> sgrid;
+  sgrid->SetDimensions(10, 11, 5);
+  vtkNew<vtkPoints> sgridPoints;
+  for (int k = 0; k < 550; ++k)
+  {
+    sgridPoints->InsertNextPoint(k % 10, (k / 10) % 11, k / 110);
+  }
+  sgrid->SetPoints(sgridPoints);
+  datasets.push_back(std::make_pair("structured", sgrid.GetPointer()));
+
+  vtkNew<vtkUniformGrid> blankedImage;
+  blankedImage->SetDimensions(12, 13, 14);
+  blankedImage->AllocateCellGhostArray();
+  for (vtkIdType c = 0; c < blankedImage->GetNumberOfCells(); c += 3)
+  {
+    blankedImage->BlankCell(c);
+  }
+  for (vtkIdType c = 0; c < 12 * 12; ++c)
+  {
+    blankedImage->BlankCell(c);
+  }
+  datasets.push_back(std::make_pair("blanked image", blankedImage.GetPointer()));
+
+  vtkNew<vtkStructuredGrid> blankedSGrid;
+  blankedSGrid->DeepCopy(sgrid);
+  blankedSGrid->AllocateCellGhostArray();
+  for (vtkIdType c = 0; c < blankedSGrid->GetNumberOfCells(); c += 4)
+  {
+    blankedSGrid->BlankCell(c);
+  }
+  datasets.push_back(std::make_pair("blanked structured", blankedSGrid.GetPointer()));
+
+  vtkNew<vtkUnstructuredGrid> ugrid;
+  vtkNew<vtkPoints> ugridPoints;
+  for (int k = 0; k < 400; ++k)
+  {
+    ugridPoints->InsertNextPoint(sin(1.3 * k), cos(0.7 * k), 0.01 * k);
+  }
+  ugrid->SetPoints(ugridPoints);
+  ugrid->Allocate();
+  for (int c = 0; c < 600; ++c)
+  {
+    vtkIdType ids[4];
+    for (int k = 0; k < 4; ++k)
+    {
+      ids[k] = (c * 7 + k * 101 + (c * k) % 13) % 400;
+    }
+    switch (c % 5)
+    {
+      case 0:
+      case 1:
+        ugrid->InsertNextCell(VTK_TETRA, 4, ids);
+        break;
+      case 2:
+        ugrid->InsertNextCell(VTK_TRIANGLE, 3, ids);
+        break;
+      case 3:
+        ugrid->InsertNextCell(VTK_LINE, 2, ids);
+        break;
+      default:
+        ugrid->InsertNextCell(VTK_VERTEX, 1, ids);
+    }
+  }
+  datasets.push_back(std::make_pair("unstructured", ugrid.GetPointer()));
+
+  vtkSMPTools::Config sequential;
+  sequential.Backend = "Sequential";
+
+  bool success = true;
+  for (size_t d = 0; d < datasets.size(); ++d)
+  {
+    vtkDataSet* dataset = datasets[d].second;
+    AddArrays(dataset->GetCellData(), dataset->GetNumberOfCells());
+    AddArrays(dataset->GetPointData(), dataset->GetNumberOfPoints());
+    std::string name = datasets[d].first;
+
+    for (int opt = 0; opt < 3; ++opt)
+    {
+      vtkNew<vtkCellDataToPointData> c2p;
+      c2p->SetInputData(dataset);
+      c2p->SetContributingCellOption(opt);
+      vtkSMPTools::LocalScope(sequential, [&]() { c2p->Update(); });
+      vtkNew<vtkPointData> expected;
+      expected->DeepCopy(c2p->GetOutput()->GetPointData());
+      c2p->Modified();
+      c2p->Update();
+      success = SameAttributes(name + " c2p", expected,
+        c2p->GetOutput()->GetPointData()) && success;
+    }
+
+    for (int categorical = 0; categorical < 2; ++categorical)
+    {
+      vtkNew<vtkPointDataToCellData> p2c;
+      p2c->SetInputData(dataset);
+      p2c->SetCategoricalData(categorical);
+      vtkSMPTools::LocalScope(sequential, [&]() { p2c->Update(); });
+      vtkNew<vtkCellData> expected;
+      expected->DeepCopy(p2c->GetOutput()->GetCellData());
+      p2c->Modified();
+      p2c->Update();
+      success = SameAttributes(name + " p2c", expected,
+        p2c->GetOutput()->GetCellData()) && success;
+    }
+  }
+  return success;
+}
+} // anonymous namespace
+
 int TestCellDataToPointData (int, char*[])
 {
+  if (!TestDatasets())
+  {
+    return EXIT_FAILURE;
+  }
+
   char const name [] = "RTData";
   vsp(RTAnalyticSource, wavelet);
     wavelet->SetWholeExtent(-2, 2, -2, 2, -2, 2);
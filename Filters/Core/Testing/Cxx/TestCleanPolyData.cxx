@@ -14,10 +14,51 @@
 =========================================================================*/
 
 #include <vtkCellArray.h>
+#include <vtkCellData.h>
 #include <vtkCleanPolyData.h>
+#include <vtkFloatArray.h>
+#include <vtkIntArray.h>
 #include <vtkMinimalStandardRandomSequence.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPointLocator.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+// A subclass whose OperateOnPoint() snaps the points to a grid, and is not
+// thread safe: it counts its calls and records the threads it is called from.
+class vtkSnapCleanPolyData : public vtkCleanPolyData
+{
+public:
+  static vtkSnapCleanPolyData *New();
+  vtkTypeMacro(vtkSnapCleanPolyData, vtkCleanPolyData);
+
+  void OperateOnPoint(double in[3], double out[3]) override
+  {
+    ++this->NumberOfCalls;
+    if (std::this_thread::get_id() != this->Thread)
+    {
+      ++this->NumberOfOtherThreadCalls;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      out[i] = 0.2 * std::floor(in[i] / 0.2 + 0.5);
+    }
+  }
+
+  std::thread::id Thread;
+  vtkIdType NumberOfCalls = 0;
+  vtkIdType NumberOfOtherThreadCalls = 0;
+
+protected:
+  vtkSnapCleanPolyData() : Thread(std::this_thread::get_id()) {}
+};
+vtkStandardNewMacro(vtkSnapCleanPolyData);
+
 namespace
 {
 void InitializePolyData(vtkPolyData *polyData, int dataType)
@@ -83,6 +124,211 @@ int CleanPolyData(int dataType, int outputPointsPrecision)
 
   return points->GetDataType();
 }
+
+// A triangle soup of a grid (each triangle has its own points, as read from
+// a STL file) with degenerate triangles, plus verts, lines and strips, some
+// unused points, and point and cell data.
+vtkSmartPointer<vtkPolyData> CreateSoup(int res, int dataType)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataType(dataType);
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> strips = vtkSmartPointer<vtkCellArray>::New();
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < res; ++i)
+    {
+      double x[4][3] = { { 0.1 * i, 0.1 * j, 0.0 },
+                         { 0.1 * (i + 1), 0.1 * j, 0.0 },
+                         { 0.1 * (i + 1), 0.1 * (j + 1), 0.0 },
+                         { 0.1 * i, 0.1 * (j + 1), 0.0 } };
+      random->Next();
+      if (random->GetValue() < 0.05)
+      {
+        // Collapse an edge of the quad
+        x[1][0] = x[0][0];
+      }
+      for (int t = 0; t < 2; ++t)
+      {
+        int corners[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+        vtkIdType tri[3];
+        for (int c = 0; c < 3; ++c)
+        {
+          tri[c] = points->InsertNextPoint(x[corners[t][c]]);
+        }
+        polys->InsertNextCell(3, tri);
+      }
+      random->Next();
+      if (random->GetValue() < 0.05)
+      {
+        points->InsertNextPoint(x[2][0], x[2][1], 1.0); // unused
+        vtkIdType line[2] = { points->InsertNextPoint(x[0]),
+                              points->InsertNextPoint(x[1]) };
+        lines->InsertNextCell(2, line);
+        vtkIdType vert = points->InsertNextPoint(x[3]);
+        verts->InsertNextCell(1, &vert);
+        vtkIdType strip[4] = { points->InsertNextPoint(x[0]),
+                               points->InsertNextPoint(x[1]),
+                               points->InsertNextPoint(x[3]),
+                               points->InsertNextPoint(x[2]) };
+        strips->InsertNextCell(4, strip);
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> soup = vtkSmartPointer<vtkPolyData>::New();
+  soup->SetPoints(points);
+  soup->SetVerts(verts);
+  soup->SetLines(lines);
+  soup->SetPolys(polys);
+  soup->SetStrips(strips);
+
+  vtkSmartPointer<vtkFloatArray> pointData =
+    vtkSmartPointer<vtkFloatArray>::New();
+  pointData->SetName("PointIds");
+  pointData->SetNumberOfTuples(points->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+  {
+    pointData->SetValue(i, i);
+  }
+  soup->GetPointData()->AddArray(pointData);
+  vtkSmartPointer<vtkIntArray> cellData = vtkSmartPointer<vtkIntArray>::New();
+  cellData->SetName("CellIds");
+  cellData->SetNumberOfTuples(soup->GetNumberOfCells());
+  for (vtkIdType i = 0; i < soup->GetNumberOfCells(); ++i)
+  {
+    cellData->SetValue(i, i);
+  }
+  soup->GetCellData()->AddArray(cellData);
+  return soup;
+}
+
+bool SameCells(vtkCellArray *a, vtkCellArray *b)
+{
+  vtkIdType size = a->GetNumberOfConnectivityEntries();
+  return a->GetNumberOfCells() == b->GetNumberOfCells() &&
+    size == b->GetNumberOfConnectivityEntries() &&
+    (size == 0 ||
+     memcmp(a->GetPointer(), b->GetPointer(), size * sizeof(vtkIdType)) == 0);
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  if (!a || !b || a->GetNumberOfTuples() != b->GetNumberOfTuples() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a->GetNumberOfComponents(); ++c)
+    {
+      if (a->GetComponent(i, c) != b->GetComponent(i, c))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  return a->GetNumberOfPoints() == b->GetNumberOfPoints() &&
+    SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData()) &&
+    SameCells(a->GetVerts(), b->GetVerts()) &&
+    SameCells(a->GetLines(), b->GetLines()) &&
+    SameCells(a->GetPolys(), b->GetPolys()) &&
+    SameCells(a->GetStrips(), b->GetStrips()) &&
+    SameArrays(a->GetPointData()->GetArray("PointIds"),
+               b->GetPointData()->GetArray("PointIds")) &&
+    SameArrays(a->GetCellData()->GetArray("CellIds"),
+               b->GetCellData()->GetArray("CellIds"));
+}
+
+// Check that the parallel clean, used with the default locator, gives the
+// same output with the sequential backend and as the serial clean, used with
+// a vtkPointLocator when merging points.
+int CompareWithSerialClean(int dataType, int pointMerging)
+{
+  vtkSmartPointer<vtkPolyData> soup = CreateSoup(200, dataType);
+
+  vtkSmartPointer<vtkPolyData> outputs[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    vtkSmartPointer<vtkCleanPolyData> clean =
+      vtkSmartPointer<vtkCleanPolyData>::New();
+    clean->SetInputData(soup);
+    clean->SetPointMerging(pointMerging);
+    vtkSMPTools::Config config;
+    if (i == 0)
+    {
+      clean->SetLocator(vtkSmartPointer<vtkPointLocator>::New());
+    }
+    else if (i == 1)
+    {
+      config.Backend = "Sequential";
+    }
+    vtkSMPTools::LocalScope(config, [&]() { clean->Update(); });
+    outputs[i] = clean->GetOutput();
+  }
+
+  if (outputs[0]->GetNumberOfPoints() >= soup->GetNumberOfPoints() / 4 &&
+      pointMerging)
+  {
+    cerr << "Points were not merged" << endl;
+    return EXIT_FAILURE;
+  }
+  if (!SameOutputs(outputs[0], outputs[1]) ||
+      !SameOutputs(outputs[0], outputs[2]))
+  {
+    cerr << "Serial and parallel outputs differ (data type " << dataType
+         << ", point merging " << pointMerging << ")" << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// OperateOnPoint() is overridden without being thread safe: the parallel
+// clean must only call it from the calling thread, and still give the same
+// output as the serial clean.
+int CheckOperateOnPoint()
+{
+  vtkSmartPointer<vtkPolyData> soup = CreateSoup(200, VTK_DOUBLE);
+
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  for (int i = 0; i < 2; ++i)
+  {
+    vtkSmartPointer<vtkSnapCleanPolyData> clean =
+      vtkSmartPointer<vtkSnapCleanPolyData>::New();
+    clean->SetInputData(soup);
+    if (i == 0)
+    {
+      clean->SetLocator(vtkSmartPointer<vtkPointLocator>::New());
+    }
+    clean->Update();
+    outputs[i] = clean->GetOutput();
+    if (clean->NumberOfCalls == 0 || clean->NumberOfOtherThreadCalls != 0)
+    {
+      cerr << "OperateOnPoint called " << clean->NumberOfOtherThreadCalls
+           << " times from other threads" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (outputs[0]->GetNumberOfPoints() != 101 * 101 ||
+      !SameOutputs(outputs[0], outputs[1]))
+  {
+    cerr << "Serial and parallel outputs differ with OperateOnPoint" << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 }
 
 int TestCleanPolyData(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
@@ -129,5 +375,19 @@ int TestCleanPolyData(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
     return EXIT_FAILURE;
   }
 
+  for (int merging = 0; merging < 2; ++merging)
+  {
+    if (CompareWithSerialClean(VTK_FLOAT, merging) != EXIT_SUCCESS ||
+        CompareWithSerialClean(VTK_DOUBLE, merging) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (CheckOperateOnPoint() != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
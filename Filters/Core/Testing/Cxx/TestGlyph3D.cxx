@@ -15,22 +15,33 @@
 
 #include "vtkActor.h"
 #include "vtkCamera.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
 #include "vtkCommand.h"
 #include "vtkConeSource.h"
 #include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
 #include "vtkGlyph3D.h"
+#include "vtkIdList.h"
 #include "vtkNew.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
 #include "vtkPolyDataMapper.h"
 #include "vtkRegressionTestImage.h"
 #include "vtkRenderWindow.h"
 #include "vtkRenderWindowInteractor.h"
 #include "vtkRenderer.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStringArray.h"
 #include "vtkTestErrorObserver.h"
 #include "vtkTestUtilities.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
 static bool TestGlyph3D_WithBadArray()
 {
   vtkSmartPointer<vtkDoubleArray> vectors =
@@ -86,6 +97,292 @@ static bool TestGlyph3D_WithoutSource()
   return true;
 }
 
+static bool TestGlyph3D_CellArrayStorage()
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  for (int i = 0; i < 100; ++i)
+  {
+    points->InsertNextPoint(i, i % 7, i % 3);
+    scalars->InsertNextValue(0.01 * i);
+  }
+  vtkNew<vtkPolyData> polydata;
+  polydata->SetPoints(points);
+  polydata->GetPointData()->SetScalars(scalars);
+
+  vtkNew<vtkConeSource> glyphSource;
+
+  // The same glyphs must be produced whatever the storage of the cells
+  vtkNew<vtkGlyph3D> legacyGlyph3D;
+  legacyGlyph3D->SetSourceConnection(glyphSource->GetOutputPort());
+  legacyGlyph3D->SetInputData(polydata);
+  legacyGlyph3D->FillCellDataOn();
+  legacyGlyph3D->Update();
+  vtkPolyData* legacy = legacyGlyph3D->GetOutput();
+
+  vtkNew<vtkGlyph3D> offsetsGlyph3D;
+  offsetsGlyph3D->SetSourceConnection(glyphSource->GetOutputPort());
+  offsetsGlyph3D->SetInputData(polydata);
+  offsetsGlyph3D->FillCellDataOn();
+  offsetsGlyph3D->SetOutputCellArrayStorage(vtkCellArray::OFFSETS_32BIT_STORAGE);
+  offsetsGlyph3D->Update();
+  vtkPolyData* offsets = offsetsGlyph3D->GetOutput();
+
+  vtkIdType numPts = glyphSource->GetOutput()->GetNumberOfPoints();
+  vtkIdType numCells = glyphSource->GetOutput()->GetNumberOfCells();
+  if (legacy->GetNumberOfPoints() != 100 * numPts ||
+      legacy->GetNumberOfCells() != 100 * numCells ||
+      offsets->GetNumberOfPoints() != legacy->GetNumberOfPoints() ||
+      offsets->GetNumberOfCells() != legacy->GetNumberOfCells())
+  {
+    cerr << "Unexpected number of glyph points or cells" << endl;
+    return false;
+  }
+  if (offsets->GetPolys()->GetStorageType() != vtkCellArray::OFFSETS_32BIT_STORAGE)
+  {
+    cerr << "Unexpected cell array storage" << endl;
+    return false;
+  }
+
+  vtkNew<vtkIdList> legacyIds;
+  vtkNew<vtkIdList> offsetsIds;
+  for (vtkIdType cellId = 0; cellId < legacy->GetNumberOfCells(); ++cellId)
+  {
+    legacy->GetCellPoints(cellId, legacyIds);
+    offsets->GetCellPoints(cellId, offsetsIds);
+    if (legacyIds->GetNumberOfIds() != offsetsIds->GetNumberOfIds())
+    {
+      cerr << "Different cells " << cellId << endl;
+      return false;
+    }
+    for (vtkIdType i = 0; i < legacyIds->GetNumberOfIds(); ++i)
+    {
+      if (legacyIds->GetId(i) != offsetsIds->GetId(i) ||
+          legacyIds->GetId(i) / numPts != cellId / numCells)
+      {
+        cerr << "Different cells " << cellId << endl;
+        return false;
+      }
+    }
+    double legacyScalar =
+      legacy->GetCellData()->GetArray("Scalars")->GetComponent(cellId, 0);
+    if (legacyScalar != 0.01 * (cellId / numCells) ||
+        offsets->GetCellData()->GetArray("Scalars")->GetComponent(cellId, 0) != legacyScalar)
+    {
+      cerr << "Wrong cell data for cell " << cellId << endl;
+      return false;
+    }
+  }
+
+  for (vtkIdType ptId = 0; ptId < legacy->GetNumberOfPoints(); ++ptId)
+  {
+    double p[3], q[3];
+    legacy->GetPoint(ptId, p);
+    offsets->GetPoint(ptId, q);
+    if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2])
+    {
+      cerr << "Different points " << ptId << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Whether two glyph outputs have the same points, point scalars, cell data
+// and cells, in cell id order.
+static bool SameGlyphs(vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells())
+  {
+    cerr << "Different numbers of points or cells" << endl;
+    return false;
+  }
+  vtkDataArray* aScalars = a->GetPointData()->GetScalars();
+  vtkDataArray* bScalars = b->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+  {
+    double p[3], q[3];
+    a->GetPoint(i, p);
+    b->GetPoint(i, q);
+    if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2] ||
+        (aScalars && aScalars->GetComponent(i, 0) != bScalars->GetComponent(i, 0)))
+    {
+      cerr << "Different points " << i << endl;
+      return false;
+    }
+  }
+  vtkNew<vtkIdList> aIds;
+  vtkNew<vtkIdList> bIds;
+  vtkDataArray* aCellScalars = a->GetCellData()->GetArray("Scalars");
+  vtkDataArray* bCellScalars = b->GetCellData()->GetArray("Scalars");
+  vtkStringArray* aNames = vtkArrayDownCast<vtkStringArray>(
+    a->GetCellData()->GetAbstractArray("Names"));
+  vtkStringArray* bNames = vtkArrayDownCast<vtkStringArray>(
+    b->GetCellData()->GetAbstractArray("Names"));
+  if (!aCellScalars != !bCellScalars || !aNames != !bNames)
+  {
+    cerr << "Different cell arrays" << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfCells(); ++i)
+  {
+    a->GetCellPoints(i, aIds);
+    b->GetCellPoints(i, bIds);
+    bool same = a->GetCellType(i) == b->GetCellType(i) &&
+      aIds->GetNumberOfIds() == bIds->GetNumberOfIds();
+    for (vtkIdType j = 0; same && j < aIds->GetNumberOfIds(); ++j)
+    {
+      same = aIds->GetId(j) == bIds->GetId(j);
+    }
+    if (!same ||
+        (aCellScalars &&
+         aCellScalars->GetComponent(i, 0) != bCellScalars->GetComponent(i, 0)) ||
+        (aNames && aNames->GetValue(i) != bNames->GetValue(i)))
+    {
+      cerr << "Different cells " << i << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compare the glyphs of single kind and mixed kind sources, and of a table
+// of sources of different kinds, with the ones generated by the Sequential
+// backend.
+static bool TestGlyph3D_Backends()
+{
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkDoubleArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkStringArray> names;
+  names->SetName("Names");
+  for (int i = 0; i < 500; ++i)
+  {
+    points->InsertNextPoint(0.1 * i, sin(0.3 * i), cos(0.2 * i));
+    scalars->InsertNextValue(0.5 + 0.5 * sin(0.7 * i));
+    vectors->InsertNextTuple3(cos(0.1 * i), sin(0.2 * i), i % 3 - 1.0);
+    names->InsertNextValue(std::to_string(i));
+  }
+  vtkNew<vtkPolyData> polydata;
+  polydata->SetPoints(points);
+  polydata->GetPointData()->SetScalars(scalars);
+  polydata->GetPointData()->SetVectors(vectors);
+  polydata->GetPointData()->AddArray(names);
+
+  // A source whose cells of several kinds are interleaved
+  vtkNew<vtkPolyData> mixedSource;
+  vtkNew<vtkPoints> mixedPoints;
+  for (int i = 0; i < 8; ++i)
+  {
+    mixedPoints->InsertNextPoint(i % 2, (i / 2) % 2, i / 4);
+  }
+  mixedSource->SetPoints(mixedPoints);
+  mixedSource->Allocate();
+  vtkIdType tri[3] = { 0, 1, 2 };
+  vtkIdType line[2] = { 3, 7 };
+  vtkIdType quad[4] = { 4, 5, 7, 6 };
+  vtkIdType vert[1] = { 5 };
+  vtkIdType strip[5] = { 0, 4, 1, 5, 3 };
+  vtkIdType polyLine[3] = { 2, 6, 7 };
+  mixedSource->InsertNextCell(VTK_TRIANGLE, 3, tri);
+  mixedSource->InsertNextCell(VTK_LINE, 2, line);
+  mixedSource->InsertNextCell(VTK_QUAD, 4, quad);
+  mixedSource->InsertNextCell(VTK_VERTEX, 1, vert);
+  mixedSource->InsertNextCell(VTK_TRIANGLE_STRIP, 5, strip);
+  mixedSource->InsertNextCell(VTK_POLY_LINE, 3, polyLine);
+
+  // A source of lines only
+  vtkNew<vtkPolyData> lineSource;
+  lineSource->SetPoints(mixedPoints);
+  lineSource->Allocate();
+  lineSource->InsertNextCell(VTK_LINE, 2, line);
+  lineSource->InsertNextCell(VTK_POLY_LINE, 3, polyLine);
+
+  vtkNew<vtkConeSource> cone;
+  cone->SetResolution(5);
+  cone->Update();
+
+  // The outputs are kept rather than deep copied: a deep copy would renumber
+  // the cells of mixed kinds.
+  bool success = true;
+  for (int mode = 0; mode < 3; ++mode)
+  {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int parallel = 0; parallel < 2; ++parallel)
+    {
+      vtkNew<vtkGlyph3D> glyph3D;
+      glyph3D->SetInputData(polydata);
+      glyph3D->FillCellDataOn();
+      glyph3D->SetScaleModeToScaleByVector();
+      glyph3D->SetColorModeToColorByScalar();
+      if (mode == 0)
+      {
+        glyph3D->SetSourceData(cone->GetOutput());
+      }
+      else if (mode == 1)
+      {
+        glyph3D->SetSourceData(mixedSource);
+      }
+      else
+      {
+        glyph3D->SetSourceData(0, cone->GetOutput());
+        glyph3D->SetSourceData(1, lineSource);
+        glyph3D->SetSourceData(2, mixedSource);
+        glyph3D->SetIndexModeToScalar();
+        glyph3D->SetRange(0.0, 1.0);
+      }
+      vtkSMPTools::Config config;
+      if (!parallel)
+      {
+        config.Backend = "Sequential";
+      }
+      vtkSMPTools::LocalScope(config, [&]() { glyph3D->Update(); });
+      outputs[parallel] = glyph3D->GetOutput();
+    }
+    if (outputs[0]->GetNumberOfCells() == 0 ||
+        !SameGlyphs(outputs[0], outputs[1]))
+    {
+      cerr << "Sequential and parallel glyphs differ for mode " << mode
+           << endl;
+      success = false;
+    }
+  }
+
+  // The cells of each glyph of the mixed source are consecutive, in the
+  // order of the source cells, and use the points of that glyph only.
+  vtkNew<vtkGlyph3D> mixedGlyph3D;
+  mixedGlyph3D->SetInputData(polydata);
+  mixedGlyph3D->SetSourceData(mixedSource);
+  mixedGlyph3D->Update();
+  vtkPolyData* output = mixedGlyph3D->GetOutput();
+  vtkIdType numCells = mixedSource->GetNumberOfCells();
+  vtkIdType numPts = mixedSource->GetNumberOfPoints();
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+  {
+    bool same = output->GetCellType(cellId) ==
+      mixedSource->GetCellType(cellId % numCells);
+    output->GetCellPoints(cellId, ptIds);
+    for (vtkIdType i = 0; same && i < ptIds->GetNumberOfIds(); ++i)
+    {
+      same = ptIds->GetId(i) / numPts == cellId / numCells;
+    }
+    if (!same)
+    {
+      cerr << "Misplaced glyph cell " << cellId << endl;
+      success = false;
+      break;
+    }
+  }
+  return success;
+}
+
 int TestGlyph3D(int argc, char* argv[])
 {
   if(!TestGlyph3D_WithBadArray())
@@ -98,6 +395,16 @@ int TestGlyph3D(int argc, char* argv[])
     return EXIT_FAILURE;
   }
 
+  if (!TestGlyph3D_CellArrayStorage())
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!TestGlyph3D_Backends())
+  {
+    return EXIT_FAILURE;
+  }
+
   vtkSmartPointer<vtkDoubleArray> vectors =
     vtkSmartPointer<vtkDoubleArray>::New();
   vectors->SetName("Normals");
@@ -0,0 +1,240 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataNormals.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkPolyDataNormals gives the same output with the sequential
+// and the parallel SMP backends, and the same output as the serial filter
+// it replaced, through digests of the outputs of the latter.
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// A folded grid of triangles (with a sharp ridge along its middle) whose
+// cells are randomly reordered, plus a few quads sharing an edge with three
+// other quads to have non-manifold edges.
+vtkSmartPointer<vtkPolyData> CreateMesh(int res)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int j = 0; j <= res; ++j)
+  {
+    for (int i = 0; i <= res; ++i)
+    {
+      points->InsertNextPoint(i, j, 0.5 * abs(2 * i - res));
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < res; ++i)
+    {
+      vtkIdType p0 = j * (res + 1) + i;
+      vtkIdType tris[2][3] = { { p0, p0 + 1, p0 + res + 2 },
+                               { p0, p0 + res + 2, p0 + res + 1 } };
+      for (int t = 0; t < 2; ++t)
+      {
+        random->Next();
+        if (random->GetValue() < 0.5)
+        {
+          std::swap(tris[t][0], tris[t][2]);
+        }
+        polys->InsertNextCell(3, tris[t]);
+      }
+    }
+  }
+
+  // Three quads hanging from the first edge of the grid
+  for (int q = 0; q < 3; ++q)
+  {
+    vtkIdType p = points->InsertNextPoint(0, -1, q - 1.0);
+    vtkIdType quad[4] = { 0, 1, p + 1, p };
+    points->InsertNextPoint(1, -1, q - 1.0);
+    polys->InsertNextCell(4, quad);
+  }
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(points);
+  mesh->SetPolys(polys);
+  return mesh;
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  if (!a || !b)
+  {
+    return a == b;
+  }
+  vtkFloatArray *fa = vtkArrayDownCast<vtkFloatArray>(a);
+  vtkFloatArray *fb = vtkArrayDownCast<vtkFloatArray>(b);
+  return fa && fb && fa->GetNumberOfValues() == fb->GetNumberOfValues() &&
+    memcmp(fa->GetPointer(0), fb->GetPointer(0),
+           fa->GetNumberOfValues() * sizeof(float)) == 0;
+}
+
+// Digest of an output: its number of points, a hash of its polygons and
+// weighted sums of its point and cell normals.
+struct Digest
+{
+  vtkIdType NumberOfPoints;
+  vtkTypeUInt64 Polys;
+  double PointNormals;
+  double CellNormals;
+};
+
+double SumNormals(vtkDataArray *normals)
+{
+  double sum = 0.0;
+  for (vtkIdType i = 0; normals && i < normals->GetNumberOfTuples(); ++i)
+  {
+    double *n = normals->GetTuple3(i);
+    sum += (1 + i % 7) * (n[0] + 2.0 * n[1] + 3.0 * n[2]);
+  }
+  return sum;
+}
+
+Digest ComputeDigest(vtkPolyData *output)
+{
+  Digest digest;
+  digest.NumberOfPoints = output->GetNumberOfPoints();
+  vtkCellArray *polys = output->GetPolys();
+  const vtkIdType *conn = polys->GetPointer();
+  digest.Polys = 0;
+  for (vtkIdType i = 0; i < polys->GetNumberOfConnectivityEntries(); ++i)
+  {
+    digest.Polys = 31 * digest.Polys + static_cast<vtkTypeUInt64>(conn[i]);
+  }
+  digest.PointNormals = SumNormals(output->GetPointData()->GetNormals());
+  digest.CellNormals = SumNormals(output->GetCellData()->GetNormals());
+  return digest;
+}
+
+bool Near(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-6 * (1.0 + std::fabs(b));
+}
+
+bool SameDigests(const Digest &a, const Digest &b)
+{
+  return a.NumberOfPoints == b.NumberOfPoints && a.Polys == b.Polys &&
+    Near(a.PointNormals, b.PointNormals) &&
+    Near(a.CellNormals, b.CellNormals);
+}
+
+bool SameOutputs(vtkPolyData *a, vtkPolyData *b)
+{
+  vtkCellArray *polysA = a->GetPolys();
+  vtkCellArray *polysB = b->GetPolys();
+  vtkIdType size = polysA->GetNumberOfConnectivityEntries();
+  return a->GetNumberOfPoints() == b->GetNumberOfPoints() &&
+    size == polysB->GetNumberOfConnectivityEntries() &&
+    memcmp(polysA->GetPointer(), polysB->GetPointer(),
+           size * sizeof(vtkIdType)) == 0 &&
+    SameArrays(a->GetPointData()->GetNormals(),
+               b->GetPointData()->GetNormals()) &&
+    SameArrays(a->GetCellData()->GetNormals(),
+               b->GetCellData()->GetNormals());
+}
+}
+
+int TestPolyDataNormals(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> mesh = CreateMesh(600);
+
+  // Splitting, Consistency, AutoOrientNormals, FlipNormals,
+  // NonManifoldTraversal
+  const int modes[][5] = {
+    { 0, 0, 0, 0, 1 },
+    { 0, 1, 0, 0, 1 },
+    { 1, 1, 0, 0, 1 },
+    { 1, 1, 0, 1, 0 },
+    { 1, 0, 0, 1, 1 },
+    { 0, 1, 1, 0, 1 },
+  };
+
+  // Digests of the outputs of the serial filter for each mode
+  const Digest expected[] = {
+    { 361207, 2526111160545984388ull, 6065.0234449274221, 4930.8724524595309 },
+    { 361207, 17546616084268000196ull, -3066936.9061494954,
+      -6109378.933418788 },
+    { 361814, 1567706325483481694ull, -3069889.469005933,
+      -6109378.933418788 },
+    { 361814, 33524204128412570ull, 3069889.469005933, 6109378.933418788 },
+    { 1092068, 3763627078946449166ull, -10189.296770444605,
+      4930.8724524595309 },
+    { 361207, 17546616084268000196ull, -3066936.9061494954,
+      -6109378.933418788 },
+  };
+
+  int status = EXIT_SUCCESS;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+  {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int parallel = 0; parallel < 2; ++parallel)
+    {
+      vtkSmartPointer<vtkPolyDataNormals> normals =
+        vtkSmartPointer<vtkPolyDataNormals>::New();
+      normals->SetInputData(mesh);
+      normals->SetSplitting(modes[m][0]);
+      normals->SetConsistency(modes[m][1]);
+      normals->SetAutoOrientNormals(modes[m][2]);
+      normals->SetFlipNormals(modes[m][3]);
+      normals->SetNonManifoldTraversal(modes[m][4]);
+      normals->ComputeCellNormalsOn();
+
+      vtkSMPTools::Config config;
+      if (!parallel)
+      {
+        config.Backend = "Sequential";
+      }
+      vtkSMPTools::LocalScope(config, [&]() { normals->Update(); });
+      outputs[parallel] = normals->GetOutput();
+    }
+
+    if (!SameOutputs(outputs[0], outputs[1]))
+    {
+      cerr << "Sequential and parallel outputs differ for mode " << m << endl;
+      status = EXIT_FAILURE;
+    }
+    Digest digest = ComputeDigest(outputs[1]);
+    if (!SameDigests(digest, expected[m]))
+    {
+      cerr.precision(17);
+      cerr << "Unexpected output for mode " << m << ": { "
+           << digest.NumberOfPoints << ", " << digest.Polys << "ull, "
+           << digest.PointNormals << ", " << digest.CellNormals << " }"
+           << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  return status;
+}
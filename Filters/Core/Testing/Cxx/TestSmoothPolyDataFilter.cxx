@@ -15,9 +15,17 @@
 
 #include <vtkCellArray.h>
 #include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
 #include <vtkSmoothPolyDataFilter.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
 namespace
 {
 void InitializePolyData(vtkPolyData *polyData, int dataType)
@@ -83,6 +91,109 @@ int SmoothPolyData(int dataType, int outputPointsPrecision)
 
   return points->GetDataType();
 }
+
+// A jittered grid of quads with a hole, a line and a vertex, whose points
+// are randomly renumbered so that the parallel sweeps have large
+// wavefronts.
+vtkSmartPointer<vtkPolyData> CreateMesh(int res)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  const vtkIdType numPts = (res + 1) * (res + 1);
+  std::vector<vtkIdType> ids(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    ids[i] = i;
+  }
+  for (vtkIdType i = numPts - 1; i > 0; --i)
+  {
+    random->Next();
+    std::swap(ids[i], ids[static_cast<vtkIdType>(random->GetValue() * i)]);
+  }
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numPts);
+  for (int j = 0; j <= res; ++j)
+  {
+    for (int i = 0; i <= res; ++i)
+    {
+      random->Next();
+      points->SetPoint(ids[j * (res + 1) + i], i, j, random->GetValue());
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < res; ++i)
+    {
+      if (abs(2 * i - res) < res / 4 && abs(2 * j - res) < res / 4)
+      {
+        continue;
+      }
+      vtkIdType p0 = j * (res + 1) + i;
+      vtkIdType quad[4] = { ids[p0], ids[p0 + 1], ids[p0 + res + 2],
+                            ids[p0 + res + 1] };
+      polys->InsertNextCell(4, quad);
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->InsertNextCell(res + 1);
+  for (int i = 0; i <= res; ++i)
+  {
+    lines->InsertCellPoint(ids[(res / 8) * (res + 1) + i]);
+  }
+  vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
+  verts->InsertNextCell(1, &ids[(res / 8) * (res + 2)]);
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(points);
+  mesh->SetVerts(verts);
+  mesh->SetLines(lines);
+  mesh->SetPolys(polys);
+  return mesh;
+}
+
+// Check that the sequential and the parallel SMP backends give the same
+// output.
+int CompareBackends()
+{
+  vtkSmartPointer<vtkPolyData> mesh = CreateMesh(300);
+
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    vtkSmartPointer<vtkSmoothPolyDataFilter> smoothPolyDataFilter
+      = vtkSmartPointer<vtkSmoothPolyDataFilter>::New();
+    smoothPolyDataFilter->SetInputData(mesh);
+    smoothPolyDataFilter->SetNumberOfIterations(10);
+    smoothPolyDataFilter->SetRelaxationFactor(0.5);
+    smoothPolyDataFilter->FeatureEdgeSmoothingOn();
+
+    vtkSMPTools::Config config;
+    if (!parallel)
+    {
+      config.Backend = "Sequential";
+    }
+    vtkSMPTools::LocalScope(config, [&]() { smoothPolyDataFilter->Update(); });
+    outputs[parallel] = smoothPolyDataFilter->GetOutput();
+  }
+
+  vtkPoints *points[2] = { outputs[0]->GetPoints(), outputs[1]->GetPoints() };
+  if (points[0]->GetNumberOfPoints() != points[1]->GetNumberOfPoints() ||
+      points[0]->GetDataType() != VTK_FLOAT ||
+      points[1]->GetDataType() != VTK_FLOAT ||
+      memcmp(points[0]->GetVoidPointer(0), points[1]->GetVoidPointer(0),
+             3 * points[0]->GetNumberOfPoints() * sizeof(float)) != 0)
+  {
+    cerr << "Sequential and parallel outputs differ" << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
 }
 
 int TestSmoothPolyDataFilter(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
@@ -129,5 +240,5 @@ int TestSmoothPolyDataFilter(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
     return EXIT_FAILURE;
   }
 
-  return EXIT_SUCCESS;
+  return CompareBackends();
 }
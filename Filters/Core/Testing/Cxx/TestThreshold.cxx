@@ -21,6 +21,41 @@
 #include "vtkImageData.h"
 #include "vtkPointData.h"
 #include "vtkFloatArray.h"
+#include "vtkCellArray.h"
+#include "vtkSMPTools.h"
+
+#include <cstring>
+
+namespace
+{
+bool SameGrids(vtkUnstructuredGrid *a, vtkUnstructuredGrid *b)
+{
+  vtkIdType size = a->GetCells()->GetNumberOfConnectivityEntries();
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      size != b->GetCells()->GetNumberOfConnectivityEntries() ||
+      memcmp(a->GetCells()->GetPointer(), b->GetCells()->GetPointer(),
+             size * sizeof(vtkIdType)) != 0)
+  {
+    return false;
+  }
+  vtkDataArray *sa = a->GetPointData()->GetScalars();
+  vtkDataArray *sb = b->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+  {
+    double pa[3], pb[3];
+    a->GetPoint(i, pa);
+    b->GetPoint(i, pb);
+    if (pa[0] != pb[0] || pa[1] != pb[1] || pa[2] != pb[2] ||
+        sa->GetTuple1(i) != sb->GetTuple1(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
 int TestThreshold(int, char *[])
 {
   //---------------------------------------------------
@@ -64,5 +99,27 @@ int TestThreshold(int, char *[])
     return EXIT_FAILURE;
   }
 
+  //---------------------------------------------------
+  // The output does not depend on the SMP backend
+  //---------------------------------------------------
+  filter->UseContinuousCellRangeOff();
+  filter->ThresholdBetween(L,U);
+  vtkSMPTools::Config config;
+  config.Backend = "Sequential";
+  for (int allScalars = 0; allScalars < 2; ++allScalars)
+  {
+    filter->SetAllScalars(allScalars);
+    vtkNew<vtkUnstructuredGrid> sequential;
+    vtkSMPTools::LocalScope(config, [&]() { filter->Update(); });
+    sequential->DeepCopy(filter->GetOutput());
+    filter->Modified();
+    filter->Update();
+    if(sequential->GetNumberOfCells()==0 ||
+       !SameGrids(sequential, filter->GetOutput()))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
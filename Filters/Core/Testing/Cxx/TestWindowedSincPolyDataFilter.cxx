@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestWindowedSincPolyDataFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkWindowedSincPolyDataFilter gives the same output with the
+// sequential and the parallel SMP backends.
+
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// A jittered grid of triangles with a hole, a line, a vertex and three
+// quads sharing an edge of the grid to have non-manifold edges.
+vtkSmartPointer<vtkPolyData> CreateMesh(int res)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int j = 0; j <= res; ++j)
+  {
+    for (int i = 0; i <= res; ++i)
+    {
+      random->Next();
+      points->InsertNextPoint(i, j, random->GetValue());
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < res; ++i)
+    {
+      if (abs(2 * i - res) < res / 4 && abs(2 * j - res) < res / 4)
+      {
+        continue;
+      }
+      vtkIdType p0 = j * (res + 1) + i;
+      vtkIdType tris[2][3] = { { p0, p0 + 1, p0 + res + 2 },
+                               { p0, p0 + res + 2, p0 + res + 1 } };
+      polys->InsertNextCell(3, tris[0]);
+      polys->InsertNextCell(3, tris[1]);
+    }
+  }
+
+  // Three quads hanging from the first edge of the grid
+  for (int q = 0; q < 3; ++q)
+  {
+    vtkIdType p = points->InsertNextPoint(0, -1, q - 1.0);
+    vtkIdType quad[4] = { 0, 1, p + 1, p };
+    points->InsertNextPoint(1, -1, q - 1.0);
+    polys->InsertNextCell(4, quad);
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->InsertNextCell(res + 1);
+  for (int i = 0; i <= res; ++i)
+  {
+    lines->InsertCellPoint((res / 8) * (res + 1) + i);
+  }
+  vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType vert = (res / 8) * (res + 2);
+  verts->InsertNextCell(1, &vert);
+
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(points);
+  mesh->SetVerts(verts);
+  mesh->SetLines(lines);
+  mesh->SetPolys(polys);
+  return mesh;
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  vtkFloatArray *fa = vtkArrayDownCast<vtkFloatArray>(a);
+  vtkFloatArray *fb = vtkArrayDownCast<vtkFloatArray>(b);
+  return fa && fb && fa->GetNumberOfValues() == fb->GetNumberOfValues() &&
+    memcmp(fa->GetPointer(0), fb->GetPointer(0),
+           fa->GetNumberOfValues() * sizeof(float)) == 0;
+}
+}
+
+int TestWindowedSincPolyDataFilter(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> mesh = CreateMesh(300);
+
+  // FeatureEdgeSmoothing, BoundarySmoothing, NonManifoldSmoothing,
+  // NormalizeCoordinates
+  const int modes[][4] = {
+    { 0, 1, 0, 0 },
+    { 1, 1, 0, 1 },
+    { 1, 0, 1, 0 },
+  };
+
+  int status = EXIT_SUCCESS;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m)
+  {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int parallel = 0; parallel < 2; ++parallel)
+    {
+      vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoother =
+        vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+      smoother->SetInputData(mesh);
+      smoother->SetFeatureEdgeSmoothing(modes[m][0]);
+      smoother->SetBoundarySmoothing(modes[m][1]);
+      smoother->SetNonManifoldSmoothing(modes[m][2]);
+      smoother->SetNormalizeCoordinates(modes[m][3]);
+      smoother->SetFeatureAngle(30.0);
+      smoother->GenerateErrorScalarsOn();
+
+      vtkSMPTools::Config config;
+      if (!parallel)
+      {
+        config.Backend = "Sequential";
+      }
+      vtkSMPTools::LocalScope(config, [&]() { smoother->Update(); });
+      outputs[parallel] = smoother->GetOutput();
+    }
+
+    if (!SameArrays(outputs[0]->GetPoints()->GetData(),
+                    outputs[1]->GetPoints()->GetData()) ||
+        !SameArrays(outputs[0]->GetPointData()->GetScalars(),
+                    outputs[1]->GetPointData()->GetScalars()))
+    {
+      cerr << "Sequential and parallel outputs differ for mode " << m << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  return status;
+}
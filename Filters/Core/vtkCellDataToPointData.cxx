@@ -14,22 +14,31 @@
   =========================================================================*/
 #include "vtkCellDataToPointData.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
-#include "vtkCell.h"
+#include "vtkCellTypes.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinksTemplate.h"
+#include "vtkStructuredData.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUniformGrid.h"
-#include "vtkUnsignedIntArray.h"
 
 #include <algorithm>
-#include <functional>
+#include <vector>
 
 #define VTK_MAX_CELLS_PER_POINT 4096
 
@@ -38,145 +47,299 @@ vtkStandardNewMacro(vtkCellDataToPointData);
 namespace
 {
 //----------------------------------------------------------------------------
-// Helper template function that implement the major part of the algorighm
-// which will be expanded by the vtkTemplateMacro. The template function is
-// provided so that coverage test can cover this function.
-  template <typename T>
-  void __spread (vtkDataSet* const src, vtkUnsignedIntArray* const num,
-                 vtkDataArray* const srcarray, vtkDataArray* const dstarray,
-                 vtkIdType ncells, vtkIdType npoints, vtkIdType ncomps,
-                 int highestCellDimension, int contributingCellOption)
+// Worker, dispatched on the types of the cell and point arrays, that
+// gathers for every point the values of the cells using it (given by static
+// cell links) and averages them. The sums are computed in the value type of
+// the arrays. With Patch only the cells of the highest dimension around the
+// point contribute, otherwise only the cells of dimension
+// HighestCellDimension or more. The points from BeginPoint to EndPoint are
+// processed.
+template <typename TIds>
+struct SpreadWorker
+{
+  vtkStaticCellLinksTemplate<TIds>* Links;
+  const unsigned char* CellDimensions; // nullptr when all the cells contribute
+  vtkIdType BeginPoint;
+  vtkIdType EndPoint;
+  int HighestCellDimension;
+  int ContributingCellOption;
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT* srcarray, DstArrayT* dstarray)
   {
-    T const* const srcptr = static_cast<T const*>(srcarray->GetVoidPointer(0));
-    T      * const dstptr = static_cast<T      *>(dstarray->GetVoidPointer(0));
-
-    // zero initialization
-    std::fill_n(dstptr, npoints*ncomps, T(0));
-
-    // accumulate
-    if (contributingCellOption != vtkCellDataToPointData::Patch)
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType T;
+    vtkDataArrayAccessor<SrcArrayT> src(srcarray);
+    vtkDataArrayAccessor<DstArrayT> dst(dstarray);
+    const int ncomps = srcarray->GetNumberOfComponents();
+    const bool patch =
+      this->ContributingCellOption == vtkCellDataToPointData::Patch;
+
+    vtkSMPTools::For(this->BeginPoint, this->EndPoint,
+      [&](vtkIdType pid, vtkIdType endPid)
     {
-      T const* srcbeg = srcptr;
-      for (vtkIdType cid = 0; cid < ncells; ++cid, srcbeg += ncomps)
+      std::vector<T> data(4*ncomps);
+      for (; pid < endPid; ++pid)
       {
-        vtkCell* cell = src->GetCell(cid);
-        if (cell->GetCellDimension() >= highestCellDimension)
+        std::fill(data.begin(), data.end(), T(0));
+        T numPointCells[4] = {0, 0, 0, 0};
+        vtkIdType const numCells = this->Links->GetNumberOfCells(pid);
+        const TIds* cells = this->Links->GetCells(pid);
+        for (vtkIdType i = 0; i < numCells; ++i)
         {
-          vtkIdList* pids = cell->GetPointIds();
-          for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
+          vtkIdType const cellId = cells[i];
+          int const cellDimension =
+            this->CellDimensions ? this->CellDimensions[cellId] : 0;
+          if (!patch && cellDimension < this->HighestCellDimension)
+          {
+            continue;
+          }
+          int const bin = patch ? cellDimension : 0;
+          numPointCells[bin] += 1;
+          for (int comp = 0; comp < ncomps; comp++)
           {
-            T* const dstbeg = dstptr + pids->GetId(i)*ncomps;
-            // accumulate cell data to point data <==> point_data += cell_data
-            std::transform(srcbeg,srcbeg+ncomps,dstbeg,dstbeg,std::plus<T>());
+            data[comp+ncomps*bin] += static_cast<T>(src.Get(cellId, comp));
           }
         }
-      }
-      // average
-      T* dstbeg = dstptr;
-      for (vtkIdType pid = 0; pid < npoints; ++pid, dstbeg += ncomps)
-      {
-        // guard against divide by zero
-        if (unsigned int const denom = num->GetValue(pid))
+        int dimension = 3;
+        while (dimension > 0 && !numPointCells[dimension])
         {
-          // divide point data by the number of cells using it <==>
-          // point_data /= denum
-          std::transform(dstbeg, dstbeg+ncomps, dstbeg,
-                         std::bind2nd(std::divides<T>(), denom));
+          --dimension;
+        }
+        for (int comp = 0; comp < ncomps; comp++)
+        {
+          // guard against divide by zero
+          dst.Set(pid, comp, numPointCells[dimension] ?
+            static_cast<T>(data[comp+ncomps*dimension] / numPointCells[dimension]) :
+            T(0));
         }
       }
+    });
+  }
+};
+
+//----------------------------------------------------------------------------
+// Worker, dispatched on the types of the cell and point arrays, for the
+// structured datasets (vtkImageData, vtkRectilinearGrid and
+// vtkStructuredGrid): the cells of a point are found from the dimensions of
+// the dataset instead of links, and the values of the visible ones are
+// averaged like vtkDataSetAttributes::InterpolatePoint() does. The points
+// from BeginPoint to EndPoint are processed.
+struct StructuredSpreadWorker
+{
+  int Dimensions[3];
+  const unsigned char* CellVisibility; // nullptr without blanking
+  vtkIdType BeginPoint;
+  vtkIdType EndPoint;
+
+  // Get the visible cells of a point.
+  vtkIdType GetPointCells(vtkIdType pid, vtkIdList* cellIds)
+  {
+    vtkStructuredData::GetPointCells(pid, cellIds, this->Dimensions);
+    vtkIdType numCells = 0;
+    for (vtkIdType i = 0; i < cellIds->GetNumberOfIds(); ++i)
+    {
+      vtkIdType const cellId = cellIds->GetId(i);
+      if (!this->CellVisibility || this->CellVisibility[cellId])
+      {
+        cellIds->SetId(numCells++, cellId);
+      }
     }
-    else
-    { // compute over cell patches
-      vtkNew<vtkIdList> cellsOnPoint;
-      std::vector<T> data(4*ncomps);
-      for (vtkIdType pid = 0; pid < npoints; ++pid)
+    cellIds->SetNumberOfIds(numCells);
+    return numCells;
+  }
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT* srcarray, DstArrayT* dstarray)
+  {
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType T;
+    vtkDataArrayAccessor<SrcArrayT> src(srcarray);
+    vtkDataArrayAccessor<DstArrayT> dst(dstarray);
+    const int ncomps = srcarray->GetNumberOfComponents();
+
+    vtkSMPThreadLocalObject<vtkIdList> localCellIds;
+    vtkSMPTools::For(this->BeginPoint, this->EndPoint,
+      [&](vtkIdType pid, vtkIdType endPid)
+    {
+      vtkIdList* cellIds = localCellIds.Local();
+      for (; pid < endPid; ++pid)
       {
-        std::fill(data.begin(), data.end(), 0);
-        T numPointCells[4] = {0, 0, 0, 0};
-        // Get all cells touching this point.
-        src->GetPointCells(pid, cellsOnPoint);
-        vtkIdType numPatchCells = cellsOnPoint->GetNumberOfIds();
-        for (vtkIdType pc = 0; pc  < numPatchCells; pc++)
+        vtkIdType const numCells = this->GetPointCells(pid, cellIds);
+        double const weight = numCells > 0 ? 1.0 / numCells : 0.0;
+        for (int comp = 0; comp < ncomps; comp++)
         {
-          vtkIdType cellId = cellsOnPoint->GetId(pc);
-          int cellDimension = src->GetCell(cellId)->GetCellDimension();
-          numPointCells[cellDimension] += 1;
-          for (int comp=0;comp<ncomps;comp++)
+          double val = 0.;
+          for (vtkIdType i = 0; i < numCells; ++i)
           {
-            data[comp+ncomps*cellDimension] += srcptr[comp+cellId*ncomps];
-          }
-        }
-        for (int dimension=3;dimension>=0;dimension--)
-        {
-          if (numPointCells[dimension])
-          {
-            for (int comp=0;comp<ncomps;comp++)
-            {
-              dstptr[comp+pid*ncomps] = data[comp+dimension*ncomps] / numPointCells[dimension];
-            }
-            break;
+            val += weight * static_cast<double>(src.Get(cellIds->GetId(i), comp));
           }
+          T valT;
+          vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+          dst.Set(pid, comp, valT);
         }
       }
-    }
+    });
   }
 
-  // Special traversal algorithm for vtkUniformGrid and vtkRectilinearGrid to support blanking
-  // points will not have more than 8 cells for either of these data sets
-  template <typename T>
-  void InterpolatePointDataWithMask(vtkCellDataToPointData* filter, T *input, vtkDataSet *output)
+  // Map the arrays that are not vtkDataArrays (a vtkStringArray for
+  // instance) with vtkAbstractArray::InterpolateTuple(), in a single thread.
+  void InterpolateTuples(vtkAbstractArray* srcarray, vtkAbstractArray* dstarray)
   {
-    vtkNew<vtkIdList> allCellIds;
-    allCellIds->Allocate(8);
     vtkNew<vtkIdList> cellIds;
-    cellIds->Allocate(8);
+    double weights[8];
+    for (vtkIdType pid = this->BeginPoint; pid < this->EndPoint; ++pid)
+    {
+      vtkIdType const numCells = this->GetPointCells(pid, cellIds);
+      if (numCells > 0)
+      {
+        std::fill_n(weights, numCells, 1.0 / numCells);
+        dstarray->InterpolateTuple(pid, cellIds, srcarray, weights);
+      }
+    }
+  }
+};
 
-    vtkIdType numPts = input->GetNumberOfPoints();
+//----------------------------------------------------------------------------
+// Allocate the point data of dst for the arrays of the cell data of src
+// (only the vtkDataArrays when dataArraysOnly is set), then fill them field
+// by field, calling map(srcarray, dstarray, beginPoint, endPoint) for
+// blocks of points so that the progress is updated and an abort request is
+// honored while a field is mapped.
+template <typename TMap>
+void SpreadFields(vtkCellDataToPointData* filter, vtkDataSet* src,
+                  vtkDataSet* dst, bool dataArraysOnly, TMap map)
+{
+  vtkIdType const npoints = src->GetNumberOfPoints();
 
-    vtkCellData *inCD = input->GetCellData();
-    vtkPointData *outPD = output->GetPointData();
-    outPD->InterpolateAllocate(inCD,numPts);
+  // Copy all existing cell fields into a temporary cell data array
+  vtkSmartPointer<vtkCellData> clean = vtkSmartPointer<vtkCellData>::New();
+  clean->PassData(src->GetCellData());
 
-    double weights[8];
+  // Remove all fields that are not a data array if needed.
+  for (vtkIdType fid = clean->GetNumberOfArrays(); fid--;)
+  {
+    if (dataArraysOnly &&
+        !vtkDataArray::FastDownCast(clean->GetAbstractArray(fid)))
+    {
+      clean->RemoveArray(fid);
+    }
+  }
 
-    int abort = 0;
-    vtkIdType progressInterval = numPts / 20 + 1;
-    for (vtkIdType ptId = 0; ptId < numPts && !abort; ptId++)
+  // Cell field list constructed from the filtered cell data array
+  vtkDataSetAttributes::FieldList cfl(1);
+  cfl.InitializeFieldList(clean);
+  vtkPointData* const dstpointdata = dst->GetPointData();
+  dstpointdata->InterpolateAllocate(cfl, npoints, npoints);
+
+  vtkIdType const blockSize = npoints / 10 + 1;
+  for (int fid = 0, nfields = cfl.GetNumberOfFields(); fid < nfields; ++fid)
+  {
+    // indices into the field arrays associated with the cell and the point
+    // respectively
+    int const dstid = cfl.GetFieldIndex(fid);
+    int const srcid = cfl.GetDSAIndex(0,fid);
+    if  (srcid < 0 || dstid < 0)
     {
-      if ( !(ptId % progressInterval) )
-      {
-        filter->UpdateProgress(static_cast<double>(ptId)/numPts);
-        abort = filter->GetAbortExecute();
-      }
-      input->GetPointCells(ptId, allCellIds);
-      cellIds->Reset();
-      // Only consider cells that are not masked:
-      for (vtkIdType cId = 0; cId < allCellIds->GetNumberOfIds(); ++cId)
-      {
-        vtkIdType curCell = allCellIds->GetId(cId);
-        if (input->IsCellVisible(curCell))
-        {
-          cellIds->InsertNextId(curCell);
-        }
-      }
+      continue;
+    }
 
-      vtkIdType numCells = cellIds->GetNumberOfIds();
+    vtkAbstractArray* const srcarray = clean->GetAbstractArray(srcid);
+    vtkAbstractArray* const dstarray = dstpointdata->GetAbstractArray(dstid);
+    dstarray->SetNumberOfTuples(npoints);
 
-      if ( numCells > 0 )
-      {
-        double weight = 1.0 / numCells;
-        for (vtkIdType cellId = 0; cellId < numCells; cellId++)
-        {
-          weights[cellId] = weight;
-        }
-        outPD->InterpolatePoint(inCD, ptId, cellIds, weights);
-      }
-      else
+    for (vtkIdType begin = 0; begin < npoints; begin += blockSize)
+    {
+      vtkIdType const end = std::min(begin + blockSize, npoints);
+      map(srcarray, dstarray, begin, end);
+
+      // update progress and check for an abort request.
+      filter->UpdateProgress((fid + static_cast<double>(end)/npoints)/nfields);
+      if (filter->GetAbortExecute())
       {
-        outPD->NullPoint(ptId);
+        return;
       }
     }
   }
+}
+
+//----------------------------------------------------------------------------
+// Map a vtkDataArray with worker, dispatched on the types of the arrays.
+template <typename TWorker>
+void DispatchWorker(TWorker& worker, vtkDataArray* srcarray,
+                    vtkDataArray* dstarray)
+{
+  if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(
+        srcarray, dstarray, worker))
+  {
+    // Use vtkDataArray API when fast-path dispatch fails.
+    worker(srcarray, dstarray);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Get the point dimensions of the datasets handled by
+// StructuredSpreadWorker.
+bool GetStructuredDimensions(vtkDataSet* input, int dims[3])
+{
+  if (vtkImageData* image = vtkImageData::SafeDownCast(input))
+  {
+    image->GetDimensions(dims);
+    return true;
+  }
+  if (vtkRectilinearGrid* rgrid = vtkRectilinearGrid::SafeDownCast(input))
+  {
+    rgrid->GetDimensions(dims);
+    return true;
+  }
+  if (vtkStructuredGrid* sgrid = vtkStructuredGrid::SafeDownCast(input))
+  {
+    sgrid->GetDimensions(dims);
+    return true;
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+// Visibility of the cells of the blanked vtkUniformGrid and
+// vtkStructuredGrid.
+template <typename T>
+void GetCellVisibility(T* input, std::vector<unsigned char>& visibility)
+{
+  vtkIdType const ncells = input->GetNumberOfCells();
+  visibility.resize(ncells);
+  for (vtkIdType cellId = 0; cellId < ncells; ++cellId)
+  {
+    visibility[cellId] = input->IsCellVisible(cellId) ? 1 : 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Dimension of each cell of an unstructured dataset, found once per cell
+// type.
+void GetCellDimensions(vtkDataSet* src, std::vector<unsigned char>& dims)
+{
+  unsigned char typeDimensions[VTK_NUMBER_OF_CELL_TYPES];
+  std::fill_n(typeDimensions, VTK_NUMBER_OF_CELL_TYPES, 0);
+  vtkNew<vtkCellTypes> types;
+  src->GetCellTypes(types);
+  vtkNew<vtkGenericCell> cell;
+  for (vtkIdType i = 0; i < types->GetNumberOfTypes(); ++i)
+  {
+    unsigned char const type = types->GetCellType(i);
+    cell->SetCellType(type);
+    typeDimensions[type] = static_cast<unsigned char>(cell->GetCellDimension());
+  }
+
+  vtkIdType const ncells = src->GetNumberOfCells();
+  dims.resize(ncells);
+  vtkSMPTools::For(0, ncells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    for (; cellId < endCellId; ++cellId)
+    {
+      dims[cellId] = typeDimensions[src->GetCellType(cellId)];
+    }
+  });
+}
+
 } // end anonymous namespace
 
 //----------------------------------------------------------------------------
@@ -227,16 +390,40 @@ int vtkCellDataToPointData::RequestData(
     return 1;
   }
 
-  // Do the interpolation, taking care of masked cells if needed.
-  vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input);
-  vtkUniformGrid *uniformGrid = vtkUniformGrid::SafeDownCast(input);
-  if (sGrid && sGrid->HasAnyBlankCells())
+  // Do the interpolation, taking care of masked cells if needed. The cells
+  // of the points of structured datasets are found without building links.
+  StructuredSpreadWorker worker;
+  if (GetStructuredDimensions(input, worker.Dimensions))
   {
-    InterpolatePointDataWithMask(this, sGrid, output);
-  }
-  else if (uniformGrid && uniformGrid->HasAnyBlankCells())
-  {
-    InterpolatePointDataWithMask(this, uniformGrid, output);
+    std::vector<unsigned char> visibility;
+    vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input);
+    vtkUniformGrid *uniformGrid = vtkUniformGrid::SafeDownCast(input);
+    if (sGrid && sGrid->HasAnyBlankCells())
+    {
+      GetCellVisibility(sGrid, visibility);
+    }
+    else if (uniformGrid && uniformGrid->HasAnyBlankCells())
+    {
+      GetCellVisibility(uniformGrid, visibility);
+    }
+    worker.CellVisibility = visibility.empty() ? nullptr : visibility.data();
+    SpreadFields(this, input, output, false,
+      [&](vtkAbstractArray* srcarray, vtkAbstractArray* dstarray,
+          vtkIdType beginPoint, vtkIdType endPoint)
+    {
+      worker.BeginPoint = beginPoint;
+      worker.EndPoint = endPoint;
+      vtkDataArray* const srcdata = vtkDataArray::FastDownCast(srcarray);
+      vtkDataArray* const dstdata = vtkDataArray::FastDownCast(dstarray);
+      if (srcdata && dstdata)
+      {
+        DispatchWorker(worker, srcdata, dstdata);
+      }
+      else
+      {
+        worker.InterpolateTuples(srcarray, dstarray);
+      }
+    });
   }
   else
   {
@@ -281,46 +468,24 @@ int vtkCellDataToPointData::RequestDataForUnstructuredData
     return 1;
   }
 
-  // count the number of cells associated with each point. if we are doing patches
-  // though we will do that later on.
-  vtkSmartPointer<vtkUnsignedIntArray> num;
+  // the dimension of the cells is needed to select the contributing cells
+  // unless all of them contribute.
+  std::vector<unsigned char> cellDimensions;
   int highestCellDimension = 0;
-  if (this->ContributingCellOption != vtkCellDataToPointData::Patch)
+  if (this->ContributingCellOption != vtkCellDataToPointData::All)
   {
-    num = vtkSmartPointer<vtkUnsignedIntArray>::New();
-    num->SetNumberOfComponents(1);
-    num->SetNumberOfTuples(npoints);
-    std::fill_n(num->GetPointer(0), npoints, 0u);
-    if (this->ContributingCellOption == vtkCellDataToPointData::DataSetMax)
-    {
-      int maxDimension = src->IsA("vtkPolyData") == 1 ? 2 : 3;
-      for (vtkIdType i=0;i<src->GetNumberOfCells();i++)
-      {
-        int dim = src->GetCell(i)->GetCellDimension();
-        if (dim > highestCellDimension)
-        {
-          highestCellDimension = dim;
-          if (highestCellDimension == maxDimension)
-          {
-            break;
-          }
-        }
-      }
-    }
-    vtkNew<vtkIdList> pids;
-    for (vtkIdType cid = 0; cid < ncells; ++cid)
-    {
-      if (src->GetCell(cid)->GetCellDimension() >= highestCellDimension)
-      {
-        src->GetCellPoints(cid, pids);
-        for (vtkIdType i = 0, I = pids->GetNumberOfIds(); i < I; ++i)
-        {
-          vtkIdType const pid = pids->GetId(i);
-          num->SetValue(pid, num->GetValue(pid)+1);
-        }
-      }
-    }
+    GetCellDimensions(src, cellDimensions);
   }
+  if (this->ContributingCellOption == vtkCellDataToPointData::DataSetMax)
+  {
+    highestCellDimension =
+      *std::max_element(cellDimensions.begin(), cellDimensions.end());
+  }
+
+  // the cells using each point are gathered from static links, so that the
+  // points can be processed concurrently.
+  vtkStaticCellLinksTemplate<vtkIdType> links;
+  links.BuildLinks(src);
 
   // First, copy the input to the output as a starting point
   dst->CopyStructure(src);
@@ -333,61 +498,21 @@ int vtkCellDataToPointData::RequestDataForUnstructuredData
   opd->PassData(src->GetPointData());
   opd->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
 
-  // Copy all existing cell fields into a temporary cell data array
-  vtkSmartPointer<vtkCellData> clean = vtkSmartPointer<vtkCellData>::New();
-  clean->PassData(src->GetCellData());
-
-  // Remove all fields that are not a data array.
-  for (vtkIdType fid = clean->GetNumberOfArrays(); fid--;)
+  SpreadWorker<vtkIdType> worker;
+  worker.Links = &links;
+  worker.CellDimensions =
+    cellDimensions.empty() ? nullptr : cellDimensions.data();
+  worker.HighestCellDimension = highestCellDimension;
+  worker.ContributingCellOption = this->ContributingCellOption;
+  SpreadFields(this, src, dst, true,
+    [&](vtkAbstractArray* srcarray, vtkAbstractArray* dstarray,
+        vtkIdType beginPoint, vtkIdType endPoint)
   {
-    if (!vtkDataArray::FastDownCast(clean->GetAbstractArray(fid)))
-    {
-      clean->RemoveArray(fid);
-    }
-  }
-
-  // Cell field list constructed from the filtered cell data array
-  vtkDataSetAttributes::FieldList cfl(1);
-  cfl.InitializeFieldList(clean);
-  opd->InterpolateAllocate(cfl, npoints, npoints);
-
-  for (int fid = 0, nfields = cfl.GetNumberOfFields(); fid < nfields; ++fid)
-  {
-    // update progress and check for an abort request.
-    this->UpdateProgress((fid+1.)/nfields);
-    if (this->GetAbortExecute())
-    {
-      break;
-    }
-
-    // indices into the field arrays associated with the cell and the point
-    // respectively
-    int const dstid = cfl.GetFieldIndex(fid);
-    int const srcid = cfl.GetDSAIndex(0,fid);
-    if  (srcid < 0 || dstid < 0)
-    {
-      continue;
-    }
-
-    vtkCellData * const srccelldata  = clean;
-    vtkPointData* const dstpointdata = dst->GetPointData();
-
-    if (!srccelldata || !dstpointdata)
-    {
-      continue;
-    }
-
-    vtkDataArray* const srcarray = srccelldata ->GetArray(srcid);
-    vtkDataArray* const dstarray = dstpointdata->GetArray(dstid);
-    dstarray->SetNumberOfTuples(npoints);
-
-    vtkIdType const ncomps = srcarray->GetNumberOfComponents();
-    switch (srcarray->GetDataType())
-    {
-      vtkTemplateMacro
-        (__spread<VTK_TT>(src,num,srcarray,dstarray,ncells,npoints,ncomps, highestCellDimension, this->ContributingCellOption));
-    }
-  }
+    worker.BeginPoint = beginPoint;
+    worker.EndPoint = endPoint;
+    DispatchWorker(worker, vtkDataArray::FastDownCast(srcarray),
+                   vtkDataArray::FastDownCast(dstarray));
+  });
 
   if (!this->PassCellData)
   {
@@ -399,6 +524,7 @@ int vtkCellDataToPointData::RequestDataForUnstructuredData
   return 1;
 }
 
+//----------------------------------------------------------------------------
 void vtkCellDataToPointData::InterpolatePointData(vtkDataSet *input, vtkDataSet *output)
 {
   vtkNew<vtkIdList> cellIds;
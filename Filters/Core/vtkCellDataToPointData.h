@@ -28,6 +28,14 @@
  * cells attached to a point. DataSetMax uses the highest cell dimension in
  * the entire data set.
  *
+ * The points are processed in parallel with vtkSMPTools. For unstructured
+ * grids and polydata the cells using each point are found with static cell
+ * links; for image data, rectilinear and structured grids they are found
+ * from the dimensions of the dataset. Only the cell data arrays that are
+ * vtkDataArrays are mapped to the points of unstructured grids and
+ * polydata; the other arrays of the structured datasets (a vtkStringArray
+ * for instance) are interpolated from a single thread.
+ *
  * @warning
  * This filter is an abstract filter, that is, the output is an abstract type
  * (i.e., vtkDataSet). Use the convenience methods (e.g.,
@@ -97,6 +105,10 @@ protected:
     (vtkInformation*, vtkInformationVector**, vtkInformationVector*);
   //@}
 
+  /**
+   * Serial algorithm for the datasets that are neither unstructured nor
+   * structured.
+   */
   void InterpolatePointData(vtkDataSet *input, vtkDataSet *output);
 
   //@{
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkCleanPolyData.h"
 
+#include "vtkArrayListTemplate.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkMergePoints.h"
@@ -22,11 +23,602 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkIncrementalPointLocator.h"
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 vtkStandardNewMacro(vtkCleanPolyData);
 
+//---------------------------------------------------------------------------
+// The parallel clean. It gives the same output as the serial algorithm with a
+// vtkMergePoints locator (or without merging): the output points are numbered
+// in order of first use by the cells (verts, lines, polys then strips), each
+// output point gets the coordinates and the data of the first input point it
+// replaces, and the cells keep their relative order.
+//
+// The first use of each point is found with an atomic minimum over the
+// cells. Coincident points are grouped by sorting the points by bucket of a
+// regular grid, then by coordinates, as vtkStaticPointLocator does. The cells
+// are then rebuilt in two passes over fixed size chunks of cells: the first
+// counts the output cells of each type produced by each chunk, the second
+// writes them at the offsets given by a prefix sum of the counts.
+namespace
+{
+
+// The type of output cell an input cell is turned into.
+enum CleanCellType
+{
+  CLEAN_VERT = 0,
+  CLEAN_LINE = 1,
+  CLEAN_POLY = 2,
+  CLEAN_STRIP = 3,
+  CLEAN_NONE = 4
+};
+
+// Number of cells of a chunk of the cell passes.
+const vtkIdType CLEAN_CHUNK_SIZE = 4096;
+
+class vtkParallelClean
+{
+public:
+  typedef std::function<void(double*, double*)> PointOperator;
+
+  vtkParallelClean(vtkCleanPolyData *self, vtkPolyData *input,
+                   const PointOperator &operateOnPoint, double bounds[6])
+    : Self(self), Input(input), OperateOnPoint(operateOnPoint)
+  {
+    std::copy(bounds, bounds + 6, this->Bounds);
+    this->CellArrays[CLEAN_VERT] = input->GetVerts();
+    this->CellArrays[CLEAN_LINE] = input->GetLines();
+    this->CellArrays[CLEAN_POLY] = input->GetPolys();
+    this->CellArrays[CLEAN_STRIP] = input->GetStrips();
+    this->CellTypeBegin[0] = 0;
+    for (int type = 0; type < 4; ++type)
+    {
+      this->Cells.AddCells(this->CellArrays[type]);
+      this->CellTypeBegin[type + 1] = this->Cells.GetNumberOfCells();
+    }
+    this->MaxCellSize = input->GetMaxCellSize();
+  }
+
+  void Execute(vtkPoints *newPts, vtkPolyData *output);
+
+private:
+  void MapPoints(vtkPoints *newPts);
+  void FindFirstUses(std::vector<std::atomic<vtkTypeInt64> > &firstUses);
+  void MergePoints(const std::vector<std::atomic<vtkTypeInt64> > &firstUses,
+                   std::vector<vtkIdType> &representatives);
+  vtkIdType NumberPoints(
+    const std::vector<std::atomic<vtkTypeInt64> > &firstUses,
+    const std::vector<vtkIdType> &representatives);
+  int CleanCell(vtkIdType cellId, vtkIdList *buffer, vtkIdType *pts,
+                vtkIdType &npts) const;
+  void BuildCells(vtkPolyData *output, std::vector<vtkIdType> &cellSources);
+  static void CopyAttributes(vtkDataSetAttributes *in,
+                             vtkDataSetAttributes *out,
+                             const std::vector<vtkIdType> &sources);
+
+  vtkCleanPolyData *Self;
+  vtkPolyData *Input;
+  // vtkCleanPolyData::OperateOnPoint(), and the bounds of the points it
+  // gives.
+  PointOperator OperateOnPoint;
+  double Bounds[6];
+  vtkCellArray *CellArrays[4];
+  vtkIdType CellTypeBegin[5];
+  vtkStaticCellLinksDetail::CellArraysAccess Cells;
+  vtkIdType MaxCellSize;
+  // Coordinates of the input points once operated on, rounded to the
+  // precision of the output points.
+  std::vector<double> Coords;
+  // Output point of each input point (-1 if unused) and input point of each
+  // output point.
+  std::vector<vtkIdType> PointMap;
+  std::vector<vtkIdType> PointSources;
+};
+
+//---------------------------------------------------------------------------
+// OperateOnPoint() is a public virtual method that subclasses may override
+// without making it thread safe, so the points are mapped on the calling
+// thread, in order. The following passes are the ones run in parallel.
+void vtkParallelClean::MapPoints(vtkPoints *newPts)
+{
+  vtkPoints *inPts = this->Input->GetPoints();
+  vtkIdType numPts = inPts->GetNumberOfPoints();
+  bool toFloat = (newPts->GetDataType() == VTK_FLOAT);
+  this->Coords.resize(3 * numPts);
+  double x[3];
+  for (vtkIdType ptId = 0; ptId < numPts; ++ptId)
+  {
+    double *newx = this->Coords.data() + 3 * ptId;
+    inPts->GetPoint(ptId, x);
+    this->OperateOnPoint(x, newx);
+    if (toFloat)
+    {
+      newx[0] = static_cast<float>(newx[0]);
+      newx[1] = static_cast<float>(newx[1]);
+      newx[2] = static_cast<float>(newx[2]);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+// The first use of a point is the smallest cellId * MaxCellSize + i for
+// which the point is the i-th point of the cell cellId.
+void vtkParallelClean::FindFirstUses(
+  std::vector<std::atomic<vtkTypeInt64> > &firstUses)
+{
+  vtkSMPTools::For(0, static_cast<vtkIdType>(firstUses.size()),
+    [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      firstUses[ptId].store(VTK_TYPE_INT64_MAX, std::memory_order_relaxed);
+    }
+  });
+
+  vtkSMPThreadLocalObject<vtkIdList> buffers;
+  vtkSMPTools::For(0, this->Cells.GetNumberOfCells(),
+    [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdList *buffer = buffers.Local();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (; cellId < endCellId; ++cellId)
+    {
+      this->Cells.GetCellPoints(cellId, npts, pts, buffer);
+      vtkTypeInt64 use = static_cast<vtkTypeInt64>(cellId) * this->MaxCellSize;
+      for (vtkIdType i = 0; i < npts; ++i, ++use)
+      {
+        std::atomic<vtkTypeInt64> &firstUse = firstUses[pts[i]];
+        vtkTypeInt64 current = firstUse.load(std::memory_order_relaxed);
+        while (use < current &&
+               !firstUse.compare_exchange_weak(current, use,
+                                               std::memory_order_relaxed))
+        {
+        }
+      }
+    }
+  });
+}
+
+//---------------------------------------------------------------------------
+// Find for each used point the first used point with the same coordinates.
+void vtkParallelClean::MergePoints(
+  const std::vector<std::atomic<vtkTypeInt64> > &firstUses,
+  std::vector<vtkIdType> &representatives)
+{
+  vtkIdType numPts = static_cast<vtkIdType>(firstUses.size());
+
+  // A regular grid of about NumberOfPointsPerBucket points per bucket over
+  // the bounds of the operated points. Flat dimensions are not divided.
+  const double *bounds = this->Bounds;
+  int numDims = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    numDims += (bounds[2 * i + 1] > bounds[2 * i]);
+  }
+  const double numberOfPointsPerBucket = 3.0;
+  int div = (numDims == 0 ? 1 : static_cast<int>(
+    pow(numPts / numberOfPointsPerBucket, 1.0 / numDims)));
+  div = std::max(1, std::min(div, 1024));
+  vtkIdType divisions[3];
+  double h[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    double length = bounds[2 * i + 1] - bounds[2 * i];
+    divisions[i] = (length > 0.0 ? div : 1);
+    h[i] = (length > 0.0 ? divisions[i] / length : 0.0);
+  }
+
+  struct BucketTuple
+  {
+    vtkIdType Bucket;
+    vtkIdType PtId;
+  };
+  std::vector<BucketTuple> tuples(numPts);
+  const double *coords = this->Coords.data();
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      BucketTuple &tuple = tuples[ptId];
+      tuple.PtId = ptId;
+      if (firstUses[ptId].load(std::memory_order_relaxed) ==
+          VTK_TYPE_INT64_MAX)
+      {
+        tuple.Bucket = VTK_ID_MAX; // unused points are sorted last
+        continue;
+      }
+      vtkIdType ijk[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        ijk[i] = static_cast<vtkIdType>(
+          (coords[3 * ptId + i] - bounds[2 * i]) * h[i]);
+        ijk[i] = std::max<vtkIdType>(0, std::min(ijk[i], divisions[i] - 1));
+      }
+      tuple.Bucket = ijk[0] + divisions[0] * (ijk[1] + divisions[1] * ijk[2]);
+    }
+  });
+
+  // Coincident points are contiguous once sorted, the first used one first.
+  vtkSMPTools::Sort(tuples.begin(), tuples.end(),
+    [&](const BucketTuple &a, const BucketTuple &b)
+  {
+    if (a.Bucket != b.Bucket)
+    {
+      return a.Bucket < b.Bucket;
+    }
+    const double *x = coords + 3 * a.PtId;
+    const double *y = coords + 3 * b.PtId;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (x[i] != y[i])
+      {
+        return x[i] < y[i];
+      }
+    }
+    return firstUses[a.PtId].load(std::memory_order_relaxed) <
+      firstUses[b.PtId].load(std::memory_order_relaxed);
+  });
+
+  representatives.resize(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType i, vtkIdType endI)
+  {
+    for (; i < endI; ++i)
+    {
+      const BucketTuple &first = tuples[i];
+      const double *x = coords + 3 * first.PtId;
+      if (first.Bucket == VTK_ID_MAX)
+      {
+        representatives[first.PtId] = first.PtId;
+        continue;
+      }
+      if (i > 0 && tuples[i - 1].Bucket == first.Bucket)
+      {
+        const double *y = coords + 3 * tuples[i - 1].PtId;
+        if (x[0] == y[0] && x[1] == y[1] && x[2] == y[2])
+        {
+          continue; // not the first of its group
+        }
+      }
+      for (vtkIdType j = i; j < numPts && tuples[j].Bucket == first.Bucket;
+           ++j)
+      {
+        const double *y = coords + 3 * tuples[j].PtId;
+        if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+        {
+          break;
+        }
+        representatives[tuples[j].PtId] = first.PtId;
+      }
+    }
+  });
+}
+
+//---------------------------------------------------------------------------
+// Number the output points in order of first use, fill PointMap and
+// PointSources. Return the number of output points.
+vtkIdType vtkParallelClean::NumberPoints(
+  const std::vector<std::atomic<vtkTypeInt64> > &firstUses,
+  const std::vector<vtkIdType> &representatives)
+{
+  vtkIdType numPts = static_cast<vtkIdType>(firstUses.size());
+  this->PointMap.resize(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      this->PointMap[ptId] = (representatives[ptId] == ptId &&
+        firstUses[ptId].load(std::memory_order_relaxed) != VTK_TYPE_INT64_MAX);
+    }
+  });
+  vtkIdType numNewPts = vtkSMPTools::ExclusiveScan(this->PointMap.begin(),
+    this->PointMap.end(), this->PointMap.begin(), static_cast<vtkIdType>(0));
+
+  // The first uses of the output points, then sorted
+  std::vector<std::pair<vtkTypeInt64, vtkIdType> > uses(numNewPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkIdType next = (ptId + 1 < numPts ? this->PointMap[ptId + 1] :
+                        numNewPts);
+      if (next != this->PointMap[ptId])
+      {
+        uses[this->PointMap[ptId]] = std::make_pair(
+          firstUses[ptId].load(std::memory_order_relaxed), ptId);
+      }
+    }
+  });
+  vtkSMPTools::Sort(uses.begin(), uses.end());
+
+  this->PointSources.resize(numNewPts);
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      this->PointSources[newId] = uses[newId].second;
+    }
+  });
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      this->PointMap[uses[newId].second] = newId;
+    }
+  });
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      if (firstUses[ptId].load(std::memory_order_relaxed) ==
+          VTK_TYPE_INT64_MAX)
+      {
+        this->PointMap[ptId] = -1;
+      }
+      else if (representatives[ptId] != ptId)
+      {
+        this->PointMap[ptId] = this->PointMap[representatives[ptId]];
+      }
+    }
+  });
+  return numNewPts;
+}
+
+//---------------------------------------------------------------------------
+// Renumber the points of a cell and remove its consecutive duplicate points
+// as the serial algorithm does. Return the type of output cell it becomes.
+int vtkParallelClean::CleanCell(vtkIdType cellId, vtkIdList *buffer,
+                                vtkIdType *newPts, vtkIdType &numNewPts) const
+{
+  vtkIdType npts;
+  const vtkIdType *pts;
+  this->Cells.GetCellPoints(cellId, npts, pts, buffer);
+  int type = CLEAN_VERT;
+  while (cellId >= this->CellTypeBegin[type + 1])
+  {
+    ++type;
+  }
+
+  numNewPts = 0;
+  for (vtkIdType i = 0; i < npts; ++i)
+  {
+    vtkIdType ptId = this->PointMap[pts[i]];
+    if (type == CLEAN_VERT || i == 0 || ptId != newPts[numNewPts - 1])
+    {
+      newPts[numNewPts++] = ptId;
+    }
+  }
+
+  switch (type)
+  {
+    case CLEAN_VERT:
+      return numNewPts > 0 ? CLEAN_VERT : CLEAN_NONE;
+    case CLEAN_LINE:
+      break;
+    case CLEAN_POLY:
+      if (numNewPts > 2 && newPts[0] == newPts[numNewPts - 1])
+      {
+        numNewPts--;
+      }
+      if (numNewPts > 2 || !this->Self->GetConvertPolysToLines())
+      {
+        return CLEAN_POLY;
+      }
+      break;
+    default:
+      if (numNewPts > 3 || !this->Self->GetConvertStripsToPolys())
+      {
+        return CLEAN_STRIP;
+      }
+      if (numNewPts == 3 || !this->Self->GetConvertPolysToLines())
+      {
+        return CLEAN_POLY;
+      }
+      break;
+  }
+  if (numNewPts > 1 || !this->Self->GetConvertLinesToPoints())
+  {
+    return CLEAN_LINE;
+  }
+  return numNewPts == 1 ? CLEAN_VERT : CLEAN_NONE;
+}
+
+//---------------------------------------------------------------------------
+// Build the output cells. cellSources receives the input cell of each output
+// cell.
+void vtkParallelClean::BuildCells(vtkPolyData *output,
+                                  std::vector<vtkIdType> &cellSources)
+{
+  vtkIdType numCells = this->Cells.GetNumberOfCells();
+  vtkIdType numChunks = (numCells + CLEAN_CHUNK_SIZE - 1) / CLEAN_CHUNK_SIZE;
+
+  // Number of cells and connectivity size of each output cell type, for each
+  // chunk, turned into offsets by a prefix sum.
+  struct ChunkOffsets
+  {
+    vtkIdType NumberOfCells[4];
+    vtkIdType Size[4];
+  };
+  std::vector<ChunkOffsets> offsets(numChunks + 1);
+  vtkSMPThreadLocalObject<vtkIdList> buffers;
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    vtkIdList *buffer = buffers.Local();
+    std::vector<vtkIdType> newPts(this->MaxCellSize + 1);
+    for (; chunk < endChunk; ++chunk)
+    {
+      ChunkOffsets &counts = offsets[chunk];
+      std::fill_n(counts.NumberOfCells, 4, 0);
+      std::fill_n(counts.Size, 4, 0);
+      vtkIdType cellId = chunk * CLEAN_CHUNK_SIZE;
+      vtkIdType endCellId = std::min(cellId + CLEAN_CHUNK_SIZE, numCells);
+      for (; cellId < endCellId; ++cellId)
+      {
+        vtkIdType numNewPts;
+        int type = this->CleanCell(cellId, buffer, newPts.data(), numNewPts);
+        if (type != CLEAN_NONE)
+        {
+          counts.NumberOfCells[type]++;
+          counts.Size[type] += numNewPts + 1;
+        }
+      }
+    }
+  });
+
+  ChunkOffsets totals;
+  std::fill_n(totals.NumberOfCells, 4, 0);
+  std::fill_n(totals.Size, 4, 0);
+  for (vtkIdType chunk = 0; chunk <= numChunks; ++chunk)
+  {
+    for (int type = 0; type < 4; ++type)
+    {
+      vtkIdType numberOfCells = offsets[chunk].NumberOfCells[type];
+      vtkIdType size = offsets[chunk].Size[type];
+      offsets[chunk].NumberOfCells[type] = totals.NumberOfCells[type];
+      offsets[chunk].Size[type] = totals.Size[type];
+      if (chunk < numChunks)
+      {
+        totals.NumberOfCells[type] += numberOfCells;
+        totals.Size[type] += size;
+      }
+    }
+  }
+
+  // An output cell array is created if the input has cells of this type or
+  // if some cells were converted to it.
+  vtkIdType *connectivity[4] = { nullptr, nullptr, nullptr, nullptr };
+  vtkIdType cellIdBegin[4];
+  for (int type = 0, numOutCells = 0; type < 4; ++type)
+  {
+    cellIdBegin[type] = numOutCells;
+    numOutCells += totals.NumberOfCells[type];
+    if (totals.NumberOfCells[type] == 0 &&
+        this->CellArrays[type]->GetNumberOfCells() == 0)
+    {
+      continue;
+    }
+    vtkCellArray *newCells = vtkCellArray::New();
+    connectivity[type] = newCells->WritePointer(totals.NumberOfCells[type],
+                                                totals.Size[type]);
+    switch (type)
+    {
+      case CLEAN_VERT: output->SetVerts(newCells); break;
+      case CLEAN_LINE: output->SetLines(newCells); break;
+      case CLEAN_POLY: output->SetPolys(newCells); break;
+      default: output->SetStrips(newCells); break;
+    }
+    newCells->Delete();
+  }
+  cellSources.resize(cellIdBegin[3] + totals.NumberOfCells[3]);
+
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    vtkIdList *buffer = buffers.Local();
+    std::vector<vtkIdType> cellPts(this->MaxCellSize + 1);
+    for (; chunk < endChunk; ++chunk)
+    {
+      ChunkOffsets next = offsets[chunk];
+      vtkIdType cellId = chunk * CLEAN_CHUNK_SIZE;
+      vtkIdType endCellId = std::min(cellId + CLEAN_CHUNK_SIZE, numCells);
+      for (; cellId < endCellId; ++cellId)
+      {
+        vtkIdType numNewPts;
+        int type = this->CleanCell(cellId, buffer, cellPts.data() + 1,
+                                   numNewPts);
+        if (type == CLEAN_NONE)
+        {
+          continue;
+        }
+        cellPts[0] = numNewPts;
+        std::copy(cellPts.begin(), cellPts.begin() + numNewPts + 1,
+                  connectivity[type] + next.Size[type]);
+        cellSources[cellIdBegin[type] + next.NumberOfCells[type]] = cellId;
+        next.NumberOfCells[type]++;
+        next.Size[type] += numNewPts + 1;
+      }
+    }
+  });
+}
+
+//---------------------------------------------------------------------------
+// Copy the attributes of the sources of the output elements. Data arrays are
+// copied in parallel, other arrays serially.
+void vtkParallelClean::CopyAttributes(vtkDataSetAttributes *in,
+                                      vtkDataSetAttributes *out,
+                                      const std::vector<vtkIdType> &sources)
+{
+  vtkIdType numOut = static_cast<vtkIdType>(sources.size());
+  out->CopyAllocate(in, numOut);
+  ArrayList arrays;
+  arrays.AddArrays(numOut, in, out, 0.0, false);
+  vtkSMPTools::For(0, numOut, [&](vtkIdType outId, vtkIdType endOutId)
+  {
+    for (; outId < endOutId; ++outId)
+    {
+      arrays.Copy(sources[outId], outId);
+    }
+  });
+  arrays.CopyOtherArrays(numOut, sources.data(), in, out);
+}
+
+//---------------------------------------------------------------------------
+void vtkParallelClean::Execute(vtkPoints *newPts, vtkPolyData *output)
+{
+  vtkIdType numPts = this->Input->GetNumberOfPoints();
+  this->MapPoints(newPts);
+
+  std::vector<std::atomic<vtkTypeInt64> > firstUses(numPts);
+  this->FindFirstUses(firstUses);
+  this->Self->UpdateProgress(0.25);
+
+  std::vector<vtkIdType> representatives;
+  if (this->Self->GetPointMerging())
+  {
+    this->MergePoints(firstUses, representatives);
+  }
+  else
+  {
+    representatives.resize(numPts);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      for (; ptId < endPtId; ++ptId)
+      {
+        representatives[ptId] = ptId;
+      }
+    });
+  }
+  vtkIdType numNewPts = this->NumberPoints(firstUses, representatives);
+  this->Self->UpdateProgress(0.5);
+
+  newPts->SetNumberOfPoints(numNewPts);
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      newPts->SetPoint(newId, this->Coords.data() +
+                       3 * this->PointSources[newId]);
+    }
+  });
+  CopyAttributes(this->Input->GetPointData(), output->GetPointData(),
+                 this->PointSources);
+  this->Self->UpdateProgress(0.75);
+
+  std::vector<vtkIdType> cellSources;
+  this->BuildCells(output, cellSources);
+  CopyAttributes(this->Input->GetCellData(), output->GetCellData(),
+                 cellSources);
+}
+
+}
+
 //---------------------------------------------------------------------------
 // Specify a spatial locator for speeding the search process. By
 // default an instance of vtkPointLocator is used.
@@ -138,10 +730,6 @@ int vtkCleanPolyData::RequestData(
     vtkDebugMacro(<<"No data to Operate On!");
     return 1;
   }
-  vtkIdType *updatedPts = new vtkIdType[input->GetMaxCellSize()];
-
-  vtkIdType numNewPts;
-  vtkIdType numUsedPts=0;
   vtkPoints *newPts = inPts->NewInstance();
 
   // Set the desired precision for the points in the output.
@@ -158,6 +746,34 @@ int vtkCleanPolyData::RequestData(
     newPts->SetDataType(VTK_DOUBLE);
   }
 
+  // Without merging, or when merging exactly coincident points, the points
+  // and the cells are processed in parallel.
+  if ( this->PointMerging )
+  {
+    this->CreateDefaultLocator(input);
+  }
+  if ( (!this->PointMerging || this->Locator->IsA("vtkMergePoints")) &&
+       (newPts->GetDataType() == VTK_FLOAT ||
+        newPts->GetDataType() == VTK_DOUBLE) )
+  {
+    double originalbounds[6], mappedbounds[6];
+    input->GetBounds(originalbounds);
+    this->OperateOnBounds(originalbounds,mappedbounds);
+    vtkParallelClean clean(this, input,
+      [this](double in[3], double out[3]) { this->OperateOnPoint(in, out); },
+      mappedbounds);
+    clean.Execute(newPts, output);
+
+    vtkDebugMacro(<<"Removed "
+                  << numPts - newPts->GetNumberOfPoints() << " points");
+    output->SetPoints(newPts);
+    newPts->Delete();
+    return 1;
+  }
+
+  vtkIdType *updatedPts = new vtkIdType[input->GetMaxCellSize()];
+  vtkIdType numNewPts;
+  vtkIdType numUsedPts=0;
   newPts->Allocate(numPts);
 
   // we'll be needing these
@@ -46,6 +46,14 @@
  * will not be used, and points that are not used by any cells will be
  * eliminated, but never merged.
  *
+ * When points are not merged, or merged with a vtkMergePoints locator (the
+ * default for a zero tolerance), the filter is multithreaded with
+ * vtkSMPTools: coincident points are found by sorting the points by bucket
+ * and coordinates, and the cells are rebuilt in parallel. The output is the
+ * same as the one of the serial algorithm, which is still used with other
+ * locators. OperateOnPoint is always called from the calling thread, so
+ * subclasses overriding it need not be thread safe.
+ *
  * @warning
  * Merging points can alter topology, including introducing non-manifold
  * forms. The tolerance should be chosen carefully to avoid these problems.
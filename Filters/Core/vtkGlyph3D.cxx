@@ -14,28 +14,340 @@
 =========================================================================*/
 #include "vtkGlyph3D.h"
 
+#include "vtkArrayListTemplate.h"
 #include "vtkCellData.h"
-#include "vtkCell.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
-#include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
 #include "vtkTrivialProducer.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkTypeInt64Array.h"
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkGlyph3D);
 vtkCxxSetObjectMacro(vtkGlyph3D, SourceTransform, vtkTransform);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The cells of one of the cell arrays (vertices, lines, polygons or strips)
+// of a glyph source, with the point ids of the cells stored contiguously so
+// that they can be copied concurrently.
+struct SourceCells
+{
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Ids;
+
+  void Initialize(vtkCellArray* cells)
+  {
+    this->Offsets.assign(1, 0);
+    this->Ids.clear();
+    vtkIdType npts;
+    vtkIdType* pts;
+    for (cells->InitTraversal(); cells->GetNextCell(npts, pts);)
+    {
+      this->Ids.insert(this->Ids.end(), pts, pts + npts);
+      this->Offsets.push_back(static_cast<vtkIdType>(this->Ids.size()));
+    }
+  }
+
+  vtkIdType GetNumberOfCells() const
+  {
+    return static_cast<vtkIdType>(this->Offsets.size()) - 1;
+  }
+
+  vtkIdType GetNumberOfIds() const
+  {
+    return static_cast<vtkIdType>(this->Ids.size());
+  }
+};
+
+//----------------------------------------------------------------------------
+// The index of the cell array (vertices, lines, polygons or strips) of a
+// vtkPolyData holding the cells of the given type.
+int GetCellKind(int type)
+{
+  switch (type)
+  {
+    case VTK_VERTEX: case VTK_POLY_VERTEX:
+      return 0;
+    case VTK_LINE: case VTK_POLY_LINE:
+      return 1;
+    case VTK_TRIANGLE_STRIP:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+//----------------------------------------------------------------------------
+// A glyph source: its points (with the source transform applied), normals
+// and texture coordinates in double precision, and its cells, along with
+// the types of its cells in cell id order.
+struct GlyphSource
+{
+  bool Valid;
+  vtkIdType NumberOfPoints;
+  std::vector<double> Points;
+  std::vector<double> Normals;
+  std::vector<double> TCoords;
+  SourceCells Cells[4];
+  std::vector<int> CellTypes;
+
+  GlyphSource() : Valid(false), NumberOfPoints(0) {}
+
+  void Initialize(vtkPolyData* source, vtkTransform* sourceTransform,
+                  vtkDataArray* normals, vtkDataArray* tcoords)
+  {
+    this->Valid = true;
+    vtkPoints* points = source->GetPoints();
+    this->NumberOfPoints = points ? points->GetNumberOfPoints() : 0;
+    if (this->NumberOfPoints > 0)
+    {
+      vtkNew<vtkPoints> transformedPoints;
+      if (sourceTransform)
+      {
+        transformedPoints->SetDataTypeToDouble();
+        sourceTransform->TransformPoints(points, transformedPoints);
+        points = transformedPoints;
+      }
+      this->Points.resize(3 * this->NumberOfPoints);
+      for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+      {
+        points->GetPoint(i, &this->Points[3 * i]);
+      }
+    }
+    if (normals)
+    {
+      this->Normals.resize(3 * this->NumberOfPoints);
+      for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+      {
+        normals->GetTuple(i, &this->Normals[3 * i]);
+      }
+    }
+    if (tcoords)
+    {
+      int numComps = tcoords->GetNumberOfComponents();
+      this->TCoords.resize(numComps * this->NumberOfPoints);
+      for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+      {
+        tcoords->GetTuple(i, &this->TCoords[numComps * i]);
+      }
+    }
+    this->Cells[0].Initialize(source->GetVerts());
+    this->Cells[1].Initialize(source->GetLines());
+    this->Cells[2].Initialize(source->GetPolys());
+    this->Cells[3].Initialize(source->GetStrips());
+    this->CellTypes.resize(source->GetNumberOfCells());
+    for (vtkIdType cellId = 0; cellId < source->GetNumberOfCells(); ++cellId)
+    {
+      this->CellTypes[cellId] = source->GetCellType(cellId);
+    }
+  }
+
+  vtkIdType GetNumberOfCells() const
+  {
+    return static_cast<vtkIdType>(this->CellTypes.size());
+  }
+};
+
+//----------------------------------------------------------------------------
+// The storage of one output cell array, allocated once for all the glyphs:
+// either the legacy (npts,id0,id1,...) block, or the offsets and
+// connectivity arrays of an offsets storage.
+struct GlyphCellArray
+{
+  vtkIdType* Legacy;
+  vtkSmartPointer<vtkDataArray> Offsets;
+  vtkSmartPointer<vtkDataArray> Connectivity;
+  vtkTypeInt32* Offsets32;
+  vtkTypeInt32* Connectivity32;
+  vtkTypeInt64* Offsets64;
+  vtkTypeInt64* Connectivity64;
+
+  GlyphCellArray() : Legacy(nullptr), Offsets32(nullptr),
+    Connectivity32(nullptr), Offsets64(nullptr), Connectivity64(nullptr) {}
+
+  void Allocate(vtkCellArray* cells, vtkIdType numCells, vtkIdType numIds,
+                vtkIdType numPts, int storage)
+  {
+    if (storage == vtkCellArray::LEGACY_STORAGE)
+    {
+      this->Legacy = cells->WritePointer(numCells, numCells + numIds);
+    }
+    else if (storage == vtkCellArray::OFFSETS_32BIT_STORAGE &&
+             numIds <= VTK_TYPE_INT32_MAX && numPts <= VTK_TYPE_INT32_MAX)
+    {
+      vtkNew<vtkTypeInt32Array> offsets;
+      vtkNew<vtkTypeInt32Array> connectivity;
+      offsets->SetNumberOfValues(numCells + 1);
+      connectivity->SetNumberOfValues(numIds);
+      this->Offsets32 = offsets->GetPointer(0);
+      this->Connectivity32 = connectivity->GetPointer(0);
+      this->Offsets32[numCells] = static_cast<vtkTypeInt32>(numIds);
+      this->Offsets = offsets.GetPointer();
+      this->Connectivity = connectivity.GetPointer();
+    }
+    else
+    {
+      vtkNew<vtkTypeInt64Array> offsets;
+      vtkNew<vtkTypeInt64Array> connectivity;
+      offsets->SetNumberOfValues(numCells + 1);
+      connectivity->SetNumberOfValues(numIds);
+      this->Offsets64 = offsets->GetPointer(0);
+      this->Connectivity64 = connectivity->GetPointer(0);
+      this->Offsets64[numCells] = numIds;
+      this->Offsets = offsets.GetPointer();
+      this->Connectivity = connectivity.GetPointer();
+    }
+  }
+
+  // Write the cells of a glyph whose points start at ptOffset. cellId is
+  // the index of its first cell, and idOffset the number of point ids of
+  // the cells before it.
+  void Write(const SourceCells& cells, vtkIdType cellId, vtkIdType idOffset,
+             vtkIdType ptOffset)
+  {
+    if (this->Legacy)
+    {
+      vtkIdType* out = this->Legacy + cellId + idOffset;
+      for (vtkIdType i = 0; i < cells.GetNumberOfCells(); ++i)
+      {
+        *out++ = cells.Offsets[i + 1] - cells.Offsets[i];
+        for (vtkIdType j = cells.Offsets[i]; j < cells.Offsets[i + 1]; ++j)
+        {
+          *out++ = cells.Ids[j] + ptOffset;
+        }
+      }
+    }
+    else if (this->Offsets32)
+    {
+      WriteOffsets(this->Offsets32 + cellId, this->Connectivity32 + idOffset,
+                   cells, idOffset, ptOffset);
+    }
+    else
+    {
+      WriteOffsets(this->Offsets64 + cellId, this->Connectivity64 + idOffset,
+                   cells, idOffset, ptOffset);
+    }
+  }
+
+  template <typename T>
+  static void WriteOffsets(T* offsets, T* connectivity,
+                           const SourceCells& cells, vtkIdType idOffset,
+                           vtkIdType ptOffset)
+  {
+    for (vtkIdType i = 0; i < cells.GetNumberOfCells(); ++i)
+    {
+      offsets[i] = static_cast<T>(idOffset + cells.Offsets[i]);
+    }
+    for (vtkIdType j = 0; j < cells.GetNumberOfIds(); ++j)
+    {
+      connectivity[j] = static_cast<T>(cells.Ids[j] + ptOffset);
+    }
+  }
+
+  void Finalize(vtkCellArray* cells)
+  {
+    if (this->Offsets)
+    {
+      cells->SetData(this->Offsets, this->Connectivity);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The number of points, cells and cell point ids of the glyphs of a range
+// of input points, for each kind of cells.
+struct GlyphCounts
+{
+  vtkIdType Points;
+  vtkIdType Cells[4];
+  vtkIdType Ids[4];
+
+  GlyphCounts() : Points(0)
+  {
+    std::fill(this->Cells, this->Cells + 4, 0);
+    std::fill(this->Ids, this->Ids + 4, 0);
+  }
+
+  void Add(const GlyphSource& source)
+  {
+    this->Points += source.NumberOfPoints;
+    for (int t = 0; t < 4; ++t)
+    {
+      this->Cells[t] += source.Cells[t].GetNumberOfCells();
+      this->Ids[t] += source.Cells[t].GetNumberOfIds();
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Transform the points of a glyph source with matrix and write them to out.
+template <typename T>
+void TransformGlyphPoints(double matrix[4][4], const double* in, vtkIdType n,
+                          T* out)
+{
+  for (vtkIdType i = 0; i < n; ++i, in += 3, out += 3)
+  {
+    out[0] = static_cast<T>(
+      matrix[0][0]*in[0] + matrix[0][1]*in[1] + matrix[0][2]*in[2] + matrix[0][3]);
+    out[1] = static_cast<T>(
+      matrix[1][0]*in[0] + matrix[1][1]*in[1] + matrix[1][2]*in[2] + matrix[1][3]);
+    out[2] = static_cast<T>(
+      matrix[2][0]*in[0] + matrix[2][1]*in[1] + matrix[2][2]*in[2] + matrix[2][3]);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Transform the normals of a glyph source with matrix (the transposed
+// inverse of the glyph transform) and write them, normalized, to out.
+void TransformGlyphNormals(double matrix[4][4], const double* in, vtkIdType n,
+                           float* out)
+{
+  for (vtkIdType i = 0; i < n; ++i, in += 3, out += 3)
+  {
+    out[0] = static_cast<float>(
+      matrix[0][0]*in[0] + matrix[0][1]*in[1] + matrix[0][2]*in[2]);
+    out[1] = static_cast<float>(
+      matrix[1][0]*in[0] + matrix[1][1]*in[1] + matrix[1][2]*in[2]);
+    out[2] = static_cast<float>(
+      matrix[2][0]*in[0] + matrix[2][1]*in[1] + matrix[2][2]*in[2]);
+    vtkMath::Normalize(out);
+  }
+}
+
+//----------------------------------------------------------------------------
+// The scale and orientation of the glyph of an input point, and the index
+// of its source (-1 when the point is not glyphed).
+struct GlyphPoint
+{
+  double Scale[3];
+  double V[3];
+  double VMag;
+  int Index;
+};
+
+} // anonymous namespace
+
 //----------------------------------------------------------------------------
 // Construct object with scaling on, scaling mode is by scalar value,
 // scale factor = 1.0, the range is (0,1), orient geometry is on, and
@@ -60,6 +372,7 @@ vtkGlyph3D::vtkGlyph3D()
   this->FillCellData = 0;
   this->SourceTransform = nullptr;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->OutputCellArrayStorage = vtkCellArray::LEGACY_STORAGE;
 
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
@@ -140,40 +453,19 @@ bool vtkGlyph3D::Execute(
   vtkPointData *pd;
   vtkDataArray *inCScalars; // Scalars for Coloring
   unsigned char* inGhostLevels=nullptr;
-  vtkDataArray *inNormals, *sourceNormals = nullptr;
+  vtkDataArray *inNormals, *array3D = nullptr;
+  vtkDataArray *sourceNormals = nullptr;
   vtkDataArray *sourceTCoords = nullptr;
-  vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
-  vtkPoints *sourcePts = nullptr;
-  vtkSmartPointer<vtkPoints> transformedSourcePts = vtkSmartPointer<vtkPoints>::New();
-  vtkPoints *newPts;
-  vtkDataArray *newScalars=nullptr;
-  vtkDataArray *newVectors=nullptr;
-  vtkDataArray *newNormals=nullptr;
-  vtkDataArray *newTCoords = nullptr;
-  double x[3], v[3], vNew[3], s = 0.0, vMag = 0.0, value, tc[3];
-  vtkTransform *trans = vtkTransform::New();
-  vtkNew<vtkIdList> pointIdList;
-  vtkIdList *cellPts;
-  int npts;
-  vtkIdList *pts;
-  vtkIdType ptIncr, cellIncr, cellId;
+  vtkIdType numPts, inPtId;
   int haveVectors, haveNormals, haveTCoords = 0;
-  double scalex,scaley,scalez, den;
+  double den;
   vtkPointData* outputPD = output->GetPointData();
   vtkCellData* outputCD = output->GetCellData();
   int numberOfSources = this->GetNumberOfInputConnections(1);
-  vtkIdTypeArray *pointIds=nullptr;
   vtkSmartPointer<vtkPolyData> source = this->GetSource(0, sourceVector);
-  vtkNew<vtkIdList> srcPointIdList;
-  vtkNew<vtkIdList> dstPointIdList;
-  vtkNew<vtkIdList> srcCellIdList;
-  vtkNew<vtkIdList> dstCellIdList;
 
   vtkDebugMacro(<<"Generating glyphs");
 
-  pts = vtkIdList::New();
-  pts->Allocate(VTK_CELL_SIZE);
-
   pd = input->GetPointData();
   inNormals = this->GetInputArrayToProcess(2, input);
   inCScalars = this->GetInputArrayToProcess(3, input);
@@ -202,8 +494,6 @@ bool vtkGlyph3D::Execute(
   if (numPts < 1)
   {
     vtkDebugMacro(<<"No points to glyph!");
-    pts->Delete();
-    trans->Delete();
     return 1;
   }
 
@@ -218,6 +508,12 @@ bool vtkGlyph3D::Execute(
         (this->VectorMode == VTK_USE_NORMAL && inNormals != nullptr)) )
   {
     haveVectors = 1;
+    array3D = this->VectorMode == VTK_USE_NORMAL? inNormals : inVectors;
+    if(array3D->GetNumberOfComponents()>3)
+    {
+      vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
+      return false;
+    }
   }
   else
   {
@@ -232,8 +528,6 @@ bool vtkGlyph3D::Execute(
     if ( source == nullptr )
     {
       vtkErrorMacro(<<"Indexing on but don't have data to index with");
-      pts->Delete();
-      trans->Delete();
       return true;
     }
     else
@@ -265,36 +559,34 @@ bool vtkGlyph3D::Execute(
     source = defaultSource;
   }
 
+  // Gather the points, normals and cells of the glyph sources
+  std::vector<GlyphSource> sources;
   if ( this->IndexMode != VTK_INDEXING_OFF )
   {
     pd = nullptr;
     haveNormals = 1;
-    for (numSourcePts=numSourceCells=i=0; i < numberOfSources; i++)
+    sources.resize(numberOfSources);
+    for (int i=0; i < numberOfSources; i++)
+    {
+      source = this->GetSource(i, sourceVector);
+      if ( source != nullptr && !source->GetPointData()->GetNormals() )
+      {
+        haveNormals = 0;
+      }
+    }
+    for (int i=0; i < numberOfSources; i++)
     {
       source = this->GetSource(i, sourceVector);
       if ( source != nullptr )
       {
-        if (source->GetNumberOfPoints() > numSourcePts)
-        {
-          numSourcePts = source->GetNumberOfPoints();
-        }
-        if (source->GetNumberOfCells() > numSourceCells)
-        {
-          numSourceCells = source->GetNumberOfCells();
-        }
-        if ( !(sourceNormals = source->GetPointData()->GetNormals()) )
-        {
-          haveNormals = 0;
-        }
+        sources[i].Initialize(source, this->SourceTransform,
+          haveNormals ? source->GetPointData()->GetNormals() : nullptr,
+          nullptr);
       }
     }
   }
   else
   {
-    sourcePts = source->GetPoints();
-    numSourcePts = sourcePts->GetNumberOfPoints();
-    numSourceCells = source->GetNumberOfCells();
-
     sourceNormals = source->GetPointData()->GetNormals();
     if ( sourceNormals )
     {
@@ -315,21 +607,168 @@ bool vtkGlyph3D::Execute(
       haveTCoords = 0;
     }
 
+    sources.resize(1);
+    sources[0].Initialize(source, this->SourceTransform, sourceNormals,
+                          sourceTCoords);
+
     // Prepare to copy output.
     pd = input->GetPointData();
-    outputPD->CopyAllocate(pd,numPts*numSourcePts);
-    if (this->FillCellData)
+  }
+
+  // Compute the scale and orientation of the glyph of an input point, and
+  // the index of its source.
+  auto computeGlyph = [&](vtkIdType ptId, GlyphPoint& glyph)
+  {
+    double s = 0.0;
+    glyph.Scale[0] = glyph.Scale[1] = glyph.Scale[2] = 1.0;
+    glyph.VMag = 0.0;
+
+    // Get the scalar and vector data
+    if ( inSScalars )
     {
-      outputCD->CopyAllocate(pd,numPts*numSourceCells);
+      s = inSScalars->GetComponent(ptId, 0);
+      if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
+           this->ScaleMode == VTK_DATA_SCALING_OFF )
+      {
+        glyph.Scale[0] = glyph.Scale[1] = glyph.Scale[2] = s;
+      }
+    }
+
+    if ( haveVectors )
+    {
+      glyph.V[0] = 0;
+      glyph.V[1] = 0;
+      glyph.V[2] = 0;
+      array3D->GetTuple(ptId, glyph.V);
+      glyph.VMag = vtkMath::Norm(glyph.V);
+      if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
+      {
+        glyph.Scale[0] = glyph.V[0];
+        glyph.Scale[1] = glyph.V[1];
+        glyph.Scale[2] = glyph.V[2];
+      }
+      else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
+      {
+        glyph.Scale[0] = glyph.Scale[1] = glyph.Scale[2] = glyph.VMag;
+      }
+    }
+
+    // Clamp data scale if enabled
+    if ( this->Clamping )
+    {
+      for (int i=0; i < 3; i++)
+      {
+        double scale = glyph.Scale[i];
+        scale = (scale < this->Range[0] ? this->Range[0] :
+                 (scale > this->Range[1] ? this->Range[1] : scale));
+        glyph.Scale[i] = (scale - this->Range[0]) / den;
+      }
+    }
+
+    // Compute index into table of glyphs
+    glyph.Index = 0;
+    if ( this->IndexMode != VTK_INDEXING_OFF )
+    {
+      double value = (this->IndexMode == VTK_INDEXING_BY_SCALAR ?
+                      s : glyph.VMag);
+      int index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
+      index = (index < 0 ? 0 :
+              (index >= numberOfSources ? (numberOfSources-1) : index));
+      glyph.Index = (sources[index].Valid ? index : -1);
+    }
+  };
+
+  // First pass: find the source of the glyph of each input point, or -1
+  // if the point is not glyphed.
+  std::vector<int> glyphIndices(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    GlyphPoint glyph;
+    for (; ptId < endPtId; ++ptId)
+    {
+      computeGlyph(ptId, glyph);
+
+      // Check ghost points.
+      // If we are processing a piece, we do not want to duplicate
+      // glyphs on the borders.
+      if (inGhostLevels &&
+          inGhostLevels[ptId] & vtkDataSetAttributes::DUPLICATEPOINT)
+      {
+        glyph.Index = -1;
+      }
+
+      if (inputUG && !inputUG->IsPointVisible(ptId))
+      {
+        // input is a vtkUniformGrid and the current point is blanked. Don't glyph
+        // it.
+        glyph.Index = -1;
+      }
+      glyphIndices[ptId] = glyph.Index;
+    }
+  });
+
+  // IsPointVisible() may be overridden by subclasses that are not thread
+  // safe: call it in order, from this thread.
+  for (inPtId=0; inPtId < numPts; inPtId++)
+  {
+    if (glyphIndices[inPtId] >= 0 && !this->IsPointVisible(input, inPtId))
+    {
+      glyphIndices[inPtId] = -1;
     }
   }
 
-  srcPointIdList->SetNumberOfIds(numSourcePts);
-  dstPointIdList->SetNumberOfIds(numSourcePts);
-  srcCellIdList->SetNumberOfIds(numSourceCells);
-  dstCellIdList->SetNumberOfIds(numSourceCells);
+  this->UpdateProgress(0.25);
+  if (this->GetAbortExecute())
+  {
+    return true;
+  }
+
+  // Count the points and cells of the glyphs of chunks of input points, and
+  // scan the counts to get where the glyphs of each chunk start.
+  vtkIdType numChunks = std::min(numPts,
+    static_cast<vtkIdType>(32 * vtkSMPTools::GetEstimatedNumberOfThreads()));
+  std::vector<GlyphCounts> chunkOffsets(numChunks + 1);
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    for (; chunk < endChunk; ++chunk)
+    {
+      GlyphCounts& counts = chunkOffsets[chunk + 1];
+      vtkIdType endPtId = (chunk + 1) * numPts / numChunks;
+      for (vtkIdType ptId = chunk * numPts / numChunks; ptId < endPtId; ++ptId)
+      {
+        if (glyphIndices[ptId] >= 0)
+        {
+          counts.Add(sources[glyphIndices[ptId]]);
+        }
+      }
+    }
+  });
+  for (vtkIdType chunk = 1; chunk <= numChunks; ++chunk)
+  {
+    GlyphCounts& counts = chunkOffsets[chunk];
+    const GlyphCounts& previous = chunkOffsets[chunk - 1];
+    counts.Points += previous.Points;
+    for (int t = 0; t < 4; ++t)
+    {
+      counts.Cells[t] += previous.Cells[t];
+      counts.Ids[t] += previous.Ids[t];
+    }
+  }
+  const GlyphCounts& totals = chunkOffsets[numChunks];
+  vtkIdType numNewPts = totals.Points;
+  vtkIdType numNewCells = 0;
+  int numCellKinds = 0;
+  for (int t = 0; t < 4; ++t)
+  {
+    numNewCells += totals.Cells[t];
+    numCellKinds += (totals.Cells[t] > 0 ? 1 : 0);
+  }
+  // When the glyphs have cells of several kinds, the cells of each glyph
+  // must keep consecutive cell ids, in the order of the source cells: they
+  // are then inserted one glyph after the other once the points are done.
+  bool insertCells = (numCellKinds > 1);
 
-  newPts = vtkPoints::New();
+  vtkNew<vtkPoints> newPts;
 
   // Set the desired precision for the points in the output.
   if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
@@ -344,27 +783,56 @@ bool vtkGlyph3D::Execute(
   {
     newPts->SetDataType(VTK_DOUBLE);
   }
+  newPts->SetNumberOfPoints(numNewPts);
+  float* newPtsFloat = nullptr;
+  double* newPtsDouble = nullptr;
+  if (newPts->GetDataType() == VTK_DOUBLE)
+  {
+    newPtsDouble = static_cast<vtkDoubleArray*>(newPts->GetData())->GetPointer(0);
+  }
+  else
+  {
+    newPtsFloat = static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0);
+  }
+
+  // The point data of the input points are copied to their glyphs
+  ArrayList pointArrays;
+  ArrayList cellArrays;
+  if ( pd )
+  {
+    outputPD->CopyAllocate(pd,numNewPts);
+    pointArrays.AddArrays(numNewPts, pd, outputPD, 0.0, false);
+    if (this->FillCellData)
+    {
+      outputCD->CopyAllocate(pd,numNewCells);
+      cellArrays.AddArrays(numNewCells, pd, outputCD, 0.0, false);
+    }
+  }
 
-  newPts->Allocate(numPts*numSourcePts);
+  vtkSmartPointer<vtkIdTypeArray> pointIds;
+  vtkSmartPointer<vtkDataArray> newScalars;
+  vtkSmartPointer<vtkFloatArray> newVectors;
+  vtkSmartPointer<vtkFloatArray> newNormals;
+  vtkSmartPointer<vtkFloatArray> newTCoords;
+  vtkFloatArray* newFloatScalars = nullptr;
   if ( this->GeneratePointIds )
   {
-    pointIds = vtkIdTypeArray::New();
+    pointIds = vtkSmartPointer<vtkIdTypeArray>::New();
     pointIds->SetName(this->PointIdsName);
-    pointIds->Allocate(numPts*numSourcePts);
-    outputPD->AddArray(pointIds);
-    pointIds->Delete();
+    pointIds->SetNumberOfValues(numNewPts);
   }
   if ( this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars )
   {
-    newScalars = inCScalars->NewInstance();
+    newScalars.TakeReference(inCScalars->NewInstance());
     newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
-    newScalars->Allocate(inCScalars->GetNumberOfComponents()*numPts*numSourcePts);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName(inCScalars->GetName());
   }
   else if ( (this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars)
   {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts*numSourcePts);
+    newFloatScalars = vtkFloatArray::New();
+    newScalars.TakeReference(newFloatScalars);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName("GlyphScale");
     if (this->ScaleMode == VTK_SCALE_BY_SCALAR)
     {
@@ -373,370 +841,356 @@ bool vtkGlyph3D::Execute(
   }
   else if ( (this->ColorMode == VTK_COLOR_BY_VECTOR) && haveVectors)
   {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts*numSourcePts);
+    newFloatScalars = vtkFloatArray::New();
+    newScalars.TakeReference(newFloatScalars);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName("VectorMagnitude");
   }
   if ( haveVectors )
   {
-    newVectors = vtkFloatArray::New();
+    newVectors = vtkSmartPointer<vtkFloatArray>::New();
     newVectors->SetNumberOfComponents(3);
-    newVectors->Allocate(3*numPts*numSourcePts);
+    newVectors->SetNumberOfTuples(numNewPts);
     newVectors->SetName("GlyphVector");
   }
   if ( haveNormals )
   {
-    newNormals = vtkFloatArray::New();
+    newNormals = vtkSmartPointer<vtkFloatArray>::New();
     newNormals->SetNumberOfComponents(3);
-    newNormals->Allocate(3*numPts*numSourcePts);
+    newNormals->SetNumberOfTuples(numNewPts);
     newNormals->SetName("Normals");
   }
+  int numTCoordsComps = 0;
   if (haveTCoords)
   {
-    newTCoords = vtkFloatArray::New();
-    int numComps = sourceTCoords->GetNumberOfComponents();
-    newTCoords->SetNumberOfComponents(numComps);
-    newTCoords->Allocate(numComps*numPts*numSourcePts);
+    newTCoords = vtkSmartPointer<vtkFloatArray>::New();
+    numTCoordsComps = sourceTCoords->GetNumberOfComponents();
+    newTCoords->SetNumberOfComponents(numTCoordsComps);
+    newTCoords->SetNumberOfTuples(numNewPts);
     newTCoords->SetName("TCoords");
   }
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  if (this->IndexMode != VTK_INDEXING_OFF )
+  // The cells of each kind are written to a single block
+  vtkSmartPointer<vtkCellArray> newCells[4];
+  GlyphCellArray glyphCells[4];
+  for (int t = 0; t < 4 && !insertCells; ++t)
   {
-    output->Allocate(3*numPts*numSourceCells,numPts*numSourceCells);
-  }
-  else
-  {
-    output->Allocate(source,
-                     3*numPts*numSourceCells, numPts*numSourceCells);
-  }
-
-  transformedSourcePts->SetDataTypeToDouble();
-  transformedSourcePts->Allocate(numSourcePts);
-
-  // Traverse all Input points, transforming Source points and copying
-  // point attributes.
-  //
-  ptIncr=0;
-  cellIncr=0;
-  for (inPtId=0; inPtId < numPts; inPtId++)
-  {
-    scalex = scaley = scalez = 1.0;
-    if ( ! (inPtId % 10000) )
+    if (totals.Cells[t] > 0)
     {
-      this->UpdateProgress(static_cast<double>(inPtId)/numPts);
-      if (this->GetAbortExecute())
-      {
-        break;
-      }
-    }
-
-    // Get the scalar and vector data
-    if ( inSScalars )
-    {
-      s = inSScalars->GetComponent(inPtId, 0);
-      if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
-           this->ScaleMode == VTK_DATA_SCALING_OFF )
-      {
-        scalex = scaley = scalez = s;
-      }
+      newCells[t] = vtkSmartPointer<vtkCellArray>::New();
+      glyphCells[t].Allocate(newCells[t], totals.Cells[t], totals.Ids[t],
+                             numNewPts, this->OutputCellArrayStorage);
     }
+  }
 
-    if ( haveVectors )
+  // Second pass: traverse all input points, transforming source points and
+  // copying point attributes, each chunk of points in parallel.
+  vtkSMPThreadLocalObject<vtkTransform> transforms;
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    vtkTransform* trans = transforms.Local();
+    GlyphPoint glyph;
+    double x[3], vNew[3];
+    double normalMatrix[4][4];
+    vtkIdType i;
+    for (; chunk < endChunk; ++chunk)
     {
-      vtkDataArray *array3D = this->VectorMode == VTK_USE_NORMAL? inNormals : inVectors;
-      if(array3D->GetNumberOfComponents()>3)
+      GlyphCounts offsets = chunkOffsets[chunk];
+      vtkIdType endPtId = (chunk + 1) * numPts / numChunks;
+      for (vtkIdType ptId = chunk * numPts / numChunks; ptId < endPtId; ++ptId)
       {
-        vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
-        pts->Delete();
-        trans->Delete();
-        if(newPts)
+        int index = glyphIndices[ptId];
+        if (index < 0)
         {
-          newPts->Delete();
+          continue;
         }
-        if(newVectors)
+        const GlyphSource& glyphSource = sources[index];
+        vtkIdType numSourcePts = glyphSource.NumberOfPoints;
+        vtkIdType ptIncr = offsets.Points;
+        computeGlyph(ptId, glyph);
+        double* v = glyph.V;
+        double scalex = glyph.Scale[0];
+        double scaley = glyph.Scale[1];
+        double scalez = glyph.Scale[2];
+
+        // Now begin copying/transforming glyph
+        trans->Identity();
+
+        // Copy all topology (transformation independent)
+        for (int t = 0; t < 4; ++t)
         {
-          newVectors->Delete();
+          if (newCells[t])
+          {
+            glyphCells[t].Write(glyphSource.Cells[t], offsets.Cells[t],
+                                offsets.Ids[t], ptIncr);
+          }
         }
-        return false;
-      }
-
-      v[0] = 0;
-      v[1] = 0;
-      v[2] = 0;
-      array3D->GetTuple(inPtId, v);
-      vMag = vtkMath::Norm(v);
-      if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
-      {
-        scalex = v[0];
-        scaley = v[1];
-        scalez = v[2];
-      }
-      else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
-      {
-        scalex = scaley = scalez = vMag;
-      }
-    }
-
-    // Clamp data scale if enabled
-    if ( this->Clamping )
-    {
-      scalex = (scalex < this->Range[0] ? this->Range[0] :
-                (scalex > this->Range[1] ? this->Range[1] : scalex));
-      scalex = (scalex - this->Range[0]) / den;
-      scaley = (scaley < this->Range[0] ? this->Range[0] :
-                (scaley > this->Range[1] ? this->Range[1] : scaley));
-      scaley = (scaley - this->Range[0]) / den;
-      scalez = (scalez < this->Range[0] ? this->Range[0] :
-                (scalez > this->Range[1] ? this->Range[1] : scalez));
-      scalez = (scalez - this->Range[0]) / den;
-    }
-
-    // Compute index into table of glyphs
-    if ( this->IndexMode != VTK_INDEXING_OFF )
-    {
-      if ( this->IndexMode == VTK_INDEXING_BY_SCALAR )
-      {
-        value = s;
-      }
-      else
-      {
-        value = vMag;
-      }
-
-      int index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
-      index = (index < 0 ? 0 :
-              (index >= numberOfSources ? (numberOfSources-1) : index));
 
-      source = this->GetSource(index, sourceVector);
-      if ( source != nullptr )
-      {
-        sourcePts = source->GetPoints();
-        sourceNormals = source->GetPointData()->GetNormals();
-        numSourcePts = sourcePts->GetNumberOfPoints();
-        numSourceCells = source->GetNumberOfCells();
-      }
-    }
+        // translate Source to Input point
+        input->GetPoint(ptId, x);
+        trans->Translate(x[0], x[1], x[2]);
 
-    // Make sure we're not indexing into empty glyph
-    if ( source == nullptr )
-    {
-      continue;
-    }
+        if ( haveVectors )
+        {
+          // Copy Input vector
+          float* vectors = newVectors->GetPointer(3*ptIncr);
+          for (i=0; i < 3*numSourcePts; i++)
+          {
+            vectors[i] = static_cast<float>(v[i % 3]);
+          }
+          if (this->Orient && (glyph.VMag > 0.0))
+          {
+            // if there is no y or z component
+            if ( v[1] == 0.0 && v[2] == 0.0 )
+            {
+              if (v[0] < 0) //just flip x if we need to
+              {
+                trans->RotateWXYZ(180.0,0,1,0);
+              }
+            }
+            else
+            {
+              vNew[0] = (v[0]+glyph.VMag) / 2.0;
+              vNew[1] = v[1] / 2.0;
+              vNew[2] = v[2] / 2.0;
+              trans->RotateWXYZ(180.0,vNew[0],vNew[1],vNew[2]);
+            }
+          }
+        }
 
-    // Check ghost points.
-    // If we are processing a piece, we do not want to duplicate
-    // glyphs on the borders.
-    if (inGhostLevels &&
-        inGhostLevels[inPtId] & vtkDataSetAttributes::DUPLICATEPOINT)
-    {
-      continue;
-    }
+        if (haveTCoords)
+        {
+          float* tcoords = newTCoords->GetPointer(numTCoordsComps*ptIncr);
+          for (i = 0; i < numTCoordsComps*numSourcePts; i++)
+          {
+            tcoords[i] = static_cast<float>(glyphSource.TCoords[i]);
+          }
+        }
 
-    if (inputUG && !inputUG->IsPointVisible(inPtId))
-    {
-      // input is a vtkUniformGrid and the current point is blanked. Don't glyph
-      // it.
-      continue;
-    }
+        // determine scale factor from scalars if appropriate
+        // Copy scalar value
+        if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE))
+        {
+          std::fill_n(newFloatScalars->GetPointer(ptIncr), numSourcePts,
+                      static_cast<float>(scalex)); // = scaley = scalez
+        }
+        else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR))
+        {
+          for (i=0; i < numSourcePts; i++)
+          {
+            newScalars->SetTuple(ptIncr+i, ptId, inCScalars);
+          }
+        }
+        if (haveVectors && this->ColorMode == VTK_COLOR_BY_VECTOR)
+        {
+          std::fill_n(newFloatScalars->GetPointer(ptIncr), numSourcePts,
+                      static_cast<float>(glyph.VMag));
+        }
 
-    if (!this->IsPointVisible(input, inPtId))
-    {
-      continue;
-    }
+        // scale data if appropriate
+        if ( this->Scaling )
+        {
+          if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
+          {
+            scalex = scaley = scalez = this->ScaleFactor;
+          }
+          else
+          {
+            scalex *= this->ScaleFactor;
+            scaley *= this->ScaleFactor;
+            scalez *= this->ScaleFactor;
+          }
 
-    // Now begin copying/transforming glyph
-    trans->Identity();
+          if ( scalex == 0.0 )
+          {
+            scalex = 1.0e-10;
+          }
+          if ( scaley == 0.0 )
+          {
+            scaley = 1.0e-10;
+          }
+          if ( scalez == 0.0 )
+          {
+            scalez = 1.0e-10;
+          }
+          trans->Scale(scalex,scaley,scalez);
+        }
 
-    // Copy all topology (transformation independent)
-    for (cellId=0; cellId < numSourceCells; cellId++)
-    {
-      source->GetCellPoints(cellId, pointIdList);
-      cellPts = pointIdList;
-      npts = cellPts->GetNumberOfIds();
-      for (pts->Reset(), i=0; i < npts; i++)
-      {
-        pts->InsertId(i, cellPts->GetId(i) + ptIncr);
-      }
-      output->InsertNextCell(source->GetCellType(cellId), pts);
-    }
+        // multiply points and normals by resulting matrix
+        vtkMatrix4x4* matrix = trans->GetMatrix();
+        if (newPtsDouble)
+        {
+          TransformGlyphPoints(matrix->Element, glyphSource.Points.data(),
+                               numSourcePts, newPtsDouble + 3*ptIncr);
+        }
+        else
+        {
+          TransformGlyphPoints(matrix->Element, glyphSource.Points.data(),
+                               numSourcePts, newPtsFloat + 3*ptIncr);
+        }
 
-    // translate Source to Input point
-    input->GetPoint(inPtId, x);
-    trans->Translate(x[0], x[1], x[2]);
+        if ( haveNormals )
+        {
+          // to transform the normals, multiply by the transposed inverse matrix
+          vtkMatrix4x4::DeepCopy(*normalMatrix, matrix);
+          vtkMatrix4x4::Invert(*normalMatrix, *normalMatrix);
+          vtkMatrix4x4::Transpose(*normalMatrix, *normalMatrix);
+          TransformGlyphNormals(normalMatrix, glyphSource.Normals.data(),
+                                numSourcePts, newNormals->GetPointer(3*ptIncr));
+        }
 
-    if ( haveVectors )
-    {
-      // Copy Input vector
-      for (i=0; i < numSourcePts; i++)
-      {
-        newVectors->InsertTuple(i+ptIncr, v);
-      }
-      if (this->Orient && (vMag > 0.0))
-      {
-        // if there is no y or z component
-        if ( v[1] == 0.0 && v[2] == 0.0 )
+        // Copy point data from source (if possible)
+        if ( pd )
         {
-          if (v[0] < 0) //just flip x if we need to
+          for (i = 0; i < numSourcePts; ++i)
           {
-            trans->RotateWXYZ(180.0,0,1,0);
+            pointArrays.Copy(ptId, ptIncr + i);
+          }
+          if (this->FillCellData)
+          {
+            // The cells of a glyph are consecutive (with a single kind of
+            // cells, the other kinds have no offset).
+            vtkIdType cellIncr = offsets.Cells[0] + offsets.Cells[1] +
+              offsets.Cells[2] + offsets.Cells[3];
+            for (i = 0; i < glyphSource.GetNumberOfCells(); ++i)
+            {
+              cellArrays.Copy(ptId, cellIncr + i);
+            }
           }
         }
-        else
+
+        // If point ids are to be generated, do it here
+        if ( this->GeneratePointIds )
         {
-          vNew[0] = (v[0]+vMag) / 2.0;
-          vNew[1] = v[1] / 2.0;
-          vNew[2] = v[2] / 2.0;
-          trans->RotateWXYZ(180.0,vNew[0],vNew[1],vNew[2]);
+          std::fill_n(pointIds->GetPointer(ptIncr), numSourcePts, ptId);
         }
-      }
-    }
 
-    if (haveTCoords)
-    {
-      for (i = 0; i < numSourcePts; i++)
-      {
-        sourceTCoords->GetTuple(i, tc);
-        newTCoords->InsertTuple(i+ptIncr, tc);
+        offsets.Add(glyphSource);
       }
     }
+  });
 
-    // determine scale factor from scalars if appropriate
-    // Copy scalar value
-    if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE))
-    {
-      for (i=0; i < numSourcePts; i++)
-      {
-        newScalars->InsertTuple(i+ptIncr, &scalex); // = scaley = scalez
-      }
-    }
-    else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR))
+  // Copy the point (and cell) data arrays that could not be copied in
+  // parallel, one tuple at a time.
+  if ( pd && pointArrays.GetNumberOfArrays() < outputPD->GetNumberOfArrays() )
+  {
+    std::vector<vtkIdType> pointSources;
+    pointSources.reserve(numNewPts);
+    for (inPtId=0; inPtId < numPts; inPtId++)
     {
-      for (i=0; i < numSourcePts; i++)
+      if (glyphIndices[inPtId] >= 0)
       {
-        outputPD->CopyTuple(inCScalars, newScalars, inPtId, ptIncr+i);
+        pointSources.insert(pointSources.end(),
+          sources[glyphIndices[inPtId]].NumberOfPoints, inPtId);
       }
     }
-    if (haveVectors && this->ColorMode == VTK_COLOR_BY_VECTOR)
+    pointArrays.CopyOtherArrays(numNewPts, pointSources.data(), pd, outputPD);
+  }
+  if ( pd && this->FillCellData &&
+       cellArrays.GetNumberOfArrays() < outputCD->GetNumberOfArrays() )
+  {
+    std::vector<vtkIdType> cellSources;
+    cellSources.reserve(numNewCells);
+    for (inPtId=0; inPtId < numPts; inPtId++)
     {
-      for (i=0; i < numSourcePts; i++)
+      if (glyphIndices[inPtId] >= 0)
       {
-        newScalars->InsertTuple(i+ptIncr, &vMag);
+        cellSources.insert(cellSources.end(),
+          sources[glyphIndices[inPtId]].GetNumberOfCells(), inPtId);
       }
     }
+    cellArrays.CopyOtherArrays(numNewCells, cellSources.data(), pd, outputCD);
+  }
 
-    // scale data if appropriate
-    if ( this->Scaling )
-    {
-      if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
-      {
-        scalex = scaley = scalez = this->ScaleFactor;
-      }
-      else
-      {
-        scalex *= this->ScaleFactor;
-        scaley *= this->ScaleFactor;
-        scalez *= this->ScaleFactor;
-      }
-
-      if ( scalex == 0.0 )
-      {
-        scalex = 1.0e-10;
-      }
-      if ( scaley == 0.0 )
-      {
-        scaley = 1.0e-10;
-      }
-      if ( scalez == 0.0 )
-      {
-        scalez = 1.0e-10;
-      }
-      trans->Scale(scalex,scaley,scalez);
-    }
-
-    // multiply points and normals by resulting matrix
-    if (this->SourceTransform)
-    {
-      transformedSourcePts->Reset();
-      this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts);
-      trans->TransformPoints(transformedSourcePts, newPts);
-    }
-    else
-    {
-      trans->TransformPoints(sourcePts,newPts);
-    }
+  // Update ourselves and release memory
+  //
+  output->SetPoints(newPts);
 
-    if ( haveNormals )
+  if (insertCells)
+  {
+    output->Allocate(numNewCells);
+    for (int t = 0; t < 4; ++t)
     {
-      trans->TransformNormals(sourceNormals,newNormals);
+      vtkNew<vtkCellArray> cells;
+      cells->Allocate(totals.Cells[t] + totals.Ids[t]);
+      newCells[t] = cells.GetPointer();
     }
-
-    // Copy point data from source (if possible)
-    if ( pd )
+    output->SetVerts(newCells[0]);
+    output->SetLines(newCells[1]);
+    output->SetPolys(newCells[2]);
+    output->SetStrips(newCells[3]);
+
+    std::vector<vtkIdType> pts;
+    vtkIdType ptIncr = 0;
+    for (inPtId=0; inPtId < numPts; inPtId++)
     {
-      for (i = 0; i < numSourcePts; ++i)
+      if (glyphIndices[inPtId] < 0)
       {
-        srcPointIdList->SetId(i, inPtId);
-        dstPointIdList->SetId(i, ptIncr + i);
+        continue;
       }
-      outputPD->CopyData(pd, srcPointIdList, dstPointIdList);
-      if (this->FillCellData)
+      const GlyphSource& glyphSource = sources[glyphIndices[inPtId]];
+      vtkIdType kindCellIds[4] = { 0, 0, 0, 0 };
+      for (int type : glyphSource.CellTypes)
       {
-        for (i = 0; i < numSourceCells; ++i)
+        const SourceCells& cells = glyphSource.Cells[GetCellKind(type)];
+        vtkIdType kindCellId = kindCellIds[GetCellKind(type)]++;
+        pts.clear();
+        for (vtkIdType j = cells.Offsets[kindCellId];
+             j < cells.Offsets[kindCellId + 1]; ++j)
         {
-          srcCellIdList->SetId(i, inPtId);
-          dstCellIdList->SetId(i, cellIncr + i);
+          pts.push_back(cells.Ids[j] + ptIncr);
         }
-        outputCD->CopyData(pd, srcCellIdList, dstCellIdList);
+        output->InsertNextCell(type, static_cast<int>(pts.size()), pts.data());
       }
+      ptIncr += glyphSource.NumberOfPoints;
     }
-
-    // If point ids are to be generated, do it here
-    if ( this->GeneratePointIds )
+    for (int t = 0; t < 4; ++t)
     {
-      for (i=0; i < numSourcePts; i++)
+      newCells[t]->SetStorageType(this->OutputCellArrayStorage);
+    }
+  }
+  else
+  {
+    for (int t = 0; t < 4; ++t)
+    {
+      if (newCells[t])
       {
-        pointIds->InsertNextValue(inPtId);
+        glyphCells[t].Finalize(newCells[t]);
       }
     }
-
-    ptIncr += numSourcePts;
-    cellIncr += numSourceCells;
+    output->SetVerts(newCells[0]);
+    output->SetLines(newCells[1]);
+    output->SetPolys(newCells[2]);
+    output->SetStrips(newCells[3]);
   }
 
-  // Update ourselves and release memory
-  //
-  output->SetPoints(newPts);
-  newPts->Delete();
+  if (pointIds)
+  {
+    outputPD->AddArray(pointIds);
+  }
 
   if (newScalars)
   {
     int idx = outputPD->AddArray(newScalars);
     outputPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
   }
 
   if (newVectors)
   {
     outputPD->SetVectors(newVectors);
-    newVectors->Delete();
   }
 
   if (newNormals)
   {
     outputPD->SetNormals(newNormals);
-    newNormals->Delete();
   }
 
   if (newTCoords)
   {
     outputPD->SetTCoords(newTCoords);
-    newTCoords->Delete();
   }
 
   output->Squeeze();
-  trans->Delete();
-  pts->Delete();
 
   return true;
 }
@@ -836,6 +1290,9 @@ void vtkGlyph3D::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << "\n";
 
+  os << indent << "Output Cell Array Storage: "
+     << this->OutputCellArrayStorage << "\n";
+
   os << indent << "Color Mode: " << this->GetColorModeAsString() << endl;
 
   if ( this->GetNumberOfInputConnections(1) < 2 )
@@ -73,6 +73,16 @@
  * vtkAlgorithm. The first array is scalars, the next vectors, the next
  * normals and finally color scalars.
  *
+ * @warning
+ * The glyphs are generated in parallel with vtkSMPTools. The size of the
+ * glyph of each input point is computed first, then the output points,
+ * cells and attributes are allocated once and filled concurrently. The
+ * cells of each glyph have consecutive cell ids, in the order of the source
+ * cells: when the glyphs have cells of several kinds (vertices, lines,
+ * polygons or strips), the cells are inserted from a single thread once the
+ * points are done. IsPointVisible() is called from a single thread,
+ * in point order.
+ *
  * @sa
  * vtkTensorGlyph
 */
@@ -82,6 +92,7 @@
 
 #include "vtkFiltersCoreModule.h" // For export macro
 #include "vtkPolyDataAlgorithm.h"
+#include "vtkCellArray.h" // For StorageTypes
 
 #define VTK_SCALE_BY_SCALAR 0
 #define VTK_SCALE_BY_VECTOR 1
@@ -318,6 +329,20 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Set/get the storage of the output cell arrays, one of
+   * vtkCellArray::StorageTypes. With the default LEGACY_STORAGE each cell
+   * array is a single (npts,id0,id1,...) block. With an offsets storage the
+   * point ids of all the cells are written to one connectivity block along
+   * with their offsets (OFFSETS_32BIT_STORAGE falls back to 64-bit integers
+   * when the output is too large for 32-bit ids).
+   */
+  vtkSetClampMacro(OutputCellArrayStorage, int,
+    vtkCellArray::LEGACY_STORAGE, vtkCellArray::OFFSETS_64BIT_STORAGE);
+  vtkGetMacro(OutputCellArrayStorage, int);
+  //@}
+
 protected:
   vtkGlyph3D();
   ~vtkGlyph3D() override;
@@ -359,6 +384,7 @@ protected:
   char *PointIdsName;
   vtkTransform* SourceTransform;
   int OutputPointsPrecision;
+  int OutputCellArrayStorage;
 
 private:
   vtkGlyph3D(const vtkGlyph3D&) = delete;
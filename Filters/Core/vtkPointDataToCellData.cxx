@@ -19,14 +19,24 @@
 #include <limits>
 #include <vector>
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkDataArray.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
+#include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStructuredData.h"
+#include "vtkStructuredGrid.h"
 
 #define VTK_EPSILON 1.e-6
 
@@ -63,13 +73,12 @@ public:
     this->Bins.assign(size + 1, this->Init);
   }
 
-  // Reset the fields of the bins in the histogram.
-  void Reset(vtkIdType size)
+  // Reset the fields of the bins in the histogram. All the bins are reset,
+  // since they have been sorted: the result must not depend on the cells
+  // previously processed.
+  void Reset(vtkIdType vtkNotUsed(size))
   {
-    for (vtkIdType i=0; i < size + 1; i++)
-    {
-      this->Bins[i] = this->Init;
-    }
+    std::fill(this->Bins.begin(), this->Bins.end(), this->Init);
     this->Counter = 0;
   }
 
@@ -148,9 +157,183 @@ vtkIdType Histogram::IndexOfLargestBin()
   return std::max_element(this->Bins.begin(), it2, BinCountCmp)->Index;
 }
 
+//----------------------------------------------------------------------------
+// Thread-safe access to the point ids of the cells of the input. Those of
+// the structured datasets are computed from their dimensions; for the
+// unstructured ones the cells are built before the workers run.
+class CellPointsAccess
+{
+public:
+  CellPointsAccess(vtkDataSet* input)
+    : Input(input), Structured(false), HexahedronOrder(false)
+  {
+    if (vtkImageData* image = vtkImageData::SafeDownCast(input))
+    {
+      image->GetDimensions(this->Dimensions);
+      this->Structured = true;
+    }
+    else if (vtkRectilinearGrid* rgrid = vtkRectilinearGrid::SafeDownCast(input))
+    {
+      rgrid->GetDimensions(this->Dimensions);
+      this->Structured = true;
+    }
+    else if (vtkStructuredGrid* sgrid = vtkStructuredGrid::SafeDownCast(input))
+    {
+      sgrid->GetDimensions(this->Dimensions);
+      this->Structured = true;
+      this->HexahedronOrder = true;
+    }
+    if (this->Structured)
+    {
+      this->DataDescription =
+        vtkStructuredData::GetDataDescription(this->Dimensions);
+    }
+    else if (input->GetNumberOfCells() > 0)
+    {
+      // Make sure the cells are built before concurrent accesses
+      vtkNew<vtkIdList> cellPts;
+      input->GetCellPoints(0, cellPts);
+    }
+  }
+
+  // Whether the points of the cells can be accessed concurrently
+  bool IsThreadSafe() const
+  {
+    return this->Structured || this->Input->IsA("vtkUnstructuredGrid") ||
+      this->Input->IsA("vtkPolyData");
+  }
+
+  void GetCellPoints(vtkIdType cellId, vtkIdList* cellPts)
+  {
+    if (this->Structured)
+    {
+      vtkStructuredData::GetCellPoints(cellId, cellPts,
+                                       this->DataDescription, this->Dimensions);
+      // vtkStructuredGrid::GetCellPoints() orders the points of its cells
+      // like quads and hexahedra do: keep that order so that the sums and
+      // the majority points stay the same.
+      vtkIdType npts = cellPts->GetNumberOfIds();
+      if (this->HexahedronOrder && npts >= 4)
+      {
+        vtkIdType* ids = cellPts->GetPointer(0);
+        std::swap(ids[2], ids[3]);
+        if (npts == 8)
+        {
+          std::swap(ids[6], ids[7]);
+        }
+      }
+    }
+    else
+    {
+      this->Input->GetCellPoints(cellId, cellPts);
+    }
+  }
+
+private:
+  vtkDataSet* Input;
+  bool Structured;
+  bool HexahedronOrder;
+  int Dimensions[3];
+  int DataDescription;
+};
+
+//----------------------------------------------------------------------------
+// Worker, dispatched on the types of the point and cell arrays, that
+// averages the values of the points of each cell like
+// vtkDataSetAttributes::InterpolatePoint() does, or with categorical data
+// copies the value of the majority point of the cell. The cells from
+// BeginCell to EndCell are processed.
+struct AverageWorker
+{
+  CellPointsAccess* Access;
+  vtkIdType BeginCell;
+  vtkIdType EndCell;
+  const vtkIdType* MajorityPoints; // nullptr unless categorical data
+  bool Threaded;
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT* srcarray, DstArrayT* dstarray)
+  {
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType T;
+    vtkDataArrayAccessor<SrcArrayT> src(srcarray);
+    vtkDataArrayAccessor<DstArrayT> dst(dstarray);
+    const int ncomps = srcarray->GetNumberOfComponents();
+
+    vtkSMPThreadLocalObject<vtkIdList> localCellPts;
+    auto average = [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList* cellPts = localCellPts.Local();
+      for (; cellId < endCellId; ++cellId)
+      {
+        if (this->MajorityPoints)
+        {
+          vtkIdType const pointId = this->MajorityPoints[cellId];
+          for (int comp = 0; comp < ncomps; comp++)
+          {
+            dst.Set(cellId, comp, pointId < 0 ? T(0) :
+                    static_cast<T>(src.Get(pointId, comp)));
+          }
+          continue;
+        }
+
+        this->Access->GetCellPoints(cellId, cellPts);
+        vtkIdType const numPts = cellPts->GetNumberOfIds();
+        double const weight = numPts > 0 ? 1.0 / numPts : 0.0;
+        for (int comp = 0; comp < ncomps; comp++)
+        {
+          double val = 0.;
+          for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+          {
+            val += weight * static_cast<double>(src.Get(cellPts->GetId(ptId), comp));
+          }
+          T valT;
+          vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+          dst.Set(cellId, comp, valT);
+        }
+      }
+    };
+    if (this->Threaded)
+    {
+      vtkSMPTools::For(this->BeginCell, this->EndCell, average);
+    }
+    else
+    {
+      average(this->BeginCell, this->EndCell);
+    }
+  }
+
+  // Map the arrays that are not vtkDataArrays (a vtkStringArray for
+  // instance) with vtkAbstractArray::InterpolateTuple(), or by copying the
+  // tuple of the majority point, in a single thread.
+  void InterpolateTuples(vtkAbstractArray* srcarray, vtkAbstractArray* dstarray)
+  {
+    vtkNew<vtkIdList> cellPts;
+    std::vector<double> weights;
+    for (vtkIdType cellId = this->BeginCell; cellId < this->EndCell; ++cellId)
+    {
+      if (this->MajorityPoints)
+      {
+        if (this->MajorityPoints[cellId] >= 0)
+        {
+          dstarray->SetTuple(cellId, this->MajorityPoints[cellId], srcarray);
+        }
+        continue;
+      }
+      this->Access->GetCellPoints(cellId, cellPts);
+      vtkIdType const numPts = cellPts->GetNumberOfIds();
+      if (numPts > 0)
+      {
+        weights.assign(numPts, 1.0 / numPts);
+        dstarray->InterpolateTuple(cellId, cellPts, srcarray, weights.data());
+      }
+    }
+  }
+};
+
 }
 
 
+
 vtkStandardNewMacro(vtkPointDataToCellData);
 
 //----------------------------------------------------------------------------
@@ -175,14 +358,10 @@ int vtkPointDataToCellData::RequestData(
   vtkDataSet *input = vtkDataSet::SafeDownCast(
     inInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, ptId, pointId;
-  vtkIdType numCells, numPts;
+  vtkIdType numCells;
   vtkPointData *inPD=input->GetPointData();
   vtkCellData *outCD=output->GetCellData();
   int maxCellSize=input->GetMaxCellSize();
-  vtkIdList *cellPts;
-  double weight;
-  double *weights;
 
   vtkDebugMacro(<<"Mapping point data to cell data");
 
@@ -194,9 +373,6 @@ int vtkPointDataToCellData::RequestData(
     vtkDebugMacro(<<"No input cells!");
     return 1;
   }
-  weights=new double[maxCellSize];
-
-  Histogram hist(maxCellSize);
 
   if (this->CategoricalData == 1)
   {
@@ -205,13 +381,11 @@ int vtkPointDataToCellData::RequestData(
     if (!input->GetPointData()->GetScalars())
     {
       vtkDebugMacro(<<"No input scalars!");
-      delete [] weights;
       return 1;
     }
     if (input->GetPointData()->GetScalars()->GetNumberOfComponents() != 1)
     {
       vtkDebugMacro(<<"Input scalars have more than one component! Cannot categorize!");
-      delete [] weights;
       return 1;
     }
 
@@ -222,8 +396,51 @@ int vtkPointDataToCellData::RequestData(
                                              vtkDataSetAttributes::INTERPOLATE);
   }
 
-  cellPts = vtkIdList::New();
-  cellPts->Allocate(maxCellSize);
+  // The cells are processed concurrently when their points can be accessed
+  // from several threads.
+  CellPointsAccess access(input);
+  bool const threaded = access.IsThreadSafe();
+
+  // With categorical data, find the majority point of each cell: we populate
+  // a histogram from the scalar values at each point, and then select the
+  // bin with the most elements.
+  std::vector<vtkIdType> majorityPoints;
+  if (this->CategoricalData)
+  {
+    majorityPoints.resize(numCells);
+    vtkDataArray* scalars = inPD->GetScalars();
+    vtkSMPThreadLocalObject<vtkIdList> localCellPts;
+    auto findMajorityPoints = [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList* cellPts = localCellPts.Local();
+      Histogram hist(maxCellSize);
+      for (; cellId < endCellId; ++cellId)
+      {
+        access.GetCellPoints(cellId, cellPts);
+        vtkIdType const numPts = cellPts->GetNumberOfIds();
+        if (numPts == 0)
+        {
+          majorityPoints[cellId] = -1;
+          continue;
+        }
+        hist.Reset(numPts);
+        for (vtkIdType ptId=0; ptId < numPts; ptId++)
+        {
+          vtkIdType const pointId = cellPts->GetId(ptId);
+          hist.Fill(pointId, scalars->GetComponent(pointId, 0));
+        }
+        majorityPoints[cellId] = hist.IndexOfLargestBin();
+      }
+    };
+    if (threaded)
+    {
+      vtkSMPTools::For(0, numCells, findMajorityPoints);
+    }
+    else
+    {
+      findMajorityPoints(0, numCells);
+    }
+  }
 
   // Pass the cell data first. The fields and attributes
   // which also exist in the point data of the input will
@@ -232,53 +449,56 @@ int vtkPointDataToCellData::RequestData(
   output->GetCellData()->PassData(input->GetCellData());
   output->GetCellData()->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
 
-  // notice that inPD and outCD are vtkPointData and vtkCellData; respectively.
-  // It's weird, but it works.
-  outCD->InterpolateAllocate(inPD,numCells);
-
-  int abort=0;
-  vtkIdType progressInterval=numCells/20 + 1;
-  for (cellId=0; cellId < numCells && !abort; cellId++)
+  // notice that the point fields are allocated in vtkCellData. It's weird,
+  // but it works.
+  vtkDataSetAttributes::FieldList pfl(1);
+  pfl.InitializeFieldList(inPD);
+  outCD->InterpolateAllocate(pfl, numCells, numCells);
+
+  AverageWorker worker;
+  worker.Access = &access;
+  worker.MajorityPoints = majorityPoints.empty() ? nullptr : majorityPoints.data();
+  worker.Threaded = threaded;
+
+  // Each field is mapped by blocks of cells, so that the progress is updated
+  // and an abort request is honored while a field is mapped.
+  vtkIdType const blockSize = numCells / 10 + 1;
+  bool abort = false;
+  for (int fid = 0, nfields = pfl.GetNumberOfFields();
+       fid < nfields && !abort; ++fid)
   {
-    if ( !(cellId % progressInterval) )
-    {
-      this->UpdateProgress((double)cellId/numCells);
-      abort = GetAbortExecute();
-    }
-
-    input->GetCellPoints(cellId, cellPts);
-    numPts = cellPts->GetNumberOfIds();
-
-    if (numPts == 0)
+    int const dstid = pfl.GetFieldIndex(fid);
+    int const srcid = pfl.GetDSAIndex(0,fid);
+    if  (srcid < 0 || dstid < 0)
     {
       continue;
     }
 
-    // If we aren't dealing with categorical data...
-    if (!(this->CategoricalData))
+    vtkAbstractArray* const srcarray = inPD->GetAbstractArray(srcid);
+    vtkAbstractArray* const dstarray = outCD->GetAbstractArray(dstid);
+    vtkDataArray* const srcdata = vtkDataArray::FastDownCast(srcarray);
+    vtkDataArray* const dstdata = vtkDataArray::FastDownCast(dstarray);
+    dstarray->SetNumberOfTuples(numCells);
+
+    for (vtkIdType begin = 0; begin < numCells && !abort; begin += blockSize)
     {
-      // ...then we simply provide each point with an equal weight value and
-      // interpolate.
-      weight = 1.0 / numPts;
-      for (ptId=0; ptId < numPts; ptId++)
+      worker.BeginCell = begin;
+      worker.EndCell = std::min(begin + blockSize, numCells);
+      if (!srcdata || !dstdata)
       {
-        weights[ptId] = weight;
+        worker.InterpolateTuples(srcarray, dstarray);
       }
-      outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
-    }
-    else
-    {
-      // ...otherwise, we populate a histogram from the scalar values at each
-      // point, and then select the bin with the most elements.
-      hist.Reset(numPts);
-      for (ptId=0; ptId < numPts; ptId++)
+      else if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(
+                 srcdata, dstdata, worker))
       {
-        pointId = cellPts->GetId(ptId);
-        hist.Fill(pointId,
-                  input->GetPointData()->GetScalars()->GetTuple1(pointId));
+        // Use vtkDataArray API when fast-path dispatch fails.
+        worker(srcdata, dstdata);
       }
 
-      outCD->CopyData(inPD, hist.IndexOfLargestBin(), cellId);
+      // update progress and check for an abort request.
+      this->UpdateProgress(
+        (fid + static_cast<double>(worker.EndCell)/numCells)/nfields);
+      abort = this->GetAbortExecute() != 0;
     }
   }
 
@@ -289,9 +509,6 @@ int vtkPointDataToCellData::RequestData(
   }
   output->GetPointData()->PassData(input->GetPointData());
 
-  cellPts->Delete();
-  delete [] weights;
-
   return 1;
 }
 
@@ -22,6 +22,12 @@
  * values of all points defining a particular cell. Optionally, the input point
  * data can be passed through to the output as well.
  *
+ * The cells of unstructured grids, polydata, image data, rectilinear and
+ * structured grids are processed in parallel with vtkSMPTools; the other
+ * datasets are processed serially. The point data arrays that are not
+ * vtkDataArrays (a vtkStringArray for instance) are always mapped from a
+ * single thread.
+ *
  * @warning
  * This filter is an abstract filter, that is, the output is an abstract type
  * (i.e., vtkDataSet). Use the convenience methods (e.g.,
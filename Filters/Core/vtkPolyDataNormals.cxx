@@ -26,11 +26,396 @@
 #include "vtkPolygon.h"
 #include "vtkTriangleStrip.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
 
 #include "vtkNew.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 vtkStandardNewMacro(vtkPolyDataNormals);
 
+#define VTK_CELL_NOT_VISITED     0
+#define VTK_CELL_VISITED         1
+
+// Waves smaller than this are propagated without spawning threads.
+#define VTK_SERIAL_WAVE_SIZE     1024
+
+// Scratch data of the parallel wave propagation. The cells reached by a wave
+// are claimed by the first cell of the wave (in wave order) reaching them, so
+// the orientation of each cell and the order of the next wave are those of a
+// sequential traversal.
+class vtkPolyDataNormals::vtkInternals
+{
+public:
+  vtkInternals(vtkIdType numPolys)
+    : Claims(new std::atomic<vtkIdType>[numPolys]), NumFlips(0)
+  {
+    vtkSMPTools::For(0, numPolys, [this](vtkIdType cellId, vtkIdType endCellId)
+    {
+      for (; cellId < endCellId; ++cellId)
+      {
+        this->Claims[cellId].store(VTK_ID_MAX, std::memory_order_relaxed);
+      }
+    });
+  }
+  ~vtkInternals()
+  {
+    delete [] this->Claims;
+  }
+
+  // Position in the wave of the cell claiming each unvisited cell
+  std::atomic<vtkIdType> *Claims;
+  // Number of cells claimed by each cell of the wave
+  std::vector<vtkIdType> Counts;
+  // Pairs (position in the wave, claimed cell) found by each thread
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Claimed;
+  vtkSMPThreadLocal<int> NumFlips;
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+};
+
+namespace
+{
+
+// Calls f(pts, j, j1, neighbor) for each edge neighbor through which the
+// wave may propagate from cellId, in the order of the sequential traversal.
+// pts[j], pts[j1] is the edge shared with the neighbor.
+template <typename TFunctor>
+void ForEachWaveNeighbor(vtkPolyData *oldMesh, vtkPolyData *newMesh,
+                         vtkTypeBool nonManifoldTraversal, vtkIdType cellId,
+                         vtkIdList *cellIds, TFunctor &f)
+{
+  vtkIdType npts, *pts;
+  newMesh->GetCellPoints(cellId, npts, pts);
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    vtkIdType j1 = (j + 1 < npts) ? j + 1 : 0;
+    oldMesh->GetCellEdgeNeighbors(cellId, pts[j], pts[j1], cellIds);
+    if (cellIds->GetNumberOfIds() == 1 || nonManifoldTraversal)
+    {
+      for (vtkIdType k = 0; k < cellIds->GetNumberOfIds(); ++k)
+      {
+        f(pts, j, j1, cellIds->GetId(k));
+      }
+    }
+  }
+}
+
+// First pass over a wave: each unvisited cell reached by the wave records the
+// smallest position in the wave of the cells reaching it.
+struct vtkClaimWaveNeighbors
+{
+  vtkPolyData *OldMesh;
+  vtkPolyData *NewMesh;
+  vtkTypeBool NonManifoldTraversal;
+  const vtkIdType *Wave;
+  const int *Visited;
+  std::atomic<vtkIdType> *Claims;
+  vtkSMPThreadLocalObject<vtkIdList> *CellIds;
+
+  void operator()(vtkIdType i, vtkIdType endI)
+  {
+    vtkIdList *cellIds = this->CellIds->Local();
+    for (; i < endI; ++i)
+    {
+      auto claim = [this, i](vtkIdType *, vtkIdType, vtkIdType,
+                             vtkIdType neighbor)
+      {
+        if (this->Visited[neighbor] == VTK_CELL_NOT_VISITED)
+        {
+          std::atomic<vtkIdType> &owner = this->Claims[neighbor];
+          vtkIdType current = owner.load(std::memory_order_relaxed);
+          while (i < current &&
+                 !owner.compare_exchange_weak(current, i,
+                                              std::memory_order_relaxed))
+          {
+          }
+        }
+      };
+      ForEachWaveNeighbor(this->OldMesh, this->NewMesh,
+                          this->NonManifoldTraversal, this->Wave[i], cellIds,
+                          claim);
+    }
+  }
+};
+
+// Second pass over a wave: each cell of the wave orders the cells it claimed
+// consistently with itself, marks them visited and records them for the
+// next wave.
+struct vtkOrderWaveNeighbors
+{
+  vtkPolyData *OldMesh;
+  vtkPolyData *NewMesh;
+  vtkTypeBool NonManifoldTraversal;
+  const vtkIdType *Wave;
+  int *Visited;
+  std::atomic<vtkIdType> *Claims;
+  vtkIdType *Counts;
+  vtkSMPThreadLocalObject<vtkIdList> *CellIds;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > *Claimed;
+  vtkSMPThreadLocal<int> *NumFlips;
+
+  void operator()(vtkIdType i, vtkIdType endI)
+  {
+    vtkIdList *cellIds = this->CellIds->Local();
+    std::vector<vtkIdType> &claimed = this->Claimed->Local();
+    int &numFlips = this->NumFlips->Local();
+    for (; i < endI; ++i)
+    {
+      vtkIdType count = 0;
+      auto order = [&, this](vtkIdType *pts, vtkIdType j, vtkIdType j1,
+                             vtkIdType neighbor)
+      {
+        // Only this cell may visit the cells it claimed
+        if (this->Claims[neighbor].load(std::memory_order_relaxed) != i ||
+            this->Visited[neighbor] != VTK_CELL_NOT_VISITED)
+        {
+          return;
+        }
+
+        //  Check the direction of the neighbor ordering.  Should be
+        //  consistent with us (i.e., if we are n1->n2,
+        // neighbor should be n2->n1).
+        vtkIdType numNeiPts, *neiPts, l;
+        this->NewMesh->GetCellPoints(neighbor, numNeiPts, neiPts);
+        for (l = 0; l < numNeiPts; l++)
+        {
+          if (neiPts[l] == pts[j1])
+          {
+            break;
+          }
+        }
+
+        //  Have to reverse ordering if neighbor not consistent
+        //
+        if (neiPts[(l + 1) % numNeiPts] != pts[j])
+        {
+          ++numFlips;
+          this->NewMesh->ReverseCell(neighbor);
+        }
+        this->Visited[neighbor] = VTK_CELL_VISITED;
+        claimed.push_back(i);
+        claimed.push_back(neighbor);
+        ++count;
+      };
+      ForEachWaveNeighbor(this->OldMesh, this->NewMesh,
+                          this->NonManifoldTraversal, this->Wave[i], cellIds,
+                          order);
+      this->Counts[i] = count;
+    }
+  }
+};
+
+// Compute the normal of each polygon.
+struct vtkComputePolyNormals
+{
+  vtkPolyData *Mesh;
+  vtkPoints *Points;
+  float *PolyNormals;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts, *pts;
+    double n[3];
+    for (; cellId < endCellId; ++cellId)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      vtkPolygon::ComputeNormal(this->Points, npts, pts, n);
+      float *polyNormal = this->PolyNormals + 3 * cellId;
+      polyNormal[0] = static_cast<float>(n[0]);
+      polyNormal[1] = static_cast<float>(n[1]);
+      polyNormal[2] = static_cast<float>(n[2]);
+    }
+  }
+};
+
+// Flag the points where MarkAndSplit() creates new points, i.e. the points
+// whose cells form more than one region once separated by the feature edges.
+// This replays the region growing of MarkAndSplit() with a visited state
+// local to the point.
+struct vtkMarkFeaturePoints
+{
+  vtkPolyData *OldMesh;
+  vtkCellArray *Polys;
+  const float *PolyNormals;
+  double CosAngle;
+  unsigned char *Split;
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+  vtkSMPThreadLocal<std::vector<char> > Visited;
+
+  void GetCellPoints(vtkIdType cellId, vtkIdType &npts,
+                     const vtkIdType *&pts, vtkIdList *buffer)
+  {
+    if (this->Polys->IsOffsetsStorage())
+    {
+      this->Polys->GetCellAtId(cellId, npts, pts, buffer);
+    }
+    else
+    {
+      vtkIdType *cellPts;
+      this->OldMesh->GetCellPoints(cellId, npts, cellPts);
+      pts = cellPts;
+    }
+  }
+
+  // Position of ptId in the cell pts.
+  static vtkIdType FindSpot(vtkIdType ptId, vtkIdType npts,
+                            const vtkIdType *pts)
+  {
+    vtkIdType spot;
+    for (spot = 0; spot < npts - 1 && pts[spot] != ptId; ++spot)
+    {
+    }
+    return spot;
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    vtkIdList *cellIds = this->CellIds.Local();
+    vtkIdList *cellPts = this->CellPts.Local();
+    std::vector<char> &visited = this->Visited.Local();
+    vtkIdType npts, spot, neiPt[2], nei, cellId, neiCellId;
+    const vtkIdType *pts;
+    for (; ptId < endPtId; ++ptId)
+    {
+      unsigned short ncells;
+      vtkIdType *cells;
+      this->OldMesh->GetPointCells(ptId, ncells, cells);
+      this->Split[ptId] = 0;
+      if (ncells <= 1)
+      {
+        continue;
+      }
+
+      visited.assign(ncells, 0);
+      int numRegions = 0;
+      for (unsigned short j = 0; j < ncells && numRegions < 2; ++j)
+      {
+        if (visited[j])
+        {
+          continue;
+        }
+        visited[j] = 1;
+        numRegions++;
+
+        //find the two edges
+        this->GetCellPoints(cells[j], npts, pts, cellPts);
+        spot = vtkMarkFeaturePoints::FindSpot(ptId, npts, pts);
+        if (spot == 0)
+        {
+          neiPt[0] = pts[spot+1];
+          neiPt[1] = pts[npts-1];
+        }
+        else if (spot == (npts-1))
+        {
+          neiPt[0] = pts[spot-1];
+          neiPt[1] = pts[0];
+        }
+        else
+        {
+          neiPt[0] = pts[spot+1];
+          neiPt[1] = pts[spot-1];
+        }
+
+        for (int i = 0; i < 2; ++i) //for each of the two edges of the seed cell
+        {
+          cellId = cells[j];
+          nei = neiPt[i];
+          while (cellId >= 0) //while we can grow this region
+          {
+            this->OldMesh->GetCellEdgeNeighbors(cellId, ptId, nei, cellIds);
+            if (cellIds->GetNumberOfIds() != 1)
+            {
+              break;
+            }
+            neiCellId = cellIds->GetId(0);
+            unsigned short k = static_cast<unsigned short>(
+              std::find(cells, cells + ncells, neiCellId) - cells);
+            if (k == ncells || visited[k])
+            {
+              break;
+            }
+
+            double thisNormal[3], neiNormal[3];
+            for (int c = 0; c < 3; ++c)
+            {
+              thisNormal[c] = this->PolyNormals[3 * cellId + c];
+              neiNormal[c] = this->PolyNormals[3 * neiCellId + c];
+            }
+            if (vtkMath::Dot(thisNormal, neiNormal) <= this->CosAngle)
+            {
+              break; //separated by edge angle
+            }
+
+            //visit and arrange to visit next edge neighbor
+            visited[k] = 1;
+            cellId = neiCellId;
+            this->GetCellPoints(cellId, npts, pts, cellPts);
+            spot = vtkMarkFeaturePoints::FindSpot(ptId, npts, pts);
+            if (spot == 0)
+            {
+              nei = (pts[spot+1] != nei ? pts[spot+1] : pts[npts-1]);
+            }
+            else if (spot == (npts-1))
+            {
+              nei = (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
+            }
+            else
+            {
+              nei = (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
+            }
+          }
+        }
+      }
+      this->Split[ptId] = (numRegions > 1);
+    }
+  }
+};
+
+// Sum the normals of the polygons using each point, in increasing polygon id
+// order, and normalize.
+struct vtkAccumulatePointNormals
+{
+  vtkStaticCellLinksTemplate<vtkIdType> *Links;
+  const float *PolyNormals;
+  float *Normals;
+  double FlipDirection;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      const vtkIdType ncells = this->Links->GetNumberOfCells(ptId);
+      const vtkIdType *cells = this->Links->GetCells(ptId);
+      float *n = this->Normals + 3 * ptId;
+      n[0] = n[1] = n[2] = 0.0f;
+      for (vtkIdType i = 0; i < ncells; ++i)
+      {
+        const float *polyNormal = this->PolyNormals + 3 * cells[i];
+        n[0] += polyNormal[0];
+        n[1] += polyNormal[1];
+        n[2] += polyNormal[2];
+      }
+
+      const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) *
+        this->FlipDirection;
+      if (length != 0.0)
+      {
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+      }
+    }
+  }
+};
+
+}
+
 // Construct with feature angle=30, splitting and consistency turned on,
 // flipNormals turned off, and non-manifold traversal turned on.
 vtkPolyDataNormals::vtkPolyDataNormals()
@@ -46,6 +431,7 @@ vtkPolyDataNormals::vtkPolyDataNormals()
   // some internal data
   this->NumFlips = 0;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->Internals = nullptr;
   this->Wave = nullptr;
   this->Wave2 = nullptr;
   this->CellIds = nullptr;
@@ -57,9 +443,6 @@ vtkPolyDataNormals::vtkPolyDataNormals()
   this->CosAngle = 0.0;
 }
 
-#define VTK_CELL_NOT_VISITED     0
-#define VTK_CELL_VISITED         1
-
 // Generate normals for polygon meshes
 int vtkPolyDataNormals::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -185,6 +568,9 @@ int vtkPolyDataNormals::RequestData(
   // create a copy because we're modifying it
   newPolys = vtkCellArray::New();
   newPolys->DeepCopy(polys);
+  // The cells are reordered and split in place, concurrently for distinct
+  // cells, which requires the legacy storage.
+  newPolys->SetStorageTypeToLegacy();
   this->NewMesh->SetPolys(newPolys);
   this->NewMesh->BuildCells(); //builds connectivity
 
@@ -208,6 +594,10 @@ int vtkPolyDataNormals::RequestData(
   //  with its (already checked) neighbors.
   //
   this->NumFlips = 0;
+  if (this->Consistency || this->AutoOrientNormals)
+  {
+    this->Internals = new vtkInternals(numPolys);
+  }
   if (this->AutoOrientNormals)
   {
     // No need to check this->Consistency. It's implied.
@@ -336,7 +726,13 @@ int vtkPolyDataNormals::RequestData(
     }//Consistent ordering
   } // don't automatically orient normals
 
+  delete this->Internals;
+  this->Internals = nullptr;
+
   this->UpdateProgress(0.333);
+  // The parallel passes are not interrupted: an abort request skips the
+  // passes that follow it, which leaves the remaining normals null.
+  bool abort = this->GetAbortExecute() != 0;
 
   //  Initial pass to compute polygon normals without effects of neighbors
   //
@@ -346,20 +742,19 @@ int vtkPolyDataNormals::RequestData(
   this->PolyNormals->SetName("Normals");
   this->PolyNormals->SetNumberOfTuples(numPolys);
 
-  for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
-       cellId++ )
+  float *fPolyNormals = this->PolyNormals->WritePointer(0, 3 * numPolys);
+  vtkComputePolyNormals computePolyNormals = { this->NewMesh, inPts,
+    fPolyNormals };
+  if (!abort)
   {
-    if ((cellId % 1000) == 0)
-    {
-      this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
-      if (this->GetAbortExecute())
-      {
-        break;
-      }
-    }
-    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
-    this->PolyNormals->SetTuple(cellId,n);
+    vtkSMPTools::For(0, numPolys, computePolyNormals);
+  }
+  else
+  {
+    std::fill_n(fPolyNormals, 3 * numPolys, 0.0f);
   }
+  this->UpdateProgress(0.5);
+  abort = abort || this->GetAbortExecute();
 
   // Split mesh if sharp features
   if ( this->Splitting )
@@ -379,9 +774,27 @@ int vtkPolyDataNormals::RequestData(
       this->Map->SetId(i,i);
     }
 
+    // Find the points to split in parallel, then split them in order so
+    // that the new points are numbered as in a sequential run.
+    std::vector<unsigned char> split(numPts);
+    vtkMarkFeaturePoints markFeaturePoints;
+    markFeaturePoints.OldMesh = this->OldMesh;
+    markFeaturePoints.Polys = polys;
+    markFeaturePoints.PolyNormals = fPolyNormals;
+    markFeaturePoints.CosAngle = this->CosAngle;
+    markFeaturePoints.Split = split.data();
+    if (!abort)
+    {
+      vtkSMPTools::For(0, numPts, markFeaturePoints);
+    }
+    this->UpdateProgress(0.6);
+
     for (ptId=0; ptId < numPts; ptId++)
     {
-      this->MarkAndSplit(ptId);
+      if (split[ptId])
+      {
+        this->MarkAndSplit(ptId);
+      }
     }//for all input points
 
     numNewPts = this->Map->GetNumberOfIds();
@@ -441,6 +854,7 @@ int vtkPolyDataNormals::RequestData(
   }
 
   this->UpdateProgress(0.80);
+  abort = abort || this->GetAbortExecute();
 
   //  Finally, traverse all elements, computing polygon normals and
   //  accumulating them at the vertices.
@@ -457,34 +871,20 @@ int vtkPolyDataNormals::RequestData(
   float *fNormals = newNormals->WritePointer(0, 3 * numNewPts);
   std::fill_n(fNormals, 3 * numNewPts, 0);
 
-  float *fPolyNormals = this->PolyNormals->WritePointer(0, 3 * numPolys);
-
-  if (this->ComputePointNormals)
+  if (this->ComputePointNormals && !abort)
   {
-    for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);
-         ++cellId)
+    // Gather the polygon normals at each point through static links, which
+    // are sorted by polygon id: the sums are made in the same order as a
+    // sequential scatter over the polygons.
+    if (this->Splitting)
     {
-      for (vtkIdType i = 0; i < npts; ++i)
-      {
-        fNormals[3 * pts[i]] += fPolyNormals[3 * cellId];
-        fNormals[3 * pts[i] + 1] += fPolyNormals[3 * cellId + 1];
-        fNormals[3 * pts[i] + 2] += fPolyNormals[3 * cellId + 2];
-      }
-    }
-
-    for (vtkIdType i = 0; i < numNewPts; ++i)
-    {
-      const double length = sqrt(fNormals[3 * i] * fNormals[3 * i] +
-                                 fNormals[3 * i + 1] * fNormals[3 * i + 1] +
-                                 fNormals[3 * i + 2] * fNormals[3 * i + 2]
-                                 ) * flipDirection;
-      if (length != 0.0)
-      {
-        fNormals[3 * i] /= length;
-        fNormals[3 * i + 1] /= length;
-        fNormals[3 * i + 2] /= length;
-      }
+      this->NewMesh->SetPoints(newPts);
     }
+    vtkStaticCellLinksTemplate<vtkIdType> links;
+    links.BuildLinks(this->NewMesh);
+    vtkAccumulatePointNormals accumulate = { &links, fPolyNormals, fNormals,
+      flipDirection };
+    vtkSMPTools::For(0, numNewPts, accumulate);
   }
 
   //  Update ourselves.  If no new nodes have been created (i.e., no
@@ -532,60 +932,46 @@ int vtkPolyDataNormals::RequestData(
 //
 void vtkPolyDataNormals::TraverseAndOrder (void)
 {
-  vtkIdType i, k;
-  int j, l, j1;
-  vtkIdType numIds, cellId;
-  vtkIdType *pts, *neiPts, npts, numNeiPts;
-  vtkIdType neighbor;
+  vtkInternals *internals = this->Internals;
+  vtkIdType numIds;
   vtkIdList *tmpWave;
 
   // propagate wave until nothing left in wave
   while ( (numIds=this->Wave->GetNumberOfIds()) > 0 )
   {
-    for ( i=0; i < numIds; i++ )
+    vtkIdType grain = (numIds < VTK_SERIAL_WAVE_SIZE ? numIds : 0);
+
+    // Each cell reached by the wave is claimed by the first cell of the
+    // wave reaching it, which then checks its ordering.
+    vtkClaimWaveNeighbors claim = { this->OldMesh, this->NewMesh,
+      this->NonManifoldTraversal, this->Wave->GetPointer(0), this->Visited,
+      internals->Claims, &internals->CellIds };
+    vtkSMPTools::For(0, numIds, grain, claim);
+
+    internals->Counts.resize(numIds);
+    vtkOrderWaveNeighbors order = { this->OldMesh, this->NewMesh,
+      this->NonManifoldTraversal, this->Wave->GetPointer(0), this->Visited,
+      internals->Claims, internals->Counts.data(), &internals->CellIds,
+      &internals->Claimed, &internals->NumFlips };
+    vtkSMPTools::For(0, numIds, grain, order);
+
+    // The next wave lists the claimed cells by claiming cell, as they would
+    // have been found sequentially.
+    vtkIdType numNewIds = vtkSMPTools::ExclusiveScan(
+      internals->Counts.begin(), internals->Counts.end(),
+      internals->Counts.begin(), static_cast<vtkIdType>(0));
+    this->Wave2->SetNumberOfIds(numNewIds);
+    vtkIdType *wave2 = this->Wave2->GetPointer(0);
+    vtkSMPThreadLocal<std::vector<vtkIdType> >::iterator claimed;
+    for (claimed = internals->Claimed.begin();
+         claimed != internals->Claimed.end(); ++claimed)
     {
-      cellId = this->Wave->GetId(i);
-
-      this->NewMesh->GetCellPoints(cellId, npts, pts);
-
-      for (j = 0, j1 = 1; j < npts; ++j, (j1 = (++j1 < npts) ? j1 : 0)) //for each edge neighbor
+      for (size_t i = 0; i < claimed->size(); i += 2)
       {
-        this->OldMesh->GetCellEdgeNeighbors(cellId, pts[j], pts[j1], this->CellIds);
-
-        //  Check the direction of the neighbor ordering.  Should be
-        //  consistent with us (i.e., if we are n1->n2,
-        // neighbor should be n2->n1).
-        if ( this->CellIds->GetNumberOfIds() == 1 ||
-             this->NonManifoldTraversal )
-        {
-          for (k=0; k < this->CellIds->GetNumberOfIds(); k++)
-          {
-            if (this->Visited[this->CellIds->GetId(k)]==VTK_CELL_NOT_VISITED)
-            {
-              neighbor = this->CellIds->GetId(k);
-              this->NewMesh->GetCellPoints(neighbor,numNeiPts,neiPts);
-              for (l=0; l < numNeiPts; l++)
-              {
-                if (neiPts[l] == pts[j1])
-                {
-                  break;
-                }
-              }
-
-              //  Have to reverse ordering if neighbor not consistent
-              //
-              if ( neiPts[(l+1)%numNeiPts] != pts[j] )
-              {
-                this->NumFlips++;
-                this->NewMesh->ReverseCell(neighbor);
-              }
-              this->Visited[neighbor] = VTK_CELL_VISITED;
-              this->Wave2->InsertNextId(neighbor);
-            }// if cell not visited
-          } // for each edge neighbor
-        } //for manifold or non-manifold traversal allowed
-      } // for all edges of this polygon
-    } //for all cells in wave
+        wave2[internals->Counts[(*claimed)[i]]++] = (*claimed)[i + 1];
+      }
+      claimed->clear();
+    }
 
     //swap wave and proceed with propagation
     tmpWave = this->Wave;
@@ -593,6 +979,14 @@ void vtkPolyDataNormals::TraverseAndOrder (void)
     this->Wave2 = tmpWave;
     this->Wave2->Reset();
   } //while wave still propagating
+
+  vtkSMPThreadLocal<int>::iterator numFlips;
+  for (numFlips = internals->NumFlips.begin();
+       numFlips != internals->NumFlips.end(); ++numFlips)
+  {
+    this->NumFlips += *numFlips;
+    *numFlips = 0;
+  }
 }
 
 //
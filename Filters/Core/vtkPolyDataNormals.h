@@ -39,6 +39,12 @@
  * are split and new points generated to prevent blurry edges (due to
  * Gouraud shading).
  *
+ * The filter is multithreaded with vtkSMPTools: the polygon normals, the
+ * accumulation of the point normals, the detection of the points to split
+ * and the propagation of each wave of the consistency (and auto orient)
+ * traversal run in parallel. The output does not depend on the number of
+ * threads and is identical to the output of a sequential run.
+ *
  * @warning
  * Normals are computed only for polygons and triangle strips. Normals are
  * not computed for lines or vertices.
@@ -192,6 +198,8 @@ protected:
   int OutputPointsPrecision;
 
 private:
+  class vtkInternals;
+  vtkInternals *Internals;
   vtkIdList *Wave;
   vtkIdList *Wave2;
   vtkIdList *CellIds;
@@ -203,12 +211,14 @@ private:
   double CosAngle;
 
   // Uses the list of cell ids (this->Wave) to propagate a wave of
-  // checked and properly ordered polygons.
+  // checked and properly ordered polygons. Each wave is processed in
+  // parallel.
   void TraverseAndOrder(void);
 
   // Check the point id give to see whether it lies on a feature
   // edge. If so, split the point (i.e., duplicate it) to topologically
-  // separate the mesh.
+  // separate the mesh. Only called for the points flagged by the parallel
+  // feature detection pass.
   void MarkAndSplit(vtkIdType ptId);
 
 private:
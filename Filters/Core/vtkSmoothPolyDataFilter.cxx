@@ -16,6 +16,7 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellLinks.h"
 #include "vtkCellLocator.h"
 #include "vtkFloatArray.h"
 #include "vtkMath.h"
@@ -25,10 +26,15 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTriangleFilter.h"
 
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 vtkStandardNewMacro(vtkSmoothPolyDataFilter);
 
@@ -156,19 +162,265 @@ vtkPolyData *vtkSmoothPolyDataFilter::GetSource()
 #define VTK_FEATURE_EDGE_VERTEX 2
 #define VTK_BOUNDARY_EDGE_VERTEX 3
 
-namespace {
+// Type of the polygon edges already analyzed from a neighbor polygon
+#define VTK_VISITED_EDGE -1
 
-// Special structure for marking vertices
-typedef struct _vtkMeshVertex
+namespace
 {
-  char      type;
-  vtkIdList *edges; // connected edges (list of connected point ids)
-  _vtkMeshVertex()
+
+// The edges of the polygons of the mesh, from which the vertices connected
+// to each vertex are found. The type of the i-th edge of polygon cellId
+// (the type given to its end points, or VTK_VISITED_EDGE) is stored at
+// EdgeTypes[CellOffsets[cellId] + i].
+struct vtkMeshEdges
+{
+  vtkPolyData *Mesh;
+  vtkCellArray *Polys;
+  const vtkIdType *LineEdges;
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<signed char> EdgeTypes;
+
+  // Thread-safe access to the points of a polygon.
+  void GetPolyPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType *&pts,
+                     vtkIdList *buffer) const
   {
-    type = VTK_SIMPLE_VERTEX; //can smooth
-    edges = nullptr;
+    if (this->Polys->IsOffsetsStorage())
+    {
+      this->Polys->GetCellAtId(cellId, npts, pts, buffer);
+    }
+    else
+    {
+      vtkIdType *cellPts;
+      this->Mesh->GetCellPoints(cellId, npts, cellPts);
+      pts = cellPts;
+    }
   }
-} vtkMeshVertex, *vtkMeshVertexPtr;
+
+  // Update the type and the n connected vertices of a vertex for an edge
+  // of type edge joining it to vertex other. Only the first capacity
+  // connected vertices are stored in ids.
+  static void AddEdge(signed char edge, vtkIdType other, char &type,
+                      vtkIdType &n, vtkIdType *ids, vtkIdType capacity)
+  {
+    if ( edge && type == VTK_SIMPLE_VERTEX )
+    {
+      n = 0;
+      type = edge;
+    }
+    else if ( (edge && type == VTK_BOUNDARY_EDGE_VERTEX) ||
+              (edge && type == VTK_FEATURE_EDGE_VERTEX) ||
+              (!edge && type == VTK_SIMPLE_VERTEX) )
+    {
+      if ( type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+      {
+        type = VTK_BOUNDARY_EDGE_VERTEX;
+      }
+    }
+    else
+    {
+      return;
+    }
+    if ( n < capacity )
+    {
+      ids[n] = other;
+    }
+    n++;
+  }
+
+  // Return the number of vertices connected to vertex ptId, and store the
+  // first capacity of them in ids. The edges using the vertex are visited
+  // in the order of a traversal of the polygons, so that the type and the
+  // connected vertices are those of a serial analysis of the polygons.
+  vtkIdType ConnectVertex(vtkIdType ptId, char &type, vtkIdType *ids,
+                          vtkIdType capacity, vtkIdList *buffer) const
+  {
+    vtkIdType n = 0;
+    if ( type == VTK_FEATURE_EDGE_VERTEX ) // inside a line
+    {
+      for (; n < 2; n++)
+      {
+        if ( n < capacity )
+        {
+          ids[n] = this->LineEdges[2*ptId+n];
+        }
+      }
+    }
+    if ( !this->Mesh )
+    {
+      return n;
+    }
+
+    // The cells of the links are sorted, and a polygon using the vertex
+    // several times is listed several times
+    const vtkCellLinks::Link &link = this->Mesh->GetCellLinks()->GetLink(ptId);
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (vtkIdType c=0; c < link.ncells; c++)
+    {
+      vtkIdType cellId = link.cells[c];
+      if ( c > 0 && cellId == link.cells[c-1] )
+      {
+        continue;
+      }
+      this->GetPolyPoints(cellId, npts, pts, buffer);
+      const signed char *edgeTypes =
+        this->EdgeTypes.data() + this->CellOffsets[cellId];
+      for (vtkIdType i=0; i < npts; i++)
+      {
+        if ( edgeTypes[i] == VTK_VISITED_EDGE )
+        {
+          continue;
+        }
+        vtkIdType p1 = pts[i];
+        vtkIdType p2 = pts[(i+1)%npts];
+        if ( p1 == ptId )
+        {
+          AddEdge(edgeTypes[i], p2, type, n, ids, capacity);
+        }
+        if ( p2 == ptId )
+        {
+          AddEdge(edgeTypes[i], p1, type, n, ids, capacity);
+        }
+      }
+    }
+    return n;
+  }
+
+  // Find the type of the edges of the polygons in parallel. This requires
+  // the links of the mesh.
+  void ClassifyEdges(vtkPoints *inPts, int featureEdgeSmoothing,
+                     double cosFeatureAngle)
+  {
+    vtkIdType numPolys = this->Polys->GetNumberOfCells();
+    vtkSMPThreadLocalObject<vtkIdList> cellPts;
+    this->CellOffsets.resize(numPolys + 1);
+    vtkSMPTools::For(0, numPolys, [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      vtkIdType npts;
+      const vtkIdType *pts;
+      for (; cellId < endCellId; cellId++)
+      {
+        this->GetPolyPoints(cellId, npts, pts, buffer);
+        this->CellOffsets[cellId] = npts;
+      }
+    });
+    this->CellOffsets[numPolys] = vtkSMPTools::ExclusiveScan(
+      this->CellOffsets.begin(), this->CellOffsets.begin() + numPolys,
+      this->CellOffsets.begin(), static_cast<vtkIdType>(0));
+    this->EdgeTypes.resize(this->CellOffsets[numPolys]);
+
+    vtkSMPThreadLocalObject<vtkIdList> neiCellPts, neighbors;
+    vtkSMPTools::For(0, numPolys, [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      vtkIdList *neiBuffer = neiCellPts.Local();
+      vtkIdList *cellIds = neighbors.Local();
+      vtkIdType npts, numNeiPts, numNei, j;
+      const vtkIdType *pts, *neiPts;
+      double normal[3], neiNormal[3];
+      for (; cellId < endCellId; cellId++)
+      {
+        this->GetPolyPoints(cellId, npts, pts, buffer);
+        signed char *edgeTypes =
+          this->EdgeTypes.data() + this->CellOffsets[cellId];
+        for (vtkIdType i=0; i < npts; i++)
+        {
+          this->Mesh->GetCellEdgeNeighbors(cellId, pts[i], pts[(i+1)%npts],
+                                           cellIds);
+          numNei = cellIds->GetNumberOfIds();
+
+          signed char edge = VTK_SIMPLE_VERTEX;
+          if ( numNei == 0 )
+          {
+            edge = VTK_BOUNDARY_EDGE_VERTEX;
+          }
+
+          else if ( numNei >= 2 )
+          {
+            // check to make sure that this edge hasn't been marked already
+            for (j=0; j < numNei; j++)
+            {
+              if ( cellIds->GetId(j) < cellId )
+              {
+                break;
+              }
+            }
+            if ( j >= numNei )
+            {
+              edge = VTK_FEATURE_EDGE_VERTEX;
+            }
+          }
+
+          else if ( numNei == 1 && cellIds->GetId(0) > cellId )
+          {
+            if ( featureEdgeSmoothing )
+            {
+              vtkPolygon::ComputeNormal(inPts, static_cast<int>(npts),
+                                        const_cast<vtkIdType*>(pts), normal);
+              this->GetPolyPoints(cellIds->GetId(0), numNeiPts, neiPts,
+                                  neiBuffer);
+              vtkPolygon::ComputeNormal(inPts, static_cast<int>(numNeiPts),
+                                        const_cast<vtkIdType*>(neiPts),
+                                        neiNormal);
+
+              if ( vtkMath::Dot(normal,neiNormal) <= cosFeatureAngle )
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
+              }
+            }
+          }
+          else // a visited edge; skip rest of analysis
+          {
+            edge = VTK_VISITED_EDGE;
+          }
+          edgeTypes[i] = edge;
+        }
+      }
+    });
+  }
+
+  // Find the final type and the connected vertices of every vertex in
+  // parallel: the connected vertices of vertex i are
+  // ids[offsets[i]] .. ids[offsets[i+1]-1].
+  void ConnectVertices(std::vector<char> &types,
+                       std::vector<vtkIdType> &offsets,
+                       std::vector<vtkIdType> &ids) const
+  {
+    vtkIdType numPts = static_cast<vtkIdType>(types.size());
+    vtkSMPThreadLocalObject<vtkIdList> cellPts;
+    offsets.resize(numPts + 1);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      for (; ptId < endPtId; ptId++)
+      {
+        char type = types[ptId];
+        offsets[ptId] = this->ConnectVertex(ptId, type, nullptr, 0, buffer);
+      }
+    });
+    offsets[numPts] = vtkSMPTools::ExclusiveScan(
+      offsets.begin(), offsets.begin() + numPts, offsets.begin(),
+      static_cast<vtkIdType>(0));
+
+    ids.resize(offsets[numPts]);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      for (; ptId < endPtId; ptId++)
+      {
+        this->ConnectVertex(ptId, types[ptId], ids.data() + offsets[ptId],
+                            offsets[ptId+1] - offsets[ptId], buffer);
+      }
+    });
+  }
+};
+
+// Number of vertices of each type found by the topological analysis
+struct vtkVertexCounts
+{
+  vtkIdType Simple, FEdges, BEdges, Fixed;
+};
 
 template<typename T> struct vtkSPDF_InternalParams
 {
@@ -178,13 +430,142 @@ template<typename T> struct vtkSPDF_InternalParams
   T factor;
   T conv;
   vtkIdType numPts;
-  vtkMeshVertexPtr vertexPtr;
+  const char *types;
+  const vtkIdType *edgeOffsets;
+  const vtkIdType *edgeIds;
   vtkPolyData *source;
   vtkSmoothPoints *SmoothPoints;
   double *w;
   vtkCellLocator *cellLocator;
+  // Movable points sorted by wavefront, or nullptr for a serial sweep
+  const vtkIdType *waveOffsets;
+  const vtkIdType *wavePts;
+  vtkIdType numWaves;
 };
 
+// The points are moved in place (Gauss-Seidel), so a point sees the new
+// position of its neighbors of lower id and the old position of the others.
+// The sweep is parallelized without changing this: the movable points are
+// grouped in wavefronts, each point being in a later wavefront than its
+// movable neighbors of lower id, so that the points of a wavefront do not
+// depend on each other and can be moved concurrently.
+void vtkSPDF_BuildWavefronts(vtkIdType numPts, const char *types,
+                             const vtkIdType *edgeOffsets,
+                             const vtkIdType *edgeIds,
+                             std::vector<vtkIdType> &waveOffsets,
+                             std::vector<vtkIdType> &wavePts)
+{
+  std::vector<vtkIdType> waves(numPts, -1);
+  vtkIdType numWaves = 0;
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    if (types[i] == VTK_FIXED_VERTEX || edgeOffsets[i+1] == edgeOffsets[i])
+    {
+      continue;
+    }
+    // the movable points of lower id connected to i have pushed it already
+    vtkIdType wave = std::max(waves[i], static_cast<vtkIdType>(0));
+    for (vtkIdType j = edgeOffsets[i]; j < edgeOffsets[i+1]; ++j)
+    {
+      if (edgeIds[j] < i && waves[edgeIds[j]] >= 0)
+      {
+        wave = std::max(wave, waves[edgeIds[j]] + 1);
+      }
+    }
+    waves[i] = wave;
+    for (vtkIdType j = edgeOffsets[i]; j < edgeOffsets[i+1]; ++j)
+    {
+      vtkIdType nei = edgeIds[j];
+      if (nei > i && types[nei] != VTK_FIXED_VERTEX &&
+          edgeOffsets[nei+1] != edgeOffsets[nei])
+      {
+        waves[nei] = std::max(waves[nei], wave + 1);
+      }
+    }
+    numWaves = std::max(numWaves, wave + 1);
+  }
+
+  // Counting sort of the points by wavefront
+  waveOffsets.assign(numWaves + 1, 0);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    if (waves[i] >= 0)
+    {
+      waveOffsets[waves[i]+1]++;
+    }
+  }
+  for (vtkIdType wave = 0; wave < numWaves; ++wave)
+  {
+    waveOffsets[wave+1] += waveOffsets[wave];
+  }
+  wavePts.resize(waveOffsets[numWaves]);
+  std::vector<vtkIdType> next(waveOffsets.begin(), waveOffsets.end() - 1);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    if (waves[i] >= 0)
+    {
+      wavePts[next[waves[i]]++] = i;
+    }
+  }
+}
+
+// Move the point i toward the mean position of its npts connected
+// neighbors using the relaxation factor. Return the norm of the mean
+// (cumulated) direction vector.
+template<typename T> T vtkSPDF_MovePoint(vtkSPDF_InternalParams<T>& params,
+                                         T *start, vtkIdType i,
+                                         vtkIdType npts)
+{
+  T deltaX[3];
+  double dist2, xNew[3], closestPt[3];
+  deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+  const vtkIdType *edgeIdPtr = params.edgeIds + params.edgeOffsets[i];
+  // Compute the mean (cumulated) direction vector
+  for (vtkIdType j = 0; j < npts; ++j)
+  {
+    for (unsigned short k = 0; k < 3; ++k)
+    {
+      deltaX[k] += *(start + 3 * (*edgeIdPtr) + k);
+    }
+    ++edgeIdPtr;
+  }//for all connected points
+
+  // Move the point
+  T *newPtsCoords = start + 3 * i;
+  for (unsigned short k = 0; k < 3; ++k)
+  {
+    *newPtsCoords += params.factor * (deltaX[k] / npts - (*newPtsCoords));
+    xNew[k] = *newPtsCoords;
+    ++newPtsCoords;
+  }
+
+  // Constrain point to surface
+  if (params.source)
+  {
+    vtkSmoothPoint *sPtr = params.SmoothPoints->GetSmoothPoint(i);
+    vtkCell *cell = nullptr;
+
+    if (sPtr->cellId >= 0) //in cell
+    {
+      cell = params.source->GetCell(sPtr->cellId);
+    }
+
+    if (!cell || cell->EvaluatePosition(xNew, closestPt,
+        sPtr->subId, sPtr->p, dist2, params.w) == 0)
+    { // not in cell anymore
+      params.cellLocator->FindClosestPoint(xNew, closestPt, sPtr->cellId,
+                                           sPtr->subId, dist2);
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      xNew[k] = closestPt[k];
+    }
+    params.newPts->SetPoint(i, xNew);
+  }
+
+  return vtkMath::Norm(deltaX);
+}
+
 template<typename T> void vtkSPDF_MovePoints(vtkSPDF_InternalParams<T>& params)
 {
   int iterationNumber = 0;
@@ -202,78 +583,57 @@ template<typename T> void vtkSPDF_MovePoints(vtkSPDF_InternalParams<T>& params)
     }
 
     maxDist = 0.0;
-    T* newPtsCoords = static_cast<T*>(params.newPts->GetVoidPointer(0));
-    T* start = newPtsCoords;
-    vtkMeshVertexPtr vertsPtr = params.vertexPtr;
-    vtkIdType npts, *edgeIdPtr;
-    T dist, deltaX[3];
-    double dist2, xNew[3], closestPt[3];
-
-    // For each non-fixed vertex of the mesh, move the point toward the mean
-    // position of its connected neighbors using the relaxation factor.
-    for (vtkIdType i = 0; i < params.numPts; ++i)
-    {
-      if (vertsPtr->type != VTK_FIXED_VERTEX && vertsPtr->edges != nullptr &&
-         (npts = vertsPtr->edges->GetNumberOfIds()) > 0)
+    T* start = static_cast<T*>(params.newPts->GetVoidPointer(0));
+    T dist;
+
+    if (!params.waveOffsets)
+    {
+      // For each non-fixed vertex of the mesh, move the point toward the
+      // mean position of its connected neighbors using the relaxation factor.
+      for (vtkIdType i = 0; i < params.numPts; ++i)
       {
-        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-        edgeIdPtr = vertsPtr->edges->GetPointer(0);
-        // Compute the mean (cumulated) direction vector
-        for (vtkIdType j = 0; j < npts; ++j)
+        vtkIdType npts = params.edgeOffsets[i+1] - params.edgeOffsets[i];
+        if (params.types[i] != VTK_FIXED_VERTEX && npts > 0)
         {
-          for (unsigned short k = 0; k < 3; ++k)
+          if ((dist = vtkSPDF_MovePoint(params, start, i, npts)) > maxDist)
           {
-            deltaX[k] += *(start + 3 * (*edgeIdPtr) + k);
+            maxDist = dist;
           }
-          ++edgeIdPtr;
-        }//for all connected points
-
-        // Move the point
-        *newPtsCoords += params.factor * (deltaX[0] / npts - (*newPtsCoords));
-        xNew[0] = *newPtsCoords;
-        ++newPtsCoords;
-        *newPtsCoords += params.factor * (deltaX[1] / npts - (*newPtsCoords));
-        xNew[1] = *newPtsCoords;
-        ++newPtsCoords;
-        *newPtsCoords += params.factor * (deltaX[2] / npts - (*newPtsCoords));
-        xNew[2] = *newPtsCoords;
-        ++newPtsCoords;
-
-        // Constrain point to surface
-        if (params.source)
+        }//if can move point
+      }//for all points
+    }
+    else
+    {
+      // Move the points of each wavefront in parallel. Small wavefronts are
+      // moved by the calling thread.
+      vtkSMPThreadLocal<T> maxDists(0.0);
+      for (vtkIdType wave = 0; wave < params.numWaves; ++wave)
+      {
+        vtkSMPTools::For(params.waveOffsets[wave], params.waveOffsets[wave+1],
+                         1024, [&](vtkIdType idx, vtkIdType endIdx)
         {
-          vtkSmoothPoint *sPtr = params.SmoothPoints->GetSmoothPoint(i);
-          vtkCell *cell = nullptr;
-
-          if (sPtr->cellId >= 0) //in cell
-          {
-            cell = params.source->GetCell(sPtr->cellId);
-          }
-
-          if (!cell || cell->EvaluatePosition(xNew, closestPt,
-              sPtr->subId, sPtr->p, dist2, params.w) == 0)
-          { // not in cell anymore
-            params.cellLocator->FindClosestPoint(xNew, closestPt, sPtr->cellId,
-                                                 sPtr->subId, dist2);
-          }
-          for (int k = 0; k < 3; ++k)
+          T& localMaxDist = maxDists.Local();
+          for (; idx < endIdx; ++idx)
           {
-            xNew[k] = closestPt[k];
+            vtkIdType i = params.wavePts[idx];
+            T d = vtkSPDF_MovePoint(params, start, i,
+                                    params.edgeOffsets[i+1] - params.edgeOffsets[i]);
+            if (d > localMaxDist)
+            {
+              localMaxDist = d;
+            }
           }
-          params.newPts->SetPoint(i, xNew);
-        }
-
-        if ((dist = vtkMath::Norm(deltaX)) > maxDist)
-        {
-          maxDist = dist;
-        }
-      }//if can move point
-        else
+        });
+      }
+      for (typename vtkSMPThreadLocal<T>::iterator localMaxDist =
+             maxDists.begin(); localMaxDist != maxDists.end(); ++localMaxDist)
+      {
+        if (*localMaxDist > maxDist)
         {
-          newPtsCoords += 3;
+          maxDist = *localMaxDist;
         }
-        ++vertsPtr;
-    }//for all points
+      }
+    }
   }//for not converged or within iteration count
 
   vtkDebugWithObjectMacro(params.spdf, << "Performed " << iterationNumber << " smoothing passes");
@@ -304,12 +664,10 @@ int vtkSmoothPolyDataFilter::RequestData(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
   vtkIdType numPts, numCells, i, numPolys, numStrips;
-  int j, k;
+  int j;
   vtkIdType npts = 0;
   vtkIdType *pts = nullptr;
-  vtkIdType p1, p2;
   double conv;
-  double x1[3], x2[3], x3[3], l1[3], l2[3];
   double CosFeatureAngle; //Cosine of angle between adjacent polys
   double CosEdgeAngle; // Cosine of angle between adjacent edges
   double closestPt[3], dist2, *w = nullptr;
@@ -319,7 +677,6 @@ int vtkSmoothPolyDataFilter::RequestData(
   vtkTriangleFilter *toTris=nullptr;
   vtkCellArray *inVerts, *inLines, *inPolys, *inStrips;
   vtkPoints *newPts;
-  vtkMeshVertexPtr Verts;
   vtkCellLocator *cellLocator=nullptr;
 
   // Check input
@@ -362,7 +719,8 @@ int vtkSmoothPolyDataFilter::RequestData(
   // using a subset of the attached vertices.
   //
   vtkDebugMacro(<<"Analyzing topology...");
-  Verts = new vtkMeshVertex[numPts];
+  std::vector<char> types(numPts, VTK_SIMPLE_VERTEX); //can smooth
+  std::vector<vtkIdType> lineEdges; // the neighbors of the vertices in lines
 
   inPts = input->GetPoints();
   conv = this->Convergence * input->GetLength();
@@ -373,44 +731,38 @@ int vtkSmoothPolyDataFilter::RequestData(
   {
     for (j=0; j<npts; j++)
     {
-      Verts[pts[j]].type = VTK_FIXED_VERTEX;
+      types[pts[j]] = VTK_FIXED_VERTEX;
     }
   }
   this->UpdateProgress(0.10);
 
   // now check lines. Only manifold lines can be smoothed------------
-  for (inLines=input->GetLines(), inLines->InitTraversal();
-  inLines->GetNextCell(npts,pts); )
+  inLines=input->GetLines();
+  if ( inLines->GetNumberOfCells() > 0 )
+  {
+    lineEdges.resize(2*numPts);
+  }
+  for (inLines->InitTraversal(); inLines->GetNextCell(npts,pts); )
   {
     for (j=0; j<npts; j++)
     {
-      if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
+      if ( types[pts[j]] == VTK_SIMPLE_VERTEX )
       {
-        if ( j == (npts-1) ) //end-of-line marked FIXED
-        {
-          Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        }
-        else if ( j == 0 ) //beginning-of-line marked FIXED
+        if ( j == (npts-1) || j == 0 ) //end- or beginning-of-line marked FIXED
         {
-          Verts[pts[0]].type = VTK_FIXED_VERTEX;
-          inPts->GetPoint(pts[0],x2);
-          inPts->GetPoint(pts[1],x3);
+          types[pts[j]] = VTK_FIXED_VERTEX;
         }
         else //is edge vertex (unless already edge vertex!)
         {
-          Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
-          Verts[pts[j]].edges = vtkIdList::New();
-          Verts[pts[j]].edges->SetNumberOfIds(2);
-          Verts[pts[j]].edges->SetId(0,pts[j-1]);
-          Verts[pts[j]].edges->SetId(1,pts[j+1]);
+          types[pts[j]] = VTK_FEATURE_EDGE_VERTEX;
+          lineEdges[2*pts[j]] = pts[j-1];
+          lineEdges[2*pts[j]+1] = pts[j+1];
         }
       } //if simple vertex
 
-      else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
+      else if ( types[pts[j]] == VTK_FEATURE_EDGE_VERTEX )
       { //multiply connected, becomes fixed!
-        Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        Verts[pts[j]].edges->Delete();
-        Verts[pts[j]].edges = nullptr;
+        types[pts[j]] = VTK_FIXED_VERTEX;
       }
 
     } //for all points in this line
@@ -418,30 +770,25 @@ int vtkSmoothPolyDataFilter::RequestData(
   this->UpdateProgress(0.25);
 
   // now polygons and triangle strips-------------------------------
+  vtkMeshEdges edges;
+  edges.Mesh = nullptr;
+  edges.Polys = nullptr;
+  edges.LineEdges = lineEdges.data();
+
   inPolys=input->GetPolys();
   numPolys = inPolys->GetNumberOfCells();
   inStrips=input->GetStrips();
   numStrips = inStrips->GetNumberOfCells();
 
+  inMesh = nullptr;
   if ( numPolys > 0 || numStrips > 0 )
   { //build cell structure
-    vtkCellArray *polys;
-    vtkIdType cellId;
-    int numNei, nei, edge;
-    vtkIdType numNeiPts;
-    vtkIdType *neiPts;
-    double normal[3], neiNormal[3];
-    vtkIdList *neighbors;
-
-    neighbors = vtkIdList::New();
-    neighbors->Allocate(VTK_CELL_SIZE);
-
     inMesh = vtkPolyData::New();
     inMesh->SetPoints(inPts);
     inMesh->SetPolys(inPolys);
     Mesh = inMesh;
 
-    if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
+    if ( numStrips > 0 )
     { // convert data to triangles
       inMesh->SetStrips(inStrips);
       toTris = vtkTriangleFilter::New();
@@ -451,178 +798,107 @@ int vtkSmoothPolyDataFilter::RequestData(
     }
 
     Mesh->BuildLinks(); //to do neighborhood searching
-    polys = Mesh->GetPolys();
     this->UpdateProgress(0.375);
 
-    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
-    cellId++)
-    {
-      for (i=0; i < npts; i++)
-      {
-        p1 = pts[i];
-        p2 = pts[(i+1)%npts];
-
-        if ( Verts[p1].edges == nullptr )
-        {
-          Verts[p1].edges = vtkIdList::New();
-          Verts[p1].edges->Allocate(16,6);
-        }
-        if ( Verts[p2].edges == nullptr )
-        {
-          Verts[p2].edges = vtkIdList::New();
-          Verts[p2].edges->Allocate(16,6);
-        }
-
-        Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
-        numNei = neighbors->GetNumberOfIds();
-
-        edge = VTK_SIMPLE_VERTEX;
-        if ( numNei == 0 )
-        {
-          edge = VTK_BOUNDARY_EDGE_VERTEX;
-        }
-
-        else if ( numNei >= 2 )
-        {
-          // check to make sure that this edge hasn't been marked already
-          for (j=0; j < numNei; j++)
-          {
-            if ( neighbors->GetId(j) < cellId )
-            {
-              break;
-            }
-          }
-          if ( j >= numNei )
-          {
-            edge = VTK_FEATURE_EDGE_VERTEX;
-          }
-        }
-
-        else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
-        {
-          if (this->FeatureEdgeSmoothing)
-          {
-            vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
-            Mesh->GetCellPoints(nei,numNeiPts,neiPts);
-            vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
-
-            if (vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle)
-            {
-              edge = VTK_FEATURE_EDGE_VERTEX;
-            }
-          }
-        }
-        else // a visited edge; skip rest of analysis
-        {
-          continue;
-        }
-
-        if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p1].edges->Reset();
-          Verts[p1].edges->InsertNextId(p2);
-          Verts[p1].type = edge;
-        }
-        else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
-        (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p1].edges->InsertNextId(p2);
-          if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
-          {
-            Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
-          }
-        }
+    edges.Mesh = Mesh;
+    edges.Polys = Mesh->GetPolys();
+    edges.ClassifyEdges(inPts, this->FeatureEdgeSmoothing, CosFeatureAngle);
+  }//if strips or polys
 
-        if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p2].edges->Reset();
-          Verts[p2].edges->InsertNextId(p1);
-          Verts[p2].type = edge;
-        }
-        else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
-        (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p2].edges->InsertNextId(p1);
-          if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
-          {
-            Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
-          }
-        }
-      }
-    }
+  // the vertices connected to vertex i are
+  // edgeIds[edgeOffsets[i]] .. edgeIds[edgeOffsets[i+1]-1]
+  std::vector<vtkIdType> edgeOffsets, edgeIds;
+  edges.ConnectVertices(types, edgeOffsets, edgeIds);
 
+  if (toTris)
+  {
+    toTris->Delete();
+  }
+  if (inMesh)
+  {
     inMesh->Delete();
-    if (toTris) {toTris->Delete();}
-
-    neighbors->Delete();
-  }//if strips or polys
+  }
 
   this->UpdateProgress(0.50);
 
   //post-process edge vertices to make sure we can smooth them
-  for (i=0; i<numPts; i++)
+  vtkVertexCounts noVertices = {0, 0, 0, 0};
+  vtkSMPThreadLocal<vtkVertexCounts> counts(noVertices);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
   {
-    if ( Verts[i].type == VTK_SIMPLE_VERTEX )
-    {
-      numSimple++;
-    }
-
-    else if ( Verts[i].type == VTK_FIXED_VERTEX )
+    vtkVertexCounts &count = counts.Local();
+    double x1[3], x2[3], x3[3], l1[3], l2[3];
+    for (; ptId < endPtId; ptId++)
     {
-      numFixed++;
-    }
-
-    else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
-    Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
-    { //see how many edges; if two, what the angle is
-
-      if ( !this->BoundarySmoothing &&
-      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      char &type = types[ptId];
+      if ( type == VTK_SIMPLE_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numBEdges++;
+        count.Simple++;
       }
 
-      else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
+      else if ( type == VTK_FIXED_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numFixed++;
+        count.Fixed++;
       }
 
-      else //check angle between edges
-      {
-        inPts->GetPoint(Verts[i].edges->GetId(0),x1);
-        inPts->GetPoint(i,x2);
-        inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+      else if ( type == VTK_FEATURE_EDGE_VERTEX ||
+      type == VTK_BOUNDARY_EDGE_VERTEX )
+      { //see how many edges; if two, what the angle is
 
-        for (k=0; k<3; k++)
+        if ( !this->BoundarySmoothing &&
+        type == VTK_BOUNDARY_EDGE_VERTEX )
         {
-          l1[k] = x2[k] - x1[k];
-          l2[k] = x3[k] - x2[k];
+          type = VTK_FIXED_VERTEX;
+          count.BEdges++;
         }
-        if ( vtkMath::Normalize(l1) >= 0.0 &&
-             vtkMath::Normalize(l2) >= 0.0 &&
-             vtkMath::Dot(l1,l2) < CosEdgeAngle)
+
+        else if ( edgeOffsets[ptId+1] - edgeOffsets[ptId] != 2 )
         {
-          numFixed++;
-          Verts[i].type = VTK_FIXED_VERTEX;
+          type = VTK_FIXED_VERTEX;
+          count.Fixed++;
         }
-        else
+
+        else //check angle between edges
         {
-          if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+          inPts->GetPoint(edgeIds[edgeOffsets[ptId]],x1);
+          inPts->GetPoint(ptId,x2);
+          inPts->GetPoint(edgeIds[edgeOffsets[ptId]+1],x3);
+
+          for (int k=0; k<3; k++)
+          {
+            l1[k] = x2[k] - x1[k];
+            l2[k] = x3[k] - x2[k];
+          }
+          if ( vtkMath::Normalize(l1) >= 0.0 &&
+               vtkMath::Normalize(l2) >= 0.0 &&
+               vtkMath::Dot(l1,l2) < CosEdgeAngle)
           {
-            numFEdges++;
+            count.Fixed++;
+            type = VTK_FIXED_VERTEX;
           }
           else
           {
-            numBEdges++;
+            if ( type == VTK_FEATURE_EDGE_VERTEX )
+            {
+              count.FEdges++;
+            }
+            else
+            {
+              count.BEdges++;
+            }
           }
-        }
-      }//if along edge
-    }//if edge vertex
-  }//for all points
+        }//if along edge
+      }//if edge vertex
+    }//for all points
+  });
+  for (vtkSMPThreadLocal<vtkVertexCounts>::iterator count = counts.begin();
+       count != counts.end(); ++count)
+  {
+    numSimple += count->Simple;
+    numFEdges += count->FEdges;
+    numBEdges += count->BEdges;
+    numFixed += count->Fixed;
+  }
 
   vtkDebugMacro(<<"Found\n\t" << numSimple << " simple vertices\n\t"
                 << numFEdges << " feature edge vertices\n\t"
@@ -653,6 +929,7 @@ int vtkSmoothPolyDataFilter::RequestData(
 
   // If Source defined, we do constrained smoothing (that is, points are
   // constrained to the surface of the mesh object).
+  std::vector<vtkIdType> waveOffsets, wavePts;
   if ( source )
   {
     this->SmoothPoints = new vtkSmoothPoints;
@@ -673,9 +950,22 @@ int vtkSmoothPolyDataFilter::RequestData(
   }
   else //smooth normally
   {
-    for (i=0; i<numPts; i++) //initialize to old coordinates
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      double x[3];
+      for (; ptId < endPtId; ptId++) //initialize to old coordinates
+      {
+        inPts->GetPoint(ptId, x);
+        newPts->SetPoint(ptId, x);
+      }
+    });
+
+    // The unconstrained sweeps are done in parallel, by wavefronts. The
+    // constrained ones use a cell locator that is not thread-safe.
+    if (vtkSMPTools::GetEstimatedNumberOfThreads() > 1)
     {
-      newPts->SetPoint(i,inPts->GetPoint(i));
+      vtkSPDF_BuildWavefronts(numPts, types.data(), edgeOffsets.data(),
+                              edgeIds.data(), waveOffsets, wavePts);
     }
   }
 
@@ -683,8 +973,12 @@ int vtkSmoothPolyDataFilter::RequestData(
   {
     vtkSPDF_InternalParams<double> params = { this, this->NumberOfIterations, newPts,
                                               this->RelaxationFactor, conv, numPts,
-                                              Verts, source, this->SmoothPoints,
-                                              w, cellLocator };
+                                              types.data(), edgeOffsets.data(),
+                                              edgeIds.data(), source,
+                                              this->SmoothPoints, w, cellLocator,
+                                              waveOffsets.empty() ? nullptr : waveOffsets.data(),
+                                              wavePts.data(),
+                                              static_cast<vtkIdType>(waveOffsets.size()) - 1 };
 
     vtkSPDF_MovePoints(params);
   }
@@ -692,8 +986,13 @@ int vtkSmoothPolyDataFilter::RequestData(
   {
     vtkSPDF_InternalParams<float> params = { this, this->NumberOfIterations, newPts,
                                              static_cast<float>(this->RelaxationFactor),
-                                             static_cast<float>(conv), numPts, Verts,
-                                             source, this->SmoothPoints, w, cellLocator };
+                                             static_cast<float>(conv), numPts,
+                                             types.data(), edgeOffsets.data(),
+                                             edgeIds.data(), source,
+                                             this->SmoothPoints, w, cellLocator,
+                                             waveOffsets.empty() ? nullptr : waveOffsets.data(),
+                                             wavePts.data(),
+                                             static_cast<vtkIdType>(waveOffsets.size()) - 1 };
 
     vtkSPDF_MovePoints(params);
   }
@@ -702,6 +1001,7 @@ int vtkSmoothPolyDataFilter::RequestData(
   {
     cellLocator->Delete();
     delete this->SmoothPoints;
+    this->SmoothPoints = nullptr;
     delete [] w;
   }
 
@@ -710,39 +1010,57 @@ int vtkSmoothPolyDataFilter::RequestData(
   output->GetPointData()->PassData(input->GetPointData());
   output->GetCellData()->PassData(input->GetCellData());
 
-  if ( this->GenerateErrorScalars )
+  if ( this->GenerateErrorScalars || this->GenerateErrorVectors )
   {
-    vtkFloatArray *newScalars = vtkFloatArray::New();
-    newScalars->SetNumberOfTuples(numPts);
-    for (i=0; i<numPts; i++)
+    vtkFloatArray *newScalars = nullptr, *newVectors = nullptr;
+    float *scalars = nullptr, *vectors = nullptr;
+    if ( this->GenerateErrorScalars )
     {
-      inPts->GetPoint(i,x1);
-      newPts->GetPoint(i,x2);
-      newScalars->SetComponent(i,0,
-                               sqrt(vtkMath::Distance2BetweenPoints(x1,x2)));
+      newScalars = vtkFloatArray::New();
+      newScalars->SetNumberOfTuples(numPts);
+      scalars = newScalars->GetPointer(0);
+    }
+    if ( this->GenerateErrorVectors )
+    {
+      newVectors = vtkFloatArray::New();
+      newVectors->SetNumberOfComponents(3);
+      newVectors->SetNumberOfTuples(numPts);
+      vectors = newVectors->GetPointer(0);
     }
-    int idx = output->GetPointData()->AddArray(newScalars);
-    output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
-  }
 
-  if ( this->GenerateErrorVectors )
-  {
-    vtkFloatArray *newVectors = vtkFloatArray::New();
-    newVectors->SetNumberOfComponents(3);
-    newVectors->SetNumberOfTuples(numPts);
-    for (i=0; i<numPts; i++)
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
     {
-      inPts->GetPoint(i,x1);
-      newPts->GetPoint(i,x2);
-      for (j=0; j<3; j++)
+      double x1[3], x2[3];
+      for (; ptId < endPtId; ptId++)
       {
-        x3[j] = x2[j] - x1[j];
+        inPts->GetPoint(ptId,x1);
+        newPts->GetPoint(ptId,x2);
+        if ( scalars )
+        {
+          scalars[ptId] = static_cast<float>(
+            sqrt(vtkMath::Distance2BetweenPoints(x1,x2)));
+        }
+        if ( vectors )
+        {
+          for (int k=0; k<3; k++)
+          {
+            vectors[3*ptId+k] = static_cast<float>(x2[k] - x1[k]);
+          }
+        }
       }
-      newVectors->SetTuple(i,x3);
+    });
+
+    if ( newScalars )
+    {
+      int idx = output->GetPointData()->AddArray(newScalars);
+      output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+      newScalars->Delete();
+    }
+    if ( newVectors )
+    {
+      output->GetPointData()->SetVectors(newVectors);
+      newVectors->Delete();
     }
-    output->GetPointData()->SetVectors(newVectors);
-    newVectors->Delete();
   }
 
   output->SetPoints(newPts);
@@ -753,17 +1071,6 @@ int vtkSmoothPolyDataFilter::RequestData(
   output->SetPolys(input->GetPolys());
   output->SetStrips(input->GetStrips());
 
-  //free up connectivity storage
-  for (i=0; i<numPts; i++)
-  {
-    if ( Verts[i].edges != nullptr )
-    {
-      Verts[i].edges->Delete();
-      Verts[i].edges = nullptr;
-    }
-  }
-  delete [] Verts;
-
   return 1;
 }
 
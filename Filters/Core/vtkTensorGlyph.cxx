@@ -16,21 +16,170 @@
 
 
 #include "vtkStreamingDemandDrivenPipeline.h"
-#include "vtkCell.h"
+#include "vtkArrayListTemplate.h"
 #include "vtkCellArray.h"
 #include "vtkDataSet.h"
 #include "vtkExecutive.h"
 #include "vtkFloatArray.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTransform.h"
+#include "vtkTypeInt32Array.h"
+#include "vtkTypeInt64Array.h"
+
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkTensorGlyph);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// The cells of one kind (vertices, lines, polygons or strips) generated at a
+// single input point: each source cell repeated for every glyph direction,
+// in the order the cells are output. The glyphs of the other input points
+// only differ by the offset of their points.
+struct TensorGlyphCells
+{
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Ids;
+
+  TensorGlyphCells(vtkCellArray* sourceCells, int numDirs,
+                   vtkIdType numSourcePts)
+  {
+    vtkIdType npts;
+    vtkIdType* pts;
+    this->Offsets.push_back(0);
+    for (sourceCells->InitTraversal(); sourceCells->GetNextCell(npts, pts);)
+    {
+      for (int dir=0; dir < numDirs; dir++)
+      {
+        for (vtkIdType i=0; i < npts; i++)
+        {
+          this->Ids.push_back(pts[i] + dir*numSourcePts);
+        }
+        this->Offsets.push_back(static_cast<vtkIdType>(this->Ids.size()));
+      }
+    }
+  }
+
+  vtkIdType GetNumberOfCells() const
+  {
+    return static_cast<vtkIdType>(this->Offsets.size()) - 1;
+  }
+
+  vtkIdType GetNumberOfIds() const
+  {
+    return static_cast<vtkIdType>(this->Ids.size());
+  }
+};
+
+//----------------------------------------------------------------------------
+// Fill a legacy (npts,id0,id1,...) cell array with the cells of all the
+// input points.
+void FillLegacyCells(const TensorGlyphCells& cells, vtkIdType numPts,
+                     vtkIdType numGlyphPts, vtkIdType* cellArray)
+{
+  vtkIdType numCells = cells.GetNumberOfCells();
+  vtkIdType size = numCells + cells.GetNumberOfIds();
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkIdType* cellPts = cellArray + ptId*size;
+      vtkIdType ptIncr = ptId*numGlyphPts;
+      for (vtkIdType cellId=0; cellId < numCells; ++cellId)
+      {
+        *cellPts++ = cells.Offsets[cellId+1] - cells.Offsets[cellId];
+        for (vtkIdType j=cells.Offsets[cellId]; j < cells.Offsets[cellId+1]; ++j)
+        {
+          *cellPts++ = cells.Ids[j] + ptIncr;
+        }
+      }
+    }
+  });
+}
+
+//----------------------------------------------------------------------------
+// Fill the offsets and connectivity of a cell array with the cells of all
+// the input points.
+template <typename T>
+void FillOffsetsCells(const TensorGlyphCells& cells, vtkIdType numPts,
+                      vtkIdType numGlyphPts, T* offsets, T* connectivity)
+{
+  vtkIdType numCells = cells.GetNumberOfCells();
+  vtkIdType numIds = cells.GetNumberOfIds();
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      T* cellOffsets = offsets + ptId*numCells;
+      T* cellPts = connectivity + ptId*numIds;
+      for (vtkIdType cellId=0; cellId < numCells; ++cellId)
+      {
+        cellOffsets[cellId] = static_cast<T>(ptId*numIds + cells.Offsets[cellId]);
+      }
+      vtkIdType ptIncr = ptId*numGlyphPts;
+      for (vtkIdType j=0; j < numIds; ++j)
+      {
+        cellPts[j] = static_cast<T>(cells.Ids[j] + ptIncr);
+      }
+    }
+  });
+  offsets[numPts*numCells] = static_cast<T>(numPts*numIds);
+}
+
+//----------------------------------------------------------------------------
+// Generate the output cell array of the cells of one kind, allocated as a
+// single block of the requested storage.
+vtkSmartPointer<vtkCellArray> GenerateCells(const TensorGlyphCells& cells,
+  vtkIdType numPts, vtkIdType numGlyphPts, int storage)
+{
+  vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType numCells = numPts*cells.GetNumberOfCells();
+  vtkIdType numIds = numPts*cells.GetNumberOfIds();
+  if (storage == vtkCellArray::LEGACY_STORAGE)
+  {
+    FillLegacyCells(cells, numPts, numGlyphPts,
+                    cellArray->WritePointer(numCells, numCells + numIds));
+  }
+  else if (storage == vtkCellArray::OFFSETS_32BIT_STORAGE &&
+           numIds <= VTK_TYPE_INT32_MAX &&
+           numPts*numGlyphPts <= VTK_TYPE_INT32_MAX)
+  {
+    vtkNew<vtkTypeInt32Array> offsets;
+    vtkNew<vtkTypeInt32Array> connectivity;
+    offsets->SetNumberOfValues(numCells + 1);
+    connectivity->SetNumberOfValues(numIds);
+    FillOffsetsCells(cells, numPts, numGlyphPts, offsets->GetPointer(0),
+                     connectivity->GetPointer(0));
+    cellArray->SetData(offsets, connectivity);
+  }
+  else
+  {
+    vtkNew<vtkTypeInt64Array> offsets;
+    vtkNew<vtkTypeInt64Array> connectivity;
+    offsets->SetNumberOfValues(numCells + 1);
+    connectivity->SetNumberOfValues(numIds);
+    FillOffsetsCells(cells, numPts, numGlyphPts, offsets->GetPointer(0),
+                     connectivity->GetPointer(0));
+    cellArray->SetData(offsets, connectivity);
+  }
+  return cellArray;
+}
+
+} // anonymous namespace
+
 // Construct object with scaling on and scale factor 1.0. Eigenvalues are
 // extracted, glyphs are colored with input scalar data, and logarithmic
 // scaling is turned off.
@@ -46,6 +195,7 @@ vtkTensorGlyph::vtkTensorGlyph()
   this->ThreeGlyphs = 0;
   this->Symmetric = 0;
   this->Length = 1.0;
+  this->OutputCellArrayStorage = vtkCellArray::LEGACY_STORAGE;
 
   this->SetNumberOfInputPorts(2);
 
@@ -115,38 +265,14 @@ int vtkTensorGlyph::RequestData(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
   vtkDataArray *inTensors;
-  double tensor[9];
   vtkDataArray *inScalars;
-  vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
-  int j;
+  vtkIdType numPts, numSourcePts, numGlyphPts, numNewPts, i;
   vtkPoints *sourcePts;
   vtkDataArray *sourceNormals;
-  vtkCellArray *sourceCells, *cells;
-  vtkPoints *newPts;
-  vtkFloatArray *newScalars=nullptr;
-  vtkFloatArray *newNormals=nullptr;
-  double x[3], s;
-  vtkTransform *trans;
-  vtkCell *cell;
-  vtkIdList *cellPts;
-  int npts;
-  vtkIdType *pts;
-  vtkIdType ptIncr, cellId;
-  vtkIdType subIncr;
-  int numDirs, dir, eigen_dir, symmetric_dir;
-  vtkMatrix4x4 *matrix;
-  double *m[3], w[3], *v[3];
-  double m0[3], m1[3], m2[3];
-  double v0[3], v1[3], v2[3];
-  double xv[3], yv[3], zv[3];
-  double maxScale;
+  int numDirs;
 
   numDirs = (this->ThreeGlyphs?3:1)*(this->Symmetric+1);
 
-  // set up working matrices
-  m[0] = m0; m[1] = m1; m[2] = m2;
-  v[0] = v0; v[1] = v1; v[2] = v2;
-
   vtkDebugMacro(<<"Generating tensor glyphs");
 
   vtkPointData *outPD = output->GetPointData();
@@ -160,59 +286,53 @@ int vtkTensorGlyph::RequestData(
     return 1;
   }
 
-  pts = new vtkIdType[source->GetMaxCellSize()];
-  trans = vtkTransform::New();
-  matrix = vtkMatrix4x4::New();
-
   //
-  // Allocate storage for output PolyData
+  // Allocate storage for output PolyData. Every input point produces
+  // numDirs glyphs, so the output is sized up front.
   //
   sourcePts = source->GetPoints();
   numSourcePts = sourcePts->GetNumberOfPoints();
-  numSourceCells = source->GetNumberOfCells();
+  numGlyphPts = numDirs*numSourcePts;
+  numNewPts = numPts*numGlyphPts;
 
-  newPts = vtkPoints::New();
-  newPts->Allocate(numDirs*numPts*numSourcePts);
+  vtkNew<vtkPoints> newPts;
+  newPts->SetDataTypeToFloat();
+  newPts->SetNumberOfPoints(numNewPts);
+  float* newPtsPtr =
+    static_cast<vtkFloatArray*>(newPts->GetData())->GetPointer(0);
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  if ( (sourceCells=source->GetVerts())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numPts*sourceCells->GetSize());
-    output->SetVerts(cells);
-    cells->Delete();
-  }
-  if ( (sourceCells=this->GetSource()->GetLines())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numPts*sourceCells->GetSize());
-    output->SetLines(cells);
-    cells->Delete();
-  }
-  if ( (sourceCells=this->GetSource()->GetPolys())->GetNumberOfCells() > 0 )
-  {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numPts*sourceCells->GetSize());
-    output->SetPolys(cells);
-    cells->Delete();
-  }
-  if ( (sourceCells=this->GetSource()->GetStrips())->GetNumberOfCells() > 0 )
+  //
+  // First generate all topology (transformation independent)
+  //
+  vtkCellArray* sourceCells[4] = { source->GetVerts(), source->GetLines(),
+                                   source->GetPolys(), source->GetStrips() };
+  vtkSmartPointer<vtkCellArray> cells[4];
+  for (int t=0; t < 4; t++)
   {
-    cells = vtkCellArray::New();
-    cells->Allocate(numDirs*numPts*sourceCells->GetSize());
-    output->SetStrips(cells);
-    cells->Delete();
+    if ( sourceCells[t]->GetNumberOfCells() > 0 )
+    {
+      TensorGlyphCells glyphCells(sourceCells[t], numDirs, numSourcePts);
+      cells[t] = GenerateCells(glyphCells, numPts, numGlyphPts,
+                               this->OutputCellArrayStorage);
+    }
   }
+  output->SetVerts(cells[0]);
+  output->SetLines(cells[1]);
+  output->SetPolys(cells[2]);
+  output->SetStrips(cells[3]);
 
   // only copy scalar data through
-  vtkPointData *pd = this->GetSource()->GetPointData();
+  vtkPointData *pd = source->GetPointData();
+  vtkSmartPointer<vtkFloatArray> newScalars;
+  vtkSmartPointer<vtkFloatArray> newNormals;
+  ArrayList sourceArrays;
   // generate scalars if eigenvalues are chosen or if scalars exist.
   if (this->ColorGlyphs &&
       ((this->ColorMode == COLOR_BY_EIGENVALUES) ||
        (inScalars && (this->ColorMode == COLOR_BY_SCALARS)) ) )
   {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numDirs*numPts*numSourcePts);
+    newScalars = vtkSmartPointer<vtkFloatArray>::New();
+    newScalars->SetNumberOfTuples(numNewPts);
     if (this->ColorMode == COLOR_BY_EIGENVALUES)
     {
       newScalars->SetName("MaxEigenvalue");
@@ -226,269 +346,305 @@ int vtkTensorGlyph::RequestData(
   {
     outPD->CopyAllOff();
     outPD->CopyScalarsOn();
-    outPD->CopyAllocate(pd,numDirs*numPts*numSourcePts);
+    outPD->CopyAllocate(pd,numNewPts);
+    sourceArrays.AddArrays(numNewPts, pd, outPD, 0.0, false);
   }
   if ( (sourceNormals = pd->GetNormals()) )
   {
-    newNormals = vtkFloatArray::New();
+    newNormals = vtkSmartPointer<vtkFloatArray>::New();
     newNormals->SetNumberOfComponents(3);
     newNormals->SetName("Normals");
-    newNormals->Allocate(numDirs*3*numPts*numSourcePts);
+    newNormals->SetNumberOfTuples(numNewPts);
   }
-  //
-  // First copy all topology (transformation independent)
-  //
-  for (inPtId=0; inPtId < numPts; inPtId++)
+
+  // Homogeneous coordinates of the source points and normals, shared by
+  // all the threads.
+  std::vector<double> glyphPts(4*numSourcePts, 1.0);
+  std::vector<double> glyphNormals;
+  for (i=0; i < numSourcePts; i++)
   {
-    ptIncr = numDirs * inPtId * numSourcePts;
-    for (cellId=0; cellId < numSourceCells; cellId++)
+    sourcePts->GetPoint(i, &glyphPts[4*i]);
+  }
+  if ( sourceNormals )
+  {
+    glyphNormals.resize(4*numSourcePts, 0.0);
+    for (i=0; i < numSourcePts; i++)
     {
-      cell = this->GetSource()->GetCell(cellId);
-      cellPts = cell->GetPointIds();
-      npts = cellPts->GetNumberOfIds();
-      for (dir=0; dir < numDirs; dir++)
-      {
-        // This variable may be removed, but that
-        // will not improve readability
-        subIncr = ptIncr + dir*numSourcePts;
-        for (i=0; i < npts; i++)
-        {
-          pts[i] = cellPts->GetId(i) + subIncr;
-        }
-        output->InsertNextCell(cell->GetCellType(),npts,pts);
-      }
+      sourceNormals->GetTuple(i, &glyphNormals[4*i]);
     }
   }
+
   //
   // Traverse all Input points, transforming glyph at Source points
   //
-  trans->PreMultiply();
-
-  for (inPtId=0; inPtId < numPts; inPtId++)
+  vtkSMPThreadLocalObject<vtkTransform> transforms;
+  vtkSMPThreadLocalObject<vtkMatrix4x4> matrices;
+  vtkSMPTools::For(0, numPts, [&](vtkIdType inPtId, vtkIdType endPtId)
   {
-    ptIncr = numDirs * inPtId * numSourcePts;
-
-    // Translation is postponed
-    // Symmetric tensor support
-    inTensors->GetTuple(inPtId, tensor);
-    if (inTensors->GetNumberOfComponents() == 6)
+    vtkTransform *trans = transforms.Local();
+    vtkMatrix4x4 *matrix = matrices.Local();
+    double tensor[9];
+    double x[3], s, p[4];
+    double *m[3], w[3], *v[3];
+    double m0[3], m1[3], m2[3];
+    double v0[3], v1[3], v2[3];
+    double xv[3], yv[3], zv[3];
+    double maxScale;
+    double normalMatrix[16];
+    vtkIdType ptIncr, k;
+    int dir, eigen_dir, symmetric_dir, j;
+
+    // set up working matrices
+    m[0] = m0; m[1] = m1; m[2] = m2;
+    v[0] = v0; v[1] = v1; v[2] = v2;
+
+    trans->PreMultiply();
+
+    for (; inPtId < endPtId; inPtId++)
     {
-      vtkMath::TensorFromSymmetricTensor(tensor);
-    }
+      ptIncr = inPtId * numGlyphPts;
 
-    // compute orientation vectors and scale factors from tensor
-    if ( this->ExtractEigenvalues ) // extract appropriate eigenfunctions
-    {
-      // We are interested in the symmetrical part of the tensor only, since
-      // eigenvalues are real if and only if the matrice of reals is symmetrical
-      for (j=0; j<3; j++)
+      // Translation is postponed
+      // Symmetric tensor support
+      inTensors->GetTuple(inPtId, tensor);
+      if (inTensors->GetNumberOfComponents() == 6)
       {
-        for (i=0; i<3; i++)
+        vtkMath::TensorFromSymmetricTensor(tensor);
+      }
+
+      // compute orientation vectors and scale factors from tensor
+      if ( this->ExtractEigenvalues ) // extract appropriate eigenfunctions
+      {
+        // We are interested in the symmetrical part of the tensor only, since
+        // eigenvalues are real if and only if the matrice of reals is symmetrical
+        for (j=0; j<3; j++)
         {
-          m[i][j] = 0.5 * (tensor[i + 3 * j] + tensor[j + 3 * i]);
+          for (k=0; k<3; k++)
+          {
+            m[k][j] = 0.5 * (tensor[k + 3 * j] + tensor[j + 3 * k]);
+          }
         }
-      }
-      vtkMath::Jacobi(m, w, v);
+        vtkMath::Jacobi(m, w, v);
 
-      //copy eigenvectors
-      xv[0] = v[0][0]; xv[1] = v[1][0]; xv[2] = v[2][0];
-      yv[0] = v[0][1]; yv[1] = v[1][1]; yv[2] = v[2][1];
-      zv[0] = v[0][2]; zv[1] = v[1][2]; zv[2] = v[2][2];
-    }
-    else //use tensor columns as eigenvectors
-    {
-      for (i=0; i<3; i++)
+        //copy eigenvectors
+        xv[0] = v[0][0]; xv[1] = v[1][0]; xv[2] = v[2][0];
+        yv[0] = v[0][1]; yv[1] = v[1][1]; yv[2] = v[2][1];
+        zv[0] = v[0][2]; zv[1] = v[1][2]; zv[2] = v[2][2];
+      }
+      else //use tensor columns as eigenvectors
       {
-        xv[i] = tensor[i];
-        yv[i] = tensor[i+3];
-        zv[i] = tensor[i+6];
+        for (k=0; k<3; k++)
+        {
+          xv[k] = tensor[k];
+          yv[k] = tensor[k+3];
+          zv[k] = tensor[k+6];
+        }
+        w[0] = vtkMath::Normalize(xv);
+        w[1] = vtkMath::Normalize(yv);
+        w[2] = vtkMath::Normalize(zv);
       }
-      w[0] = vtkMath::Normalize(xv);
-      w[1] = vtkMath::Normalize(yv);
-      w[2] = vtkMath::Normalize(zv);
-    }
 
-    // compute scale factors
-    w[0] *= this->ScaleFactor;
-    w[1] *= this->ScaleFactor;
-    w[2] *= this->ScaleFactor;
+      // compute scale factors
+      w[0] *= this->ScaleFactor;
+      w[1] *= this->ScaleFactor;
+      w[2] *= this->ScaleFactor;
 
-    if ( this->ClampScaling )
-    {
-      for (maxScale=0.0, i=0; i<3; i++)
+      if ( this->ClampScaling )
       {
-        if ( maxScale < fabs(w[i]) )
+        for (maxScale=0.0, k=0; k<3; k++)
         {
-          maxScale = fabs(w[i]);
+          if ( maxScale < fabs(w[k]) )
+          {
+            maxScale = fabs(w[k]);
+          }
         }
-      }
-      if ( maxScale > this->MaxScaleFactor )
-      {
-        maxScale = this->MaxScaleFactor / maxScale;
-        for (i=0; i<3; i++)
+        if ( maxScale > this->MaxScaleFactor )
         {
-          w[i] *= maxScale; //preserve overall shape of glyph
+          maxScale = this->MaxScaleFactor / maxScale;
+          for (k=0; k<3; k++)
+          {
+            w[k] *= maxScale; //preserve overall shape of glyph
+          }
         }
       }
-    }
 
-    // normalization is postponed
+      // normalization is postponed
 
-    // make sure scale is okay (non-zero) and scale data
-    for (maxScale=0.0, i=0; i<3; i++)
-    {
-      if ( w[i] > maxScale )
+      // make sure scale is okay (non-zero) and scale data
+      for (maxScale=0.0, k=0; k<3; k++)
       {
-        maxScale = w[i];
+        if ( w[k] > maxScale )
+        {
+          maxScale = w[k];
+        }
       }
-    }
-    if ( maxScale == 0.0 )
-    {
-      maxScale = 1.0;
-    }
-    for (i=0; i<3; i++)
-    {
-      if ( w[i] == 0.0 )
+      if ( maxScale == 0.0 )
       {
-        w[i] = maxScale * 1.0e-06;
+        maxScale = 1.0;
       }
-    }
-
-    // Now do the real work for each "direction"
-
-    for (dir=0; dir < numDirs; dir++)
-    {
-      eigen_dir = dir%(this->ThreeGlyphs?3:1);
-      symmetric_dir = dir/(this->ThreeGlyphs?3:1);
-
-      // Remove previous scales ...
-      trans->Identity();
-
-      // translate Source to Input point
-      input->GetPoint(inPtId, x);
-      trans->Translate(x[0], x[1], x[2]);
-
-      // normalized eigenvectors rotate object for eigen direction 0
-      matrix->Element[0][0] = xv[0];
-      matrix->Element[0][1] = yv[0];
-      matrix->Element[0][2] = zv[0];
-      matrix->Element[1][0] = xv[1];
-      matrix->Element[1][1] = yv[1];
-      matrix->Element[1][2] = zv[1];
-      matrix->Element[2][0] = xv[2];
-      matrix->Element[2][1] = yv[2];
-      matrix->Element[2][2] = zv[2];
-      trans->Concatenate(matrix);
-
-      if (eigen_dir == 1)
+      for (k=0; k<3; k++)
       {
-        trans->RotateZ(90.0);
+        if ( w[k] == 0.0 )
+        {
+          w[k] = maxScale * 1.0e-06;
+        }
       }
 
-      if (eigen_dir == 2)
-      {
-        trans->RotateY(-90.0);
-      }
+      // Now do the real work for each "direction"
 
-      if (this->ThreeGlyphs)
-      {
-        trans->Scale(w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
-      }
-      else
+      for (dir=0; dir < numDirs; dir++)
       {
-        trans->Scale(w[0], w[1], w[2]);
-      }
+        eigen_dir = dir%(this->ThreeGlyphs?3:1);
+        symmetric_dir = dir/(this->ThreeGlyphs?3:1);
+
+        // Remove previous scales ...
+        trans->Identity();
+
+        // translate Source to Input point
+        input->GetPoint(inPtId, x);
+        trans->Translate(x[0], x[1], x[2]);
+
+        // normalized eigenvectors rotate object for eigen direction 0
+        matrix->Element[0][0] = xv[0];
+        matrix->Element[0][1] = yv[0];
+        matrix->Element[0][2] = zv[0];
+        matrix->Element[1][0] = xv[1];
+        matrix->Element[1][1] = yv[1];
+        matrix->Element[1][2] = zv[1];
+        matrix->Element[2][0] = xv[2];
+        matrix->Element[2][1] = yv[2];
+        matrix->Element[2][2] = zv[2];
+        trans->Concatenate(matrix);
+
+        if (eigen_dir == 1)
+        {
+          trans->RotateZ(90.0);
+        }
 
-      // Mirror second set to the symmetric position
-      if (symmetric_dir == 1)
-      {
-        trans->Scale(-1.,1.,1.);
-      }
+        if (eigen_dir == 2)
+        {
+          trans->RotateY(-90.0);
+        }
 
-      // if the eigenvalue is negative, shift to reverse direction.
-      // The && is there to ensure that we do not change the
-      // old behaviour of vtkTensorGlyphs (which only used one dir),
-      // in case there is an oriented glyph, e.g. an arrow.
-      if (w[eigen_dir] < 0 && numDirs > 1)
-      {
-        trans->Translate(-this->Length, 0., 0.);
-      }
+        if (this->ThreeGlyphs)
+        {
+          trans->Scale(w[eigen_dir], this->ScaleFactor, this->ScaleFactor);
+        }
+        else
+        {
+          trans->Scale(w[0], w[1], w[2]);
+        }
 
-      // multiply points (and normals if available) by resulting
-      // matrix
-      trans->TransformPoints(sourcePts,newPts);
+        // Mirror second set to the symmetric position
+        if (symmetric_dir == 1)
+        {
+          trans->Scale(-1.,1.,1.);
+        }
 
-      // Apply the transformation to a series of points,
-      // and append the results to outPts.
-      if ( newNormals )
-      {
-        // a negative determinant means the transform turns the
-        // glyph surface inside out, and its surface normals all
-        // point inward. The following scale corrects the surface
-        // normals to point outward.
-        if (trans->GetMatrix()->Determinant() < 0)
+        // if the eigenvalue is negative, shift to reverse direction.
+        // The && is there to ensure that we do not change the
+        // old behaviour of vtkTensorGlyphs (which only used one dir),
+        // in case there is an oriented glyph, e.g. an arrow.
+        if (w[eigen_dir] < 0 && numDirs > 1)
         {
-          trans->Scale(-1.0,-1.0,-1.0);
+          trans->Translate(-this->Length, 0., 0.);
         }
-        trans->TransformNormals(sourceNormals,newNormals);
-      }
 
-        // Copy point data from source
-      if ( this->ColorGlyphs && inScalars &&
-           (this->ColorMode == COLOR_BY_SCALARS) )
-      {
-        s = inScalars->GetComponent(inPtId, 0);
-        for (i=0; i < numSourcePts; i++)
+        // multiply points (and normals if available) by resulting
+        // matrix
+        vtkMatrix4x4 *glyphMatrix = trans->GetMatrix();
+        float *outPts = newPtsPtr + 3*ptIncr;
+        for (k=0; k < numSourcePts; k++)
         {
-          newScalars->InsertTuple(ptIncr+i, &s);
+          glyphMatrix->MultiplyPoint(&glyphPts[4*k], p);
+          *outPts++ = static_cast<float>(p[0]);
+          *outPts++ = static_cast<float>(p[1]);
+          *outPts++ = static_cast<float>(p[2]);
         }
-      }
-      else if (this->ColorGlyphs &&
-               (this->ColorMode == COLOR_BY_EIGENVALUES) )
-      {
-        // If ThreeGlyphs is false we use the first (largest)
-        // eigenvalue as scalar.
-        s = w[eigen_dir];
-        for (i=0; i < numSourcePts; i++)
+
+        if ( newNormals )
         {
-          newScalars->InsertTuple(ptIncr+i, &s);
+          // a negative determinant means the transform turns the
+          // glyph surface inside out, and its surface normals all
+          // point inward. The following scale corrects the surface
+          // normals to point outward.
+          if (glyphMatrix->Determinant() < 0)
+          {
+            trans->Scale(-1.0,-1.0,-1.0);
+          }
+          // normals are transformed by the transposed inverse matrix
+          vtkMatrix4x4::Invert(*trans->GetMatrix()->Element, normalMatrix);
+          vtkMatrix4x4::Transpose(normalMatrix, normalMatrix);
+          float *outNormals = newNormals->GetPointer(3*ptIncr);
+          for (k=0; k < numSourcePts; k++, outNormals += 3)
+          {
+            vtkMatrix4x4::MultiplyPoint(normalMatrix, &glyphNormals[4*k], p);
+            outNormals[0] = static_cast<float>(p[0]);
+            outNormals[1] = static_cast<float>(p[1]);
+            outNormals[2] = static_cast<float>(p[2]);
+            vtkMath::Normalize(outNormals);
+          }
         }
-      }
-      else
-      {
-        for (i=0; i < numSourcePts; i++)
+
+          // Copy point data from source
+        if ( this->ColorGlyphs && inScalars &&
+             (this->ColorMode == COLOR_BY_SCALARS) )
+        {
+          s = inScalars->GetComponent(inPtId, 0);
+          std::fill_n(newScalars->GetPointer(ptIncr), numSourcePts,
+                      static_cast<float>(s));
+        }
+        else if (this->ColorGlyphs &&
+                 (this->ColorMode == COLOR_BY_EIGENVALUES) )
+        {
+          // If ThreeGlyphs is false we use the first (largest)
+          // eigenvalue as scalar.
+          s = w[eigen_dir];
+          std::fill_n(newScalars->GetPointer(ptIncr), numSourcePts,
+                      static_cast<float>(s));
+        }
+        else
         {
-          outPD->CopyData(pd,i,ptIncr+i);
+          for (k=0; k < numSourcePts; k++)
+          {
+            sourceArrays.Copy(k, ptIncr+k);
+          }
         }
+        ptIncr += numSourcePts;
       }
-      ptIncr += numSourcePts;
     }
+  });
+
+  // Scalars of the source that could not be copied concurrently
+  if ( !newScalars &&
+       sourceArrays.GetNumberOfArrays() < outPD->GetNumberOfArrays() )
+  {
+    std::vector<vtkIdType> sourceIds(numNewPts);
+    for (i=0; i < numNewPts; i++)
+    {
+      sourceIds[i] = i % numSourcePts;
+    }
+    sourceArrays.CopyOtherArrays(numNewPts, sourceIds.data(), pd, outPD);
   }
+
   vtkDebugMacro(<<"Generated " << numPts <<" tensor glyphs");
   //
   // Update output and release memory
   //
-  delete [] pts;
-
   output->SetPoints(newPts);
-  newPts->Delete();
 
   if ( newScalars )
   {
     int idx = outPD->AddArray(newScalars);
     outPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
   }
 
   if ( newNormals )
   {
     outPD->SetNormals(newNormals);
-    newNormals->Delete();
   }
 
   output->Squeeze();
-  trans->Delete();
-  matrix->Delete();
 
   return 1;
 }
@@ -563,4 +719,6 @@ void vtkTensorGlyph::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Three Glyphs: " << (this->ThreeGlyphs ? "On\n" : "Off\n");
   os << indent << "Symmetric: " << (this->Symmetric ? "On\n" : "Off\n");
   os << indent << "Length: " << this->Length << "\n";
+  os << indent << "Output Cell Array Storage: "
+     << this->OutputCellArrayStorage << "\n";
 }
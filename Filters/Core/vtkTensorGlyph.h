@@ -73,6 +73,12 @@
  * additional capability over the vtkGlyph3D object. That is, the
  * glyph can be oriented in three directions instead of one.
  *
+ * @warning
+ * The glyphs of the input points are generated concurrently with
+ * vtkSMPTools: every input point produces the same number of output points
+ * and cells, so the output is allocated up front and each point writes its
+ * own part of it.
+ *
  * @par Thanks:
  * Thanks to Jose Paulo Moitinho de Almeida for enhancements.
  *
@@ -85,6 +91,7 @@
 
 #include "vtkFiltersCoreModule.h" // For export macro
 #include "vtkPolyDataAlgorithm.h"
+#include "vtkCellArray.h" // For StorageTypes
 
 class VTKFILTERSCORE_EXPORT vtkTensorGlyph : public vtkPolyDataAlgorithm
 {
@@ -235,6 +242,17 @@ public:
   vtkGetMacro(MaxScaleFactor,double);
   //@}
 
+  //@{
+  /**
+   * Set/get the storage of the output cell arrays, one of
+   * vtkCellArray::StorageTypes (LEGACY_STORAGE by default). See
+   * vtkGlyph3D::SetOutputCellArrayStorage().
+   */
+  vtkSetClampMacro(OutputCellArrayStorage, int,
+    vtkCellArray::LEGACY_STORAGE, vtkCellArray::OFFSETS_64BIT_STORAGE);
+  vtkGetMacro(OutputCellArrayStorage, int);
+  //@}
+
 protected:
   vtkTensorGlyph();
   ~vtkTensorGlyph() override;
@@ -253,6 +271,7 @@ protected:
   vtkTypeBool ThreeGlyphs; // Boolean controls drawing 1 or 3 glyphs
   vtkTypeBool Symmetric; // Boolean controls drawing a "mirror" of each glyph
   double Length; // Distance, in x, from the origin to the end of the glyph
+  int OutputCellArrayStorage; // Storage of the output cell arrays
 private:
   vtkTensorGlyph(const vtkTensorGlyph&) = delete;
   void operator=(const vtkTensorGlyph&) = delete;
@@ -14,18 +14,28 @@
 =========================================================================*/
 #include "vtkThreshold.h"
 
-#include "vtkCell.h"
+#include "vtkArrayListTemplate.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkMath.h"
 
 #include <algorithm>
+#include <atomic>
+#include <vector>
 
 vtkStandardNewMacro(vtkThreshold);
 
@@ -105,17 +115,10 @@ int vtkThreshold::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, newCellId;
-  vtkIdList *cellPts, *pointMap;
-  vtkIdList *newCellPts;
-  vtkCell *cell;
   vtkPoints *newPoints;
-  vtkIdType i, ptId, newId, numPts;
-  int numCellPts;
-  double x[3];
+  vtkIdType numPts, numCells;
   vtkPointData *pd=input->GetPointData(), *outPD=output->GetPointData();
   vtkCellData *cd=input->GetCellData(), *outCD=output->GetCellData();
-  int keepCell;
 
   vtkDebugMacro(<< "Executing threshold filter");
 
@@ -133,13 +136,8 @@ int vtkThreshold::RequestData(
     return 1;
   }
 
-  outPD->CopyGlobalIdsOn();
-  outPD->CopyAllocate(pd);
-  outCD->CopyGlobalIdsOn();
-  outCD->CopyAllocate(cd);
-
   numPts = input->GetNumberOfPoints();
-  output->Allocate(input->GetNumberOfCells());
+  numCells = input->GetNumberOfCells();
 
   newPoints = vtkPoints::New();
 
@@ -165,99 +163,265 @@ int vtkThreshold::RequestData(
     newPoints->SetDataType(VTK_DOUBLE);
   }
 
-  newPoints->Allocate(numPts);
-
-  pointMap = vtkIdList::New(); //maps old point ids into new
-  pointMap->SetNumberOfIds(numPts);
-  for (i=0; i < numPts; i++)
-  {
-    pointMap->SetId(i,-1);
-  }
-
-  newCellPts = vtkIdList::New();
-
   // are we using pointScalars?
   int fieldAssociation = this->GetInputArrayAssociation(0, inputVector);
   bool usePointScalars = fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS;
 
-  // Check that the scalars of each cell satisfy the threshold criterion
-  for (cellId=0; cellId < input->GetNumberOfCells(); cellId++)
+  // The cells are processed in parallel. Build the cells of the data set
+  // first, from a single thread.
+  if (numCells > 0)
   {
-    cell = input->GetCell(cellId);
-    cellPts = cell->GetPointIds();
-    numCellPts = cell->GetNumberOfPoints();
-
-    if ( usePointScalars )
+    vtkNew<vtkGenericCell> cell;
+    input->GetCell(0, cell);
+  }
+  vtkStaticCellLinksDetail::AnyDataSetAccess cells(input);
+  vtkSMPThreadLocalObject<vtkIdList> buffers;
+
+  // Check that the scalars of each cell satisfy the threshold criterion. The
+  // size of a kept cell is its number of points, the size of a discarded
+  // cell 0 (empty cells, i.e. VTK_EMPTY_CELL, are always discarded).
+  std::vector<vtkIdType> cellSizes(numCells);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdList *cellPts = buffers.Local();
+    vtkIdType numCellPts;
+    const vtkIdType *pts;
+    int keepCell;
+    for (; cellId < endCellId; ++cellId)
     {
-      if (this->AllScalars)
+      cells.GetCellPoints(cellId, numCellPts, pts, cellPts);
+      if ( usePointScalars )
       {
-        keepCell = 1;
-        for ( i=0; keepCell && (i < numCellPts); i++)
+        if (this->AllScalars)
         {
-          ptId = cellPts->GetId(i);
-          keepCell = this->EvaluateComponents( inScalars, ptId );
+          keepCell = 1;
+          for (vtkIdType i=0; keepCell && (i < numCellPts); i++)
+          {
+            keepCell = this->EvaluateComponents( inScalars, pts[i] );
+          }
         }
-      }
-      else
-      {
-        if(!this->UseContinuousCellRange)
+        else if(!this->UseContinuousCellRange)
         {
           keepCell = 0;
-          for ( i=0; (!keepCell) && (i < numCellPts); i++)
+          for (vtkIdType i=0; (!keepCell) && (i < numCellPts); i++)
           {
-            ptId = cellPts->GetId(i);
-            keepCell = this->EvaluateComponents( inScalars, ptId );
+            keepCell = this->EvaluateComponents( inScalars, pts[i] );
           }
         }
         else
         {
-          keepCell = this->EvaluateCell(inScalars, cellPts, numCellPts);
+          if (pts != cellPts->GetPointer(0))
+          {
+            cellPts->SetNumberOfIds(numCellPts);
+            std::copy(pts, pts + numCellPts, cellPts->GetPointer(0));
+          }
+          keepCell = this->EvaluateCell(inScalars, cellPts,
+                                        static_cast<int>(numCellPts));
         }
       }
+      else //use cell scalars
+      {
+        keepCell = this->EvaluateComponents( inScalars, cellId );
+      }
+      cellSizes[cellId] = (keepCell ? numCellPts : 0);
     }
-    else //use cell scalars
+  });
+
+  // Gather the kept cells
+  std::vector<vtkIdType> keptOffsets(numCells);
+  vtkSMPTools::Transform(cellSizes.begin(), cellSizes.end(),
+    keptOffsets.begin(), [](vtkIdType size) -> vtkIdType { return size > 0; });
+  vtkIdType numKeptCells = vtkSMPTools::ExclusiveScan(keptOffsets.begin(),
+    keptOffsets.end(), keptOffsets.begin(), static_cast<vtkIdType>(0));
+  std::vector<vtkIdType> keptCells(numKeptCells);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    for (; cellId < endCellId; ++cellId)
     {
-      keepCell = this->EvaluateComponents( inScalars, cellId );
+      if (cellSizes[cellId] > 0)
+      {
+        keptCells[keptOffsets[cellId]] = cellId;
+      }
     }
-
-    if (  numCellPts > 0 && keepCell )
+  });
+  std::vector<vtkIdType>().swap(keptOffsets);
+
+  // The output points are numbered in order of first use by the kept cells,
+  // as when they are inserted one cell at a time: the first use of a point is
+  // the smallest keptId * maxCellSize + i for which it is the i-th point of
+  // the kept cell keptId.
+  vtkIdType maxCellSize = vtkSMPTools::Reduce(cellSizes.begin(),
+    cellSizes.end(), static_cast<vtkIdType>(0),
+    [](vtkIdType a, vtkIdType b) { return std::max(a, b); });
+  std::vector<std::atomic<vtkTypeInt64> > firstUses(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      firstUses[ptId].store(VTK_TYPE_INT64_MAX, std::memory_order_relaxed);
+    }
+  });
+  vtkSMPTools::For(0, numKeptCells, [&](vtkIdType keptId, vtkIdType endKeptId)
+  {
+    vtkIdList *cellPts = buffers.Local();
+    vtkIdType numCellPts;
+    const vtkIdType *pts;
+    for (; keptId < endKeptId; ++keptId)
     {
-      // satisfied thresholding (also non-empty cell, i.e. not VTK_EMPTY_CELL)
-      for (i=0; i < numCellPts; i++)
+      cells.GetCellPoints(keptCells[keptId], numCellPts, pts, cellPts);
+      vtkTypeInt64 use = static_cast<vtkTypeInt64>(keptId) * maxCellSize;
+      for (vtkIdType i = 0; i < numCellPts; ++i, ++use)
       {
-        ptId = cellPts->GetId(i);
-        if ( (newId = pointMap->GetId(ptId)) < 0 )
+        std::atomic<vtkTypeInt64> &firstUse = firstUses[pts[i]];
+        vtkTypeInt64 current = firstUse.load(std::memory_order_relaxed);
+        while (use < current &&
+               !firstUse.compare_exchange_weak(current, use,
+                                               std::memory_order_relaxed))
         {
-          input->GetPoint(ptId, x);
-          newId = newPoints->InsertNextPoint(x);
-          pointMap->SetId(ptId,newId);
-          outPD->CopyData(pd,ptId,newId);
         }
-        newCellPts->InsertId(i,newId);
       }
-      // special handling for polyhedron cells
-      if (vtkUnstructuredGrid::SafeDownCast(input) &&
-          input->GetCellType(cellId) == VTK_POLYHEDRON)
+    }
+  });
+
+  std::vector<vtkIdType> pointMap(numPts); //maps old point ids into new
+  vtkSMPTools::Transform(firstUses.begin(), firstUses.end(), pointMap.begin(),
+    [](const std::atomic<vtkTypeInt64> &firstUse) -> vtkIdType
+    { return firstUse.load(std::memory_order_relaxed) != VTK_TYPE_INT64_MAX; });
+  vtkIdType numNewPts = vtkSMPTools::ExclusiveScan(pointMap.begin(),
+    pointMap.end(), pointMap.begin(), static_cast<vtkIdType>(0));
+  std::vector<std::pair<vtkTypeInt64, vtkIdType> > uses(numNewPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkTypeInt64 firstUse = firstUses[ptId].load(std::memory_order_relaxed);
+      if (firstUse != VTK_TYPE_INT64_MAX)
+      {
+        uses[pointMap[ptId]] = std::make_pair(firstUse, ptId);
+      }
+      else
+      {
+        pointMap[ptId] = -1;
+      }
+    }
+  });
+  std::vector<std::atomic<vtkTypeInt64> >().swap(firstUses);
+  vtkSMPTools::Sort(uses.begin(), uses.end());
+  std::vector<vtkIdType> pointSources(numNewPts); //maps new point ids to old
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      pointSources[newId] = uses[newId].second;
+      pointMap[uses[newId].second] = newId;
+    }
+  });
+  std::vector<std::pair<vtkTypeInt64, vtkIdType> >().swap(uses);
+
+  // Copy the points and their data
+  newPoints->SetNumberOfPoints(numNewPts);
+  outPD->CopyGlobalIdsOn();
+  outPD->CopyAllocate(pd, numNewPts);
+  ArrayList pointArrays;
+  pointArrays.AddArrays(numNewPts, pd, outPD, 0.0, false);
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    double x[3];
+    for (; newId < endNewId; ++newId)
+    {
+      input->GetPoint(pointSources[newId], x);
+      newPoints->SetPoint(newId, x);
+      pointArrays.Copy(pointSources[newId], newId);
+    }
+  });
+  pointArrays.CopyOtherArrays(numNewPts, pointSources.data(), pd, outPD);
+
+  // Copy the cells and their data
+  vtkUnstructuredGrid *inputUG = vtkUnstructuredGrid::SafeDownCast(input);
+  if (inputUG && inputUG->GetFaces())
+  {
+    // special handling for polyhedron cells: their face streams are inserted
+    // one at a time.
+    vtkNew<vtkIdList> newCellPts;
+    output->Allocate(numKeptCells);
+    for (vtkIdType keptId = 0; keptId < numKeptCells; ++keptId)
+    {
+      vtkIdType cellId = keptCells[keptId];
+      inputUG->GetFaceStream(cellId, newCellPts);
+      if (inputUG->GetCellType(cellId) == VTK_POLYHEDRON)
       {
-        newCellPts->Reset();
-        vtkUnstructuredGrid::SafeDownCast(input)->
-          GetFaceStream(cellId, newCellPts);
         vtkUnstructuredGrid::ConvertFaceStreamPointIds(
-          newCellPts, pointMap->GetPointer(0));
+          newCellPts, pointMap.data());
       }
-      newCellId = output->InsertNextCell(cell->GetCellType(),newCellPts);
-      outCD->CopyData(cd,cellId,newCellId);
-      newCellPts->Reset();
-    } // satisfied thresholding
-  } // for all cells
+      else
+      {
+        for (vtkIdType i = 0; i < newCellPts->GetNumberOfIds(); ++i)
+        {
+          newCellPts->SetId(i, pointMap[newCellPts->GetId(i)]);
+        }
+      }
+      output->InsertNextCell(inputUG->GetCellType(cellId), newCellPts);
+    }
+  }
+  else
+  {
+    vtkNew<vtkUnsignedCharArray> types;
+    types->SetNumberOfValues(numKeptCells);
+    vtkNew<vtkIdTypeArray> locations;
+    locations->SetNumberOfValues(numKeptCells);
+    vtkSMPTools::For(0, numKeptCells, [&](vtkIdType keptId, vtkIdType endKeptId)
+    {
+      for (; keptId < endKeptId; ++keptId)
+      {
+        locations->SetValue(keptId, cellSizes[keptCells[keptId]] + 1);
+      }
+    });
+    vtkIdType size = vtkSMPTools::ExclusiveScan(locations.GetPointer(),
+      locations.GetPointer(), static_cast<vtkIdType>(0));
+
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfValues(size);
+    vtkSMPTools::For(0, numKeptCells, [&](vtkIdType keptId, vtkIdType endKeptId)
+    {
+      vtkIdList *cellPts = buffers.Local();
+      vtkIdType numCellPts;
+      const vtkIdType *pts;
+      for (; keptId < endKeptId; ++keptId)
+      {
+        vtkIdType cellId = keptCells[keptId];
+        types->SetValue(keptId,
+                        static_cast<unsigned char>(input->GetCellType(cellId)));
+        cells.GetCellPoints(cellId, numCellPts, pts, cellPts);
+        vtkIdType *newPts = connectivity->GetPointer(locations->GetValue(keptId));
+        *newPts++ = numCellPts;
+        for (vtkIdType i = 0; i < numCellPts; ++i)
+        {
+          newPts[i] = pointMap[pts[i]];
+        }
+      }
+    });
+
+    vtkNew<vtkCellArray> newCells;
+    newCells->SetCells(numKeptCells, connectivity);
+    output->SetCells(types, locations, newCells);
+  }
+
+  outCD->CopyGlobalIdsOn();
+  outCD->CopyAllocate(cd, numKeptCells);
+  ArrayList cellArrays;
+  cellArrays.AddArrays(numKeptCells, cd, outCD, 0.0, false);
+  vtkSMPTools::For(0, numKeptCells, [&](vtkIdType keptId, vtkIdType endKeptId)
+  {
+    for (; keptId < endKeptId; ++keptId)
+    {
+      cellArrays.Copy(keptCells[keptId], keptId);
+    }
+  });
+  cellArrays.CopyOtherArrays(numKeptCells, keptCells.data(), cd, outCD);
 
   vtkDebugMacro(<< "Extracted " << output->GetNumberOfCells()
                 << " number of cells.");
 
-  // now clean up / update ourselves
-  pointMap->Delete();
-  newCellPts->Delete();
-
   output->SetPoints(newPoints);
   newPoints->Delete();
 
@@ -30,6 +30,11 @@
  * By default only the first scalar value is used in the decision. Use the ComponentMode
  * and SelectedComponent ivars to control this behavior.
  *
+ * The filter is multithreaded with vtkSMPTools: the criterion is evaluated,
+ * and the points, cells and attributes are copied, in parallel. The output
+ * does not depend on the number of threads; the points are numbered in
+ * order of first use by the extracted cells.
+ *
  * @sa
  * vtkThresholdPoints vtkThresholdTextureCoords
 */
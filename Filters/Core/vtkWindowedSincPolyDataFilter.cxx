@@ -16,6 +16,7 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkCellLinks.h"
 #include "vtkFloatArray.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
@@ -24,9 +25,14 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
 
+#include <vector>
+
 vtkStandardNewMacro(vtkWindowedSincPolyDataFilter);
 
 // Construct object with number of iterations 20; passband .1;
@@ -57,12 +63,271 @@ vtkWindowedSincPolyDataFilter::vtkWindowedSincPolyDataFilter()
 #define VTK_FEATURE_EDGE_VERTEX 2
 #define VTK_BOUNDARY_EDGE_VERTEX 3
 
-// Special structure for marking vertices
-typedef struct _vtkMeshVertex
+// Type of the polygon edges already analyzed from a neighbor polygon
+#define VTK_VISITED_EDGE -1
+
+namespace
 {
-  char      type;
-  vtkIdList *edges; // connected edges (list of connected point ids)
-} vtkMeshVertex, *vtkMeshVertexPtr;
+
+// The edges of the polygons of the mesh, from which the vertices connected
+// to each vertex are found. The type of the i-th edge of polygon cellId
+// (the type given to its end points, or VTK_VISITED_EDGE) is stored at
+// EdgeTypes[CellOffsets[cellId] + i].
+struct vtkMeshEdges
+{
+  vtkPolyData *Mesh;
+  vtkCellArray *Polys;
+  const vtkIdType *LineEdges;
+  std::vector<vtkIdType> CellOffsets;
+  std::vector<signed char> EdgeTypes;
+
+  // Thread-safe access to the points of a polygon.
+  void GetPolyPoints(vtkIdType cellId, vtkIdType &npts, const vtkIdType *&pts,
+                     vtkIdList *buffer) const
+  {
+    if (this->Polys->IsOffsetsStorage())
+    {
+      this->Polys->GetCellAtId(cellId, npts, pts, buffer);
+    }
+    else
+    {
+      vtkIdType *cellPts;
+      this->Mesh->GetCellPoints(cellId, npts, cellPts);
+      pts = cellPts;
+    }
+  }
+
+  // Update the type and the n connected vertices of a vertex for an edge
+  // of type edge joining it to vertex other. Only the first capacity
+  // connected vertices are stored in ids.
+  static void AddEdge(signed char edge, vtkIdType other, char &type,
+                      vtkIdType &n, vtkIdType *ids, vtkIdType capacity)
+  {
+    if ( edge && type == VTK_SIMPLE_VERTEX )
+    {
+      n = 0;
+      type = edge;
+    }
+    else if ( (edge && type == VTK_BOUNDARY_EDGE_VERTEX) ||
+              (edge && type == VTK_FEATURE_EDGE_VERTEX) ||
+              (!edge && type == VTK_SIMPLE_VERTEX) )
+    {
+      if ( type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+      {
+        type = VTK_BOUNDARY_EDGE_VERTEX;
+      }
+    }
+    else
+    {
+      return;
+    }
+    if ( n < capacity )
+    {
+      ids[n] = other;
+    }
+    n++;
+  }
+
+  // Return the number of vertices connected to vertex ptId, and store the
+  // first capacity of them in ids. The edges using the vertex are visited
+  // in the order of a traversal of the polygons, so that the type and the
+  // connected vertices are those of a serial analysis of the polygons.
+  vtkIdType ConnectVertex(vtkIdType ptId, char &type, vtkIdType *ids,
+                          vtkIdType capacity, vtkIdList *buffer) const
+  {
+    vtkIdType n = 0;
+    if ( type == VTK_FEATURE_EDGE_VERTEX ) // inside a line
+    {
+      for (; n < 2; n++)
+      {
+        if ( n < capacity )
+        {
+          ids[n] = this->LineEdges[2*ptId+n];
+        }
+      }
+    }
+    if ( !this->Mesh )
+    {
+      return n;
+    }
+
+    // The cells of the links are sorted, and a polygon using the vertex
+    // several times is listed several times
+    const vtkCellLinks::Link &link = this->Mesh->GetCellLinks()->GetLink(ptId);
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (vtkIdType c=0; c < link.ncells; c++)
+    {
+      vtkIdType cellId = link.cells[c];
+      if ( c > 0 && cellId == link.cells[c-1] )
+      {
+        continue;
+      }
+      this->GetPolyPoints(cellId, npts, pts, buffer);
+      const signed char *edgeTypes =
+        this->EdgeTypes.data() + this->CellOffsets[cellId];
+      for (vtkIdType i=0; i < npts; i++)
+      {
+        if ( edgeTypes[i] == VTK_VISITED_EDGE )
+        {
+          continue;
+        }
+        vtkIdType p1 = pts[i];
+        vtkIdType p2 = pts[(i+1)%npts];
+        if ( p1 == ptId )
+        {
+          AddEdge(edgeTypes[i], p2, type, n, ids, capacity);
+        }
+        if ( p2 == ptId )
+        {
+          AddEdge(edgeTypes[i], p1, type, n, ids, capacity);
+        }
+      }
+    }
+    return n;
+  }
+
+  // Find the type of the edges of the polygons in parallel. This requires
+  // the links of the mesh.
+  void ClassifyEdges(vtkPoints *inPts, int featureEdgeSmoothing,
+                     int nonManifoldSmoothing, double cosFeatureAngle)
+  {
+    vtkIdType numPolys = this->Polys->GetNumberOfCells();
+    vtkSMPThreadLocalObject<vtkIdList> cellPts;
+    this->CellOffsets.resize(numPolys + 1);
+    vtkSMPTools::For(0, numPolys, [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      vtkIdType npts;
+      const vtkIdType *pts;
+      for (; cellId < endCellId; cellId++)
+      {
+        this->GetPolyPoints(cellId, npts, pts, buffer);
+        this->CellOffsets[cellId] = npts;
+      }
+    });
+    this->CellOffsets[numPolys] = vtkSMPTools::ExclusiveScan(
+      this->CellOffsets.begin(), this->CellOffsets.begin() + numPolys,
+      this->CellOffsets.begin(), static_cast<vtkIdType>(0));
+    this->EdgeTypes.resize(this->CellOffsets[numPolys]);
+
+    vtkSMPThreadLocalObject<vtkIdList> neiCellPts, neighbors;
+    vtkSMPTools::For(0, numPolys, [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      vtkIdList *neiBuffer = neiCellPts.Local();
+      vtkIdList *cellIds = neighbors.Local();
+      vtkIdType npts, numNeiPts, numNei, j;
+      const vtkIdType *pts, *neiPts;
+      double normal[3], neiNormal[3];
+      for (; cellId < endCellId; cellId++)
+      {
+        this->GetPolyPoints(cellId, npts, pts, buffer);
+        signed char *edgeTypes =
+          this->EdgeTypes.data() + this->CellOffsets[cellId];
+        for (vtkIdType i=0; i < npts; i++)
+        {
+          this->Mesh->GetCellEdgeNeighbors(cellId, pts[i], pts[(i+1)%npts],
+                                           cellIds);
+          numNei = cellIds->GetNumberOfIds();
+
+          signed char edge = VTK_SIMPLE_VERTEX;
+          if ( numNei == 0 )
+          {
+            edge = VTK_BOUNDARY_EDGE_VERTEX;
+          }
+
+          else if ( numNei >= 2 )
+          {
+            // non-manifold case, check nonmanifold smoothing state
+            if ( !nonManifoldSmoothing )
+            {
+              // check to make sure that this edge hasn't been marked already
+              for (j=0; j < numNei; j++)
+              {
+                if ( cellIds->GetId(j) < cellId )
+                {
+                  break;
+                }
+              }
+              if ( j >= numNei )
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
+              }
+            }
+          }
+
+          else if ( numNei == 1 && cellIds->GetId(0) > cellId )
+          {
+            if ( featureEdgeSmoothing )
+            {
+              vtkPolygon::ComputeNormal(inPts, static_cast<int>(npts),
+                                        const_cast<vtkIdType*>(pts), normal);
+              this->GetPolyPoints(cellIds->GetId(0), numNeiPts, neiPts,
+                                  neiBuffer);
+              vtkPolygon::ComputeNormal(inPts, static_cast<int>(numNeiPts),
+                                        const_cast<vtkIdType*>(neiPts),
+                                        neiNormal);
+
+              if ( vtkMath::Dot(normal,neiNormal) <= cosFeatureAngle )
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
+              }
+            }
+          }
+          else // a visited edge; skip rest of analysis
+          {
+            edge = VTK_VISITED_EDGE;
+          }
+          edgeTypes[i] = edge;
+        }
+      }
+    });
+  }
+
+  // Find the final type and the connected vertices of every vertex in
+  // parallel: the connected vertices of vertex i are
+  // ids[offsets[i]] .. ids[offsets[i+1]-1].
+  void ConnectVertices(std::vector<char> &types,
+                       std::vector<vtkIdType> &offsets,
+                       std::vector<vtkIdType> &ids) const
+  {
+    vtkIdType numPts = static_cast<vtkIdType>(types.size());
+    vtkSMPThreadLocalObject<vtkIdList> cellPts;
+    offsets.resize(numPts + 1);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      for (; ptId < endPtId; ptId++)
+      {
+        char type = types[ptId];
+        offsets[ptId] = this->ConnectVertex(ptId, type, nullptr, 0, buffer);
+      }
+    });
+    offsets[numPts] = vtkSMPTools::ExclusiveScan(
+      offsets.begin(), offsets.begin() + numPts, offsets.begin(),
+      static_cast<vtkIdType>(0));
+
+    ids.resize(offsets[numPts]);
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      vtkIdList *buffer = cellPts.Local();
+      for (; ptId < endPtId; ptId++)
+      {
+        this->ConnectVertex(ptId, types[ptId], ids.data() + offsets[ptId],
+                            offsets[ptId+1] - offsets[ptId], buffer);
+      }
+    });
+  }
+};
+
+// Number of vertices of each type found by the topological analysis
+struct vtkVertexCounts
+{
+  vtkIdType Simple, FEdges, BEdges, Fixed;
+};
+
+} // anonymous namespace
 
 int vtkWindowedSincPolyDataFilter::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -80,12 +345,9 @@ int vtkWindowedSincPolyDataFilter::RequestData(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
   vtkIdType numPts, numCells, numPolys, numStrips, i;
-  int j, k;
+  int j;
   vtkIdType npts = 0;
   vtkIdType *pts = nullptr;
-  vtkIdType p1, p2;
-  double x[3], y[3], deltaX[3], xNew[3];
-  double x1[3], x2[3], x3[3], l1[3], l2[3];
   double CosFeatureAngle; //Cosine of angle between adjacent polys
   double CosEdgeAngle; // Cosine of angle between adjacent edges
   int iterationNumber;
@@ -95,10 +357,10 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   vtkTriangleFilter *toTris=nullptr;
   vtkCellArray *inVerts, *inLines, *inPolys, *inStrips;
   vtkPoints *newPts[4];
-  vtkMeshVertexPtr Verts;
+  float *newCoords[4];
 
   // variables specific to windowed sinc interpolation
-  double theta_pb, k_pb, sigma, p_x0[3], p_x1[3], p_x3[3];
+  double theta_pb, k_pb, sigma;
   double *w, *c, *cprime;
   int zero, one, two, three;
 
@@ -149,12 +411,8 @@ int vtkWindowedSincPolyDataFilter::RequestData(
 // using a subset of the attached vertices.
 //
   vtkDebugMacro(<<"Analyzing topology...");
-  Verts = new vtkMeshVertex[numPts];
-  for (i=0; i<numPts; i++)
-  {
-    Verts[i].type = VTK_SIMPLE_VERTEX; //can smooth
-    Verts[i].edges = nullptr;
-  }
+  std::vector<char> types(numPts, VTK_SIMPLE_VERTEX); //can smooth
+  std::vector<vtkIdType> lineEdges; // the neighbors of the vertices in lines
 
   inPts = input->GetPoints();
 
@@ -164,46 +422,39 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   {
     for (j=0; j<npts; j++)
     {
-      Verts[pts[j]].type = VTK_FIXED_VERTEX;
+      types[pts[j]] = VTK_FIXED_VERTEX;
     }
   }
 
   this->UpdateProgress(0.10);
 
   // now check lines. Only manifold lines can be smoothed------------
-  for (inLines=input->GetLines(), inLines->InitTraversal();
-  inLines->GetNextCell(npts,pts); )
+  inLines=input->GetLines();
+  if ( inLines->GetNumberOfCells() > 0 )
+  {
+    lineEdges.resize(2*numPts);
+  }
+  for (inLines->InitTraversal(); inLines->GetNextCell(npts,pts); )
   {
     for (j=0; j<npts; j++)
     {
-      if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
+      if ( types[pts[j]] == VTK_SIMPLE_VERTEX )
       {
-        if ( j == (npts-1) ) //end-of-line marked FIXED
-        {
-          Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        }
-        else if ( j == 0 ) //beginning-of-line marked FIXED
+        if ( j == (npts-1) || j == 0 ) //end- or beginning-of-line marked FIXED
         {
-          Verts[pts[0]].type = VTK_FIXED_VERTEX;
-          inPts->GetPoint(pts[0],x2);
-          inPts->GetPoint(pts[1],x3);
+          types[pts[j]] = VTK_FIXED_VERTEX;
         }
         else //is edge vertex (unless already edge vertex!)
         {
-          Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
-          Verts[pts[j]].edges = vtkIdList::New();
-          Verts[pts[j]].edges->SetNumberOfIds(2);
-          //Verts[pts[j]].edges = new vtkIdList(2,2);
-          Verts[pts[j]].edges->SetId(0,pts[j-1]);
-          Verts[pts[j]].edges->SetId(1,pts[j+1]);
+          types[pts[j]] = VTK_FEATURE_EDGE_VERTEX;
+          lineEdges[2*pts[j]] = pts[j-1];
+          lineEdges[2*pts[j]+1] = pts[j+1];
         }
       } //if simple vertex
 
-      else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
+      else if ( types[pts[j]] == VTK_FEATURE_EDGE_VERTEX )
       { //multiply connected, becomes fixed!
-        Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        Verts[pts[j]].edges->Delete();
-        Verts[pts[j]].edges = nullptr;
+        types[pts[j]] = VTK_FIXED_VERTEX;
       }
 
     } //for all points in this line
@@ -212,6 +463,11 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   this->UpdateProgress(0.25);
 
   // now polygons and triangle strips-------------------------------
+  vtkMeshEdges edges;
+  edges.Mesh = nullptr;
+  edges.Polys = nullptr;
+  edges.LineEdges = lineEdges.data();
+
   inPolys=input->GetPolys();
   numPolys = inPolys->GetNumberOfCells();
   inStrips=input->GetStrips();
@@ -219,22 +475,12 @@ int vtkWindowedSincPolyDataFilter::RequestData(
 
   if ( numPolys > 0 || numStrips > 0 )
   { //build cell structure
-    vtkCellArray *polys;
-    vtkIdType cellId;
-    int numNei, nei, edge;
-    vtkIdType numNeiPts;
-    vtkIdType *neiPts;
-    double normal[3], neiNormal[3];
-    vtkIdList *neighbors;
-
     inMesh = vtkPolyData::New();
     inMesh->SetPoints(inPts);
     inMesh->SetPolys(inPolys);
     Mesh = inMesh;
-    neighbors = vtkIdList::New();
-    neighbors->Allocate(VTK_CELL_SIZE);
 
-    if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
+    if ( numStrips > 0 )
     { // convert data to triangles
       inMesh->SetStrips(inStrips);
       toTris = vtkTriangleFilter::New();
@@ -244,185 +490,106 @@ int vtkWindowedSincPolyDataFilter::RequestData(
     }
 
     Mesh->BuildLinks(); //to do neighborhood searching
-    polys = Mesh->GetPolys();
-
-    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
-         cellId++)
-    {
-      for (i=0; i < npts; i++)
-      {
-        p1 = pts[i];
-        p2 = pts[(i+1)%npts];
-
-        if ( Verts[p1].edges == nullptr )
-        {
-          Verts[p1].edges = vtkIdList::New();
-          Verts[p1].edges->Allocate(16,6);
-          // Verts[p1].edges = new vtkIdList(6,6);
-        }
-        if ( Verts[p2].edges == nullptr )
-        {
-          Verts[p2].edges = vtkIdList::New();
-          Verts[p2].edges->Allocate(16,6);
-          // Verts[p2].edges = new vtkIdList(6,6);
-        }
-
-        Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
-        numNei = neighbors->GetNumberOfIds();
-
-        edge = VTK_SIMPLE_VERTEX;
-        if ( numNei == 0 )
-        {
-          edge = VTK_BOUNDARY_EDGE_VERTEX;
-        }
-
-        else if ( numNei >= 2 )
-        {
-          // non-manifold case, check nonmanifold smoothing state
-          if (!this->NonManifoldSmoothing)
-          {
-            // check to make sure that this edge hasn't been marked already
-            for (j=0; j < numNei; j++)
-            {
-              if ( neighbors->GetId(j) < cellId )
-              {
-                break;
-              }
-            }
-            if ( j >= numNei )
-            {
-              edge = VTK_FEATURE_EDGE_VERTEX;
-            }
-          }
-        }
-
-        else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
-        {
-          if (this->FeatureEdgeSmoothing)
-          {
-            vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
-            Mesh->GetCellPoints(nei,numNeiPts,neiPts);
-            vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
-
-            if ( vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle )
-            {
-              edge = VTK_FEATURE_EDGE_VERTEX;
-            }
-          }
-        }
-        else // a visited edge; skip rest of analysis
-        {
-          continue;
-        }
+    edges.Mesh = Mesh;
+    edges.Polys = Mesh->GetPolys();
+    edges.ClassifyEdges(inPts, this->FeatureEdgeSmoothing,
+                        this->NonManifoldSmoothing, CosFeatureAngle);
+  }//if strips or polys
 
-        if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p1].edges->Reset();
-          Verts[p1].edges->InsertNextId(p2);
-          Verts[p1].type = edge;
-        }
-        else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
-        (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p1].edges->InsertNextId(p2);
-          if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
-          {
-            Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
-          }
-        }
+  // the vertices connected to vertex i are
+  // edgeIds[edgeOffsets[i]] .. edgeIds[edgeOffsets[i+1]-1]
+  std::vector<vtkIdType> edgeOffsets, edgeIds;
+  edges.ConnectVertices(types, edgeOffsets, edgeIds);
 
-        if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p2].edges->Reset();
-          Verts[p2].edges->InsertNextId(p1);
-          Verts[p2].type = edge;
-        }
-        else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
-        (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p2].edges->InsertNextId(p1);
-          if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
-          {
-            Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
-          }
-        }
-      }
-    }
-
-    //    delete inMesh; // delete this later, windowed sinc smoothing needs it
-    if (toTris)
-    {
-      toTris->Delete();
-    }
-    neighbors->Delete();
-  }//if strips or polys
+  if (toTris)
+  {
+    toTris->Delete();
+  }
+  if (inMesh)
+  {
+    inMesh->Delete();
+  }
 
   this->UpdateProgress(0.50);
 
   //post-process edge vertices to make sure we can smooth them
-  for (i=0; i<numPts; i++)
+  vtkVertexCounts noVertices = {0, 0, 0, 0};
+  vtkSMPThreadLocal<vtkVertexCounts> counts(noVertices);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
   {
-    if ( Verts[i].type == VTK_SIMPLE_VERTEX )
-    {
-      numSimple++;
-    }
-
-    else if ( Verts[i].type == VTK_FIXED_VERTEX )
+    vtkVertexCounts &count = counts.Local();
+    double x1[3], x2[3], x3[3], l1[3], l2[3];
+    for (; ptId < endPtId; ptId++)
     {
-      numFixed++;
-    }
-
-    else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
-    Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
-    { //see how many edges; if two, what the angle is
-
-      if ( !this->BoundarySmoothing &&
-      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      char &type = types[ptId];
+      if ( type == VTK_SIMPLE_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numBEdges++;
+        count.Simple++;
       }
 
-      else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
+      else if ( type == VTK_FIXED_VERTEX )
       {
-        // can only smooth edges on 2-manifold surfaces
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numFixed++;
+        count.Fixed++;
       }
 
-      else //check angle between edges
-      {
-        inPts->GetPoint(Verts[i].edges->GetId(0),x1);
-        inPts->GetPoint(i,x2);
-        inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+      else if ( type == VTK_FEATURE_EDGE_VERTEX ||
+      type == VTK_BOUNDARY_EDGE_VERTEX )
+      { //see how many edges; if two, what the angle is
 
-        for (k=0; k<3; k++)
+        if ( !this->BoundarySmoothing &&
+        type == VTK_BOUNDARY_EDGE_VERTEX )
         {
-          l1[k] = x2[k] - x1[k];
-          l2[k] = x3[k] - x2[k];
+          type = VTK_FIXED_VERTEX;
+          count.BEdges++;
         }
-        if ((vtkMath::Normalize(l1) >= 0.0) && (vtkMath::Normalize(l2) >= 0.0)
-            && (vtkMath::Dot(l1,l2) < CosEdgeAngle))
+
+        else if ( edgeOffsets[ptId+1] - edgeOffsets[ptId] != 2 )
         {
-          numFixed++;
-          Verts[i].type = VTK_FIXED_VERTEX;
+          // can only smooth edges on 2-manifold surfaces
+          type = VTK_FIXED_VERTEX;
+          count.Fixed++;
         }
-        else
+
+        else //check angle between edges
         {
-          if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+          inPts->GetPoint(edgeIds[edgeOffsets[ptId]],x1);
+          inPts->GetPoint(ptId,x2);
+          inPts->GetPoint(edgeIds[edgeOffsets[ptId]+1],x3);
+
+          for (int k=0; k<3; k++)
           {
-            numFEdges++;
+            l1[k] = x2[k] - x1[k];
+            l2[k] = x3[k] - x2[k];
+          }
+          if ((vtkMath::Normalize(l1) >= 0.0) && (vtkMath::Normalize(l2) >= 0.0)
+              && (vtkMath::Dot(l1,l2) < CosEdgeAngle))
+          {
+            count.Fixed++;
+            type = VTK_FIXED_VERTEX;
           }
           else
           {
-            numBEdges++;
+            if ( type == VTK_FEATURE_EDGE_VERTEX )
+            {
+              count.FEdges++;
+            }
+            else
+            {
+              count.BEdges++;
+            }
           }
-        }
-      }//if along edge
-    }//if edge vertex
-  }//for all points
+        }//if along edge
+      }//if edge vertex
+    }//for all points
+  });
+  for (vtkSMPThreadLocal<vtkVertexCounts>::iterator count = counts.begin();
+       count != counts.end(); ++count)
+  {
+    numSimple += count->Simple;
+    numFEdges += count->FEdges;
+    numBEdges += count->BEdges;
+    numFixed += count->Fixed;
+  }
 
   vtkDebugMacro(<<"Found\n\t" << numSimple << " simple vertices\n\t"
                 << numFEdges << " feature edge vertices\n\t"
@@ -436,40 +603,36 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   // need 4 vectors of points
   zero=0; one=1; two=2; three=3;
 
-  newPts[0] = vtkPoints::New();
-  newPts[0]->SetNumberOfPoints(numPts);
-  newPts[1] = vtkPoints::New();
-  newPts[1]->SetNumberOfPoints(numPts);
-  newPts[2] = vtkPoints::New();
-  newPts[2]->SetNumberOfPoints(numPts);
-  newPts[3] = vtkPoints::New();
-  newPts[3]->SetNumberOfPoints(numPts);
+  for (j=0; j<4; j++)
+  {
+    newPts[j] = vtkPoints::New();
+    newPts[j]->SetNumberOfPoints(numPts);
+    newCoords[j] =
+      static_cast<vtkFloatArray *>(newPts[j]->GetData())->GetPointer(0);
+  }
 
   // Get the center and length of the input dataset
   double *inCenter = input->GetCenter();
   double inLength = input->GetLength();
 
-  if (!this->NormalizeCoordinates)
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
   {
-    for (i=0; i<numPts; i++) //initialize to old coordinates
+    double x[3];
+    float *newX = newCoords[zero] + 3*ptId;
+    for (; ptId < endPtId; ptId++, newX += 3)
     {
-      newPts[zero]->SetPoint(i,inPts->GetPoint(i));
-    }
-  }
-  else
-  {
-    // center the data and scale to be within unit cube [-1, 1]
-    double normalizedPoint[3];
-    for (i=0; i<numPts; i++) //initialize to old coordinates
-    {
-      inPts->GetPoint(i, normalizedPoint);
-      for (j=0; j<3; ++j)
+      inPts->GetPoint(ptId, x); //initialize to old coordinates
+      for (int k=0; k<3; k++)
       {
-        normalizedPoint[j] = (normalizedPoint[j] - inCenter[j]) / inLength;
+        if (this->NormalizeCoordinates)
+        {
+          // center the data and scale to be within unit cube [-1, 1]
+          x[k] = (x[k] - inCenter[k]) / inLength;
+        }
+        newX[k] = static_cast<float>(x[k]);
       }
-      newPts[zero]->SetPoint(i,normalizedPoint);
     }
-  }
+  });
 
   // Smooth with a low pass filter defined as a windowed sinc function.
   // Taubin describes this methodology is the IBM tech report RC-20404
@@ -579,53 +742,62 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   }
 
   // first iteration
-  for (i=0; i<numPts; i++)
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
   {
-    if ( Verts[i].edges != nullptr &&
-         (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+    double x[3], y[3], deltaX[3];
+    for (; ptId < endPtId; ptId++)
     {
-      // point is allowed to move
-      newPts[zero]->GetPoint(i, x); //use current points
-      deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-
-      // calculate the negative of the laplacian
-      for (j=0; j<npts; j++) //for all connected points
+      const float *x0 = newCoords[zero] + 3*ptId;
+      float *x1 = newCoords[one] + 3*ptId;
+      float *x3 = newCoords[three] + 3*ptId;
+      vtkIdType nedges = edgeOffsets[ptId+1] - edgeOffsets[ptId];
+      if ( nedges > 0 )
       {
-        newPts[zero]->GetPoint(Verts[i].edges->GetId(j), y);
-        for (k=0; k<3; k++)
+        // point is allowed to move
+        const vtkIdType *ids = edgeIds.data() + edgeOffsets[ptId];
+        for (int k=0; k<3; k++)
         {
-          deltaX[k] += (x[k] - y[k]) / npts;
+          x[k] = x0[k]; //use current points
+          deltaX[k] = 0.0;
         }
-      }
-      // newPts[one] = newPts[zero] - 0.5 newPts[one]
-      for (k=0; k<3; k++)
-      {
-        deltaX[k] = x[k] - 0.5*deltaX[k];
-      }
-      newPts[one]->SetPoint(i, deltaX);
 
-      // calculate newPts[three] = c0 newPts[zero] + c1 newPts[one]
-      for (k=0; k < 3; k++)
-      {
-        deltaX[k] = c[0]*x[k] + c[1]*deltaX[k];
-      }
-      if (Verts[i].type == VTK_FIXED_VERTEX)
-      {
-        newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-      }
+        // calculate the negative of the laplacian
+        for (vtkIdType e=0; e<nedges; e++) //for all connected points
+        {
+          const float *neiX = newCoords[zero] + 3*ids[e];
+          for (int k=0; k<3; k++)
+          {
+            y[k] = neiX[k];
+            deltaX[k] += (x[k] - y[k]) / nedges;
+          }
+        }
+        // newPts[one] = newPts[zero] - 0.5 newPts[one]
+        for (int k=0; k<3; k++)
+        {
+          deltaX[k] = x[k] - 0.5*deltaX[k];
+          x1[k] = static_cast<float>(deltaX[k]);
+        }
+
+        // calculate newPts[three] = c0 newPts[zero] + c1 newPts[one]
+        for (int k=0; k < 3; k++)
+        {
+          deltaX[k] = c[0]*x[k] + c[1]*deltaX[k];
+          x3[k] = types[ptId] == VTK_FIXED_VERTEX ?
+            x0[k] : static_cast<float>(deltaX[k]);
+        }
+      }//if can move point
       else
       {
-        newPts[three]->SetPoint(i, deltaX);
+        // point is not allowed to move, just use the old point...
+        // (zero out the Laplacian)
+        for (int k=0; k<3; k++)
+        {
+          x1[k] = 0.0f;
+          x3[k] = x0[k];
+        }
       }
-    }//if can move point
-    else
-    {
-      // point is not allowed to move, just use the old point...
-      // (zero out the Laplacian)
-      newPts[one]->SetPoint(i, zerovector);
-      newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-    }
-  }//for all points
+    }//for all points
+  });
 
   // for the rest of the iterations
   for ( iterationNumber=2;
@@ -641,53 +813,65 @@ int vtkWindowedSincPolyDataFilter::RequestData(
       }
     }
 
-    for (i=0; i<numPts; i++)
+    // Each point only writes its own coordinates in newPts[two] and
+    // newPts[three], so the points are smoothed in parallel.
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
     {
-      if ( Verts[i].edges != nullptr &&
-           (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+      double p_x0[3], p_x1[3], p_x3[3], y[3], deltaX[3];
+      for (; ptId < endPtId; ptId++)
       {
-        // point is allowed to move
-        newPts[zero]->GetPoint(i, p_x0); //use current points
-        newPts[one]->GetPoint(i, p_x1);
-
-        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-
-        // calculate the negative laplacian of x1
-        for (j=0; j<npts; j++)
+        float *x2 = newCoords[two] + 3*ptId;
+        vtkIdType nedges = edgeOffsets[ptId+1] - edgeOffsets[ptId];
+        if ( nedges > 0 )
         {
-          newPts[one]->GetPoint(Verts[i].edges->GetId(j), y);
-          for (k=0; k<3; k++)
+          // point is allowed to move
+          const vtkIdType *ids = edgeIds.data() + edgeOffsets[ptId];
+          const float *x0 = newCoords[zero] + 3*ptId;
+          const float *x1 = newCoords[one] + 3*ptId;
+          float *x3 = newCoords[three] + 3*ptId;
+          for (int k=0; k<3; k++)
           {
-            deltaX[k] += (p_x1[k] - y[k]) / npts;
+            p_x0[k] = x0[k]; //use current points
+            p_x1[k] = x1[k];
+            deltaX[k] = 0.0;
           }
-        }//for all connected points
 
-        // Taubin:  x2 = (x1 - x0) + (x1 - x2)
-        for (k=0; k<3; k++)
-        {
-          deltaX[k] = p_x1[k] - p_x0[k] + p_x1[k] - deltaX[k];
-        }
-        newPts[two]->SetPoint(i, deltaX);
+          // calculate the negative laplacian of x1
+          for (vtkIdType e=0; e<nedges; e++)
+          {
+            const float *neiX = newCoords[one] + 3*ids[e];
+            for (int k=0; k<3; k++)
+            {
+              y[k] = neiX[k];
+              deltaX[k] += (p_x1[k] - y[k]) / nedges;
+            }
+          }//for all connected points
 
-        // smooth the vertex (x3 = x3 + cj x2)
-        newPts[three]->GetPoint(i, p_x3);
-        for (k=0;k<3;k++)
-        {
-          xNew[k] = p_x3[k] + c[iterationNumber] * deltaX[k];
-        }
-        if (Verts[i].type != VTK_FIXED_VERTEX)
+          // Taubin:  x2 = (x1 - x0) + (x1 - x2)
+          for (int k=0; k<3; k++)
+          {
+            deltaX[k] = p_x1[k] - p_x0[k] + p_x1[k] - deltaX[k];
+            x2[k] = static_cast<float>(deltaX[k]);
+          }
+
+          // smooth the vertex (x3 = x3 + cj x2)
+          if (types[ptId] != VTK_FIXED_VERTEX)
+          {
+            for (int k=0;k<3;k++)
+            {
+              p_x3[k] = x3[k];
+              x3[k] = static_cast<float>(p_x3[k] + c[iterationNumber] * deltaX[k]);
+            }
+          }
+        }//if can move point
+        else
         {
-          newPts[three]->SetPoint(i,xNew);
+          // point is not allowed to move, just use the old point...
+          // (zero out the Laplacian, newPts[one] is already zero)
+          x2[0] = x2[1] = x2[2] = 0.0f;
         }
-      }//if can move point
-      else
-      {
-        // point is not allowed to move, just use the old point...
-        // (zero out the Laplacian)
-        newPts[one]->SetPoint(i, zerovector);
-        newPts[two]->SetPoint(i, zerovector);
-      }
-    }//for all points
+      }//for all points
+    });
 
     // update the pointers. three is always three. all other pointers
     // shift by one and wrap.
@@ -715,16 +899,15 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   if (this->NormalizeCoordinates)
   {
     // Re-position the coordinated
-    double repositionedPoint[3];
-    for (i=0; i<numPts; i++)
+    vtkSMPTools::For(0, 3*numPts, [&](vtkIdType idx, vtkIdType endIdx)
     {
-      newPts[zero]->GetPoint(i, repositionedPoint);
-      for (j=0; j<3; ++j)
+      float *newX = newCoords[zero];
+      for (; idx < endIdx; idx++)
       {
-        repositionedPoint[j] = repositionedPoint[j] * inLength + inCenter[j];
+        newX[idx] = static_cast<float>(
+          static_cast<double>(newX[idx]) * inLength + inCenter[idx%3]);
       }
-      newPts[zero]->SetPoint(i,repositionedPoint);
-    }
+    });
   }
 
 //
@@ -733,39 +916,61 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   output->GetPointData()->PassData(input->GetPointData());
   output->GetCellData()->PassData(input->GetCellData());
 
-  if ( this->GenerateErrorScalars )
+  if ( this->GenerateErrorScalars || this->GenerateErrorVectors )
   {
-    vtkFloatArray *newScalars = vtkFloatArray::New();
-    newScalars->SetNumberOfTuples(numPts);
-    for (i=0; i<numPts; i++)
-    {
-      inPts->GetPoint(i,x1);
-      newPts[zero]->GetPoint(i,x2);
-      newScalars->SetComponent(i,0,
-                               sqrt(vtkMath::Distance2BetweenPoints(x1,x2)));
+    vtkFloatArray *newScalars = nullptr, *newVectors = nullptr;
+    float *scalars = nullptr, *vectors = nullptr;
+    if ( this->GenerateErrorScalars )
+    {
+      newScalars = vtkFloatArray::New();
+      newScalars->SetNumberOfTuples(numPts);
+      scalars = newScalars->GetPointer(0);
+    }
+    if ( this->GenerateErrorVectors )
+    {
+      newVectors = vtkFloatArray::New();
+      newVectors->SetNumberOfComponents(3);
+      newVectors->SetNumberOfTuples(numPts);
+      vectors = newVectors->GetPointer(0);
     }
-    int idx = output->GetPointData()->AddArray(newScalars);
-    output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
-  }
 
-  if ( this->GenerateErrorVectors )
-  {
-    vtkFloatArray *newVectors = vtkFloatArray::New();
-    newVectors->SetNumberOfComponents(3);
-    newVectors->SetNumberOfTuples(numPts);
-    for (i=0; i<numPts; i++)
-    {
-      inPts->GetPoint(i,x1);
-      newPts[zero]->GetPoint(i,x2);
-      for (j=0; j<3; j++)
+    vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+    {
+      double x1[3], x2[3];
+      for (; ptId < endPtId; ptId++)
       {
-        x3[j] = x2[j] - x1[j];
+        inPts->GetPoint(ptId,x1);
+        const float *newX = newCoords[zero] + 3*ptId;
+        for (int k=0; k<3; k++)
+        {
+          x2[k] = newX[k];
+        }
+        if ( scalars )
+        {
+          scalars[ptId] = static_cast<float>(
+            sqrt(vtkMath::Distance2BetweenPoints(x1,x2)));
+        }
+        if ( vectors )
+        {
+          for (int k=0; k<3; k++)
+          {
+            vectors[3*ptId+k] = static_cast<float>(x2[k] - x1[k]);
+          }
+        }
       }
-      newVectors->SetTuple(i,x3);
+    });
+
+    if ( newScalars )
+    {
+      int idx = output->GetPointData()->AddArray(newScalars);
+      output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+      newScalars->Delete();
+    }
+    if ( newVectors )
+    {
+      output->GetPointData()->SetVectors(newVectors);
+      newVectors->Delete();
     }
-    output->GetPointData()->SetVectors(newVectors);
-    newVectors->Delete();
   }
 
   output->SetPoints(newPts[zero]);
@@ -779,16 +984,6 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   output->SetPolys(input->GetPolys());
   output->SetStrips(input->GetStrips());
 
-  // finally delete the constructed (local) mesh
-  inMesh->Delete();
-
-  //free up connectivity storage
-  for (i=0; i<numPts; i++)
-  {
-    if ( Verts[i].edges != nullptr ) {Verts[i].edges->Delete();}
-  }
-  delete [] Verts;
-
   return 1;
 }
 
@@ -19,7 +19,9 @@
 
 #include "vtkExtractCells.h"
 
+#include "vtkArrayListTemplate.h"
 #include "vtkCellArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
 #include "vtkUnsignedCharArray.h"
@@ -34,129 +36,163 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinksTemplate.h"
 #include "vtkTimeStamp.h"
 
 vtkStandardNewMacro(vtkExtractCells);
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <vector>
 
-namespace {
-struct FastPointMap
+namespace
 {
-  using ConstIteratorType = const vtkIdType*;
 
-  vtkNew<vtkIdList> Map;
-  vtkIdType LastInput;
-  vtkIdType LastOutput;
-
-  ConstIteratorType CBegin() const
-  {
-    return this->Map->GetPointer(0);
-  }
-
-  ConstIteratorType CEnd() const
-  {
-    return this->Map->GetPointer(this->Map->GetNumberOfIds());
-  }
-
-  vtkIdType* Reset(vtkIdType numValues)
+// Number the points used by the cells, in increasing order of input id.
+// Unused points are mapped to -1.
+vtkIdType MapPoints(
+  const vtkStaticCellLinksDetail::AnyDataSetAccess &cells,
+  const vtkIdType *cellIds, vtkIdType numCells, vtkIdType numPointsInput,
+  std::vector<vtkIdType> &pointMap, std::vector<vtkIdType> &pointSources)
+{
+  // Mark the points used by the cells
+  std::vector<std::atomic<char> > used(numPointsInput);
+  vtkSMPThreadLocalObject<vtkIdList> buffers;
+  vtkSMPTools::For(0, numCells, [&](vtkIdType i, vtkIdType endI)
   {
-    this->LastInput = -1;
-    this->LastOutput = -1;
-    this->Map->SetNumberOfIds(numValues);
-    return this->Map->GetPointer(0);
-  }
-
-  // Map inputId to the new PointId. If inputId is invalid, return -1.
-  vtkIdType LookUp(vtkIdType inputId)
+    vtkIdList *buffer = buffers.Local();
+    vtkIdType npts;
+    const vtkIdType *ptIds;
+    for (; i < endI; ++i)
+    {
+      cells.GetCellPoints(cellIds[i], npts, ptIds, buffer);
+      for (vtkIdType j = 0; j < npts; ++j)
+      {
+        used[ptIds[j]].store(1, std::memory_order_relaxed);
+      }
+    }
+  });
+
+  // Number them
+  pointMap.resize(numPointsInput);
+  vtkSMPTools::Transform(used.begin(), used.end(), pointMap.begin(),
+    [](const std::atomic<char> &isUsed) -> vtkIdType
+    { return isUsed.load(std::memory_order_relaxed); });
+  vtkIdType numPoints = vtkSMPTools::ExclusiveScan(pointMap.begin(),
+    pointMap.end(), pointMap.begin(), static_cast<vtkIdType>(0));
+
+  pointSources.resize(numPoints);
+  vtkSMPTools::For(0, numPointsInput, [&](vtkIdType ptId, vtkIdType endPtId)
   {
-    vtkIdType outputId = -1;
-    ConstIteratorType first;
-    ConstIteratorType last;
-
-    if (this->LastOutput >= 0)
+    for (; ptId < endPtId; ++ptId)
     {
-      // Here's the optimization: since the point ids are usually requested
-      // with some locality, we can reduce the search range by caching the
-      // results of the last lookup. This reduces the number of lookups and
-      // improves CPU cache behavior.
-
-      // Offset is the distance (in input space) between the last lookup and
-      // the current id. Since the point map is sorted and unique, this is the
-      // maximum distance that the current ID can be from the previous one.
-      vtkIdType offset = inputId - this->LastInput;
-
-      // Our search range is from the last output location
-      first = this->CBegin() + this->LastOutput;
-      last = first + offset;
-
-      // Ensure these are correctly ordered (offset may be < 0):
-      if (last < first)
+      if (used[ptId].load(std::memory_order_relaxed))
+      {
+        pointSources[pointMap[ptId]] = ptId;
+      }
+      else
       {
-        std::swap(first, last);
+        pointMap[ptId] = -1;
       }
+    }
+  });
 
-      // Adjust last to be past-the-end:
-      ++last;
+  return numPoints;
+}
 
-      // Clamp to map bounds:
-      first = std::max(first, this->CBegin());
-      last = std::min(last, this->CEnd());
-    }
-    else
-    { // First run, use full range:
-      first = this->CBegin();
-      last = this->CEnd();
-    }
+//----------------------------------------------------------------------------
+// Copy the cells with their renumbered points, and their cell data.
+void CopyCells(vtkDataSet *input,
+  const vtkStaticCellLinksDetail::AnyDataSetAccess &cells,
+  const vtkIdType *cellIds, vtkIdType numCells,
+  const std::vector<vtkIdType> &pointMap, vtkUnstructuredGrid *output)
+{
+  vtkCellData *oldCD = input->GetCellData();
+  vtkCellData *newCD = output->GetCellData();
+  vtkSMPThreadLocalObject<vtkIdList> buffers;
 
-    outputId = this->BinaryFind(first, last, inputId);
-    if (outputId >= 0)
+  // The location of each cell in the output connectivity
+  vtkIdTypeArray *locationArray = vtkIdTypeArray::New();
+  locationArray->SetNumberOfValues(numCells);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType i, vtkIdType endI)
+  {
+    vtkIdList *buffer = buffers.Local();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (; i < endI; ++i)
     {
-      this->LastInput = inputId;
-      this->LastOutput = outputId;
+      cells.GetCellPoints(cellIds[i], npts, pts, buffer);
+      locationArray->SetValue(i, npts + 1);
     }
+  });
+  vtkIdType size = vtkSMPTools::ExclusiveScan(locationArray, locationArray,
+                                              static_cast<vtkIdType>(0));
 
-    return outputId;
-  }
+  vtkIdTypeArray *newcells = vtkIdTypeArray::New();
+  newcells->SetNumberOfValues(size);
+  vtkUnsignedCharArray *typeArray = vtkUnsignedCharArray::New();
+  typeArray->SetNumberOfValues(numCells);
+
+  ArrayList cellArrays;
+  cellArrays.AddArrays(numCells, oldCD, newCD, 0.0, false);
 
-private:
-  // Modified version of std::lower_bound that returns as soon as a value is
-  // found (rather than finding the beginning of a sequence). Returns the
-  // position in the list, or -1 if not found.
-  vtkIdType BinaryFind(ConstIteratorType first, ConstIteratorType last,
-                       vtkIdType val) const
+  // We only create vtkOriginalCellIds for the output data set if it does not
+  // exist in the input data set.  If it is in the input data set then we
+  // let the cell data copy take care of copying it over.
+  vtkIdTypeArray *origMap = nullptr;
+  if(oldCD->GetArray("vtkOriginalCellIds") == nullptr)
   {
-    vtkIdType len = last - first;
+    origMap = vtkIdTypeArray::New();
+    origMap->SetNumberOfComponents(1);
+    origMap->SetName("vtkOriginalCellIds");
+    origMap->SetNumberOfValues(numCells);
+  }
 
-    while (len > 0)
+  vtkSMPTools::For(0, numCells, [&](vtkIdType i, vtkIdType endI)
+  {
+    vtkIdList *buffer = buffers.Local();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for (; i < endI; ++i)
     {
-      // Select median
-      vtkIdType half = len / 2;
-      ConstIteratorType middle = first + half;
-
-      const vtkIdType &mVal = *middle;
-      if (mVal < val)
-      { // This soup is too cold.
-        first = middle;
-        ++first;
-        len = len - half - 1;
-      }
-      else if (val < mVal)
-      { // This soup is too hot!
-        len = half;
+      vtkIdType oldCellId = cellIds[i];
+      cells.GetCellPoints(oldCellId, npts, pts, buffer);
+      vtkIdType *newPts = newcells->GetPointer(locationArray->GetValue(i));
+      *newPts++ = npts;
+      for (vtkIdType j = 0; j < npts; ++j)
+      {
+        newPts[j] = pointMap[pts[j]];
       }
-      else
-      { // This soup is juuuust right.
-        return middle - this->Map->GetPointer(0);
+      typeArray->SetValue(i,
+        static_cast<unsigned char>(input->GetCellType(oldCellId)));
+      cellArrays.Copy(oldCellId, i);
+      if (origMap)
+      {
+        origMap->SetValue(i, oldCellId);
       }
     }
-
-    return -1;
+  });
+  cellArrays.CopyOtherArrays(numCells, cellIds, oldCD, newCD);
+  if (origMap)
+  {
+    newCD->AddArray(origMap);
+    origMap->Delete();
   }
-};
-} // end anon namespace
+
+  vtkCellArray *cellArray = vtkCellArray::New();
+  cellArray->SetCells(numCells, newcells);
+  output->SetCells(typeArray, locationArray, cellArray);
+
+  typeArray->Delete();
+  locationArray->Delete();
+  newcells->Delete();
+  cellArray->Delete();
+}
+
+}
 
 class vtkExtractCellsSTLCloak
 {
@@ -164,7 +200,6 @@ public:
   std::vector<vtkIdType> CellIds;
   vtkTimeStamp ModifiedTime;
   vtkTimeStamp SortTime;
-  FastPointMap PointMap;
 
   void Modified()
   {
@@ -191,7 +226,6 @@ public:
 //----------------------------------------------------------------------------
 vtkExtractCells::vtkExtractCells()
 {
-  this->SubSetUGridCellArraySize = 0;
   this->InputIsUgrid = 0;
   this->CellList = new vtkExtractCellsSTLCloak;
 }
@@ -294,7 +328,15 @@ int vtkExtractCells::RequestData(
     ((vtkUnstructuredGrid::SafeDownCast(input)) != nullptr);
 
   vtkIdType numCellsInput = input->GetNumberOfCells();
-  vtkIdType numCells = static_cast<vtkIdType>(this->CellList->CellIds.size());
+
+  // Ids out of the range of the input cells are ignored
+  const std::vector<vtkIdType> &cellIds = this->CellList->CellIds;
+  const vtkIdType *cellIdsBegin = cellIds.data() +
+    (std::lower_bound(cellIds.begin(), cellIds.end(), 0) - cellIds.begin());
+  const vtkIdType *cellIdsEnd = cellIds.data() +
+    (std::lower_bound(cellIds.begin(), cellIds.end(), numCellsInput) -
+     cellIds.begin());
+  vtkIdType numCells = static_cast<vtkIdType>(cellIdsEnd - cellIdsBegin);
 
   if (numCells == numCellsInput)
   {
@@ -332,11 +374,26 @@ int vtkExtractCells::RequestData(
     return 1;
   }
 
+  // The cells are processed in parallel. Build the cells of the data set
+  // first, from a single thread.
+  {
+    vtkNew<vtkGenericCell> cell;
+    input->GetCell(0, cell);
+  }
+  vtkStaticCellLinksDetail::AnyDataSetAccess cells(input);
+
+  // The output points are the points used by the extracted cells, in
+  // increasing order of input point id.
+  vtkIdType numPointsInput = input->GetNumberOfPoints();
+  std::vector<vtkIdType> pointMap; // input point id -> output point id
+  std::vector<vtkIdType> pointSources; // output point id -> input point id
+  vtkIdType numPoints = MapPoints(cells, cellIdsBegin, numCells,
+                                        numPointsInput, pointMap,
+                                        pointSources);
+
   vtkPointData *newPD = output->GetPointData();
   vtkCellData *newCD  = output->GetCellData();
 
-  vtkIdType numPoints = reMapPointIds(input);
-
   newPD->CopyGlobalIdsOn();
   newPD->CopyAllocate(PD, numPoints);
 
@@ -352,39 +409,26 @@ int vtkExtractCells::RequestData(
   pts->SetNumberOfPoints(numPoints);
 
   // Copy points and point data:
-  vtkPointSet *pointSet;
-  if ((pointSet = vtkPointSet::SafeDownCast(input)))
-  { // Optimize when a vtkPoints object exists in the input:
-    vtkNew<vtkIdList> dstIds; // contiguous range [0, numPoints)
-    dstIds->SetNumberOfIds(numPoints);
-    std::iota(dstIds->GetPointer(0), dstIds->GetPointer(numPoints), 0);
-
-    pts->InsertPoints(dstIds, this->CellList->PointMap.Map, pointSet->GetPoints());
-    newPD->CopyData(PD, this->CellList->PointMap.Map, dstIds);
-  }
-  else
-  { // Slow path if we have to query the dataset:
-    for (vtkIdType newId = 0; newId < numPoints; ++newId)
+  ArrayList pointArrays;
+  pointArrays.AddArrays(numPoints, PD, newPD, 0.0, false);
+  vtkSMPTools::For(0, numPoints, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    double x[3];
+    for (; newId < endNewId; ++newId)
     {
-      vtkIdType oldId = this->CellList->PointMap.Map->GetId(newId);
-      pts->SetPoint(newId, input->GetPoint(oldId));
-      newPD->CopyData(PD, oldId, newId);
+      vtkIdType oldId = pointSources[newId];
+      input->GetPoint(oldId, x);
+      pts->SetPoint(newId, x);
+      pointArrays.Copy(oldId, newId);
     }
-  }
+  });
+  pointArrays.CopyOtherArrays(numPoints, pointSources.data(), PD, newPD);
 
   output->SetPoints(pts);
   pts->Delete();
 
-  if (this->InputIsUgrid)
-  {
-    this->CopyCellsUnstructuredGrid(input, output);
-  }
-  else
-  {
-    this->CopyCellsDataSet(input, output);
-  }
+  CopyCells(input, cells, cellIdsBegin, numCells, pointMap, output);
 
-  this->CellList->PointMap.Reset(0);
   output->Squeeze();
 
   return 1;
@@ -443,251 +487,6 @@ void vtkExtractCells::Copy(vtkDataSet *input, vtkUnstructuredGrid *output)
   output->Squeeze();
 }
 
-//----------------------------------------------------------------------------
-vtkIdType vtkExtractCells::reMapPointIds(vtkDataSet *grid)
-{
-  vtkIdType totalPoints = grid->GetNumberOfPoints();
-
-  char *temp = new char [totalPoints];
-
-  if (!temp)
-  {
-    vtkErrorMacro(<< "vtkExtractCells::reMapPointIds memory allocation");
-    return 0;
-  }
-  memset(temp, 0, totalPoints);
-
-  int numberOfIds = 0;
-  int i;
-  vtkIdType id;
-  vtkIdList *ptIds = vtkIdList::New();
-  std::vector<vtkIdType>::const_iterator cellPtr;
-
-  if (!this->InputIsUgrid)
-  {
-    for (cellPtr = this->CellList->CellIds.cbegin();
-         cellPtr != this->CellList->CellIds.cend();
-         ++cellPtr)
-    {
-      grid->GetCellPoints(*cellPtr, ptIds);
-
-      vtkIdType nIds = ptIds->GetNumberOfIds();
-
-      vtkIdType *ptId = ptIds->GetPointer(0);
-
-      for (i=0; i<nIds; i++)
-      {
-        id = *ptId++;
-
-        if (temp[id] == 0)
-        {
-          numberOfIds++;
-          temp[id] = 1;
-        }
-      }
-    }
-  }
-  else
-  {
-    vtkUnstructuredGrid *ugrid = vtkUnstructuredGrid::SafeDownCast(grid);
-
-    this->SubSetUGridCellArraySize = 0;
-
-    vtkIdType *cellArray = ugrid->GetCells()->GetPointer();
-    vtkIdType *locs = ugrid->GetCellLocationsArray()->GetPointer(0);
-
-    this->SubSetUGridCellArraySize = 0;
-    vtkIdType maxid = ugrid->GetCellLocationsArray()->GetMaxId();
-
-    for (cellPtr = this->CellList->CellIds.cbegin();
-         cellPtr != this->CellList->CellIds.cend();
-         ++cellPtr)
-    {
-      if (*cellPtr > maxid) continue;
-
-      vtkIdType loc = locs[*cellPtr];
-
-      vtkIdType nIds = cellArray[loc++];
-
-      this->SubSetUGridCellArraySize += (1 + nIds);
-
-      for (i=0; i<nIds; i++)
-      {
-        id = cellArray[loc++];
-
-        if (temp[id] == 0)
-        {
-          numberOfIds++;
-          temp[id] = 1;
-        }
-      }
-    }
-  }
-  ptIds->Delete();
-  ptIds = nullptr;
-
-  vtkIdType *pointMap = this->CellList->PointMap.Reset(numberOfIds);
-
-  for (id=0; id<totalPoints; id++)
-  {
-    if (temp[id])
-    {
-      (*pointMap++) = id;
-    }
-  }
-
-  delete [] temp;
-
-  return numberOfIds;
-}
-
-//----------------------------------------------------------------------------
-void vtkExtractCells::CopyCellsDataSet(vtkDataSet *input,
-                                       vtkUnstructuredGrid *output)
-{
-  output->Allocate(static_cast<vtkIdType>(this->CellList->CellIds.size()));
-
-  vtkCellData *oldCD = input->GetCellData();
-  vtkCellData *newCD = output->GetCellData();
-
-  // We only create vtkOriginalCellIds for the output data set if it does not
-  // exist in the input data set.  If it is in the input data set then we
-  // let CopyData() take care of copying it over.
-  vtkIdTypeArray *origMap = nullptr;
-  if(oldCD->GetArray("vtkOriginalCellIds") == nullptr)
-  {
-    origMap = vtkIdTypeArray::New();
-    origMap->SetNumberOfComponents(1);
-    origMap->SetName("vtkOriginalCellIds");
-    newCD->AddArray(origMap);
-    origMap->Delete();
-  }
-
-  vtkIdList *cellPoints = vtkIdList::New();
-
-  std::vector<vtkIdType>::const_iterator cellPtr;
-
-  for (cellPtr = this->CellList->CellIds.cbegin();
-       cellPtr != this->CellList->CellIds.cend();
-       ++cellPtr)
-  {
-    vtkIdType cellId = *cellPtr;
-
-    input->GetCellPoints(cellId, cellPoints);
-
-    for (int i=0; i < cellPoints->GetNumberOfIds(); i++)
-    {
-      vtkIdType oldId = cellPoints->GetId(i);
-
-      vtkIdType newId = this->CellList->PointMap.LookUp(oldId);
-      assert("Old id exists in map." && newId >= 0);
-
-      cellPoints->SetId(i, newId);
-    }
-    vtkIdType newId = output->InsertNextCell(input->GetCellType(cellId), cellPoints);
-
-    newCD->CopyData(oldCD, cellId, newId);
-    if(origMap)
-    {
-      origMap->InsertNextValue(cellId);
-    }
-  }
-
-  cellPoints->Delete();
-}
-
-//----------------------------------------------------------------------------
-void vtkExtractCells::CopyCellsUnstructuredGrid(vtkDataSet *input,
-                                                vtkUnstructuredGrid *output)
-{
-  vtkUnstructuredGrid *ugrid = vtkUnstructuredGrid::SafeDownCast(input);
-  if (ugrid == nullptr)
-  {
-    this->CopyCellsDataSet(input, output);
-    return;
-  }
-
-  vtkCellData *oldCD = input->GetCellData();
-  vtkCellData *newCD = output->GetCellData();
-
-  // We only create vtkOriginalCellIds for the output data set if it does not
-  // exist in the input data set.  If it is in the input data set then we
-  // let CopyData() take care of copying it over.
-  vtkIdTypeArray *origMap = nullptr;
-  if(oldCD->GetArray("vtkOriginalCellIds") == nullptr)
-  {
-    origMap = vtkIdTypeArray::New();
-    origMap->SetNumberOfComponents(1);
-    origMap->SetName("vtkOriginalCellIds");
-    newCD->AddArray(origMap);
-    origMap->Delete();
-  }
-
-  vtkIdType numCells = static_cast<vtkIdType>(this->CellList->CellIds.size());
-
-  vtkCellArray *cellArray = vtkCellArray::New();                 // output
-  vtkIdTypeArray *newcells = vtkIdTypeArray::New();
-  newcells->SetNumberOfValues(this->SubSetUGridCellArraySize);
-  cellArray->SetCells(numCells, newcells);
-  vtkIdType cellArrayIdx = 0;
-
-  vtkIdTypeArray *locationArray = vtkIdTypeArray::New();
-  locationArray->SetNumberOfValues(numCells);
-
-  vtkUnsignedCharArray *typeArray = vtkUnsignedCharArray::New();
-  typeArray->SetNumberOfValues(numCells);
-
-  vtkIdType nextCellId = 0;
-
-  std::vector<vtkIdType>::const_iterator cellPtr; // input
-  vtkIdType *cells = ugrid->GetCells()->GetPointer();
-  vtkIdType maxid = ugrid->GetCellLocationsArray()->GetMaxId();
-  vtkIdType *locs = ugrid->GetCellLocationsArray()->GetPointer(0);
-  vtkUnsignedCharArray *types = ugrid->GetCellTypesArray();
-
-  for (cellPtr = this->CellList->CellIds.cbegin();
-       cellPtr != this->CellList->CellIds.cend();
-       ++cellPtr)
-  {
-    if (*cellPtr > maxid) continue;
-
-    vtkIdType oldCellId = *cellPtr;
-
-    vtkIdType loc = locs[oldCellId];
-    int size = static_cast<int>(cells[loc]);
-    vtkIdType *pts = cells + loc + 1;
-    unsigned char type = types->GetValue(oldCellId);
-
-    locationArray->SetValue(nextCellId, cellArrayIdx);
-    typeArray->SetValue(nextCellId, type);
-
-    newcells->SetValue(cellArrayIdx++, size);
-
-    for (int i=0; i<size; i++)
-    {
-      vtkIdType oldId = *pts++;
-      vtkIdType newId = this->CellList->PointMap.LookUp(oldId);
-      assert("Old id exists in map." && newId >= 0);
-
-      newcells->SetValue(cellArrayIdx++, newId);
-    }
-
-    newCD->CopyData(oldCD, oldCellId, nextCellId);
-    if(origMap)
-    {
-      origMap->InsertNextValue(oldCellId);
-    }
-    nextCellId++;
-  }
-
-  output->SetCells(typeArray, locationArray, cellArray);
-
-  typeArray->Delete();
-  locationArray->Delete();
-  newcells->Delete();
-  cellArray->Delete();
-}
-
 //----------------------------------------------------------------------------
 int vtkExtractCells::FillInputPortInformation(int, vtkInformation *info)
 {
@@ -26,6 +26,10 @@
  *    composed of these cells.  If the cell list is empty when vtkExtractCells
  *    executes, it will set up the ugrid, point and cell arrays, with no points,
  *    cells or data.
+ *
+ *    The extraction is multithreaded with vtkSMPTools. The output points are
+ *    the points used by the extracted cells, in increasing order of input
+ *    point id. Cell ids out of the range of the input cells are ignored.
 */
 
 #ifndef vtkExtractCells_h
@@ -80,16 +84,9 @@ protected:
 private:
 
   void Copy(vtkDataSet *input, vtkUnstructuredGrid *output);
-  vtkIdType reMapPointIds(vtkDataSet *grid);
-
-  void CopyCellsDataSet(vtkDataSet *input,
-                        vtkUnstructuredGrid *output);
-  void CopyCellsUnstructuredGrid(vtkDataSet *input,
-                                 vtkUnstructuredGrid *output);
 
   vtkExtractCellsSTLCloak *CellList;
 
-  vtkIdType SubSetUGridCellArraySize;
   char InputIsUgrid;
 
   vtkExtractCells(const vtkExtractCells&) = delete;
@@ -0,0 +1,219 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestInterpolatedVelocityFieldCopies.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the interpolated velocity fields made with CopyDataSets() share
+// the datasets and cell locators of the field they copy instead of building
+// new ones, and that they find the same cells and velocities as this field
+// when evaluated concurrently.
+
+#include "vtkAbstractCellLocator.h"
+#include "vtkCellLocatorInterpolatedVelocityField.h"
+#include "vtkCellType.h"
+#include "vtkDoubleArray.h"
+#include "vtkInterpolatedVelocityField.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <atomic>
+#include <vector>
+
+namespace
+{
+// A distorted grid of res^3 hexahedra, with a swirling velocity.
+vtkSmartPointer<vtkUnstructuredGrid> CreateGrid(int res)
+{
+  int n = res + 1;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        double x = i + 0.2 * (j % 2);
+        double y = j + 0.1 * (k % 3);
+        double z = k + 0.15 * (i % 2);
+        points->InsertNextPoint(x, y, z);
+        velocity->InsertNextTuple3(-y, x, 0.5 + 0.1 * z * x);
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->GetPointData()->AddArray(velocity);
+  grid->Allocate(res * res * res);
+  for (int k = 0; k < res; ++k)
+  {
+    for (int j = 0; j < res; ++j)
+    {
+      for (int i = 0; i < res; ++i)
+      {
+        vtkIdType p0 = i + n * (j + n * k);
+        vtkIdType hex[8] = { p0, p0 + 1, p0 + n + 1, p0 + n,
+                             p0 + n * n, p0 + n * n + 1, p0 + n * n + n + 1,
+                             p0 + n * n + n };
+        grid->InsertNextCell(VTK_HEXAHEDRON, 8, hex);
+      }
+    }
+  }
+  return grid;
+}
+
+// The result of the evaluation of a field at a point.
+struct Evaluation
+{
+  int Found;
+  vtkIdType CellId;
+  double Velocity[3];
+};
+
+// Evaluate a field at x with a global cell search, so that the result does
+// not depend on the points evaluated before.
+void Evaluate(vtkCompositeInterpolatedVelocityField* field, double* x,
+              Evaluation& evaluation)
+{
+  field->ClearLastCellId();
+  evaluation.Velocity[0] = evaluation.Velocity[1] =
+    evaluation.Velocity[2] = 0.0;
+  evaluation.Found = field->FunctionValues(x, evaluation.Velocity);
+  evaluation.CellId = field->GetLastCellId();
+}
+
+vtkAbstractCellLocator* GetLastCellLocator(
+  vtkCompositeInterpolatedVelocityField* field)
+{
+  vtkCellLocatorInterpolatedVelocityField* locatorField =
+    vtkCellLocatorInterpolatedVelocityField::SafeDownCast(field);
+  return locatorField ? locatorField->GetLastCellLocator() : nullptr;
+}
+
+int TestCopies(vtkCompositeInterpolatedVelocityField* field,
+               vtkUnstructuredGrid* grid, std::vector<double>& points)
+{
+  field->AddDataSet(grid);
+  field->SelectVectors(vtkDataObject::FIELD_ASSOCIATION_POINTS, "Velocity");
+  field->BuildSearchStructures();
+
+  vtkIdType numPoints = static_cast<vtkIdType>(points.size() / 3);
+  std::vector<Evaluation> expected(numPoints);
+  vtkIdType numFound = 0;
+  for (vtkIdType i = 0; i < numPoints; ++i)
+  {
+    Evaluate(field, &points[3 * i], expected[i]);
+    numFound += expected[i].Found;
+  }
+  if (numFound < numPoints / 2 || numFound == numPoints)
+  {
+    cerr << field->GetClassName() << " found " << numFound << " of "
+         << numPoints << " points" << endl;
+    return 1;
+  }
+
+  vtkAbstractCellLocator* locator = GetLastCellLocator(field);
+  vtkMTimeType buildTime = locator ? locator->GetBuildTime() : 0;
+  if (vtkCellLocatorInterpolatedVelocityField::SafeDownCast(field) &&
+      !locator)
+  {
+    cerr << "No cell locator" << endl;
+    return 1;
+  }
+
+  std::vector<Evaluation> results(numPoints);
+  vtkSMPThreadLocal<vtkSmartPointer<vtkCompositeInterpolatedVelocityField> >
+    copies;
+  std::atomic<vtkIdType> numNotShared(0);
+  vtkSMPTools::For(0, numPoints, 16, [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkSmartPointer<vtkCompositeInterpolatedVelocityField>& copy =
+      copies.Local();
+    if (!copy)
+    {
+      copy.TakeReference(field->NewInstance());
+      copy->CopyParameters(field);
+      copy->CopyDataSets(field);
+      copy->SelectVectors(vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                          "Velocity");
+    }
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      Evaluate(copy, &points[3 * i], results[i]);
+      if (results[i].Found &&
+          (copy->GetLastDataSet() != grid ||
+           GetLastCellLocator(copy) != locator))
+      {
+        ++numNotShared;
+      }
+    }
+  });
+
+  if (numNotShared != 0)
+  {
+    cerr << "The copies of " << field->GetClassName()
+         << " do not share the dataset or the cell locator" << endl;
+    return 1;
+  }
+  if (locator && locator->GetBuildTime() != buildTime)
+  {
+    cerr << "The cell locator was rebuilt" << endl;
+    return 1;
+  }
+  for (vtkIdType i = 0; i < numPoints; ++i)
+  {
+    if (results[i].Found != expected[i].Found ||
+        results[i].CellId != expected[i].CellId ||
+        results[i].Velocity[0] != expected[i].Velocity[0] ||
+        results[i].Velocity[1] != expected[i].Velocity[1] ||
+        results[i].Velocity[2] != expected[i].Velocity[2])
+    {
+      cerr << "The copies of " << field->GetClassName()
+           << " give another result for point " << i << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+}
+
+int TestInterpolatedVelocityFieldCopies(int, char*[])
+{
+  vtkSmartPointer<vtkUnstructuredGrid> grid = CreateGrid(12);
+
+  // Points in and around the grid
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  std::vector<double> points(3 * 5000);
+  for (double& x : points)
+  {
+    random->Next();
+    x = random->GetRangeValue(-1.0, 14.0);
+  }
+
+  int numFailures = 0;
+  vtkNew<vtkInterpolatedVelocityField> field;
+  numFailures += TestCopies(field, grid, points);
+  vtkNew<vtkCellLocatorInterpolatedVelocityField> locatorField;
+  numFailures += TestCopies(locatorField, grid, points);
+  return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
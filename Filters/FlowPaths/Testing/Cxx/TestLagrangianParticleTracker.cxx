@@ -302,6 +302,67 @@ int TestLagrangianParticleTracker(int, char*[])
     return EXIT_FAILURE;
   }
 
+  // Integrate the same particles concurrently and compare with serial output
+  vtkNew<vtkLagrangianParticleTracker> smpTracker;
+  smpTracker->SetIntegrator(integrator);
+  smpTracker->SetIntegrationModel(integrationModel);
+  smpTracker->SetInputData(waveletImg);
+  smpTracker->SetSourceData(seedPD);
+  smpTracker->SetSurfaceConnection(groupSurface->GetOutputPort());
+  smpTracker->SetStepFactor(0.1);
+  smpTracker->SetStepFactorMin(0.1);
+  smpTracker->SetStepFactorMax(0.1);
+  smpTracker->SetMaximumNumberOfSteps(300);
+  smpTracker->SetCellLengthComputationMode(
+    vtkLagrangianParticleTracker::STEP_LAST_CELL_VEL_DIR);
+  smpTracker->EnableSMPOn();
+  smpTracker->Update();
+  if (!smpTracker->GetEnableSMP())
+  {
+    std::cerr << "Incorrect EnableSMP" << std::endl;
+    return EXIT_FAILURE;
+  }
+  vtkPolyData* serialPaths = vtkPolyData::SafeDownCast(tracker->GetOutput());
+  vtkPolyData* smpPaths = vtkPolyData::SafeDownCast(smpTracker->GetOutput());
+  if (smpPaths->GetNumberOfPoints() != serialPaths->GetNumberOfPoints() ||
+    smpPaths->GetNumberOfCells() != serialPaths->GetNumberOfCells())
+  {
+    std::cerr << "Concurrent integration produces different particle paths: "
+      << smpPaths->GetNumberOfCells() << " paths with "
+      << smpPaths->GetNumberOfPoints() << " points instead of "
+      << serialPaths->GetNumberOfCells() << " paths with "
+      << serialPaths->GetNumberOfPoints() << " points" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (vtkIdType i = 0; i < serialPaths->GetNumberOfPoints(); i++)
+  {
+    double serialPt[3], smpPt[3];
+    serialPaths->GetPoint(i, serialPt);
+    smpPaths->GetPoint(i, smpPt);
+    if (vtkMath::Distance2BetweenPoints(serialPt, smpPt) > 1e-12)
+    {
+      std::cerr << "Concurrent integration produces different point " << i
+        << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  vtkMultiBlockDataSet* serialInter = vtkMultiBlockDataSet::SafeDownCast(
+    tracker->GetOutput(1));
+  vtkMultiBlockDataSet* smpInter = vtkMultiBlockDataSet::SafeDownCast(
+    smpTracker->GetOutput(1));
+  for (unsigned int i = 0; i < serialInter->GetNumberOfBlocks(); i++)
+  {
+    vtkPolyData* serialBlock = vtkPolyData::SafeDownCast(serialInter->GetBlock(i));
+    vtkPolyData* smpBlock = vtkPolyData::SafeDownCast(smpInter->GetBlock(i));
+    if (serialBlock && (!smpBlock ||
+      smpBlock->GetNumberOfPoints() != serialBlock->GetNumberOfPoints()))
+    {
+      std::cerr << "Concurrent integration produces different interactions"
+        << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   // Glyph for interaction points
   vtkNew<vtkSphereSource> sphereGlyph;
   sphereGlyph->SetRadius(0.1);
@@ -408,6 +408,121 @@ int TestStreaklineFilter()
   return EXIT_SUCCESS;
 }
 
+// Whether two outputs have the same points, lines and point data. The
+// image scalars, which TestTimeSource leaves uninitialized, are skipped.
+bool SameOutputs(vtkPolyData* a, vtkPolyData* b)
+{
+  if (a->GetNumberOfPoints() != b->GetNumberOfPoints() ||
+      a->GetNumberOfLines() != b->GetNumberOfLines() ||
+      a->GetPointData()->GetNumberOfArrays() !=
+        b->GetPointData()->GetNumberOfArrays())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a->GetNumberOfPoints(); i++)
+  {
+    double p[3], q[3];
+    a->GetPoint(i, p);
+    b->GetPoint(i, q);
+    if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2])
+    {
+      return false;
+    }
+  }
+  vtkNew<vtkIdList> aLine;
+  vtkNew<vtkIdList> bLine;
+  a->GetLines()->InitTraversal();
+  b->GetLines()->InitTraversal();
+  while (a->GetLines()->GetNextCell(aLine))
+  {
+    b->GetLines()->GetNextCell(bLine);
+    if (aLine->GetNumberOfIds() != bLine->GetNumberOfIds())
+    {
+      return false;
+    }
+    for (vtkIdType j = 0; j < aLine->GetNumberOfIds(); j++)
+    {
+      if (aLine->GetId(j) != bLine->GetId(j))
+      {
+        return false;
+      }
+    }
+  }
+  for (int k = 0; k < a->GetPointData()->GetNumberOfArrays(); k++)
+  {
+    if (a->GetPointData()->GetArray(k) == a->GetPointData()->GetScalars())
+    {
+      continue;
+    }
+    vtkDataArray* aArray = a->GetPointData()->GetArray(k);
+    vtkDataArray* bArray =
+      b->GetPointData()->GetArray(a->GetPointData()->GetArrayName(k));
+    if (!aArray || !bArray ||
+        aArray->GetNumberOfComponents() != bArray->GetNumberOfComponents())
+    {
+      return false;
+    }
+    for (vtkIdType i = 0; i < aArray->GetNumberOfTuples(); i++)
+    {
+      for (int c = 0; c < aArray->GetNumberOfComponents(); c++)
+      {
+        if (aArray->GetComponent(i, c) != bArray->GetComponent(i, c))
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// The particles advanced concurrently give the same particle paths and
+// streaklines as the particles advanced one by one.
+int TestParticleTracersSMP()
+{
+  vtkNew<TestTimeSource> imageSource;
+  imageSource->SetBoundingBox(-1,1,-1,1,-1,1);
+
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i < 8; i++)
+  {
+    for (int j = 0; j < 8; j++)
+    {
+      points->InsertNextPoint(-0.7 + 0.2 * i, 0.1 * (j - 4), 0.05 * (i + j));
+    }
+  }
+  vtkNew<vtkPolyData> seeds;
+  seeds->SetPoints(points);
+
+  for (int type = 0; type < 2; type++)
+  {
+    vtkSmartPointer<vtkPolyData> outputs[2];
+    for (int smp = 0; smp < 2; smp++)
+    {
+      vtkSmartPointer<vtkParticleTracerBase> filter;
+      if (type == 0)
+      {
+        filter = vtkSmartPointer<vtkParticlePathFilter>::New();
+      }
+      else
+      {
+        filter = vtkSmartPointer<vtkStreaklineFilter>::New();
+      }
+      filter->SetInputConnection(0,imageSource->GetOutputPort());
+      filter->SetInputData(1,seeds);
+      filter->SetTerminationTime(4.0);
+      filter->SetEnableSMP(smp != 0);
+      filter->Update();
+      outputs[smp] = filter->GetOutput();
+    }
+    EXPECT(outputs[0]->GetNumberOfLines() > 0 &&
+           SameOutputs(outputs[0], outputs[1]),
+           "Concurrent and serial outputs differ for " <<
+           (type == 0 ? "particle paths" : "streaklines"));
+  }
+
+  return EXIT_SUCCESS;
+}
 
 int TestParticleTracers(int, char*[])
 {
@@ -496,6 +611,7 @@ int TestParticleTracers(int, char*[])
   EXPECT(TestParticlePathFilter()==EXIT_SUCCESS,"");
   EXPECT(TestParticlePathFilterStartTime()==EXIT_SUCCESS,"");
   EXPECT(TestStreaklineFilter()==EXIT_SUCCESS,"");
+  EXPECT(TestParticleTracersSMP()==EXIT_SUCCESS,"");
 
   return EXIT_SUCCESS;
 }
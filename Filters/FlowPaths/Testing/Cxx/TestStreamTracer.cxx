@@ -13,6 +13,8 @@
 
 =========================================================================*/
 #include "vtkRTAnalyticSource.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCommand.h"
 #include "vtkNew.h"
 #include "vtkImageGradient.h"
 #include "vtkImageData.h"
@@ -20,10 +22,19 @@
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkSmartPointer.h"
 #include "vtkDoubleArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkRungeKutta45.h"
+#include "vtkSMPTools.h"
+#include "vtkUnstructuredGrid.h"
 #include <cassert>
+#include <cstring>
 
 int TestFieldNames(int, char*[])
 {
@@ -104,9 +115,230 @@ int TestFieldNames(int, char*[])
   return EXIT_SUCCESS;
 }
 
+namespace
+{
+// A custom termination callback that never terminates the streamlines, but
+// makes the tracer integrate them serially.
+bool NeverTerminate(void*, vtkPoints*, vtkDataArray*, int)
+{
+  return false;
+}
+
+// A tracer giving access to the last step size it used.
+class StepSizeTracer : public vtkStreamTracer
+{
+public:
+  static StepSizeTracer* New();
+  vtkTypeMacro(StepSizeTracer, vtkStreamTracer);
+  double GetLastUsedStepSize() { return this->LastUsedStepSize; }
+};
+vtkStandardNewMacro(StepSizeTracer);
+
+// Count the progress events strictly between the start and the end.
+void CountProgress(vtkObject*, unsigned long, void* clientData, void* callData)
+{
+  double progress = *static_cast<double*>(callData);
+  if (progress > 0.0 && progress < 1.0)
+  {
+    ++*static_cast<int*>(clientData);
+  }
+}
+
+// Abort the execution at the first progress event after the start.
+void AbortOnProgress(vtkObject* caller, unsigned long, void*, void* callData)
+{
+  if (*static_cast<double*>(callData) > 0.0)
+  {
+    vtkAlgorithm::SafeDownCast(caller)->SetAbortExecute(1);
+  }
+}
+
+bool SameArrays(vtkDataArray* a, vtkDataArray* b)
+{
+  if (!a || !b || a->GetDataType() != b->GetDataType() ||
+      a->GetNumberOfComponents() != b->GetNumberOfComponents() ||
+      a->GetNumberOfTuples() != b->GetNumberOfTuples())
+  {
+    return false;
+  }
+  return memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0),
+                a->GetNumberOfValues() * a->GetDataTypeSize()) == 0;
+}
+
+bool SameAttributes(vtkFieldData* a, vtkFieldData* b)
+{
+  if (a->GetNumberOfArrays() != b->GetNumberOfArrays())
+  {
+    return false;
+  }
+  for (int i = 0; i < a->GetNumberOfArrays(); i++)
+  {
+    if (!SameArrays(a->GetArray(i), b->GetArray(a->GetArrayName(i))))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameStreamlines(vtkPolyData* a, vtkPolyData* b)
+{
+  return a->GetNumberOfPoints() == b->GetNumberOfPoints() &&
+    SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData()) &&
+    SameArrays(a->GetLines()->GetData(), b->GetLines()->GetData()) &&
+    SameAttributes(a->GetPointData(), b->GetPointData()) &&
+    SameAttributes(a->GetCellData(), b->GetCellData());
+}
+}
+
+// Check that the streamlines integrated concurrently are the ones of the
+// serial integration, on an image and on an unstructured grid.
+int TestParallelIntegration(int, char*[])
+{
+  // A swirling flow, with a scalar to interpolate
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(21, 21, 11);
+  image->SetSpacing(0.1, 0.1, 0.1);
+  image->SetOrigin(-1.0, -1.0, 0.0);
+  vtkNew<vtkDoubleArray> velocity;
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(image->GetNumberOfPoints());
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+  {
+    double x[3];
+    image->GetPoint(i, x);
+    velocity->SetTuple3(i, -x[1] + 0.1 * x[0], x[0], 0.2 + 0.1 * x[2]);
+    scalars->SetValue(i, x[0] * x[1] + x[2]);
+  }
+  image->GetPointData()->SetVectors(velocity);
+  image->GetPointData()->AddArray(scalars);
+
+  vtkNew<vtkUnstructuredGrid> grid;
+  vtkNew<vtkPoints> gridPoints;
+  gridPoints->SetNumberOfPoints(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+  {
+    gridPoints->SetPoint(i, image->GetPoint(i));
+  }
+  grid->SetPoints(gridPoints);
+  grid->Allocate(image->GetNumberOfCells());
+  vtkNew<vtkIdList> cellPoints;
+  for (vtkIdType i = 0; i < image->GetNumberOfCells(); i++)
+  {
+    image->GetCellPoints(i, cellPoints);
+    grid->InsertNextCell(image->GetCellType(i), cellPoints);
+  }
+  grid->GetPointData()->ShallowCopy(image->GetPointData());
+
+  vtkNew<vtkPolyData> seeds;
+  vtkNew<vtkPoints> seedPoints;
+  for (int i = 0; i < 15; i++)
+  {
+    for (int j = 0; j < 15; j++)
+    {
+      seedPoints->InsertNextPoint(-0.95 + 0.13 * i, -0.95 + 0.13 * j,
+                                  0.05 * (i % 3));
+    }
+  }
+  seeds->SetPoints(seedPoints);
+
+  vtkDataSet* inputs[] = { image, grid };
+  for (int input = 0; input < 2; input++)
+  {
+    vtkSmartPointer<vtkPolyData> outputs[3];
+    double lastUsedStepSizes[3];
+    int numProgressEvents[3] = { 0, 0, 0 };
+    for (int mode = 0; mode < 3; mode++)
+    {
+      vtkNew<StepSizeTracer> tracer;
+      vtkNew<vtkCallbackCommand> progressCallback;
+      progressCallback->SetCallback(&CountProgress);
+      progressCallback->SetClientData(&numProgressEvents[mode]);
+      tracer->AddObserver(vtkCommand::ProgressEvent, progressCallback);
+      tracer->SetSourceData(seeds);
+      tracer->SetInputData(inputs[input]);
+      tracer->SetMaximumPropagation(5.0);
+      tracer->SetIntegrationDirectionToBoth();
+      vtkNew<vtkRungeKutta45> integrator;
+      tracer->SetIntegrator(integrator);
+      if (input == 1)
+      {
+        tracer->SetInterpolatorTypeToCellLocator();
+      }
+
+      vtkSMPTools::Config config;
+      if (mode == 0)
+      {
+        tracer->AddCustomTerminationCallback(&NeverTerminate, nullptr, 0);
+      }
+      else if (mode == 1)
+      {
+        config.Backend = "Sequential";
+      }
+      vtkSMPTools::LocalScope(config, [&]() { tracer->Update(); });
+      outputs[mode] = tracer->GetOutput();
+      lastUsedStepSizes[mode] = tracer->GetLastUsedStepSize();
+    }
+
+    if (outputs[0]->GetNumberOfLines() < 100 ||
+        !SameStreamlines(outputs[0], outputs[1]) ||
+        !SameStreamlines(outputs[0], outputs[2]))
+    {
+      cerr << "Serial and multithreaded streamlines differ for input "
+           << input << endl;
+      return EXIT_FAILURE;
+    }
+    if (lastUsedStepSizes[0] == 0.0 ||
+        lastUsedStepSizes[1] != lastUsedStepSizes[0] ||
+        lastUsedStepSizes[2] != lastUsedStepSizes[0] ||
+        numProgressEvents[1] == 0 || numProgressEvents[2] == 0)
+    {
+      cerr << "Wrong last used step size or no progress for input " << input
+           << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Once aborted, the serial and the multithreaded integrations output
+  // nothing, even if some streamlines were done.
+  for (int mode = 0; mode < 2; mode++)
+  {
+    vtkNew<vtkStreamTracer> tracer;
+    vtkNew<vtkCallbackCommand> abortCallback;
+    abortCallback->SetCallback(&AbortOnProgress);
+    tracer->AddObserver(vtkCommand::ProgressEvent, abortCallback);
+    tracer->SetSourceData(seeds);
+    tracer->SetInputData(image);
+    tracer->SetMaximumPropagation(5.0);
+    tracer->SetIntegrationDirectionToBoth();
+    vtkNew<vtkRungeKutta45> integrator;
+    tracer->SetIntegrator(integrator);
+    if (mode == 0)
+    {
+      tracer->AddCustomTerminationCallback(&NeverTerminate, nullptr, 0);
+    }
+    tracer->Update();
+    if (tracer->GetOutput()->GetNumberOfPoints() != 0 ||
+        tracer->GetOutput()->GetNumberOfLines() != 0)
+    {
+      cerr << "Streamlines output after an abort for the "
+           << (mode == 0 ? "serial" : "multithreaded") << " integration"
+           << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int TestStreamTracer(int n, char* a[])
 {
   int numFailures(0);
   numFailures += TestFieldNames(n,a);
+  numFailures += TestParallelIntegration(n,a);
   return numFailures;
 }
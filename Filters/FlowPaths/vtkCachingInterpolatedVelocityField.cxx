@@ -145,6 +145,50 @@ void vtkCachingInterpolatedVelocityField::SetDataSet(int I, vtkDataSet* dataset,
   this->Weights.assign(maxsize, 0.0);
 }
 //---------------------------------------------------------------------------
+void vtkCachingInterpolatedVelocityField::BuildSearchStructures()
+{
+  // vtkDataSet::FindCell() and GetCell() are thread safe once they have been
+  // called from a single thread; the locators are not rebuilt once they are
+  // no longer lazy.
+  for (size_t i = 0; i < this->CacheList.size(); i++)
+  {
+    IVFDataSetInfo &data = this->CacheList[i];
+    if (!data.DataSet)
+    {
+      continue;
+    }
+    if (data.BSPTree)
+    {
+      data.BSPTree->LazyEvaluationOff();
+      data.BSPTree->BuildLocator();
+    }
+    if (data.DataSet->GetNumberOfPoints() > 0 &&
+        data.DataSet->GetNumberOfCells() > 0)
+    {
+      double x[3], pcoords[3];
+      int subId;
+      data.DataSet->GetPoint(0, x);
+      data.DataSet->GetCell(0, this->TempCell);
+      data.DataSet->FindCell(x, nullptr, this->TempCell, -1, 0.0, subId,
+                             pcoords, &this->Weights[0]);
+    }
+  }
+}
+//---------------------------------------------------------------------------
+void vtkCachingInterpolatedVelocityField::CopyDataSets(
+  vtkCachingInterpolatedVelocityField* from)
+{
+  for (size_t i = 0; i < from->CacheList.size(); i++)
+  {
+    const IVFDataSetInfo &data = from->CacheList[i];
+    if (data.DataSet)
+    {
+      this->SetDataSet(static_cast<int>(i), data.DataSet, data.StaticDataSet,
+                       data.BSPTree);
+    }
+  }
+}
+//---------------------------------------------------------------------------
 void vtkCachingInterpolatedVelocityField::SetLastCellInfo(vtkIdType c, int datasetindex)
 {
   if ((this->LastCacheIndex != datasetindex) || (this->LastCellId != c))
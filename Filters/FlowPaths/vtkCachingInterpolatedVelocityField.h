@@ -32,7 +32,8 @@
  *
  * @warning
  * vtkCachingInterpolatedVelocityField is not thread safe. A new instance should
- * be created by each thread.
+ * be created by each thread. Such instances can share the datasets and cell
+ * locators of a field through BuildSearchStructures() and CopyDataSets().
  *
  * @sa
  * vtkFunctionSet vtkStreamTracer
@@ -88,6 +89,21 @@ public:
    */
   virtual void SetDataSet(int I, vtkDataSet* dataset, bool staticdataset, vtkAbstractCellLocator *locator);
 
+  /**
+   * Build the cell locators and the other search structures of the datasets
+   * now instead of on the first evaluation, so that evaluations no longer
+   * modify them.
+   */
+  void BuildSearchStructures();
+
+  /**
+   * Set the datasets of another field, sharing its cell locators. The
+   * vectors must be selected before. Once from->BuildSearchStructures() has
+   * been called, the fields sharing its datasets can be evaluated
+   * concurrently, each instance from its own thread.
+   */
+  void CopyDataSets(vtkCachingInterpolatedVelocityField* from);
+
   //@{
   /**
    * If you want to work with an arbitrary vector array, then set its name
@@ -264,6 +264,49 @@ void vtkCellLocatorInterpolatedVelocityField::AddDataSet( vtkDataSet * dataset )
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkCellLocatorInterpolatedVelocityField::BuildSearchStructures()
+{
+  this->Superclass::BuildSearchStructures();
+
+  for ( vtkAbstractCellLocator * locator : *this->CellLocators )
+  {
+    if ( locator )
+    {
+      locator->LazyEvaluationOff();
+      locator->BuildLocator();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellLocatorInterpolatedVelocityField::CopyDataSets
+  ( vtkCompositeInterpolatedVelocityField * from )
+{
+  vtkCellLocatorInterpolatedVelocityField * fromLocators =
+    vtkCellLocatorInterpolatedVelocityField::SafeDownCast( from );
+  if ( !fromLocators )
+  {
+    this->Superclass::CopyDataSets( from );
+    return;
+  }
+
+  for ( size_t i = 0; i < fromLocators->DataSets->size(); i ++ )
+  {
+    vtkDataSet * dataset = ( *fromLocators->DataSets )[i];
+    this->DataSets->push_back( dataset );
+    this->CellLocators->push_back( ( *fromLocators->CellLocators )[i] );
+
+    int  size = dataset->GetMaxCellSize();
+    if ( size > this->WeightsSize )
+    {
+      this->WeightsSize = size;
+      delete[] this->Weights;
+      this->Weights = new double[size];
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkCellLocatorInterpolatedVelocityField::CopyParameters
   ( vtkAbstractInterpolatedVelocityField * from )
@@ -102,6 +102,20 @@ public:
    */
   void AddDataSet( vtkDataSet * dataset ) override;
 
+  /**
+   * Build the cell locators now. They are switched off lazy evaluation so
+   * that vtkAbstractCellLocator::FindCell() never rebuilds them, which
+   * allows to share them between threads.
+   */
+  void BuildSearchStructures() override;
+
+  /**
+   * Add all the datasets of another field together with its cell locators,
+   * which are shared rather than copied when from is a
+   * vtkCellLocatorInterpolatedVelocityField.
+   */
+  void CopyDataSets( vtkCompositeInterpolatedVelocityField * from ) override;
+
   /**
    * Evaluate the velocity field f at point (x, y, z).
    */
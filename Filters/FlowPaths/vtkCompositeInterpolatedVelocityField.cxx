@@ -35,6 +35,38 @@ vtkCompositeInterpolatedVelocityField::~vtkCompositeInterpolatedVelocityField()
   this->DataSets = nullptr;
 }
 
+void vtkCompositeInterpolatedVelocityField::BuildSearchStructures()
+{
+  // vtkDataSet::FindCell() and GetCell() are thread safe once they have been
+  // called from a single thread.
+  vtkGenericCell * cell = vtkGenericCell::New();
+  std::vector< double > weights;
+  for ( vtkDataSet * dataset : *this->DataSets )
+  {
+    if ( dataset->GetNumberOfPoints() > 0 && dataset->GetNumberOfCells() > 0 )
+    {
+      double x[3], pcoords[3];
+      int    subId;
+      weights.resize( dataset->GetMaxCellSize() );
+      dataset->GetPoint( 0, x );
+      dataset->GetLength();
+      dataset->GetCell( 0, cell );
+      dataset->FindCell( x, nullptr, cell, -1, 0.0, subId, pcoords,
+                         weights.data() );
+    }
+  }
+  cell->Delete();
+}
+
+void vtkCompositeInterpolatedVelocityField::CopyDataSets
+  ( vtkCompositeInterpolatedVelocityField * from )
+{
+  for ( vtkDataSet * dataset : *from->DataSets )
+  {
+    this->AddDataSet( dataset );
+  }
+}
+
 void vtkCompositeInterpolatedVelocityField::PrintSelf( ostream & os, vtkIndent indent )
 {
   this->Superclass::PrintSelf( os, indent );
@@ -56,7 +56,9 @@
  *
  * @warning
  *  vtkCompositeInterpolatedVelocityField is not thread safe. A new instance
- *  should be created by each thread.
+ *  should be created by each thread. Such instances can share the datasets
+ *  and cell locators of a field through BuildSearchStructures() and
+ *  CopyDataSets().
  *
  * @sa
  *  vtkInterpolatedVelocityField vtkCellLocatorInterpolatedVelocityField
@@ -106,6 +108,24 @@ public:
    */
   virtual void AddDataSet( vtkDataSet * dataset ) = 0;
 
+  /**
+   * Build the structures used to locate cells in the datasets (bounds,
+   * links, point and cell locators) now instead of on the first evaluation.
+   * Once they are built, evaluations no longer modify the datasets, and
+   * fields created with CopyDataSets() from this one can be evaluated
+   * concurrently, each instance from its own thread.
+   */
+  virtual void BuildSearchStructures();
+
+  /**
+   * Add all the datasets of another field. Subclasses share the search
+   * structures built by from->BuildSearchStructures() instead of building
+   * their own, so that only the cell cache (LastCellId, GenCell, Weights)
+   * is duplicated. THIS FUNCTION DOES NOT CHANGE THE REFERENCE COUNT OF
+   * THE DATASETS.
+   */
+  virtual void CopyDataSets( vtkCompositeInterpolatedVelocityField * from );
+
 
 protected:
   vtkCompositeInterpolatedVelocityField();
@@ -27,7 +27,6 @@
 #include "vtkNew.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
-#include "vtkQuad.h"
 #include "vtkSetGet.h"
 #include "vtkSmartPointer.h"
 #include "vtkDoubleArray.h"
@@ -593,6 +592,37 @@ void vtkLagrangianBasicIntegrationModel::SetTracker(
   this->Tracker = tracker;
 }
 
+//----------------------------------------------------------------------------
+vtkLagrangianBasicIntegrationModel* vtkLagrangianBasicIntegrationModel::NewThreadedModel()
+{
+  vtkLagrangianBasicIntegrationModel* model = this->NewInstance();
+  model->SetLocator(this->Locator);
+  model->LocatorsBuilt = this->LocatorsBuilt;
+  model->SetTracker(this->Tracker);
+  model->InputArrays = this->InputArrays;
+  model->Tolerance = this->Tolerance;
+  model->NonPlanarQuadSupport = this->NonPlanarQuadSupport;
+  model->UseInitialIntegrationTime = this->UseInitialIntegrationTime;
+
+  // Flow locators are only used to find cells, which does not modify them
+  *model->DataSets = *this->DataSets;
+  *model->Locators = *this->Locators;
+  model->WeightsSize = this->WeightsSize;
+  delete[] model->LastWeights;
+  model->LastWeights = new double[model->WeightsSize];
+
+  // Finding cells along a line modifies the locator, so each copy
+  // has its own surface locators
+  for (size_t iDs = 0; iDs < this->Surfaces->size(); iDs++)
+  {
+    model->AddDataSet((*this->Surfaces)[iDs].second, true,
+      (*this->Surfaces)[iDs].first);
+  }
+
+  this->InitializeThreadedModel(model);
+  return model;
+}
+
 //----------------------------------------------------------------------------
 void vtkLagrangianBasicIntegrationModel::AddDataSet(vtkDataSet * dataset,
   bool surface, unsigned int surfaceFlatIndex)
@@ -746,6 +776,7 @@ vtkLagrangianParticle* vtkLagrangianBasicIntegrationModel::ComputeSurfaceInterac
   vtkIdType cellId = -1;
   int surfaceType = -1;
   PassThroughSetType passThroughInterSet;
+  vtkNew<vtkGenericCell> cell;
   bool perforation;
   do
   {
@@ -763,7 +794,7 @@ vtkLagrangianParticle* vtkLagrangianBasicIntegrationModel::ComputeSurfaceInterac
         double tmpFactor;
         double tmpPoint[3];
         vtkIdType tmpCellId = cellList->GetId(i);
-        vtkCell* cell = tmpSurface->GetCell(tmpCellId);
+        tmpSurface->GetCell(tmpCellId, cell);
         if (this->IntersectWithLine(cell, particle->GetPosition(),
           particle->GetNextPosition(), this->Tolerance,
           tmpFactor, tmpPoint) == 0)
@@ -988,8 +1019,7 @@ bool vtkLagrangianBasicIntegrationModel::IntersectWithLine(vtkCell* cell,
   // Non planar quad support
   if (this->NonPlanarQuadSupport)
   {
-    vtkQuad* quad = vtkQuad::SafeDownCast(cell);
-    if (quad != nullptr)
+    if (cell->GetCellType() == VTK_QUAD)
     {
       if (p1[0] == p2[0] && p1[1] == p2[1] && p1[2] == p2[2])
       {
@@ -997,7 +1027,7 @@ bool vtkLagrangianBasicIntegrationModel::IntersectWithLine(vtkCell* cell,
         return false;
       }
 
-      vtkPoints* points = quad->GetPoints();
+      vtkPoints* points = cell->GetPoints();
 
       // create 4 points
       double p[3];
@@ -1355,8 +1385,9 @@ bool vtkLagrangianBasicIntegrationModel::GetFlowOrSurfaceData(int idx, vtkDataSe
       this->TmpArray = array->NewInstance();
       this->TmpArray->SetNumberOfComponents(nComponents);
       this->TmpArray->SetNumberOfTuples(1);
+      dataSet->GetCell(tupleId, this->Cell);
       this->TmpArray->InterpolateTuple(
-        0, dataSet->GetCell(tupleId)->GetPointIds(), array, weights);
+        0, this->Cell->GetPointIds(), array, weights);
 
       // Recover data
       data = this->TmpArray->GetTuple(0);
@@ -1379,7 +1410,9 @@ bool vtkLagrangianBasicIntegrationModel::GetFlowOrSurfaceData(int idx, vtkDataSe
         return false;
       }
       nComponents = array->GetNumberOfComponents();
-      data = array->GetTuple(tupleId);
+      this->TmpTuple.resize(nComponents);
+      array->GetTuple(tupleId, this->TmpTuple.data());
+      data = this->TmpTuple.data();
       return true;
     }
     case vtkDataObject::FIELD_ASSOCIATION_NONE:
@@ -1393,7 +1426,9 @@ bool vtkLagrangianBasicIntegrationModel::GetFlowOrSurfaceData(int idx, vtkDataSe
         return false;
       }
       nComponents = array->GetNumberOfComponents();
-      data = array->GetTuple(tupleId);
+      this->TmpTuple.resize(nComponents);
+      array->GetTuple(tupleId, this->TmpTuple.data());
+      data = this->TmpTuple.data();
       return true;
     }
     default:
@@ -43,6 +43,12 @@
  * Inherited class could reimplement CheckFreeFlightTermination to set
  * the way particle terminate in free flight
  *
+ * When vtkLagrangianParticleTracker integrates particles concurrently, each
+ * thread uses its own copy of the model, created by NewThreadedModel.
+ * Inherited classes with their own parameters or results should reimplement
+ * InitializeThreadedModel and FinalizeThreadedModel, and the surface
+ * interaction methods then receive the queue of new particles of the thread.
+ *
  * @sa
  * vtkLagrangianParticleTracker vtkLagrangianParticle
  * vtkLagrangianMatidaIntegrationModel
@@ -58,6 +64,7 @@
 
 #include <queue> // for new particles
 #include <map> // for array indexes
+#include <vector> // for tuples
 
 class vtkAbstractArray;
 class vtkAbstractCellLocator;
@@ -383,6 +390,34 @@ public:
    */
   virtual vtkAbstractArray* GetSeedArray(int idx, vtkPointData* pointData);
 
+  /**
+   * Create a copy of this model to be used by a single thread when the
+   * particles are integrated concurrently. The copy shares the flow datasets,
+   * their locators and the surfaces with this model, and builds its own
+   * surface locators. It is created with NewInstance, then
+   * InitializeThreadedModel is called to copy the parameters of inherited
+   * classes. The caller is responsible for deleting the returned model.
+   */
+  virtual vtkLagrangianBasicIntegrationModel* NewThreadedModel();
+
+  /**
+   * Called by NewThreadedModel on this model with the new copy. Inherited
+   * classes can reimplement it to copy their own parameters. It may be called
+   * concurrently from different threads, so it should not modify this model.
+   * Does nothing in base implementation
+   */
+  virtual void InitializeThreadedModel(
+    vtkLagrangianBasicIntegrationModel* vtkNotUsed(threadedModel)){}
+
+  /**
+   * Called on this model with each copy created by NewThreadedModel once all
+   * the particles have been integrated, before the copy is deleted. Inherited
+   * classes can reimplement it to gather the results of each thread. Calls are
+   * made one at a time. Does nothing in base implementation
+   */
+  virtual void FinalizeThreadedModel(
+    vtkLagrangianBasicIntegrationModel* vtkNotUsed(threadedModel)){}
+
 protected:
   vtkLagrangianBasicIntegrationModel();
   ~vtkLagrangianBasicIntegrationModel() override;
@@ -519,6 +554,7 @@ protected:
   vtkLocatorsType* SurfaceLocators;
 
   vtkDataArray* TmpArray;
+  std::vector<double> TmpTuple;
 
   double Tolerance;
   bool NonPlanarQuadSupport;
@@ -29,6 +29,7 @@ vtkLagrangianParticle::vtkLagrangianParticle(int numberOfVariables,
   SeedArrayTupleIndex(seedArrayTupleIndex),
   NumberOfSteps(0),
   SeedData(seedData),
+  NewParticleSeedData(nullptr),
   StepTime(0),
   IntegrationTime(integrationTime),
   PrevIntegrationTime(0),
@@ -94,16 +95,21 @@ vtkLagrangianParticle* vtkLagrangianParticle::NewInstance(int numberOfVariables,
 vtkLagrangianParticle* vtkLagrangianParticle::NewParticle(vtkIdType particleId)
 {
   // Copy point data tuples
-  vtkPointData* seedData = this->GetSeedData();
+  vtkPointData* parentSeedData = this->GetSeedData();
+  vtkPointData* seedData = this->NewParticleSeedData ?
+    this->NewParticleSeedData : parentSeedData;
   vtkIdType seedArrayTupleIndex = this->GetSeedArrayTupleIndex();
-  if (seedData->GetNumberOfArrays() > 0)
+  if (parentSeedData->GetNumberOfArrays() > 0)
   {
     vtkIdType parentSeedArrayTupleIndex = seedArrayTupleIndex;
     seedArrayTupleIndex = seedData->GetArray(0)->GetNumberOfTuples();
-    seedData->CopyAllocate(
-      seedData, seedArrayTupleIndex + 1);
+    if (seedData == parentSeedData)
+    {
+      seedData->CopyAllocate(
+        seedData, seedArrayTupleIndex + 1);
+    }
     seedData->CopyData(
-      seedData, parentSeedArrayTupleIndex, seedArrayTupleIndex);
+      parentSeedData, parentSeedArrayTupleIndex, seedArrayTupleIndex);
   }
 
   // Create particle and copy members
@@ -243,6 +249,18 @@ vtkPointData* vtkLagrangianParticle::GetSeedData()
   return this->SeedData;
 }
 
+//---------------------------------------------------------------------------
+void vtkLagrangianParticle::SetNewParticleSeedData(vtkPointData* seedData)
+{
+  this->NewParticleSeedData = seedData;
+}
+
+//---------------------------------------------------------------------------
+vtkPointData* vtkLagrangianParticle::GetNewParticleSeedData()
+{
+  return this->NewParticleSeedData;
+}
+
 //---------------------------------------------------------------------------
 double& vtkLagrangianParticle::GetStepTimeRef()
 {
@@ -362,6 +380,7 @@ void vtkLagrangianParticle::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfVariables: " << this->NumberOfVariables << std::endl;
   os << indent << "ParentId: " << this->ParentId << std::endl;
   os << indent << "SeedData: " << this->SeedData << std::endl;
+  os << indent << "NewParticleSeedData: " << this->NewParticleSeedData << std::endl;
   os << indent << "SeedId: " << this->SeedId << std::endl;
   os << indent << "SeedArrayTupleIndex: " << this->SeedArrayTupleIndex << std::endl;
   os << indent << "StepTime: " << this->StepTime << std::endl;
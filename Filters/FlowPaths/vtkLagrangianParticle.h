@@ -297,6 +297,20 @@ public:
    */
   virtual vtkPointData* GetSeedData();
 
+  //@{
+  /**
+   * Set/Get the point data in which NewParticle stores the seed data of the
+   * particles created from this one. When nullptr, which is the default,
+   * the seed data of this particle is used. It should have been allocated
+   * with CopyAllocate on the seed data of this particle.
+   * This is used when integrating particles concurrently, so that each
+   * thread stores the seed data of new particles without modifying the
+   * seed data shared between threads.
+   */
+  virtual void SetNewParticleSeedData(vtkPointData* seedData);
+  virtual vtkPointData* GetNewParticleSeedData();
+  //@}
+
   /**
    * Get the last traversed cell id
    */
@@ -446,6 +460,7 @@ protected:
   vtkIdType SeedArrayTupleIndex;
   vtkIdType NumberOfSteps;
   vtkPointData* SeedData;
+  vtkPointData* NewParticleSeedData;
   vtkDataSet* LastDataSet;
   vtkIdType LastCellId;
   double StepTime;
@@ -22,6 +22,7 @@
 #include "vtkDataSetSurfaceFilter.h"
 #include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -37,17 +38,110 @@
 #include "vtkPolyLine.h"
 #include "vtkPolygon.h"
 #include "vtkRungeKutta2.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
-#include "vtkVoxel.h"
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #include <sstream>
+#include <vector>
 
 vtkObjectFactoryNewMacro(vtkLagrangianParticleTracker);
 vtkCxxSetObjectMacro(vtkLagrangianParticleTracker, IntegrationModel, vtkLagrangianBasicIntegrationModel);
 vtkCxxSetObjectMacro(vtkLagrangianParticleTracker, Integrator, vtkInitialValueProblemSolver);
 
+namespace
+{
+  // The copies of the integration model and integrator used by each thread
+  struct IntegrationThreadData
+  {
+    vtkSmartPointer<vtkLagrangianBasicIntegrationModel> Model;
+    vtkSmartPointer<vtkInitialValueProblemSolver> Integrator;
+  };
+
+  // The outputs of a chunk of particles integrated by a single thread, with
+  // the seed data and the queue of the particles created by the chunk.
+  struct ParticleChunk
+  {
+    vtkNew<vtkPolyData> Paths;
+    vtkNew<vtkCellArray> Lines;
+    std::vector<bool> HasPath;
+    vtkSmartPointer<vtkDataObject> Interactions;
+    vtkSmartPointer<vtkPointData> SeedData;
+    std::queue<vtkLagrangianParticle*> NewParticles;
+  };
+
+  // Create an empty polydata with the same point data arrays as pd
+  vtkPolyData* NewPolyDataLike(vtkPolyData* pd)
+  {
+    vtkPolyData* copy = vtkPolyData::New();
+    vtkNew<vtkPoints> points;
+    copy->SetPoints(points);
+    copy->GetPointData()->CopyStructure(pd->GetPointData());
+    return copy;
+  }
+
+  // Create an empty interaction output with the same layout as output
+  vtkDataObject* NewInteractionOutputLike(vtkDataObject* output)
+  {
+    vtkDataObject* copy = output->NewInstance();
+    vtkCompositeDataSet* hdOutput = vtkCompositeDataSet::SafeDownCast(output);
+    vtkPolyData* pdOutput = vtkPolyData::SafeDownCast(output);
+    if (hdOutput)
+    {
+      vtkCompositeDataSet* hdCopy = vtkCompositeDataSet::SafeDownCast(copy);
+      hdCopy->CopyStructure(hdOutput);
+      vtkSmartPointer<vtkCompositeDataIterator> iter;
+      iter.TakeReference(hdOutput->NewIterator());
+      for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+        vtkPolyData* pd = vtkPolyData::SafeDownCast(hdOutput->GetDataSet(iter));
+        if (pd)
+        {
+          vtkPolyData* pdCopy = NewPolyDataLike(pd);
+          hdCopy->SetDataSet(iter, pdCopy);
+          pdCopy->Delete();
+        }
+      }
+    }
+    else if (pdOutput && pdOutput->GetPoints())
+    {
+      vtkPolyData* pdCopy = vtkPolyData::SafeDownCast(copy);
+      vtkNew<vtkPoints> points;
+      pdCopy->SetPoints(points);
+      pdCopy->GetPointData()->CopyStructure(pdOutput->GetPointData());
+    }
+    return copy;
+  }
+
+  // Append the points and point data of from to the ones of to
+  void AppendPoints(vtkPolyData* to, vtkPolyData* from)
+  {
+    vtkIdType numPts = from->GetNumberOfPoints();
+    if (numPts == 0)
+    {
+      return;
+    }
+    vtkPoints* points = to->GetPoints();
+    points->InsertPoints(points->GetNumberOfPoints(), numPts, 0, from->GetPoints());
+    vtkPointData* toPD = to->GetPointData();
+    vtkPointData* fromPD = from->GetPointData();
+    for (int i = 0; i < fromPD->GetNumberOfArrays(); i++)
+    {
+      vtkAbstractArray* fromArray = fromPD->GetAbstractArray(i);
+      vtkAbstractArray* toArray = toPD->GetAbstractArray(fromArray->GetName());
+      if (toArray)
+      {
+        toArray->InsertTuples(toArray->GetNumberOfTuples(),
+          fromArray->GetNumberOfTuples(), 0, fromArray);
+      }
+    }
+  }
+}
+
 //---------------------------------------------------------------------------
 vtkLagrangianParticleTracker::vtkLagrangianParticleTracker()
 {
@@ -72,6 +166,7 @@ vtkLagrangianParticleTracker::vtkLagrangianParticleTracker()
   this->ParticlePathsRenderingPointsThreshold = 100;
 
   this->CreateOutOfDomainParticle = false;
+  this->EnableSMP = false;
   this->ParticleCounter = 0;
 
   this->FlowCache = nullptr;
@@ -122,7 +217,8 @@ void vtkLagrangianParticleTracker::PrintSelf(ostream& os, vtkIndent indent)
     << this->ParticlePathsRenderingPointsThreshold << endl;
   os << indent << "MinimumVelocityMagnitude: " << this->MinimumVelocityMagnitude << endl;
   os << indent << "MinimumReductionFactor: " << this->MinimumReductionFactor << endl;
-  os << indent << "ParticleCounter: " << this->ParticleCounter << endl;
+  os << indent << "EnableSMP: " << this->EnableSMP << endl;
+  os << indent << "ParticleCounter: " << this->ParticleCounter.load() << endl;
 }
 
 //---------------------------------------------------------------------------
@@ -271,6 +367,11 @@ int vtkLagrangianParticleTracker::RequestData(
   this->IntegrationModel->PreIntegrate(particlesQueue);
 
   // Integrate each particle
+  if (this->CanIntegrateInParallel())
+  {
+    this->IntegrateParticlesInParallel(particlesQueue, particlePathsOutput,
+      interactionOutput);
+  }
   while (!this->GetAbortExecute())
   {
     // Check for particle feed
@@ -350,9 +451,7 @@ vtkMTimeType vtkLagrangianParticleTracker::GetMTime()
 //---------------------------------------------------------------------------
 vtkIdType vtkLagrangianParticleTracker::GetNewParticleId()
 {
-  vtkIdType id = this->ParticleCounter;
-  this->ParticleCounter++;
-  return id;
+  return this->ParticleCounter.fetch_add(1);
 }
 
 //---------------------------------------------------------------------------
@@ -969,11 +1068,198 @@ void vtkLagrangianParticleTracker::GetParticleFeed(
 {
 }
 
+//---------------------------------------------------------------------------
+bool vtkLagrangianParticleTracker::CanIntegrateInParallel()
+{
+  return this->EnableSMP;
+}
+
+//---------------------------------------------------------------------------
+void vtkLagrangianParticleTracker::IntegrateParticlesInParallel(
+  std::queue<vtkLagrangianParticle*>& particlesQueue,
+  vtkPolyData* particlePathsOutput, vtkDataObject* interactionOutput)
+{
+  vtkSMPThreadLocal<IntegrationThreadData> threadData;
+
+  // The seed data of the particles created by each chunk, which are
+  // referenced by these particles until they are integrated
+  std::vector<vtkSmartPointer<vtkPointData> > chunksSeedData;
+
+  vtkIdType numIntegrated = 0;
+  while (!this->GetAbortExecute())
+  {
+    // Integrate all the particles available at once
+    this->GetParticleFeed(particlesQueue);
+    if (particlesQueue.empty())
+    {
+      break;
+    }
+    std::vector<vtkLagrangianParticle*> particles;
+    particles.reserve(particlesQueue.size());
+    while (!particlesQueue.empty())
+    {
+      particles.push_back(particlesQueue.front());
+      particlesQueue.pop();
+    }
+
+    vtkIdType numParticles = static_cast<vtkIdType>(particles.size());
+    vtkIdType numChunks = std::min(numParticles,
+      static_cast<vtkIdType>(32 * vtkSMPTools::GetEstimatedNumberOfThreads()));
+    std::vector<std::unique_ptr<ParticleChunk> > chunks(numChunks);
+    vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+    {
+      IntegrationThreadData& data = threadData.Local();
+      if (!data.Model)
+      {
+        data.Model.TakeReference(this->IntegrationModel->NewThreadedModel());
+        data.Integrator.TakeReference(this->Integrator->NewInstance());
+        data.Integrator->SetFunctionSet(data.Model);
+      }
+      for (; chunk < endChunk; ++chunk)
+      {
+        ParticleChunk* output = new ParticleChunk;
+        chunks[chunk].reset(output);
+        vtkIdType begin = chunk * numParticles / numChunks;
+        vtkIdType end = (chunk + 1) * numParticles / numChunks;
+
+        vtkPolyData* paths = NewPolyDataLike(particlePathsOutput);
+        output->Paths->ShallowCopy(paths);
+        paths->Delete();
+        output->Interactions.TakeReference(
+          NewInteractionOutputLike(interactionOutput));
+
+        // New particles store their seed data in the chunk, so that the seed
+        // data shared by the threads is not modified
+        output->SeedData = vtkSmartPointer<vtkPointData>::New();
+        output->SeedData->CopyAllocate(particles[begin]->GetSeedData(), 1);
+
+        vtkNew<vtkIdList> particlePathPointId;
+        for (vtkIdType i = begin; i < end; i++)
+        {
+          vtkLagrangianParticle* particle = particles[i];
+          particle->SetNewParticleSeedData(output->SeedData);
+          particlePathPointId->Reset();
+          this->IntegrateParticle(data.Model, data.Integrator, particle,
+            output->NewParticles, output->Paths, particlePathPointId,
+            output->Interactions, false);
+          particle->SetNewParticleSeedData(nullptr);
+
+          // Duplicate single point particle paths, to avoid degenerated lines.
+          if (particlePathPointId->GetNumberOfIds() == 1)
+          {
+            particlePathPointId->InsertNextId(particlePathPointId->GetId(0));
+          }
+          output->HasPath.push_back(particlePathPointId->GetNumberOfIds() > 0);
+          if (output->HasPath.back())
+          {
+            output->Lines->InsertNextCell(particlePathPointId);
+          }
+        }
+      }
+    });
+
+    // Append the outputs of the chunks in order
+    vtkCellArray* lines = particlePathsOutput->GetLines();
+    vtkCompositeDataSet* hdOutput = vtkCompositeDataSet::SafeDownCast(interactionOutput);
+    vtkPolyData* pdOutput = vtkPolyData::SafeDownCast(interactionOutput);
+    for (vtkIdType chunk = 0; chunk < numChunks; chunk++)
+    {
+      ParticleChunk* output = chunks[chunk].get();
+      vtkIdType offset = particlePathsOutput->GetNumberOfPoints();
+      AppendPoints(particlePathsOutput, output->Paths);
+
+      vtkIdType begin = chunk * numParticles / numChunks;
+      vtkIdType end = (chunk + 1) * numParticles / numChunks;
+      vtkIdType npts;
+      vtkIdType* pts;
+      output->Lines->InitTraversal();
+      for (vtkIdType i = begin; i < end; i++)
+      {
+        vtkLagrangianParticle* particle = particles[i];
+        if (output->HasPath[i - begin] && output->Lines->GetNextCell(npts, pts))
+        {
+          lines->InsertNextCell(npts);
+          for (vtkIdType j = 0; j < npts; j++)
+          {
+            lines->InsertCellPoint(pts[j] + offset);
+          }
+          this->InsertPathData(particle, particlePathsOutput->GetCellData());
+
+          // Insert data from seed data only on not yet written arrays
+          this->InsertSeedData(particle, particlePathsOutput->GetCellData());
+        }
+
+        // Delete integrated particle
+        delete particle;
+      }
+
+      if (hdOutput)
+      {
+        vtkCompositeDataSet* hdChunk =
+          vtkCompositeDataSet::SafeDownCast(output->Interactions);
+        vtkSmartPointer<vtkCompositeDataIterator> iter;
+        iter.TakeReference(hdOutput->NewIterator());
+        for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+        {
+          vtkPolyData* pd = vtkPolyData::SafeDownCast(hdOutput->GetDataSet(iter));
+          vtkPolyData* pdChunk = vtkPolyData::SafeDownCast(hdChunk->GetDataSet(iter));
+          if (pd && pdChunk)
+          {
+            AppendPoints(pd, pdChunk);
+          }
+        }
+      }
+      else if (pdOutput && pdOutput->GetPoints())
+      {
+        AppendPoints(pdOutput, vtkPolyData::SafeDownCast(output->Interactions));
+      }
+
+      // The new particles are integrated in the next batch
+      while (!output->NewParticles.empty())
+      {
+        particlesQueue.push(output->NewParticles.front());
+        output->NewParticles.pop();
+      }
+      chunksSeedData.push_back(output->SeedData);
+    }
+
+    numIntegrated += numParticles;
+    if (this->ParticleCounter > 0)
+    {
+      this->UpdateProgress(std::min(1.0,
+        static_cast<double>(numIntegrated) / this->ParticleCounter));
+    }
+  }
+
+  // Let the model gather the results of each thread
+  for (vtkSMPThreadLocal<IntegrationThreadData>::iterator iter = threadData.begin();
+    iter != threadData.end(); ++iter)
+  {
+    if ((*iter).Model)
+    {
+      this->IntegrationModel->FinalizeThreadedModel((*iter).Model);
+    }
+  }
+}
+
 //---------------------------------------------------------------------------
 int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
   std::queue<vtkLagrangianParticle*>& particlesQueue,
   vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
   vtkDataObject* interactionOutput)
+{
+  return this->IntegrateParticle(this->IntegrationModel, this->Integrator,
+    particle, particlesQueue, particlePathsOutput, particlePathPointId,
+    interactionOutput, true);
+}
+
+//---------------------------------------------------------------------------
+int vtkLagrangianParticleTracker::IntegrateParticle(
+  vtkLagrangianBasicIntegrationModel* model,
+  vtkInitialValueProblemSolver* integrator, vtkLagrangianParticle* particle,
+  std::queue<vtkLagrangianParticle*>& particlesQueue,
+  vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
+  vtkDataObject* interactionOutput, bool serial)
 {
   // Sanity check
   if (particle == nullptr)
@@ -983,7 +1269,8 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
   }
 
   // Set the current particle
-  this->IntegrationModel->SetCurrentParticle(particle);
+  model->SetCurrentParticle(particle);
+  vtkNew<vtkGenericCell> cell;
 
   // Integrate until MaximumNumberOfSteps is reached or special case stops integration
   int integrationRes = 0;
@@ -993,7 +1280,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
   while (particle->GetNumberOfSteps() < this->MaximumNumberOfSteps)
   {
     // Update progress
-    if (particle->GetNumberOfSteps() % 100 == 0 && this->ParticleCounter > 0)
+    if (serial && particle->GetNumberOfSteps() % 100 == 0 && this->ParticleCounter > 0)
     {
       double progress = static_cast<double>(particle->GetId() +
         static_cast<double>(particle->GetNumberOfSteps()) / this->MaximumNumberOfSteps) /
@@ -1009,7 +1296,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
     double velocityMagnitude = reintegrationFactor * std::max(
       this->MinimumVelocityMagnitude,
       vtkMath::Norm(particle->GetVelocity()));
-    double cellLength = this->ComputeCellLength(particle);
+    double cellLength = this->ComputeCellLength(model, particle, cell);
 
     double stepLength    = stepFactor          * cellLength;
     double stepLengthMin = this->StepFactorMin * cellLength;
@@ -1019,7 +1306,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
     double stepTimeMax = stepLengthMax / velocityMagnitude;
 
     // Integrate one step
-    if (!this->ComputeNextStep(particle->GetEquationVariables(),
+    if (!this->ComputeNextStep(model, integrator, particle->GetEquationVariables(),
       particle->GetNextEquationVariables(), particle->GetIntegrationTime(),
       stepTime, stepTimeActual, stepTimeMin, stepTimeMax, integrationRes))
     {
@@ -1041,7 +1328,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
 
     // Simpler Adaptive Step Reintegration code
     if (this->AdaptiveStepReintegration &&
-        this->IntegrationModel->CheckAdaptiveStepReintegration(particle))
+        model->CheckAdaptiveStepReintegration(particle))
     {
       double stepLengthCurr2 = vtkMath::Distance2BetweenPoints(
         particle->GetPosition(), particle->GetNextPosition());
@@ -1068,11 +1355,11 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
       vtkLagrangianBasicIntegrationModel::PassThroughParticlesType passThroughParticles;
       unsigned int interactedSurfaceFlaxIndex;
       vtkLagrangianParticle* interactionParticle =
-        this->IntegrationModel->ComputeSurfaceInteraction(
+        model->ComputeSurfaceInteraction(
         particle, particlesQueue, interactedSurfaceFlaxIndex, passThroughParticles);
       if (interactionParticle != nullptr)
       {
-        this->InsertInteractionOutputPoint(interactionParticle,
+        this->InsertInteractionOutputPoint(model, interactionParticle,
           interactedSurfaceFlaxIndex, interactionOutput);
         delete interactionParticle;
         interactionParticle = nullptr;
@@ -1088,7 +1375,8 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
         vtkLagrangianBasicIntegrationModel::PassThroughParticlesItem item =
           passThroughParticles.front();
         passThroughParticles.pop();
-        this->InsertInteractionOutputPoint(item.second, item.first, interactionOutput);
+        this->InsertInteractionOutputPoint(model, item.second, item.first,
+          interactionOutput);
 
         // the pass through particles needs to be deleted
         delete item.second;
@@ -1096,7 +1384,8 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
 
       // Particle has been correctly integrated and interacted, record it
       // Insert Current particle as an output point
-      this->InsertPathOutputPoint(particle, particlePathsOutput, particlePathPointId);
+      this->InsertPathOutputPoint(model, particle, particlePathsOutput,
+        particlePathPointId);
 
       // Particle has been terminated by surface
       if (particle->GetTermination() !=
@@ -1104,14 +1393,15 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
       {
         // Insert last particle path point on surface
         particle->MoveToNextPosition();
-        this->InsertPathOutputPoint(particle, particlePathsOutput, particlePathPointId);
+        this->InsertPathOutputPoint(model, particle, particlePathsOutput,
+          particlePathPointId);
 
         // stop integration
         break;
       }
     }
 
-    if (this->IntegrationModel->CheckFreeFlightTermination(particle))
+    if (model->CheckFreeFlightTermination(particle))
     {
       particle->SetTermination(
         vtkLagrangianParticle::PARTICLE_TERMINATION_FLIGHT_TERMINATED);
@@ -1122,7 +1412,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
     particle->MoveToNextPosition();
 
     // Compute now adaptive step
-    if (this->Integrator->IsAdaptive() || this->AdaptiveStepReintegration)
+    if (integrator->IsAdaptive() || this->AdaptiveStepReintegration)
     {
       stepFactor = stepTime * velocityMagnitude / cellLength;
     }
@@ -1134,7 +1424,7 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
     particle->SetTermination(
       vtkLagrangianParticle::PARTICLE_TERMINATION_OUT_OF_STEPS);
   }
-  this->IntegrationModel->SetCurrentParticle(nullptr);
+  model->SetCurrentParticle(nullptr);
   return integrationRes;
 }
 
@@ -1142,6 +1432,15 @@ int vtkLagrangianParticleTracker::Integrate(vtkLagrangianParticle* particle,
 void vtkLagrangianParticleTracker::InsertPathOutputPoint(
   vtkLagrangianParticle* particle, vtkPolyData* particlePathsOutput,
   vtkIdList* particlePathPointId, bool prev)
+{
+  this->InsertPathOutputPoint(this->IntegrationModel, particle,
+    particlePathsOutput, particlePathPointId, prev);
+}
+
+//---------------------------------------------------------------------------
+void vtkLagrangianParticleTracker::InsertPathOutputPoint(
+  vtkLagrangianBasicIntegrationModel* model, vtkLagrangianParticle* particle,
+  vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId, bool prev)
 {
   // Recover structures
   vtkPoints* particlePathsPoints = particlePathsOutput->GetPoints();
@@ -1159,7 +1458,7 @@ void vtkLagrangianParticleTracker::InsertPathOutputPoint(
     vtkLagrangianBasicIntegrationModel::VARIABLE_STEP_CURRENT);
 
   // Add Variables data
-  this->IntegrationModel->InsertVariablesParticleData(particle,
+  model->InsertVariablesParticleData(particle,
     particlePathsPointData, prev ?
     vtkLagrangianBasicIntegrationModel::VARIABLE_STEP_PREV :
     vtkLagrangianBasicIntegrationModel::VARIABLE_STEP_CURRENT);
@@ -1169,6 +1468,15 @@ void vtkLagrangianParticleTracker::InsertPathOutputPoint(
 void vtkLagrangianParticleTracker::InsertInteractionOutputPoint(
   vtkLagrangianParticle* particle, unsigned int interactedSurfaceFlatIndex,
   vtkDataObject* interactionOutput)
+{
+  this->InsertInteractionOutputPoint(this->IntegrationModel, particle,
+    interactedSurfaceFlatIndex, interactionOutput);
+}
+
+//---------------------------------------------------------------------------
+void vtkLagrangianParticleTracker::InsertInteractionOutputPoint(
+  vtkLagrangianBasicIntegrationModel* model, vtkLagrangianParticle* particle,
+  unsigned int interactedSurfaceFlatIndex, vtkDataObject* interactionOutput)
 {
   // Find the correct output
   vtkCompositeDataSet *hdOutput = vtkCompositeDataSet::SafeDownCast(interactionOutput);
@@ -1211,7 +1519,7 @@ void vtkLagrangianParticleTracker::InsertInteractionOutputPoint(
     vtkLagrangianBasicIntegrationModel::VARIABLE_STEP_NEXT);
 
   // Add Variables data
-  this->IntegrationModel->InsertVariablesParticleData(particle, pointData,
+  model->InsertVariablesParticleData(particle, pointData,
     vtkLagrangianBasicIntegrationModel::VARIABLE_STEP_NEXT);
 
   // Finally, Insert data from seed data only on not yet written arrays
@@ -1301,19 +1609,29 @@ void vtkLagrangianParticleTracker::InsertParticleData(vtkLagrangianParticle* par
 //---------------------------------------------------------------------------
 double vtkLagrangianParticleTracker::ComputeCellLength(
   vtkLagrangianParticle* particle)
+{
+  vtkNew<vtkGenericCell> cell;
+  return this->ComputeCellLength(this->IntegrationModel, particle, cell);
+}
+
+//---------------------------------------------------------------------------
+double vtkLagrangianParticleTracker::ComputeCellLength(
+  vtkLagrangianBasicIntegrationModel* model, vtkLagrangianParticle* particle,
+  vtkGenericCell* cell)
 {
   double cellLength = 1.0;
   vtkDataSet* dataset = nullptr;
-  vtkCell* cell = nullptr;
+  bool foundCell = false;
   bool forceLastCell = false;
   if (this->CellLengthComputationMode == STEP_CUR_CELL_LENGTH ||
     this->CellLengthComputationMode == STEP_CUR_CELL_VEL_DIR ||
     this->CellLengthComputationMode == STEP_CUR_CELL_DIV_THEO)
   {
     vtkIdType cellId;
-    if (this->IntegrationModel->FindInLocators(particle->GetPosition(), dataset, cellId))
+    if (model->FindInLocators(particle->GetPosition(), dataset, cellId))
     {
-      cell = dataset->GetCell(cellId);
+      dataset->GetCell(cellId, cell);
+      foundCell = true;
     }
     else
     {
@@ -1330,13 +1648,14 @@ double vtkLagrangianParticleTracker::ComputeCellLength(
     {
       return cellLength;
     }
-    cell = dataset->GetCell(particle->GetLastCellId());
-    if (!cell)
+    dataset->GetCell(particle->GetLastCellId(), cell);
+    if (cell->GetCellType() == VTK_EMPTY_CELL)
     {
       return cellLength;
     }
+    foundCell = true;
   }
-  if (cell == nullptr)
+  if (!foundCell)
   {
     vtkWarningMacro("Unsupported Cell Length Computation Mode"
       " or could not find a cell to compute cell length with");
@@ -1367,7 +1686,7 @@ double vtkLagrangianParticleTracker::ComputeCellLength(
   }
   else if ((this->CellLengthComputationMode == STEP_CUR_CELL_DIV_THEO ||
     this->CellLengthComputationMode == STEP_LAST_CELL_DIV_THEO) &&
-      vtkMath::Norm(vel) > 0.0 && !vtkVoxel::SafeDownCast(cell))
+      vtkMath::Norm(vel) > 0.0 && cell->GetCellType() != VTK_VOXEL)
   {
     double velHat[3] = {vel[0], vel[1], vel[2]};
     vtkMath::Normalize(velHat);
@@ -1410,16 +1729,29 @@ bool vtkLagrangianParticleTracker::ComputeNextStep(
   double t, double& delT, double& delTActual,
   double minStep, double maxStep,
   int& integrationRes)
+{
+  return this->ComputeNextStep(this->IntegrationModel, this->Integrator,
+    xprev, xnext, t, delT, delTActual, minStep, maxStep, integrationRes);
+}
+
+//---------------------------------------------------------------------------
+bool vtkLagrangianParticleTracker::ComputeNextStep(
+  vtkLagrangianBasicIntegrationModel* model,
+  vtkInitialValueProblemSolver* integrator,
+  double* xprev, double* xnext,
+  double t, double& delT, double& delTActual,
+  double minStep, double maxStep,
+  int& integrationRes)
 {
   // Check for potential manual integration
   double error;
-  if (!this->IntegrationModel->ManualIntegration(xprev, xnext, t, delT, delTActual,
-    minStep, maxStep, this->IntegrationModel->GetTolerance(), error, integrationRes))
+  if (!model->ManualIntegration(xprev, xnext, t, delT, delTActual,
+    minStep, maxStep, model->GetTolerance(), error, integrationRes))
   {
     // integrate one step
     integrationRes =
-      this->Integrator->ComputeNextStep(xprev, xnext, t, delT, delTActual,
-        minStep, maxStep, this->IntegrationModel->GetTolerance(), error);
+      integrator->ComputeNextStep(xprev, xnext, t, delT, delTActual,
+        minStep, maxStep, model->GetTolerance(), error);
   }
 
   // Check failure cases
@@ -40,6 +40,9 @@
  *
  * It has a parallel implementation which streams particle between domains.
  *
+ * When EnableSMP is on, the particles are integrated concurrently using
+ * vtkSMPTools, each thread with its own copy of the integration model.
+ *
  * The most important parameters of this filter is it's integrationModel.
  * Only one integration model implementation exist currently in ParaView
  * ,vtkLagrangianMatidaIntegrationModel but the design enables plugin developers
@@ -91,12 +94,14 @@
 #include "vtkDataObjectAlgorithm.h"
 #include "vtkBoundingBox.h" // For cached bounds
 
+#include <atomic> // for particle counter
 #include <queue> // for particle queue
 
 class vtkBoundingBox;
 class vtkCellArray;
 class vtkDataSet;
 class vtkDoubleArray;
+class vtkGenericCell;
 class vtkIdList;
 class vtkInformation;
 class vtkInitialValueProblemSolver;
@@ -248,6 +253,23 @@ public:
   vtkBooleanMacro(CreateOutOfDomainParticle, bool);
   //@}
 
+  //@{
+  /**
+   * Set/Get the concurrent integration of particles using vtkSMPTools.
+   * The particles available at once are split between threads, each one
+   * using its own copy of the integration model created with
+   * vtkLagrangianBasicIntegrationModel::NewThreadedModel, and the outputs
+   * are appended in the same order as when integrating particles one by one.
+   * Only the ids of the particles created by surface interactions may differ.
+   * The integration model, its locator and the integrator must be thread
+   * safe, so this is off by default. Ignored by the parallel tracker when
+   * running on more than one process.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
   //@{
   /**
    * Specify the source object used to generate particle initial position (seeds).
@@ -357,12 +379,46 @@ protected:
     vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
     vtkDataObject* interactionOutput);
 
+  /**
+   * Integrate a particle with the provided integration model and integrator,
+   * which are the ones of the tracker in Integrate and copies of them when
+   * integrating particles concurrently. Progress is only updated when serial
+   * is true.
+   */
+  int IntegrateParticle(vtkLagrangianBasicIntegrationModel* model,
+    vtkInitialValueProblemSolver* integrator, vtkLagrangianParticle* particle,
+    std::queue<vtkLagrangianParticle*>& particlesQueue,
+    vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
+    vtkDataObject* interactionOutput, bool serial);
+
+  /**
+   * Return true if the particles can be integrated concurrently,
+   * that is when EnableSMP is on.
+   */
+  virtual bool CanIntegrateInParallel();
+
+  /**
+   * Integrate the particles of the queue, and the particles they create,
+   * concurrently. Each batch of particles available at once is split into
+   * chunks integrated by different threads in their own outputs, which are
+   * then appended in order to the outputs of the tracker.
+   */
+  virtual void IntegrateParticlesInParallel(
+    std::queue<vtkLagrangianParticle*>& particlesQueue,
+    vtkPolyData* particlePathsOutput, vtkDataObject* interactionOutput);
+
   void InsertPathOutputPoint(vtkLagrangianParticle* particle,
     vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
     bool prev = false);
+  void InsertPathOutputPoint(vtkLagrangianBasicIntegrationModel* model,
+    vtkLagrangianParticle* particle, vtkPolyData* particlePathsOutput,
+    vtkIdList* particlePathPointId, bool prev = false);
 
   void InsertInteractionOutputPoint(vtkLagrangianParticle* particle,
     unsigned int interactedSurfaceFlatIndex, vtkDataObject* interactionOutput);
+  void InsertInteractionOutputPoint(vtkLagrangianBasicIntegrationModel* model,
+    vtkLagrangianParticle* particle, unsigned int interactedSurfaceFlatIndex,
+    vtkDataObject* interactionOutput);
 
   void InsertSeedData(vtkLagrangianParticle* particle, vtkFieldData* data);
   void InsertPathData(vtkLagrangianParticle* particle, vtkFieldData* data);
@@ -370,12 +426,20 @@ protected:
   void InsertParticleData(vtkLagrangianParticle* particle, vtkFieldData* data, int stepEnum);
 
   double ComputeCellLength(vtkLagrangianParticle* particle);
+  double ComputeCellLength(vtkLagrangianBasicIntegrationModel* model,
+    vtkLagrangianParticle* particle, vtkGenericCell* cell);
 
   bool ComputeNextStep(
     double* xprev, double* xnext,
     double t, double& delT, double& delTActual,
     double minStep, double maxStep,
     int& integrationRes);
+  bool ComputeNextStep(vtkLagrangianBasicIntegrationModel* model,
+    vtkInitialValueProblemSolver* integrator,
+    double* xprev, double* xnext,
+    double t, double& delT, double& delTActual,
+    double minStep, double maxStep,
+    int& integrationRes);
 
   virtual bool CheckParticlePathsRenderingThreshold(vtkPolyData* particlePathsOutput);
 
@@ -392,7 +456,8 @@ protected:
   bool GeneratePolyVertexInteractionOutput;
   int ParticlePathsRenderingPointsThreshold;
   bool CreateOutOfDomainParticle;
-  vtkIdType ParticleCounter;
+  bool EnableSMP;
+  std::atomic<vtkIdType> ParticleCounter;
 
   // internal parameters use for step computation
   double MinimumVelocityMagnitude;
@@ -34,6 +34,8 @@
 #include "vtkRungeKutta2.h"
 #include "vtkRungeKutta4.h"
 #include "vtkRungeKutta45.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTemporalInterpolatedVelocityField.h"
@@ -53,6 +55,17 @@ const double vtkParticleTracerBase::Epsilon = 1.0E-12;
 
 using namespace vtkParticleTracerBaseNamespace;
 
+namespace
+{
+  // The copies of the interpolator and integrator used by each thread to
+  // advance particles.
+  struct AdvanceThreadData
+  {
+    vtkSmartPointer<vtkTemporalInterpolatedVelocityField> Interpolator;
+    vtkSmartPointer<vtkInitialValueProblemSolver> Integrator;
+  };
+}
+
 vtkCxxSetObjectMacro(vtkParticleTracerBase, ParticleWriter, vtkAbstractParticleWriter);
 vtkCxxSetObjectMacro(vtkParticleTracerBase,Integrator,vtkInitialValueProblemSolver);
 
@@ -146,6 +159,7 @@ vtkParticleTracerBase::vtkParticleTracerBase()
 
   this->SetIntegratorType(RUNGE_KUTTA4);
   this->DisableResetCache = 0;
+  this->EnableSMP = false;
 }
 
 //---------------------------------------------------------------------------
@@ -854,7 +868,6 @@ vtkPolyData* vtkParticleTracerBase::Execute(vtkInformationVector** inputVector)
   {
     ParticleListIterator  it_first = this->ParticleHistories.begin();
     ParticleListIterator  it_last  = this->ParticleHistories.end();
-    ParticleListIterator  it_next;
 
     //
     // Perform multiple passes. The number of passes is equal to one more than
@@ -864,19 +877,14 @@ vtkPolyData* vtkParticleTracerBase::Execute(vtkInformationVector** inputVector)
     while(continueExecuting)
     {
       vtkDebugMacro(<<"Begin Pass " << pass << " with " << this->ParticleHistories.size() << " Particles");
-      for (ParticleListIterator it=it_first; it!=it_last;)
+      // Collect the iterators first because if a particle is terminated
+      // or leaves the domain, its iterator will be deleted.
+      std::vector<ParticleListIterator> particles;
+      for (ParticleListIterator it=it_first; it!=it_last; ++it)
       {
-        // Keep the 'next' iterator handy because if a particle is terminated
-        // or leaves the domain, the 'current' iterator will be deleted.
-        it_next = it;
-        it_next++;
-        this->IntegrateParticle(it, from, this->CurrentTimeValue, integrator);
-        if (this->GetAbortExecute())
-        {
-          break;
-        }
-        it = it_next;
+        particles.push_back(it);
       }
+      this->IntegrateParticles(particles, from, this->CurrentTimeValue, integrator);
       // Particles might have been deleted during the first pass as they move
       // out of domain or age. Before adding any new particles that are sent
       // to us, we must know the starting point ready for the next pass
@@ -1055,20 +1063,117 @@ int vtkParticleTracerBase::RequestData(
   return 1;
 }
 
+//---------------------------------------------------------------------------
+struct vtkParticleTracerBase::AdvanceResult
+{
+  enum
+  {
+    ADVANCED,
+    STEP_FAILED,
+    OUTSIDE_ALL
+  };
+
+  // The particle before it was advanced, needed to send it
+  ParticleInformation Previous;
+  int Status;
+  bool Integrated;
+  double Velocity[3];
+  vtkIdType CachedCellId[2];
+  int CachedDataSetId[2];
+};
+
 //---------------------------------------------------------------------------
 void vtkParticleTracerBase::IntegrateParticle(
   ParticleListIterator &it, double currenttime, double targettime,
   vtkInitialValueProblemSolver* integrator)
+{
+  AdvanceResult result;
+  this->AdvanceParticle(
+    *it, currenttime, targettime, this->Interpolator, integrator, result);
+  this->FinishParticle(it, result, false);
+}
+
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::IntegrateParticles(
+  std::vector<ParticleListIterator> &particles, double currenttime,
+  double targettime, vtkInitialValueProblemSolver* integrator)
+{
+  vtkIdType numParticles = static_cast<vtkIdType>(particles.size());
+  if (!this->EnableSMP || numParticles < 2)
+  {
+    for (vtkIdType i = 0; i < numParticles; i++)
+    {
+      this->IntegrateParticle(particles[i], currenttime, targettime, integrator);
+      if (this->GetAbortExecute())
+      {
+        break;
+      }
+    }
+    return;
+  }
+
+  if (this->GetAbortExecute())
+  {
+    return;
+  }
+
+  // The cell locators are built now and shared by the copies of the
+  // interpolator made by each thread.
+  this->Interpolator->BuildSearchStructures();
+
+  std::vector<AdvanceResult> results(numParticles);
+  vtkSMPThreadLocal<AdvanceThreadData> threadData;
+  vtkSMPTools::For(0, numParticles, [&](vtkIdType begin, vtkIdType end)
+  {
+    AdvanceThreadData& data = threadData.Local();
+    if (!data.Interpolator)
+    {
+      data.Interpolator =
+        vtkSmartPointer<vtkTemporalInterpolatedVelocityField>::New();
+      data.Interpolator->CopyDataSets(this->Interpolator);
+      data.Integrator.TakeReference(integrator->NewInstance());
+      data.Integrator->SetFunctionSet(data.Interpolator);
+    }
+    for (vtkIdType i = begin; i < end; i++)
+    {
+      this->AdvanceParticle(*particles[i], currenttime, targettime,
+        data.Interpolator, data.Integrator, results[i]);
+    }
+  });
+
+  // Particles are sent, removed and added to the output in order. After an
+  // abort, the particles that are not finished are restored, as if they
+  // had not been advanced.
+  for (vtkIdType i = 0; i < numParticles; i++)
+  {
+    this->FinishParticle(particles[i], results[i], true);
+    if (this->GetAbortExecute())
+    {
+      for (vtkIdType j = i + 1; j < numParticles; j++)
+      {
+        *particles[j] = results[j].Previous;
+      }
+      break;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::AdvanceParticle(
+  ParticleInformation &info, double currenttime, double targettime,
+  vtkTemporalInterpolatedVelocityField* interpolator,
+  vtkInitialValueProblemSolver* integrator, AdvanceResult &result)
 {
   double epsilon = (targettime-currenttime)/100.0;
-  double velocity[3], point1[4], point2[4] = {0.0, 0.0, 0.0, 0.0};
+  double point1[4], point2[4] = {0.0, 0.0, 0.0, 0.0};
   double minStep=0, maxStep=0;
   double stepWanted, stepTaken=0.0;
   int substeps = 0;
 
-  ParticleInformation &info = (*it);
-  ParticleInformation previous = (*it);
-  bool particle_good = true;
+  result.Previous = info;
+  result.Status = AdvanceResult::ADVANCED;
+  result.Integrated = false;
+  result.Velocity[0] = result.Velocity[1] = result.Velocity[2] = 0.0;
 
   info.ErrorCode = 0;
 
@@ -1089,11 +1194,11 @@ void vtkParticleTracerBase::IntegrateParticle(
     //
     if(this->AllFixedGeometry)
     {
-      this->Interpolator->SetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
+      interpolator->SetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
     }
     else
     {
-      this->Interpolator->ClearCache();
+      interpolator->ClearCache();
     }
 
     double delT = (targettime-currenttime) * this->IntegrationStep;
@@ -1124,19 +1229,10 @@ void vtkParticleTracerBase::IntegrateParticle(
       {
         // if the particle is sent, remove it from the list
         info.ErrorCode = 1;
-        if (!this->RetryWithPush(info, point1, delT, substeps))
+        if (!this->RetryWithPush(info, point1, delT, substeps, interpolator))
         {
-          if(previous.PointId <0 && previous.TailPointId < 0)
-          {
-            vtkErrorMacro("the particle should have been added");
-          }
-          else
-          {
-            this->SendParticleToAnotherProcess(info,previous, this->ParticlePointData);
-          }
-          this->ParticleHistories.erase(it);
-          particle_good = false;
-          break;
+          result.Status = AdvanceResult::STEP_FAILED;
+          return;
         }
         else
         {
@@ -1170,36 +1266,67 @@ void vtkParticleTracerBase::IntegrateParticle(
       }
     }
 
-    if (particle_good)
+    // The integration succeeded, but check the computed final position
+    // is actually inside the domain (the intermediate steps taken inside
+    // the integrator were ok, but the final step may just pass out)
+    // if it moves out, we can't interpolate scalars, so we must send it away
+    info.LocationState = interpolator->TestPoint(info.CurrentPosition.x);
+    if (info.LocationState==ID_OUTSIDE_ALL)
     {
-      // The integration succeeded, but check the computed final position
-      // is actually inside the domain (the intermediate steps taken inside
-      // the integrator were ok, but the final step may just pass out)
-      // if it moves out, we can't interpolate scalars, so we must send it away
-      info.LocationState = this->Interpolator->TestPoint(info.CurrentPosition.x);
-      if (info.LocationState==ID_OUTSIDE_ALL)
-      {
-        info.ErrorCode = 2;
-        // if the particle is sent, remove it from the list
-        if (this->SendParticleToAnotherProcess(info,previous,this->OutputPointData))
-        {
-          this->ParticleHistories.erase(it);
-          particle_good = false;
-        }
-      }
+      info.ErrorCode = 2;
+      result.Status = AdvanceResult::OUTSIDE_ALL;
     }
+    interpolator->GetLastGoodVelocity(result.Velocity);
+    result.Integrated = true;
+  }
 
-    // Has this particle stagnated
-    //
-    if (particle_good)
+  //
+  // store the last Cell Ids and dataset indices for next time particle is updated
+  //
+  interpolator->GetCachedCellIds(result.CachedCellId, result.CachedDataSetId);
+
+#ifdef DEBUGPARTICLETRACE
+  double eps = (this->GetCacheDataTime(1)-this->GetCacheDataTime(0))/100;
+  Assert (point1[3]>=(this->GetCacheDataTime(0)-eps) && point1[3]<=(this->GetCacheDataTime(1)+eps));
+#endif
+}
+
+//---------------------------------------------------------------------------
+void vtkParticleTracerBase::FinishParticle(
+  ParticleListIterator &it, AdvanceResult &result, bool restoreInterpolator)
+{
+  ParticleInformation &info = (*it);
+  bool particle_good = true;
+
+  if (result.Status==AdvanceResult::STEP_FAILED)
+  {
+    if(result.Previous.PointId <0 && result.Previous.TailPointId < 0)
     {
-      this->Interpolator->GetLastGoodVelocity(velocity);
-      info.speed = vtkMath::Norm(velocity);
-      if (it->speed <= this->TerminalSpeed)
-      {
-        this->ParticleHistories.erase(it);
-        particle_good = false;
-      }
+      vtkErrorMacro("the particle should have been added");
+    }
+    else
+    {
+      this->SendParticleToAnotherProcess(info, result.Previous, this->ParticlePointData);
+    }
+    particle_good = false;
+  }
+  else if (result.Status==AdvanceResult::OUTSIDE_ALL)
+  {
+    // if the particle is sent, remove it from the list
+    if (this->SendParticleToAnotherProcess(info, result.Previous, this->OutputPointData))
+    {
+      particle_good = false;
+    }
+  }
+
+  // Has this particle stagnated
+  //
+  if (particle_good && result.Integrated)
+  {
+    info.speed = vtkMath::Norm(result.Velocity);
+    if (info.speed <= this->TerminalSpeed)
+    {
+      particle_good = false;
     }
   }
 
@@ -1214,23 +1341,31 @@ void vtkParticleTracerBase::IntegrateParticle(
     //
     // store the last Cell Ids and dataset indices for next time particle is updated
     //
-    this->Interpolator->GetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
+    info.CachedCellId[0] = result.CachedCellId[0];
+    info.CachedCellId[1] = result.CachedCellId[1];
+    info.CachedDataSetId[0] = result.CachedDataSetId[0];
+    info.CachedDataSetId[1] = result.CachedDataSetId[1];
     //
     info.TimeStepAge += 1;
     //
+    // The point attributes are interpolated with the cells and weights
+    // found at the final position of the particle
+    //
+    if (restoreInterpolator && result.Integrated)
+    {
+      this->Interpolator->SetCachedCellIds(info.CachedCellId, info.CachedDataSetId);
+      this->Interpolator->TestPoint(info.CurrentPosition.x);
+    }
+    //
     // Now generate the output geometry and scalars
     //
-    this->AddParticle(info,velocity);
+    this->AddParticle(info, result.Velocity);
   }
   else
   {
+    this->ParticleHistories.erase(it);
     this->Interpolator->ClearCache();
   }
-
-#ifdef DEBUGPARTICLETRACE
-  double eps = (this->GetCacheDataTime(1)-this->GetCacheDataTime(0))/100;
-  Assert (point1[3]>=(this->GetCacheDataTime(0)-eps) && point1[3]<=(this->GetCacheDataTime(1)+eps));
-#endif
 }
 
 //---------------------------------------------------------------------------
@@ -1244,6 +1379,7 @@ void vtkParticleTracerBase::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ForceReinjectionEveryNSteps: "
      << this->ForceReinjectionEveryNSteps << endl;
   os << indent << "EnableParticleWriting: " << this->EnableParticleWriting << endl;
+  os << indent << "EnableSMP: " << this->EnableSMP << endl;
   os << indent << "IgnorePipelineTime: " << this->IgnorePipelineTime << endl;
   os << indent << "StaticMesh: " << this->StaticMesh << endl;
   os << indent << "TerminationTime: " << this->TerminationTime << endl;
@@ -1448,11 +1584,19 @@ void vtkParticleTracerBase::CreateProtoPD(vtkDataObject* input)
 //---------------------------------------------------------------------------
 bool vtkParticleTracerBase::RetryWithPush(
   ParticleInformation &info,  double* point1,double delT, int substeps)
+{
+  return this->RetryWithPush(info, point1, delT, substeps, this->Interpolator);
+}
+
+//---------------------------------------------------------------------------
+bool vtkParticleTracerBase::RetryWithPush(
+  ParticleInformation &info,  double* point1,double delT, int substeps,
+  vtkTemporalInterpolatedVelocityField* interpolator)
 {
   double velocity[3];
-  this->Interpolator->ClearCache();
+  interpolator->ClearCache();
 
-  info.LocationState = this->Interpolator->TestPoint(point1);
+  info.LocationState = interpolator->TestPoint(point1);
 
   if (info.LocationState==ID_OUTSIDE_ALL)
   {
@@ -1461,7 +1605,7 @@ bool vtkParticleTracerBase::RetryWithPush(
     // send the particle 'as is' and hope it lands in another process
     if (substeps>0)
     {
-      this->Interpolator->GetLastGoodVelocity(velocity);
+      interpolator->GetLastGoodVelocity(velocity);
     }
     else
     {
@@ -1472,19 +1616,19 @@ bool vtkParticleTracerBase::RetryWithPush(
   else if (info.LocationState==ID_OUTSIDE_T0)
   {
     // the particle left the volume but can be tested at T2, so use the velocity at T2
-    this->Interpolator->GetLastGoodVelocity(velocity);
+    interpolator->GetLastGoodVelocity(velocity);
     info.ErrorCode = 4;
   }
   else if (info.LocationState==ID_OUTSIDE_T1)
   {
     // the particle left the volume but can be tested at T1, so use the velocity at T1
-    this->Interpolator->GetLastGoodVelocity(velocity);
+    interpolator->GetLastGoodVelocity(velocity);
     info.ErrorCode = 5;
   }
   else
   {
     // The test returned INSIDE_ALL, so test failed near start of integration,
-    this->Interpolator->GetLastGoodVelocity(velocity);
+    interpolator->GetLastGoodVelocity(velocity);
   }
 
   // try adding a one increment push to the particle to get over a rotating/moving boundary
@@ -1494,7 +1638,7 @@ bool vtkParticleTracerBase::RetryWithPush(
   }
 
   info.CurrentPosition.x[3] += delT;
-  info.LocationState = this->Interpolator->TestPoint(info.CurrentPosition.x);
+  info.LocationState = interpolator->TestPoint(info.CurrentPosition.x);
   info.age += delT;
   info.SimulationTime += delT; // = this->GetCurrentTimeValue();
 
@@ -20,6 +20,11 @@
  * in a vector field. Note that the input vtkPointData structure must
  * be identical on all datasets.
  *
+ * When EnableSMP is on, the particles are advanced concurrently using
+ * vtkSMPTools, each thread with its own copy of the interpolator sharing the
+ * cell locators of the input. They are then added to the output, or sent to
+ * other processes, in the same order as when they are advanced one by one.
+ *
  * @sa
  * vtkRibbonFilter vtkRuledSurfaceFilter vtkInitialValueProblemSolver
  * vtkRungeKutta2 vtkRungeKutta4 vtkRungeKutta45 vtkStreamTracer
@@ -254,6 +259,21 @@ public:
   vtkBooleanMacro(DisableResetCache,vtkTypeBool);
   //@}
 
+  //@{
+  /**
+   * Set/Get the concurrent advection of particles using vtkSMPTools. The
+   * particles of each pass are advanced by several threads, each one using
+   * its own copy of the interpolator and integrator, then added to the
+   * output or sent to other processes in the same order as when advancing
+   * them one by one, so that the output does not change. The integrator and
+   * the interpolator prototype must be thread safe, so this is off by
+   * default.
+   */
+  vtkSetMacro(EnableSMP, bool);
+  vtkGetMacro(EnableSMP, bool);
+  vtkBooleanMacro(EnableSMP, bool);
+  //@}
+
   //@{
   /**
    * Provide support for multiple seed sources
@@ -398,6 +418,39 @@ public:
     double currenttime, double terminationtime,
     vtkInitialValueProblemSolver* integrator);
 
+  /**
+   * Integrate a list of particles between the two times supplied. When
+   * EnableSMP is on, the particles are advanced concurrently, each thread
+   * with its own copy of the interpolator and integrator, then they are
+   * sent, removed or added to the output in the order of the list, so that
+   * the output is the same as when calling IntegrateParticle on each of
+   * them. When the execution is aborted, the particles that were not
+   * finished are left as they were before being advanced.
+   */
+  void IntegrateParticles(
+    std::vector<vtkParticleTracerBaseNamespace::ParticleListIterator> &particles,
+    double currenttime, double terminationtime,
+    vtkInitialValueProblemSolver* integrator);
+
+  /**
+   * The two halves of IntegrateParticle. AdvanceParticle only moves the
+   * particle with the given interpolator and integrator and records what has
+   * to be done with it in result; it can be called concurrently for different
+   * particles. FinishParticle then sends, removes or adds the particle to the
+   * output. When restoreInterpolator is true, the interpolator of the filter
+   * is first moved to the final position of the particle, which is needed
+   * when the particle was advanced with another interpolator.
+   */
+  struct AdvanceResult;
+  void AdvanceParticle(
+    vtkParticleTracerBaseNamespace::ParticleInformation &info,
+    double currenttime, double terminationtime,
+    vtkTemporalInterpolatedVelocityField* interpolator,
+    vtkInitialValueProblemSolver* integrator, AdvanceResult &result);
+  void FinishParticle(
+    vtkParticleTracerBaseNamespace::ParticleListIterator &it,
+    AdvanceResult &result, bool restoreInterpolator);
+
   // if the particle is added to send list, then returns value is 1,
   // if it is kept on this process after a retry return value is 0
   virtual bool SendParticleToAnotherProcess(
@@ -494,6 +547,9 @@ public:
    */
   bool RetryWithPush(
     vtkParticleTracerBaseNamespace::ParticleInformation &info, double* point1,double delT, int subSteps);
+  bool RetryWithPush(
+    vtkParticleTracerBaseNamespace::ParticleInformation &info, double* point1,double delT, int subSteps,
+    vtkTemporalInterpolatedVelocityField* interpolator);
 
   bool SetTerminationTimeNoModify(double t);
 
@@ -533,6 +589,8 @@ public:
   char                      *ParticleFileName;
   vtkTypeBool                        EnableParticleWriting;
 
+  bool EnableSMP;
+
 
   // The main lists which are held during operation- between time step updates
   vtkParticleTracerBaseNamespace::ParticleVector    LocalSeeds;
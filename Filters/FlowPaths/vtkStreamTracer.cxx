@@ -45,8 +45,14 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkRungeKutta2.h"
 #include "vtkRungeKutta4.h"
 #include "vtkRungeKutta45.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <vector>
 
 vtkObjectFactoryNewMacro(vtkStreamTracer)
@@ -89,6 +95,16 @@ namespace
     }
   }
 
+  // The function set, integrator and work arrays of a thread integrating
+  // streamlines.
+  struct IntegrationThreadData
+  {
+    vtkSmartPointer<vtkAbstractInterpolatedVelocityField> Func;
+    vtkSmartPointer<vtkInitialValueProblemSolver> Integrator;
+    vtkSmartPointer<vtkGenericCell> Cell;
+    std::vector<double> Weights;
+  };
+
 }
 
 vtkStreamTracer::vtkStreamTracer()
@@ -514,12 +530,18 @@ int vtkStreamTracer::RequestData(
       double propagation = 0;
       vtkIdType numSteps = 0;
       double integrationTime = 0;
-      this->Integrate(input0->GetPointData(), output,
-                      seeds, seedIds,
-                      integrationDirections,
-                      lastPoint, func,
-                      maxCellSize, vecType,vecName,
-                      propagation, numSteps, integrationTime);
+      if (!this->IntegrateInParallel(input0->GetPointData(), output,
+                                     seeds, seedIds,
+                                     integrationDirections, func,
+                                     maxCellSize, vecType, vecName))
+      {
+        this->Integrate(input0->GetPointData(), output,
+                        seeds, seedIds,
+                        integrationDirections,
+                        lastPoint, func,
+                        maxCellSize, vecType,vecName,
+                        propagation, numSteps, integrationTime);
+      }
     }
     func->Delete();
     seeds->Delete();
@@ -653,6 +675,135 @@ int vtkStreamTracer::CheckInputs(vtkAbstractInterpolatedVelocityField*& func,
   return VTK_OK;
 }
 
+// The streamlines of a range of seeds. The input point data is interpolated
+// in PointData as the points are inserted, the other point arrays are only
+// added to PointData by SetOutput().
+class vtkStreamTracer::Streamlines
+{
+public:
+  Streamlines(vtkPointData* inputPD, vtkDataSetAttributes* pointData,
+              int vecType, const char* vecName, bool computeVorticity,
+              vtkIdType numPts)
+    : PointData(pointData), LastUsedStepSize(0.0), HasLastUsedStepSize(false)
+  {
+    this->PointData->InterpolateAllocate(inputPD, numPts);
+
+    // We will keep track of integration time in this array
+    this->Time->SetName("IntegrationTime");
+
+    // This array explains why the integration stopped
+    this->ReasonForTermination->SetName("ReasonForTermination");
+
+    this->SeedIds->SetName("SeedIds");
+
+    if(vecType != vtkDataObject::POINT)
+    {
+      this->VelocityVectors = vtkSmartPointer<vtkDoubleArray>::New();
+      this->VelocityVectors->SetName(vecName);
+      this->VelocityVectors->SetNumberOfComponents(3);
+    }
+    if (computeVorticity)
+    {
+      this->CellVectors = vtkSmartPointer<vtkDoubleArray>::New();
+      this->CellVectors->SetNumberOfComponents(3);
+      this->CellVectors->Allocate(3*VTK_CELL_SIZE);
+
+      this->Vorticity = vtkSmartPointer<vtkDoubleArray>::New();
+      this->Vorticity->SetName("Vorticity");
+      this->Vorticity->SetNumberOfComponents(3);
+
+      this->Rotation = vtkSmartPointer<vtkDoubleArray>::New();
+      this->Rotation->SetName("Rotation");
+
+      this->AngularVelocity = vtkSmartPointer<vtkDoubleArray>::New();
+      this->AngularVelocity->SetName("AngularVelocity");
+    }
+  }
+
+  // Append the streamlines of other, which must have the same arrays.
+  void Append(Streamlines& other)
+  {
+    vtkIdType offset = this->Points->GetNumberOfPoints();
+    vtkIdType numPts = other.Points->GetNumberOfPoints();
+    this->Points->InsertPoints(offset, numPts, 0, other.Points);
+    for (int i = 0; i < this->PointData->GetNumberOfArrays(); i++)
+    {
+      this->PointData->GetAbstractArray(i)->InsertTuples(
+        offset, numPts, 0, other.PointData->GetAbstractArray(i));
+    }
+    vtkDataArray* pointArrays[] = { this->Time, this->VelocityVectors,
+      this->Vorticity, this->Rotation, this->AngularVelocity };
+    vtkDataArray* otherPointArrays[] = { other.Time, other.VelocityVectors,
+      other.Vorticity, other.Rotation, other.AngularVelocity };
+    for (int i = 0; i < 5; i++)
+    {
+      if (pointArrays[i])
+      {
+        pointArrays[i]->InsertTuples(offset, numPts, 0, otherPointArrays[i]);
+      }
+    }
+
+    vtkIdType numLines = other.Lines->GetNumberOfCells();
+    vtkIdType npts;
+    vtkIdType* pts;
+    other.Lines->InitTraversal();
+    while (other.Lines->GetNextCell(npts, pts))
+    {
+      this->Lines->InsertNextCell(npts);
+      for (vtkIdType i = 0; i < npts; i++)
+      {
+        this->Lines->InsertCellPoint(offset + pts[i]);
+      }
+    }
+    this->ReasonForTermination->InsertTuples(
+      this->ReasonForTermination->GetNumberOfTuples(), numLines, 0,
+      other.ReasonForTermination);
+    this->SeedIds->InsertTuples(this->SeedIds->GetNumberOfTuples(), numLines,
+                                0, other.SeedIds);
+  }
+
+  // Create the output polylines
+  void SetOutput(vtkPolyData* output)
+  {
+    output->SetPoints(this->Points);
+    this->PointData->AddArray(this->Time);
+    if (this->VelocityVectors)
+    {
+      this->PointData->AddArray(this->VelocityVectors);
+    }
+    if (this->Vorticity)
+    {
+      this->PointData->AddArray(this->Vorticity);
+      this->PointData->AddArray(this->Rotation);
+      this->PointData->AddArray(this->AngularVelocity);
+    }
+
+    if (this->Points->GetNumberOfPoints() > 1)
+    {
+      output->SetLines(this->Lines);
+      output->GetCellData()->AddArray(this->ReasonForTermination);
+      output->GetCellData()->AddArray(this->SeedIds);
+    }
+  }
+
+  vtkSmartPointer<vtkDataSetAttributes> PointData;
+  // Step size of the last integration step, if any was taken
+  double LastUsedStepSize;
+  bool HasLastUsedStepSize;
+  vtkNew<vtkPoints> Points;
+  vtkNew<vtkCellArray> Lines;
+  vtkNew<vtkDoubleArray> Time;
+  vtkNew<vtkIntArray> ReasonForTermination;
+  vtkNew<vtkIntArray> SeedIds;
+  // Only with cell velocities
+  vtkSmartPointer<vtkDoubleArray> VelocityVectors;
+  // Only when computing the vorticity
+  vtkSmartPointer<vtkDoubleArray> CellVectors;
+  vtkSmartPointer<vtkDoubleArray> Vorticity;
+  vtkSmartPointer<vtkDoubleArray> Rotation;
+  vtkSmartPointer<vtkDoubleArray> AngularVelocity;
+};
+
 void vtkStreamTracer::Integrate(vtkPointData *input0Data,
                                 vtkPolyData* output,
                                 vtkDataArray* seedSource,
@@ -667,20 +818,6 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
                                 vtkIdType& inNumSteps,
                                 double &inIntegrationTime)
 {
-  vtkIdType numLines = seedIds->GetNumberOfIds();
-  double propagation = inPropagation;
-  vtkIdType numSteps = inNumSteps;
-  double integrationTime = inIntegrationTime;
-
-  // Useful pointers
-  vtkDataSetAttributes* outputPD = output->GetPointData();
-  vtkDataSetAttributes* outputCD = output->GetCellData();
-  vtkPointData* inputPD;
-  vtkDataSet* input;
-  vtkDataArray* inVectors;
-
-  int direction=1;
-
   if (this->GetIntegrator() == nullptr)
   {
     vtkErrorMacro("No integrator is specified.");
@@ -725,48 +862,7 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
   // were to allocate any points here, potentially, we can
   // waste a lot of memory if a lot of streamers are used.
   // Always insert the first point
-  vtkPoints* outputPoints = vtkPoints::New();
-  vtkCellArray* outputLines = vtkCellArray::New();
-
-  // We will keep track of integration time in this array
-  vtkDoubleArray* time = vtkDoubleArray::New();
-  time->SetName("IntegrationTime");
-
-  // This array explains why the integration stopped
-  vtkIntArray* retVals = vtkIntArray::New();
-  retVals->SetName("ReasonForTermination");
-
-  vtkIntArray* sids = vtkIntArray::New();
-  sids->SetName("SeedIds");
-
-  vtkSmartPointer<vtkDoubleArray> velocityVectors;
-  if(vecType != vtkDataObject::POINT)
-  {
-    velocityVectors = vtkSmartPointer<vtkDoubleArray>::New();
-    velocityVectors->SetName(vecName);
-    velocityVectors->SetNumberOfComponents(3);
-  }
-  vtkDoubleArray* cellVectors = nullptr;
-  vtkDoubleArray* vorticity = nullptr;
-  vtkDoubleArray* rotation = nullptr;
-  vtkDoubleArray* angularVel = nullptr;
-  if (this->ComputeVorticity)
-  {
-    cellVectors = vtkDoubleArray::New();
-    cellVectors->SetNumberOfComponents(3);
-    cellVectors->Allocate(3*VTK_CELL_SIZE);
-
-    vorticity = vtkDoubleArray::New();
-    vorticity->SetName("Vorticity");
-    vorticity->SetNumberOfComponents(3);
-
-    rotation = vtkDoubleArray::New();
-    rotation->SetName("Rotation");
-
-    angularVel = vtkDoubleArray::New();
-    angularVel->SetName("AngularVelocity");
-  }
-
+  //
   // We will interpolate all point attributes of the input on each point of
   // the output (unless they are turned off). Note that we are using only
   // the first input, if there are more than one, the attributes have to match.
@@ -782,19 +878,88 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
   //       as a consequence a large number of such small vtkPolyData objects
   //       are needed to represent a streamline, consuming up the memory before
   //       the intermediate memory is timely released.
-  outputPD->InterpolateAllocate( input0Data,
-                                 this->MaximumNumberOfSteps );
+  Streamlines streamlines(input0Data, output->GetPointData(), vecType,
+                          vecName, this->ComputeVorticity,
+                          this->MaximumNumberOfSteps);
+
+  if (this->IntegrateSeeds(0, seedIds->GetNumberOfIds(), streamlines,
+                           seedSource, seedIds, integrationDirections,
+                           lastPoint, func, integrator, surfaceFunc, cell,
+                           weights, vecType, vecName, inPropagation,
+                           inNumSteps, inIntegrationTime, true))
+  {
+    // Assign geometry and attributes
+    streamlines.SetOutput(output);
+    if (output->GetNumberOfPoints() > 1 && this->GenerateNormalsInIntegrate)
+    {
+      this->GenerateNormals(output, nullptr, vecName);
+    }
+  }
+
+  integrator->Delete();
+  cell->Delete();
 
-  vtkIdType numPtsTotal=0;
+  delete[] weights;
+
+  output->Squeeze();
+}
+
+bool vtkStreamTracer::IntegrateSeeds(vtkIdType firstLine,
+                                     vtkIdType lastLine,
+                                     Streamlines& streamlines,
+                                     vtkDataArray* seedSource,
+                                     vtkIdList* seedIds,
+                                     vtkIntArray* integrationDirections,
+                                     double lastPoint[3],
+                                     vtkAbstractInterpolatedVelocityField* func,
+                                     vtkInitialValueProblemSolver* integrator,
+                                     vtkInterpolatedVelocityField* surfaceFunc,
+                                     vtkGenericCell* cell,
+                                     double* weights,
+                                     int vecType,
+                                     const char *vecName,
+                                     double& inPropagation,
+                                     vtkIdType& inNumSteps,
+                                     double &inIntegrationTime,
+                                     bool serial)
+{
+  vtkIdType numLines = seedIds->GetNumberOfIds();
+  double propagation = inPropagation;
+  vtkIdType numSteps = inNumSteps;
+  double integrationTime = inIntegrationTime;
+
+  // Useful pointers
+  vtkDataSetAttributes* outputPD = streamlines.PointData;
+  vtkPointData* inputPD;
+  vtkDataSet* input;
+  vtkDataArray* inVectors;
+
+  int direction=1;
+
+  vtkPoints* outputPoints = streamlines.Points;
+  vtkCellArray* outputLines = streamlines.Lines;
+  vtkDoubleArray* time = streamlines.Time;
+  vtkIntArray* retVals = streamlines.ReasonForTermination;
+  vtkIntArray* sids = streamlines.SeedIds;
+  vtkDoubleArray* velocityVectors = streamlines.VelocityVectors;
+  vtkDoubleArray* cellVectors = streamlines.CellVectors;
+  vtkDoubleArray* vorticity = streamlines.Vorticity;
+  vtkDoubleArray* rotation = streamlines.Rotation;
+  vtkDoubleArray* angularVel = streamlines.AngularVelocity;
+
+  vtkIdType numPtsTotal=outputPoints->GetNumberOfPoints();
   double velocity[3];
 
   int shouldAbort = 0;
 
-  for(int currentLine = 0; currentLine < numLines; currentLine++)
+  for(vtkIdType currentLine = firstLine; currentLine < lastLine; currentLine++)
   {
 
     double progress = static_cast<double>(currentLine)/numLines;
-    this->UpdateProgress(progress);
+    if (serial)
+    {
+      this->UpdateProgress(progress);
+    }
 
     switch (integrationDirections->GetValue(currentLine))
     {
@@ -940,9 +1105,12 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
 
       if ( numSteps++ % 1000 == 1 )
       {
-        progress =
-          ( currentLine + propagation / this->MaximumPropagation ) / numLines;
-        this->UpdateProgress(progress);
+        if (serial)
+        {
+          progress =
+            ( currentLine + propagation / this->MaximumPropagation ) / numLines;
+          this->UpdateProgress(progress);
+        }
 
         if (this->GetAbortExecute())
         {
@@ -975,7 +1143,12 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
         }
         maxStep = stepSize.Interval;
       }
-      this->LastUsedStepSize = stepSize.Interval;
+      streamlines.LastUsedStepSize = stepSize.Interval;
+      streamlines.HasLastUsedStepSize = true;
+      if (serial)
+      {
+        this->LastUsedStepSize = stepSize.Interval;
+      }
 
       // Calculate the next step using the integrator provided
       // Break if the next point is out of bounds.
@@ -1158,63 +1331,128 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
     integrationTime = 0;
   }
 
-  if (!shouldAbort)
+  return !shouldAbort;
+}
+
+bool vtkStreamTracer::IntegrateInParallel(vtkPointData *input0Data,
+                                          vtkPolyData* output,
+                                          vtkDataArray* seedSource,
+                                          vtkIdList* seedIds,
+                                          vtkIntArray* integrationDirections,
+                                          vtkAbstractInterpolatedVelocityField* func,
+                                          int maxCellSize,
+                                          int vecType,
+                                          const char *vecName)
+{
+  // The custom termination callbacks are given all the points integrated so
+  // far, and the surface streamlines need a point locator.
+  vtkIdType numLines = seedIds->GetNumberOfIds();
+  if (numLines < 2 || !this->GetIntegrator() || this->SurfaceStreamlines ||
+      !this->CustomTerminationCallback.empty() ||
+      !this->HasMatchingPointAttributes ||
+      !vtkCompositeInterpolatedVelocityField::SafeDownCast(func))
   {
-    // Create the output polyline
-    output->SetPoints(outputPoints);
-    outputPD->AddArray(time);
-    if(vecType != vtkDataObject::POINT)
-    {
-      outputPD->AddArray(velocityVectors);
-    }
-    if (vorticity)
+    return false;
+  }
+
+  // The cell locators, links, bounds and point locators are built now and
+  // shared by the copies of the function set made by each thread.
+  vtkCompositeInterpolatedVelocityField* compositeFunc =
+    vtkCompositeInterpolatedVelocityField::SafeDownCast(func);
+  compositeFunc->BuildSearchStructures();
+
+  // Integrate chunks of seeds concurrently, each thread with its own copy of
+  // the function set and integrator. The chunks are then appended in order.
+  // Only the calling thread reports progress, from the number of chunks
+  // done.
+  vtkIdType numChunks = std::min(numLines,
+    static_cast<vtkIdType>(32 * vtkSMPTools::GetEstimatedNumberOfThreads()));
+  std::vector<std::unique_ptr<Streamlines> > chunks(numChunks);
+  std::vector<unsigned char> finished(numChunks, 0);
+  vtkSMPThreadLocal<IntegrationThreadData> threadData;
+  std::atomic<bool> aborted(false);
+  std::atomic<vtkIdType> numFinished(0);
+  const std::thread::id callingThread = std::this_thread::get_id();
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    IntegrationThreadData& data = threadData.Local();
+    if (!data.Func)
     {
-      outputPD->AddArray(vorticity);
-      outputPD->AddArray(rotation);
-      outputPD->AddArray(angularVel);
+      data.Func.TakeReference(func->NewInstance());
+      data.Func->CopyParameters(func);
+      vtkCompositeInterpolatedVelocityField::SafeDownCast(data.Func)
+        ->CopyDataSets(compositeFunc);
+      data.Func->SelectVectors(vecType, vecName);
+      data.Integrator.TakeReference(this->GetIntegrator()->NewInstance());
+      data.Integrator->SetFunctionSet(data.Func);
+      data.Cell = vtkSmartPointer<vtkGenericCell>::New();
+      data.Weights.resize(maxCellSize);
     }
-
-    vtkIdType numPts = outputPoints->GetNumberOfPoints();
-    if ( numPts > 1 )
+    for (; chunk < endChunk && !aborted; ++chunk)
     {
-      // Assign geometry and attributes
-      output->SetLines(outputLines);
-      if (this->GenerateNormalsInIntegrate)
+      chunks[chunk].reset(new Streamlines(input0Data,
+        vtkSmartPointer<vtkPointData>::New(), vecType, vecName,
+        this->ComputeVorticity, this->MaximumNumberOfSteps));
+      double lastPoint[3];
+      double propagation = 0;
+      vtkIdType numSteps = 0;
+      double integrationTime = 0;
+      if (!this->IntegrateSeeds(chunk * numLines / numChunks,
+                                (chunk + 1) * numLines / numChunks,
+                                *chunks[chunk], seedSource, seedIds,
+                                integrationDirections, lastPoint, data.Func,
+                                data.Integrator, nullptr, data.Cell,
+                                data.Weights.data(), vecType, vecName,
+                                propagation, numSteps, integrationTime, false))
+      {
+        aborted = true;
+        break;
+      }
+      finished[chunk] = 1;
+      vtkIdType done = ++numFinished;
+      if (std::this_thread::get_id() == callingThread)
       {
-        this->GenerateNormals(output, nullptr, vecName);
+        this->UpdateProgress(static_cast<double>(done) / numChunks);
       }
-
-      outputCD->AddArray(retVals);
-      outputCD->AddArray(sids);
     }
-  }
+  });
 
-  if (vorticity)
+  // The last step size is the one of the last seed integrated with a step,
+  // as in the serial integration.
+  for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
   {
-    vorticity->Delete();
-    rotation->Delete();
-    angularVel->Delete();
+    if (finished[chunk] && chunks[chunk]->HasLastUsedStepSize)
+    {
+      this->LastUsedStepSize = chunks[chunk]->LastUsedStepSize;
+    }
   }
 
-  if (cellVectors)
+  // As in the serial integration, nothing is output after an abort.
+  if (!aborted)
   {
-    cellVectors->Delete();
-  }
-  retVals->Delete();
-  sids->Delete();
-
-  outputPoints->Delete();
-  outputLines->Delete();
-
-  time->Delete();
-
-
-  integrator->Delete();
-  cell->Delete();
+    vtkIdType numPts = 0;
+    for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+    {
+      numPts += chunks[chunk]->Points->GetNumberOfPoints();
+    }
+    Streamlines streamlines(input0Data, output->GetPointData(), vecType,
+                            vecName, this->ComputeVorticity, numPts);
+    for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+    {
+      streamlines.Append(*chunks[chunk]);
+      chunks[chunk].reset();
+    }
 
-  delete[] weights;
+    // Assign geometry and attributes
+    streamlines.SetOutput(output);
+    if (output->GetNumberOfPoints() > 1 && this->GenerateNormalsInIntegrate)
+    {
+      this->GenerateNormals(output, nullptr, vecName);
+    }
+  }
 
   output->Squeeze();
+  return true;
 }
 
 void vtkStreamTracer::GenerateNormals(vtkPolyData* output, double* firstNormal,
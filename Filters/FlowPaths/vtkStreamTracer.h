@@ -69,6 +69,13 @@
  * a source object, traces will be generated from each point in the source
  * that is inside the dataset.
  *
+ * The streamlines of the different seeds are integrated concurrently with
+ * vtkSMPTools, each thread using its own copy of the interpolated velocity
+ * field and of the integrator. The output is the same as the one of the
+ * serial integration, which is used instead with surface streamlines, custom
+ * termination callbacks, AMR inputs and inputs whose blocks do not have the
+ * same point data arrays.
+ *
  * @sa
  * vtkRibbonFilter vtkRuledSurfaceFilter vtkInitialValueProblemSolver
  * vtkRungeKutta2 vtkRungeKutta4 vtkRungeKutta45 vtkTemporalStreamTracer
@@ -93,6 +100,7 @@ class vtkDoubleArray;
 class vtkExecutive;
 class vtkGenericCell;
 class vtkIdList;
+class vtkInterpolatedVelocityField;
 class vtkIntArray;
 class vtkPoints;
 
@@ -412,6 +420,56 @@ protected:
                  double& propagation,
                  vtkIdType& numSteps,
                  double& integrationTime);
+
+  /**
+   * The points, lines and arrays of streamlines being integrated.
+   */
+  class Streamlines;
+
+  /**
+   * Integrate the streamlines of the seeds from firstLine to lastLine - 1
+   * into streamlines, as Integrate() does, with the given function set,
+   * integrator, cell and interpolation weights. When serial is false, the
+   * method may run concurrently on other seeds: it then neither reports
+   * progress nor updates LastUsedStepSize, whose value is only kept in
+   * streamlines. Return false if the execution was aborted.
+   */
+  bool IntegrateSeeds(vtkIdType firstLine,
+                      vtkIdType lastLine,
+                      Streamlines& streamlines,
+                      vtkDataArray* seedSource,
+                      vtkIdList* seedIds,
+                      vtkIntArray* integrationDirections,
+                      double lastPoint[3],
+                      vtkAbstractInterpolatedVelocityField* func,
+                      vtkInitialValueProblemSolver* integrator,
+                      vtkInterpolatedVelocityField* surfaceFunc,
+                      vtkGenericCell* cell,
+                      double* weights,
+                      int vecType,
+                      const char *vecName,
+                      double& propagation,
+                      vtkIdType& numSteps,
+                      double& integrationTime,
+                      bool serial);
+
+  /**
+   * Multithreaded version of Integrate() for the streamlines of
+   * RequestData(). The progress is reported as chunks of seeds are done.
+   * As with Integrate(), nothing is output when the execution is aborted.
+   * Return false without touching the output when the streamlines must be
+   * integrated serially.
+   */
+  bool IntegrateInParallel(vtkPointData *inputData,
+                           vtkPolyData* output,
+                           vtkDataArray* seedSource,
+                           vtkIdList* seedIds,
+                           vtkIntArray* integrationDirections,
+                           vtkAbstractInterpolatedVelocityField* func,
+                           int maxCellSize,
+                           int vecType,
+                           const char *vecFieldName);
+
   double SimpleIntegrate(double seed[3],
                          double lastPoint[3],
                          double stepSize,
@@ -90,6 +90,26 @@ bool vtkTemporalInterpolatedVelocityField::IsStatic(int datasetIndex)
   return this->StaticDataSets[datasetIndex];
 }
 //---------------------------------------------------------------------------
+void vtkTemporalInterpolatedVelocityField::BuildSearchStructures()
+{
+  this->IVF[0]->BuildSearchStructures();
+  this->IVF[1]->BuildSearchStructures();
+}
+//---------------------------------------------------------------------------
+void vtkTemporalInterpolatedVelocityField::CopyDataSets(
+  vtkTemporalInterpolatedVelocityField* from)
+{
+  this->Times[0] = from->Times[0];
+  this->Times[1] = from->Times[1];
+  this->ScaleCoeff = from->ScaleCoeff;
+  this->StaticDataSets = from->StaticDataSets;
+  for (int T = 0; T < 2; T++)
+  {
+    this->IVF[T]->SelectVectors(from->IVF[T]->GetVectorsSelection());
+    this->IVF[T]->CopyDataSets(from->IVF[T]);
+  }
+}
+//---------------------------------------------------------------------------
 void vtkTemporalInterpolatedVelocityField::SetVectorsSelection(const char *v)
 {
   this->IVF[0]->SelectVectors(v);
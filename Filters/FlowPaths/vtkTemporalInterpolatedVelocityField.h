@@ -30,8 +30,10 @@
  * values and computing vorticity etc.
  *
  * @warning
- * vtkTemporalInterpolatedVelocityField is probably not thread safe.
- * A new instance should be created by each thread.
+ * vtkTemporalInterpolatedVelocityField is not thread safe.
+ * A new instance should be created by each thread. Such instances can share
+ * the datasets and cell locators of a field through BuildSearchStructures()
+ * and CopyDataSets().
  *
  * @warning
  * Datasets are added in lists. The list for T1 must be idential to that for T0
@@ -101,6 +103,20 @@ public:
    */
   void SetDataSetAtTime(int I, int N, double T, vtkDataSet* dataset, bool staticdataset);
 
+  /**
+   * Build the cell locators and the other search structures of the datasets
+   * at both times now instead of on the first evaluation.
+   */
+  void BuildSearchStructures();
+
+  /**
+   * Set the datasets and times of another field, sharing its cell locators
+   * and its vectors selection. Once from->BuildSearchStructures() has been
+   * called, the fields sharing its datasets can be evaluated concurrently,
+   * each instance from its own thread.
+   */
+  void CopyDataSets(vtkTemporalInterpolatedVelocityField* from);
+
   //@{
   /**
    * Between iterations of the Particle Tracer, Id's of the Cell
@@ -0,0 +1,565 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGradientFilter.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check the gradients of grids that are flat in one direction, the
+// replacement values of the points without contributing cells, the
+// gradients of hexahedra, wedges and pyramids with the sequential and the
+// parallel SMP backends, and the finite difference stencil of structured
+// grids against the cell derivatives of the same grids as unstructured grids.
+
+#include "vtkCell.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDoubleArray.h"
+#include "vtkGradientFilter.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSMPTools.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+const char* ResultNames[4] =
+  { "Gradients", "Divergence", "Vorticity", "Q-criterion" };
+
+// A 3 component field whose gradient is the constant matrix
+// { 2, 3, 0, 0, -1, 4, 1, 0, 5 } (row i is the gradient of component i).
+void LinearField(const double x[3], double value[3])
+{
+  value[0] = 2.0 * x[0] + 3.0 * x[1];
+  value[1] = -x[1] + 4.0 * x[2];
+  value[2] = x[0] + 5.0 * x[2];
+}
+
+const double LinearGradient[9] = { 2, 3, 0, 0, -1, 4, 1, 0, 5 };
+
+void AddField(vtkDataSet* grid, bool linear)
+{
+  vtkNew<vtkDoubleArray> pointField;
+  pointField->SetName("Field");
+  pointField->SetNumberOfComponents(3);
+  pointField->SetNumberOfTuples(grid->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); ++i)
+  {
+    double x[3], value[3];
+    grid->GetPoint(i, x);
+    if (linear)
+    {
+      LinearField(x, value);
+    }
+    else
+    {
+      value[0] = sin(x[0]) * x[1];
+      value[1] = x[2] * x[2] + x[0] * x[1];
+      value[2] = cos(x[1] * x[2]);
+    }
+    pointField->SetTypedTuple(i, value);
+  }
+  grid->GetPointData()->AddArray(pointField);
+
+  vtkNew<vtkDoubleArray> cellField;
+  cellField->SetName("Field");
+  cellField->SetNumberOfComponents(3);
+  cellField->SetNumberOfTuples(grid->GetNumberOfCells());
+  vtkNew<vtkIdList> ptIds;
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); ++i)
+  {
+    // the average of the point values, which is the value at the center of
+    // the cells of the structured grids for the linear field
+    double value[3] = { 0.0, 0.0, 0.0 };
+    grid->GetCellPoints(i, ptIds);
+    for (vtkIdType j = 0; j < ptIds->GetNumberOfIds(); ++j)
+    {
+      double* v = pointField->GetTuple3(ptIds->GetId(j));
+      for (int k = 0; k < 3; ++k)
+      {
+        value[k] += v[k] / ptIds->GetNumberOfIds();
+      }
+    }
+    cellField->SetTypedTuple(i, value);
+  }
+  grid->GetCellData()->AddArray(cellField);
+}
+
+void SetUpFilter(vtkGradientFilter* filter, vtkDataSet* input,
+                 int fieldAssociation)
+{
+  filter->SetInputData(input);
+  filter->SetInputScalars(fieldAssociation, "Field");
+  filter->SetComputeDivergence(1);
+  filter->SetComputeVorticity(1);
+  filter->SetComputeQCriterion(1);
+}
+
+vtkDataSetAttributes* GetResults(vtkGradientFilter* filter,
+                                 int fieldAssociation)
+{
+  vtkDataSet* output = vtkDataSet::SafeDownCast(filter->GetOutput());
+  if (fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS)
+  {
+    return output->GetPointData();
+  }
+  return output->GetCellData();
+}
+
+bool IsLinearGradient(vtkDataArray* gradients, double tolerance)
+{
+  for (vtkIdType i = 0; i < gradients->GetNumberOfTuples(); ++i)
+  {
+    for (int j = 0; j < 9; ++j)
+    {
+      if (std::fabs(gradients->GetComponent(i, j) - LinearGradient[j]) >
+          tolerance)
+      {
+        cerr << "Gradient component " << j << " of tuple " << i << " is "
+             << gradients->GetComponent(i, j) << " instead of "
+             << LinearGradient[j] << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Grids that are flat in one direction get the gradients of the two other
+// directions, and nothing across the flat direction.
+int TestFlatGrids()
+{
+  int errors = 0;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(7, 5, 1);
+  image->SetSpacing(0.5, 2.0, 1.0);
+  image->SetOrigin(-1.0, 2.0, 3.0);
+
+  vtkNew<vtkStructuredGrid> structured;
+  structured->SetDimensions(6, 1, 4);
+  vtkNew<vtkPoints> points;
+  for (int k = 0; k < 4; ++k)
+  {
+    for (int i = 0; i < 6; ++i)
+    {
+      points->InsertNextPoint(i + 0.1 * k * k, 1.0, 0.5 * k + 0.05 * i);
+    }
+  }
+  structured->SetPoints(points);
+
+  vtkDataSet* grids[2] = { image, structured };
+  for (int g = 0; g < 2; ++g)
+  {
+    AddField(grids[g], true);
+    // the flat direction has no derivative
+    int flat = (g == 0 ? 2 : 1);
+    for (int association = 0; association < 2; ++association)
+    {
+      vtkNew<vtkGradientFilter> gradients;
+      SetUpFilter(gradients, grids[g], association);
+      gradients->Update();
+      vtkDataArray* result =
+        GetResults(gradients, association)->GetArray("Gradients");
+      vtkIdType numberOfTuples = (association == 0 ?
+        grids[g]->GetNumberOfPoints() : grids[g]->GetNumberOfCells());
+      if (!result || result->GetNumberOfTuples() != numberOfTuples)
+      {
+        cerr << "No gradients for " << grids[g]->GetClassName()
+             << " association " << association << endl;
+        ++errors;
+        continue;
+      }
+      for (vtkIdType i = 0; i < numberOfTuples; ++i)
+      {
+        for (int j = 0; j < 9; ++j)
+        {
+          double expected = (j % 3 == flat ? 0.0 : LinearGradient[j]);
+          if (std::fabs(result->GetComponent(i, j) - expected) > 1e-10)
+          {
+            cerr << "Gradient component " << j << " of tuple " << i
+                 << " of " << grids[g]->GetClassName() << " association "
+                 << association << " is " << result->GetComponent(i, j)
+                 << " instead of " << expected << endl;
+            ++errors;
+            i = numberOfTuples;
+            break;
+          }
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+// Two tetrahedra, a point of a vertex only and a point of no cell. The two
+// last points have no contributing cell with the DataSetMax option.
+int TestReplacementValues()
+{
+  int errors = 0;
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(0.0, 0.0, 0.0);
+  points->InsertNextPoint(1.0, 0.0, 0.0);
+  points->InsertNextPoint(0.0, 1.0, 0.0);
+  points->InsertNextPoint(0.0, 0.0, 1.0);
+  points->InsertNextPoint(1.0, 1.0, 1.0);
+  points->InsertNextPoint(3.0, 3.0, 3.0);
+  points->InsertNextPoint(-3.0, 3.0, 3.0);
+  vtkNew<vtkUnstructuredGrid> grid;
+  grid->SetPoints(points);
+  vtkIdType tetra1[4] = { 0, 1, 2, 3 };
+  vtkIdType tetra2[4] = { 1, 2, 3, 4 };
+  vtkIdType vertex = 5;
+  grid->InsertNextCell(VTK_TETRA, 4, tetra1);
+  grid->InsertNextCell(VTK_TETRA, 4, tetra2);
+  grid->InsertNextCell(VTK_VERTEX, 1, &vertex);
+  AddField(grid, true);
+
+  for (int option = vtkGradientFilter::Zero;
+       option <= vtkGradientFilter::DataTypeMax; ++option)
+  {
+    vtkNew<vtkGradientFilter> gradients;
+    SetUpFilter(gradients, grid, vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    gradients->SetContributingCellOption(vtkGradientFilter::DataSetMax);
+    gradients->SetReplacementValueOption(option);
+    gradients->Update();
+    vtkDataSetAttributes* results =
+      GetResults(gradients, vtkDataObject::FIELD_ASSOCIATION_POINTS);
+
+    double replacement = 0.0;
+    switch (option)
+    {
+      case vtkGradientFilter::NaN:
+        replacement = vtkMath::Nan();
+        break;
+      case vtkGradientFilter::DataTypeMin:
+        replacement = std::numeric_limits<double>::min();
+        break;
+      case vtkGradientFilter::DataTypeMax:
+        replacement = std::numeric_limits<double>::max();
+        break;
+    }
+    for (int r = 0; r < 4; ++r)
+    {
+      vtkDataArray* result = results->GetArray(ResultNames[r]);
+      if (!result)
+      {
+        cerr << "No " << ResultNames[r] << " array" << endl;
+        ++errors;
+        continue;
+      }
+      for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); ++i)
+      {
+        for (int j = 0; j < result->GetNumberOfComponents(); ++j)
+        {
+          double value = result->GetComponent(i, j);
+          bool replaced = (vtkMath::IsNan(replacement) ?
+            vtkMath::IsNan(value) : value == replacement);
+          // the tetrahedra values of the linear field are exact, and are
+          // only replacement values when a gradient component is zero
+          if (i >= 5 ? !replaced :
+              (replaced && option != vtkGradientFilter::Zero))
+          {
+            cerr << ResultNames[r] << " component " << j << " of point " << i
+                 << " is " << value << " with replacement option " << option
+                 << endl;
+            ++errors;
+          }
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+// Whether the result arrays of two filters have the same values.
+bool SameResults(vtkDataSetAttributes* a, vtkDataSetAttributes* b)
+{
+  for (int r = 0; r < 4; ++r)
+  {
+    vtkDataArray* aResult = a->GetArray(ResultNames[r]);
+    vtkDataArray* bResult = b->GetArray(ResultNames[r]);
+    if (!aResult || !bResult ||
+        aResult->GetNumberOfTuples() != bResult->GetNumberOfTuples() ||
+        aResult->GetNumberOfComponents() != bResult->GetNumberOfComponents())
+    {
+      return false;
+    }
+    for (vtkIdType i = 0; i < aResult->GetNumberOfTuples(); ++i)
+    {
+      for (int j = 0; j < aResult->GetNumberOfComponents(); ++j)
+      {
+        if (aResult->GetComponent(i, j) != bResult->GetComponent(i, j))
+        {
+          cerr << ResultNames[r] << " component " << j << " of tuple " << i
+               << " is " << bResult->GetComponent(i, j) << " instead of "
+               << aResult->GetComponent(i, j) << endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// A distorted grid of 4x3x3 points, and its hexahedra, or each hexahedron
+// split into 2 wedges or into 3 pyramids with the apex at its last point.
+void MakeGrid(int cellType, vtkUnstructuredGrid* grid)
+{
+  const int dims[3] = { 4, 3, 3 };
+  vtkNew<vtkPoints> points;
+  for (int k = 0; k < dims[2]; ++k)
+  {
+    for (int j = 0; j < dims[1]; ++j)
+    {
+      for (int i = 0; i < dims[0]; ++i)
+      {
+        points->InsertNextPoint(i + 0.15 * sin(3.0 * j + k),
+                                j + 0.1 * cos(2.0 * i + k),
+                                k + 0.1 * sin(i + 2.0 * j));
+      }
+    }
+  }
+  grid->SetPoints(points);
+  grid->Allocate();
+  for (int k = 0; k + 1 < dims[2]; ++k)
+  {
+    for (int j = 0; j + 1 < dims[1]; ++j)
+    {
+      for (int i = 0; i + 1 < dims[0]; ++i)
+      {
+        vtkIdType p = i + dims[0] * (j + dims[1] * k);
+        vtkIdType dj = dims[0];
+        vtkIdType dk = dims[0] * dims[1];
+        vtkIdType hex[8] = { p, p + 1, p + 1 + dj, p + dj,
+                             p + dk, p + 1 + dk, p + 1 + dj + dk, p + dj + dk };
+        if (cellType == VTK_HEXAHEDRON)
+        {
+          grid->InsertNextCell(VTK_HEXAHEDRON, 8, hex);
+        }
+        else if (cellType == VTK_WEDGE)
+        {
+          vtkIdType wedge1[6] = { hex[0], hex[1], hex[3],
+                                  hex[4], hex[5], hex[7] };
+          vtkIdType wedge2[6] = { hex[1], hex[2], hex[3],
+                                  hex[5], hex[6], hex[7] };
+          grid->InsertNextCell(VTK_WEDGE, 6, wedge1);
+          grid->InsertNextCell(VTK_WEDGE, 6, wedge2);
+        }
+        else
+        {
+          vtkIdType pyramid1[5] = { hex[0], hex[1], hex[2], hex[3], hex[6] };
+          vtkIdType pyramid2[5] = { hex[0], hex[4], hex[5], hex[1], hex[6] };
+          vtkIdType pyramid3[5] = { hex[0], hex[3], hex[7], hex[4], hex[6] };
+          grid->InsertNextCell(VTK_PYRAMID, 5, pyramid1);
+          grid->InsertNextCell(VTK_PYRAMID, 5, pyramid2);
+          grid->InsertNextCell(VTK_PYRAMID, 5, pyramid3);
+        }
+      }
+    }
+  }
+}
+
+// The point gradients of a nonlinear field on a single hexahedron, wedge or
+// pyramid are the derivatives of the cell at the parametric coordinates of
+// its points. On grids of these cells, the point and cell gradients are the
+// same with the Sequential backend and the default one.
+int TestCellTypes()
+{
+  const int cellTypes[3] = { VTK_HEXAHEDRON, VTK_WEDGE, VTK_PYRAMID };
+  vtkSMPTools::Config sequential;
+  sequential.Backend = "Sequential";
+
+  int errors = 0;
+  for (int t = 0; t < 3; ++t)
+  {
+    vtkNew<vtkUnstructuredGrid> grid;
+    MakeGrid(cellTypes[t], grid);
+    AddField(grid, false);
+
+    // The points of a single cell get the derivatives of that cell at their
+    // parametric coordinates.
+    vtkNew<vtkUnstructuredGrid> single;
+    single->SetPoints(grid->GetPoints());
+    single->Allocate(1);
+    vtkNew<vtkIdList> ptIds;
+    grid->GetCellPoints(0, ptIds);
+    single->InsertNextCell(cellTypes[t], ptIds);
+    single->GetPointData()->ShallowCopy(grid->GetPointData());
+    vtkNew<vtkGradientFilter> singleGradients;
+    SetUpFilter(singleGradients, single,
+                vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    singleGradients->Update();
+    vtkDataArray* singleResult = GetResults(singleGradients,
+      vtkDataObject::FIELD_ASSOCIATION_POINTS)->GetArray("Gradients");
+    vtkCell* cell = single->GetCell(0);
+    vtkDataArray* field = grid->GetPointData()->GetArray("Field");
+    std::vector<double> values(3 * ptIds->GetNumberOfIds());
+    for (vtkIdType i = 0; i < ptIds->GetNumberOfIds(); ++i)
+    {
+      field->GetTuple(ptIds->GetId(i), &values[3 * i]);
+    }
+    for (vtkIdType i = 0; i < ptIds->GetNumberOfIds(); ++i)
+    {
+      double derivatives[9];
+      cell->Derivatives(0, cell->GetParametricCoords() + 3 * i, values.data(),
+                        3, derivatives);
+      for (int j = 0; j < 9; ++j)
+      {
+        if (std::fabs(singleResult->GetComponent(ptIds->GetId(i), j) -
+                      derivatives[j]) > 1e-8)
+        {
+          cerr << "Gradient component " << j << " of point " << i
+               << " of cell type " << cellTypes[t] << " is "
+               << singleResult->GetComponent(ptIds->GetId(i), j)
+               << " instead of " << derivatives[j] << endl;
+          ++errors;
+          break;
+        }
+      }
+    }
+
+    // point gradients, point gradients with the faster approximation, then
+    // cell gradients
+    for (int c = 0; c < 3; ++c)
+    {
+      int association = (c < 2 ? vtkDataObject::FIELD_ASSOCIATION_POINTS :
+                         vtkDataObject::FIELD_ASSOCIATION_CELLS);
+      vtkNew<vtkGradientFilter> serial;
+      SetUpFilter(serial, grid, association);
+      serial->SetFasterApproximation(c == 1);
+      vtkSMPTools::LocalScope(sequential, [&]() { serial->Update(); });
+      vtkNew<vtkGradientFilter> gradients;
+      SetUpFilter(gradients, grid, association);
+      gradients->SetFasterApproximation(c == 1);
+      gradients->Update();
+      if (!SameResults(GetResults(serial, association),
+                       GetResults(gradients, association)))
+      {
+        cerr << "Sequential and parallel gradients differ for cell type "
+             << cellTypes[t] << " and case " << c << endl;
+        ++errors;
+      }
+    }
+  }
+  return errors;
+}
+
+// The finite difference stencil of image data and structured grids, and the
+// cell derivatives of the same grids as unstructured grids, are both exact
+// for a linear field.
+int TestStructuredAndUnstructured()
+{
+  int errors = 0;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(6, 5, 4);
+  image->SetSpacing(0.5, 1.0, 2.0);
+  image->SetOrigin(1.0, -2.0, 0.5);
+
+  vtkNew<vtkStructuredGrid> structured;
+  structured->SetDimensions(5, 4, 4);
+  vtkNew<vtkPoints> points;
+  for (int k = 0; k < 4; ++k)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      for (int i = 0; i < 5; ++i)
+      {
+        points->InsertNextPoint(i + 0.1 * sin(2.0 * j + k),
+                                j + 0.05 * i * k,
+                                k + 0.1 * cos(i + j));
+      }
+    }
+  }
+  structured->SetPoints(points);
+
+  vtkDataSet* grids[2] = { image, structured };
+  for (int g = 0; g < 2; ++g)
+  {
+    AddField(grids[g], true);
+    vtkNew<vtkUnstructuredGrid> unstructured;
+    vtkNew<vtkPoints> unstructuredPoints;
+    unstructuredPoints->SetNumberOfPoints(grids[g]->GetNumberOfPoints());
+    for (vtkIdType i = 0; i < grids[g]->GetNumberOfPoints(); ++i)
+    {
+      unstructuredPoints->SetPoint(i, grids[g]->GetPoint(i));
+    }
+    unstructured->SetPoints(unstructuredPoints);
+    unstructured->Allocate(grids[g]->GetNumberOfCells());
+    vtkNew<vtkIdList> ptIds;
+    for (vtkIdType i = 0; i < grids[g]->GetNumberOfCells(); ++i)
+    {
+      grids[g]->GetCellPoints(i, ptIds);
+      unstructured->InsertNextCell(grids[g]->GetCellType(i), ptIds);
+    }
+    unstructured->GetPointData()->ShallowCopy(grids[g]->GetPointData());
+
+    vtkNew<vtkGradientFilter> stencil;
+    SetUpFilter(stencil, grids[g], vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    stencil->Update();
+    vtkNew<vtkGradientFilter> cells;
+    SetUpFilter(cells, unstructured, vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    cells->Update();
+    vtkDataSetAttributes* stencilResults =
+      GetResults(stencil, vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    vtkDataSetAttributes* cellResults =
+      GetResults(cells, vtkDataObject::FIELD_ASSOCIATION_POINTS);
+    if (!IsLinearGradient(stencilResults->GetArray("Gradients"), 1e-8) ||
+        !IsLinearGradient(cellResults->GetArray("Gradients"), 1e-8))
+    {
+      cerr << "Wrong gradients for " << grids[g]->GetClassName() << endl;
+      ++errors;
+      continue;
+    }
+    for (int r = 1; r < 4; ++r)
+    {
+      vtkDataArray* a1 = stencilResults->GetArray(ResultNames[r]);
+      vtkDataArray* a2 = cellResults->GetArray(ResultNames[r]);
+      for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); ++i)
+      {
+        for (int j = 0; j < a1->GetNumberOfComponents(); ++j)
+        {
+          if (std::fabs(a1->GetComponent(i, j) - a2->GetComponent(i, j)) >
+              1e-8)
+          {
+            cerr << ResultNames[r] << " component " << j << " of point " << i
+                 << " of " << grids[g]->GetClassName() << " is "
+                 << a1->GetComponent(i, j) << " instead of "
+                 << a2->GetComponent(i, j) << endl;
+            ++errors;
+            i = a1->GetNumberOfTuples();
+            break;
+          }
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+} // anonymous namespace
+
+int TestGradientFilter(int, char*[])
+{
+  int errors = TestFlatGrids();
+  errors += TestReplacementValues();
+  errors += TestCellTypes();
+  errors += TestStructuredAndUnstructured();
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTableBasedClipDataSet.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that vtkTableBasedClipDataSet gives the same unstructured grid with
+// the sequential and the parallel SMP backends.
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkFloatArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTableBasedClipDataSet.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// A grid of res^3 cells of all the types the clip tables handle, plus
+// polylines which are clipped by vtkClipDataSet.
+vtkSmartPointer<vtkUnstructuredGrid> CreateGrid(int res)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  int n = res + 1;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetName("Scalars");
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        points->InsertNextPoint(i, j + 0.1 * i, k);
+        random->Next();
+        scalars->InsertNextValue(random->GetValue());
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->GetPointData()->SetScalars(scalars);
+  grid->Allocate(res * res * res);
+  for (int k = 0; k < res; ++k)
+  {
+    for (int j = 0; j < res; ++j)
+    {
+      for (int i = 0; i < res; ++i)
+      {
+        vtkIdType p0 = i + n * (j + n * k);
+        vtkIdType h[8] = { p0, p0 + 1, p0 + n + 1, p0 + n,
+                           p0 + n * n, p0 + n * n + 1, p0 + n * n + n + 1,
+                           p0 + n * n + n };
+        vtkIdType tet[4] = { h[0], h[1], h[3], h[4] };
+        vtkIdType wedge[6] = { h[0], h[1], h[3], h[4], h[5], h[7] };
+        vtkIdType voxel[8] = { h[0], h[1], h[3], h[2],
+                               h[4], h[5], h[7], h[6] };
+        random->Next();
+        switch (static_cast<int>(random->GetValue() * 9))
+        {
+          case 0: grid->InsertNextCell(VTK_HEXAHEDRON, 8, h); break;
+          case 1: grid->InsertNextCell(VTK_TETRA, 4, tet); break;
+          case 2: grid->InsertNextCell(VTK_WEDGE, 6, wedge); break;
+          case 3: grid->InsertNextCell(VTK_PYRAMID, 5, h); break;
+          case 4: grid->InsertNextCell(VTK_VOXEL, 8, voxel); break;
+          case 5: grid->InsertNextCell(VTK_QUAD, 4, h); break;
+          case 6: grid->InsertNextCell(VTK_TRIANGLE, 3, h); break;
+          case 7: grid->InsertNextCell(VTK_LINE, 2, h); break;
+          default: grid->InsertNextCell(VTK_POLY_LINE, 3, h); break;
+        }
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkFloatArray> cellScalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  cellScalars->SetName("CellScalars");
+  for (vtkIdType cellId = 0; cellId < grid->GetNumberOfCells(); ++cellId)
+  {
+    cellScalars->InsertNextValue(cellId);
+  }
+  grid->GetCellData()->AddArray(cellScalars);
+  return grid;
+}
+
+bool SameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  vtkFloatArray *fa = vtkArrayDownCast<vtkFloatArray>(a);
+  vtkFloatArray *fb = vtkArrayDownCast<vtkFloatArray>(b);
+  return fa && fb && fa->GetNumberOfValues() == fb->GetNumberOfValues() &&
+    memcmp(fa->GetPointer(0), fb->GetPointer(0),
+           fa->GetNumberOfValues() * sizeof(float)) == 0;
+}
+
+bool SameGrids(vtkUnstructuredGrid *a, vtkUnstructuredGrid *b)
+{
+  if (a->GetNumberOfCells() != b->GetNumberOfCells() ||
+      !SameArrays(a->GetPoints()->GetData(), b->GetPoints()->GetData()) ||
+      !SameArrays(a->GetPointData()->GetArray("Scalars"),
+                  b->GetPointData()->GetArray("Scalars")) ||
+      !SameArrays(a->GetCellData()->GetArray("CellScalars"),
+                  b->GetCellData()->GetArray("CellScalars")))
+  {
+    return false;
+  }
+  vtkIdType size = a->GetCells()->GetNumberOfConnectivityEntries();
+  return size == b->GetCells()->GetNumberOfConnectivityEntries() &&
+    memcmp(a->GetCells()->GetPointer(), b->GetCells()->GetPointer(),
+           size * sizeof(vtkIdType)) == 0 &&
+    memcmp(a->GetCellTypesArray()->GetPointer(0),
+           b->GetCellTypesArray()->GetPointer(0), a->GetNumberOfCells()) == 0;
+}
+}
+
+int TestTableBasedClipDataSet(int, char *[])
+{
+  vtkSmartPointer<vtkUnstructuredGrid> grid = CreateGrid(40);
+
+  vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+  plane->SetOrigin(20.3, 17.7, 15.1);
+  plane->SetNormal(0.3, 1.0, 0.7);
+
+  int status = EXIT_SUCCESS;
+  for (int mode = 0; mode < 2; ++mode)
+  {
+    vtkSmartPointer<vtkUnstructuredGrid> outputs[2][2];
+    for (int parallel = 0; parallel < 2; ++parallel)
+    {
+      vtkSmartPointer<vtkTableBasedClipDataSet> clipper =
+        vtkSmartPointer<vtkTableBasedClipDataSet>::New();
+      clipper->SetInputData(grid);
+      if (mode == 0)
+      {
+        clipper->SetClipFunction(plane);
+      }
+      else
+      {
+        clipper->SetValue(0.5);
+      }
+      clipper->GenerateClippedOutputOn();
+
+      vtkSMPTools::Config config;
+      if (!parallel)
+      {
+        config.Backend = "Sequential";
+      }
+      vtkSMPTools::LocalScope(config, [&]() { clipper->Update(); });
+      outputs[parallel][0] = clipper->GetOutput();
+      outputs[parallel][1] = clipper->GetClippedOutput();
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+      if (outputs[0][i]->GetNumberOfCells() == 0 ||
+          !SameGrids(outputs[0][i], outputs[1][i]))
+      {
+        cerr << "Sequential and parallel outputs " << i
+             << " differ for mode " << mode << endl;
+        status = EXIT_FAILURE;
+      }
+    }
+  }
+
+  return status;
+}
@@ -20,11 +20,15 @@
 
 #include "vtkGradientFilter.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCell.h"
 #include "vtkCellData.h"
 #include "vtkCellDataToPointData.h"
+#include "vtkCellTypes.h"
 #include "vtkDataArray.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
+#include "vtkGenericCell.h"
 #include "vtkIdList.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -35,11 +39,15 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinksTemplate.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -87,17 +95,18 @@ namespace
   void ComputePointGradientsUG(
     vtkDataSet *structure, vtkDataArray *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence, int highestCellDimension, int contributingCellOption);
+    data_type* divergence, const unsigned char* cellDimensions,
+    int highestCellDimension, int contributingCellOption, bool threaded);
 
   int GetCellParametricData(
     vtkIdType pointId, double pointCoord[3], vtkCell *cell, int & subId,
-    double parametricCoord[3]);
+    double parametricCoord[3], std::vector<double>& weights);
 
   template<class data_type>
   void ComputeCellGradientsUG(
     vtkDataSet *structure, vtkDataArray *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence);
+    data_type* divergence, bool threaded);
 
   // Functions for image data and structured grids
   template<class Grid, class data_type>
@@ -120,23 +129,74 @@ namespace
     return false;
   }
 
-  // generic way to get the coordinate for either a cell (using
-  // the parametric center) or a point
-  void GetGridEntityCoordinate(vtkDataSet* grid, int fieldAssociation,
-                               vtkIdType index, double coords[3])
+  // The cells of unstructured grids and polydatas can be accessed
+  // concurrently once they are built, the ones of other datasets are
+  // processed serially.
+  bool HasThreadSafeCells(vtkDataSet* structure)
   {
-    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS)
+    return structure->IsA("vtkUnstructuredGrid") ||
+      structure->IsA("vtkPolyData");
+  }
+
+  // run functor over [0,n), with vtkSMPTools when threaded
+  template<class Functor>
+  void ForEach(vtkIdType n, bool threaded, Functor& functor)
+  {
+    if (threaded)
     {
-      grid->GetPoint(index, coords);
+      vtkSMPTools::For(0, n, functor);
     }
     else
     {
-      vtkCell* cell = grid->GetCell(index);
-      double pcoords[3];
-      int subId = cell->GetParametricCenter(pcoords);
-      std::vector<double> weights(cell->GetNumberOfPoints()+1);
-      cell->EvaluateLocation(subId, pcoords, coords, &weights[0]);
+      functor(0, n);
+    }
+  }
+
+  // dimension of each cell of a dataset, found once per cell type
+  void GetCellDimensions(vtkDataSet* structure, bool threaded,
+                         std::vector<unsigned char>& dimensions)
+  {
+    unsigned char typeDimensions[VTK_NUMBER_OF_CELL_TYPES];
+    std::fill_n(typeDimensions, VTK_NUMBER_OF_CELL_TYPES, 0);
+    vtkNew<vtkCellTypes> types;
+    structure->GetCellTypes(types);
+    vtkNew<vtkGenericCell> cell;
+    for (vtkIdType i = 0; i < types->GetNumberOfTypes(); i++)
+    {
+      unsigned char type = types->GetCellType(i);
+      cell->SetCellType(type);
+      typeDimensions[type] = static_cast<unsigned char>(cell->GetCellDimension());
     }
+
+    dimensions.resize(structure->GetNumberOfCells());
+    auto getDimensions = [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      for (; cellId < endCellId; cellId++)
+      {
+        dimensions[cellId] = typeDimensions[structure->GetCellType(cellId)];
+      }
+    };
+    ForEach(structure->GetNumberOfCells(), threaded, getDimensions);
+  }
+
+  // world coordinates of the parametric centers of the cells of a grid
+  void GetCellCenters(vtkDataSet* grid, std::vector<double>& centers)
+  {
+    vtkIdType numCells = grid->GetNumberOfCells();
+    centers.resize(3*numCells);
+    vtkSMPThreadLocalObject<vtkGenericCell> cells;
+    vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkGenericCell* cell = cells.Local();
+      double weights[VTK_CELL_SIZE];
+      for (; cellId < endCellId; cellId++)
+      {
+        grid->GetCell(cellId, cell);
+        double pcoords[3];
+        int subId = cell->GetParametricCenter(pcoords);
+        cell->EvaluateLocation(subId, pcoords, &centers[3*cellId], weights);
+      }
+    });
   }
 
   template<class data_type>
@@ -398,7 +458,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     divergence->SetNumberOfTuples(array->GetNumberOfTuples());
     switch (arrayType)
     {
-      vtkFloatingPointTemplateMacro(Fill(gradients, static_cast<VTK_TT>(0), this->ReplacementValueOption));
+      vtkFloatingPointTemplateMacro(Fill(divergence, static_cast<VTK_TT>(0), this->ReplacementValueOption));
     }
     if (this->DivergenceArrayName)
     {
@@ -417,7 +477,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     vorticity->SetNumberOfTuples(array->GetNumberOfTuples());
     switch (arrayType)
     {
-      vtkFloatingPointTemplateMacro(Fill(gradients, static_cast<VTK_TT>(0), this->ReplacementValueOption));
+      vtkFloatingPointTemplateMacro(Fill(vorticity, static_cast<VTK_TT>(0), this->ReplacementValueOption));
     }
     if (this->VorticityArrayName)
     {
@@ -435,7 +495,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     qCriterion->SetNumberOfTuples(array->GetNumberOfTuples());
     switch (arrayType)
     {
-      vtkFloatingPointTemplateMacro(Fill(gradients, static_cast<VTK_TT>(0), this->ReplacementValueOption));
+      vtkFloatingPointTemplateMacro(Fill(qCriterion, static_cast<VTK_TT>(0), this->ReplacementValueOption));
     }
     if (this->QCriterionArrayName)
     {
@@ -447,21 +507,26 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     }
   }
 
+  // the cells are built first when they can then be accessed concurrently
+  bool threaded = HasThreadSafeCells(input);
+  if (threaded && input->GetNumberOfCells() > 0)
+  {
+    vtkNew<vtkGenericCell> cell;
+    input->GetCell(0, cell);
+  }
+
+  std::vector<unsigned char> cellDimensions;
   int highestCellDimension = 0;
-  if (this->ContributingCellOption == vtkGradientFilter::DataSetMax)
+  if (fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS &&
+      !this->FasterApproximation &&
+      this->ContributingCellOption != vtkGradientFilter::All)
   {
-    int maxDimension = input->IsA("vtkPolyData") == 1 ? 2 : 3;
-    for (vtkIdType i=0;i<input->GetNumberOfCells();i++)
+    GetCellDimensions(input, threaded, cellDimensions);
+    if (this->ContributingCellOption == vtkGradientFilter::DataSetMax &&
+        !cellDimensions.empty())
     {
-      int dim = input->GetCell(i)->GetCellDimension();
-      if (dim > highestCellDimension)
-      {
-        highestCellDimension = dim;
-        if (highestCellDimension == maxDimension)
-        {
-          break;
-        }
-      }
+      highestCellDimension =
+        *std::max_element(cellDimensions.begin(), cellDimensions.end());
     }
   }
 
@@ -482,7 +547,9 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                             static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                            (divergence == nullptr ? nullptr :
                             static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
-                           highestCellDimension, this->ContributingCellOption));
+                           (cellDimensions.empty() ? nullptr : &cellDimensions[0]),
+                           highestCellDimension, this->ContributingCellOption,
+                           threaded));
       }
       if(gradients)
       {
@@ -550,7 +617,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
             (qCriterion == nullptr ? nullptr :
              static_cast<VTK_TT *>(cellQCriterion->GetVoidPointer(0))),
             (divergence == nullptr ? nullptr :
-             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0)))));
+             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0))),
+            threaded));
       }
 
       // We need to convert cell Array to points Array.
@@ -632,7 +700,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                          (qCriterion == nullptr ? nullptr :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == nullptr ? nullptr :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         threaded));
     }
 
     if(gradients)
@@ -839,131 +908,129 @@ namespace {
   void ComputePointGradientsUG(
     vtkDataSet *structure, vtkDataArray *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence, int highestCellDimension, int contributingCellOption)
+    data_type* divergence, const unsigned char* cellDimensions,
+    int highestCellDimension, int contributingCellOption, bool threaded)
   {
-    vtkNew<vtkIdList> currentPoint;
-    currentPoint->SetNumberOfIds(1);
-    vtkNew<vtkIdList> cellsOnPoint;
+    // the cells using each point are gathered from static links so that the
+    // points can be processed concurrently
+    vtkStaticCellLinksTemplate<vtkIdType> links;
+    links.BuildLinks(structure);
 
     vtkIdType numpts = structure->GetNumberOfPoints();
-
     int numberOfOutputComponents = 3*numberOfInputComponents;
-    std::vector<data_type> g(numberOfOutputComponents);
+    vtkSMPThreadLocalObject<vtkGenericCell> cells;
 
-    // if we are doing patches for contributing cell dimensions we want to keep track of
-    // the maximum expected dimension so we can exit out of the check loop quicker
-    const int maxCellDimension = structure->IsA("vtkPolyData") ? 2 : 3;
-
-    for (vtkIdType point = 0; point < numpts; point++)
+    auto computeGradients = [&](vtkIdType point, vtkIdType endPoint)
     {
-      currentPoint->SetId(0, point);
-      double pointcoords[3];
-      structure->GetPoint(point, pointcoords);
-      // Get all cells touching this point.
-      structure->GetCellNeighbors(-1, currentPoint, cellsOnPoint);
-      vtkIdType numCellNeighbors = cellsOnPoint->GetNumberOfIds();
-
-      for(int i=0;i<numberOfOutputComponents;i++)
-      {
-        g[i] = 0;
-      }
+      vtkGenericCell *cell = cells.Local();
+      std::vector<data_type> g(numberOfOutputComponents);
+      std::vector<double> derivative(numberOfOutputComponents);
+      std::vector<double> values;
+      std::vector<double> weights;
 
-      if (contributingCellOption == vtkGradientFilter::Patch)
+      for (; point < endPoint; point++)
       {
-        highestCellDimension = 0;
-        for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
+        double pointcoords[3];
+        structure->GetPoint(point, pointcoords);
+        // Get all cells touching this point.
+        vtkIdType numCellNeighbors = links.GetNumberOfCells(point);
+        const vtkIdType *cellsOnPoint = links.GetCells(point);
+
+        std::fill(g.begin(), g.end(), static_cast<data_type>(0));
+
+        int highestDimension = highestCellDimension;
+        if (contributingCellOption == vtkGradientFilter::Patch)
         {
-          int cellDimension = structure->GetCell(cellsOnPoint->GetId(neighbor))->GetCellDimension();
-          if (cellDimension > highestCellDimension)
+          highestDimension = 0;
+          for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
           {
-            highestCellDimension = cellDimension;
-            if (highestCellDimension == maxCellDimension)
-            {
-              break;
-            }
+            highestDimension = std::max(
+              highestDimension, static_cast<int>(cellDimensions[cellsOnPoint[neighbor]]));
           }
         }
-      }
-      vtkIdType numValidCellNeighbors = 0;
+        vtkIdType numValidCellNeighbors = 0;
 
-      // Iterate on all cells and find all points connected to current point
-      // by an edge.
-      for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
-      {
-        vtkCell *cell = structure->GetCell(cellsOnPoint->GetId(neighbor));
-        if (cell->GetCellDimension() >= highestCellDimension)
+        // Iterate on all cells and find all points connected to current point
+        // by an edge.
+        for (vtkIdType neighbor = 0; neighbor < numCellNeighbors; neighbor++)
         {
+          vtkIdType cellId = cellsOnPoint[neighbor];
+          if (cellDimensions && cellDimensions[cellId] < highestDimension)
+          {
+            continue;
+          }
+          structure->GetCell(cellId, cell);
           int subId;
           double parametricCoord[3];
           if(GetCellParametricData(point, pointcoords, cell,
-                                   subId, parametricCoord))
+                                   subId, parametricCoord, weights))
           {
             numValidCellNeighbors++;
-            for(int inputComponent=0;inputComponent<numberOfInputComponents;inputComponent++)
+            // Get values of Array at cell points, and the derivatives of all
+            // the components at once.
+            int numberOfCellPoints = cell->GetNumberOfPoints();
+            values.resize(numberOfCellPoints*numberOfInputComponents);
+            for (int i = 0; i < numberOfCellPoints; i++)
+            {
+              array->GetTuple(cell->GetPointId(i),
+                              &values[i*numberOfInputComponents]);
+            }
+            cell->Derivatives(subId, parametricCoord, &values[0],
+                              numberOfInputComponents, &derivative[0]);
+            for(int i=0;i<numberOfOutputComponents;i++)
             {
-              int numberOfCellPoints = cell->GetNumberOfPoints();
-              std::vector<double> values(numberOfCellPoints);
-              // Get values of Array at cell points.
-              for (int i = 0; i < numberOfCellPoints; i++)
-              {
-                values[i] = array->GetComponent(cell->GetPointId(i), inputComponent);
-              }
-
-              double derivative[3];
-              // Get derivative of cell at point.
-              cell->Derivatives(subId, parametricCoord, &values[0], 1, derivative);
-
-              g[inputComponent*3] += static_cast<data_type>(derivative[0]);
-              g[inputComponent*3+1] += static_cast<data_type>(derivative[1]);
-              g[inputComponent*3+2] += static_cast<data_type>(derivative[2]);
-            } // iterating over Components
+              g[i] += static_cast<data_type>(derivative[i]);
+            }
           } // if(GetCellParametricData())
-        } // if(cell->GetCellDimension () >= highestCellDimension
-      } // iterating over neighbors
-
-      if (numValidCellNeighbors > 0)
-      {
-        for(int i=0;i<3*numberOfInputComponents;i++)
-        {
-          g[i] /= numValidCellNeighbors;
-        }
+        } // iterating over neighbors
 
-        if(vorticity)
-        {
-          ComputeVorticityFromGradient(&g[0], vorticity+3*point);
-        }
-        if(qCriterion)
-        {
-          ComputeQCriterionFromGradient(&g[0], qCriterion+point);
-        }
-        if(divergence)
-        {
-          ComputeDivergenceFromGradient(&g[0], divergence+point);
-        }
-        if(gradients)
+        if (numValidCellNeighbors > 0)
         {
           for(int i=0;i<numberOfOutputComponents;i++)
           {
-            gradients[point*numberOfOutputComponents+i] = g[i];
+            g[i] /= numValidCellNeighbors;
+          }
+
+          if(vorticity)
+          {
+            ComputeVorticityFromGradient(&g[0], vorticity+3*point);
+          }
+          if(qCriterion)
+          {
+            ComputeQCriterionFromGradient(&g[0], qCriterion+point);
+          }
+          if(divergence)
+          {
+            ComputeDivergenceFromGradient(&g[0], divergence+point);
+          }
+          if(gradients)
+          {
+            std::copy(g.begin(), g.end(),
+                      gradients + point*numberOfOutputComponents);
           }
         }
-      }
-    }  // iterating over points in grid
+      }  // iterating over points in grid
+    };
+
+    ForEach(numpts, threaded, computeGradients);
   }
 
 //-----------------------------------------------------------------------------
   int GetCellParametricData(vtkIdType pointId, double pointCoord[3],
-                            vtkCell *cell, int &subId, double parametricCoord[3])
+                            vtkCell *cell, int &subId, double parametricCoord[3],
+                            std::vector<double>& weights)
   {
     // Watch out for degenerate cells.  They make the derivative calculation
     // fail.
     vtkIdList *pointIds = cell->GetPointIds();
     int timesPointRegistered = 0;
+    int cellPointId = 0;
     for (int i = 0; i < pointIds->GetNumberOfIds(); i++)
     {
       if (pointId == pointIds->GetId(i))
       {
         timesPointRegistered++;
+        cellPointId = i;
       }
     }
     if (timesPointRegistered != 1)
@@ -972,12 +1039,34 @@ namespace {
       return 0;
     }
 
+    // The parametric coordinates of the vertices of the linear cells are
+    // known, which saves the Newton iterations of EvaluatePosition().
+    switch (cell->GetCellType())
+    {
+      case VTK_LINE:
+      case VTK_TRIANGLE:
+      case VTK_QUAD:
+      case VTK_PIXEL:
+      case VTK_TETRA:
+      case VTK_VOXEL:
+      case VTK_HEXAHEDRON:
+      case VTK_WEDGE:
+      case VTK_PYRAMID:
+      {
+        const double *pcoords = cell->GetParametricCoords() + 3*cellPointId;
+        subId = 0;
+        parametricCoord[0] = pcoords[0];
+        parametricCoord[1] = pcoords[1];
+        parametricCoord[2] = pcoords[2];
+        return 1;
+      }
+    }
+
     double dummy;
-    int numpoints = cell->GetNumberOfPoints();
-    std::vector<double> values(numpoints);
+    weights.resize(cell->GetNumberOfPoints());
     // Get parametric position of point.
     cell->EvaluatePosition(pointCoord, nullptr, subId, parametricCoord,
-                           dummy, &values[0]/*Really another dummy.*/);
+                           dummy, &weights[0]);
 
     return 1;
   }
@@ -987,370 +1076,335 @@ namespace {
     void ComputeCellGradientsUG(
       vtkDataSet *structure, vtkDataArray *array, data_type *gradients,
       int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-      data_type* divergence)
+      data_type* divergence, bool threaded)
   {
     vtkIdType numcells = structure->GetNumberOfCells();
-    std::vector<double> values(8);
-    std::vector<data_type> cellGradients(3*numberOfInputComponents);
-    for (vtkIdType cellid = 0; cellid < numcells; cellid++)
+    int numberOfOutputComponents = 3*numberOfInputComponents;
+    vtkSMPThreadLocalObject<vtkGenericCell> cells;
+
+    auto computeGradients = [&](vtkIdType cellid, vtkIdType endCellId)
     {
-      vtkCell *cell = structure->GetCell(cellid);
-      int subId;
-      double cellCenter[3];
-      subId = cell->GetParametricCenter(cellCenter);
+      vtkGenericCell *cell = cells.Local();
+      std::vector<double> values(8*numberOfInputComponents);
+      std::vector<double> derivative(numberOfOutputComponents);
+      std::vector<data_type> cellGradients(numberOfOutputComponents);
 
-      int numpoints = cell->GetNumberOfPoints();
-      if(static_cast<size_t>(numpoints) > values.size())
-      {
-        values.resize(numpoints);
-      }
-      double derivative[3];
-      for(int inputComponent=0;inputComponent<numberOfInputComponents;
-          inputComponent++)
+      for (; cellid < endCellId; cellid++)
       {
+        structure->GetCell(cellid, cell);
+        int subId;
+        double cellCenter[3];
+        subId = cell->GetParametricCenter(cellCenter);
+
+        int numpoints = cell->GetNumberOfPoints();
+        if(static_cast<size_t>(numpoints*numberOfInputComponents) > values.size())
+        {
+          values.resize(numpoints*numberOfInputComponents);
+        }
         for (int i = 0; i < numpoints; i++)
         {
-          values[i] = array->GetComponent(cell->GetPointId(i), inputComponent);
+          array->GetTuple(cell->GetPointId(i), &values[i*numberOfInputComponents]);
         }
 
-        cell->Derivatives(subId, cellCenter, &values[0], 1, derivative);
-        cellGradients[inputComponent*3] =
-          static_cast<data_type>(derivative[0]);
-        cellGradients[inputComponent*3+1] =
-          static_cast<data_type>(derivative[1]);
-        cellGradients[inputComponent*3+2] =
-          static_cast<data_type>(derivative[2]);
-      }
-      if(gradients)
-      {
-        for(int i=0;i<3*numberOfInputComponents;i++)
+        // empty cells leave the derivatives untouched
+        std::fill(derivative.begin(), derivative.end(), 0.0);
+        cell->Derivatives(subId, cellCenter, &values[0], numberOfInputComponents,
+                          &derivative[0]);
+        for(int i=0;i<numberOfOutputComponents;i++)
+        {
+          cellGradients[i] = static_cast<data_type>(derivative[i]);
+        }
+        if(gradients)
+        {
+          std::copy(cellGradients.begin(), cellGradients.end(),
+                    gradients + cellid*numberOfOutputComponents);
+        }
+        if(vorticity)
         {
-          gradients[cellid*3*numberOfInputComponents+i] = cellGradients[i];
+          ComputeVorticityFromGradient(&cellGradients[0], vorticity+3*cellid);
+        }
+        if(qCriterion)
+        {
+          ComputeQCriterionFromGradient(&cellGradients[0], qCriterion+cellid);
+        }
+        if(divergence)
+        {
+          ComputeDivergenceFromGradient(&cellGradients[0], divergence+cellid);
         }
       }
-      if(vorticity)
+    };
+
+    ForEach(numcells, threaded, computeGradients);
+  }
+
+//-----------------------------------------------------------------------------
+  // Finite difference gradients of the points (or cells) of image data,
+  // rectilinear and structured grids, computed from the values of their
+  // neighbors along the i, j and k directions. The lines of the grid are
+  // processed concurrently.
+  template<class data_type>
+  struct StructuredGradientsWorker
+  {
+    vtkDataSet* Grid;
+    const double* CellCenters; // nullptr for point data
+    std::vector<double> Axes[3]; // empty unless the points are on axes
+    int Dims[3];
+    int NumberOfInputComponents;
+    data_type* Gradients;
+    data_type* Vorticity;
+    data_type* QCriterion;
+    data_type* Divergence;
+
+    void GetCoordinate(const int ijk[3], vtkIdType idx, double x[3]) const
+    {
+      if (this->CellCenters)
       {
-        ComputeVorticityFromGradient(&cellGradients[0], vorticity+3*cellid);
+        std::copy(this->CellCenters + 3*idx, this->CellCenters + 3*idx + 3, x);
       }
-      if(qCriterion)
+      else if (!this->Axes[0].empty())
       {
-        ComputeQCriterionFromGradient(&cellGradients[0], qCriterion+cellid);
+        x[0] = this->Axes[0][ijk[0]];
+        x[1] = this->Axes[1][ijk[1]];
+        x[2] = this->Axes[2][ijk[2]];
       }
-      if(divergence)
+      else
       {
-        ComputeDivergenceFromGradient(&cellGradients[0], divergence+cellid);
+        this->Grid->GetPoint(idx, x);
       }
     }
-  }
 
-//-----------------------------------------------------------------------------
-  template<class Grid, class data_type>
-  void ComputeGradientsSG(Grid output, vtkDataArray* array, data_type* gradients,
-                          int numberOfInputComponents, int fieldAssociation,
-                          data_type* vorticity, data_type* qCriterion,
-                          data_type* divergence)
-  {
-    int idx, idx2, inputComponent;
-    double xp[3], xm[3], factor;
-    xp[0] = xp[1] = xp[2] = xm[0] = xm[1] = xm[2] = factor = 0;
-    double xxi, yxi, zxi, xeta, yeta, zeta, xzeta, yzeta, zzeta;
-    yxi = zxi = xeta = yeta = zeta = xzeta = yzeta = zzeta = 0;
-    double aj, xix, xiy, xiz, etax, etay, etaz, zetax, zetay, zetaz;
-    xix = xiy = xiz = etax = etay = etaz = zetax = zetay = zetaz = 0;
-    // for finite differencing -- the values on the "plus" side and
-    // "minus" side of the point to be computed at
-    std::vector<double> plusvalues(numberOfInputComponents);
-    std::vector<double> minusvalues(numberOfInputComponents);
-
-    std::vector<double> dValuesdXi(numberOfInputComponents);
-    std::vector<double> dValuesdEta(numberOfInputComponents);
-    std::vector<double> dValuesdZeta(numberOfInputComponents);
-    std::vector<data_type> localGradients(numberOfInputComponents*3);
-
-    int dims[3];
-    output->GetDimensions(dims);
-    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+    // Differences of the coordinates and of the values along direction dir:
+    // centered inside the grid and one-sided on its boundary.
+    template<class Accessor>
+    void Differentiate(Accessor& values, int dir, const int ijk[3],
+                       double dx[3], double* dValues) const
     {
-      // reduce the dimensions by 1 for cells
-      for(int i=0;i<3;i++)
+      if ( this->Dims[dir] == 1 ) // 2D in this direction
+      {
+        dx[0] = dx[1] = dx[2] = 0.0;
+        dx[dir] = 1.0;
+        std::fill(dValues, dValues + this->NumberOfInputComponents, 0.0);
+        return;
+      }
+
+      double factor = 1.0;
+      int plus[3] = { ijk[0], ijk[1], ijk[2] };
+      int minus[3] = { ijk[0], ijk[1], ijk[2] };
+      if ( ijk[dir] == 0 )
+      {
+        plus[dir]++;
+      }
+      else if ( ijk[dir] == (this->Dims[dir]-1) )
       {
-        dims[i]--;
+        minus[dir]--;
+      }
+      else
+      {
+        factor = 0.5;
+        plus[dir]++;
+        minus[dir]--;
+      }
+      vtkIdType ijsize = static_cast<vtkIdType>(this->Dims[0])*this->Dims[1];
+      vtkIdType idx = plus[0] + plus[1]*static_cast<vtkIdType>(this->Dims[0]) +
+        plus[2]*ijsize;
+      vtkIdType idx2 = minus[0] + minus[1]*static_cast<vtkIdType>(this->Dims[0]) +
+        minus[2]*ijsize;
+
+      double xp[3], xm[3];
+      this->GetCoordinate(plus, idx, xp);
+      this->GetCoordinate(minus, idx2, xm);
+      for (int ii=0; ii<3; ii++)
+      {
+        dx[ii] = factor * (xp[ii] - xm[ii]);
+      }
+      for (int inputComponent=0; inputComponent<this->NumberOfInputComponents;
+           inputComponent++)
+      {
+        dValues[inputComponent] = factor *
+          (static_cast<double>(values.Get(idx, inputComponent)) -
+           static_cast<double>(values.Get(idx2, inputComponent)));
       }
     }
-    int ijsize = dims[0]*dims[1];
 
-    for (int k=0; k<dims[2]; k++)
+    template<class ArrayT>
+    void operator()(ArrayT* array)
     {
-      for (int j=0; j<dims[1]; j++)
+      vtkDataArrayAccessor<ArrayT> values(array);
+      const int numberOfInputComponents = this->NumberOfInputComponents;
+      const vtkIdType ijsize = static_cast<vtkIdType>(this->Dims[0])*this->Dims[1];
+      const vtkIdType numLines = static_cast<vtkIdType>(this->Dims[1])*this->Dims[2];
+
+      vtkSMPTools::For(0, numLines, [&](vtkIdType line, vtkIdType endLine)
       {
-        for (int i=0; i<dims[0]; i++)
+        std::vector<double> dValuesdXi(numberOfInputComponents);
+        std::vector<double> dValuesdEta(numberOfInputComponents);
+        std::vector<double> dValuesdZeta(numberOfInputComponents);
+        std::vector<data_type> localGradients(numberOfInputComponents*3);
+
+        for (; line < endLine; line++)
         {
-          //  Xi derivatives.
-          if ( dims[0] == 1 ) // 2D in this direction
-          {
-            factor = 1.0;
-            for (int ii=0; ii<3; ii++)
-            {
-              xp[ii] = xm[ii] = 0.0;
-            }
-            xp[0] = 1.0;
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = minusvalues[inputComponent] = 0;
-            }
-          }
-          else if ( i == 0 )
-          {
-            factor = 1.0;
-            idx = (i+1) + j*dims[0] + k*ijsize;
-            idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
-            }
-          }
-          else if ( i == (dims[0]-1) )
-          {
-            factor = 1.0;
-            idx = i + j*dims[0] + k*ijsize;
-            idx2 = i-1 + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
-            }
-          }
-          else
+          int ijk[3];
+          ijk[1] = static_cast<int>(line % this->Dims[1]);
+          ijk[2] = static_cast<int>(line / this->Dims[1]);
+          for (ijk[0]=0; ijk[0]<this->Dims[0]; ijk[0]++)
           {
-            factor = 0.5;
-            idx = (i+1) + j*dims[0] + k*ijsize;
-            idx2 = (i-1) + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
+            double dxdxi[3], dxdeta[3], dxdzeta[3];
+            this->Differentiate(values, 0, ijk, dxdxi, &dValuesdXi[0]);
+            this->Differentiate(values, 1, ijk, dxdeta, &dValuesdEta[0]);
+            this->Differentiate(values, 2, ijk, dxdzeta, &dValuesdZeta[0]);
+            double xxi = dxdxi[0], yxi = dxdxi[1], zxi = dxdxi[2];
+            double xeta = dxdeta[0], yeta = dxdeta[1], zeta = dxdeta[2];
+            double xzeta = dxdzeta[0], yzeta = dxdzeta[1], zzeta = dxdzeta[2];
+
+            // Now calculate the Jacobian.  Grids occasionally have
+            // singularities, or points where the Jacobian is infinite (the
+            // inverse is zero).  For these cases, we'll set the Jacobian to
+            // zero, which will result in a zero derivative.
+            //
+            double aj =  xxi*yeta*zzeta+yxi*zeta*xzeta+zxi*xeta*yzeta
+              -zxi*yeta*xzeta-yxi*xeta*zzeta-xxi*zeta*yzeta;
+            if (aj != 0.0)
             {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
+              aj = 1. / aj;
             }
-          }
-
-          xxi = factor * (xp[0] - xm[0]);
-          yxi = factor * (xp[1] - xm[1]);
-          zxi = factor * (xp[2] - xm[2]);
-          for(inputComponent=0;inputComponent<numberOfInputComponents;inputComponent++)
-          {
-            dValuesdXi[inputComponent] = factor *
-              (plusvalues[inputComponent] - minusvalues[inputComponent]);
-          }
 
-          //  Eta derivatives.
-          if ( dims[1] == 1 ) // 2D in this direction
-          {
-            factor = 1.0;
-            for (int ii=0; ii<3; ii++)
-            {
-              xp[ii] = xm[ii] = 0.0;
-            }
-            xp[1] = 1.0;
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
+            //  Xi metrics.
+            double xix  =  aj*(yeta*zzeta-zeta*yzeta);
+            double xiy  = -aj*(xeta*zzeta-zeta*xzeta);
+            double xiz  =  aj*(xeta*yzeta-yeta*xzeta);
+
+            //  Eta metrics.
+            double etax = -aj*(yxi*zzeta-zxi*yzeta);
+            double etay =  aj*(xxi*zzeta-zxi*xzeta);
+            double etaz = -aj*(xxi*yzeta-yxi*xzeta);
+
+            //  Zeta metrics.
+            double zetax=  aj*(yxi*zeta-zxi*yeta);
+            double zetay= -aj*(xxi*zeta-zxi*xeta);
+            double zetaz=  aj*(xxi*yeta-yxi*xeta);
+
+            // Finally compute the actual derivatives
+            vtkIdType idx = ijk[0] + ijk[1]*static_cast<vtkIdType>(this->Dims[0]) +
+              ijk[2]*ijsize;
+            for(int inputComponent=0;inputComponent<numberOfInputComponents;
                 inputComponent++)
             {
-              plusvalues[inputComponent] = minusvalues[inputComponent] = 0;
-            }
-          }
-          else if ( j == 0 )
-          {
-            factor = 1.0;
-            idx = i + (j+1)*dims[0] + k*ijsize;
-            idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
-            }
-          }
-          else if ( j == (dims[1]-1) )
-          {
-            factor = 1.0;
-            idx = i + j*dims[0] + k*ijsize;
-            idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
-            }
-          }
-          else
-          {
-            factor = 0.5;
-            idx = i + (j+1)*dims[0] + k*ijsize;
-            idx2 = i + (j-1)*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
-            {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
-            }
-          }
+              localGradients[inputComponent*3] = static_cast<data_type>(
+                xix*dValuesdXi[inputComponent]+etax*dValuesdEta[inputComponent]+
+                zetax*dValuesdZeta[inputComponent]);
 
-          xeta = factor * (xp[0] - xm[0]);
-          yeta = factor * (xp[1] - xm[1]);
-          zeta = factor * (xp[2] - xm[2]);
-          for(inputComponent=0;inputComponent<numberOfInputComponents;inputComponent++)
-          {
-            dValuesdEta[inputComponent] = factor *
-              (plusvalues[inputComponent] - minusvalues[inputComponent]);
-          }
+              localGradients[inputComponent*3+1] = static_cast<data_type>(
+                xiy*dValuesdXi[inputComponent]+etay*dValuesdEta[inputComponent]+
+                zetay*dValuesdZeta[inputComponent]);
 
-          //  Zeta derivatives.
-          if ( dims[2] == 1 ) // 2D in this direction
-          {
-            factor = 1.0;
-            for (int ii=0; ii<3; ii++)
-            {
-              xp[ii] = xm[ii] = 0.0;
+              localGradients[inputComponent*3+2] = static_cast<data_type>(
+                xiz*dValuesdXi[inputComponent]+etaz*dValuesdEta[inputComponent]+
+                zetaz*dValuesdZeta[inputComponent]);
             }
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
+
+            if(this->Gradients)
             {
-              plusvalues[inputComponent] = minusvalues[inputComponent] = 0;
+              std::copy(localGradients.begin(), localGradients.end(),
+                        this->Gradients + idx*numberOfInputComponents*3);
             }
-            xp[2] = 1.0;
-          }
-          else if ( k == 0 )
-          {
-            factor = 1.0;
-            idx = i + j*dims[0] + (k+1)*ijsize;
-            idx2 = i + j*dims[0] + k*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
+            if(this->Vorticity)
             {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
+              ComputeVorticityFromGradient(&localGradients[0], this->Vorticity+3*idx);
             }
-          }
-          else if ( k == (dims[2]-1) )
-          {
-            factor = 1.0;
-            idx = i + j*dims[0] + k*ijsize;
-            idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
+            if(this->QCriterion)
             {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
+              ComputeQCriterionFromGradient(&localGradients[0], this->QCriterion+idx);
             }
-          }
-          else
-          {
-            factor = 0.5;
-            idx = i + j*dims[0] + (k+1)*ijsize;
-            idx2 = i + j*dims[0] + (k-1)*ijsize;
-            GetGridEntityCoordinate(output, fieldAssociation, idx, xp);
-            GetGridEntityCoordinate(output, fieldAssociation, idx2, xm);
-            for(inputComponent=0;inputComponent<numberOfInputComponents;
-                inputComponent++)
+            if(this->Divergence)
             {
-              plusvalues[inputComponent] = array->GetComponent(idx, inputComponent);
-              minusvalues[inputComponent] = array->GetComponent(idx2, inputComponent);
+              ComputeDivergenceFromGradient(&localGradients[0], this->Divergence+idx);
             }
           }
+        }
+      });
+    }
+  };
 
-          xzeta = factor * (xp[0] - xm[0]);
-          yzeta = factor * (xp[1] - xm[1]);
-          zzeta = factor * (xp[2] - xm[2]);
-          for(inputComponent=0;inputComponent<numberOfInputComponents;inputComponent++)
-          {
-            dValuesdZeta[inputComponent] = factor *
-              (plusvalues[inputComponent] - minusvalues[inputComponent]);
-          }
-
-          // Now calculate the Jacobian.  Grids occasionally have
-          // singularities, or points where the Jacobian is infinite (the
-          // inverse is zero).  For these cases, we'll set the Jacobian to
-          // zero, which will result in a zero derivative.
-          //
-          aj =  xxi*yeta*zzeta+yxi*zeta*xzeta+zxi*xeta*yzeta
-            -zxi*yeta*xzeta-yxi*xeta*zzeta-xxi*zeta*yzeta;
-          if (aj != 0.0)
-          {
-            aj = 1. / aj;
-          }
-
-          //  Xi metrics.
-          xix  =  aj*(yeta*zzeta-zeta*yzeta);
-          xiy  = -aj*(xeta*zzeta-zeta*xzeta);
-          xiz  =  aj*(xeta*yzeta-yeta*xzeta);
-
-          //  Eta metrics.
-          etax = -aj*(yxi*zzeta-zxi*yzeta);
-          etay =  aj*(xxi*zzeta-zxi*xzeta);
-          etaz = -aj*(xxi*yzeta-yxi*xzeta);
-
-          //  Zeta metrics.
-          zetax=  aj*(yxi*zeta-zxi*yeta);
-          zetay= -aj*(xxi*zeta-zxi*xeta);
-          zetaz=  aj*(xxi*yeta-yxi*xeta);
-
-          // Finally compute the actual derivatives
-          idx = i + j*dims[0] + k*ijsize;
-          for(inputComponent=0;inputComponent<numberOfInputComponents;inputComponent++)
-          {
-            localGradients[inputComponent*3] = static_cast<data_type>(
-              xix*dValuesdXi[inputComponent]+etax*dValuesdEta[inputComponent]+
-              zetax*dValuesdZeta[inputComponent]);
+//-----------------------------------------------------------------------------
+  // The points of image data and rectilinear grids are found from their
+  // coordinates along the three axes, like GetPoint() does.
+  void GetAxisCoordinates(vtkImageData* image, std::vector<double> axes[3])
+  {
+    const int* extent = image->GetExtent();
+    const double* origin = image->GetOrigin();
+    const double* spacing = image->GetSpacing();
+    for (int i=0; i<3; i++)
+    {
+      for (int loc=extent[2*i]; loc<=extent[2*i+1]; loc++)
+      {
+        axes[i].push_back(origin[i] + loc * spacing[i]);
+      }
+    }
+  }
 
-            localGradients[inputComponent*3+1] = static_cast<data_type>(
-              xiy*dValuesdXi[inputComponent]+etay*dValuesdEta[inputComponent]+
-              zetay*dValuesdZeta[inputComponent]);
+  void GetAxisCoordinates(vtkRectilinearGrid* grid, std::vector<double> axes[3])
+  {
+    vtkDataArray* coordinates[3] = { grid->GetXCoordinates(),
+      grid->GetYCoordinates(), grid->GetZCoordinates() };
+    for (int i=0; i<3; i++)
+    {
+      for (vtkIdType loc=0; loc<coordinates[i]->GetNumberOfTuples(); loc++)
+      {
+        axes[i].push_back(coordinates[i]->GetComponent(loc, 0));
+      }
+    }
+  }
 
-            localGradients[inputComponent*3+2] = static_cast<data_type>(
-              xiz*dValuesdXi[inputComponent]+etaz*dValuesdEta[inputComponent]+
-              zetaz*dValuesdZeta[inputComponent]);
-          }
+  void GetAxisCoordinates(vtkStructuredGrid*, std::vector<double>*)
+  {
+  }
 
-          if(gradients)
-          {
-            for(int ii=0;ii<3*numberOfInputComponents;ii++)
-            {
-              gradients[idx*numberOfInputComponents*3+ii] = localGradients[ii];
-            }
-          }
-          if(vorticity)
-          {
-            ComputeVorticityFromGradient(&localGradients[0], vorticity+3*idx);
-          }
-          if(qCriterion)
-          {
-            ComputeQCriterionFromGradient(&localGradients[0], qCriterion+idx);
-          }
-          if(divergence)
-          {
-            ComputeDivergenceFromGradient(&localGradients[0], divergence+idx);
-          }
+//-----------------------------------------------------------------------------
+  template<class Grid, class data_type>
+  void ComputeGradientsSG(Grid output, vtkDataArray* array, data_type* gradients,
+                          int numberOfInputComponents, int fieldAssociation,
+                          data_type* vorticity, data_type* qCriterion,
+                          data_type* divergence)
+  {
+    StructuredGradientsWorker<data_type> worker;
+    worker.Grid = output;
+    worker.CellCenters = nullptr;
+    worker.NumberOfInputComponents = numberOfInputComponents;
+    worker.Gradients = gradients;
+    worker.Vorticity = vorticity;
+    worker.QCriterion = qCriterion;
+    worker.Divergence = divergence;
+
+    output->GetDimensions(worker.Dims);
+    std::vector<double> cellCenters;
+    if(fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_CELLS)
+    {
+      // reduce the dimensions by 1 for cells, except in the directions in
+      // which the grid is flat
+      for(int i=0;i<3;i++)
+      {
+        if (worker.Dims[i] > 1)
+        {
+          worker.Dims[i]--;
         }
       }
+      // each cell center is used by up to 7 cells: compute them once
+      GetCellCenters(output, cellCenters);
+      worker.CellCenters = cellCenters.empty() ? nullptr : &cellCenters[0];
+    }
+    else
+    {
+      GetAxisCoordinates(output, worker.Axes);
+    }
+    if (static_cast<vtkIdType>(worker.Dims[0])*worker.Dims[1]*worker.Dims[2] !=
+        array->GetNumberOfTuples())
+    {
+      return;
+    }
+
+    if (!vtkArrayDispatch::Dispatch::Execute(array, worker))
+    {
+      worker(array);
     }
   }
 
@@ -39,6 +39,10 @@
  * the entire data set. For Patch or DataSetMax it is possible that some values
  * will not be computed. The ReplacementValueOption specifies what to use
  * for these values.
+ *
+ * The points (or cells) are processed in parallel with vtkSMPTools for image
+ * data, rectilinear and structured grids, unstructured grids and polydata.
+ * Other datasets are processed serially.
 */
 
 #ifndef vtkGradientFilter_h
@@ -31,6 +31,7 @@
 
 #include "vtkTableBasedClipDataSet.h"
 
+#include "vtkArrayListTemplate.h"
 #include "vtkExecutive.h"
 #include "vtkInformation.h"
 #include "vtkSmartPointer.h"
@@ -57,9 +58,20 @@
 #include "vtkRectilinearGrid.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
 
 #include "vtkTableBasedClipCases.h"
 
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
 vtkStandardNewMacro( vtkTableBasedClipDataSet );
 vtkCxxSetObjectMacro( vtkTableBasedClipDataSet, ClipFunction, vtkImplicitFunction );
 
@@ -611,6 +623,13 @@ class  vtkTableBasedClipperVolumeFromVolume :
                                 vtkUnstructuredGrid *, int *, double *,
                                 double *, double * );
 
+    // Merge pieces that clipped consecutive ranges of cells (in this order)
+    // into the output. The output is the same as for a single piece having
+    // clipped all the cells. The pieces are processed in parallel.
+    static void ConstructMergedDataSet
+                ( const std::vector< vtkTableBasedClipperVolumeFromVolume * > &,
+                  vtkDataSet *, vtkUnstructuredGrid *, double * );
+
     int      AddCentroidPoint( int n, int * p )
              { return -1 - centroid_list.AddPoint( n, p ); }
 
@@ -651,6 +670,7 @@ class  vtkTableBasedClipperVolumeFromVolume :
     void         ConstructDataSet
                  ( vtkDataSet *, vtkUnstructuredGrid *,
                    TableBasedClipperCommonPointsStructure & );
+    vtkPoints  * NewOutputPoints( vtkDataSet * ) const;
 };
 
 
@@ -1285,29 +1305,7 @@ void vtkTableBasedClipperVolumeFromVolume::
   //
   // Set up the output points and its point data.
   //
-  vtkPoints * outPts = vtkPoints::New();
-
-  // set precision for the points in the output
-  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
-  {
-    vtkPointSet *inputPointSet = vtkPointSet::SafeDownCast(input);
-    if(inputPointSet)
-    {
-      outPts->SetDataType(inputPointSet->GetPoints()->GetDataType());
-    }
-    else
-    {
-      outPts->SetDataType(VTK_FLOAT);
-    }
-  }
-  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
-  {
-    outPts->SetDataType(VTK_FLOAT);
-  }
-  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
-  {
-    outPts->SetDataType(VTK_DOUBLE);
-  }
+  vtkPoints * outPts = this->NewOutputPoints( input );
 
   int centroidStart  = numUsed + pt_list.GetTotalNumberOfPoints();
   int nOutPts        = centroidStart + centroid_list.GetTotalNumberOfPoints();
@@ -1582,6 +1580,478 @@ void vtkTableBasedClipperVolumeFromVolume::
   delete [] ptLookup;
 }
 
+vtkPoints * vtkTableBasedClipperVolumeFromVolume::
+            NewOutputPoints( vtkDataSet * input ) const
+{
+  vtkPoints * outPts = vtkPoints::New();
+
+  // set precision for the points in the output
+  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    vtkPointSet *inputPointSet = vtkPointSet::SafeDownCast(input);
+    if(inputPointSet)
+    {
+      outPts->SetDataType(inputPointSet->GetPoints()->GetDataType());
+    }
+    else
+    {
+      outPts->SetDataType(VTK_FLOAT);
+    }
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  {
+    outPts->SetDataType(VTK_FLOAT);
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    outPts->SetDataType(VTK_DOUBLE);
+  }
+
+  return outPts;
+}
+
+// An edge point of a piece, identified by its index in the concatenation of
+// the point lists of all the pieces.
+struct TableBasedClipperEdgeEntry
+{
+  int        ptIds[2];
+  vtkIdType  index;
+
+  bool IsSameEdge( const TableBasedClipperEdgeEntry & other ) const
+  {
+    return ptIds[0] == other.ptIds[0] && ptIds[1] == other.ptIds[1];
+  }
+
+  bool operator < ( const TableBasedClipperEdgeEntry & other ) const
+  {
+    if ( ptIds[0] != other.ptIds[0] )
+    {
+      return ptIds[0] < other.ptIds[0];
+    }
+    if ( ptIds[1] != other.ptIds[1] )
+    {
+      return ptIds[1] < other.ptIds[1];
+    }
+    return index < other.index;
+  }
+};
+
+void vtkTableBasedClipperVolumeFromVolume::ConstructMergedDataSet
+     ( const std::vector< vtkTableBasedClipperVolumeFromVolume * > & pieces,
+       vtkDataSet * input, vtkUnstructuredGrid * output, double * pts_ptr )
+{
+  const vtkIdType numPieces  = static_cast< vtkIdType >( pieces.size() );
+  const vtkIdType numPrevPts = pieces[0]->numPrevPts;
+  const int       nshapes    = pieces[0]->nshapes;
+
+  vtkPointData * inPD = input->GetPointData();
+  vtkCellData  * inCD = input->GetCellData();
+
+  vtkPointData * outPD = output->GetPointData();
+  vtkCellData  * outCD = output->GetCellData();
+
+  //
+  // Offsets of the pieces in the concatenations of their edge points, of
+  // their centroid points and of their shapes. As for a single piece, all the
+  // shapes of a type come before the shapes of the next type: the shapes of
+  // type i of piece p start at ( i * numPieces + p ).
+  //
+  std::vector< vtkIdType > edgeOffsets( numPieces + 1, 0 );
+  std::vector< vtkIdType > centroidOffsets( numPieces + 1, 0 );
+  std::vector< vtkIdType > shapeOffsets( nshapes * numPieces + 1, 0 );
+  std::vector< vtkIdType > connOffsets( nshapes * numPieces + 1, 0 );
+  for ( vtkIdType p = 0; p < numPieces; p ++ )
+  {
+    edgeOffsets[ p + 1 ] = edgeOffsets[p] +
+      pieces[p]->pt_list.GetTotalNumberOfPoints();
+    centroidOffsets[ p + 1 ] = centroidOffsets[p] +
+      pieces[p]->centroid_list.GetTotalNumberOfPoints();
+  }
+  for ( vtkIdType s = 0; s < nshapes * numPieces; s ++ )
+  {
+    vtkTableBasedClipperShapeList * shapes =
+      pieces[ s % numPieces ]->shapes[ s / numPieces ];
+    vtkIdType ns = shapes->GetTotalNumberOfShapes();
+    shapeOffsets[ s + 1 ] = shapeOffsets[s] + ns;
+    connOffsets[ s + 1 ]  = connOffsets[s] + ( shapes->GetShapeSize() + 1 ) * ns;
+  }
+  vtkIdType numEdges  = edgeOffsets[ numPieces ];
+  vtkIdType ncells    = shapeOffsets[ nshapes * numPieces ];
+  vtkIdType conn_size = connOffsets[ nshapes * numPieces ];
+
+  //
+  // Merge the edge points shared by several pieces. The first piece creating
+  // an edge point gives it its position, and the edge points are numbered in
+  // order of creation, as with a single piece.
+  //
+  std::vector< const TableBasedClipperPointEntry * > edges( numEdges );
+  std::vector< TableBasedClipperEdgeEntry > sortedEdges( numEdges );
+  vtkSMPTools::For( 0, numPieces, 1, [&]( vtkIdType p, vtkIdType endP )
+  {
+    for ( ; p < endP; p ++ )
+    {
+      const vtkTableBasedClipperPointList & pt_list = pieces[p]->pt_list;
+      vtkIdType index = edgeOffsets[p];
+      int nLists = pt_list.GetNumberOfLists();
+      for ( int i = 0; i < nLists; i ++ )
+      {
+        const TableBasedClipperPointEntry * pe_list = nullptr;
+        int nPts = pt_list.GetList( i, pe_list );
+        for ( int j = 0; j < nPts; j ++, index ++ )
+        {
+          edges[ index ] = pe_list + j;
+          sortedEdges[ index ].ptIds[0] = pe_list[j].ptIds[0];
+          sortedEdges[ index ].ptIds[1] = pe_list[j].ptIds[1];
+          sortedEdges[ index ].index    = index;
+        }
+      }
+    }
+  } );
+  vtkSMPTools::Sort( sortedEdges.begin(), sortedEdges.end() );
+
+  std::vector< vtkIdType > firstEdges( numEdges );
+  vtkSMPTools::For( 0, numEdges, [&]( vtkIdType i, vtkIdType endI )
+  {
+    for ( ; i < endI; i ++ )
+    {
+      if ( i > 0 && sortedEdges[i].IsSameEdge( sortedEdges[ i - 1 ] ) )
+      {
+        continue;
+      }
+      for ( vtkIdType j = i;
+            j < numEdges && sortedEdges[j].IsSameEdge( sortedEdges[i] ); j ++ )
+      {
+        firstEdges[ sortedEdges[j].index ] = sortedEdges[i].index;
+      }
+    }
+  } );
+  std::vector< TableBasedClipperEdgeEntry >().swap( sortedEdges );
+
+  std::vector< vtkIdType > edgeMap( numEdges );
+  vtkSMPTools::For( 0, numEdges, [&]( vtkIdType i, vtkIdType endI )
+  {
+    for ( ; i < endI; i ++ )
+    {
+      edgeMap[i] = ( firstEdges[i] == i ? 1 : 0 );
+    }
+  } );
+  vtkIdType numUniqueEdges = vtkSMPTools::ExclusiveScan( edgeMap.begin(),
+    edgeMap.end(), edgeMap.begin(), static_cast< vtkIdType >( 0 ) );
+  std::vector< vtkIdType > uniqueEdges( numUniqueEdges );
+  vtkSMPTools::For( 0, numEdges, [&]( vtkIdType i, vtkIdType endI )
+  {
+    for ( ; i < endI; i ++ )
+    {
+      if ( firstEdges[i] == i )
+      {
+        uniqueEdges[ edgeMap[i] ] = i;
+      }
+      else
+      {
+        edgeMap[i] = edgeMap[ firstEdges[i] ];
+      }
+    }
+  } );
+  std::vector< vtkIdType >().swap( firstEdges );
+
+  //
+  // Number the points of the input used by the shapes in order of first use,
+  // as with a single piece: the first use of a point is the smallest
+  // shape * 8 + i for which it is the i-th point of the shape.
+  //
+  std::vector< std::atomic< vtkTypeInt64 > > firstUses( numPrevPts );
+  vtkSMPTools::For( 0, numPrevPts, [&]( vtkIdType i, vtkIdType endI )
+  {
+    for ( ; i < endI; i ++ )
+    {
+      firstUses[i].store( VTK_TYPE_INT64_MAX, std::memory_order_relaxed );
+    }
+  } );
+  vtkSMPTools::For( 0, nshapes * numPieces, 1, [&]( vtkIdType s, vtkIdType endS )
+  {
+    for ( ; s < endS; s ++ )
+    {
+      const vtkTableBasedClipperShapeList * shapes =
+        pieces[ s % numPieces ]->shapes[ s / numPieces ];
+      int npts_per_shape = shapes->GetShapeSize();
+      int nlists = shapes->GetNumberOfLists();
+      vtkTypeInt64 use = static_cast< vtkTypeInt64 >( shapeOffsets[s] ) * 8;
+      for ( int j = 0; j < nlists; j ++ )
+      {
+        const int * list;
+        int listSize = shapes->GetList( j, list );
+        for ( int k = 0; k < listSize; k ++, use += 8 )
+        {
+          list ++; // skip the cell id entry
+          for ( int l = 0; l < npts_per_shape; l ++ )
+          {
+            int pt = *list;
+            list ++;
+            if ( pt >= 0 && pt < numPrevPts )
+            {
+              std::atomic< vtkTypeInt64 > & firstUse = firstUses[ pt ];
+              vtkTypeInt64 current = firstUse.load( std::memory_order_relaxed );
+              while ( use + l < current &&
+                      !firstUse.compare_exchange_weak
+                        ( current, use + l, std::memory_order_relaxed ) )
+              {
+              }
+            }
+          }
+        }
+      }
+    }
+  } );
+
+  std::vector< vtkIdType > ptLookup( numPrevPts );
+  vtkSMPTools::Transform( firstUses.begin(), firstUses.end(), ptLookup.begin(),
+    []( const std::atomic< vtkTypeInt64 > & firstUse ) -> vtkIdType
+    { return firstUse.load( std::memory_order_relaxed ) != VTK_TYPE_INT64_MAX; } );
+  vtkIdType numUsed = vtkSMPTools::ExclusiveScan( ptLookup.begin(),
+    ptLookup.end(), ptLookup.begin(), static_cast< vtkIdType >( 0 ) );
+  std::vector< std::pair< vtkTypeInt64, vtkIdType > > uses( numUsed );
+  vtkSMPTools::For( 0, numPrevPts, [&]( vtkIdType i, vtkIdType endI )
+  {
+    for ( ; i < endI; i ++ )
+    {
+      vtkTypeInt64 firstUse = firstUses[i].load( std::memory_order_relaxed );
+      if ( firstUse != VTK_TYPE_INT64_MAX )
+      {
+        uses[ ptLookup[i] ] = std::make_pair( firstUse, i );
+      }
+      else
+      {
+        ptLookup[i] = -1;
+      }
+    }
+  } );
+  std::vector< std::atomic< vtkTypeInt64 > >().swap( firstUses );
+  vtkSMPTools::Sort( uses.begin(), uses.end() );
+
+  //
+  // Set up the output points and its point data. For the arrays that cannot
+  // be interpolated by ArrayList, the edge and centroid points take the value
+  // of one of their points.
+  //
+  vtkIdType centroidStart = numUsed + numUniqueEdges;
+  vtkIdType nOutPts       = centroidStart + centroidOffsets[ numPieces ];
+  std::vector< vtkIdType > pointSources( nOutPts );
+
+  auto outputId = [&]( vtkIdType p, int pt ) -> vtkIdType
+  {
+    if ( pt < 0 )
+    {
+      return centroidStart + centroidOffsets[p] - 1 - pt;
+    }
+    if ( pt >= numPrevPts )
+    {
+      return numUsed + edgeMap[ edgeOffsets[p] + pt - numPrevPts ];
+    }
+    return ptLookup[ pt ];
+  };
+
+  vtkPoints * outPts = pieces[0]->NewOutputPoints( input );
+  outPts->SetNumberOfPoints( nOutPts );
+  outPD->CopyAllocate( inPD, nOutPts );
+
+  vtkIntArray * newOrigNodes = nullptr;
+  vtkIntArray * origNodes = vtkArrayDownCast<vtkIntArray>
+                (  inPD->GetArray( "avtOriginalNodeNumbers" )  );
+  int numOrigComps = 0;
+  ArrayList pointArrays;
+  ArrayList centroidArrays;
+  if ( origNodes != nullptr )
+  {
+    numOrigComps = origNodes->GetNumberOfComponents();
+    newOrigNodes = vtkIntArray::New();
+    newOrigNodes->SetNumberOfComponents( numOrigComps );
+    newOrigNodes->SetNumberOfTuples( nOutPts );
+    newOrigNodes->SetName( origNodes->GetName() );
+    pointArrays.ExcludeArray( origNodes );
+    centroidArrays.ExcludeArray( outPD->GetArray( origNodes->GetName() ) );
+  }
+  pointArrays.AddArrays( nOutPts, inPD, outPD, 0.0, false );
+  centroidArrays.AddSelfInterpolatingArrays( nOutPts, outPD );
+
+  //
+  // Copy over all the points from the input that are actually used in the
+  // output.
+  //
+  vtkSMPTools::For( 0, numUsed, [&]( vtkIdType ptIdx, vtkIdType endPtIdx )
+  {
+    for ( ; ptIdx < endPtIdx; ptIdx ++ )
+    {
+      vtkIdType i = uses[ ptIdx ].second;
+      ptLookup[i] = ptIdx;
+      pointSources[ ptIdx ] = i;
+      outPts->SetPoint( ptIdx, pts_ptr + 3 * i );
+      pointArrays.Copy( i, ptIdx );
+      for ( int z = 0; z < numOrigComps; z ++ )
+      {
+        newOrigNodes->SetTypedComponent
+          ( ptIdx, z, origNodes->GetTypedComponent( i, z ) );
+      }
+    }
+  } );
+  std::vector< std::pair< vtkTypeInt64, vtkIdType > >().swap( uses );
+
+  //
+  // Now construct all the points that are along edges.
+  //
+  vtkSMPTools::For( 0, numUniqueEdges, [&]( vtkIdType e, vtkIdType endE )
+  {
+    for ( ; e < endE; e ++ )
+    {
+      const TableBasedClipperPointEntry & pe = *edges[ uniqueEdges[e] ];
+      const double * pt1 = pts_ptr + 3 * pe.ptIds[0];
+      const double * pt2 = pts_ptr + 3 * pe.ptIds[1];
+      double pt[3];
+      double p  = pe.percent;
+      double bp = 1.0 - p;
+      pt[0] = pt1[0] * p + pt2[0] * bp;
+      pt[1] = pt1[1] * p + pt2[1] * bp;
+      pt[2] = pt1[2] * p + pt2[2] * bp;
+
+      vtkIdType ptIdx = numUsed + e;
+      int id = ( bp <= 0.5 ? pe.ptIds[0] : pe.ptIds[1] );
+      pointSources[ ptIdx ] = id;
+      outPts->SetPoint( ptIdx, pt );
+      pointArrays.InterpolateEdge( pe.ptIds[0], pe.ptIds[1], bp, ptIdx );
+      for ( int z = 0; z < numOrigComps; z ++ )
+      {
+        newOrigNodes->SetTypedComponent
+          ( ptIdx, z, origNodes->GetTypedComponent( id, z ) );
+      }
+    }
+  } );
+
+  //
+  // Now construct the new "centroid" points. They may depend on the previous
+  // centroid points of their piece.
+  //
+  vtkSMPTools::For( 0, numPieces, 1, [&]( vtkIdType p, vtkIdType endP )
+  {
+    for ( ; p < endP; p ++ )
+    {
+      const vtkTableBasedClipperCentroidPointList & centroid_list =
+        pieces[p]->centroid_list;
+      vtkIdType ptIdx = centroidStart + centroidOffsets[p];
+      int nLists = centroid_list.GetNumberOfLists();
+      for ( int i = 0; i < nLists; i ++ )
+      {
+        const TableBasedClipperCentroidPointEntry * ce_list = nullptr;
+        int nPts = centroid_list.GetList( i, ce_list );
+        for ( int j = 0; j < nPts; j ++, ptIdx ++ )
+        {
+          const TableBasedClipperCentroidPointEntry & ce = ce_list[j];
+          vtkIdType ids[8];
+          double weights[8];
+          double pt[3] = { 0.0, 0.0, 0.0 };
+          double weight_factor = 1.0 / ce.nPts;
+          for ( int k = 0; k < ce.nPts; k ++ )
+          {
+            double ptk[3];
+            weights[k] = 1.0 * weight_factor;
+            ids[k] = outputId( p, ce.ptIds[k] );
+            outPts->GetPoint( ids[k], ptk );
+            pt[0] += ptk[0];
+            pt[1] += ptk[1];
+            pt[2] += ptk[2];
+          }
+          pt[0] *= weight_factor;
+          pt[1] *= weight_factor;
+          pt[2] *= weight_factor;
+
+          pointSources[ ptIdx ] = pointSources[ ids[0] ];
+          outPts->SetPoint( ptIdx, pt );
+          centroidArrays.Interpolate( ce.nPts, ids, weights, ptIdx );
+          // these 'created' nodes have no original designation
+          for ( int z = 0; z < numOrigComps; z ++ )
+          {
+            newOrigNodes->SetTypedComponent( ptIdx, z, -1 );
+          }
+        }
+      }
+    }
+  } );
+  pointArrays.CopyOtherArrays( nOutPts, pointSources.data(), inPD, outPD );
+
+  output->SetPoints( outPts );
+  outPts->Delete();
+
+  if ( newOrigNodes )
+  {
+    // AddArray will overwrite an already existing array with
+    // the same name, exactly what we want here.
+    outPD->AddArray( newOrigNodes );
+    newOrigNodes->Delete();
+  }
+
+  //
+  // Now set up the shapes and the cell data.
+  //
+  outCD->CopyAllocate( inCD, ncells );
+  ArrayList cellArrays;
+  cellArrays.AddArrays( ncells, inCD, outCD, 0.0, false );
+  std::vector< vtkIdType > cellSources( ncells );
+
+  vtkIdTypeArray * nlist = vtkIdTypeArray::New();
+  nlist->SetNumberOfValues( conn_size );
+
+  vtkUnsignedCharArray * cellTypes = vtkUnsignedCharArray::New();
+  cellTypes->SetNumberOfValues( ncells );
+
+  vtkIdTypeArray * cellLocations = vtkIdTypeArray::New();
+  cellLocations->SetNumberOfValues( ncells );
+
+  vtkSMPTools::For( 0, nshapes * numPieces, 1, [&]( vtkIdType s, vtkIdType endS )
+  {
+    for ( ; s < endS; s ++ )
+    {
+      vtkIdType p = s % numPieces;
+      const vtkTableBasedClipperShapeList * shapes =
+        pieces[p]->shapes[ s / numPieces ];
+      int shapesize = shapes->GetShapeSize();
+      int vtk_type = shapes->GetVTKType();
+      int nlists = shapes->GetNumberOfLists();
+      vtkIdType cellId = shapeOffsets[s];
+      vtkIdType current_index = connOffsets[s];
+      vtkIdType * nl = nlist->GetPointer( current_index );
+      for ( int j = 0; j < nlists; j ++ )
+      {
+        const int * list;
+        int listSize = shapes->GetList( j, list );
+        for ( int k = 0; k < listSize; k ++ )
+        {
+          cellArrays.Copy( list[0], cellId );
+          cellSources[ cellId ] = list[0];
+          *nl ++ = shapesize;
+          for ( int l = 0; l < shapesize; l ++ )
+          {
+            *nl ++ = outputId( p, list[ l + 1 ] );
+          }
+          list += shapesize + 1;
+          cellLocations->SetValue( cellId, current_index );
+          cellTypes->SetValue( cellId, static_cast< unsigned char >( vtk_type ) );
+
+          current_index += shapesize + 1;
+          cellId ++;
+        }
+      }
+    }
+  } );
+  cellArrays.CopyOtherArrays( ncells, cellSources.data(), inCD, outCD );
+
+  vtkCellArray * cells = vtkCellArray::New();
+  cells->SetCells( ncells, nlist );
+  nlist->Delete();
+
+  output->SetCells( cellTypes, cellLocations, cells );
+  cellTypes->Delete();
+  cellLocations->Delete();
+  cells->Delete();
+}
+
 inline void GetPoint( double * pt, const double * X, const double * Y,
                       const double * Z, const int * dims, const int & index )
 {
@@ -3011,33 +3481,27 @@ void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd,
 }
 
 //-----------------------------------------------------------------------------
-void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
-     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
-{
-  vtkUnstructuredGrid * unstruct = vtkUnstructuredGrid::SafeDownCast( inputGrd );
-
-  vtkIdType   i, j;
+// Clip the cells [begin, end) of an unstructured grid with the case tables.
+// The ids of the cells which cannot be clipped this way are appended to
+// specials.
+static void ClipUnstructuredGridCells( vtkTableBasedClipDataSet * self,
+     vtkUnstructuredGrid * unstruct, vtkDataArray * clipAray, double isoValue,
+     int insideOut, vtkIdType begin, vtkIdType end,
+     vtkTableBasedClipperVolumeFromVolume * visItVFV,
+     std::vector< vtkIdType > & specials )
+{
+  vtkIdType   j;
   vtkIdType   numbPnts = 0;
-  int         numCants = 0; // number of cells not clipped by this filter
-  int         numCells = unstruct->GetNumberOfCells();
 
-  // volume from volume
-  vtkTableBasedClipperVolumeFromVolume   * visItVFV = new
-  vtkTableBasedClipperVolumeFromVolume(
-      this->OutputPointsPrecision, unstruct->GetNumberOfPoints(),
-      int(   pow(  double( numCells ), double( 0.6667f )  )   ) * 5 + 100    );
+  // receives the point ids of the cells when they are not stored as
+  // vtkIdType, since the input cells are read by several threads
+  vtkNew< vtkIdList > cellPnts;
 
-  // the stuffs that can not be clipped by this filter
-  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
-  specials->SetPoints( unstruct->GetPoints() );
-  specials->GetPointData()->ShallowCopy( unstruct->GetPointData() );
-  specials->Allocate( numCells );
-
-  for ( i = 0; i < numCells; i ++ )
+  for ( vtkIdType i = begin; i < end; i ++ )
   {
     int         cellType = unstruct->GetCellType( i );
-    vtkIdType * pntIndxs = nullptr;
-    unstruct->GetCellPoints( i, numbPnts, pntIndxs );
+    const vtkIdType * pntIndxs = nullptr;
+    unstruct->GetCellPoints( i, numbPnts, pntIndxs, cellPnts );
 
     bool     bCanClip = false;
     switch ( cellType )
@@ -3219,12 +3683,12 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
             break;
 
           default:
-            vtkErrorMacro( << "An invalid output shape was found "
+            vtkErrorWithObjectMacro( self, << "An invalid output shape was found "
                            << "in the ClipCases." << endl );
         }
 
-        if ( (!this->InsideOut && theColor == COLOR0 ) ||
-             ( this->InsideOut && theColor == COLOR1 )
+        if ( (!insideOut && theColor == COLOR0 ) ||
+             ( insideOut && theColor == COLOR1 )
            )
         {
           // We don't want this one; it's the wrong side.
@@ -3271,7 +3735,7 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
           }
           else
           {
-            vtkErrorMacro( << "An invalid output point value was found "
+            vtkErrorWithObjectMacro( self, << "An invalid output point value was found "
                            << "in the ClipCases." << endl );
           }
         }
@@ -3326,34 +3790,84 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
       edgeVtxs = nullptr;
       thisCase = nullptr;
     }
-    else if (cellType == VTK_POLYHEDRON)
+    else
     {
-      if ( numCants == 0 )
-      {
-          specials->GetCellData()
-                  ->CopyAllocate( unstruct->GetCellData(), numCells );
-      }
-      vtkIdType nfaces, *facePtIds;
-      unstruct->GetFaceStream(i, nfaces, facePtIds);
-      specials->InsertNextCell(cellType, nfaces, facePtIds);
-      specials->GetCellData()
-              ->CopyData( unstruct->GetCellData(), i, numCants );
-      numCants ++;
+      specials.push_back( i );
     }
-    else
+
+    pntIndxs = nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{
+  vtkUnstructuredGrid * unstruct = vtkUnstructuredGrid::SafeDownCast( inputGrd );
+
+  vtkIdType   i;
+  vtkIdType   numbPnts = 0;
+  int         numCants = 0; // number of cells not clipped by this filter
+  vtkIdType   numCells = unstruct->GetNumberOfCells();
+
+  // The cells are clipped in parallel, by pieces of consecutive cells. Each
+  // piece has its own volume from volume, and the pieces are merged as if a
+  // single one had clipped all the cells: the output does not depend on the
+  // number of pieces.
+  vtkIdType numPieces = std::max< vtkIdType >( 1, std::min< vtkIdType >(
+    2 * vtkSMPTools::GetEstimatedNumberOfThreads(), numCells / 1000 ) );
+  std::vector< vtkTableBasedClipperVolumeFromVolume * > pieces( numPieces );
+  std::vector< std::vector< vtkIdType > > specialIds( numPieces );
+  vtkSMPTools::For( 0, numPieces, 1, [&]( vtkIdType p, vtkIdType endP )
+  {
+    for ( ; p < endP; p ++ )
     {
+      vtkIdType begin = p * numCells / numPieces;
+      vtkIdType end   = ( p + 1 ) * numCells / numPieces;
+
+      // volume from volume
+      pieces[p] = new vtkTableBasedClipperVolumeFromVolume(
+        this->OutputPointsPrecision, unstruct->GetNumberOfPoints(),
+        int(   pow(  double( end - begin ), double( 0.6667f )  )   ) * 5 + 100 );
+      ClipUnstructuredGridCells( this, unstruct, clipAray, isoValue,
+                                 this->InsideOut, begin, end, pieces[p],
+                                 specialIds[p] );
+    }
+  } );
+
+  // the stuffs that can not be clipped by this filter
+  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
+  specials->SetPoints( unstruct->GetPoints() );
+  specials->GetPointData()->ShallowCopy( unstruct->GetPointData() );
+  specials->Allocate( numCells );
+
+  for ( vtkIdType p = 0; p < numPieces; p ++ )
+  {
+    for ( size_t c = 0; c < specialIds[p].size(); c ++ )
+    {
+      i = specialIds[p][c];
+      int  cellType = unstruct->GetCellType( i );
       if ( numCants == 0 )
       {
           specials->GetCellData()
                   ->CopyAllocate( unstruct->GetCellData(), numCells );
       }
-      specials->InsertNextCell( cellType, numbPnts, pntIndxs );
+      if (cellType == VTK_POLYHEDRON)
+      {
+        vtkIdType nfaces, *facePtIds;
+        unstruct->GetFaceStream(i, nfaces, facePtIds);
+        specials->InsertNextCell(cellType, nfaces, facePtIds);
+      }
+      else
+      {
+        vtkIdType * pntIndxs = nullptr;
+        unstruct->GetCellPoints( i, numbPnts, pntIndxs );
+        specials->InsertNextCell( cellType, numbPnts, pntIndxs );
+      }
       specials->GetCellData()
               ->CopyData( unstruct->GetCellData(), i, numCants );
       numCants ++;
     }
-
-    pntIndxs = nullptr;
   }
 
   int         toDelete = 0;
@@ -3368,10 +3882,13 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
     toDelete = 1;
     numbPnts = inputPts->GetNumberOfPoints();
     theCords = new double [ numbPnts * 3 ];
-    for ( i = 0; i < numbPnts; i ++ )
+    vtkSMPTools::For( 0, numbPnts, [&]( vtkIdType ptId, vtkIdType endPtId )
     {
-      inputPts->GetPoint( i, theCords + ( i << 1 ) + i );
-    }
+      for ( ; ptId < endPtId; ptId ++ )
+      {
+        inputPts->GetPoint( ptId, theCords + 3 * ptId );
+      }
+    } );
   }
   inputPts = nullptr;
 
@@ -3383,7 +3900,8 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
     this->ClipDataSet( specials, clipAray, vtkUGrid );
 
     vtkUnstructuredGrid * visItGrd = vtkUnstructuredGrid::New();
-    visItVFV->ConstructDataSet( unstruct, visItGrd, theCords );
+    vtkTableBasedClipperVolumeFromVolume::ConstructMergedDataSet
+      ( pieces, unstruct, visItGrd, theCords );
 
     vtkAppendFilter * appender = vtkAppendFilter::New();
     appender->AddInputData( vtkUGrid );
@@ -3401,17 +3919,20 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
   }
   else
   {
-    visItVFV->ConstructDataSet( unstruct, outputUG, theCords );
+    vtkTableBasedClipperVolumeFromVolume::ConstructMergedDataSet
+      ( pieces, unstruct, outputUG, theCords );
   }
 
   specials->Delete();
-  delete visItVFV;
+  for ( vtkIdType p = 0; p < numPieces; p ++ )
+  {
+    delete pieces[p];
+  }
   if ( toDelete )
   {
     delete [] theCords;
   }
   specials = nullptr;
-  visItVFV = nullptr;
   theCords = nullptr;
   unstruct = nullptr;
 }
@@ -70,6 +70,11 @@
  *  advantages are gained by adopting the unique clipping and triangulation tables
  *  proposed by VisIt.
  *
+ *  The clipping of unstructured grids is multithreaded with vtkSMPTools:
+ *  pieces of consecutive cells are clipped in parallel, then their points and
+ *  cells are merged in parallel. The output is the same whatever the number of
+ *  threads.
+ *
  * @warning
  *  vtkTableBasedClipDataSet makes use of a hash table (that is provided by class
  *  maintained by internal class vtkTableBasedClipperDataSetFromVolume) to achieve
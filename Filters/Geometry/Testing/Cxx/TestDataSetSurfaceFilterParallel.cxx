@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataSetSurfaceFilterParallel.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the multithreaded extraction of the surface of unstructured
+// grids gives the same polydata as the serial one, with the sequential and
+// the parallel SMP backends.
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// A grid of res^3 cells of the types handled by the multithreaded
+// extraction. With a quadratic tetrahedron added after the other cells, on
+// new points, the grid is handled by the serial extraction instead: its
+// faces and points then come after the ones of the other cells.
+vtkSmartPointer<vtkUnstructuredGrid> CreateGrid(int res, bool serial)
+{
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random =
+    vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+
+  int n = res + 1;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetName("Scalars");
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        points->InsertNextPoint(i, j + 0.1 * i, k);
+        random->Next();
+        scalars->InsertNextValue(random->GetValue());
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->GetPointData()->SetScalars(scalars);
+  grid->Allocate(res * res * res);
+  for (int k = 0; k < res; ++k)
+  {
+    for (int j = 0; j < res; ++j)
+    {
+      for (int i = 0; i < res; ++i)
+      {
+        vtkIdType p0 = i + n * (j + n * k);
+        vtkIdType h[8] = { p0, p0 + 1, p0 + n + 1, p0 + n,
+                           p0 + n * n, p0 + n * n + 1, p0 + n * n + n + 1,
+                           p0 + n * n + n };
+        vtkIdType tet[4] = { h[0], h[1], h[3], h[4] };
+        vtkIdType wedge[6] = { h[0], h[1], h[3], h[4], h[5], h[7] };
+        vtkIdType voxel[8] = { h[0], h[1], h[3], h[2],
+                               h[4], h[5], h[7], h[6] };
+        random->Next();
+        switch (static_cast<int>(random->GetValue() * 10))
+        {
+          case 0: case 1: grid->InsertNextCell(VTK_HEXAHEDRON, 8, h); break;
+          case 2: grid->InsertNextCell(VTK_TETRA, 4, tet); break;
+          case 3: grid->InsertNextCell(VTK_WEDGE, 6, wedge); break;
+          case 4: grid->InsertNextCell(VTK_PYRAMID, 5, h); break;
+          case 5: grid->InsertNextCell(VTK_VOXEL, 8, voxel); break;
+          case 6: grid->InsertNextCell(VTK_QUAD, 4, h); break;
+          case 7: grid->InsertNextCell(VTK_TRIANGLE, 3, h); break;
+          case 8: grid->InsertNextCell(VTK_LINE, 2, h); break;
+          default: grid->InsertNextCell(VTK_VERTEX, 1, h); break;
+        }
+      }
+    }
+  }
+
+  if (serial)
+  {
+    vtkIdType quadraticTet[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      quadraticTet[i] = points->InsertNextPoint(
+        n + (i & 1), n + ((i >> 1) & 1), n + ((i >> 2) & 1));
+      scalars->InsertNextValue(0.0);
+    }
+    grid->InsertNextCell(VTK_QUADRATIC_TETRA, 10, quadraticTet);
+  }
+
+  vtkSmartPointer<vtkFloatArray> cellScalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  cellScalars->SetName("CellScalars");
+  for (vtkIdType cellId = 0; cellId < grid->GetNumberOfCells(); ++cellId)
+  {
+    cellScalars->InsertNextValue(cellId);
+  }
+  grid->GetCellData()->AddArray(cellScalars);
+  return grid;
+}
+
+// Whether the first values of b are the ones of a.
+template <class ArrayT>
+bool SameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+  ArrayT *ta = vtkArrayDownCast<ArrayT>(a);
+  ArrayT *tb = vtkArrayDownCast<ArrayT>(b);
+  return ta && tb && ta->GetNumberOfValues() <= tb->GetNumberOfValues() &&
+    memcmp(ta->GetPointer(0), tb->GetPointer(0),
+           ta->GetNumberOfValues() * sizeof(typename ArrayT::ValueType)) == 0;
+}
+
+bool SameCells(vtkCellArray *a, vtkCellArray *b)
+{
+  vtkIdType size = a->GetNumberOfConnectivityEntries();
+  return size <= b->GetNumberOfConnectivityEntries() &&
+    memcmp(a->GetPointer(), b->GetPointer(), size * sizeof(vtkIdType)) == 0;
+}
+
+// Whether b starts with the points and cells of a.
+bool SamePolyData(vtkPolyData *a, vtkPolyData *b)
+{
+  return SameArrays<vtkFloatArray>(a->GetPoints()->GetData(),
+                                   b->GetPoints()->GetData()) &&
+    SameArrays<vtkFloatArray>(a->GetPointData()->GetArray("Scalars"),
+                              b->GetPointData()->GetArray("Scalars")) &&
+    SameArrays<vtkIdTypeArray>(a->GetPointData()->GetArray("vtkOriginalPointIds"),
+                               b->GetPointData()->GetArray("vtkOriginalPointIds")) &&
+    SameArrays<vtkFloatArray>(a->GetCellData()->GetArray("CellScalars"),
+                              b->GetCellData()->GetArray("CellScalars")) &&
+    SameArrays<vtkIdTypeArray>(a->GetCellData()->GetArray("vtkOriginalCellIds"),
+                               b->GetCellData()->GetArray("vtkOriginalCellIds")) &&
+    SameCells(a->GetVerts(), b->GetVerts()) &&
+    SameCells(a->GetLines(), b->GetLines()) &&
+    SameCells(a->GetPolys(), b->GetPolys());
+}
+
+vtkSmartPointer<vtkPolyData> ExtractSurface(vtkUnstructuredGrid *grid,
+                                            bool parallel)
+{
+  vtkSmartPointer<vtkDataSetSurfaceFilter> surface =
+    vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
+  surface->SetInputData(grid);
+  surface->PassThroughCellIdsOn();
+  surface->PassThroughPointIdsOn();
+  surface->SetNonlinearSubdivisionLevel(0);
+
+  vtkSMPTools::Config config;
+  if (!parallel)
+  {
+    config.Backend = "Sequential";
+  }
+  vtkSMPTools::LocalScope(config, [&]() { surface->Update(); });
+  return surface->GetOutput();
+}
+}
+
+int TestDataSetSurfaceFilterParallel(int, char *[])
+{
+  // The multithreaded extraction is only used with several threads.
+  vtkSMPTools::Initialize(4);
+  int status = EXIT_SUCCESS;
+
+  vtkSmartPointer<vtkPolyData> serial =
+    ExtractSurface(CreateGrid(20, true), true);
+  vtkSmartPointer<vtkUnstructuredGrid> grid = CreateGrid(20, false);
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    vtkSmartPointer<vtkPolyData> output = ExtractSurface(grid, parallel != 0);
+    // The serial output has the 4 more faces of the quadratic tetrahedron.
+    if (output->GetNumberOfPolys() == 0 ||
+        output->GetNumberOfPolys() + 4 != serial->GetNumberOfPolys() ||
+        output->GetNumberOfVerts() != serial->GetNumberOfVerts() ||
+        output->GetNumberOfLines() != serial->GetNumberOfLines() ||
+        !SamePolyData(output, serial))
+    {
+      cerr << "Serial and multithreaded surfaces differ with the "
+           << (parallel ? "parallel" : "sequential") << " backend" << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+
+  return status;
+}
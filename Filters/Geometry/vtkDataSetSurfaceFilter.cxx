@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkDataSetSurfaceFilter.h"
 
+#include "vtkArrayListTemplate.h"
 #include "vtkCell.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
@@ -21,6 +22,7 @@
 #include "vtkDoubleArray.h"
 #include "vtkGenericCell.h"
 #include "vtkHexahedron.h"
+#include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
@@ -32,6 +34,7 @@
 #include "vtkPyramid.h"
 #include "vtkRectilinearGrid.h"
 #include "vtkRectilinearGridGeometryFilter.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGridGeometryFilter.h"
@@ -49,8 +52,12 @@
 #include "vtkStructuredData.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 static inline int sizeofFastQuad(int numPts)
 {
@@ -1467,6 +1474,452 @@ void vtkDataSetSurfaceFilter::PrintSelf(ostream& os, vtkIndent indent)
      << this->GetNonlinearSubdivisionLevel() << endl;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// How UnstructuredGridExecuteInParallel() handles a cell: it is output as a
+// vertex, a line or a polygon, gives faces to the external surface, is
+// ignored, or is left to the serial execution.
+enum SurfaceCellCategory
+{
+  SURFACE_VERTS = 0,
+  SURFACE_LINES,
+  SURFACE_POLYS,
+  SURFACE_FACES,
+  SURFACE_SKIPPED,
+  SURFACE_UNSUPPORTED
+};
+
+unsigned char GetSurfaceCellCategory(unsigned char cellType,
+                                     bool linearizeQuadratic)
+{
+  switch (cellType)
+  {
+    case VTK_EMPTY_CELL:
+      return SURFACE_SKIPPED;
+
+    case VTK_VERTEX:
+    case VTK_POLY_VERTEX:
+      return SURFACE_VERTS;
+
+    case VTK_LINE:
+    case VTK_POLY_LINE:
+      return SURFACE_LINES;
+
+    case VTK_PIXEL:
+    case VTK_QUAD:
+    case VTK_TRIANGLE:
+    case VTK_POLYGON:
+    case VTK_TRIANGLE_STRIP:
+      return SURFACE_POLYS;
+
+    // Without subdivision, quadratic faces are output as their linear
+    // counterparts.
+    case VTK_QUADRATIC_TRIANGLE:
+    case VTK_LAGRANGE_TRIANGLE:
+    case VTK_QUADRATIC_QUAD:
+    case VTK_BIQUADRATIC_QUAD:
+    case VTK_QUADRATIC_LINEAR_QUAD:
+    case VTK_LAGRANGE_QUADRILATERAL:
+      return linearizeQuadratic ? SURFACE_POLYS : SURFACE_UNSUPPORTED;
+
+    case VTK_TETRA:
+    case VTK_HEXAHEDRON:
+    case VTK_VOXEL:
+    case VTK_WEDGE:
+    case VTK_PYRAMID:
+    case VTK_PENTAGONAL_PRISM:
+    case VTK_HEXAGONAL_PRISM:
+    case VTK_POLYHEDRON:
+      return SURFACE_FACES;
+
+    default:
+      return SURFACE_UNSUPPORTED;
+  }
+}
+
+// The number of points of a vertex, line or 2D cell that are mapped to output
+// points: strips of less than two points are ignored, and quadratic faces
+// only keep their corners.
+vtkIdType GetNumberOfSurfacePoints(unsigned char cellType, vtkIdType npts)
+{
+  switch (cellType)
+  {
+    case VTK_TRIANGLE_STRIP:
+      return npts > 1 ? npts : 0;
+    case VTK_QUADRATIC_TRIANGLE:
+    case VTK_LAGRANGE_TRIANGLE:
+      return 3;
+    case VTK_QUADRATIC_QUAD:
+    case VTK_BIQUADRATIC_QUAD:
+    case VTK_QUADRATIC_LINEAR_QUAD:
+    case VTK_LAGRANGE_QUADRILATERAL:
+      return 4;
+    default:
+      return npts;
+  }
+}
+
+// The i-th mapped point of a vertex, line or 2D cell; pixels become quads.
+inline vtkIdType GetSurfacePoint(unsigned char cellType, const vtkIdType *pts,
+                                 vtkIdType i)
+{
+  return (cellType == VTK_PIXEL && i >= 2) ? pts[5 - i] : pts[i];
+}
+
+// Calls f(numFacePts, facePts) for each face of a 3D cell, with the points in
+// the order the serial execution inserts them in the face hash.
+template <typename Functor>
+void ForEachFace(vtkUnstructuredGrid *input, vtkIdType cellId,
+                 unsigned char cellType, const vtkIdType *pts, Functor &f)
+{
+  static const int hexFaces[6][4] = { {0,1,5,4}, {0,3,2,1}, {0,4,7,3},
+                                      {1,2,6,5}, {2,3,7,6}, {4,5,6,7} };
+  static const int voxelFaces[6][4] = { {0,1,5,4}, {0,2,3,1}, {0,4,6,2},
+                                        {1,3,7,5}, {2,6,7,3}, {4,5,7,6} };
+  static const int tetraFaces[4][3] = { {0,1,3}, {0,2,1}, {0,3,2}, {1,2,3} };
+  vtkIdType face[4];
+
+  switch (cellType)
+  {
+    case VTK_HEXAHEDRON:
+    case VTK_VOXEL:
+    {
+      const int (*faces)[4] = (cellType == VTK_HEXAHEDRON ? hexFaces : voxelFaces);
+      for (int j = 0; j < 6; ++j)
+      {
+        for (int i = 0; i < 4; ++i)
+        {
+          face[i] = pts[faces[j][i]];
+        }
+        f(4, face);
+      }
+      break;
+    }
+
+    case VTK_TETRA:
+      for (int j = 0; j < 4; ++j)
+      {
+        for (int i = 0; i < 3; ++i)
+        {
+          face[i] = pts[tetraFaces[j][i]];
+        }
+        f(3, face);
+      }
+      break;
+
+    case VTK_WEDGE:
+    case VTK_PYRAMID:
+      for (int j = 0; j < 5; ++j)
+      {
+        const int *verts = (cellType == VTK_WEDGE ? vtkWedge::GetFaceArray(j)
+                                                  : vtkPyramid::GetFaceArray(j));
+        int numFacePts = 0;
+        for (; numFacePts < 4 && verts[numFacePts] >= 0; ++numFacePts)
+        {
+          face[numFacePts] = pts[verts[numFacePts]];
+        }
+        f(numFacePts, face);
+      }
+      break;
+
+    case VTK_PENTAGONAL_PRISM:
+    case VTK_HEXAGONAL_PRISM:
+    {
+      int n = (cellType == VTK_PENTAGONAL_PRISM ? 5 : 6);
+      for (int j = 0; j < n; ++j)
+      {
+        int k = (j + 1) % n;
+        face[0] = pts[j];
+        face[1] = pts[k];
+        face[2] = pts[k + n];
+        face[3] = pts[j + n];
+        f(4, face);
+      }
+      f(n, pts);
+      f(n, pts + n);
+      break;
+    }
+
+    case VTK_POLYHEDRON:
+    {
+      vtkIdType numFaces = 0;
+      vtkIdType *faceStream = nullptr;
+      input->GetFaceStream(cellId, numFaces, faceStream);
+      for (vtkIdType j = 0; j < numFaces; ++j)
+      {
+        f(static_cast<int>(faceStream[0]), faceStream + 1);
+        faceStream += faceStream[0] + 1;
+      }
+      break;
+    }
+  }
+}
+
+// Rotates a face the way the face hash stores it, its smallest point first:
+// triangles and quads are only rotated when one point is smaller than all
+// the others, polygons start at the first occurrence of their smallest point.
+void RotateFace(vtkIdType *face, int numPts)
+{
+  vtkIdType a, b, c, d;
+  switch (numPts)
+  {
+    case 3:
+      a = face[0];
+      b = face[1];
+      c = face[2];
+      if (b < a && b < c)
+      {
+        face[0] = b; face[1] = c; face[2] = a;
+      }
+      else if (c < a && c < b)
+      {
+        face[0] = c; face[1] = a; face[2] = b;
+      }
+      break;
+
+    case 4:
+      a = face[0];
+      b = face[1];
+      c = face[2];
+      d = face[3];
+      if (b < a && b < c && b < d)
+      {
+        face[0] = b; face[1] = c; face[2] = d; face[3] = a;
+      }
+      else if (c < a && c < b && c < d)
+      {
+        face[0] = c; face[1] = d; face[2] = a; face[3] = b;
+      }
+      else if (d < a && d < b && d < c)
+      {
+        face[0] = d; face[1] = a; face[2] = b; face[3] = c;
+      }
+      break;
+
+    default:
+    {
+      int first = 0;
+      for (int i = 1; i < numPts; ++i)
+      {
+        if (face[i] < face[first])
+        {
+          first = i;
+        }
+      }
+      std::rotate(face, face + first, face + numPts);
+      break;
+    }
+  }
+}
+
+// The key of a face stored by RotateFace(). Two faces match in the face hash
+// when they have the same key: the same first point and number of points,
+// and the same other points up to orientation.
+class SurfaceFaceKey
+{
+public:
+  SurfaceFaceKey(const vtkIdType *pts, int numPts)
+    : Pts(pts), NumPts(numPts), Reversed(false)
+  {
+    if (numPts > 4)
+    {
+      // Compare the polygon with its reverse, the smallest one is the key.
+      for (int i = 1; i < numPts; ++i)
+      {
+        if (pts[i] != pts[numPts - i])
+        {
+          this->Reversed = (pts[numPts - i] < pts[i]);
+          break;
+        }
+      }
+    }
+  }
+
+  vtkIdType operator[](int i) const
+  {
+    const vtkIdType *pts = this->Pts;
+    switch (this->NumPts)
+    {
+      case 3:
+        return i == 0 ? pts[0] : (i == 1 ? std::min(pts[1], pts[2])
+                                          : std::max(pts[1], pts[2]));
+      case 4:
+        return i == 0 ? pts[0] : (i == 1 ? pts[2] : (i == 2 ?
+          std::min(pts[1], pts[3]) : std::max(pts[1], pts[3])));
+      default:
+        return (i == 0 || !this->Reversed) ? pts[i] : pts[this->NumPts - i];
+    }
+  }
+
+  // Orders the keys by first point, number of points, then other points.
+  static int Compare(const SurfaceFaceKey &a, const SurfaceFaceKey &b)
+  {
+    if (a.Pts[0] != b.Pts[0])
+    {
+      return a.Pts[0] < b.Pts[0] ? -1 : 1;
+    }
+    if (a.NumPts != b.NumPts)
+    {
+      return a.NumPts < b.NumPts ? -1 : 1;
+    }
+    for (int i = 1; i < a.NumPts; ++i)
+    {
+      vtkIdType ai = a[i], bi = b[i];
+      if (ai != bi)
+      {
+        return ai < bi ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+private:
+  const vtkIdType *Pts;
+  int NumPts;
+  bool Reversed;
+};
+
+// A face in the bin of its first point. Face is the index of the face in
+// order of insertion, and Key holds the rest of the key of the face stored by
+// RotateFace(): the two other points of a triangle, sorted, then -1; the
+// opposite point of a quad then its two other points, sorted; and for the
+// other faces -1, the number of points and the location of the points, which
+// are stored separately.
+struct BinnedSurfaceFace
+{
+  vtkIdType Face;
+  vtkIdType Key[3];
+
+  bool operator<(const BinnedSurfaceFace &other) const
+  {
+    return this->Face < other.Face;
+  }
+};
+
+// Whether the points of a face do not fit in the key of its binned face.
+inline bool IsStoredSeparately(int numPts)
+{
+  return numPts < 3 || numPts > 4;
+}
+
+// The number of points of a binned face.
+inline int GetNumberOfPoints(const BinnedSurfaceFace &binned)
+{
+  return binned.Key[0] < 0 ? static_cast<int>(binned.Key[1])
+                           : (binned.Key[2] < 0 ? 3 : 4);
+}
+
+// Fills a binned face from a face rotated by RotateFace(). The points of the
+// faces stored separately are copied at location, which is then advanced.
+void SetBinnedFace(BinnedSurfaceFace &binned, vtkIdType face,
+                   const vtkIdType *pts, int numPts,
+                   vtkIdType *storedPts, vtkIdType &location)
+{
+  binned.Face = face;
+  if (IsStoredSeparately(numPts))
+  {
+    binned.Key[0] = -1;
+    binned.Key[1] = numPts;
+    binned.Key[2] = location;
+    std::copy(pts, pts + numPts, storedPts + location);
+    location += numPts;
+  }
+  else
+  {
+    SurfaceFaceKey key(pts, numPts);
+    for (int i = 1; i < 4; ++i)
+    {
+      binned.Key[i - 1] = (i < numPts ? key[i] : -1);
+    }
+  }
+}
+
+// Compares the keys of the binned faces of a bin.
+class BinnedSurfaceFaceKeys
+{
+public:
+  BinnedSurfaceFaceKeys(const vtkIdType *storedPts)
+    : StoredPts(storedPts) {}
+
+  int Compare(const BinnedSurfaceFace &a, const BinnedSurfaceFace &b) const
+  {
+    if (a.Key[0] < 0 && b.Key[0] < 0)
+    {
+      return SurfaceFaceKey::Compare(
+        SurfaceFaceKey(this->StoredPts + a.Key[2], static_cast<int>(a.Key[1])),
+        SurfaceFaceKey(this->StoredPts + b.Key[2], static_cast<int>(b.Key[1])));
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      if (a.Key[i] != b.Key[i])
+      {
+        return a.Key[i] < b.Key[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+  bool Same(const BinnedSurfaceFace &a, const BinnedSurfaceFace &b) const
+  {
+    if (a.Key[0] < 0 || b.Key[0] < 0)
+    {
+      return this->Compare(a, b) == 0;
+    }
+    return a.Key[0] == b.Key[0] && a.Key[1] == b.Key[1] &&
+      a.Key[2] == b.Key[2];
+  }
+  // Orders by key, then by order of insertion.
+  bool operator()(const BinnedSurfaceFace &a,
+                  const BinnedSurfaceFace &b) const
+  {
+    int order = this->Compare(a, b);
+    return order < 0 || (order == 0 && a.Face < b.Face);
+  }
+
+private:
+  const vtkIdType *StoredPts;
+};
+
+// Exclusive scan of the values of the cells of one category, in cell order.
+// The offsets of the cells of the other categories are left unchanged.
+vtkIdType ScanCategory(const std::vector<unsigned char> &categories,
+                       unsigned char category,
+                       const std::vector<vtkIdType> &values,
+                       std::vector<vtkIdType> &offsets,
+                       std::vector<vtkIdType> &buffer)
+{
+  vtkSMPTools::Transform(values.begin(), values.end(), categories.begin(),
+    buffer.begin(), [category](vtkIdType value, unsigned char c) -> vtkIdType
+    { return c == category ? value : 0; });
+  vtkIdType total = vtkSMPTools::ExclusiveScan(buffer.begin(), buffer.end(),
+    buffer.begin(), static_cast<vtkIdType>(0));
+  vtkSMPTools::For(0, static_cast<vtkIdType>(categories.size()),
+    [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    for (; cellId < endCellId; ++cellId)
+    {
+      if (categories[cellId] == category)
+      {
+        offsets[cellId] = buffer[cellId];
+      }
+    }
+  });
+  return total;
+}
+
+// Atomically lowers a first use.
+inline void UpdateFirstUse(std::atomic<vtkTypeInt64> &firstUse,
+                           vtkTypeInt64 use)
+{
+  vtkTypeInt64 current = firstUse.load(std::memory_order_relaxed);
+  while (use < current &&
+         !firstUse.compare_exchange_weak(current, use,
+                                         std::memory_order_relaxed))
+  {
+  }
+}
+}
+
 //========================================================================
 // Tris are now degenerate quads so we only need one hash table.
 // We might want to change the method names from QuadHash to just Hash.
@@ -1512,6 +1965,17 @@ int vtkDataSetSurfaceFilter::UnstructuredGridExecute(vtkDataSet *dataSetInput,
     }
   }
 
+  // Grids that do not need subdivision are processed in parallel when all
+  // their cells are supported. With a single thread, the face hash is
+  // faster than the binning of the parallel execution.
+  vtkUnstructuredGrid *grid = vtkUnstructuredGrid::SafeDownCast(input);
+  if (!handleSubdivision && grid &&
+      vtkSMPTools::GetEstimatedNumberOfThreads() > 1 &&
+      this->UnstructuredGridExecuteInParallel(grid, output))
+  {
+    return 1;
+  }
+
   vtkSmartPointer<vtkUnstructuredGrid> tempInput;
   if (handleSubdivision)
   {
@@ -2220,6 +2684,618 @@ int vtkDataSetSurfaceFilter::UnstructuredGridExecute(vtkDataSet *dataSetInput,
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkDataSetSurfaceFilter::UnstructuredGridExecuteInParallel(
+  vtkUnstructuredGrid *input, vtkPolyData *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+  if (!input->GetCellTypesArray() || !input->GetPoints())
+  {
+    return 0;
+  }
+  const unsigned char *cellTypes = input->GetCellTypesArray()->GetPointer(0);
+  bool linearizeQuadratic = (this->NonlinearSubdivisionLevel < 1);
+
+  // Sort the cells in categories, and leave the grids with other cells to
+  // the serial execution.
+  std::vector<unsigned char> categories(numCells);
+  std::atomic<bool> supported(true);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    for (; cellId < endCellId; ++cellId)
+    {
+      categories[cellId] =
+        GetSurfaceCellCategory(cellTypes[cellId], linearizeQuadratic);
+      if (categories[cellId] == SURFACE_UNSUPPORTED)
+      {
+        supported = false;
+      }
+    }
+  });
+  if (!supported)
+  {
+    return 0;
+  }
+
+  vtkPointData *inputPD = input->GetPointData();
+  vtkCellData *inputCD = input->GetCellData();
+  vtkPointData *outputPD = output->GetPointData();
+  vtkCellData *outputCD = output->GetCellData();
+  vtkUnsignedCharArray *ghosts = input->GetPointGhostArray();
+
+  // Shallow copy field data not associated with points or cells
+  output->GetFieldData()->ShallowCopy(input->GetFieldData());
+
+  // Count the output cells and connectivity entries of the vertices, lines
+  // and 2D cells, and the faces of the 3D cells and the points of the faces
+  // stored separately from their key. Here and below, the cell points are
+  // read without modifying the input, through an id list of each task that
+  // receives them when they are not stored as vtkIdType.
+  std::vector<vtkIdType> counts(numCells);
+  std::vector<vtkIdType> sizes(numCells);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    vtkIdType numFaces, numFacePts;
+    auto countFace = [&](int n, const vtkIdType*)
+    {
+      ++numFaces;
+      numFacePts += (IsStoredSeparately(n) ? n : 0);
+    };
+    for (; cellId < endCellId; ++cellId)
+    {
+      unsigned char cellType = cellTypes[cellId];
+      switch (categories[cellId])
+      {
+        case SURFACE_VERTS:
+        case SURFACE_LINES:
+        case SURFACE_POLYS:
+          input->GetCellPoints(cellId, npts, pts, ptIds);
+          npts = GetNumberOfSurfacePoints(cellType, npts);
+          if (cellType == VTK_TRIANGLE_STRIP)
+          {
+            // Strips are output as triangles.
+            counts[cellId] = std::max(npts - 2, static_cast<vtkIdType>(0));
+            sizes[cellId] = 4 * counts[cellId];
+          }
+          else
+          {
+            counts[cellId] = 1;
+            sizes[cellId] = npts + 1;
+          }
+          break;
+        case SURFACE_FACES:
+          input->GetCellPoints(cellId, npts, pts, ptIds);
+          numFaces = numFacePts = 0;
+          ForEachFace(input, cellId, cellType, pts, countFace);
+          counts[cellId] = numFaces;
+          sizes[cellId] = numFacePts;
+          break;
+        default:
+          counts[cellId] = sizes[cellId] = 0;
+          break;
+      }
+    }
+  });
+
+  // The vertices, lines and 2D cells are output in cell order, before the
+  // external faces, and the faces in the order of the cells inserting them.
+  std::vector<vtkIdType> cellOffsets(numCells);
+  std::vector<vtkIdType> connOffsets(numCells);
+  std::vector<vtkIdType> buffer(numCells);
+  vtkIdType numCategoryCells[SURFACE_FACES];
+  vtkIdType categoryConnSizes[SURFACE_FACES + 1];
+  for (unsigned char category = SURFACE_VERTS; category < SURFACE_FACES;
+       ++category)
+  {
+    numCategoryCells[category] =
+      ScanCategory(categories, category, counts, cellOffsets, buffer);
+    categoryConnSizes[category] =
+      ScanCategory(categories, category, sizes, connOffsets, buffer);
+  }
+  categoryConnSizes[SURFACE_FACES] =
+    ScanCategory(categories, SURFACE_FACES, sizes, connOffsets, buffer);
+  // The faces of a cell are numbered from its face offset. The offsets do not
+  // decrease with the cell ids: the cell of a face is found by binary search.
+  std::vector<vtkIdType> &faceOffsets = buffer;
+  vtkIdType numFaces =
+    ScanCategory(categories, SURFACE_FACES, counts, cellOffsets, faceOffsets);
+  vtkIdType maxCellSize = vtkSMPTools::Reduce(sizes.begin(), sizes.end(),
+    static_cast<vtkIdType>(4),
+    [](vtkIdType a, vtkIdType b) { return std::max(a, b); });
+
+  // Bin the faces of the 3D cells, rotated as the face hash stores them, by
+  // their first (smallest) point as the face hash does. The faces are
+  // generated twice, to size the bins and then to fill them, rather than
+  // stored: only their keys are.
+  std::vector<std::atomic<vtkIdType> > binSizes(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      binSizes[ptId].store(0, std::memory_order_relaxed);
+    }
+  });
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    std::vector<vtkIdType> rotated(maxCellSize);
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    auto countFace = [&](int n, const vtkIdType *facePts)
+    {
+      std::copy(facePts, facePts + n, rotated.begin());
+      RotateFace(rotated.data(), n);
+      binSizes[rotated[0]].fetch_add(1, std::memory_order_relaxed);
+    };
+    for (; cellId < endCellId; ++cellId)
+    {
+      if (categories[cellId] == SURFACE_FACES)
+      {
+        input->GetCellPoints(cellId, npts, pts, ptIds);
+        ForEachFace(input, cellId, cellTypes[cellId], pts, countFace);
+      }
+    }
+  });
+  std::vector<vtkIdType> binOffsets(numPts + 1);
+  vtkSMPTools::Transform(binSizes.begin(), binSizes.end(), binOffsets.begin(),
+    [](std::atomic<vtkIdType> &binSize) -> vtkIdType
+    { return binSize.exchange(0, std::memory_order_relaxed); });
+  binOffsets[numPts] = vtkSMPTools::ExclusiveScan(binOffsets.begin(),
+    binOffsets.begin() + numPts, binOffsets.begin(), static_cast<vtkIdType>(0));
+  // Left uninitialized: every face is set below.
+  std::unique_ptr<BinnedSurfaceFace[]> binnedFaces(
+    new BinnedSurfaceFace[numFaces]);
+  std::vector<vtkIdType> storedPts(categoryConnSizes[SURFACE_FACES]);
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    std::vector<vtkIdType> rotated(maxCellSize);
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    vtkIdType face, location;
+    auto binFace = [&](int n, const vtkIdType *facePts)
+    {
+      std::copy(facePts, facePts + n, rotated.begin());
+      RotateFace(rotated.data(), n);
+      vtkIdType first = rotated[0];
+      SetBinnedFace(binnedFaces[binOffsets[first] +
+        binSizes[first].fetch_add(1, std::memory_order_relaxed)],
+        face++, rotated.data(), n, storedPts.data(), location);
+    };
+    for (; cellId < endCellId; ++cellId)
+    {
+      if (categories[cellId] == SURFACE_FACES)
+      {
+        input->GetCellPoints(cellId, npts, pts, ptIds);
+        face = faceOffsets[cellId];
+        location = connOffsets[cellId];
+        ForEachFace(input, cellId, cellTypes[cellId], pts, binFace);
+      }
+    }
+  });
+  std::vector<std::atomic<vtkIdType> >().swap(binSizes);
+
+  // The faces sharing their key with another face of their bin are internal
+  // and hidden. The others are the external faces, moved to the front of
+  // their bin in order of insertion: they are output bin by bin, in the
+  // order of the face hash traversal.
+  std::vector<vtkIdType> visibleOffsets(numPts);
+  BinnedSurfaceFaceKeys keys(storedPts.data());
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    const vtkIdType smallBinSize = 32;
+    bool hidden[smallBinSize];
+    for (; ptId < endPtId; ++ptId)
+    {
+      BinnedSurfaceFace *begin = binnedFaces.get() + binOffsets[ptId];
+      vtkIdType size = binOffsets[ptId + 1] - binOffsets[ptId];
+      if (size > smallBinSize)
+      {
+        // Sort large bins by key to find the runs of matching faces.
+        std::sort(begin, begin + size, keys);
+        for (vtkIdType first = 0; first < size;)
+        {
+          vtkIdType last = first + 1;
+          while (last < size && keys.Same(begin[first], begin[last]))
+          {
+            ++last;
+          }
+          for (vtkIdType i = first; last - first > 1 && i < last; ++i)
+          {
+            begin[i].Face = -1;
+          }
+          first = last;
+        }
+        std::sort(begin, begin + size);
+      }
+      else if (size > 1)
+      {
+        std::sort(begin, begin + size);
+        std::fill(hidden, hidden + size, false);
+        for (vtkIdType i = 0; i < size; ++i)
+        {
+          for (vtkIdType j = i + 1; j < size; ++j)
+          {
+            if (keys.Same(begin[i], begin[j]))
+            {
+              hidden[i] = hidden[j] = true;
+            }
+          }
+        }
+        for (vtkIdType i = 0; i < size; ++i)
+        {
+          begin[i].Face = (hidden[i] ? -1 : begin[i].Face);
+        }
+      }
+      visibleOffsets[ptId] = std::remove_if(begin, begin + size,
+        [](const BinnedSurfaceFace &binned) { return binned.Face < 0; }) -
+        begin;
+    }
+  });
+  vtkIdType numVisibleFaces = vtkSMPTools::ExclusiveScan(
+    visibleOffsets.begin(), visibleOffsets.end(), visibleOffsets.begin(),
+    static_cast<vtkIdType>(0));
+  std::vector<vtkIdType> visibleFaces(numVisibleFaces);
+  std::vector<vtkIdType> visibleLocations(numVisibleFaces + 1);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkIdType numBinVisible = (ptId + 1 < numPts ? visibleOffsets[ptId + 1]
+                                                   : numVisibleFaces) -
+        visibleOffsets[ptId];
+      const BinnedSurfaceFace *binned = binnedFaces.get() + binOffsets[ptId];
+      for (vtkIdType i = 0; i < numBinVisible; ++i)
+      {
+        visibleFaces[visibleOffsets[ptId] + i] = binned[i].Face;
+        visibleLocations[visibleOffsets[ptId] + i] =
+          GetNumberOfPoints(binned[i]);
+      }
+    }
+  });
+  visibleLocations[numVisibleFaces] = vtkSMPTools::ExclusiveScan(
+    visibleLocations.begin(), visibleLocations.begin() + numVisibleFaces,
+    visibleLocations.begin(), static_cast<vtkIdType>(0));
+  std::vector<vtkIdType>().swap(visibleOffsets);
+  binnedFaces.reset();
+  std::vector<vtkIdType>().swap(storedPts);
+  std::vector<vtkIdType>().swap(binOffsets);
+
+  // Generate the external faces again, from their cells.
+  std::vector<vtkIdType> visiblePts(visibleLocations[numVisibleFaces]);
+  std::vector<vtkIdType> visibleCells(numVisibleFaces);
+  vtkSMPTools::For(0, numVisibleFaces, [&](vtkIdType i, vtkIdType endI)
+  {
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    vtkIdType face, cellFace;
+    vtkIdType *facePts;
+    auto copyFace = [&](int n, const vtkIdType *cellFacePts)
+    {
+      if (cellFace++ == face)
+      {
+        std::copy(cellFacePts, cellFacePts + n, facePts);
+        RotateFace(facePts, n);
+      }
+    };
+    for (; i < endI; ++i)
+    {
+      face = visibleFaces[i];
+      vtkIdType cellId = std::upper_bound(faceOffsets.begin(),
+        faceOffsets.end(), face) - faceOffsets.begin() - 1;
+      visibleCells[i] = cellId;
+      input->GetCellPoints(cellId, npts, pts, ptIds);
+      cellFace = faceOffsets[cellId];
+      facePts = visiblePts.data() + visibleLocations[i];
+      ForEachFace(input, cellId, cellTypes[cellId], pts, copyFace);
+    }
+  });
+  std::vector<vtkIdType>().swap(visibleFaces);
+  std::vector<vtkIdType>().swap(faceOffsets);
+  this->UpdateProgress(0.5);
+
+  // External faces whose points are all duplicated (boundary) ghost points,
+  // or that have a hidden point, are not output. Their points are still
+  // numbered like the ones of the output faces.
+  std::vector<vtkIdType> faceCellOffsets(numVisibleFaces);
+  std::vector<vtkIdType> faceConnOffsets(numVisibleFaces);
+  vtkSMPTools::For(0, numVisibleFaces, [&](vtkIdType i, vtkIdType endI)
+  {
+    for (; i < endI; ++i)
+    {
+      const vtkIdType *facePts = visiblePts.data() + visibleLocations[i];
+      int numFacePts =
+        static_cast<int>(visibleLocations[i + 1] - visibleLocations[i]);
+      bool allGhosts = (ghosts != nullptr);
+      bool oneHidden = false;
+      for (int j = 0; ghosts && j < numFacePts; ++j)
+      {
+        unsigned char val = ghosts->GetValue(facePts[j]);
+        if (!(val & vtkDataSetAttributes::DUPLICATEPOINT))
+        {
+          allGhosts = false;
+        }
+        if (val & vtkDataSetAttributes::HIDDENPOINT)
+        {
+          oneHidden = true;
+        }
+      }
+      bool outputFace = !(allGhosts || oneHidden);
+      faceCellOffsets[i] = outputFace;
+      faceConnOffsets[i] = (outputFace ? numFacePts + 1 : 0);
+    }
+  });
+  vtkIdType numOutputFaces = vtkSMPTools::ExclusiveScan(
+    faceCellOffsets.begin(), faceCellOffsets.end(), faceCellOffsets.begin(),
+    static_cast<vtkIdType>(0));
+  vtkIdType faceConnSize = vtkSMPTools::ExclusiveScan(
+    faceConnOffsets.begin(), faceConnOffsets.end(), faceConnOffsets.begin(),
+    static_cast<vtkIdType>(0));
+
+  // The output points are numbered in order of first use, as they are when
+  // the vertices, then the lines, then the 2D cells and then the external
+  // faces are inserted one at a time.
+  std::vector<std::atomic<vtkTypeInt64> > firstUses(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      firstUses[ptId].store(VTK_TYPE_INT64_MAX, std::memory_order_relaxed);
+    }
+  });
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    for (; cellId < endCellId; ++cellId)
+    {
+      unsigned char category = categories[cellId];
+      if (category < SURFACE_FACES)
+      {
+        input->GetCellPoints(cellId, npts, pts, ptIds);
+        npts = GetNumberOfSurfacePoints(cellTypes[cellId], npts);
+        vtkTypeInt64 use = (static_cast<vtkTypeInt64>(category) * numCells +
+                            cellId) * maxCellSize;
+        for (vtkIdType i = 0; i < npts; ++i)
+        {
+          UpdateFirstUse(firstUses[GetSurfacePoint(cellTypes[cellId], pts, i)],
+                         use + i);
+        }
+      }
+    }
+  });
+  vtkSMPTools::For(0, numVisibleFaces, [&](vtkIdType i, vtkIdType endI)
+  {
+    for (; i < endI; ++i)
+    {
+      const vtkIdType *facePts = visiblePts.data() + visibleLocations[i];
+      int numFacePts =
+        static_cast<int>(visibleLocations[i + 1] - visibleLocations[i]);
+      vtkTypeInt64 use = (static_cast<vtkTypeInt64>(SURFACE_FACES) * numCells +
+                          i) * maxCellSize;
+      for (int j = 0; j < numFacePts; ++j)
+      {
+        UpdateFirstUse(firstUses[facePts[j]], use + j);
+      }
+    }
+  });
+
+  std::vector<vtkIdType> pointMap(numPts); //maps old point ids into new
+  vtkSMPTools::Transform(firstUses.begin(), firstUses.end(), pointMap.begin(),
+    [](const std::atomic<vtkTypeInt64> &firstUse) -> vtkIdType
+    { return firstUse.load(std::memory_order_relaxed) != VTK_TYPE_INT64_MAX; });
+  vtkIdType numNewPts = vtkSMPTools::ExclusiveScan(pointMap.begin(),
+    pointMap.end(), pointMap.begin(), static_cast<vtkIdType>(0));
+  std::vector<std::pair<vtkTypeInt64, vtkIdType> > uses(numNewPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      vtkTypeInt64 firstUse = firstUses[ptId].load(std::memory_order_relaxed);
+      if (firstUse != VTK_TYPE_INT64_MAX)
+      {
+        uses[pointMap[ptId]] = std::make_pair(firstUse, ptId);
+      }
+    }
+  });
+  std::vector<std::atomic<vtkTypeInt64> >().swap(firstUses);
+  vtkSMPTools::Sort(uses.begin(), uses.end());
+  std::vector<vtkIdType> pointSources(numNewPts); //maps new point ids to old
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      pointSources[newId] = uses[newId].second;
+      pointMap[uses[newId].second] = newId;
+    }
+  });
+  std::vector<std::pair<vtkTypeInt64, vtkIdType> >().swap(uses);
+
+  // Copy the points and their data
+  vtkNew<vtkPoints> newPts;
+  newPts->SetDataType(input->GetPoints()->GetData()->GetDataType());
+  newPts->SetNumberOfPoints(numNewPts);
+  outputPD->CopyGlobalIdsOn();
+  outputPD->CopyAllocate(inputPD, numNewPts);
+  ArrayList pointArrays;
+  pointArrays.AddArrays(numNewPts, inputPD, outputPD, 0.0, false);
+  vtkSMPTools::For(0, numNewPts, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    double x[3];
+    for (; newId < endNewId; ++newId)
+    {
+      input->GetPoint(pointSources[newId], x);
+      newPts->SetPoint(newId, x);
+      pointArrays.Copy(pointSources[newId], newId);
+    }
+  });
+  pointArrays.CopyOtherArrays(numNewPts, pointSources.data(), inputPD,
+                              outputPD);
+
+  // Fill the cell arrays. The 2D cells come before the external faces in
+  // the polygons, and the output cells are numbered in the same order as the
+  // serial execution: vertices, lines, polygons.
+  vtkIdType numOutCells = numCategoryCells[SURFACE_VERTS] +
+    numCategoryCells[SURFACE_LINES] + numCategoryCells[SURFACE_POLYS] +
+    numOutputFaces;
+  std::vector<vtkIdType> cellSources(numOutCells); //maps new cell ids to old
+  vtkIdType cellBases[SURFACE_FACES + 1];
+  cellBases[SURFACE_VERTS] = 0;
+  for (int category = SURFACE_LINES; category <= SURFACE_FACES; ++category)
+  {
+    cellBases[category] = cellBases[category - 1] +
+      numCategoryCells[category - 1];
+  }
+  vtkNew<vtkIdTypeArray> connectivities[SURFACE_FACES];
+  connectivities[SURFACE_VERTS]->SetNumberOfValues(
+    categoryConnSizes[SURFACE_VERTS]);
+  connectivities[SURFACE_LINES]->SetNumberOfValues(
+    categoryConnSizes[SURFACE_LINES]);
+  connectivities[SURFACE_POLYS]->SetNumberOfValues(
+    categoryConnSizes[SURFACE_POLYS] + faceConnSize);
+
+  vtkSMPTools::For(0, numCells, [&](vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts;
+    const vtkIdType *pts;
+    vtkNew<vtkIdList> ptIds;
+    for (; cellId < endCellId; ++cellId)
+    {
+      unsigned char category = categories[cellId];
+      if (category >= SURFACE_FACES)
+      {
+        continue;
+      }
+      unsigned char cellType = cellTypes[cellId];
+      input->GetCellPoints(cellId, npts, pts, ptIds);
+      npts = GetNumberOfSurfacePoints(cellType, npts);
+      vtkIdType *newPts =
+        connectivities[category]->GetPointer(connOffsets[cellId]);
+      vtkIdType *sources =
+        cellSources.data() + cellBases[category] + cellOffsets[cellId];
+      if (cellType == VTK_TRIANGLE_STRIP)
+      {
+        // Change strips to triangles so we do not have to worry about order.
+        if (npts > 1)
+        {
+          int toggle = 0;
+          vtkIdType triPts[3] = { pointMap[pts[0]], pointMap[pts[1]], 0 };
+          for (vtkIdType i = 2; i < npts; ++i)
+          {
+            triPts[2] = pointMap[pts[i]];
+            *newPts++ = 3;
+            *newPts++ = triPts[0];
+            *newPts++ = triPts[1];
+            *newPts++ = triPts[2];
+            *sources++ = cellId;
+            triPts[toggle] = triPts[2];
+            toggle = !toggle;
+          }
+        }
+      }
+      else
+      {
+        *newPts++ = npts;
+        for (vtkIdType i = 0; i < npts; ++i)
+        {
+          newPts[i] = pointMap[GetSurfacePoint(cellType, pts, i)];
+        }
+        *sources = cellId;
+      }
+    }
+  });
+
+  vtkIdType *facesConnectivity = connectivities[SURFACE_POLYS]->GetPointer(
+    categoryConnSizes[SURFACE_POLYS]);
+  vtkSMPTools::For(0, numVisibleFaces, [&](vtkIdType i, vtkIdType endI)
+  {
+    for (; i < endI; ++i)
+    {
+      vtkIdType next = (i + 1 < numVisibleFaces ? faceCellOffsets[i + 1]
+                                                : numOutputFaces);
+      if (next == faceCellOffsets[i])
+      {
+        continue;
+      }
+      const vtkIdType *facePts = visiblePts.data() + visibleLocations[i];
+      int numFacePts =
+        static_cast<int>(visibleLocations[i + 1] - visibleLocations[i]);
+      vtkIdType *newPts = facesConnectivity + faceConnOffsets[i];
+      *newPts++ = numFacePts;
+      for (int j = 0; j < numFacePts; ++j)
+      {
+        newPts[j] = pointMap[facePts[j]];
+      }
+      cellSources[cellBases[SURFACE_FACES] + faceCellOffsets[i]] =
+        visibleCells[i];
+    }
+  });
+
+  // Copy the cell data
+  outputCD->CopyGlobalIdsOn();
+  outputCD->CopyAllocate(inputCD, numOutCells);
+  ArrayList cellArrays;
+  cellArrays.AddArrays(numOutCells, inputCD, outputCD, 0.0, false);
+  vtkSMPTools::For(0, numOutCells, [&](vtkIdType newId, vtkIdType endNewId)
+  {
+    for (; newId < endNewId; ++newId)
+    {
+      cellArrays.Copy(cellSources[newId], newId);
+    }
+  });
+  cellArrays.CopyOtherArrays(numOutCells, cellSources.data(), inputCD,
+                             outputCD);
+
+  if (this->PassThroughCellIds)
+  {
+    vtkNew<vtkIdTypeArray> originalCellIds;
+    originalCellIds->SetName(this->GetOriginalCellIdsName());
+    originalCellIds->SetNumberOfValues(numOutCells);
+    std::copy(cellSources.begin(), cellSources.end(),
+              originalCellIds->GetPointer(0));
+    outputCD->AddArray(originalCellIds);
+  }
+  if (this->PassThroughPointIds)
+  {
+    vtkNew<vtkIdTypeArray> originalPointIds;
+    originalPointIds->SetName(this->GetOriginalPointIdsName());
+    originalPointIds->SetNumberOfValues(numNewPts);
+    std::copy(pointSources.begin(), pointSources.end(),
+              originalPointIds->GetPointer(0));
+    outputPD->AddArray(originalPointIds);
+  }
+
+  output->SetPoints(newPts);
+  vtkNew<vtkCellArray> newPolys;
+  newPolys->SetCells(numCategoryCells[SURFACE_POLYS] + numOutputFaces,
+                     connectivities[SURFACE_POLYS]);
+  output->SetPolys(newPolys);
+  if (numCategoryCells[SURFACE_VERTS] > 0)
+  {
+    vtkNew<vtkCellArray> newVerts;
+    newVerts->SetCells(numCategoryCells[SURFACE_VERTS],
+                       connectivities[SURFACE_VERTS]);
+    output->SetVerts(newVerts);
+  }
+  if (numCategoryCells[SURFACE_LINES] > 0)
+  {
+    vtkNew<vtkCellArray> newLines;
+    newLines->SetCells(numCategoryCells[SURFACE_LINES],
+                       connectivities[SURFACE_LINES]);
+    output->SetLines(newLines);
+  }
+
+  output->Squeeze();
+
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkDataSetSurfaceFilter::InitializeQuadHash(vtkIdType numPoints)
 {
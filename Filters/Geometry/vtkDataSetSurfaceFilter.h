@@ -21,6 +21,14 @@
  * vtkGeometryFilter.  It only has one option: whether to use triangle strips
  * when the input type is structured.
  *
+ * When several threads are available, the external faces of unstructured
+ * grids made of linear cells (and of quadratic 2D cells when
+ * NonlinearSubdivisionLevel is 0) are extracted with vtkSMPTools: the faces
+ * of all the cells are generated in parallel and binned by their smallest
+ * point, and the faces found once in their bin are kept. The output is the
+ * same as the one of the serial face hash, which is still used for the other
+ * grids and with a single thread.
+ *
  * @sa
  * vtkGeometryFilter vtkStructuredGridGeometryFilter.
 */
@@ -35,6 +43,7 @@ class vtkPointData;
 class vtkPoints;
 class vtkIdTypeArray;
 class vtkStructuredGrid;
+class vtkUnstructuredGrid;
 
 // Helper structure for hashing faces.
 struct vtkFastGeomQuadStruct
@@ -150,6 +159,14 @@ public:
 #endif
   virtual int UnstructuredGridExecute(vtkDataSet *input,
                                       vtkPolyData *output);
+
+  /**
+   * Multithreaded version of UnstructuredGridExecute() for grids that do not
+   * need nonlinear subdivision. Returns 0 without touching the output when
+   * the grid has cells it does not handle.
+   */
+  int UnstructuredGridExecuteInParallel(vtkUnstructuredGrid *input,
+                                        vtkPolyData *output);
   virtual int DataSetExecute(vtkDataSet *input, vtkPolyData *output);
   virtual int StructuredWithBlankingExecute(vtkStructuredGrid *input, vtkPolyData *output);
   virtual int UniformGridExecute(
@@ -1139,13 +1139,18 @@ vtkIdType vtkPLagrangianParticleTracker::GetNewParticleId()
 {
   if (this->Controller && this->Controller->GetNumberOfProcesses() > 1)
   {
-    vtkIdType id = this->ParticleCounter;
-    this->ParticleCounter += this->Controller->GetNumberOfProcesses();
-    return id;
+    return this->ParticleCounter.fetch_add(this->Controller->GetNumberOfProcesses());
   }
   return this->Superclass::GetNewParticleId();
 }
 
+//---------------------------------------------------------------------------
+bool vtkPLagrangianParticleTracker::CanIntegrateInParallel()
+{
+  return this->Superclass::CanIntegrateInParallel() &&
+    (!this->Controller || this->Controller->GetNumberOfProcesses() <= 1);
+}
+
 //---------------------------------------------------------------------------
 void vtkPLagrangianParticleTracker::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -86,6 +86,12 @@ protected:
     vtkPolyData* particlePathsOutput, vtkIdList* particlePathPointId,
     vtkDataObject* interactionOutput) override;
 
+  /**
+   * Particles are integrated concurrently only when running on a single
+   * process, as particles streamed between ranks must be integrated in order.
+   */
+  bool CanIntegrateInParallel() override;
+
   void SendParticle(vtkLagrangianParticle* particle);
   void ReceiveParticles(std::queue<vtkLagrangianParticle*>& particleQueue);
 
@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestASCIINumberParser.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Compare the numbers parsed by vtkASCIINumberParser with the numbers read
+// by the stream operators, and check the parallel parsing of large texts.
+
+#include "vtkASCIINumberParser.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template <class T>
+bool ParseOne(const char* text, T expected)
+{
+  T value = T();
+  const char* end = text + strlen(text);
+  const char* p = vtkASCIINumberParser::Parse(text, end, value);
+  if (!p || value != expected)
+  {
+    cerr << "Parsing \"" << text << "\" failed" << endl;
+    return false;
+  }
+  return true;
+}
+
+template <class T>
+bool ParseFails(const char* text)
+{
+  T value = T();
+  if (vtkASCIINumberParser::Parse(text, text + strlen(text), value))
+  {
+    cerr << "Parsing \"" << text << "\" should fail" << endl;
+    return false;
+  }
+  return true;
+}
+
+// Parse the text written with the stream operator and compare with the
+// values read by the stream operator.
+template <class T>
+bool CompareWithStream(const std::string& text, size_t numValues)
+{
+  std::vector<T> expected(numValues);
+  std::istringstream is(text);
+  for (size_t i = 0; i < numValues; ++i)
+  {
+    is >> expected[i];
+  }
+
+  std::vector<T> values(numValues + 1);
+  size_t count = numValues + 1;
+  const char* end = vtkASCIINumberParser::ParseValues(
+    text.c_str(), text.c_str() + text.size(), values.data(), count);
+  if (!end || count != numValues)
+  {
+    cerr << "Parsed " << count << " values instead of " << numValues << endl;
+    return false;
+  }
+  for (size_t i = 0; i < numValues; ++i)
+  {
+    if (values[i] != expected[i] &&
+        !(std::isnan(static_cast<double>(values[i])) &&
+          std::isnan(static_cast<double>(expected[i]))))
+    {
+      cerr << "Value " << i << " is " << values[i] << " instead of "
+           << expected[i] << endl;
+      return false;
+    }
+  }
+
+  // Stop after some values.
+  count = numValues / 2;
+  end = vtkASCIINumberParser::ParseValues(
+    text.c_str(), text.c_str() + text.size(), values.data(), count);
+  if (!end || count != numValues / 2 ||
+      (*end && !vtkASCIINumberParser::IsSpace(*end)))
+  {
+    cerr << "Wrong partial parsing" << endl;
+    return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int TestASCIINumberParser(int, char*[])
+{
+  bool ok = true;
+
+  // Integers
+  ok &= ParseOne<int>("  42", 42);
+  ok &= ParseOne<int>("\n-2147483648 ", std::numeric_limits<int>::min());
+  ok &= ParseOne<int>("+2147483647", std::numeric_limits<int>::max());
+  ok &= ParseOne<long long>("-9223372036854775808",
+                            std::numeric_limits<long long>::min());
+  ok &= ParseOne<unsigned long long>("18446744073709551615",
+    std::numeric_limits<unsigned long long>::max());
+  ok &= ParseOne<unsigned short>("65535", 65535);
+  ok &= ParseOne<char>("65", 'A');
+  ok &= ParseOne<unsigned char>("255", 255);
+  ok &= ParseFails<int>("2147483648");
+  ok &= ParseFails<short>("-32769");
+  ok &= ParseFails<unsigned long long>("18446744073709551616");
+  ok &= ParseFails<int>("12a");
+  ok &= ParseFails<int>("1.5");
+  ok &= ParseFails<int>("-");
+  ok &= ParseFails<int>("   ");
+
+  // Floating-point numbers
+  ok &= ParseOne<double>("0.1", 0.1);
+  ok &= ParseOne<double>("-1.5e-3", -1.5e-3);
+  ok &= ParseOne<double>("1E+300", 1e300);
+  ok &= ParseOne<double>("4.9406564584124654e-324", 4.9406564584124654e-324);
+  ok &= ParseOne<double>(".5", 0.5);
+  ok &= ParseOne<double>("5.", 5.0);
+  ok &= ParseOne<double>("0.30000000000000004441", 0.30000000000000004441);
+  ok &= ParseOne<double>("123456789012345678901234567890",
+                         123456789012345678901234567890.0);
+  ok &= ParseOne<float>("0.1", 0.1f);
+  ok &= ParseOne<float>("3.4028235e38", std::numeric_limits<float>::max());
+  ok &= ParseOne<float>("16777217", 16777216.0f);
+  ok &= ParseOne<double>("inf", std::numeric_limits<double>::infinity());
+  ok &= ParseFails<double>("1e");
+  ok &= ParseFails<double>("1.0x");
+  ok &= ParseFails<float>("abc");
+
+  // Random numbers written with all their digits, in texts large enough to
+  // be parsed in parallel.
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  const size_t numValues = 200000;
+  std::ostringstream doubles, floats, ints;
+  doubles.precision(17);
+  floats.precision(9);
+  for (size_t i = 0; i < numValues; ++i)
+  {
+    random->Next();
+    double scale = std::pow(10.0, random->GetRangeValue(-30.0, 30.0));
+    random->Next();
+    double value = scale * random->GetRangeValue(-1.0, 1.0);
+    const char* separator = i % 10 == 9 ? "\n" : (i % 3 ? " " : "\t ");
+    doubles << value << separator;
+    floats << static_cast<float>(value) << separator;
+    ints << static_cast<int>(value * 1e9 / scale) << separator;
+  }
+  ok &= CompareWithStream<double>(doubles.str(), numValues);
+  ok &= CompareWithStream<float>(floats.str(), numValues);
+  ok &= CompareWithStream<int>(ints.str(), numValues);
+
+  // An invalid value in a large text
+  std::string text = doubles.str();
+  text[text.size() / 2] = 'x';
+  std::vector<double> values(numValues);
+  size_t count = numValues;
+  if (vtkASCIINumberParser::ParseValues(text.c_str(),
+                                        text.c_str() + text.size(),
+                                        values.data(), count))
+  {
+    cerr << "Parsing an invalid text should fail" << endl;
+    ok = false;
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
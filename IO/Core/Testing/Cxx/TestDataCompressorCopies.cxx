@@ -0,0 +1,219 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataCompressorCopies.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the copies made by vtkDataCompressor::NewCopy() to process
+// blocks concurrently are of the class of the compressor, with its settings,
+// and that the blocks are processed as by the compressor itself.
+
+#include "vtkNew.h"
+#include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
+#include "vtkZLibDataCompressor.h"
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// A zlib compressor that writes a marker before the compressed data.
+class vtkMarkedZLibCompressor : public vtkZLibDataCompressor
+{
+public:
+  static vtkMarkedZLibCompressor* New();
+  vtkTypeMacro(vtkMarkedZLibCompressor, vtkZLibDataCompressor);
+
+  size_t GetMaximumCompressionSpace(size_t size) override
+  {
+    return 1 + this->Superclass::GetMaximumCompressionSpace(size);
+  }
+
+  unsigned char Marker;
+
+protected:
+  vtkMarkedZLibCompressor() : Marker(0) {}
+
+  size_t CompressBuffer(unsigned char const* uncompressedData,
+                        size_t uncompressedSize,
+                        unsigned char* compressedData,
+                        size_t compressionSpace) override
+  {
+    compressedData[0] = this->Marker;
+    size_t size = this->Superclass::CompressBuffer(
+      uncompressedData, uncompressedSize, compressedData + 1,
+      compressionSpace - 1);
+    return size ? size + 1 : 0;
+  }
+
+  size_t UncompressBuffer(unsigned char const* compressedData,
+                          size_t compressedSize,
+                          unsigned char* uncompressedData,
+                          size_t uncompressedSize) override
+  {
+    if (compressedSize < 1 || compressedData[0] != this->Marker)
+    {
+      return 0;
+    }
+    return this->Superclass::UncompressBuffer(
+      compressedData + 1, compressedSize - 1, uncompressedData,
+      uncompressedSize);
+  }
+
+  bool CopySettings(vtkDataCompressor* source) override
+  {
+    if (!this->Superclass::CopySettings(source))
+    {
+      return false;
+    }
+    this->Marker = static_cast<vtkMarkedZLibCompressor*>(source)->Marker;
+    return true;
+  }
+
+private:
+  vtkMarkedZLibCompressor(const vtkMarkedZLibCompressor&) = delete;
+  void operator=(const vtkMarkedZLibCompressor&) = delete;
+};
+vtkStandardNewMacro(vtkMarkedZLibCompressor);
+
+// A compressor that stores the data as is, and cannot be copied.
+class vtkStoreCompressor : public vtkDataCompressor
+{
+public:
+  static vtkStoreCompressor* New();
+  vtkTypeMacro(vtkStoreCompressor, vtkDataCompressor);
+
+  size_t GetMaximumCompressionSpace(size_t size) override { return size; }
+
+protected:
+  vtkStoreCompressor() {}
+
+  size_t CompressBuffer(unsigned char const* uncompressedData,
+                        size_t uncompressedSize,
+                        unsigned char* compressedData, size_t) override
+  {
+    memcpy(compressedData, uncompressedData, uncompressedSize);
+    return uncompressedSize;
+  }
+
+  size_t UncompressBuffer(unsigned char const* compressedData,
+                          size_t compressedSize,
+                          unsigned char* uncompressedData,
+                          size_t uncompressedSize) override
+  {
+    if (compressedSize != uncompressedSize)
+    {
+      return 0;
+    }
+    memcpy(uncompressedData, compressedData, compressedSize);
+    return compressedSize;
+  }
+
+private:
+  vtkStoreCompressor(const vtkStoreCompressor&) = delete;
+  void operator=(const vtkStoreCompressor&) = delete;
+};
+vtkStandardNewMacro(vtkStoreCompressor);
+
+// Compress and uncompress blocks with CompressBlocks() and UncompressBlocks()
+// and compare them with the blocks compressed one at a time.
+int TestBlocks(vtkDataCompressor* compressor)
+{
+  const size_t numBlocks = 64;
+  const size_t blockSize = 4096;
+  std::vector<unsigned char> data(numBlocks * blockSize);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<unsigned char>((i * i) / 7 % 251);
+  }
+
+  size_t space = compressor->GetMaximumCompressionSpace(blockSize);
+  std::vector<unsigned char> compressed(numBlocks * space);
+  std::vector<unsigned char> uncompressed(data.size());
+  std::vector<unsigned char const*> input(numBlocks);
+  std::vector<unsigned char*> output(numBlocks);
+  std::vector<unsigned char const*> compressedInput(numBlocks);
+  std::vector<unsigned char*> uncompressedOutput(numBlocks);
+  std::vector<size_t> sizes(numBlocks, blockSize);
+  std::vector<size_t> compressedSizes(numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    input[i] = &data[i * blockSize];
+    output[i] = &compressed[i * space];
+    compressedInput[i] = output[i];
+    uncompressedOutput[i] = &uncompressed[i * blockSize];
+  }
+
+  if (!compressor->CompressBlocks(numBlocks, input.data(), sizes.data(),
+                                  output.data(), compressedSizes.data()))
+  {
+    cerr << compressor->GetClassName() << " failed to compress the blocks"
+         << endl;
+    return 1;
+  }
+  std::vector<unsigned char> expected(space);
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    size_t size =
+      compressor->Compress(input[i], blockSize, expected.data(), space);
+    if (size != compressedSizes[i] ||
+        memcmp(expected.data(), output[i], size) != 0)
+    {
+      cerr << compressor->GetClassName() << " compressed block " << i
+           << " differently" << endl;
+      return 1;
+    }
+  }
+
+  if (!compressor->UncompressBlocks(numBlocks, compressedInput.data(),
+                                    compressedSizes.data(),
+                                    uncompressedOutput.data(), sizes.data()) ||
+      uncompressed != data)
+  {
+    cerr << compressor->GetClassName() << " failed to uncompress the blocks"
+         << endl;
+    return 1;
+  }
+  return 0;
+}
+}
+
+int TestDataCompressorCopies(int, char*[])
+{
+  int numFailures = 0;
+
+  vtkNew<vtkMarkedZLibCompressor> marked;
+  marked->Marker = 42;
+  marked->SetCompressionLevel(9);
+  vtkSmartPointer<vtkDataCompressor> copy;
+  copy.TakeReference(marked->NewCopy());
+  vtkMarkedZLibCompressor* markedCopy =
+    vtkMarkedZLibCompressor::SafeDownCast(copy);
+  if (!markedCopy || markedCopy->Marker != 42 ||
+      markedCopy->GetCompressionLevel() != 9)
+  {
+    cerr << "The copy of vtkMarkedZLibCompressor is not the same" << endl;
+    ++numFailures;
+  }
+  numFailures += TestBlocks(marked);
+
+  vtkNew<vtkStoreCompressor> store;
+  copy.TakeReference(store->NewCopy());
+  if (copy)
+  {
+    cerr << "vtkStoreCompressor was copied" << endl;
+    ++numFailures;
+  }
+  numFailures += TestBlocks(store);
+
+  return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,5 +14,6 @@ vtk_module(vtkIOCore
     vtklz4
     vtksys
     vtkutf8
+    vtkzfp
     vtkzlib
   )
@@ -0,0 +1,478 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkASCIINumberParser.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkASCIINumberParser.h"
+#include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <vector>
+
+vtkStandardNewMacro(vtkASCIINumberParser);
+
+namespace
+{
+
+inline bool vtkASCIINumberParserIsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+inline const char* vtkASCIINumberParserSkipSpaces(const char* p,
+                                                  const char* end)
+{
+  while (p != end && vtkASCIINumberParser::IsSpace(*p))
+  {
+    ++p;
+  }
+  return p;
+}
+
+inline bool vtkASCIINumberParserAtDelimiter(const char* p, const char* end)
+{
+  return p == end || vtkASCIINumberParser::IsSpace(*p);
+}
+
+//----------------------------------------------------------------------------
+// Integers.  The magnitude is accumulated in 64 bits, then checked against
+// the range of the type.
+template <class T>
+const char* vtkASCIINumberParserParseInteger(const char* p, const char* end,
+                                             T& value)
+{
+  p = vtkASCIINumberParserSkipSpaces(p, end);
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = *p++ == '-';
+  }
+  const char* digits = p;
+  unsigned long long magnitude = 0;
+  const unsigned long long maxMagnitude =
+    std::numeric_limits<unsigned long long>::max();
+  for (; p != end && vtkASCIINumberParserIsDigit(*p); ++p)
+  {
+    unsigned long long digit = static_cast<unsigned long long>(*p - '0');
+    if (magnitude > (maxMagnitude - digit) / 10)
+    {
+      return nullptr;
+    }
+    magnitude = magnitude * 10 + digit;
+  }
+  if (p == digits || !vtkASCIINumberParserAtDelimiter(p, end))
+  {
+    return nullptr;
+  }
+
+  if (std::numeric_limits<T>::is_signed)
+  {
+    const unsigned long long maxValue =
+      static_cast<unsigned long long>(std::numeric_limits<T>::max());
+    if (magnitude > maxValue + (negative ? 1 : 0))
+    {
+      return nullptr;
+    }
+    // Negate magnitude - 1 to parse the smallest value too.
+    value = negative && magnitude > 0 ?
+      static_cast<T>(-static_cast<long long>(magnitude - 1) - 1) :
+      static_cast<T>(magnitude);
+  }
+  else
+  {
+    // Like strtoul(), negative values wrap around.
+    if (magnitude >
+        static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+    {
+      return nullptr;
+    }
+    value = static_cast<T>(negative ? 0 - magnitude : magnitude);
+  }
+  return p;
+}
+
+// The legacy readers read the char types as int and cast them.
+template <class T>
+const char* vtkASCIINumberParserParseCharacter(const char* p, const char* end,
+                                               T& value)
+{
+  int intValue;
+  p = vtkASCIINumberParserParseInteger(p, end, intValue);
+  if (p)
+  {
+    value = static_cast<T>(intValue);
+  }
+  return p;
+}
+
+//----------------------------------------------------------------------------
+// Floating-point numbers.  The decimal significand and exponent are parsed
+// exactly; when the significand and the power of ten are both exactly
+// representable, a single multiplication or division rounds correctly.
+// Other numbers are converted by strtod() or strtof().
+
+const double vtkASCIINumberParserPowersOf10[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+  1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Convert the number of [begin, end) with the C library, which follows the
+// decimal point of the current locale.
+template <class T>
+bool vtkASCIINumberParserConvert(const char* begin, const char* end,
+                                 T& value)
+{
+  std::string number(begin, end);
+  const char* point = localeconv()->decimal_point;
+  if (point && (point[0] != '.' || point[1] != '\0'))
+  {
+    size_t pos = number.find('.');
+    if (pos != std::string::npos)
+    {
+      number.replace(pos, 1, point);
+    }
+  }
+  const char* str = number.c_str();
+  char* last = nullptr;
+  double result = sizeof(T) == sizeof(float) ?
+    static_cast<double>(strtof(str, &last)) : strtod(str, &last);
+  if (last != str + number.size())
+  {
+    return false;
+  }
+  value = static_cast<T>(result);
+  return true;
+}
+
+// The decimal significand holds at most 19 digits.
+const int vtkASCIINumberParserMaxDigits = 19;
+
+template <class T>
+const char* vtkASCIINumberParserParseReal(const char* p, const char* end,
+                                          T& value)
+{
+  p = vtkASCIINumberParserSkipSpaces(p, end);
+  const char* begin = p;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = *p++ == '-';
+  }
+
+  unsigned long long significand = 0;
+  int numDigits = 0;
+  int exponent = 0;
+  bool truncated = false;
+  bool anyDigit = false;
+  for (; p != end && vtkASCIINumberParserIsDigit(*p); ++p)
+  {
+    anyDigit = true;
+    if (numDigits < vtkASCIINumberParserMaxDigits)
+    {
+      significand = significand * 10 + static_cast<unsigned>(*p - '0');
+      numDigits += significand != 0;
+    }
+    else
+    {
+      truncated = truncated || *p != '0';
+      ++exponent;
+    }
+  }
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && vtkASCIINumberParserIsDigit(*p); ++p)
+    {
+      anyDigit = true;
+      if (numDigits < vtkASCIINumberParserMaxDigits)
+      {
+        significand = significand * 10 + static_cast<unsigned>(*p - '0');
+        numDigits += significand != 0;
+        --exponent;
+      }
+      else
+      {
+        truncated = truncated || *p != '0';
+      }
+    }
+  }
+  if (!anyDigit)
+  {
+    // nan, inf and such
+    while (p != end && !vtkASCIINumberParser::IsSpace(*p))
+    {
+      ++p;
+    }
+    return vtkASCIINumberParserConvert(begin, p, value) ? p : nullptr;
+  }
+  if (p != end && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    bool negativeExponent = false;
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+      negativeExponent = *p++ == '-';
+    }
+    if (p == end || !vtkASCIINumberParserIsDigit(*p))
+    {
+      return nullptr;
+    }
+    int explicitExponent = 0;
+    for (; p != end && vtkASCIINumberParserIsDigit(*p); ++p)
+    {
+      if (explicitExponent < 100000)
+      {
+        explicitExponent = explicitExponent * 10 + (*p - '0');
+      }
+    }
+    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+  }
+  if (!vtkASCIINumberParserAtDelimiter(p, end))
+  {
+    return nullptr;
+  }
+
+  const unsigned long long maxExact = 1ull << 53;
+  if (!truncated && significand <= maxExact &&
+      exponent >= -22 && exponent <= 22)
+  {
+    double result = static_cast<double>(significand);
+    result = exponent < 0 ?
+      result / vtkASCIINumberParserPowersOf10[-exponent] :
+      result * vtkASCIINumberParserPowersOf10[exponent];
+    result = negative ? -result : result;
+    if (sizeof(T) == sizeof(double))
+    {
+      value = static_cast<T>(result);
+      return p;
+    }
+    // Rounding the double to a float rounds correctly, unless the double
+    // is halfway between two floats.
+    float rounded = static_cast<float>(result);
+    float other = std::nextafter(rounded, result > rounded ?
+                                 std::numeric_limits<float>::max() :
+                                 std::numeric_limits<float>::lowest());
+    double error = std::abs(static_cast<double>(rounded) - result);
+    if (error == 0.0 ||
+        error != std::abs(static_cast<double>(other) - result))
+    {
+      value = static_cast<T>(rounded);
+      return p;
+    }
+  }
+  return vtkASCIINumberParserConvert(begin, p, value) ? p : nullptr;
+}
+
+//----------------------------------------------------------------------------
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             char& value)
+{
+  return vtkASCIINumberParserParseCharacter(p, end, value);
+}
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             signed char& value)
+{
+  return vtkASCIINumberParserParseCharacter(p, end, value);
+}
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             unsigned char& value)
+{
+  return vtkASCIINumberParserParseCharacter(p, end, value);
+}
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             float& value)
+{
+  return vtkASCIINumberParserParseReal(p, end, value);
+}
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             double& value)
+{
+  return vtkASCIINumberParserParseReal(p, end, value);
+}
+template <class T>
+inline const char* vtkASCIINumberParserParse(const char* p, const char* end,
+                                             T& value)
+{
+  return vtkASCIINumberParserParseInteger(p, end, value);
+}
+
+//----------------------------------------------------------------------------
+// Parse at most numValues values sequentially.
+template <class T>
+const char* vtkASCIINumberParserParseSequential(const char* p,
+                                                const char* end, T* values,
+                                                size_t& numValues)
+{
+  size_t i = 0;
+  for (; i < numValues; ++i)
+  {
+    p = vtkASCIINumberParserSkipSpaces(p, end);
+    if (p == end)
+    {
+      break;
+    }
+    p = vtkASCIINumberParserParse(p, end, values[i]);
+    if (!p)
+    {
+      return nullptr;
+    }
+  }
+  numValues = i;
+  return p;
+}
+
+// The chunks of a large text, which start and end on white space so that
+// no number is split.  The numbers of each chunk are counted, then parsed,
+// in parallel.
+template <class T>
+struct vtkASCIINumberParserChunks
+{
+  std::vector<const char*> Bounds;
+  std::vector<size_t> Counts;
+  std::vector<size_t> Offsets;
+  std::vector<const char*> Ends;
+  T* Values;
+  size_t NumValues;
+  bool Counting;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType c = begin; c < end; ++c)
+    {
+      const char* p = this->Bounds[c];
+      const char* last = this->Bounds[c + 1];
+      if (this->Counting)
+      {
+        size_t count = 0;
+        bool inToken = false;
+        for (; p != last; ++p)
+        {
+          bool space = vtkASCIINumberParser::IsSpace(*p);
+          count += !space && !inToken;
+          inToken = !space;
+        }
+        this->Counts[c] = count;
+      }
+      else if (this->Offsets[c] < this->NumValues)
+      {
+        size_t count = std::min(this->Counts[c],
+                                this->NumValues - this->Offsets[c]);
+        this->Ends[c] = vtkASCIINumberParserParseSequential(
+          p, last, this->Values + this->Offsets[c], count);
+      }
+    }
+  }
+};
+
+// Texts shorter than this are parsed sequentially.
+const size_t vtkASCIINumberParserMinParallelSize = 1 << 20;
+
+template <class T>
+const char* vtkASCIINumberParserParseValues(const char* begin,
+                                            const char* end, T* values,
+                                            size_t& numValues)
+{
+  size_t size = static_cast<size_t>(end - begin);
+  int numThreads = vtkSMPTools::GetEstimatedNumberOfThreads();
+  if (size < vtkASCIINumberParserMinParallelSize || numThreads < 2 ||
+      numValues < 2)
+  {
+    return vtkASCIINumberParserParseSequential(begin, end, values,
+                                               numValues);
+  }
+
+  vtkASCIINumberParserChunks<T> chunks;
+  size_t chunkSize = std::max(size / (8 * static_cast<size_t>(numThreads)),
+                              static_cast<size_t>(1 << 16));
+  chunks.Bounds.push_back(begin);
+  for (const char* p = begin + chunkSize; p < end; p += chunkSize)
+  {
+    while (p != end && !vtkASCIINumberParser::IsSpace(*p))
+    {
+      ++p;
+    }
+    if (p != end)
+    {
+      chunks.Bounds.push_back(p);
+    }
+  }
+  chunks.Bounds.push_back(end);
+  vtkIdType numChunks = static_cast<vtkIdType>(chunks.Bounds.size() - 1);
+  chunks.Counts.resize(numChunks);
+  chunks.Offsets.resize(numChunks);
+  chunks.Ends.resize(numChunks, nullptr);
+  chunks.Values = values;
+  chunks.NumValues = numValues;
+
+  chunks.Counting = true;
+  vtkSMPTools::For(0, numChunks, 1, chunks);
+  size_t total = 0;
+  vtkIdType lastChunk = -1;
+  for (vtkIdType c = 0; c < numChunks; ++c)
+  {
+    chunks.Offsets[c] = total;
+    if (total < numValues && chunks.Counts[c] > 0)
+    {
+      lastChunk = c;
+    }
+    total += chunks.Counts[c];
+  }
+  chunks.Counting = false;
+  vtkSMPTools::For(0, numChunks, 1, chunks);
+
+  for (vtkIdType c = 0; c <= lastChunk; ++c)
+  {
+    if (chunks.Offsets[c] < numValues && !chunks.Ends[c])
+    {
+      return nullptr;
+    }
+  }
+  numValues = std::min(numValues, total);
+  return lastChunk < 0 ? begin : chunks.Ends[lastChunk];
+}
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+#define VTK_ASCII_NUMBER_PARSER_DEF(T)                                      \
+  const char* vtkASCIINumberParser::Parse(const char* begin,               \
+                                          const char* end, T& value)       \
+  {                                                                         \
+    return vtkASCIINumberParserParse(begin, end, value);                    \
+  }                                                                         \
+  const char* vtkASCIINumberParser::ParseValues(const char* begin,         \
+                                                const char* end,           \
+                                                T* values,                 \
+                                                size_t& numValues)         \
+  {                                                                         \
+    return vtkASCIINumberParserParseValues(begin, end, values, numValues);  \
+  }
+VTK_ASCII_NUMBER_PARSER_DEF(char);
+VTK_ASCII_NUMBER_PARSER_DEF(signed char);
+VTK_ASCII_NUMBER_PARSER_DEF(unsigned char);
+VTK_ASCII_NUMBER_PARSER_DEF(short);
+VTK_ASCII_NUMBER_PARSER_DEF(unsigned short);
+VTK_ASCII_NUMBER_PARSER_DEF(int);
+VTK_ASCII_NUMBER_PARSER_DEF(unsigned int);
+VTK_ASCII_NUMBER_PARSER_DEF(long);
+VTK_ASCII_NUMBER_PARSER_DEF(unsigned long);
+VTK_ASCII_NUMBER_PARSER_DEF(long long);
+VTK_ASCII_NUMBER_PARSER_DEF(unsigned long long);
+VTK_ASCII_NUMBER_PARSER_DEF(float);
+VTK_ASCII_NUMBER_PARSER_DEF(double);
+#undef VTK_ASCII_NUMBER_PARSER_DEF
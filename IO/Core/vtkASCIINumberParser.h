@@ -0,0 +1,95 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkASCIINumberParser.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkASCIINumberParser
+ * @brief   parse numbers from ASCII text
+ *
+ * vtkASCIINumberParser parses whitespace-separated numbers from a buffer of
+ * text, much faster than the stream operators: the numbers are parsed in
+ * place, always in the classic "C" locale, and large texts are split into
+ * chunks parsed by several threads (via vtkSMPTools). It is used by the
+ * readers of ASCII files.
+ *
+ * The integers are decimal, with an optional sign. char, signed char and
+ * unsigned char values are parsed as integers, like the legacy VTK readers
+ * do. The floating-point numbers are read like strtod() does, and are
+ * rounded correctly.
+*/
+
+#ifndef vtkASCIINumberParser_h
+#define vtkASCIINumberParser_h
+
+#include "vtkIOCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class VTKIOCORE_EXPORT vtkASCIINumberParser : public vtkObject
+{
+public:
+  static vtkASCIINumberParser *New();
+  vtkTypeMacro(vtkASCIINumberParser,vtkObject);
+
+  //@{
+  /**
+   * Parse(begin, end, value) parses the number that starts [begin, end)
+   * after white space. It returns a pointer past the number, or nullptr if
+   * there is no number, if it is out of the range of the type, or if it is
+   * not followed by white space or by the end of the text.
+   *
+   * ParseValues(begin, end, values, numValues) parses at most numValues
+   * numbers from [begin, end), with several threads for large texts. It
+   * sets numValues to the number of values parsed, and returns a pointer
+   * past the last value parsed (begin if none), or nullptr if some text is
+   * not a number.
+   */
+#define VTK_ASCII_NUMBER_PARSER_DECL(T)                                 \
+  static const char* Parse(const char* begin, const char* end,         \
+                           T& value);                                   \
+  static const char* ParseValues(const char* begin, const char* end,   \
+                                 T* values, size_t& numValues)
+  VTK_ASCII_NUMBER_PARSER_DECL(char);
+  VTK_ASCII_NUMBER_PARSER_DECL(signed char);
+  VTK_ASCII_NUMBER_PARSER_DECL(unsigned char);
+  VTK_ASCII_NUMBER_PARSER_DECL(short);
+  VTK_ASCII_NUMBER_PARSER_DECL(unsigned short);
+  VTK_ASCII_NUMBER_PARSER_DECL(int);
+  VTK_ASCII_NUMBER_PARSER_DECL(unsigned int);
+  VTK_ASCII_NUMBER_PARSER_DECL(long);
+  VTK_ASCII_NUMBER_PARSER_DECL(unsigned long);
+  VTK_ASCII_NUMBER_PARSER_DECL(long long);
+  VTK_ASCII_NUMBER_PARSER_DECL(unsigned long long);
+  VTK_ASCII_NUMBER_PARSER_DECL(float);
+  VTK_ASCII_NUMBER_PARSER_DECL(double);
+#undef VTK_ASCII_NUMBER_PARSER_DECL
+  //@}
+
+  /**
+   * Return true for the white space characters separating the numbers.
+   */
+  static bool IsSpace(char c)
+  {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+
+protected:
+  vtkASCIINumberParser() {}
+  ~vtkASCIINumberParser() override {}
+
+private:
+  vtkASCIINumberParser(const vtkASCIINumberParser&) = delete;
+  void operator=(const vtkASCIINumberParser&) = delete;
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkASCIINumberParser.h
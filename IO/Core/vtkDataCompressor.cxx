@@ -13,8 +13,110 @@
 
 =========================================================================*/
 #include "vtkDataCompressor.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <vector>
+
+namespace
+{
+
+// Compress or uncompress a range of blocks, each thread with its own copy of
+// the compressor.
+struct vtkDataCompressorBlocks
+{
+  vtkDataCompressor* Compressor;
+  bool Compress;
+  unsigned char const* const* Input;
+  size_t const* InputSizes;
+  unsigned char* const* Output;
+  size_t const* OutputSizes;
+  size_t* Results;
+  vtkSMPThreadLocal<vtkDataCompressor*> Copies;
+
+  vtkDataCompressorBlocks(vtkDataCompressor* compressor, bool compress,
+                          unsigned char const* const* input,
+                          size_t const* inputSizes,
+                          unsigned char* const* output,
+                          size_t const* outputSizes, size_t* results)
+    : Compressor(compressor), Compress(compress), Input(input),
+      InputSizes(inputSizes), Output(output), OutputSizes(outputSizes),
+      Results(results), Copies(nullptr)
+  {
+  }
+
+  ~vtkDataCompressorBlocks()
+  {
+    for (auto it = this->Copies.begin(); it != this->Copies.end(); ++it)
+    {
+      if (*it)
+      {
+        (*it)->Delete();
+      }
+    }
+  }
+
+  void Initialize()
+  {
+    vtkDataCompressor*& copy = this->Copies.Local();
+    if (!copy)
+    {
+      copy = this->Compressor->NewCopy();
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataCompressor* compressor = this->Copies.Local();
+    this->Process(compressor, begin, end);
+  }
+
+  void Reduce()
+  {
+  }
+
+  void Process(vtkDataCompressor* compressor, vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      if (this->Compress)
+      {
+        this->Results[i] = compressor->Compress(
+          this->Input[i], this->InputSizes[i], this->Output[i],
+          compressor->GetMaximumCompressionSpace(this->InputSizes[i]));
+      }
+      else
+      {
+        this->Results[i] = compressor->Uncompress(
+          this->Input[i], this->InputSizes[i], this->Output[i],
+          this->OutputSizes[i]);
+      }
+    }
+  }
+};
+
+// Process the blocks concurrently when the compressor can be copied, else
+// sequentially. The first copy goes to the calling thread.
+void vtkDataCompressorProcessBlocks(vtkDataCompressorBlocks& blocks,
+                                    size_t numBlocks)
+{
+  vtkIdType n = static_cast<vtkIdType>(numBlocks);
+  if (n > 1 && vtkSMPTools::GetEstimatedNumberOfThreads() > 1)
+  {
+    vtkDataCompressor* copy = blocks.Compressor->NewCopy();
+    if (copy)
+    {
+      blocks.Copies.Local() = copy;
+      vtkSMPTools::For(0, n, 1, blocks);
+      return;
+    }
+  }
+  blocks.Process(blocks.Compressor, 0, n);
+}
+
+} // anonymous namespace
+
 
 //----------------------------------------------------------------------------
 vtkDataCompressor::vtkDataCompressor()
@@ -32,6 +134,17 @@ void vtkDataCompressor::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 }
 
+//----------------------------------------------------------------------------
+void vtkDataCompressor::SetDataDescription(int, int, const int*)
+{
+}
+
+//----------------------------------------------------------------------------
+size_t vtkDataCompressor::GetPreferredBlockSize(size_t blockSize)
+{
+  return blockSize;
+}
+
 //----------------------------------------------------------------------------
 size_t
 vtkDataCompressor::Compress(unsigned char const* uncompressedData,
@@ -116,3 +229,62 @@ vtkDataCompressor::Uncompress(unsigned char const* compressedData,
 
   return outputArray;
 }
+
+//----------------------------------------------------------------------------
+vtkDataCompressor* vtkDataCompressor::NewCopy()
+{
+  vtkDataCompressor* copy = this->NewInstance();
+  if (!copy->CopySettings(this))
+  {
+    copy->Delete();
+    return nullptr;
+  }
+  return copy;
+}
+
+//----------------------------------------------------------------------------
+bool vtkDataCompressor::CopySettings(vtkDataCompressor*)
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+bool vtkDataCompressor::CompressBlocks(
+  size_t numBlocks, unsigned char const* const* uncompressedData,
+  size_t const* uncompressedSizes, unsigned char* const* compressedData,
+  size_t* compressedSizes)
+{
+  vtkDataCompressorBlocks blocks(this, true, uncompressedData,
+                                 uncompressedSizes, compressedData, nullptr,
+                                 compressedSizes);
+  vtkDataCompressorProcessBlocks(blocks, numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    if (!compressedSizes[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkDataCompressor::UncompressBlocks(
+  size_t numBlocks, unsigned char const* const* compressedData,
+  size_t const* compressedSizes, unsigned char* const* uncompressedData,
+  size_t const* uncompressedSizes)
+{
+  std::vector<size_t> results(numBlocks);
+  vtkDataCompressorBlocks blocks(this, false, compressedData, compressedSizes,
+                                 uncompressedData, uncompressedSizes,
+                                 results.data());
+  vtkDataCompressorProcessBlocks(blocks, numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    if (!results[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
@@ -20,6 +20,11 @@
  * compression.  Subclasses provide one compression method and one
  * decompression method.  The public interface to all compressors
  * remains the same, and is defined by this class.
+ *
+ * CompressBlocks() and UncompressBlocks() process several independent
+ * blocks of data at once. When the compressor can be copied (see
+ * NewCopy()), the blocks are processed concurrently (via vtkSMPTools), each
+ * thread using its own copy of the compressor.
 */
 
 #ifndef vtkDataCompressor_h
@@ -84,6 +89,59 @@ public:
                                    size_t compressedSize,
                                    size_t uncompressedSize);
 
+  /**
+   * Return a new compressor of the same class and with the same settings,
+   * with a reference count of 1, or nullptr if the compressor cannot be
+   * copied. The copy is made with NewInstance() and CopySettings(), so that
+   * it keeps the overrides of the subclasses. The copies are used to
+   * compress or uncompress blocks from several threads at once.
+   */
+  vtkDataCompressor* NewCopy();
+
+  /**
+   * Describe the data compressed next: the VTK type of their values (or
+   * VTK_VOID when unknown or not in the native byte order), the number of
+   * components of the values, and the point or cell dimensions of the grid
+   * they are attached to (nullptr when the data are not structured).
+   * Compressors specialized for some data, like vtkZFPDataCompressor, use
+   * it; the others ignore it.
+   */
+  virtual void SetDataDescription(int dataType, int numberOfComponents,
+                                  const int dimensions[3]);
+
+  /**
+   * Return the size of the blocks in which to split the data described by
+   * SetDataDescription(), close to the requested size. The default returns
+   * the requested size. vtkZFPDataCompressor adjusts it so that the blocks
+   * hold whole tuples, and whole rows or slices of the grid.
+   */
+  virtual size_t GetPreferredBlockSize(size_t blockSize);
+
+  /**
+   * Compress numBlocks independent blocks of data. The i-th block of
+   * uncompressedSizes[i] bytes is compressed into compressedData[i], which
+   * must hold at least GetMaximumCompressionSpace(uncompressedSizes[i])
+   * bytes, and compressedSizes[i] receives the size of the compressed data,
+   * or zero on error. Returns true if all the blocks were compressed.
+   */
+  bool CompressBlocks(size_t numBlocks,
+                      unsigned char const* const* uncompressedData,
+                      size_t const* uncompressedSizes,
+                      unsigned char* const* compressedData,
+                      size_t* compressedSizes);
+
+  /**
+   * Uncompress numBlocks independent blocks of data. The i-th block of
+   * compressedSizes[i] bytes is uncompressed into uncompressedData[i], whose
+   * size uncompressedSizes[i] must be known by the caller. Returns true if
+   * all the blocks were uncompressed.
+   */
+  bool UncompressBlocks(size_t numBlocks,
+                        unsigned char const* const* compressedData,
+                        size_t const* compressedSizes,
+                        unsigned char* const* uncompressedData,
+                        size_t const* uncompressedSizes);
+
 protected:
   vtkDataCompressor();
   ~vtkDataCompressor() override;
@@ -100,6 +158,14 @@ protected:
                                   size_t compressedSize,
                                   unsigned char* uncompressedData,
                                   size_t uncompressedSize)=0;
+
+  // Copy the settings of the given compressor, of the same class as this
+  // one, and return true if this compressor can then be used in its place.
+  // The default copies nothing and returns false, so that NewCopy() returns
+  // nullptr. The subclasses that can be copied override it to copy their
+  // settings; their own subclasses call it first, then copy theirs.
+  virtual bool CopySettings(vtkDataCompressor* source);
+
 private:
   vtkDataCompressor(const vtkDataCompressor&) = delete;
   void operator=(const vtkDataCompressor&) = delete;
@@ -92,3 +92,15 @@ vtkLZ4DataCompressor::GetMaximumCompressionSpace(size_t size)
 {
   return LZ4_COMPRESSBOUND(size);
 }
+
+//----------------------------------------------------------------------------
+bool vtkLZ4DataCompressor::CopySettings(vtkDataCompressor* source)
+{
+  vtkLZ4DataCompressor* other = vtkLZ4DataCompressor::SafeDownCast(source);
+  if (!other)
+  {
+    return false;
+  }
+  this->AccelerationLevel = other->AccelerationLevel;
+  return true;
+}
@@ -58,6 +58,10 @@ protected:
                           size_t compressedSize,
                           unsigned char* uncompressedData,
                           size_t uncompressedSize) override;
+
+  // Copy the AccelerationLevel, so that the compressor can be copied.
+  bool CopySettings(vtkDataCompressor* source) override;
+
 private:
   vtkLZ4DataCompressor(const vtkLZ4DataCompressor&) = delete;
   void operator=(const vtkLZ4DataCompressor&) = delete;
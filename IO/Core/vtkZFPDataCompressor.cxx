@@ -0,0 +1,487 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkZFPDataCompressor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkZFPDataCompressor.h"
+#include "vtkObjectFactory.h"
+#include "vtk_zfp.h"
+#include "vtk_zlib.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+vtkStandardNewMacro(vtkZFPDataCompressor);
+
+// zfp 0.5.4 introduced the reversible (lossless) mode.
+#if ZFP_VERSION >= 0x0054
+#define VTK_ZFP_HAS_REVERSIBLE
+#endif
+
+namespace
+{
+
+// The first byte of a compressed block tells how it was compressed. The
+// second byte of zfp blocks is the number of interleaved components, and is
+// followed by the zfp stream with a full zfp header.
+enum
+{
+  LosslessBlock = 0,
+  ZFPBlock = 1
+};
+const size_t ZFPBlockPrefixSize = 2;
+
+// zfp records the sizes of fields with 16 bits in 3D and 24 bits in 2D.
+const size_t ZFPMax3DSize = size_t(1) << 16;
+const size_t ZFPMax2DSize = size_t(1) << 24;
+
+// The size of the values of the given type compressed with zfp, or zero.
+size_t vtkZFPDataCompressorGetTypeSize(int dataType)
+{
+  switch (dataType)
+  {
+    case VTK_FLOAT:
+      return sizeof(float);
+    case VTK_DOUBLE:
+      return sizeof(double);
+    default:
+      return 0;
+  }
+}
+
+// Get the dimensions of the grid that are not flat, and return their number.
+int vtkZFPDataCompressorGetDimensions(const int dimensions[3], size_t dims[3])
+{
+  dims[0] = dims[1] = dims[2] = 0;
+  int numDims = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (dimensions[i] > 1)
+    {
+      dims[numDims++] = static_cast<size_t>(dimensions[i]);
+    }
+  }
+  return numDims;
+}
+
+// Create a field of the given sizes whose values are the components of
+// numberOfComponents interleaved components. The data pointer is set later.
+zfp_field* vtkZFPDataCompressorNewField(zfp_type type, int numberOfComponents,
+                                        const unsigned int sizes[3])
+{
+  zfp_field* field;
+  if (sizes[2])
+  {
+    field = zfp_field_3d(nullptr, type, sizes[0], sizes[1], sizes[2]);
+  }
+  else if (sizes[1])
+  {
+    field = zfp_field_2d(nullptr, type, sizes[0], sizes[1]);
+  }
+  else
+  {
+    field = zfp_field_1d(nullptr, type, sizes[0]);
+  }
+  if (numberOfComponents > 1)
+  {
+    int sx = numberOfComponents;
+    int sy = sx * static_cast<int>(sizes[0]);
+    int sz = sy * static_cast<int>(sizes[1]);
+    zfp_field_set_stride_3d(field, sx, sy, sz);
+  }
+  return field;
+}
+
+// Set the compression parameters of the stream for the given field.
+bool vtkZFPDataCompressorSetMode(vtkZFPDataCompressor* self, zfp_stream* zfp,
+                                 const zfp_field* field)
+{
+  zfp_type type = zfp_field_type(field);
+  switch (self->GetMode())
+  {
+    case vtkZFPDataCompressor::FIXED_RATE:
+      zfp_stream_set_rate(zfp, self->GetRate(), type,
+                          zfp_field_dimensionality(field), 0);
+      return true;
+    case vtkZFPDataCompressor::FIXED_PRECISION:
+      zfp_stream_set_precision(zfp, self->GetPrecision(), type);
+      return true;
+    case vtkZFPDataCompressor::FIXED_ACCURACY:
+      zfp_stream_set_accuracy(zfp, self->GetTolerance(), type);
+      return true;
+#ifdef VTK_ZFP_HAS_REVERSIBLE
+    case vtkZFPDataCompressor::REVERSIBLE:
+      zfp_stream_set_reversible(zfp);
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+vtkZFPDataCompressor::vtkZFPDataCompressor()
+{
+  this->Mode = FIXED_PRECISION;
+  this->Rate = 16.0;
+  this->Precision = 32;
+  this->Tolerance = 1e-6;
+  this->DataType = VTK_VOID;
+  this->NumberOfComponents = 1;
+  this->Dimensions[0] = this->Dimensions[1] = this->Dimensions[2] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkZFPDataCompressor::~vtkZFPDataCompressor()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkZFPDataCompressor::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Mode: " << this->Mode << endl;
+  os << indent << "Rate: " << this->Rate << endl;
+  os << indent << "Precision: " << this->Precision << endl;
+  os << indent << "Tolerance: " << this->Tolerance << endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkZFPDataCompressor::SetDataDescription(int dataType,
+                                              int numberOfComponents,
+                                              const int dimensions[3])
+{
+  this->DataType = dataType;
+  this->NumberOfComponents = numberOfComponents;
+  for (int i = 0; i < 3; ++i)
+  {
+    this->Dimensions[i] = dimensions ? dimensions[i] : 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+size_t vtkZFPDataCompressor::GetPreferredBlockSize(size_t blockSize)
+{
+  size_t tupleSize = vtkZFPDataCompressorGetTypeSize(this->DataType);
+  if (tupleSize == 0)
+  {
+    return blockSize;
+  }
+  if (this->NumberOfComponents > 1 && this->NumberOfComponents <= 255)
+  {
+    tupleSize *= static_cast<size_t>(this->NumberOfComponents);
+  }
+
+  // Blocks of at least two whole slices are 3D fields, blocks of at least
+  // two whole rows 2D fields, and the others 1D streams of whole tuples.
+  size_t dims[3];
+  int numDims = vtkZFPDataCompressorGetDimensions(this->Dimensions, dims);
+  const size_t maxSize = size_t(1) << 24;
+  size_t unitSize = tupleSize;
+  size_t minUnits = 1;
+  size_t maxUnits = VTK_UNSIGNED_INT_MAX;
+  if (numDims == 3 && dims[0] <= ZFPMax3DSize && dims[1] <= ZFPMax3DSize &&
+      2 * dims[0] * dims[1] * tupleSize <= maxSize)
+  {
+    unitSize = dims[0] * dims[1] * tupleSize;
+    minUnits = 2;
+    maxUnits = ZFPMax3DSize;
+  }
+  else if (numDims >= 2 && dims[0] <= ZFPMax2DSize &&
+           2 * dims[0] * tupleSize <= maxSize)
+  {
+    unitSize = dims[0] * tupleSize;
+    minUnits = 2;
+    maxUnits = ZFPMax2DSize;
+  }
+  size_t numUnits = std::min(std::max(blockSize / unitSize, minUnits),
+                             maxUnits);
+  return numUnits * unitSize;
+}
+
+//----------------------------------------------------------------------------
+bool vtkZFPDataCompressor::GetFieldLayout(size_t size,
+                                          int& numberOfComponents,
+                                          unsigned int sizes[3])
+{
+  size_t typeSize = vtkZFPDataCompressorGetTypeSize(this->DataType);
+  if (typeSize == 0)
+  {
+    return false;
+  }
+#ifndef VTK_ZFP_HAS_REVERSIBLE
+  if (this->Mode == REVERSIBLE)
+  {
+    return false;
+  }
+#endif
+  if (size == 0 || size % typeSize != 0)
+  {
+    return false;
+  }
+
+  // Compress each component separately if the block holds whole tuples.
+  size_t numValues = size / typeSize;
+  numberOfComponents = this->NumberOfComponents;
+  if (numberOfComponents < 1 || numberOfComponents > 255 ||
+      numValues % numberOfComponents != 0)
+  {
+    numberOfComponents = 1;
+  }
+  size_t numTuples = numValues / numberOfComponents;
+
+  // Ignore the flat dimensions of the grid.
+  size_t dims[3];
+  int numDims = vtkZFPDataCompressorGetDimensions(this->Dimensions, dims);
+
+  // Blocks of whole slices are 3D fields, blocks of whole rows 2D fields.
+  const size_t max3D = ZFPMax3DSize;
+  const size_t max2D = ZFPMax2DSize;
+  sizes[0] = static_cast<unsigned int>(numTuples);
+  sizes[1] = sizes[2] = 0;
+  if (numDims >= 2 && numTuples % (dims[0] * dims[1]) == 0 &&
+      numTuples / (dims[0] * dims[1]) > 1 && dims[0] <= max3D &&
+      dims[1] <= max3D && numTuples / (dims[0] * dims[1]) <= max3D)
+  {
+    sizes[0] = static_cast<unsigned int>(dims[0]);
+    sizes[1] = static_cast<unsigned int>(dims[1]);
+    sizes[2] = static_cast<unsigned int>(numTuples / (dims[0] * dims[1]));
+  }
+  else if (numDims >= 1 && numTuples % dims[0] == 0 &&
+           numTuples / dims[0] > 1 && dims[0] <= max2D &&
+           numTuples / dims[0] <= max2D)
+  {
+    sizes[0] = static_cast<unsigned int>(dims[0]);
+    sizes[1] = static_cast<unsigned int>(numTuples / dims[0]);
+  }
+  else if (numTuples > VTK_UNSIGNED_INT_MAX)
+  {
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+size_t
+vtkZFPDataCompressor::CompressBuffer(unsigned char const* uncompressedData,
+                                     size_t uncompressedSize,
+                                     unsigned char* compressedData,
+                                     size_t compressionSpace)
+{
+  int numberOfComponents;
+  unsigned int sizes[3];
+  if (!this->GetFieldLayout(uncompressedSize, numberOfComponents, sizes))
+  {
+    return this->CompressLossless(uncompressedData, uncompressedSize,
+                                  compressedData, compressionSpace);
+  }
+
+  zfp_type type =
+    this->DataType == VTK_FLOAT ? zfp_type_float : zfp_type_double;
+  size_t typeSize = this->DataType == VTK_FLOAT ? sizeof(float) : sizeof(double);
+  zfp_field* field =
+    vtkZFPDataCompressorNewField(type, numberOfComponents, sizes);
+  zfp_stream* zfp = zfp_stream_open(nullptr);
+  vtkZFPDataCompressorSetMode(this, zfp, field);
+
+  // The bit stream works on 64-bit words, so it needs an aligned buffer.
+  size_t maxSize = numberOfComponents * zfp_stream_maximum_size(zfp, field);
+  std::vector<vtkTypeUInt64> buffer((maxSize + 7) / 8);
+  bitstream* stream =
+    stream_open(buffer.data(), buffer.size() * sizeof(vtkTypeUInt64));
+  zfp_stream_set_bit_stream(zfp, stream);
+
+  size_t zfpSize = 0;
+  if (zfp_write_header(zfp, field, ZFP_HEADER_FULL))
+  {
+    for (int c = 0; c < numberOfComponents; ++c)
+    {
+      zfp_field_set_pointer(
+        field, const_cast<unsigned char*>(uncompressedData) + c * typeSize);
+      zfpSize = zfp_compress(zfp, field);
+      if (!zfpSize)
+      {
+        break;
+      }
+    }
+  }
+
+  zfp_field_free(field);
+  zfp_stream_close(zfp);
+  stream_close(stream);
+
+  if (!zfpSize || ZFPBlockPrefixSize + zfpSize > compressionSpace)
+  {
+    vtkErrorMacro("zfp error while compressing data.");
+    return 0;
+  }
+  compressedData[0] = ZFPBlock;
+  compressedData[1] = static_cast<unsigned char>(numberOfComponents);
+  memcpy(compressedData + ZFPBlockPrefixSize, buffer.data(), zfpSize);
+  return ZFPBlockPrefixSize + zfpSize;
+}
+
+//----------------------------------------------------------------------------
+size_t
+vtkZFPDataCompressor::CompressLossless(unsigned char const* uncompressedData,
+                                       size_t uncompressedSize,
+                                       unsigned char* compressedData,
+                                       size_t compressionSpace)
+{
+  if (compressionSpace < 1)
+  {
+    vtkErrorMacro("Zlib error while compressing data.");
+    return 0;
+  }
+  uLongf cs = static_cast<uLongf>(compressionSpace - 1);
+  Bytef* cd = reinterpret_cast<Bytef*>(compressedData + 1);
+  const Bytef* ud = reinterpret_cast<const Bytef*>(uncompressedData);
+  uLong us = static_cast<uLong>(uncompressedSize);
+
+  // Call zlib's compress function.
+  if (compress2(cd, &cs, ud, us, Z_DEFAULT_COMPRESSION) != Z_OK)
+  {
+    vtkErrorMacro("Zlib error while compressing data.");
+    return 0;
+  }
+  compressedData[0] = LosslessBlock;
+  return static_cast<size_t>(cs) + 1;
+}
+
+//----------------------------------------------------------------------------
+size_t
+vtkZFPDataCompressor::UncompressBuffer(unsigned char const* compressedData,
+                                       size_t compressedSize,
+                                       unsigned char* uncompressedData,
+                                       size_t uncompressedSize)
+{
+  if (compressedSize > 0 && compressedData[0] == LosslessBlock)
+  {
+    uLongf us = static_cast<uLongf>(uncompressedSize);
+    Bytef* ud = reinterpret_cast<Bytef*>(uncompressedData);
+    const Bytef* cd = reinterpret_cast<const Bytef*>(compressedData + 1);
+    uLong cs = static_cast<uLong>(compressedSize - 1);
+    if (uncompress(ud, &us, cd, cs) != Z_OK)
+    {
+      vtkErrorMacro("Zlib error while uncompressing data.");
+      return 0;
+    }
+    if (us != static_cast<uLongf>(uncompressedSize))
+    {
+      vtkErrorMacro("Decompression produced incorrect size.\n"
+                    "Expected " << uncompressedSize << " and got " << us);
+      return 0;
+    }
+    return uncompressedSize;
+  }
+
+  if (compressedSize <= ZFPBlockPrefixSize || compressedData[0] != ZFPBlock ||
+      compressedData[1] == 0)
+  {
+    vtkErrorMacro("Invalid zfp compressed data.");
+    return 0;
+  }
+  int numberOfComponents = compressedData[1];
+
+  // Copy the stream to a buffer aligned for the bit stream.
+  size_t zfpSize = compressedSize - ZFPBlockPrefixSize;
+  std::vector<vtkTypeUInt64> buffer((zfpSize + 7) / 8, 0);
+  memcpy(buffer.data(), compressedData + ZFPBlockPrefixSize, zfpSize);
+  bitstream* stream =
+    stream_open(buffer.data(), buffer.size() * sizeof(vtkTypeUInt64));
+  zfp_stream* zfp = zfp_stream_open(stream);
+  zfp_field* field = zfp_field_alloc();
+
+  bool result = false;
+  if (zfp_read_header(zfp, field, ZFP_HEADER_FULL))
+  {
+    zfp_type type = zfp_field_type(field);
+    size_t typeSize = type == zfp_type_float ? sizeof(float) : sizeof(double);
+    unsigned int sizes[3] = { field->nx, field->ny, field->nz };
+    size_t size = zfp_field_size(field, nullptr) * numberOfComponents *
+                  typeSize;
+    if ((type == zfp_type_float || type == zfp_type_double) &&
+        size == uncompressedSize)
+    {
+      zfp_field* strided =
+        vtkZFPDataCompressorNewField(type, numberOfComponents, sizes);
+      result = true;
+      for (int c = 0; result && c < numberOfComponents; ++c)
+      {
+        zfp_field_set_pointer(strided, uncompressedData + c * typeSize);
+        result = zfp_decompress(zfp, strided) != 0;
+      }
+      zfp_field_free(strided);
+    }
+  }
+
+  zfp_field_free(field);
+  zfp_stream_close(zfp);
+  stream_close(stream);
+
+  if (!result)
+  {
+    vtkErrorMacro("zfp error while uncompressing data.");
+    return 0;
+  }
+  return uncompressedSize;
+}
+
+//----------------------------------------------------------------------------
+size_t
+vtkZFPDataCompressor::GetMaximumCompressionSpace(size_t size)
+{
+  // The data that zfp cannot compress are compressed with zlib, which needs
+  // a buffer 0.1% larger + 12 bytes.
+  size_t losslessSpace = 1 + size + (size+999)/1000 + 12;
+
+  int numberOfComponents;
+  unsigned int sizes[3];
+  if (!this->GetFieldLayout(size, numberOfComponents, sizes))
+  {
+    return losslessSpace;
+  }
+
+  zfp_type type =
+    this->DataType == VTK_FLOAT ? zfp_type_float : zfp_type_double;
+  zfp_field* field =
+    vtkZFPDataCompressorNewField(type, numberOfComponents, sizes);
+  zfp_stream* zfp = zfp_stream_open(nullptr);
+  vtkZFPDataCompressorSetMode(this, zfp, field);
+  size_t zfpSpace = ZFPBlockPrefixSize +
+                    numberOfComponents * zfp_stream_maximum_size(zfp, field);
+  zfp_field_free(field);
+  zfp_stream_close(zfp);
+
+  return std::max(losslessSpace, zfpSpace);
+}
+
+//----------------------------------------------------------------------------
+bool vtkZFPDataCompressor::CopySettings(vtkDataCompressor* source)
+{
+  vtkZFPDataCompressor* other = vtkZFPDataCompressor::SafeDownCast(source);
+  if (!other)
+  {
+    return false;
+  }
+  this->Mode = other->Mode;
+  this->Rate = other->Rate;
+  this->Precision = other->Precision;
+  this->Tolerance = other->Tolerance;
+  this->SetDataDescription(other->DataType, other->NumberOfComponents,
+                           other->Dimensions);
+  return true;
+}
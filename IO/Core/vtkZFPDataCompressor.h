@@ -0,0 +1,171 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkZFPDataCompressor.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkZFPDataCompressor
+ * @brief   Floating-point data compression using zfp.
+ *
+ * vtkZFPDataCompressor provides a concrete vtkDataCompressor class using
+ * the zfp library to compress floating-point arrays, lossily in the
+ * FIXED_RATE, FIXED_PRECISION and FIXED_ACCURACY modes, or losslessly in
+ * the REVERSIBLE mode.
+ *
+ * zfp needs to know the type and the layout of the values it compresses,
+ * which are given by SetDataDescription(). The components of the values
+ * are compressed separately. When the data are attached to a grid of
+ * known dimensions, the blocks holding whole XY slices of the grid are
+ * compressed as 3D fields, those holding whole rows as 2D fields, and the
+ * others as 1D streams. GetPreferredBlockSize() gives the block size to
+ * use for that, which vtkXMLWriter uses instead of its BlockSize.
+ *
+ * Data that zfp cannot compress (integers, data not in the native byte
+ * order or not described) are compressed losslessly with zlib instead.
+ * This is also the case of all the data in the REVERSIBLE mode when the zfp
+ * library is older than 0.5.4, which introduced reversible compression.
+ *
+ * Each compressed block records how it was compressed, so uncompressing
+ * needs no description of the data.
+*/
+
+#ifndef vtkZFPDataCompressor_h
+#define vtkZFPDataCompressor_h
+
+#include "vtkIOCoreModule.h" // For export macro
+#include "vtkDataCompressor.h"
+
+class VTKIOCORE_EXPORT vtkZFPDataCompressor : public vtkDataCompressor
+{
+public:
+  vtkTypeMacro(vtkZFPDataCompressor,vtkDataCompressor);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+  static vtkZFPDataCompressor* New();
+
+  /**
+   * The compression modes of zfp.
+   */
+  enum CompressionMode
+  {
+    FIXED_RATE,
+    FIXED_PRECISION,
+    FIXED_ACCURACY,
+    REVERSIBLE
+  };
+
+  //@{
+  /**
+   * Get/Set the compression mode. The default is FIXED_PRECISION.
+   */
+  vtkSetClampMacro(Mode, int, FIXED_RATE, REVERSIBLE);
+  vtkGetMacro(Mode, int);
+  void SetModeToFixedRate() { this->SetMode(FIXED_RATE); }
+  void SetModeToFixedPrecision() { this->SetMode(FIXED_PRECISION); }
+  void SetModeToFixedAccuracy() { this->SetMode(FIXED_ACCURACY); }
+  void SetModeToReversible() { this->SetMode(REVERSIBLE); }
+  //@}
+
+  //@{
+  /**
+   * Get/Set the number of compressed bits per value in the FIXED_RATE
+   * mode. The default is 16.
+   */
+  vtkSetClampMacro(Rate, double, 0.0, 64.0);
+  vtkGetMacro(Rate, double);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the number of uncompressed bit planes in the FIXED_PRECISION
+   * mode. The default is 32.
+   */
+  vtkSetClampMacro(Precision, int, 1, 64);
+  vtkGetMacro(Precision, int);
+  //@}
+
+  //@{
+  /**
+   * Get/Set the maximum absolute error in the FIXED_ACCURACY mode. The
+   * default is 1e-6.
+   */
+  vtkSetClampMacro(Tolerance, double, 0.0, VTK_DOUBLE_MAX);
+  vtkGetMacro(Tolerance, double);
+  //@}
+
+  /**
+   * Describe the data compressed next. Only VTK_FLOAT and VTK_DOUBLE data
+   * are compressed with zfp.
+   */
+  void SetDataDescription(int dataType, int numberOfComponents,
+                          const int dimensions[3]) override;
+
+  /**
+   * Round the requested size down to whole XY slices of the grid, or whole
+   * rows when the grid is 2D, but keep at least two of them (within 16 MB),
+   * so that the blocks are compressed as 3D or 2D fields. Without a grid,
+   * round it down to whole tuples. Return the requested size for data that
+   * zfp does not compress.
+   */
+  size_t GetPreferredBlockSize(size_t blockSize) override;
+
+  /**
+   * Get the maximum space that may be needed to store data of the
+   * given uncompressed size after compression, for the current
+   * description of the data.
+   */
+  size_t GetMaximumCompressionSpace(size_t size) override;
+
+protected:
+  vtkZFPDataCompressor();
+  ~vtkZFPDataCompressor() override;
+
+  int Mode;
+  double Rate;
+  int Precision;
+  double Tolerance;
+
+  int DataType;
+  int NumberOfComponents;
+  int Dimensions[3];
+
+  // Compression method required by vtkDataCompressor.
+  size_t CompressBuffer(unsigned char const* uncompressedData,
+                        size_t uncompressedSize,
+                        unsigned char* compressedData,
+                        size_t compressionSpace) override;
+  // Decompression method required by vtkDataCompressor.
+  size_t UncompressBuffer(unsigned char const* compressedData,
+                          size_t compressedSize,
+                          unsigned char* uncompressedData,
+                          size_t uncompressedSize) override;
+
+  // Copy the settings and the data description, so that the compressor can
+  // be copied.
+  bool CopySettings(vtkDataCompressor* source) override;
+
+  // Decide how a block of the given size is compressed with zfp: the number
+  // of interleaved components and the sizes of the field of each component
+  // (unused sizes are zero). Returns false if zfp cannot compress it.
+  bool GetFieldLayout(size_t size, int& numberOfComponents,
+                      unsigned int sizes[3]);
+
+  size_t CompressLossless(unsigned char const* uncompressedData,
+                          size_t uncompressedSize,
+                          unsigned char* compressedData,
+                          size_t compressionSpace);
+
+private:
+  vtkZFPDataCompressor(const vtkZFPDataCompressor&) = delete;
+  void operator=(const vtkZFPDataCompressor&) = delete;
+};
+
+#endif
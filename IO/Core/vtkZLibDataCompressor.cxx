@@ -96,3 +96,15 @@ vtkZLibDataCompressor::GetMaximumCompressionSpace(size_t size)
   // ZLib specifies that destination buffer must be 0.1% larger + 12 bytes.
   return size + (size+999)/1000 + 12;
 }
+
+//----------------------------------------------------------------------------
+bool vtkZLibDataCompressor::CopySettings(vtkDataCompressor* source)
+{
+  vtkZLibDataCompressor* other = vtkZLibDataCompressor::SafeDownCast(source);
+  if (!other)
+  {
+    return false;
+  }
+  this->CompressionLevel = other->CompressionLevel;
+  return true;
+}
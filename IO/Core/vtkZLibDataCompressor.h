@@ -65,6 +65,10 @@ protected:
                           size_t compressedSize,
                           unsigned char* uncompressedData,
                           size_t uncompressedSize) override;
+
+  // Copy the CompressionLevel, so that the compressor can be copied.
+  bool CopySettings(vtkDataCompressor* source) override;
+
 private:
   vtkZLibDataCompressor(const vtkZLibDataCompressor&) = delete;
   void operator=(const vtkZLibDataCompressor&) = delete;
@@ -0,0 +1,244 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSTLReaderMerging.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Read ASCII and binary STL files with the parallel merging of the points,
+// and compare with the points and triangles merged by a vtkPointLocator and
+// by a vtkMergePoints set as the locator.
+// Also check the solids of a multi-solid ASCII file and a parse error.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkExecutive.h"
+#include "vtkMergePoints.h"
+#include "vtkNew.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSTLReader.h"
+#include "vtkSTLWriter.h"
+#include "vtkTestErrorObserver.h"
+#include "vtkTestUtilities.h"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+bool SameArrays(vtkDataArray* a1, vtkDataArray* a2)
+{
+  if (!a1 || !a2 || a1->GetNumberOfValues() != a2->GetNumberOfValues())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a1->GetNumberOfValues(); ++i)
+  {
+    if (a1->GetVariantValue(i) != a2->GetVariantValue(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A wavy grid of triangles, with some degenerate triangles.
+void MakeMesh(vtkPolyData* mesh)
+{
+  const int n = 150;
+  vtkNew<vtkPoints> points;
+  for (int j = 0; j < n; ++j)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      points->InsertNextPoint(
+        0.01 * i, 0.01 * j, 0.1 * sin(0.1 * i) * cos(0.07 * j));
+    }
+  }
+  vtkNew<vtkCellArray> polys;
+  for (int j = 0; j < n - 1; ++j)
+  {
+    for (int i = 0; i < n - 1; ++i)
+    {
+      vtkIdType p = j * n + i;
+      vtkIdType tri1[3] = { p, p + 1, p + n + 1 };
+      vtkIdType tri2[3] = { p, p + n + 1, p + n };
+      polys->InsertNextCell(3, tri1);
+      polys->InsertNextCell(3, tri2);
+      if (p % 97 == 0)
+      {
+        vtkIdType degenerate[3] = { p, p + 1, p };
+        polys->InsertNextCell(3, degenerate);
+      }
+    }
+  }
+  mesh->SetPoints(points);
+  mesh->SetPolys(polys);
+}
+
+int TestFile(const std::string& fileName, vtkIdType numTris)
+{
+  vtkNew<vtkSTLReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  vtkPolyData* merged = reader->GetOutput();
+
+  vtkNew<vtkSTLReader> locatorReader;
+  locatorReader->SetFileName(fileName.c_str());
+  vtkNew<vtkPointLocator> locator;
+  locator->SetTolerance(0.0);
+  locatorReader->SetLocator(locator);
+  locatorReader->Update();
+  vtkPolyData* expected = locatorReader->GetOutput();
+
+  if (merged->GetNumberOfPoints() != expected->GetNumberOfPoints() ||
+      !SameArrays(merged->GetPoints()->GetData(),
+                  expected->GetPoints()->GetData()) ||
+      merged->GetNumberOfPolys() != expected->GetNumberOfPolys() ||
+      !SameArrays(merged->GetPolys()->GetData(),
+                  expected->GetPolys()->GetData()))
+  {
+    cerr << "Wrong merged points or triangles for " << fileName << ": "
+         << merged->GetNumberOfPoints() << " points and "
+         << merged->GetNumberOfPolys() << " triangles instead of "
+         << expected->GetNumberOfPoints() << " and "
+         << expected->GetNumberOfPolys() << endl;
+    return 1;
+  }
+
+  vtkNew<vtkSTLReader> mergePointsReader;
+  mergePointsReader->SetFileName(fileName.c_str());
+  vtkNew<vtkMergePoints> mergePoints;
+  mergePointsReader->SetLocator(mergePoints);
+  mergePointsReader->Update();
+  vtkPolyData* merged2 = mergePointsReader->GetOutput();
+  if (!SameArrays(merged2->GetPoints()->GetData(),
+                  expected->GetPoints()->GetData()) ||
+      !SameArrays(merged2->GetPolys()->GetData(),
+                  expected->GetPolys()->GetData()))
+  {
+    cerr << "Wrong points or triangles merged by a vtkMergePoints for "
+         << fileName << endl;
+    return 1;
+  }
+
+  reader->MergingOff();
+  reader->Update();
+  if (reader->GetOutput()->GetNumberOfPoints() != 3 * numTris ||
+      reader->GetOutput()->GetNumberOfPolys() != numTris)
+  {
+    cerr << "Wrong number of points or triangles without merging for "
+         << fileName << endl;
+    return 1;
+  }
+  return 0;
+}
+
+const char* multipleSolids =
+  "solid first\n"
+  "  facet normal 0 0 1\n"
+  "    outer loop\n"
+  "      vertex 0 0 0\n"
+  "      vertex 1 0 0\n"
+  "      vertex 0 1 0\n"
+  "    endloop\n"
+  "  endfacet\n"
+  "endsolid first\n"
+  "\n"
+  "SOLID second\r\n"
+  "COLOR 0.5 0.5 0.5 1\r\n"
+  "  Facet Normal 0 0 1\r\n"
+  "    Outer Loop\r\n"
+  "      Vertex 1 0 0\r\n"
+  "      Vertex 1 1 0\r\n"
+  "      Vertex 0.0e0 1.0 -0.0\r\n"
+  "    EndLoop\r\n"
+  "  EndFacet\r\n"
+  "EndSolid second";
+
+const char* badVertex =
+  "solid bad\n"
+  "  facet normal 0 0 1\n"
+  "    outer loop\n"
+  "      vertex 0 0 0\n"
+  "      vertex 1 0 x\n";
+
+} // anonymous namespace
+
+int TestSTLReaderMerging(int argc, char* argv[])
+{
+  char* tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+    "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  if (!tempDir)
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+  std::string testDirectory = tempDir;
+  delete[] tempDir;
+
+  int errors = 0;
+
+  vtkNew<vtkPolyData> mesh;
+  MakeMesh(mesh);
+  vtkNew<vtkSTLWriter> writer;
+  writer->SetInputData(mesh);
+  std::string fileName = testDirectory + "/TestSTLReaderMergingASCII.stl";
+  writer->SetFileName(fileName.c_str());
+  writer->SetFileTypeToASCII();
+  writer->Write();
+  errors += TestFile(fileName, mesh->GetNumberOfPolys());
+  fileName = testDirectory + "/TestSTLReaderMergingBinary.stl";
+  writer->SetFileName(fileName.c_str());
+  writer->SetFileTypeToBinary();
+  writer->Write();
+  errors += TestFile(fileName, mesh->GetNumberOfPolys());
+
+  // Two solids, tagged with scalars, with 4 points once merged.
+  fileName = testDirectory + "/TestSTLReaderMergingSolids.stl";
+  {
+    std::ofstream file(fileName.c_str(), std::ios::binary);
+    file << multipleSolids;
+  }
+  vtkNew<vtkSTLReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->ScalarTagsOn();
+  reader->Update();
+  vtkDataArray* scalars = reader->GetOutput()->GetCellData()->GetScalars();
+  if (reader->GetOutput()->GetNumberOfPoints() != 4 ||
+      reader->GetOutput()->GetNumberOfPolys() != 2 || !scalars ||
+      scalars->GetTuple1(0) != 0.0 || scalars->GetTuple1(1) != 1.0)
+  {
+    cerr << "Wrong output for multiple solids" << endl;
+    ++errors;
+  }
+
+  fileName = testDirectory + "/TestSTLReaderMergingBadVertex.stl";
+  {
+    std::ofstream file(fileName.c_str(), std::ios::binary);
+    file << badVertex;
+  }
+  vtkNew<vtkTest::ErrorObserver> errorObserver;
+  vtkNew<vtkTest::ErrorObserver> executiveObserver;
+  reader->SetFileName(fileName.c_str());
+  reader->AddObserver(vtkCommand::ErrorEvent, errorObserver);
+  reader->GetExecutive()->AddObserver(vtkCommand::ErrorEvent,
+                                      executiveObserver);
+  reader->Update();
+  errors += errorObserver->CheckErrorMessage(
+    "at line 5: Parse error reading STL vertex");
+
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
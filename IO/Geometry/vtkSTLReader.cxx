@@ -14,25 +14,31 @@
 =========================================================================*/
 #include "vtkSTLReader.h"
 
+#include "vtkASCIINumberParser.h"
 #include "vtkByteSwap.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkErrorCode.h"
 #include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkIncrementalPointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkMergePoints.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <algorithm>
-#include <cctype>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro(vtkSTLReader);
@@ -77,6 +83,237 @@ vtkMTimeType vtkSTLReader::GetMTime()
   return mTime1;
 }
 
+//------------------------------------------------------------------------------
+// Parallel merging of the points of the triangles read, used instead of a
+// vtkMergePoints locator. The output is identical: coincident points are
+// grouped by sorting them by bucket of a regular grid, then by coordinates,
+// and the output points are numbered in order of first occurrence. The
+// triangles that become degenerate are removed, then the remaining ones are
+// written in two passes over fixed size chunks: the first counts the
+// triangles kept by each chunk, the second writes them at the offsets given
+// by a prefix sum of the counts.
+namespace
+{
+
+// Number of triangles of a chunk of the triangle passes.
+const vtkIdType STL_CHUNK_SIZE = 4096;
+
+// The points of the triangle i are the points 3i, 3i + 1 and 3i + 2.
+void stlMergePoints(vtkPoints *newPts, vtkFloatArray *newScalars,
+                    vtkPoints *mergedPts, vtkCellArray *mergedPolys,
+                    vtkFloatArray *mergedScalars)
+{
+  vtkIdType numPts = newPts->GetNumberOfPoints();
+  const float *coords =
+    vtkArrayDownCast<vtkFloatArray>(newPts->GetData())->GetPointer(0);
+
+  // A regular grid of about 3 points per bucket over the bounds of the
+  // points. Flat dimensions are not divided.
+  double bounds[6];
+  newPts->GetBounds(bounds);
+  int numDims = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    numDims += (bounds[2 * i + 1] > bounds[2 * i]);
+  }
+  int div = (numDims == 0 ? 1 : static_cast<int>(
+    pow(numPts / 3.0, 1.0 / numDims)));
+  div = std::max(1, std::min(div, 1024));
+  vtkIdType divisions[3];
+  double h[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    double length = bounds[2 * i + 1] - bounds[2 * i];
+    divisions[i] = (length > 0.0 ? div : 1);
+    h[i] = (length > 0.0 ? divisions[i] / length : 0.0);
+  }
+
+  struct BucketTuple
+  {
+    vtkIdType Bucket;
+    vtkIdType PtId;
+  };
+  std::vector<BucketTuple> tuples(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      BucketTuple &tuple = tuples[ptId];
+      tuple.PtId = ptId;
+      const float *x = coords + 3 * ptId;
+      if (vtkMath::IsNan(x[0]) || vtkMath::IsNan(x[1]) ||
+          vtkMath::IsNan(x[2]))
+      {
+        tuple.Bucket = VTK_ID_MAX; // never merged, sorted last
+        continue;
+      }
+      vtkIdType ijk[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        ijk[i] = static_cast<vtkIdType>((x[i] - bounds[2 * i]) * h[i]);
+        ijk[i] = std::max<vtkIdType>(0, std::min(ijk[i], divisions[i] - 1));
+      }
+      tuple.Bucket = ijk[0] + divisions[0] * (ijk[1] + divisions[1] * ijk[2]);
+    }
+  });
+
+  // Coincident points are contiguous once sorted, the first one first.
+  vtkSMPTools::Sort(tuples.begin(), tuples.end(),
+    [&](const BucketTuple &a, const BucketTuple &b)
+  {
+    if (a.Bucket != b.Bucket)
+    {
+      return a.Bucket < b.Bucket;
+    }
+    if (a.Bucket != VTK_ID_MAX)
+    {
+      const float *x = coords + 3 * a.PtId;
+      const float *y = coords + 3 * b.PtId;
+      for (int i = 0; i < 3; ++i)
+      {
+        if (x[i] != y[i])
+        {
+          return x[i] < y[i];
+        }
+      }
+    }
+    return a.PtId < b.PtId;
+  });
+
+  // The first point of each group represents the others.
+  std::vector<vtkIdType> pointMap(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType i, vtkIdType endI)
+  {
+    for (; i < endI; ++i)
+    {
+      const BucketTuple &first = tuples[i];
+      const float *x = coords + 3 * first.PtId;
+      if (first.Bucket == VTK_ID_MAX)
+      {
+        pointMap[first.PtId] = first.PtId;
+        continue;
+      }
+      if (i > 0 && tuples[i - 1].Bucket == first.Bucket)
+      {
+        const float *y = coords + 3 * tuples[i - 1].PtId;
+        if (x[0] == y[0] && x[1] == y[1] && x[2] == y[2])
+        {
+          continue; // not the first of its group
+        }
+      }
+      for (vtkIdType j = i; j < numPts && tuples[j].Bucket == first.Bucket;
+           ++j)
+      {
+        const float *y = coords + 3 * tuples[j].PtId;
+        if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2])
+        {
+          break;
+        }
+        pointMap[tuples[j].PtId] = first.PtId;
+      }
+    }
+  });
+  std::vector<BucketTuple>().swap(tuples);
+
+  // Number the representatives in order, then map the other points.
+  std::vector<vtkIdType> newIds(numPts);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      newIds[ptId] = (pointMap[ptId] == ptId);
+    }
+  });
+  vtkIdType numNewPts = vtkSMPTools::ExclusiveScan(newIds.begin(),
+    newIds.end(), newIds.begin(), static_cast<vtkIdType>(0));
+
+  mergedPts->SetDataTypeToFloat();
+  mergedPts->SetNumberOfPoints(numNewPts);
+  float *mergedCoords =
+    vtkArrayDownCast<vtkFloatArray>(mergedPts->GetData())->GetPointer(0);
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      if (pointMap[ptId] == ptId)
+      {
+        std::copy(coords + 3 * ptId, coords + 3 * ptId + 3,
+                  mergedCoords + 3 * newIds[ptId]);
+      }
+    }
+  });
+  vtkSMPTools::For(0, numPts, [&](vtkIdType ptId, vtkIdType endPtId)
+  {
+    for (; ptId < endPtId; ++ptId)
+    {
+      pointMap[ptId] = newIds[pointMap[ptId]];
+    }
+  });
+  std::vector<vtkIdType>().swap(newIds);
+
+  // Keep the triangles with three different points.
+  vtkIdType numTris = numPts / 3;
+  vtkIdType numChunks = (numTris + STL_CHUNK_SIZE - 1) / STL_CHUNK_SIZE;
+  auto keep = [&](vtkIdType triId)
+  {
+    const vtkIdType *nodes = pointMap.data() + 3 * triId;
+    return nodes[0] != nodes[1] && nodes[0] != nodes[2] &&
+      nodes[1] != nodes[2];
+  };
+  std::vector<vtkIdType> offsets(numChunks);
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    for (; chunk < endChunk; ++chunk)
+    {
+      vtkIdType triId = chunk * STL_CHUNK_SIZE;
+      vtkIdType endTriId = std::min(triId + STL_CHUNK_SIZE, numTris);
+      offsets[chunk] = 0;
+      for (; triId < endTriId; ++triId)
+      {
+        offsets[chunk] += keep(triId);
+      }
+    }
+  });
+  vtkIdType numNewTris = vtkSMPTools::ExclusiveScan(offsets.begin(),
+    offsets.end(), offsets.begin(), static_cast<vtkIdType>(0));
+
+  vtkIdType *connectivity = mergedPolys->WritePointer(numNewTris,
+                                                      4 * numNewTris);
+  float *scalars = nullptr;
+  if (newScalars)
+  {
+    mergedScalars->SetNumberOfTuples(numNewTris);
+    scalars = mergedScalars->GetPointer(0);
+  }
+  vtkSMPTools::For(0, numChunks, 1, [&](vtkIdType chunk, vtkIdType endChunk)
+  {
+    for (; chunk < endChunk; ++chunk)
+    {
+      vtkIdType newTriId = offsets[chunk];
+      vtkIdType triId = chunk * STL_CHUNK_SIZE;
+      vtkIdType endTriId = std::min(triId + STL_CHUNK_SIZE, numTris);
+      for (; triId < endTriId; ++triId)
+      {
+        if (!keep(triId))
+        {
+          continue;
+        }
+        vtkIdType *cell = connectivity + 4 * newTriId;
+        cell[0] = 3;
+        std::copy(pointMap.data() + 3 * triId,
+                  pointMap.data() + 3 * triId + 3, cell + 1);
+        if (scalars)
+        {
+          scalars[newTriId] = newScalars->GetValue(triId);
+        }
+        ++newTriId;
+      }
+    }
+  });
+}
+
+} // end of anonymous namespace
+
 //------------------------------------------------------------------------------
 int vtkSTLReader::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -167,19 +404,16 @@ int vtkSTLReader::RequestData(
   fclose(fp);
 
   // If merging is on, create hash table and merge points/triangles.
-  vtkPoints *mergedPts = newPts.Get();
-  vtkCellArray *mergedPolys = newPolys.Get();
+  vtkSmartPointer<vtkPoints> mergedPts = newPts.Get();
+  vtkSmartPointer<vtkCellArray> mergedPolys = newPolys.Get();
   vtkFloatArray *mergedScalars = newScalars;
   if (this->Merging)
   {
-    mergedPts = vtkPoints::New();
-    mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
-    mergedPolys = vtkCellArray::New();
-    mergedPolys->Allocate(newPolys->GetSize());
+    mergedPts = vtkSmartPointer<vtkPoints>::New();
+    mergedPolys = vtkSmartPointer<vtkCellArray>::New();
     if (newScalars)
     {
       mergedScalars = vtkFloatArray::New();
-      mergedScalars->Allocate(newPolys->GetSize());
     }
 
     vtkSmartPointer<vtkIncrementalPointLocator> locator = this->Locator;
@@ -187,32 +421,51 @@ int vtkSTLReader::RequestData(
     {
       locator.TakeReference(this->NewDefaultLocator());
     }
-    locator->InitPointInsertion(mergedPts, newPts->GetBounds());
 
-    int nextCell = 0;
-    vtkIdType *pts = nullptr;
-    vtkIdType npts;
-    for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
+    // The default vtkMergePoints merges exactly coincident points, which is
+    // done in parallel without the locator. A locator set by the user is
+    // always used.
+    if (this->Locator == nullptr &&
+        !strcmp(locator->GetClassName(), "vtkMergePoints"))
+    {
+      stlMergePoints(newPts, newScalars, mergedPts, mergedPolys,
+                     mergedScalars);
+    }
+    else
     {
-      vtkIdType nodes[3];
-      for (int i = 0; i < 3; i++)
+      mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
+      mergedPolys->Allocate(newPolys->GetSize());
+      if (newScalars)
       {
-        double x[3];
-        newPts->GetPoint(pts[i], x);
-        locator->InsertUniquePoint(x, nodes[i]);
+        mergedScalars->Allocate(newPolys->GetSize());
       }
+      locator->InitPointInsertion(mergedPts, newPts->GetBounds());
 
-      if (nodes[0] != nodes[1] &&
-        nodes[0] != nodes[2] &&
-        nodes[1] != nodes[2])
+      int nextCell = 0;
+      vtkIdType *pts = nullptr;
+      vtkIdType npts;
+      for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
       {
-        mergedPolys->InsertNextCell(3, nodes);
-        if (newScalars)
+        vtkIdType nodes[3];
+        for (int i = 0; i < 3; i++)
         {
-          mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
+          double x[3];
+          newPts->GetPoint(pts[i], x);
+          locator->InsertUniquePoint(x, nodes[i]);
         }
+
+        if (nodes[0] != nodes[1] &&
+          nodes[0] != nodes[2] &&
+          nodes[1] != nodes[2])
+        {
+          mergedPolys->InsertNextCell(3, nodes);
+          if (newScalars)
+          {
+            mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
+          }
+        }
+        nextCell++;
       }
-      nextCell++;
     }
 
     if (newScalars)
@@ -226,10 +479,7 @@ int vtkSTLReader::RequestData(
   }
 
   output->SetPoints(mergedPts);
-  mergedPts->Delete();
-
   output->SetPolys(mergedPolys);
-  mergedPolys->Delete();
 
   if (mergedScalars)
   {
@@ -252,8 +502,6 @@ int vtkSTLReader::RequestData(
 bool vtkSTLReader::ReadBinarySTL(FILE *fp, vtkPoints *newPts,
                                  vtkCellArray *newPolys)
 {
-  typedef struct { float  n[3], v1[3], v2[3], v3[3]; } facet_t;
-
   vtkDebugMacro(<< "Reading BINARY STL file");
 
   //  File is read to obtain raw information as well as bounding box
@@ -266,7 +514,7 @@ bool vtkSTLReader::ReadBinarySTL(FILE *fp, vtkPoints *newPts,
     return false;
   }
 
-  unsigned long ulint;
+  vtkTypeUInt32 ulint;
   if (fread(&ulint, 1, 4, fp) != 4)
   {
     vtkErrorMacro("STLReader error reading file: " << this->FileName
@@ -290,55 +538,60 @@ bool vtkSTLReader::ReadBinarySTL(FILE *fp, vtkPoints *newPts,
   ulFileLength -= (80 + 4); // 80 byte - header, 4 byte - tringle count
   ulFileLength /= 50;       // 50 byte - twelve 32-bit-floating point numbers + 2 byte for attribute byte count
 
-  if (numTris < static_cast<int>(ulFileLength))
+  if (numTris != static_cast<int>(ulFileLength))
   {
+    // The facets are read until the end of the file, so the length of the
+    // file is the better estimate when allocating.
     numTris = static_cast<int>(ulFileLength);
   }
 
-  // now we can allocate the memory we need for this STL file
-  newPts->Allocate(numTris * 3);
-  newPolys->Allocate(numTris);
-
-  facet_t facet;
-  for (int i = 0; fread(&facet, 48, 1, fp) > 0; i++)
+  // Read the facets in large blocks, each decoded in parallel: the
+  // coordinates of the vertices are copied, and the triangles defined.
+  const int blockSize = 1 << 20;
+  std::vector<char> facets(50 * static_cast<size_t>(
+    std::min(numTris + 1, blockSize)));
+  vtkFloatArray *coords = vtkArrayDownCast<vtkFloatArray>(newPts->GetData());
+  coords->SetNumberOfComponents(3);
+  coords->Allocate(3 * 3 * static_cast<vtkIdType>(numTris));
+  vtkNew<vtkIdTypeArray> cells;
+  cells->Allocate(4 * static_cast<vtkIdType>(numTris));
+  vtkIdType numRead = 0;
+  for (bool eof = false; !eof;)
   {
-    unsigned short ibuff2;
-    if (fread(&ibuff2, 2, 1, fp) != 1) //read extra junk
+    size_t nbytes = fread(facets.data(), 1, facets.size(), fp);
+    eof = (nbytes < facets.size());
+    vtkIdType num = static_cast<vtkIdType>(nbytes / 50);
+    if (nbytes % 50 >= 48)
     {
       vtkErrorMacro("STLReader error reading file: " << this->FileName
         << " Premature EOF while reading extra junk.");
       return false;
     }
 
-    vtkByteSwap::Swap4LE(facet.n);
-    vtkByteSwap::Swap4LE(facet.n+1);
-    vtkByteSwap::Swap4LE(facet.n+2);
-
-    vtkByteSwap::Swap4LE(facet.v1);
-    vtkByteSwap::Swap4LE(facet.v1+1);
-    vtkByteSwap::Swap4LE(facet.v1+2);
-
-    vtkByteSwap::Swap4LE(facet.v2);
-    vtkByteSwap::Swap4LE(facet.v2+1);
-    vtkByteSwap::Swap4LE(facet.v2+2);
-
-    vtkByteSwap::Swap4LE(facet.v3);
-    vtkByteSwap::Swap4LE(facet.v3+1);
-    vtkByteSwap::Swap4LE(facet.v3+2);
-
-    vtkIdType pts[3];
-    pts[0] = newPts->InsertNextPoint(facet.v1);
-    pts[1] = newPts->InsertNextPoint(facet.v2);
-    pts[2] = newPts->InsertNextPoint(facet.v3);
-
-    newPolys->InsertNextCell(3, pts);
-
-    if ((i % 5000) == 0 && i != 0)
+    float *x = coords->WritePointer(9 * numRead, 9 * num);
+    vtkIdType *cell = cells->WritePointer(4 * numRead, 4 * num);
+    vtkIdType firstPt = 3 * numRead;
+    vtkSMPTools::For(0, num, [&](vtkIdType i, vtkIdType end)
     {
-      vtkDebugMacro(<< "triangle# " << i);
-      this->UpdateProgress(static_cast<double>(i) / numTris);
-    }
+      for (; i < end; ++i)
+      {
+        // Skip the normal, 12 bytes
+        float *v = x + 9 * i;
+        memcpy(v, facets.data() + 50 * i + 12, 9 * sizeof(float));
+        vtkByteSwap::Swap4LERange(v, 9);
+        vtkIdType *pts = cell + 4 * i;
+        pts[0] = 3;
+        pts[1] = firstPt + 3 * i;
+        pts[2] = pts[1] + 1;
+        pts[3] = pts[1] + 2;
+      }
+    });
+    numRead += num;
+
+    vtkDebugMacro(<< "triangle# " << numRead);
+    this->UpdateProgress(static_cast<double>(numRead) / std::max(numTris, 1));
   }
+  newPolys->SetCells(numRead, cells);
 
   return true;
 }
@@ -360,25 +613,102 @@ inline std::string stlParseExpected(std::string expected, std::string found)
 }
 
 
-// Get three space-delimited floats from string.
-bool stlReadVertex(char* buf, float vertCoord[3])
+// The first words of the lines of an ASCII file. The vertices whose
+// coordinates cannot be parsed are stlBadVertex.
+enum stlKeyword
+{
+  stlBlank = 0,
+  stlSolid,
+  stlColor,
+  stlFacet,
+  stlOuter,
+  stlVertex,
+  stlBadVertex,
+  stlEndLoop,
+  stlEndFacet,
+  stlEndSolid,
+  stlOther
+};
+
+const char *const stlKeywordNames[] = { "", "solid", "color", "facet",
+  "outer", "vertex", "vertex", "endloop", "endfacet", "endsolid", "" };
+
+
+// A chunk of whole lines of an ASCII file, and what was parsed from it: the
+// keyword of each line, the coordinates of the vertices, and the first word
+// that is not a keyword, in lower case.
+struct stlASCIIChunk
 {
-  char* begptr = buf;
-  char* endptr = nullptr;
+  const char *Begin;
+  const char *End;
+  std::vector<unsigned char> Keywords;
+  std::vector<float> Coords;
+  std::string Other;
+};
 
-  for (int i = 0; i < 3; ++i)
+
+void stlParseChunk(stlASCIIChunk &chunk)
+{
+  chunk.Keywords.clear();
+  chunk.Coords.clear();
+  chunk.Other.clear();
+
+  const char *line = chunk.Begin;
+  while (line < chunk.End)
   {
-    errno = 0;
-    vertCoord[i] = std::strtof(begptr, &endptr);
-    if (errno || (begptr == endptr))
+    const char *lineEnd =
+      static_cast<const char*>(memchr(line, '\n', chunk.End - line));
+    if (!lineEnd)
     {
-      return false;
+      lineEnd = chunk.End;
     }
 
-    begptr = endptr;
-  }
+    // The first word, in lower case.
+    const char *p = line;
+    while (p < lineEnd && vtkASCIINumberParser::IsSpace(*p))
+    {
+      ++p;
+    }
+    std::string word;
+    for (; p < lineEnd && !vtkASCIINumberParser::IsSpace(*p); ++p)
+    {
+      word += (*p >= 'A' && *p <= 'Z') ? static_cast<char>(*p + 'a' - 'A')
+                                       : *p;
+    }
 
-  return true;
+    unsigned char keyword = word.empty() ? stlBlank : stlOther;
+    for (int k = stlSolid; k < stlOther && keyword == stlOther; ++k)
+    {
+      if (k != stlBadVertex && word == stlKeywordNames[k])
+      {
+        keyword = static_cast<unsigned char>(k);
+      }
+    }
+
+    if (keyword == stlVertex)
+    {
+      float x[3];
+      for (int i = 0; i < 3 && p; ++i)
+      {
+        p = vtkASCIINumberParser::Parse(p, lineEnd, x[i]);
+      }
+      if (p)
+      {
+        chunk.Coords.insert(chunk.Coords.end(), x, x + 3);
+      }
+      else
+      {
+        keyword = stlBadVertex;
+      }
+    }
+    else if (keyword == stlOther && chunk.Other.empty())
+    {
+      chunk.Other = word;
+    }
+    chunk.Keywords.push_back(keyword);
+
+    line = lineEnd + 1;
+  }
 }
 
 } // end of anonymous namespace
@@ -407,227 +737,190 @@ bool stlReadVertex(char* buf, float vertCoord[3])
 // * The file concludes with
 //
 // endsolid [name]
+//
+// The file is read in large windows of whole lines. The lines of a window
+// are split in chunks parsed by several threads, then their keywords are
+// checked in order against the format, and finally the vertices of the
+// chunks are appended in parallel.
 
 bool vtkSTLReader::ReadASCIISTL(FILE *fp, vtkPoints *newPts,
                                 vtkCellArray *newPolys, vtkFloatArray *scalars)
 {
   vtkDebugMacro(<< "Reading ASCII STL file");
 
-  char line[256];         // line buffer
-  float vertCoord[3];     // scratch space when parsing "vertex %f %f %f"
-  vtkIdType pts[3];       // point ids for building triangles
-  int vertOff = 0;
-
-  int solidId = -1;
-  int lineNum = 0;
-
   enum StlAsciiScanState
   {
     scanSolid = 0,
     scanFacet,
     scanLoop,
-    scanVerts,
+    scanVert1,
+    scanVert2,
+    scanVert3,
     scanEndLoop,
-    scanEndFacet,
-    scanEndSolid
+    scanEndFacet
   };
-
+  static const unsigned char expected[] = { stlSolid, stlFacet, stlOuter,
+    stlVertex, stlVertex, stlVertex, stlEndLoop, stlEndFacet };
+  static const char *const expectedNames[] = { "solid", "facet",
+    "outer loop", "vertex", "vertex", "vertex", "endloop", "endfacet" };
+
+  vtkFloatArray *coords = vtkArrayDownCast<vtkFloatArray>(newPts->GetData());
+  coords->SetNumberOfComponents(3);
+  double fileLength = static_cast<double>(
+    vtksys::SystemTools::FileLength(this->FileName));
+  double numParsed = 0.0;
+
+  // a window of at most 64 MB, and just the file for smaller files so that
+  // the end of the file is found by the first read
+  std::vector<char> buffer(static_cast<size_t>(
+    std::min(fileLength + 1.0, static_cast<double>(1 << 26))));
+  size_t numBuffered = 0;
+  std::vector<stlASCIIChunk> chunks;
+  size_t numThreads =
+    static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads());
+
+  int state = scanSolid;
+  int solidId = -1;
+  int lineNum = 0;
   std::string errorMessage;
 
-  for (StlAsciiScanState state = scanSolid; errorMessage.empty(); /*nil*/)
+  for (bool eof = false; !eof && errorMessage.empty(); /*nil*/)
   {
-    char *cmd = fgets(line, 255, fp);
-
-    if (!cmd)
+    numBuffered += fread(buffer.data() + numBuffered, 1,
+                         buffer.size() - numBuffered, fp);
+    eof = (numBuffered < buffer.size());
+
+    // The last line is parsed with the next window, unless at the end of
+    // the file.
+    size_t numText = numBuffered;
+    if (!eof)
     {
-      // fgets() failed (eg EOF).
-      // If scanning for the next "solid" this is a valid way to exit,
-      // but is an error if scanning for the initial "solid" or any other token
-
-      switch (state)
+      while (numText > 0 && buffer[numText - 1] != '\n')
       {
-        case scanSolid:
-        {
-          // Emit error if EOF encountered without having read anything
-          if (solidId < 0) errorMessage = stlParseEof("solid");
-          break;
-        }
-        case scanFacet:    { errorMessage = stlParseEof("facet"); break; }
-        case scanLoop:     { errorMessage = stlParseEof("outer loop"); break; }
-        case scanVerts:    { errorMessage = stlParseEof("vertex"); break; }
-        case scanEndLoop:  { errorMessage = stlParseEof("endloop"); break; }
-        case scanEndFacet: { errorMessage = stlParseEof("endfacet"); break; }
-        case scanEndSolid: { errorMessage = stlParseEof("endsolid"); break; }
+        --numText;
+      }
+      if (numText == 0)
+      {
+        // A line longer than the window
+        buffer.resize(2 * buffer.size());
+        continue;
       }
-
-      // Terminate the parsing loop
-      break;
-    }
-
-    // Cue to the first non-space.
-    while (isspace(*cmd))
-    {
-      ++cmd;
-    }
-
-    // An empty line - try again
-    if (!*cmd)
-    {
-      // Increment line-number, but not while still in the header
-      if (lineNum) ++lineNum;
-      continue;
-    }
-
-    // Ensure consistent case on the first token and separate from
-    // subsequent arguments
-
-    char *arg = cmd;
-    while (*arg && !isspace(*arg))
-    {
-      *arg = tolower(*arg);
-      ++arg;
     }
 
-    // Terminate first token (cmd)
-    if (*arg)
+    // Split and parse the chunks.
+    const char *text = buffer.data();
+    size_t chunkSize = std::max(numText / (8 * numThreads),
+                                static_cast<size_t>(1 << 16));
+    size_t numChunks = 0;
+    for (size_t begin = 0; begin < numText; ++numChunks)
     {
-      *arg = '\0';
-      ++arg;
-
-      while (isspace(*arg))
+      size_t end = std::min(begin + chunkSize, numText);
+      const char *newline = static_cast<const char*>(
+        memchr(text + end - 1, '\n', numText - end + 1));
+      end = newline ? newline + 1 - text : numText;
+      if (chunks.size() <= numChunks)
       {
-        ++arg;
+        chunks.resize(numChunks + 1);
       }
+      chunks[numChunks].Begin = text + begin;
+      chunks[numChunks].End = text + end;
+      begin = end;
     }
-
-    ++lineNum;
-
-    // Handle all expected parsed elements
-    switch (state)
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numChunks), 1,
+                     [&](vtkIdType c, vtkIdType endC)
     {
-      case scanSolid:
+      for (; c < endC; ++c)
       {
-        if (!strcmp(cmd, "solid"))
-        {
-          ++solidId;
-          state = scanFacet;  // Next state
-        }
-        else
-        {
-          errorMessage = stlParseExpected("solid", cmd);
-        }
-        break;
+        stlParseChunk(chunks[c]);
       }
-      case scanFacet:
+    });
+
+    // Check the keywords in order.
+    std::vector<vtkIdType> offsets(numChunks + 1, coords->GetNumberOfValues());
+    for (size_t c = 0; c < numChunks && errorMessage.empty(); ++c)
+    {
+      for (unsigned char keyword : chunks[c].Keywords)
       {
-        if (!strcmp(cmd, "color"))
+        if (keyword == stlBlank)
         {
-          // Optional 'color' entry (after solid) - continue looking for 'facet'
+          // Increment line-number, but not while still in the header
+          if (lineNum) ++lineNum;
           continue;
         }
+        ++lineNum;
 
-        if (!strcmp(cmd, "facet"))
-        {
-          state = scanLoop;  // Next state
-        }
-        else if (!strcmp(cmd, "endsolid"))
-        {
-          // Finished with 'endsolid' - find next solid
-          state = scanSolid;
-        }
-        else
-        {
-          errorMessage = stlParseExpected("facet", cmd);
-        }
-        break;
-      }
-      case scanLoop:
-      {
-        if (!strcmp(cmd, "outer"))  // More pedantic => && !strcmp(arg, "loop")
-        {
-          state = scanVerts;  // Next state
-        }
-        else
+        if (keyword == expected[state])
         {
-          errorMessage = stlParseExpected("outer loop", cmd);
-        }
-        break;
-      }
-      case scanVerts:
-      {
-        if (!strcmp(cmd, "vertex"))
-        {
-          if (stlReadVertex(arg, vertCoord))
+          if (state == scanSolid)
           {
-            pts[vertOff] = newPts->InsertNextPoint(vertCoord);
-            ++vertOff;  // Next vertex
-
-            if (vertOff >= 3)
-            {
-              // Finished this triangle.
-              vertOff = 0;
-              state = scanEndLoop;  // Next state
-
-              // Save as cell
-              newPolys->InsertNextCell(3, pts);
-              if (scalars)
-              {
-                scalars->InsertNextValue(solidId);
-              }
-
-              if ((newPolys->GetNumberOfCells() % 5000) == 0)
-              {
-                this->UpdateProgress((newPolys->GetNumberOfCells()%50000) / 50000.0);
-              }
-            }
+            ++solidId;
           }
-          else
+          else if (state == scanVert3 && scalars)
           {
-            errorMessage = "Parse error reading STL vertex";
+            scalars->InsertNextValue(solidId);
           }
+          state = (state == scanEndFacet ? scanFacet : state + 1);
         }
-        else
-        {
-          errorMessage = stlParseExpected("vertex", cmd);
-        }
-        break;
-      }
-      case scanEndLoop:
-      {
-        if (!strcmp(cmd, "endloop"))
+        else if (state == scanFacet && keyword == stlColor)
         {
-          state = scanEndFacet;  // Next state
+          // Optional 'color' entry (after solid) - continue looking for 'facet'
         }
-        else
+        else if (state == scanFacet && keyword == stlEndSolid)
         {
-          errorMessage = stlParseExpected("endloop", cmd);
+          // Finished with 'endsolid' - find next solid
+          state = scanSolid;
         }
-        break;
-      }
-      case scanEndFacet:
-      {
-        if (!strcmp(cmd, "endfacet"))
+        else if (keyword == stlBadVertex && expected[state] == stlVertex)
         {
-          state = scanFacet;  // Next facet, or endsolid
+          errorMessage = "Parse error reading STL vertex";
+          break;
         }
         else
         {
-          errorMessage = stlParseExpected("endfacet", cmd);
+          errorMessage = stlParseExpected(expectedNames[state],
+            keyword == stlOther ? chunks[c].Other : stlKeywordNames[keyword]);
+          break;
         }
-        break;
       }
-      case scanEndSolid:
+      offsets[c + 1] = offsets[c] +
+        static_cast<vtkIdType>(chunks[c].Coords.size());
+    }
+    if (!errorMessage.empty())
+    {
+      break;
+    }
+
+    // Append the vertices.
+    float *x = coords->WritePointer(offsets[0],
+                                    offsets[numChunks] - offsets[0]);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numChunks), 1,
+                     [&](vtkIdType c, vtkIdType endC)
+    {
+      for (; c < endC; ++c)
       {
-        if (!strcmp(cmd, "endsolid"))
-        {
-          state = scanSolid;  // Start over again
-        }
-        else
-        {
-          errorMessage = stlParseExpected("endsolid", cmd);
-        }
-        break;
+        std::copy(chunks[c].Coords.begin(), chunks[c].Coords.end(),
+                  x + offsets[c] - offsets[0]);
       }
+    });
+
+    numParsed += numText;
+    this->UpdateProgress(fileLength > 0.0 ? numParsed / fileLength : 1.0);
+
+    numBuffered -= numText;
+    memmove(buffer.data(), buffer.data() + numText, numBuffered);
+  }
+
+  if (errorMessage.empty())
+  {
+    // EOF is a valid way to exit while scanning for the next "solid", but
+    // is an error if scanning for the initial "solid" or any other token.
+    if (state != scanSolid)
+    {
+      errorMessage = stlParseEof(expectedNames[state]);
+    }
+    else if (solidId < 0)
+    {
+      errorMessage = stlParseEof("solid");
     }
   }
 
@@ -639,6 +932,23 @@ bool vtkSTLReader::ReadASCIISTL(FILE *fp, vtkPoints *newPts,
     return false;
   }
 
+  // The points of the triangle i are the points 3i, 3i + 1 and 3i + 2.
+  vtkIdType numTris = newPts->GetNumberOfPoints() / 3;
+  vtkNew<vtkIdTypeArray> cells;
+  vtkIdType *cell = cells->WritePointer(0, 4 * numTris);
+  vtkSMPTools::For(0, numTris, [&](vtkIdType i, vtkIdType end)
+  {
+    for (; i < end; ++i)
+    {
+      vtkIdType *pts = cell + 4 * i;
+      pts[0] = 3;
+      pts[1] = 3 * i;
+      pts[2] = pts[1] + 1;
+      pts[3] = pts[1] + 2;
+    }
+  });
+  newPolys->SetCells(numTris, cells);
+
   return true;
 }
 
@@ -24,8 +24,12 @@
  * .stl files are quite inefficient since they duplicate vertex
  * definitions. By setting the Merging boolean you can control whether the
  * point data is merged after reading. Merging is performed by default,
- * however, merging requires a large amount of temporary storage since a
- * 3D hash table must be constructed.
+ * however, merging requires a large amount of temporary storage. With the
+ * default locator the points are merged by a parallel sort, which gives
+ * the same points and triangles as vtkMergePoints.
+ *
+ * The files are read in large blocks, decoded by several threads (via
+ * vtkSMPTools).
  *
  * @warning
  * Binary files written on one system may not be readable on other systems.
@@ -81,7 +85,8 @@ public:
   //@{
   /**
    * Specify a spatial locator for merging points. By
-   * default an instance of vtkMergePoints is used.
+   * default an instance of vtkMergePoints is used. Other locators are used
+   * serially, and are slower on large files.
    */
   void SetLocator(vtkIncrementalPointLocator *locator);
   vtkGetObjectMacro(Locator,vtkIncrementalPointLocator);
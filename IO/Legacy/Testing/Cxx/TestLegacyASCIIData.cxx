@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestLegacyASCIIData.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Roundtrip test for the ASCII legacy files: the arrays, cells and lookup
+// table are large enough to be parsed in blocks and in parallel, and are
+// followed by other sections that must still be read.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIntArray.h"
+#include "vtkLookupTable.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+#include "vtkUnstructuredGridReader.h"
+#include "vtkUnstructuredGridWriter.h"
+
+#include <cmath>
+
+namespace
+{
+
+bool SameArrays(vtkDataArray* a1, vtkDataArray* a2, const char* name)
+{
+  if (!a1 || !a2 || a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+  {
+    cerr << "Wrong size of " << name << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a1->GetNumberOfComponents(); ++c)
+    {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+      {
+        cerr << "Wrong value " << i << " of " << name << ": "
+             << a2->GetComponent(i, c) << " instead of "
+             << a1->GetComponent(i, c) << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int TestLegacyASCIIData(int, char*[])
+{
+  // Hexahedra along a line of points, with values written exactly in ASCII.
+  const vtkIdType numPoints = 200000;
+  vtkNew<vtkUnstructuredGrid> grid;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numPoints);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(numPoints);
+  for (vtkIdType i = 0; i < numPoints; ++i)
+  {
+    points->SetPoint(i, i / 8.0, -(i % 1000) / 4.0, (i % 7) / 16.0);
+    scalars->SetValue(i, static_cast<float>(i % 64) / 64.0f);
+  }
+  grid->SetPoints(points);
+  grid->Allocate(numPoints / 8);
+  for (vtkIdType i = 0; i + 8 <= numPoints; i += 8)
+  {
+    vtkIdType ids[8] = { i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7 };
+    grid->InsertNextCell(VTK_HEXAHEDRON, 8, ids);
+  }
+  vtkNew<vtkLookupTable> lut;
+  lut->SetNumberOfTableValues(256);
+  lut->Build();
+  scalars->SetLookupTable(lut);
+  grid->GetPointData()->SetScalars(scalars);
+  vtkNew<vtkIntArray> ids;
+  ids->SetName("ids");
+  ids->SetNumberOfComponents(2);
+  ids->SetNumberOfTuples(grid->GetNumberOfCells());
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); ++i)
+  {
+    ids->SetTuple2(i, static_cast<double>(i), -static_cast<double>(i) * 1000);
+  }
+  grid->GetCellData()->AddArray(ids);
+
+  vtkNew<vtkUnstructuredGridWriter> writer;
+  writer->SetFileTypeToASCII();
+  writer->SetInputData(grid);
+  writer->WriteToOutputStringOn();
+  writer->Write();
+
+  vtkNew<vtkUnstructuredGridReader> reader;
+  reader->ReadFromInputStringOn();
+  reader->SetInputString(writer->GetOutputString(),
+                         writer->GetOutputStringLength());
+  reader->Update();
+  vtkUnstructuredGrid* output = reader->GetOutput();
+
+  bool ok = output->GetNumberOfPoints() == numPoints &&
+            output->GetNumberOfCells() == grid->GetNumberOfCells();
+  if (!ok)
+  {
+    cerr << "Wrong number of points or cells" << endl;
+    return EXIT_FAILURE;
+  }
+  ok &= SameArrays(points->GetData(), output->GetPoints()->GetData(),
+                   "points");
+  ok &= SameArrays(grid->GetCells()->GetData(),
+                   output->GetCells()->GetData(), "cells");
+  ok &= SameArrays(grid->GetCellTypesArray(), output->GetCellTypesArray(),
+                   "cell types");
+  ok &= SameArrays(scalars, output->GetPointData()->GetScalars(), "scalars");
+  ok &= SameArrays(ids, output->GetCellData()->GetArray("ids"), "ids");
+
+  vtkLookupTable* outputLut =
+    output->GetPointData()->GetScalars()->GetLookupTable();
+  if (!outputLut || outputLut->GetNumberOfTableValues() != 256)
+  {
+    cerr << "Wrong lookup table" << endl;
+    return EXIT_FAILURE;
+  }
+  for (vtkIdType i = 0; i < 256; ++i)
+  {
+    double rgba1[4], rgba2[4];
+    lut->GetTableValue(i, rgba1);
+    outputLut->GetTableValue(i, rgba2);
+    for (int c = 0; c < 4; ++c)
+    {
+      // The table is written with the default stream precision.
+      if (std::abs(rgba1[c] - rgba2[c]) > 1e-5)
+      {
+        cerr << "Wrong lookup table value " << i << endl;
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
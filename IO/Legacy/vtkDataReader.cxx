@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkDataReader.h"
 
+#include "vtkASCIINumberParser.h"
 #include "vtkBitArray.h"
 #include "vtkByteSwap.h"
 #include "vtkCellData.h"
@@ -58,7 +59,9 @@
 
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 #include <cctype>
 
 // I need a safe way to read a line of arbitrary length.  It exists on
@@ -371,6 +374,155 @@ int vtkDataReader::Read(double *result)
   return 1;
 }
 
+// Read ASCII values in large blocks of the stream, then move the stream back
+// to just after the last value.  Returns -1 if the stream cannot move back,
+// and the values must be read one by one.
+template <class T>
+int vtkDataReaderReadASCIIValues(istream *IS, T *values, size_t numValues)
+{
+  if (IS->tellg() == std::streampos(-1))
+  {
+    return -1;
+  }
+
+  // Most numbers take less than 16 characters.
+  const size_t minBlockSize = 4096;
+  const size_t maxBlockSize = 1 << 24;
+  size_t blockSize = std::min(std::max(16 * numValues, minBlockSize),
+                              maxBlockSize);
+  std::vector<char> buffer;
+  size_t numRead = 0;
+  size_t tail = 0; // characters left over from the previous block
+  while (numRead < numValues)
+  {
+    buffer.resize(tail + blockSize);
+    IS->read(buffer.data() + tail, static_cast<std::streamsize>(blockSize));
+    size_t numChars = static_cast<size_t>(IS->gcount());
+    bool lastBlock = numChars < blockSize;
+    const char* begin = buffer.data();
+    const char* end = begin + tail + numChars;
+
+    // Parse the numbers that are complete.
+    const char* complete = end;
+    while (!lastBlock && complete != begin &&
+           !vtkASCIINumberParser::IsSpace(complete[-1]))
+    {
+      --complete;
+    }
+    size_t count = numValues - numRead;
+    const char* parsed = vtkASCIINumberParser::ParseValues(
+      begin, complete, values + numRead, count);
+    if (!parsed)
+    {
+      return 0;
+    }
+    numRead += count;
+    if (numRead == numValues)
+    {
+      IS->clear();
+      IS->seekg(-static_cast<std::streamoff>(end - parsed), ios::cur);
+      return IS->fail() ? 0 : 1;
+    }
+    if (lastBlock)
+    {
+      return 0;
+    }
+
+    // Keep the rest of the block for the next one.
+    tail = static_cast<size_t>(end - parsed);
+    std::copy(parsed, end, buffer.begin());
+  }
+  return 1;
+}
+
+template <class T>
+int vtkDataReaderReadValues(vtkDataReader *self, istream *IS, T *values,
+                            vtkIdType numValues)
+{
+  if (numValues <= 0)
+  {
+    return 1;
+  }
+  if (self->GetFileType() != VTK_BINARY)
+  {
+    int result = vtkDataReaderReadASCIIValues(IS, values,
+                                              static_cast<size_t>(numValues));
+    if (result >= 0)
+    {
+      return result;
+    }
+  }
+  for (vtkIdType i = 0; i < numValues; ++i)
+  {
+    if (!self->Read(values + i))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int vtkDataReader::ReadValues(char *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(unsigned char *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(short *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(unsigned short *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(int *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(unsigned int *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(long *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(unsigned long *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(long long *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(unsigned long long *values,
+                              vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(float *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
+int vtkDataReader::ReadValues(double *values, vtkIdType numValues)
+{
+  return vtkDataReaderReadValues(this, this->IS, values, numValues);
+}
+
 size_t vtkDataReader::Peek(char *str, size_t n)
 {
   if (n == 0)
@@ -1424,19 +1576,11 @@ int vtkReadBinaryData(istream *IS, T *data, vtkIdType numTuples, vtkIdType numCo
 template <class T>
 int vtkReadASCIIData(vtkDataReader *self, T *data, vtkIdType numTuples, vtkIdType numComp)
 {
-  vtkIdType i, j;
-
-  for (i=0; i<numTuples; i++)
+  if ( !self->ReadValues(data, numTuples*numComp) )
   {
-    for (j=0; j<numComp; j++)
-    {
-      if ( !self->Read(data++) )
-      {
-        vtkGenericWarningMacro(<<"Error reading ascii data. Possible mismatch of "
-          "datasize with declaration.");
-        return 0;
-      }
-    }
+    vtkGenericWarningMacro(<<"Error reading ascii data. Possible mismatch of "
+      "datasize with declaration.");
+    return 0;
   }
   return 1;
 }
@@ -3020,17 +3164,16 @@ int vtkDataReader::ReadLutData(vtkDataSetAttributes *a)
   }
   else // ascii
   {
-    float rgba[4];
+    std::vector<float> rgba(4*static_cast<size_t>(size));
+    if (!this->ReadValues(rgba.data(), 4*static_cast<vtkIdType>(size)))
+    {
+      vtkErrorMacro(<<"Error reading lookup table!" << " for file: "
+                    << (this->FileName?this->FileName:"(Null FileName)"));
+      return 0;
+    }
     for (i=0; i<size; i++)
     {
-      if (!(this->Read(rgba) && this->Read(rgba+1) &&
-            this->Read(rgba+2) && this->Read(rgba+3)))
-      {
-        vtkErrorMacro(<<"Error reading lookup table!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
-      lut->SetTableValue(i, rgba[0], rgba[1], rgba[2], rgba[3]);
+      lut->SetTableValue(i, rgba[4*i], rgba[4*i+1], rgba[4*i+2], rgba[4*i+3]);
     }
   }
 
@@ -3051,7 +3194,6 @@ int vtkDataReader::ReadLutData(vtkDataSetAttributes *a)
 int vtkDataReader::ReadCells(vtkIdType size, int *data)
 {
   char line[256];
-  int i;
 
   if ( this->FileType == VTK_BINARY)
   {
@@ -3068,14 +3210,11 @@ int vtkDataReader::ReadCells(vtkIdType size, int *data)
   }
   else // ascii
   {
-    for (i=0; i<size; i++)
+    if (!this->ReadValues(data, size))
     {
-      if (!this->Read(data+i))
-      {
-        vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
+      vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
+                    << (this->FileName?this->FileName:"(Null FileName)"));
+      return 0;
     }
   }
 
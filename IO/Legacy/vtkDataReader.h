@@ -405,6 +405,27 @@ public:
   int Read(double *);
   //@}
 
+  //@{
+  /**
+   * Internal function to read in numValues values.  ASCII values are
+   * parsed in large blocks by vtkASCIINumberParser, with several threads
+   * for the large blocks, which is much faster than reading them one by
+   * one with Read().  Returns zero if there was an error.
+   */
+  int ReadValues(char *values, vtkIdType numValues);
+  int ReadValues(unsigned char *values, vtkIdType numValues);
+  int ReadValues(short *values, vtkIdType numValues);
+  int ReadValues(unsigned short *values, vtkIdType numValues);
+  int ReadValues(int *values, vtkIdType numValues);
+  int ReadValues(unsigned int *values, vtkIdType numValues);
+  int ReadValues(long *values, vtkIdType numValues);
+  int ReadValues(unsigned long *values, vtkIdType numValues);
+  int ReadValues(long long *values, vtkIdType numValues);
+  int ReadValues(unsigned long long *values, vtkIdType numValues);
+  int ReadValues(float *values, vtkIdType numValues);
+  int ReadValues(double *values, vtkIdType numValues);
+  //@}
+
   /**
    * Read @a n character from the stream into @a str, then reset the stream
    * position. Returns the number of characters actually read.
@@ -0,0 +1,165 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPLYReaderLargeFile.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Write a mesh with more vertices and faces than vtkPLYReader reads at once
+// in ASCII, little endian and big endian files, and check the mesh read back.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkFloatArray.h"
+#include "vtkNew.h"
+#include "vtkPLYReader.h"
+#include "vtkPLYWriter.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <string>
+
+namespace
+{
+
+bool SameArrays(vtkDataArray* a1, vtkDataArray* a2, const char* name)
+{
+  if (!a1 || !a2 || a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+  {
+    cerr << "Wrong size of " << name << endl;
+    return false;
+  }
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < a1->GetNumberOfComponents(); ++c)
+    {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+      {
+        cerr << "Wrong value " << i << " of " << name << ": "
+             << a2->GetComponent(i, c) << " instead of "
+             << a1->GetComponent(i, c) << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+int TestPLYReaderLargeFile(int argc, char *argv[])
+{
+  char *tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+     "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  if (!tempDir)
+  {
+    std::cout << "Could not determine temporary directory.\n";
+    return EXIT_FAILURE;
+  }
+  std::string fileName = std::string(tempDir) + "/TestPLYReaderLargeFile.ply";
+  delete[] tempDir;
+
+  // A grid of triangles and quads, with coordinates written exactly in
+  // ASCII.
+  const int res = 600;
+  vtkNew<vtkPolyData> mesh;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkFloatArray> tcoords;
+  tcoords->SetNumberOfComponents(2);
+  vtkNew<vtkUnsignedCharArray> pointColors;
+  pointColors->SetName("Colors");
+  pointColors->SetNumberOfComponents(3);
+  for (int j = 0; j < res; ++j)
+  {
+    for (int i = 0; i < res; ++i)
+    {
+      points->InsertNextPoint(i / 4.0, j / 4.0, ((i + j) % 8) / 8.0);
+      tcoords->InsertNextTuple2((i % 64) / 64.0, (j % 64) / 64.0);
+      pointColors->InsertNextTuple3(i % 256, j % 256, (i + j) % 256);
+    }
+  }
+  vtkNew<vtkCellArray> polys;
+  vtkNew<vtkUnsignedCharArray> cellColors;
+  cellColors->SetName("Colors");
+  cellColors->SetNumberOfComponents(3);
+  for (int j = 0; j + 1 < res; ++j)
+  {
+    for (int i = 0; i + 1 < res; ++i)
+    {
+      vtkIdType quad[4] = { j * res + i, j * res + i + 1,
+                            (j + 1) * res + i + 1, (j + 1) * res + i };
+      if ((i + j) % 3 == 0)
+      {
+        polys->InsertNextCell(4, quad);
+        cellColors->InsertNextTuple3(255, i % 256, 0);
+      }
+      else
+      {
+        vtkIdType tri[3] = { quad[0], quad[2], quad[3] };
+        polys->InsertNextCell(3, quad);
+        polys->InsertNextCell(3, tri);
+        cellColors->InsertNextTuple3(0, j % 256, 255);
+        cellColors->InsertNextTuple3(0, 255, i % 256);
+      }
+    }
+  }
+  mesh->SetPoints(points);
+  mesh->SetPolys(polys);
+  mesh->GetPointData()->SetTCoords(tcoords);
+  mesh->GetPointData()->AddArray(pointColors);
+  mesh->GetCellData()->AddArray(cellColors);
+
+  for (int fileType = 0; fileType < 3; ++fileType)
+  {
+    vtkNew<vtkPLYWriter> writer;
+    writer->SetFileName(fileName.c_str());
+    writer->SetInputData(mesh);
+    writer->SetArrayName("Colors");
+    writer->SetTextureCoordinatesNameToUV();
+    if (fileType == 0)
+    {
+      writer->SetFileTypeToASCII();
+    }
+    else
+    {
+      writer->SetFileTypeToBinary();
+      writer->SetDataByteOrder(fileType == 1 ? VTK_LITTLE_ENDIAN :
+                               VTK_BIG_ENDIAN);
+    }
+    writer->Write();
+
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    vtkPolyData *output = reader->GetOutput();
+
+    if (!output->GetPoints() || !output->GetPolys() ||
+        !SameArrays(points->GetData(), output->GetPoints()->GetData(),
+                    "points") ||
+        !SameArrays(polys->GetData(), output->GetPolys()->GetData(),
+                    "polys") ||
+        !SameArrays(tcoords, output->GetPointData()->GetTCoords(),
+                    "texture coordinates") ||
+        !SameArrays(pointColors, output->GetPointData()->GetArray("RGB"),
+                    "point colors") ||
+        !SameArrays(cellColors, output->GetCellData()->GetArray("RGB"),
+                    "cell colors"))
+    {
+      cerr << "Wrong mesh read from file type " << fileType << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
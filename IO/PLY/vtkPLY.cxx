@@ -47,14 +47,19 @@ WARRANTY OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.
 */
 
 #include "vtkPLY.h"
+#include "vtkASCIINumberParser.h"
 #include "vtkHeap.h"
 #include "vtkByteSwap.h"
 #include "vtkMath.h"
+#include "vtkSMPTools.h"
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <cassert>
+#include <string>
+#include <vector>
 
 /* memory allocation */
 #define myalloc(mem_size) vtkPLY::my_alloc((mem_size), __LINE__, __FILE__)
@@ -1014,6 +1019,531 @@ void vtkPLY::ply_get_element(PlyFile *plyfile, void *elem_ptr)
 }
 
 
+/******************************************************************************
+Decode a binary item of a file of the given type from a buffer.
+
+Entry:
+  ptr       - pointer to the item
+  type      - data type of the item
+  file_type - binary file type, big or little endian
+
+Exit:
+  int_val    - integer value
+  uint_val   - unsigned integer value
+  double_val - double-precision floating point value
+******************************************************************************/
+
+static void decode_binary_item(
+  const char *ptr,
+  int type,
+  int file_type,
+  int *int_val,
+  unsigned int *uint_val,
+  double *double_val
+)
+{
+  switch (type) {
+    case PLY_CHAR:
+    case PLY_INT8:
+    {
+      vtkTypeInt8 value;
+      memcpy(&value, ptr, sizeof(value));
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_UCHAR:
+    case PLY_UINT8:
+    {
+      vtkTypeUInt8 value;
+      memcpy(&value, ptr, sizeof(value));
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_SHORT:
+    case PLY_INT16:
+    {
+      vtkTypeInt16 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap2BE(&value) :
+        vtkByteSwap::Swap2LE(&value);
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_USHORT:
+    case PLY_UINT16:
+    {
+      vtkTypeUInt16 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap2BE(&value) :
+        vtkByteSwap::Swap2LE(&value);
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_INT:
+    case PLY_INT32:
+    {
+      vtkTypeInt32 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap4BE(&value) :
+        vtkByteSwap::Swap4LE(&value);
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_UINT:
+    case PLY_UINT32:
+    {
+      vtkTypeUInt32 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap4BE(&value) :
+        vtkByteSwap::Swap4LE(&value);
+
+      // Here value can always fit in int, unsigned int, and double.
+      *int_val = static_cast<int>(value);
+      *uint_val = static_cast<unsigned int>(value);
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_FLOAT:
+    case PLY_FLOAT32:
+    {
+      vtkTypeFloat32 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap4BE(&value) :
+        vtkByteSwap::Swap4LE(&value);
+
+      // INT32_MIN (-2^31) is a power of 2 and thus exactly representable as float.
+      // INT32_MAX (2^31 - 1) is not exactly representable as float; closest smaller integer is 2^31 - 128.
+      // UINT32_MAX (2^32 - 1) is not exactly representable as float; closest smaller integer is 2^32 - 256.
+      *int_val = static_cast<int>(vtkMath::ClampValue(value, (float)VTK_INT_MIN, 2147483520.0f));
+      *uint_val = static_cast<unsigned int>(vtkMath::ClampValue(value, 0.0f, 4294967040.0f));
+      *double_val = static_cast<double>(value);
+    }
+      break;
+    case PLY_DOUBLE:
+    {
+      vtkTypeFloat64 value;
+      memcpy(&value, ptr, sizeof(value));
+      file_type == PLY_BINARY_BE ?
+        vtkByteSwap::Swap8BE(&value) :
+        vtkByteSwap::Swap8LE(&value);
+
+      // Here we can just clamp and cast, all int32s can be exactly represented as doubles.
+      *int_val = static_cast<int>(vtkMath::ClampValue(value, (double)VTK_INT_MIN, (double)VTK_INT_MAX));
+      *uint_val = static_cast<unsigned int>(vtkMath::ClampValue(value, 0.0, (double)VTK_UNSIGNED_INT_MAX));
+      *double_val = value;
+    }
+      break;
+    default:
+      fprintf (stderr, "decode_binary_item: bad type = %d\n", type);
+      assert (0);
+  }
+}
+
+
+/******************************************************************************
+Extract the value of the next ascii word of a line, like get_ascii_item()
+does but without copying the word.
+
+Entry:
+  ptr  - pointer in the line, before the word
+  end  - end of the line
+  type - data type supposedly in the word
+
+Exit:
+  int_val    - integer value
+  uint_val   - unsigned integer value
+  double_val - double-precision floating point value
+  returns a pointer past the word, or nullptr if there is no word left (the
+  values are then set to zero)
+******************************************************************************/
+
+static const char *parse_ascii_item(
+  const char *ptr,
+  const char *end,
+  int type,
+  int *int_val,
+  unsigned int *uint_val,
+  double *double_val
+)
+{
+  while (ptr != end && vtkASCIINumberParser::IsSpace(*ptr))
+    ptr++;
+  if (ptr == end) {
+    *int_val = 0;
+    *uint_val = 0;
+    *double_val = 0.0;
+    return nullptr;
+  }
+  const char *word_end = ptr;
+  while (word_end != end && !vtkASCIINumberParser::IsSpace(*word_end))
+    word_end++;
+
+  switch (type) {
+    case PLY_CHAR:
+    case PLY_INT8:
+    case PLY_UCHAR:
+    case PLY_UINT8:
+    case PLY_SHORT:
+    case PLY_INT16:
+    case PLY_USHORT:
+    case PLY_UINT16:
+    case PLY_INT:
+    case PLY_INT32:
+    {
+      int value;
+      if (vtkASCIINumberParser::Parse(ptr, word_end, value)) {
+        *int_val = value;
+        *uint_val = *int_val;
+        *double_val = *int_val;
+        return word_end;
+      }
+      break;
+    }
+
+    case PLY_UINT:
+    case PLY_UINT32:
+    {
+      unsigned int value;
+      if (vtkASCIINumberParser::Parse(ptr, word_end, value)) {
+        *uint_val = value;
+        *int_val = *uint_val;
+        *double_val = *uint_val;
+        return word_end;
+      }
+      break;
+    }
+
+    case PLY_FLOAT:
+    case PLY_FLOAT32:
+    case PLY_DOUBLE:
+    {
+      double value;
+      if (vtkASCIINumberParser::Parse(ptr, word_end, value)) {
+        *double_val = value;
+        *int_val = (int) *double_val;
+        *uint_val = (unsigned int) *double_val;
+        return word_end;
+      }
+      break;
+    }
+
+    default:
+      fprintf (stderr, "parse_ascii_item: bad type = %d\n", type);
+      assert (0);
+  }
+
+  /* not a plain number, let the C library make the most of it */
+  std::string word(ptr, word_end);
+  vtkPLY::get_ascii_item(word.c_str(), type, int_val, uint_val, double_val);
+  return word_end;
+}
+
+
+/******************************************************************************
+Find the size of the next element of a binary file in a buffer.
+
+Entry:
+  elem      - the kind of element
+  file_type - binary file type, big or little endian
+  ptr       - pointer to the element
+  end       - end of the buffer
+
+Exit:
+  size    - size of the element in bytes
+  returns false if the element does not fit in the buffer
+******************************************************************************/
+
+static bool binary_element_size(
+  PlyElement *elem,
+  int file_type,
+  const char *ptr,
+  const char *end,
+  size_t *size
+)
+{
+  const char *item = ptr;
+  for (int j = 0; j < elem->nprops; j++) {
+    PlyProperty *prop = elem->props[j];
+    size_t item_size = ply_type_size[prop->external_type];
+    if (prop->is_list) {
+      size_t count_size = ply_type_size[prop->count_external];
+      if (static_cast<size_t>(end - item) < count_size)
+        return false;
+      int int_val;
+      unsigned int uint_val;
+      double double_val;
+      decode_binary_item(item, prop->count_external, file_type,
+                         &int_val, &uint_val, &double_val);
+      item += count_size;
+      item_size *= (int_val > 0 ? int_val : 0);
+    }
+    if (static_cast<size_t>(end - item) < item_size)
+      return false;
+    item += item_size;
+  }
+  *size = item - ptr;
+  return true;
+}
+
+
+/******************************************************************************
+Decode an element read in a buffer, as ascii_get_element() or
+binary_get_element() do. The elements must not have other properties.
+
+Entry:
+  elem      - the kind of element
+  file_type - file type, ascii or binary
+  ptr       - pointer to the element (a line for an ascii file)
+  end       - end of the element
+  elem_ptr  - pointer to location where the element information should be
+              put, or nullptr to only count the list items
+  list_ptr  - pointer to location where the list items should be put
+
+Exit:
+  returns the number of bytes of list items stored at list_ptr
+******************************************************************************/
+
+static size_t decode_element(
+  PlyElement *elem,
+  int file_type,
+  const char *ptr,
+  const char *end,
+  char *elem_ptr,
+  char *list_ptr
+)
+{
+  int int_val = 0;
+  unsigned int uint_val = 0;
+  double double_val = 0.0;
+  size_t list_size = 0;
+
+  /* read the next item of the element, or only skip it if it is not stored */
+  auto next_item = [&](int type, bool store)
+  {
+    if (file_type != PLY_ASCII) {
+      if (store)
+        decode_binary_item(ptr, type, file_type,
+                           &int_val, &uint_val, &double_val);
+      ptr += ply_type_size[type];
+    }
+    else if (store) {
+      const char *word_end = parse_ascii_item(ptr, end, type,
+                                              &int_val, &uint_val, &double_val);
+      ptr = (word_end ? word_end : end);
+    }
+    else {
+      while (ptr != end && vtkASCIINumberParser::IsSpace(*ptr))
+        ptr++;
+      while (ptr != end && !vtkASCIINumberParser::IsSpace(*ptr))
+        ptr++;
+    }
+  };
+
+  for (int j = 0; j < elem->nprops; j++) {
+
+    PlyProperty *prop = elem->props[j];
+    bool store_it = (elem->store_prop[j] == STORE_PROP);
+
+    if (prop->is_list) {       /* a list */
+
+      /* get and store the number of items in the list */
+      next_item (prop->count_external, true);
+      int list_count = (int_val > 0 ? int_val : 0);
+      if (store_it && elem_ptr)
+        vtkPLY::store_item (elem_ptr + prop->count_offset,
+                            prop->count_internal,
+                            int_val, uint_val, double_val);
+
+      /* store the items contiguously, 8-byte aligned for the next list */
+      size_t item_size = ply_type_size[prop->internal_type];
+      char *item = list_ptr + list_size;
+      if (store_it) {
+        if (elem_ptr)
+          *((char **) (elem_ptr + prop->offset)) =
+            (list_count == 0 ? nullptr : item);
+        list_size += (item_size * list_count + 7) / 8 * 8;
+      }
+
+      for (int k = 0; k < list_count; k++) {
+        next_item (prop->external_type, store_it && elem_ptr);
+        if (store_it && elem_ptr) {
+          vtkPLY::store_item (item, prop->internal_type,
+                              int_val, uint_val, double_val);
+          item += item_size;
+        }
+      }
+
+    }
+    else {                     /* not a list */
+      next_item (prop->external_type, store_it && elem_ptr);
+      if (store_it && elem_ptr)
+        vtkPLY::store_item (elem_ptr + prop->offset, prop->internal_type,
+                            int_val, uint_val, double_val);
+    }
+
+  }
+
+  return list_size;
+}
+
+
+/******************************************************************************
+Read several elements from the file.  This routine assumes that we're
+reading the type of element specified in the last call to the routine
+ply_get_element_setup() or ply_get_property(), and that it has no other
+properties. The file is read in large blocks and the elements are decoded
+with several threads.
+
+Entry:
+  plyfile   - file identifier
+  elem_ptr  - pointer to an array of elements to fill
+  elem_size - size of the elements of the array (bytes)
+  num       - number of elements to read
+
+Exit:
+  list_data - pointer to the items of the lists of all the elements, which
+              the elements point into. The calling routine must call "free"
+              on it once finished with it (nullptr when there are no lists).
+  returns the number of elements read, less than num if the end of the file
+  is reached, or -1 if the element has other properties: ply_get_element()
+  must be used instead
+******************************************************************************/
+
+int vtkPLY::ply_get_elements(
+  PlyFile *plyfile,
+  void *elem_ptr,
+  int elem_size,
+  int num,
+  void **list_data
+)
+{
+  PlyElement *elem = plyfile->which_elem;
+  int file_type = plyfile->file_type;
+  *list_data = nullptr;
+  if (elem == nullptr || elem->other_offset != NO_OTHER_PROPS)
+    return (-1);
+  if (num <= 0)
+    return (0);
+
+  /* guess the size of the elements, to read them in a few blocks */
+  size_t guess = 0;
+  bool has_lists = false;
+  for (int j = 0; j < elem->nprops; j++) {
+    PlyProperty *prop = elem->props[j];
+    size_t item_size = (file_type == PLY_ASCII ?
+                        8 : ply_type_size[prop->external_type]);
+    if (prop->is_list) {
+      has_lists = true;
+      guess += (file_type == PLY_ASCII ? 2 : ply_type_size[prop->count_external]);
+      item_size *= 3;
+    }
+    guess += item_size;
+  }
+  size_t block_size = std::max<size_t>(4096, guess * num + 1);
+
+  /* read the file and find the bounds of the elements: the lines of an */
+  /* ascii file, as get_words() reads them, or the binary elements */
+  std::vector<char> buffer;
+  std::vector<size_t> bounds(1, 0);
+  bounds.reserve(num + 1);
+  bool eof = false;
+  while (static_cast<int>(bounds.size()) <= num && !eof) {
+    size_t size = buffer.size();
+    buffer.resize(size + block_size);
+    size_t nread = fread (buffer.data() + size, 1, block_size, plyfile->fp);
+    buffer.resize(size + nread);
+    eof = (nread < block_size);
+    block_size = std::min<size_t>(2 * block_size, 1 << 28);
+
+    const char *data = buffer.data();
+    const char *data_end = data + buffer.size();
+    while (static_cast<int>(bounds.size()) <= num) {
+      const char *begin = data + bounds.back();
+      size_t elem_bytes;
+      if (file_type == PLY_ASCII) {
+        const char *eol = static_cast<const char *>(
+          memchr(begin, '\n', data_end - begin));
+        if (eol)
+          elem_bytes = eol - begin + 1;
+        else if (eof && begin != data_end)
+          elem_bytes = data_end - begin;
+        else
+          break;
+      }
+      else if (!binary_element_size(elem, file_type, begin, data_end,
+                                    &elem_bytes))
+        break;
+      bounds.push_back(bounds.back() + elem_bytes);
+    }
+  }
+
+  /* leave the file just after the elements read */
+  size_t unread = buffer.size() - bounds.back();
+  if (unread > 0)
+    fseek (plyfile->fp, -static_cast<long>(unread), SEEK_CUR);
+
+  int nelems = static_cast<int>(bounds.size()) - 1;
+  const char *data = buffer.data();
+  char *elems = static_cast<char *>(elem_ptr);
+
+  /* find where the list items of each element go */
+  std::vector<size_t> list_offsets(nelems + 1, 0);
+  if (has_lists) {
+    vtkSMPTools::For(0, nelems, [&](vtkIdType i, vtkIdType end)
+    {
+      for (; i < end; ++i)
+        list_offsets[i] = decode_element(elem, file_type, data + bounds[i],
+                                         data + bounds[i + 1],
+                                         nullptr, nullptr);
+    });
+    size_t list_size = vtkSMPTools::ExclusiveScan(
+      list_offsets.begin(), list_offsets.end() - 1, list_offsets.begin(),
+      static_cast<size_t>(0));
+    if (list_size > 0) {
+      *list_data = myalloc (list_size);
+      if (*list_data == nullptr)
+        return (0);
+    }
+  }
+
+  char *lists = static_cast<char *>(*list_data);
+  vtkSMPTools::For(0, nelems, [&](vtkIdType i, vtkIdType end)
+  {
+    for (; i < end; ++i)
+      decode_element(elem, file_type, data + bounds[i], data + bounds[i + 1],
+                     elems + i * static_cast<size_t>(elem_size),
+                     lists + list_offsets[i]);
+  });
+
+  return (nelems);
+}
+
+
 /******************************************************************************
 Extract the comments from the header information of a PLY file.
 
@@ -2299,174 +2829,23 @@ void vtkPLY::get_binary_item(
   double *double_val
 )
 {
-  switch (type) {
-    case PLY_CHAR:
-    case PLY_INT8:
-      {
-      vtkTypeInt8 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading char.");
-        fclose (plyfile->fp);
-        return;
-      }
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_UCHAR:
-    case PLY_UINT8:
-    {
-      vtkTypeUInt8 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading uchar or uint8.");
-        fclose (plyfile->fp);
-        return;
-      }
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_SHORT:
-    case PLY_INT16:
-    {
-      vtkTypeInt16 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading short.");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap2BE(&value) :
-        vtkByteSwap::Swap2LE(&value);
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_USHORT:
-    case PLY_UINT16:
-    {
-      vtkTypeUInt16 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading ushort.");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap2BE(&value) :
-        vtkByteSwap::Swap2LE(&value);
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_INT:
-    case PLY_INT32:
-    {
-      vtkTypeInt32 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading int or int32.");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap4BE(&value) :
-        vtkByteSwap::Swap4LE(&value);
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_UINT:
-    case PLY_UINT32:
-    {
-      vtkTypeUInt32 value = 0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading uint");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap4BE(&value) :
-        vtkByteSwap::Swap4LE(&value);
-
-      // Here value can always fit in int, unsigned int, and double.
-      *int_val = static_cast<int>(value);
-      *uint_val = static_cast<unsigned int>(value);
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_FLOAT:
-    case PLY_FLOAT32:
-    {
-      vtkTypeFloat32 value = 0.0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading float of float32.");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap4BE(&value) :
-        vtkByteSwap::Swap4LE(&value);
-
-      // INT32_MIN (-2^31) is a power of 2 and thus exactly representable as float.
-      // INT32_MAX (2^31 - 1) is not exactly representable as float; closest smaller integer is 2^31 - 128.
-      // UINT32_MAX (2^32 - 1) is not exactly representable as float; closest smaller integer is 2^32 - 256.
-      *int_val = static_cast<int>(vtkMath::ClampValue(value, (float)VTK_INT_MIN, 2147483520.0f));
-      *uint_val = static_cast<unsigned int>(vtkMath::ClampValue(value, 0.0f, 4294967040.0f));
-      *double_val = static_cast<double>(value);
-    }
-      break;
-    case PLY_DOUBLE:
-    {
-      vtkTypeFloat64 value = 0.0;
-      if (fread (&value, sizeof(value), 1, plyfile->fp) != 1)
-      {
-        vtkGenericWarningMacro ("PLY error reading file."
-                                << " Premature EOF while reading double.");
-        fclose (plyfile->fp);
-        return;
-      }
-      plyfile->file_type == PLY_BINARY_BE ?
-        vtkByteSwap::Swap8BE(&value) :
-        vtkByteSwap::Swap8LE(&value);
+  if (type <= PLY_START_TYPE || type >= PLY_END_TYPE) {
+    fprintf (stderr, "get_binary_item: bad type = %d\n", type);
+    assert (0);
+    return;
+  }
 
-      // Here we can just clamp and cast, all int32s can be exactly represented as doubles.
-      *int_val = static_cast<int>(vtkMath::ClampValue(value, (double)VTK_INT_MIN, (double)VTK_INT_MAX));
-      *uint_val = static_cast<unsigned int>(vtkMath::ClampValue(value, 0.0, (double)VTK_UNSIGNED_INT_MAX));
-      *double_val = value;
-    }
-      break;
-    default:
-      fprintf (stderr, "get_binary_item: bad type = %d\n", type);
-      assert (0);
+  char item[8];
+  if (fread (item, ply_type_size[type], 1, plyfile->fp) != 1)
+  {
+    vtkGenericWarningMacro ("PLY error reading file."
+                            << " Premature EOF while reading "
+                            << type_names[type] << ".");
+    fclose (plyfile->fp);
+    return;
   }
+  decode_binary_item(item, type, plyfile->file_type,
+                     int_val, uint_val, double_val);
 }
 
 
@@ -53,7 +53,9 @@ WARRANTY OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE.
  * vtkPLY is a modified version of the PLY 1.1 library. The library
  * has been modified by wrapping in a class (to minimize global symbols);
  * to take advantage of functionality generally not available through the
- * PLY library API; and to correct problems with the PLY library.
+ * PLY library API; and to correct problems with the PLY library. Large
+ * files are best read with ply_get_elements(), which reads many elements at
+ * once and decodes them with several threads.
  *
  * The original distribution was taken from the Stanford University PLY
  * file format release 1.1 (see http://graphics.stanford.edu/data/3Dscanrep/).
@@ -181,6 +183,7 @@ public:
   static void ply_get_property(PlyFile *, const char *, PlyProperty *);
   static PlyOtherProp *ply_get_other_properties(PlyFile *, const char *, int);
   static void ply_get_element(PlyFile *, void *);
+  static int ply_get_elements(PlyFile *, void *, int, int, void **);
   static char **ply_get_comments(PlyFile *, int *);
   static char **ply_get_obj_info(PlyFile *, int *);
   static void ply_close(PlyFile *);
@@ -18,16 +18,21 @@
 #include "vtkCellData.h"
 #include "vtkPointData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPLY.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include <vtksys/SystemTools.hxx>
 
+#include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <vector>
 
 vtkStandardNewMacro(vtkPLYReader);
 
@@ -65,6 +70,10 @@ typedef struct _plyFace {
   unsigned char nverts;   // number of vertex indices in list
   int *verts;             // vertex index list
 } plyFace;
+
+// Number of elements read at once. Their conversion to VTK arrays is done
+// in parallel.
+const int PLY_BATCH_SIZE = 1 << 18;
 }
 
 int vtkPLYReader::RequestData(
@@ -245,6 +254,7 @@ int vtkPLYReader::RequestData(
 
   // Okay, now we can grab the data
   int numPts = 0, numPolys = 0;
+  bool readError = false;
   for (int i = 0; i < nelems; i++)
   {
     //get the description of the first element */
@@ -252,7 +262,7 @@ int vtkPLYReader::RequestData(
     vtkPLY::ply_get_element_description (ply, elemName, &numElems, &nprops);
 
     // if we're on vertex elements, read them in
-    if ( elemName && !strcmp ("vertex", elemName) )
+    if ( elemName && !readError && !strcmp ("vertex", elemName) )
     {
       // Create a list of points
       numPts = numElems;
@@ -292,43 +302,71 @@ int vtkPLYReader::RequestData(
         RGBPoints->SetNumberOfTuples(numPts);
       }
 
-      plyVertex vertex;
-      for (int j=0; j < numPts; j++)
+      // Read the vertices in batches and copy them in parallel
+      std::vector<plyVertex> vertices(std::min(numPts, PLY_BATCH_SIZE));
+      float *x = vtkArrayDownCast<vtkFloatArray>(pts->GetData())->GetPointer(0);
+      float *tcoords = TexCoordsPointsAvailable ?
+        TexCoordsPoints->GetPointer(0) : nullptr;
+      float *normals = NormalPointsAvailable ? Normals->GetPointer(0) : nullptr;
+      unsigned char *rgb = RGBPointsAvailable ? RGBPoints->GetPointer(0) : nullptr;
+      for (int begin = 0; begin < numPts; )
       {
-        vtkPLY::ply_get_element (ply, (void *) &vertex);
-        pts->SetPoint (j, vertex.x);
-        if ( TexCoordsPointsAvailable )
-        {
-          TexCoordsPoints->SetTuple2(j, vertex.tex[0], vertex.tex[1]);
-        }
-        if ( NormalPointsAvailable )
+        int num = std::min(numPts - begin, PLY_BATCH_SIZE);
+        void *listData;
+        int numRead = vtkPLY::ply_get_elements(ply, vertices.data(),
+          static_cast<int>(sizeof(plyVertex)), num, &listData);
+        free(listData); // allocated in vtkPLY::ply_get_elements
+        if (numRead != num)
         {
-          Normals->SetTuple3(j, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+          vtkErrorMacro(<<"Could not read the vertices of " << this->FileName);
+          readError = true;
+          break;
         }
-        if ( RGBPointsAvailable )
+
+        vtkSMPTools::For(0, num, [&](vtkIdType i, vtkIdType end)
         {
-          if (RGBPointsHaveAlpha)
+          for (; i < end; ++i)
           {
-            RGBPoints->SetTuple4(j, vertex.red, vertex.green, vertex.blue, vertex.alpha);
+            const plyVertex &vertex = vertices[i];
+            vtkIdType j = begin + i;
+            std::copy(vertex.x, vertex.x + 3, x + 3 * j);
+            if ( tcoords )
+            {
+              std::copy(vertex.tex, vertex.tex + 2, tcoords + 2 * j);
+            }
+            if ( normals )
+            {
+              std::copy(vertex.normal, vertex.normal + 3, normals + 3 * j);
+            }
+            if ( rgb )
+            {
+              unsigned char *color =
+                rgb + (RGBPointsHaveAlpha ? 4 : 3) * j;
+              color[0] = vertex.red;
+              color[1] = vertex.green;
+              color[2] = vertex.blue;
+              if (RGBPointsHaveAlpha)
+              {
+                color[3] = vertex.alpha;
+              }
+            }
           }
-          else
-          {
-            RGBPoints->SetTuple3(j, vertex.red, vertex.green, vertex.blue);
-          }
-        }
+        });
+        begin += num;
       }
       output->SetPoints(pts);
       pts->Delete();
     }//if vertex
 
-    else if ( elemName && !strcmp ("face", elemName) )
+    else if ( elemName && !readError && !strcmp ("face", elemName) )
     {
       // Create a polygonal array
       numPolys = numElems;
       vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-      polys->Allocate(polys->EstimateSize(numPolys,3),numPolys/2);
-      plyFace face;
-      vtkIdType vtkVerts[256];
+      vtkNew<vtkIdTypeArray> cells;
+      cells->Allocate(polys->EstimateSize(numPolys, 3));
+      std::vector<plyFace> faces(std::min(numPolys, PLY_BATCH_SIZE));
+      std::vector<vtkIdType> locations(faces.size() + 1);
 
       // Get the face properties
       vtkPLY::ply_get_property (ply, elemName, &faceProps[0]);
@@ -351,39 +389,64 @@ int vtkPLYReader::RequestData(
         RGBCells->SetNumberOfTuples(numPolys);
       }
 
-      // grab all the face elements
-      for (int j=0; j < numPolys; j++)
+      // Read the faces in batches: each face is written at its location in
+      // the cell array, given by a prefix sum of the face sizes.
+      unsigned char *intensities = intensityAvailable ?
+        intensity->GetPointer(0) : nullptr;
+      unsigned char *colors = RGBCellsAvailable ?
+        RGBCells->GetPointer(0) : nullptr;
+      for (int begin = 0; begin < numPolys; )
       {
-        //grab and element from the file
-        vtkPLY::ply_get_element (ply, (void *) &face);
-        for (int k=0; k < face.nverts; k++)
+        int num = std::min(numPolys - begin, PLY_BATCH_SIZE);
+        void *listData;
+        int numRead = vtkPLY::ply_get_elements(ply, faces.data(),
+          static_cast<int>(sizeof(plyFace)), num, &listData);
+        if (numRead != num)
         {
-          vtkVerts[k] = face.verts[k];
+          free(listData);
+          vtkErrorMacro(<<"Could not read the faces of " << this->FileName);
+          readError = true;
+          break;
         }
-        free(face.verts); // allocated in vtkPLY::ascii/binary_get_element
 
-        polys->InsertNextCell(face.nverts,vtkVerts);
-        if ( intensityAvailable )
-        {
-          intensity->SetValue(j,face.intensity);
-        }
-        if ( RGBCellsAvailable )
+        vtkSMPTools::Transform(faces.begin(), faces.begin() + num,
+          locations.begin(),
+          [](const plyFace &face) { return face.nverts + 1; });
+        vtkIdType size = vtkSMPTools::ExclusiveScan(locations.begin(),
+          locations.begin() + num, locations.begin(), vtkIdType(0));
+        vtkIdType *connectivity =
+          cells->WritePointer(cells->GetNumberOfValues(), size);
+
+        vtkSMPTools::For(0, num, [&](vtkIdType i, vtkIdType end)
         {
-          if (RGBCellsHaveAlpha)
-          {
-            RGBCells->SetValue(4 * j, face.red);
-            RGBCells->SetValue(4 * j + 1, face.green);
-            RGBCells->SetValue(4 * j + 2, face.blue);
-            RGBCells->SetValue(4 * j + 3, face.alpha);
-          }
-          else
+          for (; i < end; ++i)
           {
-            RGBCells->SetValue(3 * j, face.red);
-            RGBCells->SetValue(3 * j + 1, face.green);
-            RGBCells->SetValue(3 * j + 2, face.blue);
+            const plyFace &face = faces[i];
+            vtkIdType j = begin + i;
+            vtkIdType *cell = connectivity + locations[i];
+            cell[0] = face.nverts;
+            std::copy(face.verts, face.verts + face.nverts, cell + 1);
+            if ( intensities )
+            {
+              intensities[j] = face.intensity;
+            }
+            if ( colors )
+            {
+              unsigned char *color = colors + (RGBCellsHaveAlpha ? 4 : 3) * j;
+              color[0] = face.red;
+              color[1] = face.green;
+              color[2] = face.blue;
+              if (RGBCellsHaveAlpha)
+              {
+                color[3] = face.alpha;
+              }
+            }
           }
-        }
+        });
+        free(listData); // allocated in vtkPLY::ply_get_elements
+        begin += num;
       }
+      polys->SetCells(numPolys, cells);
       output->SetPolys(polys);
     }//if face
 
@@ -399,6 +462,11 @@ int vtkPLYReader::RequestData(
   // close the PLY file
   vtkPLY::ply_close (ply);
 
+  if (readError)
+  {
+    output->Initialize();
+    return 0;
+  }
   return 1;
 }
 
@@ -0,0 +1,180 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestXMLCompressedBlocks.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the compressed blocks of the XML files are the same when they
+// are compressed with the sequential and the parallel SMP backends, and that
+// they are read back correctly.
+
+#include "vtkBitArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkSMPTools.h"
+#include "vtkSOADataArrayTemplate.h"
+#include "vtkStringArray.h"
+#include "vtkXMLImageDataReader.h"
+#include "vtkXMLImageDataWriter.h"
+
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+bool SameArrays(vtkAbstractArray* a1, vtkAbstractArray* a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfValues() != a2->GetNumberOfValues() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a1->GetNumberOfValues(); ++i)
+  {
+    if (a1->GetVariantValue(i) != a2->GetVariantValue(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string Write(vtkImageData* image, int compressor, int byteOrder,
+                  bool encode, bool parallel)
+{
+  vtkNew<vtkXMLImageDataWriter> writer;
+  writer->SetInputData(image);
+  writer->WriteToOutputStringOn();
+  writer->SetDataModeToAppended();
+  writer->SetCompressorType(compressor);
+  writer->SetByteOrder(byteOrder);
+  writer->SetEncodeAppendedData(encode);
+  writer->SetBlockSize(4096);
+
+  vtkSMPTools::Config config;
+  if (!parallel)
+  {
+    config.Backend = "Sequential";
+  }
+  vtkSMPTools::LocalScope(config, [&]() { writer->Write(); });
+  return writer->GetOutputString();
+}
+
+} // anonymous namespace
+
+int TestXMLCompressedBlocks(int, char*[])
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(40, 40, 20);
+  vtkIdType numPoints = image->GetNumberOfPoints();
+
+  vtkNew<vtkFloatArray> floats;
+  floats->SetName("floats");
+  floats->SetNumberOfComponents(3);
+  floats->SetNumberOfTuples(numPoints);
+  vtkNew<vtkSOADataArrayTemplate<double> > doubles;
+  doubles->SetName("doubles");
+  doubles->SetNumberOfComponents(2);
+  doubles->SetNumberOfTuples(numPoints);
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("ids");
+  ids->SetNumberOfTuples(numPoints);
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("bits");
+  bits->SetNumberOfTuples(numPoints);
+  vtkNew<vtkStringArray> strings;
+  strings->SetName("strings");
+  strings->SetNumberOfTuples(numPoints / 10);
+  for (vtkIdType i = 0; i < numPoints; ++i)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      random->Next();
+      floats->SetTypedComponent(i, c, static_cast<float>(i % 100) +
+                                static_cast<float>(random->GetValue()));
+    }
+    random->Next();
+    doubles->SetTypedComponent(i, 0, random->GetValue());
+    doubles->SetTypedComponent(i, 1, static_cast<double>(i));
+    ids->SetValue(i, i / 7);
+    bits->SetValue(i, (i / 3) % 2);
+    if (i % 10 == 0 && i / 10 < strings->GetNumberOfValues())
+    {
+      strings->SetValue(i / 10, std::string(i % 37, 'a' + i % 26));
+    }
+  }
+  image->GetPointData()->AddArray(floats);
+  image->GetPointData()->AddArray(doubles);
+  image->GetPointData()->AddArray(ids);
+  image->GetPointData()->AddArray(bits);
+  image->GetFieldData()->AddArray(strings);
+
+  // The first write caches the ranges of the arrays in their information,
+  // which is written by the next writes.
+  Write(image, vtkXMLWriter::NONE, vtkXMLWriter::LittleEndian, false, false);
+
+  int status = EXIT_SUCCESS;
+  int compressors[2] = { vtkXMLWriter::ZLIB, vtkXMLWriter::LZ4 };
+  for (int c = 0; c < 2; ++c)
+  {
+    for (int encode = 0; encode < 2; ++encode)
+    {
+      // Write big endian base64 data to also swap the bytes.
+      int byteOrder =
+        encode ? vtkXMLWriter::BigEndian : vtkXMLWriter::LittleEndian;
+      std::string sequential =
+        Write(image, compressors[c], byteOrder, encode != 0, false);
+      std::string parallel =
+        Write(image, compressors[c], byteOrder, encode != 0, true);
+      if (sequential != parallel)
+      {
+        cerr << "Sequential and parallel files differ for compressor "
+             << compressors[c] << " and encoding " << encode << endl;
+        status = EXIT_FAILURE;
+      }
+
+      vtkNew<vtkXMLImageDataReader> reader;
+      reader->ReadFromInputStringOn();
+      reader->SetInputString(parallel);
+      reader->Update();
+      vtkImageData* output = reader->GetOutput();
+      const char* names[4] = { "floats", "doubles", "ids", "bits" };
+      for (int a = 0; a < 4; ++a)
+      {
+        if (!SameArrays(image->GetPointData()->GetAbstractArray(names[a]),
+                        output->GetPointData()->GetAbstractArray(names[a])))
+        {
+          cerr << "Wrong array " << names[a] << " for compressor "
+               << compressors[c] << " and encoding " << encode << endl;
+          status = EXIT_FAILURE;
+        }
+      }
+      if (!SameArrays(strings,
+                      output->GetFieldData()->GetAbstractArray("strings")))
+      {
+        cerr << "Wrong string array for compressor " << compressors[c]
+             << " and encoding " << encode << endl;
+        status = EXIT_FAILURE;
+      }
+    }
+  }
+
+  return status;
+}
@@ -0,0 +1,177 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestXMLReaderMemoryMap.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the arrays read with a memory map of the file are the same as
+// the arrays read as usual, and that they outlive the reader and can be
+// modified without modifying the file.
+
+#include "vtkBitArray.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCharArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnstructuredGrid.h"
+#include "vtkXMLUnstructuredGridReader.h"
+#include "vtkXMLUnstructuredGridWriter.h"
+
+#include <string>
+
+namespace
+{
+
+bool SameArrays(vtkAbstractArray* a1, vtkAbstractArray* a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfValues() != a2->GetNumberOfValues() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+  {
+    return false;
+  }
+  for (vtkIdType i = 0; i < a1->GetNumberOfValues(); ++i)
+  {
+    if (a1->GetVariantValue(i) != a2->GetVariantValue(i))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SameGrids(vtkUnstructuredGrid* g1, vtkUnstructuredGrid* g2)
+{
+  const char* names[4] = { "doubles", "ints", "chars", "bits" };
+  for (int a = 0; a < 4; ++a)
+  {
+    if (!SameArrays(g1->GetPointData()->GetAbstractArray(names[a]),
+                    g2->GetPointData()->GetAbstractArray(names[a])))
+    {
+      cerr << "Wrong array " << names[a] << endl;
+      return false;
+    }
+  }
+  if (!SameArrays(g1->GetPoints()->GetData(), g2->GetPoints()->GetData()) ||
+      !SameArrays(g1->GetCellData()->GetAbstractArray("ids"),
+                  g2->GetCellData()->GetAbstractArray("ids")))
+  {
+    cerr << "Wrong points or cell data" << endl;
+    return false;
+  }
+  return true;
+}
+
+vtkSmartPointer<vtkUnstructuredGrid> Read(const std::string& filename,
+                                          bool useMemoryMap)
+{
+  vtkNew<vtkXMLUnstructuredGridReader> reader;
+  reader->SetFileName(filename.c_str());
+  reader->SetUseMemoryMap(useMemoryMap);
+  reader->Update();
+  return reader->GetOutput();
+}
+
+} // anonymous namespace
+
+int TestXMLReaderMemoryMap(int argc, char* argv[])
+{
+  char* temp_dir_c =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv,
+                                           "VTK_TEMP_DIR",
+                                           "Testing/Temporary");
+  std::string temp_dir = std::string(temp_dir_c);
+  delete [] temp_dir_c;
+
+  if (temp_dir.empty())
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string filename = temp_dir + "/testXMLReaderMemoryMap.vtu";
+
+  // A cloud of vertices with arrays of several types and sizes, so that
+  // some arrays are aligned in the file and the others are not.
+  const vtkIdType numPoints = 1000;
+  vtkNew<vtkUnstructuredGrid> grid;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkDoubleArray> doubles;
+  doubles->SetName("doubles");
+  doubles->SetNumberOfComponents(2);
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("ints");
+  vtkNew<vtkCharArray> chars;
+  chars->SetName("chars");
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("bits");
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("ids");
+  for (vtkIdType i = 0; i < numPoints; ++i)
+  {
+    points->InsertNextPoint(i % 10, (i / 10) % 10, i / 100);
+    verts->InsertNextCell(1, &i);
+    doubles->InsertNextTuple2(0.5 * i, -0.25 * i);
+    ints->InsertNextValue(static_cast<int>(3 * i - 1000));
+    chars->InsertNextValue(static_cast<char>(i % 128));
+    bits->InsertNextValue(static_cast<int>(i % 3 == 0));
+    ids->InsertNextValue(numPoints - i);
+  }
+  grid->SetPoints(points);
+  grid->SetCells(VTK_VERTEX, verts);
+  grid->GetPointData()->AddArray(doubles);
+  grid->GetPointData()->AddArray(ints);
+  grid->GetPointData()->AddArray(chars);
+  grid->GetPointData()->AddArray(bits);
+  grid->GetCellData()->AddArray(ids);
+
+  vtkNew<vtkXMLUnstructuredGridWriter> writer;
+  writer->SetFileName(filename.c_str());
+  writer->SetInputData(grid);
+  writer->SetDataModeToAppended();
+  writer->EncodeAppendedDataOff();
+  writer->SetCompressorTypeToNone();
+  writer->Write();
+
+  // The arrays outlive the reader and its memory map.
+  vtkSmartPointer<vtkUnstructuredGrid> mapped = Read(filename, true);
+  if (!SameGrids(grid, mapped) || !SameGrids(grid, Read(filename, false)))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Modify and grow the arrays, then make sure the file is unchanged.
+  vtkDataArray* mappedChars = mapped->GetPointData()->GetArray("chars");
+  vtkDataArray* mappedDoubles = mapped->GetPointData()->GetArray("doubles");
+  mappedChars->SetComponent(0, 0, 1.0);
+  mappedDoubles->InsertNextTuple2(1.0, 2.0);
+  if (mappedChars->GetComponent(0, 0) != 1.0 ||
+      mappedDoubles->GetComponent(numPoints - 1, 1) != -0.25 * (numPoints - 1))
+  {
+    cerr << "Wrong modified arrays" << endl;
+    return EXIT_FAILURE;
+  }
+  mapped = nullptr;
+  if (!SameGrids(grid, Read(filename, true)))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
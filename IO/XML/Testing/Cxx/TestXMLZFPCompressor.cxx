@@ -0,0 +1,269 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestXMLZFPCompressor.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Write image data and polydata with vtkZFPDataCompressor in each mode, and
+// check that the floating-point arrays are read back within the requested
+// error, and the other arrays exactly. The image arrays, written with the
+// default block size, must be split in blocks of whole slices.
+
+#include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkXMLImageDataReader.h"
+#include "vtkXMLImageDataWriter.h"
+#include "vtkXMLPolyDataReader.h"
+#include "vtkXMLPolyDataWriter.h"
+#include "vtkZFPDataCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+// The largest difference between the arrays, or -1 if they do not match.
+double MaxError(vtkAbstractArray* a1, vtkAbstractArray* a2)
+{
+  vtkDataArray* d1 = vtkDataArray::SafeDownCast(a1);
+  vtkDataArray* d2 = vtkDataArray::SafeDownCast(a2);
+  if (!d1 || !d2 || d1->GetDataType() != d2->GetDataType() ||
+      d1->GetNumberOfTuples() != d2->GetNumberOfTuples() ||
+      d1->GetNumberOfComponents() != d2->GetNumberOfComponents())
+  {
+    return -1.0;
+  }
+  double error = 0.0;
+  for (vtkIdType i = 0; i < d1->GetNumberOfTuples(); ++i)
+  {
+    for (int c = 0; c < d1->GetNumberOfComponents(); ++c)
+    {
+      error = std::max(error, std::abs(d1->GetComponent(i, c) -
+                                       d2->GetComponent(i, c)));
+    }
+  }
+  return error;
+}
+
+// Read the block size of an array from its compression header, in the raw
+// appended data written with 64-bit headers in the native byte order.
+// Returns 0 if the array is not found.
+vtkTypeUInt64 GetBlockSize(const std::string& xml, const char* name)
+{
+  size_t array = xml.find("Name=\"" + std::string(name) + "\"");
+  size_t offset = xml.find("offset=\"", array);
+  size_t appended = xml.find("<AppendedData");
+  size_t data = xml.find('_', appended);
+  if (array == std::string::npos || offset == std::string::npos ||
+      appended == std::string::npos || data == std::string::npos)
+  {
+    return 0;
+  }
+  size_t header = data + 1 + std::stoul(xml.substr(offset + 8));
+  vtkTypeUInt64 words[2];
+  if (header + sizeof(words) > xml.size())
+  {
+    return 0;
+  }
+  memcpy(words, xml.data() + header, sizeof(words));
+  return words[1];
+}
+
+vtkZFPDataCompressor* NewCompressor(int mode)
+{
+  vtkZFPDataCompressor* compressor = vtkZFPDataCompressor::New();
+  compressor->SetMode(mode);
+  compressor->SetRate(24.0);
+  compressor->SetPrecision(40);
+  compressor->SetTolerance(1e-5);
+  return compressor;
+}
+
+// The largest error allowed for values of magnitude up to 2.
+double Tolerance(int mode)
+{
+  switch (mode)
+  {
+    case vtkZFPDataCompressor::FIXED_RATE:
+      return 1e-3;
+    case vtkZFPDataCompressor::FIXED_PRECISION:
+      return 1e-6;
+    case vtkZFPDataCompressor::FIXED_ACCURACY:
+      return 1e-5;
+    default:
+      return 0.0;
+  }
+}
+
+int TestImage(int mode, int byteOrder)
+{
+  // Smooth fields, with slices smaller than the default block size.
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(32, 24, 16);
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(image->GetNumberOfPoints());
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(image->GetNumberOfPoints());
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("ints");
+  ints->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    image->GetPoint(i, x);
+    vectors->SetTuple3(i, sin(0.2 * x[0]), cos(0.3 * x[1]), sin(0.1 * x[2]));
+    scalars->SetValue(i, sin(0.2 * x[0]) * cos(0.15 * x[1]) + 0.01 * x[2]);
+    ints->SetValue(i, static_cast<int>(i * 7919 % 1000));
+  }
+  image->GetPointData()->AddArray(vectors);
+  image->GetPointData()->AddArray(scalars);
+  image->GetPointData()->AddArray(ints);
+
+  vtkNew<vtkXMLImageDataWriter> writer;
+  vtkZFPDataCompressor* compressor = NewCompressor(mode);
+  writer->SetCompressor(compressor);
+  compressor->Delete();
+  writer->SetByteOrder(byteOrder);
+  writer->SetHeaderTypeToUInt64();
+  writer->SetDataModeToAppended();
+  writer->EncodeAppendedDataOff();
+  writer->SetInputData(image);
+  writer->WriteToOutputStringOn();
+  writer->Write();
+
+  vtkNew<vtkXMLImageDataReader> reader;
+  reader->ReadFromInputStringOn();
+  reader->SetInputString(writer->GetOutputString());
+  reader->Update();
+  vtkPointData* pd = reader->GetOutput()->GetPointData();
+
+  // Data not in the native byte order are compressed losslessly.
+  double tolerance = Tolerance(mode);
+#ifdef VTK_WORDS_BIGENDIAN
+  if (byteOrder != vtkXMLWriter::BigEndian)
+#else
+  if (byteOrder != vtkXMLWriter::LittleEndian)
+#endif
+  {
+    tolerance = 0.0;
+  }
+  double vectorsError = MaxError(vectors, pd->GetArray("vectors"));
+  double scalarsError = MaxError(scalars, pd->GetArray("scalars"));
+  if (vectorsError < 0.0 || vectorsError > tolerance ||
+      scalarsError < 0.0 || scalarsError > tolerance ||
+      MaxError(ints, pd->GetArray("ints")) != 0.0)
+  {
+    cerr << "Wrong image arrays for mode " << mode << " and byte order "
+         << byteOrder << ": errors " << vectorsError << " and "
+         << scalarsError << endl;
+    return 1;
+  }
+
+  // The arrays compressed with zfp are split in blocks of at least two
+  // whole slices, to be compressed as 3D fields.
+  if (tolerance > 0.0)
+  {
+    const std::string& xml = writer->GetOutputString();
+    vtkTypeUInt64 vectorsSlice = 32 * 24 * 3 * sizeof(float);
+    vtkTypeUInt64 scalarsSlice = 32 * 24 * sizeof(double);
+    vtkTypeUInt64 vectorsBlock = GetBlockSize(xml, "vectors");
+    vtkTypeUInt64 scalarsBlock = GetBlockSize(xml, "scalars");
+    if (vectorsBlock % vectorsSlice != 0 || vectorsBlock < 2 * vectorsSlice ||
+        scalarsBlock % scalarsSlice != 0 || scalarsBlock < 2 * scalarsSlice)
+    {
+      cerr << "Wrong block sizes for mode " << mode << ": " << vectorsBlock
+           << " and " << scalarsBlock << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int TestPolyData(int mode)
+{
+  // A line of points, with the points and a scalar array compressed as 1D
+  // streams.
+  vtkNew<vtkPolyData> polyData;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  for (vtkIdType i = 0; i < 5000; ++i)
+  {
+    double t = 0.001 * i;
+    points->InsertNextPoint(cos(t), sin(t), t);
+    verts->InsertNextCell(1, &i);
+    scalars->InsertNextValue(static_cast<float>(cos(3.0 * t)));
+  }
+  polyData->SetPoints(points);
+  polyData->SetVerts(verts);
+  polyData->GetPointData()->SetScalars(scalars);
+
+  vtkNew<vtkXMLPolyDataWriter> writer;
+  vtkZFPDataCompressor* compressor = NewCompressor(mode);
+  writer->SetCompressor(compressor);
+  compressor->Delete();
+  writer->SetInputData(polyData);
+  writer->WriteToOutputStringOn();
+  writer->Write();
+
+  vtkNew<vtkXMLPolyDataReader> reader;
+  reader->ReadFromInputStringOn();
+  reader->SetInputString(writer->GetOutputString());
+  reader->Update();
+  vtkPolyData* output = reader->GetOutput();
+
+  double tolerance = Tolerance(mode);
+  double pointsError = MaxError(points->GetData(),
+                                output->GetPoints()->GetData());
+  double scalarsError = MaxError(scalars,
+                                 output->GetPointData()->GetArray("scalars"));
+  if (pointsError < 0.0 || pointsError > 5 * tolerance ||
+      scalarsError < 0.0 || scalarsError > tolerance ||
+      output->GetNumberOfVerts() != polyData->GetNumberOfVerts() ||
+      MaxError(polyData->GetVerts()->GetData(),
+               output->GetVerts()->GetData()) != 0.0)
+  {
+    cerr << "Wrong polydata arrays for mode " << mode << ": errors "
+         << pointsError << " and " << scalarsError << endl;
+    return 1;
+  }
+  return 0;
+}
+
+} // anonymous namespace
+
+int TestXMLZFPCompressor(int, char*[])
+{
+  int errors = 0;
+  for (int mode = vtkZFPDataCompressor::FIXED_RATE;
+       mode <= vtkZFPDataCompressor::REVERSIBLE; ++mode)
+  {
+    errors += TestImage(mode, vtkXMLWriter::LittleEndian);
+    errors += TestImage(mode, vtkXMLWriter::BigEndian);
+    errors += TestPolyData(mode);
+  }
+  return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkXMLReader.h"
 
+#include "vtkAOSDataArrayTemplate.h"
 #include "vtkArrayIteratorIncludes.h"
 #include "vtkCallbackCommand.h"
 #include "vtkDataArraySelection.h"
@@ -40,6 +41,7 @@
 #include "vtkXMLDataParser.h"
 #include "vtkXMLFileReadTester.h"
 #include "vtkXMLReaderVersion.h"
+#include "vtkZFPDataCompressor.h"
 #include "vtkZLibDataCompressor.h"
 
 #include <vtksys/SystemTools.hxx>
@@ -48,9 +50,20 @@
 #include <cassert>
 #include <functional>
 #include <locale> // C++ locale
+#include <memory>
 #include <sstream>
 #include <vector>
 
+#if defined(_WIN32) && !defined(__CYGWIN__)
+# include "vtkWindows.h"
+# include <vtksys/Encoding.hxx>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 vtkCxxSetObjectMacro(vtkXMLReader,ReaderErrorObserver,vtkCommand);
 vtkCxxSetObjectMacro(vtkXMLReader,ParserErrorObserver,vtkCommand);
 
@@ -95,6 +108,125 @@ static void ReadStringVersion(const char* version, int& major, int& minor)
     }
   }
 }
+//----------------------------------------------------------------------------
+namespace
+{
+
+// A private, copy-on-write memory map of a whole file.
+class vtkXMLReaderMappedFile
+{
+public:
+  vtkXMLReaderMappedFile() : Data(nullptr), Size(0) {}
+
+  ~vtkXMLReaderMappedFile()
+  {
+    if (this->Data)
+    {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+      UnmapViewOfFile(this->Data);
+#else
+      munmap(this->Data, this->Size);
+#endif
+    }
+  }
+
+  bool Open(const char* fileName)
+  {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    // the file names are UTF-8
+    HANDLE file = CreateFileW(
+      vtksys::Encoding::ToWindowsExtendedPath(fileName).c_str(), GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+      mapping =
+        CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    }
+    if (mapping)
+    {
+      this->Data = static_cast<unsigned char*>(
+        MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+      this->Size = static_cast<size_t>(size.QuadPart);
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+    {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void* data = mmap(nullptr, static_cast<size_t>(st.st_size),
+                        PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        this->Data = static_cast<unsigned char*>(data);
+        this->Size = static_cast<size_t>(st.st_size);
+      }
+    }
+    close(fd);
+#endif
+    return this->Data != nullptr;
+  }
+
+  unsigned char* Data;
+  size_t Size;
+
+private:
+  vtkXMLReaderMappedFile(const vtkXMLReaderMappedFile&) = delete;
+  void operator=(const vtkXMLReaderMappedFile&) = delete;
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+int vtkXMLReaderMapArray(T*, vtkAbstractArray* array,
+                         const std::shared_ptr<vtkXMLReaderMappedFile>& file,
+                         vtkTypeInt64 position, vtkIdType numValues)
+{
+  vtkAOSDataArrayTemplate<T>* aos =
+    vtkArrayDownCast<vtkAOSDataArrayTemplate<T> >(array);
+  size_t end = static_cast<size_t>(position) + numValues * sizeof(T);
+  if (!aos || end > file->Size)
+  {
+    return 0;
+  }
+  T* data = reinterpret_cast<T*>(file->Data + position);
+  if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+  {
+    return 0;
+  }
+
+  // The free function of the array keeps a reference to the memory map, so
+  // that the map is released with the last array using it.
+  aos->SetArray(data, numValues, 1);
+  aos->SetArrayFreeFunction([file](void*) {});
+  return 1;
+}
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// The memory map of the file read by a vtkXMLReader.
+class vtkXMLReaderMemoryMap
+{
+public:
+  vtkXMLReaderMemoryMap() : Failed(false) {}
+
+  std::shared_ptr<vtkXMLReaderMappedFile> File;
+
+  // Whether the file could not be mapped.
+  bool Failed;
+};
+
 //----------------------------------------------------------------------------
 vtkXMLReader::vtkXMLReader()
 {
@@ -104,6 +236,8 @@ vtkXMLReader::vtkXMLReader()
   this->StringStream = nullptr;
   this->ReadFromInputString = 0;
   this->InputString = "";
+  this->UseMemoryMap = 0;
+  this->MemoryMap = new vtkXMLReaderMemoryMap;
   this->XMLParser = nullptr;
   this->ReaderErrorObserver = nullptr;
   this->ParserErrorObserver = nullptr;
@@ -161,6 +295,7 @@ vtkXMLReader::~vtkXMLReader()
     this->DestroyXMLParser();
   }
   this->CloseStream();
+  delete this->MemoryMap;
   this->CellDataArraySelection->RemoveObserver(this->SelectionObserver);
   this->PointDataArraySelection->RemoveObserver(this->SelectionObserver);
   this->ColumnArraySelection->RemoveObserver(this->SelectionObserver);
@@ -199,6 +334,7 @@ void vtkXMLReader::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << indent << "Stream: (none)\n";
   }
+  os << indent << "UseMemoryMap: " << this->UseMemoryMap << "\n";
   os << indent << "TimeStep:" << this->TimeStep << "\n";
   os << indent << "NumberOfTimeSteps:" << this->NumberOfTimeSteps << "\n";
   os << indent << "TimeStepRange:(" << this->TimeStepRange[0] << ","
@@ -357,6 +493,10 @@ void vtkXMLReader::CloseVTKFile()
     this->FileStream->close();
     delete this->FileStream;
     this->FileStream = nullptr;
+
+    // The arrays using the memory map keep it alive.
+    this->MemoryMap->File.reset();
+    this->MemoryMap->Failed = false;
   }
 }
 
@@ -421,6 +561,10 @@ void vtkXMLReader::SetupCompressor(const char* type)
     {
       compressor = vtkLZ4DataCompressor::New();
     }
+    else if (strcmp(type, "vtkZFPDataCompressor") == 0)
+    {
+      compressor = vtkZFPDataCompressor::New();
+    }
   }
 
   if (!compressor)
@@ -807,19 +951,27 @@ int vtkXMLReader::ReadArrayValues(
   }
   this->InReadData = 1;
   int result;
-  // All arrays types except vtkBitArray.
-  vtkArrayIterator* iter = array->NewIterator();
-  switch (array->GetDataType())
+  if (this->UseMemoryMap &&
+      this->MapArrayValues(da, arrayIndex, array, startIndex, numValues))
   {
-    vtkArrayIteratorTemplateMacro(
-      result = vtkXMLDataReaderReadArrayValues(da, this->XMLParser,
-        arrayIndex, static_cast<VTK_TT*>(iter), startIndex, numValues));
-  default:
-    result = 0;
+    result = 1;
   }
-  if (iter)
+  else
   {
-    iter->Delete();
+    // All arrays types except vtkBitArray.
+    vtkArrayIterator* iter = array->NewIterator();
+    switch (array->GetDataType())
+    {
+      vtkArrayIteratorTemplateMacro(
+        result = vtkXMLDataReaderReadArrayValues(da, this->XMLParser,
+          arrayIndex, static_cast<VTK_TT*>(iter), startIndex, numValues));
+    default:
+      result = 0;
+    }
+    if (iter)
+    {
+      iter->Delete();
+    }
   }
 
   this->ConvertGhostLevelsToGhostType(fieldType, array, startIndex, numValues);
@@ -835,6 +987,55 @@ int vtkXMLReader::ReadArrayValues(
   return result;
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLReader::MapArrayValues(
+  vtkXMLDataElement* da, vtkIdType arrayIndex,
+  vtkAbstractArray* array, vtkIdType startIndex, vtkIdType numValues)
+{
+  // Only whole arrays read from a file we opened can use its memory map.
+  vtkTypeInt64 offset = 0;
+  if (!this->FileStream || this->Stream != this->FileStream ||
+      this->MemoryMap->Failed || arrayIndex != 0 || numValues <= 0 ||
+      numValues != array->GetNumberOfValues() ||
+      !vtkArrayDownCast<vtkDataArray>(array) ||
+      array->GetDataType() == VTK_BIT ||
+      !da->GetScalarAttribute("offset", offset))
+  {
+    return 0;
+  }
+
+  vtkTypeInt64 position = this->XMLParser->FindRawAppendedData(
+    offset, startIndex, numValues, array->GetDataType());
+  if (position < 0)
+  {
+    return 0;
+  }
+
+  if (!this->MemoryMap->File)
+  {
+    std::shared_ptr<vtkXMLReaderMappedFile> file =
+      std::make_shared<vtkXMLReaderMappedFile>();
+    if (!file->Open(this->FileName))
+    {
+      vtkWarningMacro("Cannot map file " << this->FileName
+                      << " in memory, reading it instead.");
+      this->MemoryMap->Failed = true;
+      return 0;
+    }
+    this->MemoryMap->File = file;
+  }
+
+  int result = 0;
+  switch (array->GetDataType())
+  {
+    vtkTemplateMacro(
+      result = vtkXMLReaderMapArray(static_cast<VTK_TT*>(nullptr), array,
+                                    this->MemoryMap->File, position,
+                                    numValues));
+  }
+  return result;
+}
+
 //----------------------------------------------------------------------------
 void vtkXMLReader::ReadXMLData()
 {
@@ -39,6 +39,7 @@ class vtkXMLDataParser;
 class vtkInformationVector;
 class vtkInformation;
 class vtkCommand;
+class vtkXMLReaderMemoryMap;
 
 class VTKIOXML_EXPORT vtkXMLReader : public vtkAlgorithm
 {
@@ -72,6 +73,21 @@ public:
   void SetInputString(const std::string& s) { this->InputString = s; }
   //@}
 
+  //@{
+  /**
+   * When on, the arrays of the appended data section of a file that are
+   * read entirely and stored exactly as in memory (raw encoded, not
+   * compressed, in the byte order of this machine and aligned for their
+   * value type) are not copied: they directly use a private memory map of
+   * the file. The pages of the file are then only loaded when the data are
+   * accessed and are shared by all the processes reading the file, until
+   * they are modified. The other arrays are read as usual. Off by default.
+   */
+  vtkSetMacro(UseMemoryMap, vtkTypeBool);
+  vtkGetMacro(UseMemoryMap, vtkTypeBool);
+  vtkBooleanMacro(UseMemoryMap, vtkTypeBool);
+  //@}
+
   /**
    * Test whether the file (type) with the given name can be read by this
    * reader. If the file has a newer version than the reader, we still say
@@ -277,6 +293,12 @@ protected:
     vtkXMLDataElement* da, vtkIdType arrayIndex, vtkAbstractArray* array,
     vtkIdType startIndex, vtkIdType numValues, FieldType type = OTHER);
 
+  // Make the array use the memory map of the file, if possible, instead of
+  // reading its values. Returns 1 if it does.
+  int MapArrayValues(vtkXMLDataElement* da, vtkIdType arrayIndex,
+                     vtkAbstractArray* array, vtkIdType startIndex,
+                     vtkIdType numValues);
+
   // Setup the data array selections for the input's set of arrays.
   void SetDataArraySelections(vtkXMLDataElement* eDSA,
                               vtkDataArraySelection* sel);
@@ -315,6 +337,9 @@ protected:
   // The input string.
   std::string InputString;
 
+  // Whether to use a memory map of the file for the raw appended arrays.
+  vtkTypeBool UseMemoryMap;
+
   // The array selections.
   vtkDataArraySelection* PointDataArraySelection;
   vtkDataArraySelection* CellDataArraySelection;
@@ -393,6 +418,8 @@ private:
   ifstream* FileStream;
   // The stream used to read the input if it is in a string.
   std::istringstream* StringStream;
+  // The memory map of the file, if UseMemoryMap is on.
+  vtkXMLReaderMemoryMap* MemoryMap;
   int TimeStepWasReadOnce;
 
   int FileMajorVersion;
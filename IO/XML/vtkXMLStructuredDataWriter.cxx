@@ -29,6 +29,8 @@
 #include "vtkXMLOffsetsManager.h"
 #undef  vtkXMLOffsetsManager_DoNotInclude
 
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 vtkXMLStructuredDataWriter::vtkXMLStructuredDataWriter()
 {
@@ -583,17 +585,21 @@ void vtkXMLStructuredDataWriter::WriteAppendedPieceData(int index)
 
   // Set the range of progress for the point data arrays.
   this->SetProgressRange(progressRange, 0, fractions);
+  this->SetArrayDimensions(false);
   this->WritePointDataAppendedData(input->GetPointData(), this->CurrentTimeIndex,
                                    &this->PointDataOM->GetPiece(index));
   if (this->ErrorCode == vtkErrorCode::OutOfDiskSpaceError)
   {
+    this->ClearArrayDimensions();
     return;
   }
 
   // Set the range of progress for the cell data arrays.
   this->SetProgressRange(progressRange, 1, fractions);
+  this->SetArrayDimensions(true);
   this->WriteCellDataAppendedData(input->GetCellData(), this->CurrentTimeIndex,
                                   &this->CellDataOM->GetPiece(index));
+  this->ClearArrayDimensions();
 }
 
 //----------------------------------------------------------------------------
@@ -617,15 +623,19 @@ void vtkXMLStructuredDataWriter::WriteInlinePiece(vtkIndent indent)
 
   // Set the range of progress for the point data arrays.
   this->SetProgressRange(progressRange, 0, fractions);
+  this->SetArrayDimensions(false);
   this->WritePointDataInline(input->GetPointData(), indent);
   if (this->ErrorCode == vtkErrorCode::OutOfDiskSpaceError)
   {
+    this->ClearArrayDimensions();
     return;
   }
 
   // Set the range of progress for the cell data arrays.
   this->SetProgressRange(progressRange, 1, fractions);
+  this->SetArrayDimensions(true);
   this->WriteCellDataInline(input->GetCellData(), indent);
+  this->ClearArrayDimensions();
 }
 
 //----------------------------------------------------------------------------
@@ -638,6 +648,27 @@ vtkIdType vtkXMLStructuredDataWriter::GetStartTuple(int* extent,
           ((k - extent[4]) * increments[2]));
 }
 
+//----------------------------------------------------------------------------
+void vtkXMLStructuredDataWriter::SetArrayDimensions(bool cellData)
+{
+  int extent[6];
+  this->GetInputExtent(extent);
+  for (int i = 0; i < 3; ++i)
+  {
+    int numPoints = extent[2*i+1] - extent[2*i] + 1;
+    this->ArrayDimensions[i] =
+      cellData ? std::max(numPoints - 1, 1) : std::max(numPoints, 1);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkXMLStructuredDataWriter::ClearArrayDimensions()
+{
+  this->ArrayDimensions[0] = 0;
+  this->ArrayDimensions[1] = 0;
+  this->ArrayDimensions[2] = 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkXMLStructuredDataWriter::CalculatePieceFractions(float* fractions)
 {
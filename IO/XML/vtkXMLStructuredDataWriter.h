@@ -95,6 +95,11 @@ protected:
                           int i, int j, int k);
   void CalculatePieceFractions(float* fractions);
 
+  // Describe the point or cell data arrays of the input extent to the
+  // compressor, or stop describing them.
+  void SetArrayDimensions(bool cellData);
+  void ClearArrayDimensions();
+
   void SetInputUpdateExtent(int piece);
   int ProcessRequest(vtkInformation* request,
                      vtkInformationVector** inputVector,
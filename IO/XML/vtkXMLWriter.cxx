@@ -42,9 +42,11 @@
 #include "vtkOutputStream.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkStdString.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkUnsignedCharArray.h"
+#include "vtkZFPDataCompressor.h"
 #include "vtkZLibDataCompressor.h"
 #define vtkXMLOffsetsManager_DoNotInclude
 #include "vtkXMLOffsetsManager.h"
@@ -58,11 +60,13 @@
 #include "vtkQuadratureSchemeDefinition.h"
 #include "vtkInformationStringKey.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <cassert>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #if !defined(_WIN32) || defined(__CYGWIN__)
 # include <unistd.h> /* unlink */
@@ -74,6 +78,26 @@
 #include <locale> // C++ locale
 
 
+//*****************************************************************************
+// The blocks of an array buffered by vtkXMLWriter::WriteCompressionBlock, so
+// that they can be compressed together by several threads.
+class vtkXMLWriterCompressionBlocks
+{
+public:
+  // The maximum number of buffered blocks.
+  size_t Capacity;
+
+  // The uncompressed data and sizes of the buffered blocks.
+  std::vector<unsigned char> Data;
+  std::vector<size_t> Sizes;
+
+  // The compressed data and sizes.
+  std::vector<unsigned char> CompressedData;
+  std::vector<size_t> CompressedSizes;
+
+  vtkXMLWriterCompressionBlocks() : Capacity(1) {}
+};
+
 //*****************************************************************************
 // Friend class to enable access for template functions to the protected
 // writer methods.
@@ -473,6 +497,10 @@ vtkXMLWriter::vtkXMLWriter()
   this->BlockSize = 32768; //2^15
   this->Compressor = vtkZLibDataCompressor::New();
   this->CompressionHeader = nullptr;
+  this->CompressionBlocks = new vtkXMLWriterCompressionBlocks;
+  this->ArrayDimensions[0] = 0;
+  this->ArrayDimensions[1] = 0;
+  this->ArrayDimensions[2] = 0;
   this->Int32IdTypeBuffer = nullptr;
   this->ByteSwapBuffer = nullptr;
 
@@ -503,6 +531,7 @@ vtkXMLWriter::~vtkXMLWriter()
   this->SetFileName(nullptr);
   this->DataStream->Delete();
   this->SetCompressor(nullptr);
+  delete this->CompressionBlocks;
   delete this->OutFile;
   this->OutFile = nullptr;
   delete this->OutStringStream;
@@ -541,6 +570,15 @@ void vtkXMLWriter::SetCompressorType(int compressorType)
     this->Compressor = vtkLZ4DataCompressor::New();
     this->Modified();
   }
+  else if (compressorType == ZFP)
+  {
+    if (this->Compressor &&
+        !this->Compressor->IsTypeOf("vtkZFPDataCompressor")) {
+      this->Compressor->Delete();
+    }
+    this->Compressor = vtkZFPDataCompressor::New();
+    this->Modified();
+  }
   else
   {
     vtkWarningMacro("Invalid compressorType:" << compressorType);
@@ -1289,10 +1327,35 @@ int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
 
   if (this->Compressor)
   {
+    // Describe the data to the compressor.  The values are described only
+    // when they are written as they are in memory.
+    int dataType = wordType;
+#ifdef VTK_WORDS_BIGENDIAN
+    if (this->ByteOrder != vtkXMLWriter::BigEndian ||
+#else
+    if (this->ByteOrder != vtkXMLWriter::LittleEndian ||
+#endif
+        wordType == VTK_BIT ||
+        this->GetOutputWordTypeSize(wordType) != this->GetWordTypeSize(wordType))
+    {
+      dataType = VTK_VOID;
+    }
+    bool structured = this->ArrayDimensions[0] > 0;
+    this->Compressor->SetDataDescription(
+      dataType, a->GetNumberOfComponents(),
+      structured ? this->ArrayDimensions : nullptr);
+
+    // Split the array in the blocks preferred by the compressor for these
+    // data, e.g. whole slices of the grid for zfp.  The block size is
+    // recorded in the compression header, so readers need not know it.
+    size_t blockSize = this->BlockSize;
+    this->BlockSize = this->Compressor->GetPreferredBlockSize(blockSize);
+
     // Need to compress the data.  Create compression header.  This
     // reserves enough space in the output.
     if (!this->CreateCompressionHeader(dataSize))
     {
+      this->BlockSize = blockSize;
       return 0;
     }
     // Start writing the data.
@@ -1304,6 +1367,12 @@ int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
       result = 0;
     }
 
+    // Compress and write the blocks still buffered.
+    if (result && !this->FlushCompressionBlocks())
+    {
+      result = 0;
+    }
+
     // Finish writing the data.
     if (result && !this->DataStream->EndWriting())
     {
@@ -1320,6 +1389,7 @@ int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
     delete this->CompressionHeader;
     this->CompressionHeader = nullptr;
 
+    this->BlockSize = blockSize;
     return result;
   }
   else
@@ -1664,32 +1734,84 @@ int vtkXMLWriter::CreateCompressionHeader(size_t size)
   // Initialize counter for block writing.
   this->CompressionBlockNumber = 0;
 
+  // Buffer enough blocks to keep all the threads busy, within 16 MB, when
+  // the compressor can be copied to compress them concurrently.
+  vtkXMLWriterCompressionBlocks* blocks = this->CompressionBlocks;
+  size_t threads =
+    static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads());
+  size_t maxBlocks = std::max<size_t>(1, (1 << 24) / this->BlockSize);
+  blocks->Capacity = std::min(std::min(4 * threads, maxBlocks),
+                              std::max<size_t>(numBlocks, 1));
+  blocks->Sizes.clear();
+  blocks->Data.resize(blocks->Capacity * this->BlockSize);
+  blocks->CompressedData.resize(
+    blocks->Capacity *
+    this->Compressor->GetMaximumCompressionSpace(this->BlockSize));
+
   return result;
 }
 
 //----------------------------------------------------------------------------
 int vtkXMLWriter::WriteCompressionBlock(unsigned char* data, size_t size)
 {
-  // Compress the data.
-  vtkUnsignedCharArray* outputArray = this->Compressor->Compress(data, size);
+  // Buffer the data, and compress the buffered blocks once there are
+  // enough of them.
+  vtkXMLWriterCompressionBlocks* blocks = this->CompressionBlocks;
+  memcpy(&blocks->Data[blocks->Sizes.size() * this->BlockSize], data, size);
+  blocks->Sizes.push_back(size);
+  if (blocks->Sizes.size() < blocks->Capacity)
+  {
+    return 1;
+  }
+  return this->FlushCompressionBlocks();
+}
+
+//----------------------------------------------------------------------------
+int vtkXMLWriter::FlushCompressionBlocks()
+{
+  vtkXMLWriterCompressionBlocks* blocks = this->CompressionBlocks;
+  size_t numBlocks = blocks->Sizes.size();
+  if (numBlocks == 0)
+  {
+    return 1;
+  }
 
-  // Find the compressed size.
-  size_t outputSize = outputArray->GetNumberOfTuples();
-  unsigned char* outputPointer = outputArray->GetPointer(0);
+  // Compress the blocks, concurrently if possible.
+  size_t space = this->Compressor->GetMaximumCompressionSpace(this->BlockSize);
+  std::vector<unsigned char const*> input(numBlocks);
+  std::vector<unsigned char*> output(numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i)
+  {
+    input[i] = &blocks->Data[i * this->BlockSize];
+    output[i] = &blocks->CompressedData[i * space];
+  }
+  blocks->CompressedSizes.resize(numBlocks);
+  bool compressed = this->Compressor->CompressBlocks(
+    numBlocks, input.data(), blocks->Sizes.data(), output.data(),
+    blocks->CompressedSizes.data());
+  blocks->Sizes.clear();
+  if (!compressed)
+  {
+    vtkErrorMacro("Error compressing data.");
+    return 0;
+  }
 
-  // Write the compressed data.
-  int result = this->DataStream->Write(outputPointer, outputSize);
+  // Write the compressed data in order, and store the compressed sizes in
+  // the compression header.
+  int result = 1;
+  for (size_t i = 0; result && i < numBlocks; ++i)
+  {
+    size_t outputSize = blocks->CompressedSizes[i];
+    result = this->DataStream->Write(output[i], outputSize);
+    this->CompressionHeader->Set(3+this->CompressionBlockNumber++, outputSize);
+  }
   this->Stream->flush();
   if (this->Stream->fail())
   {
     this->SetErrorCode(vtkErrorCode::GetLastSystemError());
+    return 0;
   }
 
-  // Store the resulting compressed size in the compression header.
-  this->CompressionHeader->Set(3+this->CompressionBlockNumber++, outputSize);
-
-  outputArray->Delete();
-
   return result;
 }
 
@@ -49,6 +49,7 @@ class vtkStdString;
 class OffsetsManager;      // one per piece/per time
 class OffsetsManagerGroup; // array of OffsetsManager
 class OffsetsManagerArray; // array of OffsetsManagerGroup
+class vtkXMLWriterCompressionBlocks; // blocks waiting to be compressed
 
 class VTKIOXML_EXPORT vtkXMLWriter : public vtkAlgorithm
 {
@@ -138,6 +139,9 @@ public:
   /**
    * Get/Set the compressor used to compress binary and appended data
    * before writing to the file.  Default is a vtkZLibDataCompressor.
+   * The blocks of an array are compressed by several threads when the
+   * compressor can be copied (see vtkDataCompressor::NewCopy()); the file
+   * is the same as with a single thread.
    */
   virtual void SetCompressor(vtkDataCompressor*);
   vtkGetObjectMacro(Compressor, vtkDataCompressor);
@@ -147,7 +151,8 @@ public:
   {
     NONE,
     ZLIB,
-    LZ4
+    LZ4,
+    ZFP
   };
 
   //@{
@@ -167,6 +172,10 @@ public:
   {
     this->SetCompressorType(ZLIB);
   }
+  void SetCompressorTypeToZFP()
+  {
+    this->SetCompressorType(ZFP);
+  }
   //@}
 
   //@{
@@ -174,7 +183,9 @@ public:
    * Get/Set the block size used in compression.  When reading, this
    * controls the granularity of how much extra information must be
    * read when only part of the data are requested.  The value should
-   * be a multiple of the largest scalar data type.
+   * be a multiple of the largest scalar data type.  The compressor may
+   * adjust it for each array (see
+   * vtkDataCompressor::GetPreferredBlockSize()).
    */
   virtual void SetBlockSize(size_t blockSize);
   vtkGetMacro(BlockSize, size_t);
@@ -323,6 +334,12 @@ protected:
   size_t CompressionBlockNumber;
   vtkXMLDataHeader* CompressionHeader;
   vtkTypeInt64 CompressionHeaderPosition;
+  vtkXMLWriterCompressionBlocks* CompressionBlocks;
+
+  // The point or cell dimensions of the structured data arrays being
+  // written, for the compressors that depend on the layout of the data.
+  // Zero when the arrays are not structured.
+  int ArrayDimensions[3];
 
   // The output stream used to write binary and appended data.  May
   // transparently encode the data.
@@ -458,6 +475,7 @@ protected:
   void PerformByteSwap(void* data, size_t numWords, size_t wordSize);
   int CreateCompressionHeader(size_t size);
   int WriteCompressionBlock(unsigned char* data, size_t size);
+  int FlushCompressionBlocks();
   int WriteCompressionHeader();
   size_t GetWordTypeSize(int dataType);
   const char* GetWordTypeName(int dataType);
@@ -20,6 +20,7 @@
 #include "vtkDataCompressor.h"
 #include "vtkInputStream.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
 #include "vtkXMLDataElement.h"
 #define vtkXMLDataHeaderPrivate_DoNotInclude
 #include "vtkXMLDataHeaderPrivate.h"
@@ -595,6 +596,56 @@ unsigned char* vtkXMLDataParser::ReadBlock(vtkTypeUInt64 block)
   return decompressBuffer;
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLDataParser::ReadBlocks(vtkTypeUInt64 firstBlock, size_t numBlocks,
+                                 unsigned char* buffer)
+{
+  // The compressed blocks follow each other in the stream, read them all
+  // at once.
+  vtkTypeUInt64 lastBlock = firstBlock + numBlocks - 1;
+  vtkTypeInt64 begin = this->BlockStartOffsets[firstBlock];
+  size_t compressedSize = static_cast<size_t>(
+    this->BlockStartOffsets[lastBlock] - begin) +
+    this->BlockCompressedSizes[lastBlock];
+
+  if(!this->DataStream->Seek(begin))
+  {
+    return 0;
+  }
+
+  unsigned char* readBuffer = new unsigned char[compressedSize];
+
+  if(this->DataStream->Read(readBuffer, compressedSize) < compressedSize)
+  {
+    delete [] readBuffer;
+    return 0;
+  }
+
+  // Uncompress the blocks, concurrently if possible.
+  std::vector<unsigned char const*> compressedData(numBlocks);
+  std::vector<size_t> compressedSizes(numBlocks);
+  std::vector<unsigned char*> uncompressedData(numBlocks);
+  std::vector<size_t> uncompressedSizes(numBlocks);
+  for(size_t i=0; i < numBlocks; ++i)
+  {
+    vtkTypeUInt64 block = firstBlock + i;
+    compressedData[i] = readBuffer + (this->BlockStartOffsets[block] - begin);
+    compressedSizes[i] = this->BlockCompressedSizes[block];
+    uncompressedData[i] = buffer;
+    uncompressedSizes[i] = this->FindBlockSize(block);
+    buffer += uncompressedSizes[i];
+  }
+
+  bool result =
+    this->Compressor->UncompressBlocks(numBlocks, compressedData.data(),
+                                       compressedSizes.data(),
+                                       uncompressedData.data(),
+                                       uncompressedSizes.data());
+
+  delete [] readBuffer;
+  return result;
+}
+
 //----------------------------------------------------------------------------
 size_t vtkXMLDataParser::ReadUncompressedData(unsigned char* data,
                                               vtkTypeUInt64 startWord,
@@ -774,18 +825,33 @@ size_t vtkXMLDataParser::ReadCompressedData(unsigned char* data,
     // Report progress.
     this->UpdateProgress(float(outputPointer-data)/length);
 
-    unsigned int currentBlock = firstBlock+1;
-    for(;currentBlock != lastBlock && !this->Abort; ++currentBlock)
+    // Read the complete blocks in batches, large enough to keep all the
+    // threads busy (within 16 MB) when the compressor can be copied to
+    // uncompress them concurrently.
+    size_t threads =
+      static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads());
+    size_t batchSize = std::max<size_t>(
+      1, std::min<size_t>(4*threads, (1 << 24) / blockSize));
+
+    vtkTypeUInt64 currentBlock = firstBlock+1;
+    while(currentBlock != lastBlock && !this->Abort)
     {
-      // Read this block.
-      if(!this->ReadBlock(currentBlock, outputPointer)) { return 0; }
+      // Read these blocks.
+      size_t numBlocks = static_cast<size_t>(
+        std::min<vtkTypeUInt64>(batchSize, lastBlock-currentBlock));
+      if(!this->ReadBlocks(currentBlock, numBlocks, outputPointer))
+      {
+        return 0;
+      }
 
-      // Byte swap this block.  Note that blockSize will always be an
+      // Byte swap these blocks.  Note that blockSize will always be an
       // integer multiple of the word size.
-      this->PerformByteSwap(outputPointer, blockSize / wordSize, wordSize);
+      this->PerformByteSwap(outputPointer, numBlocks*blockSize / wordSize,
+                            wordSize);
 
       // Advance the pointer to the beginning of the next block.
-      outputPointer += this->FindBlockSize(currentBlock);
+      outputPointer += numBlocks*blockSize;
+      currentBlock += numBlocks;
 
       // Report progress.
       this->UpdateProgress(float(outputPointer-data)/length);
@@ -934,6 +1000,54 @@ size_t vtkXMLDataParser::ReadAppendedData(vtkTypeInt64 offset,
   return this->ReadBinaryData(buffer, startWord, numWords, wordType);
 }
 
+//----------------------------------------------------------------------------
+vtkTypeInt64 vtkXMLDataParser::FindRawAppendedData(vtkTypeInt64 offset,
+                                                   vtkTypeUInt64 startWord,
+                                                   size_t numWords,
+                                                   int wordType)
+{
+#ifdef VTK_WORDS_BIGENDIAN
+  int byteOrder = vtkXMLDataParser::BigEndian;
+#else
+  int byteOrder = vtkXMLDataParser::LittleEndian;
+#endif
+  if(this->Compressor || this->ByteOrder != byteOrder ||
+     this->AppendedDataStream->IsA("vtkBase64InputStream"))
+  {
+    return -1;
+  }
+
+  // Read the length of the data.
+#if defined(VTK_HAS_STD_UNIQUE_PTR)
+  std::unique_ptr<vtkXMLDataHeader>
+    uh(vtkXMLDataHeader::New(this->HeaderType, 1));
+#else
+  std::auto_ptr<vtkXMLDataHeader>
+    uh(vtkXMLDataHeader::New(this->HeaderType, 1));
+#endif
+  size_t const headerSize = uh->DataSize();
+  this->DataStream = this->AppendedDataStream;
+  this->SeekG(this->AppendedDataPosition+offset);
+  this->DataStream->SetStream(this->Stream);
+  this->DataStream->StartReading();
+  size_t r = this->DataStream->Read(uh->Data(), headerSize);
+  this->DataStream->EndReading();
+  if(r < headerSize)
+  {
+    return -1;
+  }
+  vtkTypeUInt64 size = uh->Get(0);
+
+  // Make sure the requested words are in the data.
+  size_t wordSize = this->GetWordTypeSize(wordType);
+  if((startWord+numWords)*wordSize > size)
+  {
+    return -1;
+  }
+  return this->AppendedDataPosition + offset +
+    static_cast<vtkTypeInt64>(headerSize + startWord*wordSize);
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // Define a parsing function template.  The extra "long" argument is used
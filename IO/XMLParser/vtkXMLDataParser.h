@@ -79,6 +79,17 @@ public:
   { return this->ReadAppendedData(offset, buffer, startWord, numWords,
                                     VTK_CHAR); }
 
+  /**
+   * Return the position in the stream of numWords words of the given type,
+   * starting at startWord, of the appended data at the given offset, when
+   * these data are stored in the stream exactly as in memory: raw encoded,
+   * not compressed and in the byte order of this machine. Returns -1
+   * otherwise, or when there are less data.
+   */
+  vtkTypeInt64 FindRawAppendedData(vtkTypeInt64 offset,
+                                   vtkTypeUInt64 startWord,
+                                   size_t numWords, int wordType);
+
   /**
    * Read from an ascii data section starting at the current position in
    * the stream.  Returns the number of words read.
@@ -189,6 +200,8 @@ protected:
   size_t FindBlockSize(vtkTypeUInt64 block);
   int ReadBlock(vtkTypeUInt64 block, unsigned char* buffer);
   unsigned char* ReadBlock(vtkTypeUInt64 block);
+  int ReadBlocks(vtkTypeUInt64 firstBlock, size_t numBlocks,
+                 unsigned char* buffer);
   size_t ReadUncompressedData(unsigned char* data,
                               vtkTypeUInt64 startWord,
                               size_t numWords,